@@ -11,6 +11,1230 @@
 #include "CAN_STM32F1xx.h"
 
 #include <math.h>
+#include <string.h>
+
+/*****************************************************************************
+ * @defgroup CAN statistics.
+ * @{
+ */
+
+/* Error state changes and error codes in SCE interrupt. */
+#define CAN_SCE_IT                                                             \
+    (CAN_IT_ERROR_WARNING | CAN_IT_ERROR_PASSIVE | CAN_IT_BUSOFF |             \
+     CAN_IT_LAST_ERROR_CODE | CAN_IT_ERROR)
+
+/**
+ * @brief Statistics of a CAN and the state to compute them.
+ */
+typedef struct {
+    can_stats_t stats;  /*!< Counters */
+    uint32_t bit_time;  /*!< Nominal bit time, unit: ns */
+    uint64_t load_bits; /*!< Bits on the bus since `load_tick` */
+    uint32_t load_tick; /*!< Start of the bus load period */
+    uint64_t wait_sum;  /*!< Sum of transmit wait, unit: CPU cycle */
+    uint32_t wait_max;  /*!< Maximum transmit wait, unit: CPU cycle */
+    uint32_t wait_num;  /*!< Number of transmit waits */
+} can_stat_t;
+
+#if CAN1_ENABLE
+static can_stat_t can1_stat;
+#endif /* CAN1_ENABLE */
+
+#if CAN2_ENABLE
+static can_stat_t can2_stat;
+#endif /* CAN2_ENABLE */
+
+/**
+ * @brief Get the statistics of a CAN.
+ *
+ * @param hcan The handle of CAN.
+ * @return The statistics. return NULL which the CAN doesn't exist.
+ */
+static can_stat_t *can_stat_find(CAN_HandleTypeDef *hcan) {
+#if CAN1_ENABLE
+    if (hcan == &can1_handle) {
+        return &can1_stat;
+    }
+#endif /* CAN1_ENABLE */
+
+#if CAN2_ENABLE
+    if (hcan == &can2_handle) {
+        return &can2_stat;
+    }
+#endif /* CAN2_ENABLE */
+
+    UNUSED(hcan);
+    return NULL;
+}
+
+/**
+ * @brief Clear the counters, keep the ID ranges and the error state.
+ *
+ * @param stat The statistics.
+ */
+static void can_stat_clear(can_stat_t *stat) {
+    can_stats_range_t *range;
+    uint32_t i;
+
+    stat->stats.tx_frames = 0;
+    stat->stats.tx_bytes = 0;
+    stat->stats.tx_dropped = 0;
+    stat->stats.tx_retry = 0;
+    stat->stats.tx_wait_avg = 0;
+    stat->stats.tx_wait_max = 0;
+    stat->stats.rx_frames = 0;
+    stat->stats.rx_bytes = 0;
+    stat->stats.rx_overrun = 0;
+    stat->stats.rx_lost = 0;
+    stat->stats.load = 0;
+    stat->stats.errors = 0;
+    stat->stats.warning_count = 0;
+    stat->stats.passive_count = 0;
+    stat->stats.bus_off_count = 0;
+    stat->stats.recover_count = 0;
+    stat->stats.passive_tick = 0;
+    stat->stats.bus_off_tick = 0;
+    stat->stats.recover_tick = 0;
+    stat->stats.last_error = 0;
+
+    for (i = 0; i < CAN_STATS_RANGE_NUM; ++i) {
+        range = &stat->stats.range[i];
+        range->tx_frames = 0;
+        range->tx_bytes = 0;
+        range->rx_frames = 0;
+        range->rx_bytes = 0;
+    }
+
+    stat->load_bits = 0;
+    stat->load_tick = HAL_GetTick();
+    stat->wait_sum = 0;
+    stat->wait_max = 0;
+    stat->wait_num = 0;
+}
+
+#if CAN1_ENABLE || CAN2_ENABLE
+
+/**
+ * @brief Clear the statistics and start the cycle counter for wait time.
+ *
+ * @param stat The statistics.
+ * @param prescale Prescaler of bit timing.
+ * @param tseg1 Time of segment 1.
+ * @param tseg2 Time of segment 2.
+ */
+static void can_stat_init(can_stat_t *stat, uint32_t prescale, uint32_t tseg1,
+                          uint32_t tseg2) {
+    can_stat_clear(stat);
+    stat->stats.state = CAN_ERR_ACTIVE;
+    stat->stats.tec = 0;
+    stat->stats.rec = 0;
+    stat->bit_time =
+        (uint32_t)((uint64_t)prescale * (1U + tseg1 + tseg2) * 1000000000U /
+                   HAL_RCC_GetPCLK1Freq());
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+#endif /* CAN1_ENABLE || CAN2_ENABLE */
+
+/**
+ * @brief Count a frame sent or received.
+ *
+ * @param stat The statistics.
+ * @param ide `CAN_ID_STD` or `CAN_ID_EXT`.
+ * @param id The ID.
+ * @param len Data length, 0 for remote frame.
+ * @param tx 1: sent; 0: received.
+ */
+static void can_stat_frame(can_stat_t *stat, uint32_t ide, uint32_t id,
+                           uint32_t len, uint8_t tx) {
+    can_stats_range_t *range;
+    uint32_t primask = __get_PRIMASK();
+    uint32_t i;
+
+    __disable_irq();
+    if (tx) {
+        ++stat->stats.tx_frames;
+        stat->stats.tx_bytes += len;
+    } else {
+        ++stat->stats.rx_frames;
+        stat->stats.rx_bytes += len;
+    }
+
+    /* SOF, arbitration, control, CRC, ACK, EOF and intermission, without
+     * stuff bits. */
+    stat->load_bits += ((ide == CAN_ID_STD) ? 47U : 67U) + len * 8U;
+
+    for (i = 0; i < CAN_STATS_RANGE_NUM; ++i) {
+        range = &stat->stats.range[i];
+        if (range->id_max < range->id_min || range->ide != ide ||
+            id < range->id_min || id > range->id_max) {
+            continue;
+        }
+
+        if (tx) {
+            ++range->tx_frames;
+            range->tx_bytes += len;
+        } else {
+            ++range->rx_frames;
+            range->rx_bytes += len;
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Count a frame sent from the transmit queue.
+ *
+ * @param hcan The handle of CAN.
+ * @param frame The frame.
+ * @param time `DWT->CYCCNT` when the frame is put into the queue.
+ */
+static void can_stat_tx_done(CAN_HandleTypeDef *hcan, const can_frame_t *frame,
+                             uint32_t time) {
+    can_stat_t *stat = can_stat_find(hcan);
+    uint32_t wait = DWT->CYCCNT - time;
+    uint32_t primask = __get_PRIMASK();
+
+    if (stat == NULL) {
+        return;
+    }
+
+    can_stat_frame(stat, frame->ide, frame->id,
+                   (frame->rtr == CAN_RTR_DATA) ? frame->len : 0, 1);
+
+    __disable_irq();
+    stat->wait_sum += wait;
+    ++stat->wait_num;
+    if (wait > stat->wait_max) {
+        stat->wait_max = wait;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Read the error counters, record the error state changes.
+ *
+ * @param hcan The handle of CAN.
+ * @param stat The statistics.
+ * @param in_isr Called in SCE interrupt, count the error code.
+ * @note Without SCE interrupt, the changes are found when the statistics are
+ *       read, and the tick is the time of reading.
+ */
+static void can_stat_update(CAN_HandleTypeDef *hcan, can_stat_t *stat,
+                            uint8_t in_isr) {
+    uint32_t esr = hcan->Instance->ESR;
+    uint32_t lec = (esr & CAN_ESR_LEC) >> CAN_ESR_LEC_Pos;
+    uint32_t primask = __get_PRIMASK();
+    uint8_t state;
+
+    state = (esr & CAN_ESR_BOFF)   ? CAN_ERR_BUS_OFF
+            : (esr & CAN_ESR_EPVF) ? CAN_ERR_PASSIVE
+            : (esr & CAN_ESR_EWGF) ? CAN_ERR_WARNING
+                                   : CAN_ERR_ACTIVE;
+
+    __disable_irq();
+    stat->stats.tec = (uint8_t)((esr & CAN_ESR_TEC) >> CAN_ESR_TEC_Pos);
+    stat->stats.rec = (uint8_t)((esr & CAN_ESR_REC) >> CAN_ESR_REC_Pos);
+
+    /* 7 is written by software, it is not an error. */
+    if (lec != 0 && lec != 7) {
+        stat->stats.last_error = (uint8_t)lec;
+        if (in_isr) {
+            ++stat->stats.errors;
+        }
+    }
+
+    if (state != stat->stats.state) {
+        if (stat->stats.state == CAN_ERR_BUS_OFF) {
+            ++stat->stats.recover_count;
+            stat->stats.recover_tick = HAL_GetTick();
+        }
+
+        if (state == CAN_ERR_WARNING) {
+            ++stat->stats.warning_count;
+        } else if (state == CAN_ERR_PASSIVE) {
+            ++stat->stats.passive_count;
+            stat->stats.passive_tick = HAL_GetTick();
+        } else if (state == CAN_ERR_BUS_OFF) {
+            ++stat->stats.bus_off_count;
+            stat->stats.bus_off_tick = HAL_GetTick();
+        }
+
+        stat->stats.state = state;
+    }
+    __set_PRIMASK(primask);
+}
+
+#if (CAN1_ENABLE && CAN1_ENABLE_SCE_IT) || (CAN2_ENABLE && CAN2_ENABLE_SCE_IT)
+
+/**
+ * @brief CAN SCE interrupt handler, record the error state before HAL clears
+ *        the error code.
+ *
+ * @param hcan The handle of CAN.
+ */
+static void can_sce_irq_handler(CAN_HandleTypeDef *hcan) {
+    can_stat_t *stat = can_stat_find(hcan);
+
+    if (stat != NULL) {
+        can_stat_update(hcan, stat, 1);
+    }
+
+    HAL_CAN_IRQHandler(hcan);
+}
+
+#endif /* CANx_ENABLE_SCE_IT */
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup CAN transmit queue.
+ * @{
+ */
+
+#define CAN_TX_MAILBOX_NUM 3
+
+/**
+ * @brief Frame waiting to be sent.
+ */
+typedef struct {
+    uint32_t key;      /*!< Arbitration field, the smaller wins the bus */
+    uint32_t time;     /*!< `DWT->CYCCNT` when put into the queue */
+    can_frame_t frame; /*!< Frame */
+} can_tx_item_t;
+
+/**
+ * @brief Transmit queue of a CAN.
+ *
+ * @note `item` is sorted by `key` from large to small, so the next frame is
+ *       always the last one. Frames with the same key keep the send order.
+ *       The hardware sends the mailbox with the smallest identifier first
+ *       (`TransmitFifoPriority` disabled), so only the three best frames are
+ *       put into the mailboxes, and a worse frame in the mailbox is aborted
+ *       and put back to the queue when a better one arrives.
+ */
+typedef struct {
+    can_tx_item_t item[CAN_TX_QUEUE_SIZE];     /*!< Frames not in mailbox */
+    uint32_t count;                            /*!< Number of frames */
+    can_tx_item_t mailbox[CAN_TX_MAILBOX_NUM]; /*!< Frames in the mailboxes */
+    uint32_t busy;  /*!< Mailboxes used by the queue, bit 0-2 */
+    uint32_t abort; /*!< Mailboxes being aborted, bit 0-2 */
+    can_selected_t selected;                       /*!< Which CAN */
+    void (*callback)(can_selected_t can_selected); /*!< Called after a frame
+                                                        is sent */
+} can_tx_queue_t;
+
+#if CAN1_ENABLE
+static can_tx_queue_t can1_tx_queue = {.selected = can1_selected};
+#endif /* CAN1_ENABLE */
+
+#if CAN2_ENABLE
+static can_tx_queue_t can2_tx_queue = {.selected = can2_selected};
+#endif /* CAN2_ENABLE */
+
+/**
+ * @brief Get the transmit queue of a CAN.
+ *
+ * @param hcan The handle of CAN.
+ * @return The transmit queue. return NULL which the CAN doesn't exist.
+ */
+static can_tx_queue_t *can_tx_get_queue(CAN_HandleTypeDef *hcan) {
+#if CAN1_ENABLE
+    if (hcan == &can1_handle) {
+        return &can1_tx_queue;
+    }
+#endif /* CAN1_ENABLE */
+
+#if CAN2_ENABLE
+    if (hcan == &can2_handle) {
+        return &can2_tx_queue;
+    }
+#endif /* CAN2_ENABLE */
+
+    UNUSED(hcan);
+    return NULL;
+}
+
+/**
+ * @brief Clear the transmit queue, the frames are dropped.
+ *
+ * @param queue The transmit queue.
+ */
+static void can_tx_reset(can_tx_queue_t *queue) {
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    queue->count = 0;
+    queue->busy = 0;
+    queue->abort = 0;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Get the arbitration field of a frame.
+ *
+ * @param frame The frame.
+ * @return Bits of arbitration field in sending order, the frame with smaller
+ *         value wins the bus.
+ */
+static uint32_t can_tx_key(const can_frame_t *frame) {
+    uint32_t rtr = (frame->rtr == CAN_RTR_REMOTE) ? 1U : 0U;
+
+    if (frame->ide == CAN_ID_STD) {
+        /* Base ID, RTR, IDE = 0 */
+        return ((frame->id & 0x7FFU) << 21) | (rtr << 20);
+    }
+
+    /* Base ID, SRR = 1, IDE = 1, ID extension, RTR */
+    return (((frame->id >> 18) & 0x7FFU) << 21) | (3U << 19) |
+           ((frame->id & 0x3FFFFU) << 1) | rtr;
+}
+
+/**
+ * @brief Get the number of mailboxes in a mask.
+ *
+ * @param mask Mask of mailboxes, bit 0-2.
+ * @return Number of mailboxes.
+ */
+static uint32_t can_tx_mailbox_num(uint32_t mask) {
+    return (mask & 1U) + ((mask >> 1) & 1U) + ((mask >> 2) & 1U);
+}
+
+/**
+ * @brief Insert a frame to the transmit queue.
+ *
+ * @param queue The transmit queue.
+ * @param item The frame.
+ * @param requeue The frame is back from a mailbox, put it before the frames
+ *                with the same key.
+ * @return Insert status.
+ * @retval - 0: Success.
+ * @retval - 1: The queue is full.
+ */
+static uint8_t can_tx_insert(can_tx_queue_t *queue, const can_tx_item_t *item,
+                             uint8_t requeue) {
+    uint32_t i = queue->count;
+
+    if (i >= CAN_TX_QUEUE_SIZE) {
+        return 1;
+    }
+
+    while (i > 0 && (queue->item[i - 1].key < item->key ||
+                     (queue->item[i - 1].key == item->key && !requeue))) {
+        queue->item[i] = queue->item[i - 1];
+        --i;
+    }
+    queue->item[i] = *item;
+    ++queue->count;
+
+    return 0;
+}
+
+/**
+ * @brief Collect the finished mailboxes, put the aborted or failed frames back
+ *        to the queue. Must be called with interrupt disabled.
+ *
+ * @param hcan The handle of CAN.
+ * @param queue The transmit queue.
+ * @param in_isr Called in TX interrupt after `HAL_CAN_IRQHandler`.
+ * @note When TX interrupt is enabled, HAL clears `RQCPx` and then calls the
+ *       complete callback for the sent mailboxes, the others left busy are
+ *       aborted or failed. It is only safe to check this after HAL, so the
+ *       mailboxes are only collected in TX interrupt. When TX interrupt is
+ *       disabled, `RQCPx` and `TXOKx` are kept until next transmission.
+ */
+static void can_tx_collect(CAN_HandleTypeDef *hcan, can_tx_queue_t *queue,
+                           uint8_t in_isr) {
+    can_stat_t *stat = can_stat_find(hcan);
+    uint32_t tsr = hcan->Instance->TSR;
+    uint32_t it_enabled = hcan->Instance->IER & CAN_IER_TMEIE;
+    uint32_t i, rqcp;
+
+    if (it_enabled && !in_isr) {
+        return;
+    }
+
+    for (i = 0; i < CAN_TX_MAILBOX_NUM; ++i) {
+        if ((queue->busy & (1U << i)) == 0 ||
+            (tsr & (CAN_TSR_TME0 << i)) == 0) {
+            continue;
+        }
+
+        rqcp = tsr & (CAN_TSR_RQCP0 << (i * 8));
+        if (it_enabled) {
+            if (rqcp != 0) {
+                /* Finished after HAL, wait for next interrupt. */
+                continue;
+            }
+            can_tx_insert(queue, &queue->mailbox[i], 1);
+            ++stat->stats.tx_retry;
+        } else {
+            if (rqcp == 0) {
+                continue;
+            }
+            if ((tsr & (CAN_TSR_TXOK0 << (i * 8))) == 0) {
+                can_tx_insert(queue, &queue->mailbox[i], 1);
+                ++stat->stats.tx_retry;
+            } else {
+                can_stat_tx_done(hcan, &queue->mailbox[i].frame,
+                                 queue->mailbox[i].time);
+            }
+        }
+
+        queue->busy &= ~(1U << i);
+        queue->abort &= ~(1U << i);
+    }
+}
+
+/**
+ * @brief Put the best frames into the empty mailboxes. Must be called with
+ *        interrupt disabled.
+ *
+ * @param hcan The handle of CAN.
+ * @param queue The transmit queue.
+ */
+static void can_tx_refill(CAN_HandleTypeDef *hcan, can_tx_queue_t *queue) {
+    CAN_TxHeaderTypeDef tx_header = {.TransmitGlobalTime = DISABLE};
+    can_tx_item_t *item;
+    uint32_t tx_mail_box, tme = 0, i, worst;
+
+    while (queue->count > 0) {
+        item = &queue->item[queue->count - 1];
+
+        /* HAL chooses the empty mailbox, wait for the TX interrupt if one of
+         * them is not collected yet. */
+        tme = (hcan->Instance->TSR & CAN_TSR_TME) >> CAN_TSR_TME0_Pos;
+        if (tme == 0 || (tme & queue->busy) != 0) {
+            break;
+        }
+
+        tx_header.IDE = item->frame.ide;
+        tx_header.RTR = item->frame.rtr;
+        tx_header.DLC = item->frame.len;
+        tx_header.StdId = item->frame.id;
+        tx_header.ExtId = item->frame.id;
+        if (HAL_CAN_AddTxMessage(hcan, &tx_header, item->frame.data,
+                                 &tx_mail_box) != HAL_OK) {
+            return;
+        }
+
+        i = (tx_mail_box == CAN_TX_MAILBOX0)   ? 0
+            : (tx_mail_box == CAN_TX_MAILBOX1) ? 1
+                                               : 2;
+        queue->mailbox[i] = *item;
+        queue->busy |= 1U << i;
+        --queue->count;
+    }
+
+    /* All mailboxes are full. The aborting mailboxes will be taken by the
+     * best frames in queue, check whether the next one is better than the
+     * worst frame in mailbox. */
+    i = can_tx_mailbox_num(queue->abort);
+    if (queue->count <= i || tme != 0) {
+        return;
+    }
+    item = &queue->item[queue->count - 1 - i];
+
+    worst = CAN_TX_MAILBOX_NUM;
+    for (i = 0; i < CAN_TX_MAILBOX_NUM; ++i) {
+        if ((queue->busy & ~queue->abort & (1U << i)) == 0) {
+            continue;
+        }
+        if (worst == CAN_TX_MAILBOX_NUM ||
+            queue->mailbox[i].key > queue->mailbox[worst].key) {
+            worst = i;
+        }
+    }
+
+    if (worst != CAN_TX_MAILBOX_NUM &&
+        item->key < queue->mailbox[worst].key) {
+        /* If the frame is being sent, it may still be sent successfully. */
+        if (HAL_CAN_AbortTxRequest(hcan, CAN_TX_MAILBOX0 << worst) == HAL_OK) {
+            queue->abort |= 1U << worst;
+        }
+    }
+}
+
+#if (CAN1_ENABLE && CAN1_ENABLE_TX_IT) || (CAN2_ENABLE && CAN2_ENABLE_TX_IT)
+
+/**
+ * @brief CAN TX interrupt handler, collect the aborted or failed mailboxes
+ *        after HAL, and refill them.
+ *
+ * @param hcan The handle of CAN.
+ */
+static void can_tx_irq_handler(CAN_HandleTypeDef *hcan) {
+    can_tx_queue_t *queue = can_tx_get_queue(hcan);
+    uint32_t primask;
+
+    HAL_CAN_IRQHandler(hcan);
+
+    if (queue == NULL) {
+        return;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    can_tx_collect(hcan, queue, 1);
+    can_tx_refill(hcan, queue);
+    __set_PRIMASK(primask);
+}
+
+#endif /* CANx_ENABLE_TX_IT */
+
+/**
+ * @brief A mailbox is sent, refill it.
+ *
+ * @param hcan The handle of CAN.
+ * @param mailbox The mailbox number, 0-2.
+ */
+static void can_tx_complete(CAN_HandleTypeDef *hcan, uint32_t mailbox) {
+    can_tx_queue_t *queue = can_tx_get_queue(hcan);
+    uint32_t primask = __get_PRIMASK();
+
+    if (queue == NULL) {
+        return;
+    }
+
+    __disable_irq();
+    if (queue->busy & (1U << mailbox)) {
+        can_stat_tx_done(hcan, &queue->mailbox[mailbox].frame,
+                         queue->mailbox[mailbox].time);
+    }
+    queue->busy &= ~(1U << mailbox);
+    queue->abort &= ~(1U << mailbox);
+    can_tx_refill(hcan, queue);
+    __set_PRIMASK(primask);
+    if (queue->callback != NULL) {
+        queue->callback(queue->selected);
+    }
+}
+
+/**
+ * @brief CAN tx mailbox 0 complete callback.
+ *
+ * @param hcan The handle of CAN.
+ */
+void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan) {
+    can_tx_complete(hcan, 0);
+}
+
+/**
+ * @brief CAN tx mailbox 1 complete callback.
+ *
+ * @param hcan The handle of CAN.
+ */
+void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan) {
+    can_tx_complete(hcan, 1);
+}
+
+/**
+ * @brief CAN tx mailbox 2 complete callback.
+ *
+ * @param hcan The handle of CAN.
+ */
+void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan) {
+    can_tx_complete(hcan, 2);
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup CAN receive dispatch.
+ * @{
+ */
+
+#if defined(CAN2)
+/* Filter banks shared by CAN1 and CAN2. */
+#define CAN_FILTER_BANK_NUM  28
+#else
+#define CAN_FILTER_BANK_NUM  14
+#endif /* defined(CAN2) */
+
+/* Filter numbers (FMI) of each FIFO, a bank has 4 filters at most. */
+#define CAN_RX_ROUTE_NUM     (CAN_RX_FILTER_NUM * 4)
+#define CAN_RX_ROUTE_NONE    0xFFU
+
+/**
+ * @brief Subscription.
+ */
+typedef struct {
+    uint32_t id;         /*!< ID, the bits not in mask are cleared */
+    uint32_t mask;       /*!< The bits set must match */
+    uint8_t ide;         /*!< `CAN_ID_STD` or `CAN_ID_EXT` */
+    uint8_t fifo;        /*!< `CAN_RX_FIFO0` or `CAN_RX_FIFO1` */
+    can_rx_ring_t *ring; /*!< Receive ring */
+} can_rx_filter_t;
+
+/**
+ * @brief Receive state of a CAN.
+ *
+ * @note If there is no subscription, all frames are accepted and handled by
+ *       `HAL_CAN_IRQHandler` as before. Otherwise the FIFOs are read in
+ *       interrupt directly, and the filter number of the frame selects the
+ *       subscription.
+ */
+typedef struct {
+    can_rx_filter_t filter[CAN_RX_FILTER_NUM]; /*!< Subscriptions */
+    uint32_t filter_num;                       /*!< Number of subscriptions */
+    uint8_t route[2][CAN_RX_ROUTE_NUM]; /*!< Filter number of each FIFO to
+                                             subscription */
+    uint8_t rx_it; /*!< FIFO interrupts enabled, bit 0: FIFO0, bit 1: FIFO1 */
+} can_rx_t;
+
+/**
+ * @brief Kind of filter bank.
+ */
+enum {
+    CAN_BANK_MASK32, /*!< 32-bit mask, 1 filter */
+    CAN_BANK_LIST32, /*!< 32-bit identifier list, 2 filters */
+    CAN_BANK_MASK16, /*!< 16-bit mask, 2 filters */
+    CAN_BANK_LIST16  /*!< 16-bit identifier list, 4 filters */
+};
+
+/**
+ * @brief Layout of a filter bank.
+ */
+typedef struct {
+    uint8_t kind;    /*!< `CAN_BANK_xxx` */
+    uint8_t fifo;    /*!< `CAN_RX_FIFO0` or `CAN_RX_FIFO1` */
+    uint8_t num;     /*!< Subscriptions in the bank, 0: accept all */
+    uint8_t slot[4]; /*!< Subscription of each filter */
+} can_filter_bank_t;
+
+/* Filters of each kind of bank. */
+static const uint8_t can_bank_slots[] = {1, 2, 2, 4};
+
+#if CAN1_ENABLE
+static can_rx_t can1_rx = {.rx_it = (CAN1_ENABLE_RX0_IT ? 1U : 0U) |
+                                    (CAN1_ENABLE_RX1_IT ? 2U : 0U)};
+#endif /* CAN1_ENABLE */
+
+#if CAN2_ENABLE
+static can_rx_t can2_rx = {.rx_it = (CAN2_ENABLE_RX0_IT ? 1U : 0U) |
+                                    (CAN2_ENABLE_RX1_IT ? 2U : 0U)};
+#endif /* CAN2_ENABLE */
+
+/**
+ * @brief Get the receive state of a CAN.
+ *
+ * @param hcan The handle of CAN.
+ * @return The receive state. return NULL which the CAN doesn't exist.
+ */
+static can_rx_t *can_rx_get(CAN_HandleTypeDef *hcan) {
+#if CAN1_ENABLE
+    if (hcan == &can1_handle) {
+        return &can1_rx;
+    }
+#endif /* CAN1_ENABLE */
+
+#if CAN2_ENABLE
+    if (hcan == &can2_handle) {
+        return &can2_rx;
+    }
+#endif /* CAN2_ENABLE */
+
+    UNUSED(hcan);
+    return NULL;
+}
+
+#if CAN1_ENABLE || CAN2_ENABLE
+
+/**
+ * @brief Whether the subscription matches only one ID.
+ *
+ * @param filter The subscription.
+ * @return 1: One ID; 0: Masked.
+ */
+static uint32_t can_filter_is_exact(const can_rx_filter_t *filter) {
+    return filter->mask ==
+           ((filter->ide == CAN_ID_STD) ? 0x7FFU : 0x1FFFFFFFU);
+}
+
+/**
+ * @brief Put a subscription into the current bank, add a new bank if it is
+ *        full.
+ *
+ * @param bank The layout.
+ * @param bank_num Number of banks, increased when a bank is added.
+ * @param max Maximum banks.
+ * @param cur The current bank of this kind, NULL: add a new one.
+ * @param kind `CAN_BANK_xxx`.
+ * @param fifo `CAN_RX_FIFO0` or `CAN_RX_FIFO1`.
+ * @param index The subscription.
+ * @note If the banks are not enough, `bank_num` is still increased.
+ */
+static void can_filter_put(can_filter_bank_t *bank, uint32_t *bank_num,
+                           uint32_t max, can_filter_bank_t **cur, uint8_t kind,
+                           uint8_t fifo, uint32_t index) {
+    if (*cur == NULL || (*cur)->num == can_bank_slots[kind]) {
+        if (*bank_num >= max) {
+            ++(*bank_num);
+            *cur = NULL;
+            return;
+        }
+
+        *cur = &bank[(*bank_num)++];
+        (*cur)->kind = kind;
+        (*cur)->fifo = fifo;
+        (*cur)->num = 0;
+    }
+
+    (*cur)->slot[(*cur)->num++] = (uint8_t)index;
+}
+
+/**
+ * @brief Pack the subscriptions into the fewest filter banks.
+ *
+ * @param rx The receive state.
+ * @param bank The layout.
+ * @param max Maximum banks.
+ * @return Number of banks needed, it may be greater than `max`.
+ * @note Extended masks use one 32-bit mask bank each, extended IDs are paired
+ *       in 32-bit list banks and standard masks in 16-bit mask banks. Standard
+ *       IDs fill the spare filter of them first, then 4 in a 16-bit list bank.
+ *       The unused filters of a bank repeat the first one.
+ */
+static uint32_t can_filter_layout(const can_rx_t *rx, can_filter_bank_t *bank,
+                                  uint32_t max) {
+    can_filter_bank_t *mask32, *list32, *mask16, *list16;
+    const can_rx_filter_t *filter;
+    uint32_t bank_num = 0;
+    uint8_t fifo;
+    uint32_t i;
+
+    if (rx->filter_num == 0) {
+        /* Accept all frames, FIFO1 is preferred as before. */
+        if (rx->rx_it != 0) {
+            mask32 = NULL;
+            can_filter_put(bank, &bank_num, max, &mask32, CAN_BANK_MASK32,
+                           (rx->rx_it & 2U) ? CAN_RX_FIFO1 : CAN_RX_FIFO0, 0);
+            if (mask32 != NULL) {
+                mask32->num = 0;
+            }
+        }
+        return bank_num;
+    }
+
+    for (fifo = CAN_RX_FIFO0; fifo <= CAN_RX_FIFO1; ++fifo) {
+        list32 = mask16 = list16 = NULL;
+
+        for (i = 0; i < rx->filter_num; ++i) {
+            filter = &rx->filter[i];
+            if (filter->fifo != fifo || filter->ide != CAN_ID_EXT) {
+                continue;
+            }
+
+            if (can_filter_is_exact(filter)) {
+                can_filter_put(bank, &bank_num, max, &list32, CAN_BANK_LIST32,
+                               fifo, i);
+            } else {
+                mask32 = NULL;
+                can_filter_put(bank, &bank_num, max, &mask32, CAN_BANK_MASK32,
+                               fifo, i);
+            }
+        }
+
+        for (i = 0; i < rx->filter_num; ++i) {
+            filter = &rx->filter[i];
+            if (filter->fifo == fifo && filter->ide == CAN_ID_STD &&
+                !can_filter_is_exact(filter)) {
+                can_filter_put(bank, &bank_num, max, &mask16, CAN_BANK_MASK16,
+                               fifo, i);
+            }
+        }
+
+        for (i = 0; i < rx->filter_num; ++i) {
+            filter = &rx->filter[i];
+            if (filter->fifo != fifo || filter->ide != CAN_ID_STD ||
+                !can_filter_is_exact(filter)) {
+                continue;
+            }
+
+            if (list32 != NULL && list32->num == 1) {
+                list32->slot[list32->num++] = (uint8_t)i;
+            } else if (mask16 != NULL && mask16->num == 1) {
+                mask16->slot[mask16->num++] = (uint8_t)i;
+            } else {
+                can_filter_put(bank, &bank_num, max, &list16, CAN_BANK_LIST16,
+                               fifo, i);
+            }
+        }
+    }
+
+    return bank_num;
+}
+
+/**
+ * @brief Build the map from filter number to subscription.
+ *
+ * @param rx The receive state.
+ * @param bank The layout.
+ * @param bank_num Number of banks.
+ * @note The filter numbers of each FIFO start from 0 at the first bank of
+ *       this CAN, and increase by the filters of each bank.
+ */
+static void can_filter_route(can_rx_t *rx, const can_filter_bank_t *bank,
+                             uint32_t bank_num) {
+    uint32_t fmi[2] = {0, 0};
+    uint32_t i, k, n;
+
+    memset(rx->route, CAN_RX_ROUTE_NONE, sizeof(rx->route));
+
+    for (i = 0; i < bank_num; ++i) {
+        for (k = 0; k < can_bank_slots[bank[i].kind]; ++k) {
+            n = fmi[bank[i].fifo]++;
+            if (n < CAN_RX_ROUTE_NUM && bank[i].num != 0) {
+                rx->route[bank[i].fifo][n] =
+                    bank[i].slot[(k < bank[i].num) ? k : 0];
+            }
+        }
+    }
+}
+
+/**
+ * @brief The 32-bit filter value of a subscription, STID[10:0] EXID[17:0]
+ *        IDE RTR 0.
+ *
+ * @param filter The subscription.
+ * @param mask 0: The ID; 1: The mask.
+ * @return The value.
+ * @note IDE is always compared. RTR is compared for one ID, so only data
+ *       frame is accepted.
+ */
+static uint32_t can_filter_value32(const can_rx_filter_t *filter,
+                                   uint32_t mask) {
+    uint32_t value = mask ? filter->mask : filter->id;
+
+    value = (filter->ide == CAN_ID_STD) ? (value << 21) : (value << 3);
+    if (mask) {
+        value |= CAN_ID_EXT | (can_filter_is_exact(filter) ? CAN_RTR_REMOTE : 0);
+    } else {
+        value |= filter->ide;
+    }
+
+    return value;
+}
+
+/**
+ * @brief The 16-bit filter value of a standard subscription,
+ *        STID[10:0] RTR IDE EXID[17:15].
+ *
+ * @param filter The subscription.
+ * @param mask 0: The ID; 1: The mask.
+ * @return The value.
+ */
+static uint32_t can_filter_value16(const can_rx_filter_t *filter,
+                                   uint32_t mask) {
+    if (!mask) {
+        return filter->id << 5;
+    }
+
+    return (filter->mask << 5) | 0x08U |
+           (can_filter_is_exact(filter) ? 0x10U : 0U);
+}
+
+/**
+ * @brief Write the layout into the filter banks.
+ *
+ * @param can_ip The CAN which has the filter banks.
+ * @param rx The receive state.
+ * @param bank The layout.
+ * @param bank_num Number of banks.
+ * @param first The first bank of this CAN.
+ * @param last The bank after the last one of this CAN, the banks not used are
+ *             deactivated.
+ * @note Filter initialization mode must be entered.
+ */
+static void can_filter_write(CAN_TypeDef *can_ip, const can_rx_t *rx,
+                             const can_filter_bank_t *bank, uint32_t bank_num,
+                             uint32_t first, uint32_t last) {
+    const can_rx_filter_t *filter[4];
+    const can_filter_bank_t *cur;
+    uint32_t fr1, fr2, bit;
+    uint32_t i, k;
+
+    for (i = first; i < last; ++i) {
+        bit = 1U << i;
+        can_ip->FA1R &= ~bit;
+        if (i - first >= bank_num) {
+            continue;
+        }
+
+        cur = &bank[i - first];
+        for (k = 0; k < 4; ++k) {
+            filter[k] = &rx->filter[cur->slot[(k < cur->num) ? k : 0]];
+        }
+
+        switch (cur->kind) {
+            case CAN_BANK_LIST32:
+                fr1 = can_filter_value32(filter[0], 0);
+                fr2 = can_filter_value32(filter[1], 0);
+                break;
+
+            case CAN_BANK_MASK16:
+                fr1 = (can_filter_value16(filter[0], 1) << 16) |
+                      can_filter_value16(filter[0], 0);
+                fr2 = (can_filter_value16(filter[1], 1) << 16) |
+                      can_filter_value16(filter[1], 0);
+                break;
+
+            case CAN_BANK_LIST16:
+                fr1 = (can_filter_value16(filter[1], 0) << 16) |
+                      can_filter_value16(filter[0], 0);
+                fr2 = (can_filter_value16(filter[3], 0) << 16) |
+                      can_filter_value16(filter[2], 0);
+                break;
+
+            default:
+                if (cur->num == 0) {
+                    fr1 = fr2 = 0;
+                } else {
+                    fr1 = can_filter_value32(filter[0], 0);
+                    fr2 = can_filter_value32(filter[0], 1);
+                }
+                break;
+        }
+
+        if (cur->kind == CAN_BANK_LIST32 || cur->kind == CAN_BANK_LIST16) {
+            can_ip->FM1R |= bit;
+        } else {
+            can_ip->FM1R &= ~bit;
+        }
+
+        if (cur->kind == CAN_BANK_MASK32 || cur->kind == CAN_BANK_LIST32) {
+            can_ip->FS1R |= bit;
+        } else {
+            can_ip->FS1R &= ~bit;
+        }
+
+        if (cur->fifo == CAN_RX_FIFO1) {
+            can_ip->FFA1R |= bit;
+        } else {
+            can_ip->FFA1R &= ~bit;
+        }
+
+        can_ip->sFilterRegister[i].FR1 = fr1;
+        can_ip->sFilterRegister[i].FR2 = fr2;
+        can_ip->FA1R |= bit;
+    }
+}
+
+/**
+ * @brief Lay out the subscriptions of the CANs sharing filter banks and write
+ *        them.
+ *
+ * @param can_ip The CAN which has the filter banks.
+ * @param rx1 The receive state of master CAN.
+ * @param rx2 The receive state of slave CAN, NULL if not used.
+ * @param bank_total Number of filter banks.
+ * @param write 0: The CAN is not initialized, only check the layout.
+ * @return Filter status.
+ * @retval - 0: `CAN_FILTER_OK`:      Success.
+ * @retval - 3: `CAN_FILTER_NO_BANK`: The filter banks are not enough.
+ * @note The spare banks are split between master and slave CAN.
+ */
+static uint8_t can_filter_program(CAN_TypeDef *can_ip, can_rx_t *rx1,
+                                  can_rx_t *rx2, uint32_t bank_total,
+                                  uint32_t write) {
+    can_filter_bank_t bank[CAN_FILTER_BANK_NUM];
+    uint32_t n1, n2 = 0, start = bank_total;
+    uint32_t primask;
+
+    n1 = can_filter_layout(rx1, bank, bank_total);
+    if (n1 > bank_total) {
+        return CAN_FILTER_NO_BANK;
+    }
+
+    if (rx2 != NULL) {
+        n2 = can_filter_layout(rx2, bank + n1, bank_total - n1);
+        if (n1 + n2 > bank_total) {
+            return CAN_FILTER_NO_BANK;
+        }
+        start = n1 + (bank_total - n1 - n2) / 2;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    can_filter_route(rx1, bank, n1);
+    if (rx2 != NULL) {
+        can_filter_route(rx2, bank + n1, n2);
+    }
+
+    if (write) {
+        can_ip->FMR |= CAN_FMR_FINIT;
+
+#if defined(CAN2)
+        if (can_ip == CAN1) {
+            can_ip->FMR = (can_ip->FMR & ~CAN_FMR_CAN2SB) |
+                          (start << CAN_FMR_CAN2SB_Pos);
+        }
+#endif /* defined(CAN2) */
+
+        can_filter_write(can_ip, rx1, bank, n1, 0, start);
+        if (rx2 != NULL) {
+            can_filter_write(can_ip, rx2, bank + n1, n2, start, bank_total);
+        }
+
+        can_ip->FMR &= ~CAN_FMR_FINIT;
+    }
+
+    __set_PRIMASK(primask);
+
+    return CAN_FILTER_OK;
+}
+
+#endif /* CAN1_ENABLE || CAN2_ENABLE */
+
+/**
+ * @brief Apply the subscriptions of a CAN to the filter banks. CAN1 and CAN2
+ *        are laid out together because they share the filter banks.
+ *
+ * @param hcan The handle of CAN.
+ * @return Filter status.
+ * @retval - 0: `CAN_FILTER_OK`:      Success.
+ * @retval - 3: `CAN_FILTER_NO_BANK`: The filter banks are not enough.
+ * @retval - 4: `CAN_FILTER_FAIL`:    The CAN doesn't exist.
+ */
+static uint8_t can_filter_apply(CAN_HandleTypeDef *hcan) {
+    UNUSED(hcan);
+
+#if CAN2_ENABLE
+    return can_filter_program(
+        CAN1, &can1_rx, &can2_rx, CAN_FILTER_BANK_NUM,
+        HAL_CAN_GetState(&can1_handle) != HAL_CAN_STATE_RESET ||
+            HAL_CAN_GetState(&can2_handle) != HAL_CAN_STATE_RESET);
+#elif CAN1_ENABLE
+    return can_filter_program(
+        CAN1, &can1_rx, NULL, CAN_FILTER_BANK_NUM,
+        HAL_CAN_GetState(&can1_handle) != HAL_CAN_STATE_RESET);
+#else
+    return CAN_FILTER_FAIL;
+#endif /* CAN2_ENABLE */
+}
+
+#if CAN1_ENABLE || CAN2_ENABLE
+
+/**
+ * @brief Read the frames in a FIFO into the rings of the subscriptions, then
+ *        call the callbacks once.
+ *
+ * @param hcan The handle of CAN.
+ * @param fifo `CAN_RX_FIFO0` or `CAN_RX_FIFO1`.
+ * @note If there is no subscription, `HAL_CAN_IRQHandler` handles it.
+ */
+static void can_rx_irq_handler(CAN_HandleTypeDef *hcan, uint32_t fifo) {
+    can_rx_t *rx = can_rx_get(hcan);
+    can_stat_t *stat = can_stat_find(hcan);
+    CAN_FIFOMailBox_TypeDef *mailbox;
+    volatile uint32_t *rfr;
+    const can_rx_filter_t *filter;
+    can_rx_ring_t *ring;
+    can_frame_t *frame;
+    uint32_t rir, rdtr, data[2];
+    uint32_t touched = 0, lost = 0, overrun = 0;
+    uint32_t index, id, len, head, i, primask;
+
+    if (rx == NULL || rx->filter_num == 0) {
+        HAL_CAN_IRQHandler(hcan);
+        return;
+    }
+
+    mailbox = &hcan->Instance->sFIFOMailBox[fifo];
+    rfr = (fifo == CAN_RX_FIFO0) ? &hcan->Instance->RF0R
+                                 : &hcan->Instance->RF1R;
+
+    while ((*rfr & CAN_RF0R_FMP0) != 0) {
+        rir = mailbox->RIR;
+        rdtr = mailbox->RDTR;
+        id = (rir & CAN_RI0R_IDE) ? (rir >> CAN_RI0R_EXID_Pos)
+                                  : (rir >> CAN_RI0R_STID_Pos);
+        len = rdtr & CAN_RDT0R_DLC;
+        if (len > 8) {
+            len = 8;
+        }
+        if (stat != NULL) {
+            can_stat_frame(stat, rir & CAN_RI0R_IDE, id,
+                           (rir & CAN_RI0R_RTR) ? 0 : len, 0);
+        }
+
+        index = (rdtr & CAN_RDT0R_FMI) >> CAN_RDT0R_FMI_Pos;
+        index = (index < CAN_RX_ROUTE_NUM) ? rx->route[fifo][index]
+                                           : CAN_RX_ROUTE_NONE;
+
+        if (index != CAN_RX_ROUTE_NONE) {
+            filter = &rx->filter[index];
+            ring = filter->ring;
+            head = ring->head;
+
+            if ((rir & CAN_RI0R_IDE) != filter->ide ||
+                (id & filter->mask) != filter->id) {
+                /* Received before the filters changed, drop it. */
+            } else if (head - ring->tail >= ring->size) {
+                ++ring->lost;
+                ++lost;
+            } else {
+                frame = &ring->buf[head & (ring->size - 1)];
+                frame->id = id;
+                frame->ide = (uint8_t)(rir & CAN_RI0R_IDE);
+                frame->rtr = (uint8_t)(rir & CAN_RI0R_RTR);
+                frame->len = (uint8_t)len;
+                data[0] = mailbox->RDLR;
+                data[1] = mailbox->RDHR;
+                memcpy(frame->data, data, sizeof(frame->data));
+
+                __DMB();
+                ring->head = head + 1;
+                touched |= 1U << index;
+            }
+        }
+
+        /* Release the output mailbox, FULL and FOVR are not cleared. */
+        *rfr = CAN_RF0R_RFOM0;
+    }
+
+    if (*rfr & CAN_RF0R_FOVR0) {
+        *rfr = CAN_RF0R_FOVR0;
+        overrun = 1;
+    }
+
+    if (stat != NULL && (lost | overrun) != 0) {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        stat->stats.rx_lost += lost;
+        stat->stats.rx_overrun += overrun;
+        __set_PRIMASK(primask);
+    }
+
+    while (touched != 0) {
+        for (i = 0; (touched & (1U << i)) == 0; ++i) {
+        }
+
+        ring = rx->filter[i].ring;
+        for (; i < rx->filter_num; ++i) {
+            if (rx->filter[i].ring == ring) {
+                touched &= ~(1U << i);
+            }
+        }
+
+        if (ring->callback != NULL) {
+            ring->callback(ring);
+        }
+    }
+}
+
+#endif /* CAN1_ENABLE || CAN2_ENABLE */
+
+/**
+ * @}
+ */
 
 /*****************************************************************************
  * @defgroup CAN1 Functions.
@@ -64,23 +1288,11 @@ uint8_t can1_init(uint32_t baud_rate, uint32_t prop_delay) {
         return CAN_INIT_FAIL;
     }
 
-    CAN_FilterTypeDef can_filter_config;
-
-    can_filter_config.FilterBank = 0;
-    can_filter_config.FilterMode = CAN_FILTERMODE_IDMASK;
-    can_filter_config.FilterScale = CAN_FILTERSCALE_32BIT;
-    can_filter_config.FilterIdHigh = 0x0000;
-    can_filter_config.FilterIdLow = 0x0000;
-    can_filter_config.FilterMaskIdHigh = 0x0000;
-    can_filter_config.FilterMaskIdLow = 0x0000;
-    can_filter_config.FilterActivation = CAN_FILTER_ENABLE;
-    can_filter_config.SlaveStartFilterBank = 0;
-
-#if CAN1_ENABLE_RX0_IT
-    can_filter_config.FilterFIFOAssignment = CAN_FILTER_FIFO0;
-    if (HAL_CAN_ConfigFilter(&can1_handle, &can_filter_config) != HAL_OK) {
+    if (can_filter_apply(&can1_handle) != CAN_FILTER_OK) {
         return CAN_INIT_FILTER_FAIL;
     }
+
+#if CAN1_ENABLE_RX0_IT
     if (HAL_CAN_ActivateNotification(&can1_handle,
                                      CAN_IT_RX_FIFO0_MSG_PENDING) != HAL_OK) {
         return CAN_INIT_NOTIFY_FAIL;
@@ -88,16 +1300,28 @@ uint8_t can1_init(uint32_t baud_rate, uint32_t prop_delay) {
 #endif /* CAN1_ENABLE_RX0_IT */
 
 #if CAN1_ENABLE_RX1_IT
-    can_filter_config.FilterFIFOAssignment = CAN_FILTER_FIFO1;
-    if (HAL_CAN_ConfigFilter(&can1_handle, &can_filter_config) != HAL_OK) {
-        return CAN_INIT_FILTER_FAIL;
-    }
     if (HAL_CAN_ActivateNotification(&can1_handle,
                                      CAN_IT_RX_FIFO1_MSG_PENDING) != HAL_OK) {
         return CAN_INIT_NOTIFY_FAIL;
     }
 #endif /* CAN1_ENABLE_RX1_IT */
 
+#if CAN1_ENABLE_TX_IT
+    if (HAL_CAN_ActivateNotification(&can1_handle,
+                                     CAN_IT_TX_MAILBOX_EMPTY) != HAL_OK) {
+        return CAN_INIT_NOTIFY_FAIL;
+    }
+#endif /* CAN1_ENABLE_TX_IT */
+
+#if CAN1_ENABLE_SCE_IT
+    if (HAL_CAN_ActivateNotification(&can1_handle, CAN_SCE_IT) != HAL_OK) {
+        return CAN_INIT_NOTIFY_FAIL;
+    }
+#endif /* CAN1_ENABLE_SCE_IT */
+
+    can_tx_reset(&can1_tx_queue);
+    can_stat_init(&can1_stat, prescale, tbs1, tbs2);
+
     if (HAL_CAN_Start(&can1_handle) != HAL_OK) {
         return CAN_INIT_START_FAIL;
     }
@@ -112,7 +1336,7 @@ uint8_t can1_init(uint32_t baud_rate, uint32_t prop_delay) {
  *
  */
 void CAN1_TX_IRQHandler(void) {
-    HAL_CAN_IRQHandler(&can1_handle);
+    can_tx_irq_handler(&can1_handle);
 }
 
 #endif /* CAN1_ENABLE_TX_IT */
@@ -124,7 +1348,7 @@ void CAN1_TX_IRQHandler(void) {
  *
  */
 void CAN1_RX0_IRQHandler(void) {
-    HAL_CAN_IRQHandler(&can1_handle);
+    can_rx_irq_handler(&can1_handle, CAN_RX_FIFO0);
 }
 
 #endif /* CAN1_ENABLE_RX0_IT */
@@ -136,7 +1360,7 @@ void CAN1_RX0_IRQHandler(void) {
  *
  */
 void CAN1_RX1_IRQHandler(void) {
-    HAL_CAN_IRQHandler(&can1_handle);
+    can_rx_irq_handler(&can1_handle, CAN_RX_FIFO1);
 }
 
 #endif /* CAN1_ENABLE_RX1_IT */
@@ -148,7 +1372,7 @@ void CAN1_RX1_IRQHandler(void) {
  *
  */
 void CAN1_SCE_IRQHandler(void) {
-    HAL_CAN_IRQHandler(&can1_handle);
+    can_sce_irq_handler(&can1_handle);
 }
 
 #endif /* CAN1_ENABLE_SCE_IT */
@@ -162,7 +1386,7 @@ void CAN1_SCE_IRQHandler(void) {
  * @retval - 2: `CAN_NO_INIT`:     This can is no init.
  */
 uint8_t can1_deinit(void) {
-    if (__HAL_RCC_CAN1_CLK_DISABLE()) {
+    if (!__HAL_RCC_CAN1_IS_CLK_ENABLED()) {
         return CAN_NO_INIT;
     }
 
@@ -170,6 +1394,8 @@ uint8_t can1_deinit(void) {
         return CAN_DEINIT_FAIL;
     }
 
+    can_tx_reset(&can1_tx_queue);
+
     if (HAL_CAN_DeInit(&can1_handle) != HAL_OK) {
         return CAN_DEINIT_FAIL;
     }
@@ -234,23 +1460,11 @@ uint8_t can2_init(uint32_t baud_rate, uint32_t prop_delay) {
         return CAN_INIT_FAIL;
     }
 
-    CAN_FilterTypeDef can_filter_config;
-
-    can_filter_config.FilterBank = 0;
-    can_filter_config.FilterMode = CAN_FILTERMODE_IDMASK;
-    can_filter_config.FilterScale = CAN_FILTERSCALE_32BIT;
-    can_filter_config.FilterIdHigh = 0x0000;
-    can_filter_config.FilterIdLow = 0x0000;
-    can_filter_config.FilterMaskIdHigh = 0x0000;
-    can_filter_config.FilterMaskIdLow = 0x0000;
-    can_filter_config.FilterActivation = CAN_FILTER_ENABLE;
-    can_filter_config.SlaveStartFilterBank = 0;
-
-#if CAN2_ENABLE_RX0_IT
-    can_filter_config.FilterFIFOAssignment = CAN_FILTER_FIFO0;
-    if (HAL_CAN_ConfigFilter(&can2_handle, &can_filter_config) != HAL_OK) {
+    if (can_filter_apply(&can2_handle) != CAN_FILTER_OK) {
         return CAN_INIT_FILTER_FAIL;
     }
+
+#if CAN2_ENABLE_RX0_IT
     if (HAL_CAN_ActivateNotification(&can2_handle,
                                      CAN_IT_RX_FIFO0_MSG_PENDING) != HAL_OK) {
         return CAN_INIT_NOTIFY_FAIL;
@@ -258,16 +1472,28 @@ uint8_t can2_init(uint32_t baud_rate, uint32_t prop_delay) {
 #endif /* CAN2_ENABLE_RX0_IT */
 
 #if CAN2_ENABLE_RX1_IT
-    can_filter_config.FilterFIFOAssignment = CAN_FILTER_FIFO1;
-    if (HAL_CAN_ConfigFilter(&can2_handle, &can_filter_config) != HAL_OK) {
-        return CAN_INIT_FILTER_FAIL;
-    }
     if (HAL_CAN_ActivateNotification(&can2_handle,
                                      CAN_IT_RX_FIFO1_MSG_PENDING) != HAL_OK) {
         return CAN_INIT_NOTIFY_FAIL;
     }
 #endif /* CAN2_ENABLE_RX1_IT */
 
+#if CAN2_ENABLE_TX_IT
+    if (HAL_CAN_ActivateNotification(&can2_handle,
+                                     CAN_IT_TX_MAILBOX_EMPTY) != HAL_OK) {
+        return CAN_INIT_NOTIFY_FAIL;
+    }
+#endif /* CAN2_ENABLE_TX_IT */
+
+#if CAN2_ENABLE_SCE_IT
+    if (HAL_CAN_ActivateNotification(&can2_handle, CAN_SCE_IT) != HAL_OK) {
+        return CAN_INIT_NOTIFY_FAIL;
+    }
+#endif /* CAN2_ENABLE_SCE_IT */
+
+    can_tx_reset(&can2_tx_queue);
+    can_stat_init(&can2_stat, prescale, tbs1, tbs2);
+
     if (HAL_CAN_Start(&can2_handle) != HAL_OK) {
         return CAN_INIT_START_FAIL;
     }
@@ -282,7 +1508,7 @@ uint8_t can2_init(uint32_t baud_rate, uint32_t prop_delay) {
  *
  */
 void CAN2_TX_IRQHandler(void) {
-    HAL_CAN_IRQHandler(&can2_handle);
+    can_tx_irq_handler(&can2_handle);
 }
 
 #endif /* CAN2_ENABLE_TX_IT */
@@ -294,7 +1520,7 @@ void CAN2_TX_IRQHandler(void) {
  *
  */
 void CAN2_RX0_IRQHandler(void) {
-    HAL_CAN_IRQHandler(&can2_handle);
+    can_rx_irq_handler(&can2_handle, CAN_RX_FIFO0);
 }
 
 #endif /* CAN2_ENABLE_RX0_IT */
@@ -306,7 +1532,7 @@ void CAN2_RX0_IRQHandler(void) {
  *
  */
 void CAN2_RX1_IRQHandler(void) {
-    HAL_CAN_IRQHandler(&can2_handle);
+    can_rx_irq_handler(&can2_handle, CAN_RX_FIFO1);
 }
 
 #endif /* CAN2_ENABLE_RX1_IT */
@@ -318,7 +1544,7 @@ void CAN2_RX1_IRQHandler(void) {
  *
  */
 void CAN2_SCE_IRQHandler(void) {
-    HAL_CAN_IRQHandler(&can2_handle);
+    can_sce_irq_handler(&can2_handle);
 }
 
 #endif /* CAN2_ENABLE_SCE_IT */
@@ -332,7 +1558,7 @@ void CAN2_SCE_IRQHandler(void) {
  * @retval - 2: `CAN_NO_INIT`:     This can is no init.
  */
 uint8_t can2_deinit(void) {
-    if (__HAL_RCC_CAN2_CLK_DISABLE()) {
+    if (HAL_CAN_GetState(&can2_handle) == HAL_CAN_STATE_RESET) {
         return CAN_NO_INIT;
     }
 
@@ -340,6 +1566,8 @@ uint8_t can2_deinit(void) {
         return CAN_DEINIT_FAIL;
     }
 
+    can_tx_reset(&can2_tx_queue);
+
     if (HAL_CAN_DeInit(&can2_handle) != HAL_OK) {
         return CAN_DEINIT_FAIL;
     }
@@ -630,7 +1858,7 @@ uint8_t can_rate_calc(uint32_t baud_rate, uint32_t prop_delay,
  * @param can_selected Specific which can will to get.
  * @return The handle of CAN. return NULL which the CAN doesn't exist.
  */
-CAN_HandleTypeDef *can_get_handle(can_selected_t can_select) {
+CAN_HandleTypeDef *can_get_handle(can_selected_t can_selected) {
     switch (can_selected) {
 
 #if CAN1_ENABLE
@@ -649,65 +1877,137 @@ CAN_HandleTypeDef *can_get_handle(can_selected_t can_select) {
 }
 
 /**
- * @brief CAN send message.
+ * @brief Put a frame into the transmit queue, don't wait.
  *
  * @param can_selected Specific which CAN to send message.
- * @param can_ide Specific standard ID or Extend ID.
- * @param id Specific message id.
- * @param len Specific message length.
- * @param msg Specific message content.
+ * @param frame The frame, it is copied into queue.
  * @return Send status.
- * @retval - 0: Success.
- * @retval - 1: Send error.
- * @retval - 2: Timeout.
- * @retval - 3: Parameter invalid.
- * @retval - 4: This CAN is not initialized.
+ * @retval - 0: `CAN_SEND_OK`:         Success.
+ * @retval - 2: `CAN_SEND_QUEUE_FULL`: The transmit queue is full.
+ * @retval - 3: `CAN_SEND_PARAM_ERR`:  Parameter invalid.
+ * @retval - 4: `CAN_SEND_NO_INIT`:    This CAN is not initialized.
+ * @note The frames are sent by the order of arbitration field (the same as
+ *       the bus priority), frames with the same ID keep the order. If TX
+ *       interrupt is disabled, the queue is only sent in this function.
  */
-uint8_t can_send_message(can_selected_t can_selected, uint32_t can_ide,
-                         uint32_t id, uint8_t len, const uint8_t *msg) {
+uint8_t can_send(can_selected_t can_selected, const can_frame_t *frame) {
     CAN_HandleTypeDef *can_handle = can_get_handle(can_selected);
-    if (can_handle == NULL) {
-        return 3;
+    can_tx_queue_t *queue;
+    can_tx_item_t item;
+    uint32_t primask;
+    uint8_t res = CAN_SEND_OK;
+
+    if (can_handle == NULL || frame == NULL) {
+        return CAN_SEND_PARAM_ERR;
     }
 
-    if (len > 8) {
-        return 3;
+    if (frame->len > 8 ||
+        (frame->ide == CAN_ID_STD ? frame->id > 0x7FFU
+                                  : frame->id > 0x1FFFFFFFU)) {
+        return CAN_SEND_PARAM_ERR;
     }
 
     if (HAL_CAN_GetState(can_handle) == HAL_CAN_STATE_RESET) {
-        return 4;
+        return CAN_SEND_NO_INIT;
     }
 
-    uint16_t wait_time = 0;
-    uint32_t tx_mail_box = CAN_TX_MAILBOX0;
-
-    static CAN_TxHeaderTypeDef tx_header;
-    tx_header.IDE = can_ide;
-    tx_header.RTR = CAN_RTR_DATA;
-    tx_header.DLC = len;
-    if (can_ide == CAN_ID_STD) {
-        tx_header.StdId = id;
+    queue = can_tx_get_queue(can_handle);
+    item.key = can_tx_key(frame);
+    item.time = DWT->CYCCNT;
+    item.frame = *frame;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    can_tx_collect(can_handle, queue, 0);
+    /* Keep space for the frames being aborted. */
+    if (queue->count + can_tx_mailbox_num(queue->abort) >= CAN_TX_QUEUE_SIZE) {
+        ++can_stat_find(can_handle)->stats.tx_dropped;
+        res = CAN_SEND_QUEUE_FULL;
     } else {
-        tx_header.ExtId = id;
+        can_tx_insert(queue, &item, 0);
     }
+    can_tx_refill(can_handle, queue);
+    __set_PRIMASK(primask);
+
+    return res;
+}
+
+/**
+ * @brief Put a frame into the transmit queue, wait if the queue is full.
+ *
+ * @param can_selected Specific which CAN to send message.
+ * @param frame The frame, it is copied into queue.
+ * @param timeout Maximum time to wait. Unit: ms.
+ * @return Send status.
+ * @retval - 0: `CAN_SEND_OK`:         Success.
+ * @retval - 2: `CAN_SEND_QUEUE_FULL`: Timeout, the transmit queue is full.
+ * @retval - 3: `CAN_SEND_PARAM_ERR`:  Parameter invalid.
+ * @retval - 4: `CAN_SEND_NO_INIT`:    This CAN is not initialized.
+ */
+uint8_t can_send_timeout(can_selected_t can_selected, const can_frame_t *frame,
+                         uint32_t timeout) {
+    uint32_t tick_start = HAL_GetTick();
+    uint8_t res;
 
-    while (HAL_CAN_GetTxMailboxesFreeLevel(can_handle) == 0) {
-        /* Wait to all mailbox is empty. */
-        ++wait_time;
-        if (wait_time > CAN_SEND_TIMEOUT) {
-            return 2;
+    while ((res = can_send(can_selected, frame)) == CAN_SEND_QUEUE_FULL) {
+        if (HAL_GetTick() - tick_start >= timeout) {
+            break;
         }
     }
 
-    if (HAL_CAN_AddTxMessage(can_handle, &tx_header, msg, &tx_mail_box) !=
-        HAL_OK) {
-        return 1;
+    return res;
+}
+
+/**
+ * @brief Get the number of frames not sent yet.
+ *
+ * @param can_selected Specific which CAN.
+ * @return Number of frames in the transmit queue and mailboxes.
+ */
+uint32_t can_tx_pending(can_selected_t can_selected) {
+    CAN_HandleTypeDef *can_handle = can_get_handle(can_selected);
+    can_tx_queue_t *queue;
+    uint32_t primask, count;
+
+    if (can_handle == NULL) {
+        return 0;
     }
-    return 0;
+
+    queue = can_tx_get_queue(can_handle);
+    primask = __get_PRIMASK();
+    __disable_irq();
+    can_tx_collect(can_handle, queue, 0);
+    can_tx_refill(can_handle, queue);
+    count = queue->count + can_tx_mailbox_num(queue->busy);
+    __set_PRIMASK(primask);
+
+    return count;
 }
 
 /**
- * @brief CAN send remote message.
+ * @brief Set the function called after a frame is sent, it can put the next
+ *        frames into the transmit queue.
+ *
+ * @param can_selected Specific which CAN.
+ * @param callback Called in CAN TX interrupt after a mailbox is sent, NULL:
+ *                 no callback.
+ * @note It is only called when TX interrupt is enabled.
+ */
+void can_set_tx_callback(can_selected_t can_selected,
+                         void (*callback)(can_selected_t can_selected)) {
+    CAN_HandleTypeDef *can_handle = can_get_handle(can_selected);
+    can_tx_queue_t *queue;
+
+    if (can_handle == NULL) {
+        return;
+    }
+
+    queue = can_tx_get_queue(can_handle);
+    queue->callback = callback;
+}
+
+/**
+ * @brief CAN send message.
  *
  * @param can_selected Specific which CAN to send message.
  * @param can_ide Specific standard ID or Extend ID.
@@ -716,53 +2016,484 @@ uint8_t can_send_message(can_selected_t can_selected, uint32_t can_ide,
  * @param msg Specific message content.
  * @return Send status.
  * @retval - 0: Success.
- * @retval - 1: Send error.
- * @retval - 2: Timeout.
+ * @retval - 2: The transmit queue is full.
+ * @retval - 3: Parameter invalid.
+ * @retval - 4: This CAN is not initialized.
+ * @note The message is put into the transmit queue, see `can_send`.
+ */
+uint8_t can_send_message(can_selected_t can_selected, uint32_t can_ide,
+                         uint32_t id, uint8_t len, const uint8_t *msg) {
+    can_frame_t frame = {.id = id,
+                         .ide = (uint8_t)can_ide,
+                         .rtr = CAN_RTR_DATA,
+                         .len = len};
+
+    if (len > 8 || (len > 0 && msg == NULL)) {
+        return CAN_SEND_PARAM_ERR;
+    }
+    memcpy(frame.data, msg, len);
+
+    return can_send(can_selected, &frame);
+}
+
+/**
+ * @brief CAN send remote message.
+ *
+ * @param can_selected Specific which CAN to send message.
+ * @param can_ide Specific standard ID or Extend ID.
+ * @param id Specific message id.
+ * @param len Specific message length.
+ * @param msg Specific message content, remote frame has no data, can be NULL.
+ * @return Send status.
+ * @retval - 0: Success.
+ * @retval - 2: The transmit queue is full.
  * @retval - 3: Parameter invalid.
  * @retval - 4: This CAN is not initialized.
+ * @note The message is put into the transmit queue, see `can_send`.
  */
 uint8_t can_send_remote(can_selected_t can_selected, uint32_t can_ide,
                         uint32_t id, uint8_t len, const uint8_t *msg) {
+    can_frame_t frame = {.id = id,
+                         .ide = (uint8_t)can_ide,
+                         .rtr = CAN_RTR_REMOTE,
+                         .len = len};
+
+    UNUSED(msg);
+
+    return can_send(can_selected, &frame);
+}
+
+/**
+ * @brief Initialize a receive ring.
+ *
+ * @param ring The ring.
+ * @param buf Frames buffer.
+ * @param size Number of frames, must be power of 2.
+ * @param callback Called in CAN RX interrupt after frames are put into the
+ *                 ring, can be NULL.
+ * @return Init status.
+ * @retval - 0: `CAN_FILTER_OK`:        Success.
+ * @retval - 1: `CAN_FILTER_PARAM_ERR`: Parameter invalid.
+ */
+uint8_t can_rx_ring_init(can_rx_ring_t *ring, can_frame_t *buf, uint32_t size,
+                         void (*callback)(can_rx_ring_t *ring)) {
+    if (ring == NULL || buf == NULL || size == 0 || (size & (size - 1)) != 0) {
+        return CAN_FILTER_PARAM_ERR;
+    }
+
+    ring->buf = buf;
+    ring->size = size;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->lost = 0;
+    ring->callback = callback;
+
+    return CAN_FILTER_OK;
+}
+
+/**
+ * @brief Get the oldest frame in the ring without copying.
+ *
+ * @param ring The ring.
+ * @return The frame, it is valid until `can_rx_ring_pop`. return NULL if the
+ *         ring is empty.
+ */
+can_frame_t *can_rx_ring_peek(can_rx_ring_t *ring) {
+    uint32_t tail = ring->tail;
+
+    if (ring->head == tail) {
+        return NULL;
+    }
+
+    __DMB();
+    return &ring->buf[tail & (ring->size - 1)];
+}
+
+/**
+ * @brief Remove the oldest frame in the ring.
+ *
+ * @param ring The ring.
+ */
+void can_rx_ring_pop(can_rx_ring_t *ring) {
+    uint32_t tail = ring->tail;
+
+    if (ring->head == tail) {
+        return;
+    }
+
+    __DMB();
+    ring->tail = tail + 1;
+}
+
+/**
+ * @brief Get the number of frames in the ring.
+ *
+ * @param ring The ring.
+ * @return Number of frames.
+ */
+uint32_t can_rx_ring_count(can_rx_ring_t *ring) {
+    return ring->head - ring->tail;
+}
+
+/**
+ * @brief Receive the frames matched ID and mask into a ring.
+ *
+ * @param can_selected Specific which CAN.
+ * @param can_ide Specific standard ID or Extend ID.
+ * @param id The ID.
+ * @param mask The bits set must match, all bits set: only this ID and data
+ *             frame.
+ * @param fifo `CAN_RX_FIFO0` or `CAN_RX_FIFO1`, the interrupt of this FIFO
+ *             must be enabled.
+ * @param ring The ring, initialized by `can_rx_ring_init`. A ring can
+ *             subscribe many times.
+ * @return Subscribe status.
+ * @retval - 0: `CAN_FILTER_OK`:        Success.
+ * @retval - 1: `CAN_FILTER_PARAM_ERR`: Parameter invalid.
+ * @retval - 2: `CAN_FILTER_FULL`:      Too many subscriptions.
+ * @retval - 3: `CAN_FILTER_NO_BANK`:   The filter banks are not enough.
+ * @retval - 4: `CAN_FILTER_FAIL`:      The CAN doesn't exist.
+ * @note The filter banks are packed again. After the first subscription, the
+ *       frames not subscribed are dropped by hardware, and the FIFO is read
+ *       in the RX interrupt instead of `HAL_CAN_RxFifoxMsgPendingCallback`.
+ */
+uint8_t can_rx_subscribe(can_selected_t can_selected, uint32_t can_ide,
+                         uint32_t id, uint32_t mask, uint32_t fifo,
+                         can_rx_ring_t *ring) {
     CAN_HandleTypeDef *can_handle = can_get_handle(can_selected);
-    if (can_handle == NULL) {
-        return 3;
+    uint32_t max_id = (can_ide == CAN_ID_STD) ? 0x7FFU : 0x1FFFFFFFU;
+    can_rx_filter_t *filter;
+    can_rx_t *rx;
+    uint32_t primask;
+    uint8_t res;
+
+    if (can_handle == NULL || ring == NULL || ring->buf == NULL) {
+        return CAN_FILTER_PARAM_ERR;
     }
 
-    if (len > 8) {
-        return 3;
+    if ((can_ide != CAN_ID_STD && can_ide != CAN_ID_EXT) || id > max_id ||
+        mask > max_id) {
+        return CAN_FILTER_PARAM_ERR;
     }
 
-    if (HAL_CAN_GetState(can_handle) == HAL_CAN_STATE_RESET) {
-        return 4;
+    rx = can_rx_get(can_handle);
+    if ((fifo != CAN_RX_FIFO0 && fifo != CAN_RX_FIFO1) ||
+        (rx->rx_it & (1U << fifo)) == 0) {
+        return CAN_FILTER_PARAM_ERR;
     }
 
-    uint16_t wait_time = 0;
-    uint32_t tx_mail_box = CAN_TX_MAILBOX0;
+    primask = __get_PRIMASK();
+    __disable_irq();
 
-    static CAN_TxHeaderTypeDef tx_header;
-    tx_header.IDE = can_ide;
-    tx_header.RTR = CAN_RTR_REMOTE;
-    tx_header.DLC = len;
-    if (can_ide == CAN_ID_STD) {
-        tx_header.StdId = id;
+    if (rx->filter_num >= CAN_RX_FILTER_NUM) {
+        res = CAN_FILTER_FULL;
     } else {
-        tx_header.ExtId = id;
+        filter = &rx->filter[rx->filter_num++];
+        filter->id = id & mask;
+        filter->mask = mask;
+        filter->ide = (uint8_t)can_ide;
+        filter->fifo = (uint8_t)fifo;
+        filter->ring = ring;
+
+        res = can_filter_apply(can_handle);
+        if (res != CAN_FILTER_OK) {
+            --rx->filter_num;
+            can_filter_apply(can_handle);
+        }
+    }
+
+    __set_PRIMASK(primask);
+
+    return res;
+}
+
+/**
+ * @brief Remove all subscriptions of a ring.
+ *
+ * @param can_selected Specific which CAN.
+ * @param ring The ring.
+ * @return Unsubscribe status.
+ * @retval - 0: `CAN_FILTER_OK`:        Success.
+ * @retval - 1: `CAN_FILTER_PARAM_ERR`: Parameter invalid.
+ * @retval - 3: `CAN_FILTER_NO_BANK`:   The filter banks are not enough.
+ * @retval - 4: `CAN_FILTER_FAIL`:      The CAN doesn't exist.
+ * @note When the ring returns, it will not be written by interrupt any more.
+ *       If there is no subscription left, all frames are accepted as before.
+ */
+uint8_t can_rx_unsubscribe(can_selected_t can_selected, can_rx_ring_t *ring) {
+    CAN_HandleTypeDef *can_handle = can_get_handle(can_selected);
+    can_rx_t *rx;
+    uint32_t primask, i, n = 0;
+    uint8_t res;
+
+    if (can_handle == NULL || ring == NULL) {
+        return CAN_FILTER_PARAM_ERR;
     }
 
-    while (HAL_CAN_GetTxMailboxesFreeLevel(can_handle) == 0) {
-        /* Wait to all mailbox is empty. */
-        ++wait_time;
-        if (wait_time > CAN_SEND_TIMEOUT) {
-            return 2;
+    rx = can_rx_get(can_handle);
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    for (i = 0; i < rx->filter_num; ++i) {
+        if (rx->filter[i].ring != ring) {
+            rx->filter[n++] = rx->filter[i];
         }
     }
+    rx->filter_num = n;
+    res = can_filter_apply(can_handle);
 
-    if (HAL_CAN_AddTxMessage(can_handle, &tx_header, msg, &tx_mail_box) !=
-        HAL_OK) {
-        return 1;
+    __set_PRIMASK(primask);
+
+    return res;
+}
+
+/**
+ * @brief Read the statistics.
+ *
+ * @param can_selected Specific which CAN.
+ * @param[out] stats The statistics.
+ * @return Read status.
+ * @retval - 0: `CAN_STATS_OK`:        Success.
+ * @retval - 1: `CAN_STATS_PARAM_ERR`: Parameter invalid.
+ * @note The bus load is the average since the last call at least 100ms ago,
+ *       it is estimated from the frames sent and received by this CAN
+ *       without stuff bits. Received frames are only counted when there is
+ *       a subscription (`can_rx_subscribe`), otherwise they are read by HAL.
+ *       The wait time is exact when TX interrupt is enabled, otherwise a
+ *       frame is found sent in the next `can_send`.
+ */
+uint8_t can_stats_get(can_selected_t can_selected, can_stats_t *stats) {
+    CAN_HandleTypeDef *can_handle = can_get_handle(can_selected);
+    uint32_t cycle_per_us = SystemCoreClock / 1000000U;
+    uint32_t now = HAL_GetTick();
+    can_stat_t *stat;
+    uint32_t primask, elapsed;
+
+    if (can_handle == NULL || stats == NULL) {
+        return CAN_STATS_PARAM_ERR;
     }
 
-    return 0;
+    stat = can_stat_find(can_handle);
+    if (HAL_CAN_GetState(can_handle) != HAL_CAN_STATE_RESET) {
+        can_stat_update(can_handle, stat, 0);
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    elapsed = now - stat->load_tick;
+    if (elapsed >= 100) {
+        /* Busy time (ns) / elapsed time (ns) in 0.1% */
+        stat->stats.load = (uint32_t)(stat->load_bits * stat->bit_time /
+                                      ((uint64_t)elapsed * 1000U));
+        stat->load_bits = 0;
+        stat->load_tick = now;
+    }
+    stat->stats.tx_wait_avg =
+        (stat->wait_num == 0)
+            ? 0
+            : (uint32_t)(stat->wait_sum / stat->wait_num / cycle_per_us);
+    stat->stats.tx_wait_max = stat->wait_max / cycle_per_us;
+    *stats = stat->stats;
+    __set_PRIMASK(primask);
+
+    return CAN_STATS_OK;
+}
+
+/**
+ * @brief Clear the counters, the ID ranges are kept.
+ *
+ * @param can_selected Specific which CAN.
+ */
+void can_stats_reset(can_selected_t can_selected) {
+    CAN_HandleTypeDef *can_handle = can_get_handle(can_selected);
+    uint32_t primask;
+
+    if (can_handle == NULL) {
+        return;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    can_stat_clear(can_stat_find(can_handle));
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Count the frames of an ID range separately.
+ *
+ * @param can_selected Specific which CAN.
+ * @param index Index of the range, 0 to `CAN_STATS_RANGE_NUM - 1`.
+ * @param can_ide Specific standard ID or Extend ID.
+ * @param id_min The smallest ID.
+ * @param id_max The largest ID, smaller than `id_min` to stop counting.
+ * @return Set status.
+ * @retval - 0: `CAN_STATS_OK`:        Success.
+ * @retval - 1: `CAN_STATS_PARAM_ERR`: Parameter invalid.
+ */
+uint8_t can_stats_set_range(can_selected_t can_selected, uint32_t index,
+                            uint32_t can_ide, uint32_t id_min,
+                            uint32_t id_max) {
+    CAN_HandleTypeDef *can_handle = can_get_handle(can_selected);
+    can_stats_range_t *range;
+    uint32_t primask;
+
+    if (can_handle == NULL || index >= CAN_STATS_RANGE_NUM ||
+        (can_ide != CAN_ID_STD && can_ide != CAN_ID_EXT)) {
+        return CAN_STATS_PARAM_ERR;
+    }
+
+    range = &can_stat_find(can_handle)->stats.range[index];
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    memset(range, 0, sizeof(can_stats_range_t));
+    range->ide = (uint8_t)can_ide;
+    range->id_min = id_min;
+    range->id_max = id_max;
+    __set_PRIMASK(primask);
+
+    return CAN_STATS_OK;
+}
+
+/**
+ * @brief Print the statistics.
+ *
+ * @param can_selected Specific which CAN.
+ * @param print The print function, such as `printf` or `usb_cdc_printf`.
+ * @note The bus load is updated, see `can_stats_get`.
+ */
+void can_stats_print(can_selected_t can_selected,
+                     int (*print)(const char *fmt, ...)) {
+    static const char *const state_name[] = {"error active", "error warning",
+                                             "error passive", "bus-off"};
+    static const char *const error_name[] = {
+        "none", "stuff", "form", "ack", "bit recessive", "bit dominant", "crc",
+        "none"};
+    const can_stats_range_t *range;
+    can_stats_t stats;
+    uint32_t i;
+
+    if (print == NULL || can_stats_get(can_selected, &stats) != CAN_STATS_OK) {
+        return;
+    }
+
+    print("CAN%u: %s, TEC %u, REC %u, load %lu.%lu%%\r\n",
+          (unsigned int)can_selected + 1, state_name[stats.state], stats.tec,
+          stats.rec, (unsigned long)stats.load / 10,
+          (unsigned long)stats.load % 10);
+    print("  tx: %lu frames, %lu bytes, %lu dropped, %lu retried, "
+          "wait avg %lu us, max %lu us\r\n",
+          (unsigned long)stats.tx_frames, (unsigned long)stats.tx_bytes,
+          (unsigned long)stats.tx_dropped, (unsigned long)stats.tx_retry,
+          (unsigned long)stats.tx_wait_avg, (unsigned long)stats.tx_wait_max);
+    print("  rx: %lu frames, %lu bytes, %lu overrun, %lu lost\r\n",
+          (unsigned long)stats.rx_frames, (unsigned long)stats.rx_bytes,
+          (unsigned long)stats.rx_overrun, (unsigned long)stats.rx_lost);
+    print("  errors: %lu, last %s, warning %lu, passive %lu (%lu ms), "
+          "bus-off %lu (%lu ms), recovered %lu (%lu ms)\r\n",
+          (unsigned long)stats.errors, error_name[stats.last_error],
+          (unsigned long)stats.warning_count,
+          (unsigned long)stats.passive_count,
+          (unsigned long)stats.passive_tick,
+          (unsigned long)stats.bus_off_count,
+          (unsigned long)stats.bus_off_tick,
+          (unsigned long)stats.recover_count,
+          (unsigned long)stats.recover_tick);
+
+    for (i = 0; i < CAN_STATS_RANGE_NUM; ++i) {
+        range = &stats.range[i];
+        if (range->id_max < range->id_min) {
+            continue;
+        }
+
+        print("  %s 0x%lX-0x%lX: tx %lu frames %lu bytes, rx %lu frames "
+              "%lu bytes\r\n",
+              (range->ide == CAN_ID_STD) ? "std" : "ext",
+              (unsigned long)range->id_min, (unsigned long)range->id_max,
+              (unsigned long)range->tx_frames, (unsigned long)range->tx_bytes,
+              (unsigned long)range->rx_frames, (unsigned long)range->rx_bytes);
+    }
+}
+
+/**
+ * @brief Set how to leave bus-off.
+ *
+ * @param can_selected Specific which CAN.
+ * @param mode Recovery mode.
+ *  @arg `CAN_BUS_OFF_MANUAL`: Stay in bus-off until `can_bus_off_recover`,
+ *                             this is the default.
+ *  @arg `CAN_BUS_OFF_AUTO`:   Hardware recovers after 128 x 11 recessive
+ *                             bits, the queued frames are sent after that.
+ * @return Set status.
+ * @retval - 0: `CAN_STATS_OK`:        Success.
+ * @retval - 1: `CAN_STATS_PARAM_ERR`: Parameter invalid.
+ * @note It can be called before or after the CAN is initialized.
+ */
+uint8_t can_set_bus_off_recovery(can_selected_t can_selected, uint8_t mode) {
+    CAN_HandleTypeDef *can_handle = can_get_handle(can_selected);
+
+    if (can_handle == NULL ||
+        (mode != CAN_BUS_OFF_MANUAL && mode != CAN_BUS_OFF_AUTO)) {
+        return CAN_STATS_PARAM_ERR;
+    }
+
+    can_handle->Init.AutoBusOff =
+        (mode == CAN_BUS_OFF_AUTO) ? ENABLE : DISABLE;
+
+    if (HAL_CAN_GetState(can_handle) != HAL_CAN_STATE_RESET) {
+        if (mode == CAN_BUS_OFF_AUTO) {
+            SET_BIT(can_handle->Instance->MCR, CAN_MCR_ABOM);
+        } else {
+            CLEAR_BIT(can_handle->Instance->MCR, CAN_MCR_ABOM);
+        }
+    }
+
+    return CAN_STATS_OK;
+}
+
+/**
+ * @brief Leave bus-off in `CAN_BUS_OFF_MANUAL` mode.
+ *
+ * @param can_selected Specific which CAN.
+ * @return Recover status.
+ * @retval - 0: `CAN_STATS_OK`:        Success or not in bus-off.
+ * @retval - 1: `CAN_STATS_PARAM_ERR`: Parameter invalid.
+ * @retval - 2: `CAN_STATS_NO_INIT`:   This CAN is not started.
+ * @retval - 3: `CAN_STATS_FAIL`:      Restart failed.
+ * @note The frames not sent are dropped, they are out of date. The hardware
+ *       still waits 128 x 11 recessive bits before sending.
+ */
+uint8_t can_bus_off_recover(can_selected_t can_selected) {
+    CAN_HandleTypeDef *can_handle = can_get_handle(can_selected);
+    uint32_t primask;
+
+    if (can_handle == NULL) {
+        return CAN_STATS_PARAM_ERR;
+    }
+
+    if (HAL_CAN_GetState(can_handle) != HAL_CAN_STATE_LISTENING) {
+        return CAN_STATS_NO_INIT;
+    }
+
+    if ((can_handle->Instance->ESR & CAN_ESR_BOFF) == 0) {
+        return CAN_STATS_OK;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    HAL_CAN_AbortTxRequest(can_handle, CAN_TX_MAILBOX0 | CAN_TX_MAILBOX1 |
+                                           CAN_TX_MAILBOX2);
+    can_tx_reset(can_tx_get_queue(can_handle));
+    __set_PRIMASK(primask);
+
+    /* Request initialization mode and leave it to start the recovery. */
+    if (HAL_CAN_Stop(can_handle) != HAL_OK ||
+        HAL_CAN_Start(can_handle) != HAL_OK) {
+        return CAN_STATS_FAIL;
+    }
+
+    return CAN_STATS_OK;
 }
 
 /**
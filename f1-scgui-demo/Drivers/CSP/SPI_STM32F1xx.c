@@ -878,3 +878,413 @@ uint8_t spi_change_speed(SPI_HandleTypeDef *hspi, uint8_t speed) {
 /**
  * @}
  */
+
+/*****************************************************************************
+ * @defgroup SPI bus.
+ * @note Devices on one SPI queue their transfers with `spi_bus_submit`, the
+ *       bus sets CS, clock mode and speed of each transfer and runs them one
+ *       after another by DMA (both `SPIx_RX_DMA` and `SPIx_TX_DMA`, or only
+ *       TX DMA for send only transfers), interrupt (`SPIx_IT_ENABLE`) or
+ *       polling. The next transfer is started in the interrupt of the last
+ *       one, no lock is needed by the devices. Only 8 bit master mode is
+ *       supported. Don't call `spi_rw_one_byte` on a SPI in use by the bus.
+ * @{
+ */
+
+/**
+ * @brief Queue of a SPI.
+ */
+typedef struct {
+    SPI_HandleTypeDef *hspi;  /*!< The handle of SPI */
+    uint8_t it;               /*!< SPI interrupt is enabled */
+    volatile uint8_t running; /*!< The queue is being transferred */
+    volatile uint8_t async;   /*!< `head` is transferred by DMA or interrupt */
+    spi_xfer_t *head;         /*!< Transfer in progress */
+    spi_xfer_t *tail;         /*!< Last transfer in the queue */
+} spi_bus_t;
+
+#if SPI1_ENABLE
+static spi_bus_t spi1_bus = {.hspi = &spi1_handle, .it = SPI1_IT_ENABLE};
+#endif /* SPI1_ENABLE */
+
+#if SPI2_ENABLE
+static spi_bus_t spi2_bus = {.hspi = &spi2_handle, .it = SPI2_IT_ENABLE};
+#endif /* SPI2_ENABLE */
+
+#if SPI3_ENABLE
+static spi_bus_t spi3_bus = {.hspi = &spi3_handle, .it = SPI3_IT_ENABLE};
+#endif /* SPI3_ENABLE */
+
+/**
+ * @brief Get the queue of a SPI.
+ *
+ * @param hspi The handle of SPI.
+ * @return The queue. return NULL which the SPI doesn't exist.
+ */
+static spi_bus_t *spi_bus_find(SPI_HandleTypeDef *hspi) {
+#if SPI1_ENABLE
+    if (hspi == &spi1_handle) {
+        return &spi1_bus;
+    }
+#endif /* SPI1_ENABLE */
+
+#if SPI2_ENABLE
+    if (hspi == &spi2_handle) {
+        return &spi2_bus;
+    }
+#endif /* SPI2_ENABLE */
+
+#if SPI3_ENABLE
+    if (hspi == &spi3_handle) {
+        return &spi3_bus;
+    }
+#endif /* SPI3_ENABLE */
+
+    UNUSED(hspi);
+    return NULL;
+}
+
+/**
+ * @brief Set the clock mode and speed, SPI is disabled only when they change.
+ *
+ * @param hspi The handle of SPI.
+ * @param clk_mode Clock mode.
+ * @param speed `SPI_BAUDRATEPRESCALER_x`.
+ */
+static void spi_bus_config(SPI_HandleTypeDef *hspi, uint32_t clk_mode,
+                           uint32_t speed) {
+    uint32_t mask = SPI_CR1_CPHA | SPI_CR1_CPOL | SPI_CR1_BR;
+    uint32_t cr1 = hspi->Instance->CR1;
+
+    /* Bit 0 of clock mode is CPHA and bit 1 is CPOL, the same as CR1. */
+    clk_mode &= SPI_CR1_CPHA | SPI_CR1_CPOL;
+
+    if ((cr1 & mask) == (clk_mode | speed)) {
+        return;
+    }
+
+    __HAL_SPI_DISABLE(hspi);
+    hspi->Instance->CR1 = (cr1 & ~(mask | SPI_CR1_SPE)) | clk_mode | speed;
+
+    hspi->Init.CLKPhase = clk_mode & SPI_CR1_CPHA;
+    hspi->Init.CLKPolarity = clk_mode & SPI_CR1_CPOL;
+    hspi->Init.BaudRatePrescaler = speed;
+}
+
+/**
+ * @brief Start a transfer.
+ *
+ * @param bus The queue.
+ * @param xfer The transfer.
+ * @return `SPI_BUS_PENDING`: Started by DMA or interrupt; `SPI_BUS_OK` or
+ *         `SPI_BUS_ERROR`: Done by polling.
+ */
+static uint8_t spi_bus_start(spi_bus_t *bus, spi_xfer_t *xfer) {
+    SPI_HandleTypeDef *hspi = bus->hspi;
+    uint8_t *tx_buf = (uint8_t *)xfer->tx_buf;
+    uint8_t *rx_buf = xfer->rx_buf;
+    uint16_t len = (uint16_t)xfer->len;
+    HAL_StatusTypeDef res;
+
+    spi_bus_config(hspi, xfer->clk_mode, xfer->speed);
+
+    if (xfer->cs_port != NULL) {
+        HAL_GPIO_WritePin(xfer->cs_port, xfer->cs_pin, GPIO_PIN_RESET);
+    }
+
+    /* The receive functions of HAL send the receive buffer in master mode. */
+    if (hspi->hdmatx != NULL && (rx_buf == NULL || hspi->hdmarx != NULL)) {
+        bus->async = 1;
+        if (rx_buf == NULL) {
+            res = HAL_SPI_Transmit_DMA(hspi, tx_buf, len);
+        } else if (tx_buf == NULL) {
+            res = HAL_SPI_Receive_DMA(hspi, rx_buf, len);
+        } else {
+            res = HAL_SPI_TransmitReceive_DMA(hspi, tx_buf, rx_buf, len);
+        }
+    } else if (bus->it) {
+        bus->async = 1;
+        if (rx_buf == NULL) {
+            res = HAL_SPI_Transmit_IT(hspi, tx_buf, len);
+        } else if (tx_buf == NULL) {
+            res = HAL_SPI_Receive_IT(hspi, rx_buf, len);
+        } else {
+            res = HAL_SPI_TransmitReceive_IT(hspi, tx_buf, rx_buf, len);
+        }
+    } else {
+        if (rx_buf == NULL) {
+            res = HAL_SPI_Transmit(hspi, tx_buf, len, SPI_BUS_POLL_TIMEOUT);
+        } else if (tx_buf == NULL) {
+            res = HAL_SPI_Receive(hspi, rx_buf, len, SPI_BUS_POLL_TIMEOUT);
+        } else {
+            res = HAL_SPI_TransmitReceive(hspi, tx_buf, rx_buf, len,
+                                          SPI_BUS_POLL_TIMEOUT);
+        }
+    }
+
+    if (res != HAL_OK) {
+        bus->async = 0;
+        return SPI_BUS_ERROR;
+    }
+
+    return bus->async ? SPI_BUS_PENDING : SPI_BUS_OK;
+}
+
+/**
+ * @brief Finish the head of the queue. When it failed, the rest of its
+ *        transaction fails too.
+ *
+ * @param bus The queue.
+ * @param status `SPI_BUS_OK` or `SPI_BUS_ERROR`.
+ */
+static void spi_bus_finish(spi_bus_t *bus, uint8_t status) {
+    void (*callback)(spi_xfer_t *xfer, uint8_t status);
+    spi_xfer_t *xfer;
+    uint32_t primask;
+    uint8_t cs_hold;
+
+    do {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        xfer = bus->head;
+        bus->head = xfer->link;
+        if (bus->head == NULL) {
+            bus->tail = NULL;
+        }
+        __set_PRIMASK(primask);
+
+        cs_hold = xfer->cs_hold;
+        if (cs_hold == 0 && xfer->cs_port != NULL) {
+            HAL_GPIO_WritePin(xfer->cs_port, xfer->cs_pin, GPIO_PIN_SET);
+        }
+
+        /* The owner may reuse it after the status is set. */
+        callback = xfer->callback;
+        xfer->status = status;
+        if (callback != NULL) {
+            callback(xfer, status);
+        }
+    } while (status != SPI_BUS_OK && cs_hold);
+}
+
+/**
+ * @brief Transfer the queue until it is empty or a transfer is started by
+ *        DMA or interrupt.
+ *
+ * @param bus The queue.
+ */
+static void spi_bus_run(spi_bus_t *bus) {
+    spi_xfer_t *xfer;
+    uint32_t primask;
+    uint8_t res;
+
+    while (1) {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        xfer = bus->head;
+        if (xfer == NULL) {
+            bus->running = 0;
+        }
+        __set_PRIMASK(primask);
+
+        if (xfer == NULL) {
+            return;
+        }
+
+        res = spi_bus_start(bus, xfer);
+        if (res == SPI_BUS_PENDING) {
+            return;
+        }
+
+        spi_bus_finish(bus, res);
+    }
+}
+
+/**
+ * @brief A transfer by DMA or interrupt is done.
+ *
+ * @param hspi The handle of SPI.
+ * @param status `SPI_BUS_OK` or `SPI_BUS_ERROR`.
+ */
+static void spi_bus_irq_done(SPI_HandleTypeDef *hspi, uint8_t status) {
+    spi_bus_t *bus = spi_bus_find(hspi);
+
+    if (bus == NULL || bus->async == 0) {
+        return;
+    }
+
+    bus->async = 0;
+    spi_bus_finish(bus, status);
+    spi_bus_run(bus);
+}
+
+/**
+ * @brief SPI transmit completed callback.
+ *
+ * @param hspi The handle of SPI.
+ */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi) {
+    spi_bus_irq_done(hspi, SPI_BUS_OK);
+}
+
+/**
+ * @brief SPI receive completed callback.
+ *
+ * @param hspi The handle of SPI.
+ */
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi) {
+    spi_bus_irq_done(hspi, SPI_BUS_OK);
+}
+
+/**
+ * @brief SPI transmit and receive completed callback.
+ *
+ * @param hspi The handle of SPI.
+ */
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi) {
+    spi_bus_irq_done(hspi, SPI_BUS_OK);
+}
+
+/**
+ * @brief SPI error callback.
+ *
+ * @param hspi The handle of SPI.
+ */
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+    spi_bus_irq_done(hspi, SPI_BUS_ERROR);
+}
+
+/**
+ * @brief Put a transaction into the queue of a SPI, it is started at once
+ *        when the SPI is idle.
+ *
+ * @param hspi The handle of SPI.
+ * @param xfer The first transfer of the transaction, the others are linked
+ *             by `next`. They can't be modified until done.
+ * @return Submit status.
+ * @retval - 0: `SPI_BUS_OK`:        Success.
+ * @retval - 1: `SPI_BUS_PARAM_ERR`: Parameter invalid.
+ * @retval - 2: `SPI_BUS_NO_INIT`:   SPI is not initialized.
+ * @note It can be called in interrupt. `callback` is called in interrupt
+ *       when the transfer is done by DMA or interrupt, otherwise in the
+ *       context which runs the queue.
+ */
+uint8_t spi_bus_submit(SPI_HandleTypeDef *hspi, spi_xfer_t *xfer) {
+    spi_bus_t *bus = spi_bus_find(hspi);
+    spi_xfer_t *last;
+    uint32_t primask;
+    uint8_t start;
+
+    if (bus == NULL || xfer == NULL) {
+        return SPI_BUS_PARAM_ERR;
+    }
+
+    if (HAL_SPI_GetState(hspi) == HAL_SPI_STATE_RESET) {
+        return SPI_BUS_NO_INIT;
+    }
+
+    if (hspi->Init.Mode != SPI_MODE_MASTER ||
+        hspi->Init.DataSize != SPI_DATASIZE_8BIT) {
+        return SPI_BUS_PARAM_ERR;
+    }
+
+    for (last = xfer; last != NULL; last = last->next) {
+        if (last->len == 0 || last->len > 0xFFFFU ||
+            (last->tx_buf == NULL && last->rx_buf == NULL) ||
+            last->clk_mode > SPI_CLK_MODE3 ||
+            !IS_SPI_BAUDRATE_PRESCALER(last->speed)) {
+            return SPI_BUS_PARAM_ERR;
+        }
+    }
+
+    for (last = xfer;; last = last->next) {
+        last->status = SPI_BUS_PENDING;
+        last->cs_hold = (last->next != NULL);
+        last->link = last->next;
+        if (last->next == NULL) {
+            break;
+        }
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (bus->tail == NULL) {
+        bus->head = xfer;
+    } else {
+        bus->tail->link = xfer;
+    }
+    bus->tail = last;
+    start = !bus->running;
+    bus->running = 1;
+    __set_PRIMASK(primask);
+
+    if (start) {
+        spi_bus_run(bus);
+    }
+
+    return SPI_BUS_OK;
+}
+
+/**
+ * @brief Wait for a transaction to be done.
+ *
+ * @param xfer The first transfer of the transaction.
+ * @param timeout Timeout, unit: ms.
+ * @return Transaction status.
+ * @retval - 0: `SPI_BUS_OK`:      Success.
+ * @retval - 3: `SPI_BUS_ERROR`:   Transfer failed.
+ * @retval - 4: `SPI_BUS_TIMEOUT`: Timeout, the transaction is still in the
+ *                                 queue.
+ * @note It polls the status. With RTOS, give a semaphore in `callback` and
+ *       wait for it to release the CPU.
+ */
+uint8_t spi_bus_wait(spi_xfer_t *xfer, uint32_t timeout) {
+    uint32_t start = HAL_GetTick();
+
+    while (xfer->next != NULL) {
+        xfer = xfer->next;
+    }
+
+    while (xfer->status == SPI_BUS_PENDING) {
+        if (HAL_GetTick() - start >= timeout) {
+            return SPI_BUS_TIMEOUT;
+        }
+    }
+
+    return xfer->status;
+}
+
+/**
+ * @brief Submit a transaction and wait for it.
+ *
+ * @param hspi The handle of SPI.
+ * @param xfer The first transfer of the transaction.
+ * @param timeout Timeout, unit: ms.
+ * @return Transaction status, see `spi_bus_submit` and `spi_bus_wait`.
+ */
+uint8_t spi_bus_transfer(SPI_HandleTypeDef *hspi, spi_xfer_t *xfer,
+                         uint32_t timeout) {
+    uint8_t res = spi_bus_submit(hspi, xfer);
+
+    if (res != SPI_BUS_OK) {
+        return res;
+    }
+
+    return spi_bus_wait(xfer, timeout);
+}
+
+/**
+ * @brief Whether the queue of a SPI is being transferred.
+ *
+ * @param hspi The handle of SPI.
+ * @return 1: Busy; 0: Idle or the SPI doesn't exist.
+ */
+uint8_t spi_bus_busy(SPI_HandleTypeDef *hspi) {
+    spi_bus_t *bus = spi_bus_find(hspi);
+
+    return (bus != NULL) ? bus->running : 0;
+}
+
+/**
+ * @}
+ */
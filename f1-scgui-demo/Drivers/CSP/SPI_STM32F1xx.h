@@ -30,6 +30,16 @@ extern "C" {
 #define SPI_DEINIT_DMA_FAIL 2
 #define SPI_NO_INIT         3
 
+#define SPI_BUS_OK          0
+#define SPI_BUS_PARAM_ERR   1
+#define SPI_BUS_NO_INIT     2
+#define SPI_BUS_ERROR       3
+#define SPI_BUS_TIMEOUT     4
+#define SPI_BUS_PENDING     5
+
+/* Timeout of a transfer without DMA and interrupt, unit: ms. */
+#define SPI_BUS_POLL_TIMEOUT 1000
+
 /**
  * @}
  */
@@ -44,6 +54,30 @@ typedef enum {
   SPI_CLK_MODE3  /*!< Mode 3: CPOL=1; CPHA=1 */
 } spi_clk_mode_t;
 
+/**
+ * @brief Transfer on a shared SPI bus. Transfers linked by `next` are one
+ *        transaction of a device, CS is kept low until the last one is done.
+ */
+typedef struct spi_xfer {
+    GPIO_TypeDef *cs_port;      /*!< CS port, NULL: no CS */
+    uint16_t cs_pin;            /*!< CS pin, active low */
+    uint8_t clk_mode;           /*!< `spi_clk_mode_t` */
+    uint8_t speed;              /*!< `SPI_BAUDRATEPRESCALER_x` */
+    const uint8_t *tx_buf;      /*!< Data to send, NULL: receive only */
+    uint8_t *rx_buf;            /*!< Data received, NULL: send only */
+    uint32_t len;               /*!< Bytes to transfer */
+    struct spi_xfer *next;      /*!< Next transfer of the transaction, NULL:
+                                     the last one */
+    void (*callback)(struct spi_xfer *xfer, uint8_t status); /*!< Called when
+                                                                  done, can be
+                                                                  NULL */
+    void *user;                 /*!< User data */
+
+    volatile uint8_t status;    /*!< `SPI_BUS_PENDING` until done */
+    uint8_t cs_hold;            /*!< Private: keep CS low after it */
+    struct spi_xfer *link;      /*!< Private: next in the queue */
+} spi_xfer_t;
+
 /*****************************************************************************
  * @defgroup SPI1 Functions
  * @{
@@ -141,6 +175,12 @@ uint8_t spi_rw_one_byte(SPI_HandleTypeDef *hspi, uint8_t byte);
 uint16_t spi_rw_two_byte(SPI_HandleTypeDef *hspi, uint16_t tx_data);
 
 uint8_t spi_change_speed(SPI_HandleTypeDef *hspi, uint8_t speed);
+
+uint8_t spi_bus_submit(SPI_HandleTypeDef *hspi, spi_xfer_t *xfer);
+uint8_t spi_bus_wait(spi_xfer_t *xfer, uint32_t timeout);
+uint8_t spi_bus_transfer(SPI_HandleTypeDef *hspi, spi_xfer_t *xfer,
+                         uint32_t timeout);
+uint8_t spi_bus_busy(SPI_HandleTypeDef *hspi);
 /**
  * @}
  */
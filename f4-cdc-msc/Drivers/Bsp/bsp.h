@@ -20,6 +20,8 @@ extern "C" {
 #include "./core/core_delay.h"
 #include "./key/key.h"
 #include "./lcd/lcd.h"
+#include "./lcd/lcd_comp.h"
+#include "./lcd/lcd_font.h"
 #include "./led/led.h"
 #include "./sdram/sdram.h"
 #include "./touch/touch.h"
@@ -260,6 +260,7 @@ void lcd_draw_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2,
 void lcd_draw_rectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2,
                         uint16_t color);
 
+const uint8_t *lcd_get_char_font(char chr, uint8_t size);
 void lcd_show_char(uint16_t x, uint16_t y, char chr, uint8_t size, uint8_t mode,
                    uint16_t color);
 void lcd_show_num(uint16_t x, uint16_t y, uint32_t num, uint8_t len,
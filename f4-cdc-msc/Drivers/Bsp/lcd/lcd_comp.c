@@ -0,0 +1,591 @@
+/**
+ * @file    lcd_comp.c
+ * @author  Deadline039
+ * @brief   LCD 脏矩形合成器
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#include "lcd_comp.h"
+
+#include <string.h>
+
+static lcd_comp_widget_t g_comp_widget[LCD_COMP_WIDGET_NUM];
+static uint8_t g_comp_widget_num;
+
+static lcd_comp_area_t g_comp_dirty[LCD_COMP_DIRTY_NUM];
+static uint8_t g_comp_dirty_num;
+
+static uint16_t g_comp_buf[LCD_COMP_BUF_SIZE];
+static uint16_t g_comp_bg_color;
+static uint32_t g_comp_period_ms;
+static uint32_t g_comp_last_tick;
+static lcd_comp_stat_t g_comp_stat;
+
+/**
+ * @brief 判断两个区域是否相交或相邻
+ *
+ * @param a 区域 a
+ * @param b 区域 b
+ * @return 0: 不相交; 1: 相交或相邻
+ */
+static inline uint8_t lcd_comp_area_touch(const lcd_comp_area_t *a,
+                                          const lcd_comp_area_t *b) {
+    return (a->x <= b->x + b->w && b->x <= a->x + a->w &&
+            a->y <= b->y + b->h && b->y <= a->y + a->h);
+}
+
+/**
+ * @brief 求两个区域的外接矩形
+ *
+ * @param a 区域 a
+ * @param b 区域 b
+ * @return 外接矩形
+ */
+static lcd_comp_area_t lcd_comp_area_union(const lcd_comp_area_t *a,
+                                           const lcd_comp_area_t *b) {
+    lcd_comp_area_t res;
+    uint16_t ex = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+    uint16_t ey = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
+
+    res.x = (a->x < b->x) ? a->x : b->x;
+    res.y = (a->y < b->y) ? a->y : b->y;
+    res.w = ex - res.x;
+    res.h = ey - res.y;
+
+    return res;
+}
+
+/**
+ * @brief 求两个区域的交集
+ *
+ * @param a 区域 a
+ * @param b 区域 b
+ * @param[out] res 交集
+ * @return 0: 无交集; 1: 有交集
+ */
+static uint8_t lcd_comp_area_intersect(const lcd_comp_area_t *a,
+                                       const lcd_comp_area_t *b,
+                                       lcd_comp_area_t *res) {
+    uint16_t sx = (a->x > b->x) ? a->x : b->x;
+    uint16_t sy = (a->y > b->y) ? a->y : b->y;
+    uint16_t ex = (a->x + a->w < b->x + b->w) ? a->x + a->w : b->x + b->w;
+    uint16_t ey = (a->y + a->h < b->y + b->h) ? a->y + a->h : b->y + b->h;
+
+    if (sx >= ex || sy >= ey) {
+        return 0;
+    }
+
+    res->x = sx;
+    res->y = sy;
+    res->w = ex - sx;
+    res->h = ey - sy;
+
+    return 1;
+}
+
+/**
+ * @brief 添加脏区域, 与已有区域相交时合并
+ *
+ * @param area 区域
+ */
+static void lcd_comp_add_dirty(lcd_comp_area_t area) {
+    uint8_t merged;
+    uint8_t best = 0;
+    uint32_t best_cost = UINT32_MAX;
+
+    /* 裁剪到屏幕范围内 */
+    if (area.x >= lcddev.width || area.y >= lcddev.height || area.w == 0 ||
+        area.h == 0) {
+        return;
+    }
+
+    if (area.x + area.w > lcddev.width) {
+        area.w = lcddev.width - area.x;
+    }
+
+    if (area.y + area.h > lcddev.height) {
+        area.h = lcddev.height - area.y;
+    }
+
+    /* 合并后的区域可能又与其他区域相交, 直到不再合并为止 */
+    do {
+        merged = 0;
+
+        for (uint8_t i = 0; i < g_comp_dirty_num; i++) {
+            if (lcd_comp_area_touch(&g_comp_dirty[i], &area)) {
+                area = lcd_comp_area_union(&g_comp_dirty[i], &area);
+                g_comp_dirty[i] = g_comp_dirty[--g_comp_dirty_num];
+                merged = 1;
+                break;
+            }
+        }
+    } while (merged);
+
+    if (g_comp_dirty_num < LCD_COMP_DIRTY_NUM) {
+        g_comp_dirty[g_comp_dirty_num++] = area;
+        return;
+    }
+
+    /* 表满, 合并到面积增加最少的一项 */
+    for (uint8_t i = 0; i < LCD_COMP_DIRTY_NUM; i++) {
+        lcd_comp_area_t u = lcd_comp_area_union(&g_comp_dirty[i], &area);
+        uint32_t cost = (uint32_t)u.w * u.h -
+                        (uint32_t)g_comp_dirty[i].w * g_comp_dirty[i].h;
+
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = i;
+        }
+    }
+
+    g_comp_dirty[best] = lcd_comp_area_union(&g_comp_dirty[best], &area);
+}
+
+/**
+ * @brief 在合成缓冲区中填充矩形
+ *
+ * @param band 缓冲区对应的屏幕区域
+ * @param area 填充区域, 必须在 `band` 内
+ * @param color 颜色
+ */
+static void lcd_comp_buf_fill(const lcd_comp_area_t *band,
+                              const lcd_comp_area_t *area, uint16_t color) {
+    for (uint16_t r = 0; r < area->h; r++) {
+        uint16_t *p = &g_comp_buf[(area->y - band->y + r) * band->w +
+                                  (area->x - band->x)];
+
+        for (uint16_t c = 0; c < area->w; c++) {
+            *p++ = color;
+        }
+    }
+}
+
+/**
+ * @brief 在合成缓冲区中绘制标签
+ *
+ * @param band 缓冲区对应的屏幕区域
+ * @param clip 标签与 `band` 的交集
+ * @param widget 标签
+ */
+static void lcd_comp_draw_label(const lcd_comp_area_t *band,
+                                const lcd_comp_area_t *clip,
+                                const lcd_comp_widget_t *widget) {
+    uint8_t size = widget->font_size;
+    uint8_t col_bytes = (size + 7) / 8;
+    uint16_t cx = widget->area.x;
+    uint16_t cy = widget->area.y;
+
+    for (const char *p = widget->text; *p != '\0'; p++) {
+        const uint8_t *pfont;
+
+        if (*p == '\n') {
+            cx = widget->area.x;
+            cy += size;
+            continue;
+        }
+
+        if (cx + size / 2 > widget->area.x + widget->area.w) {
+            /* 自动换行 */
+            cx = widget->area.x;
+            cy += size;
+        }
+
+        if (cy >= clip->y + clip->h) {
+            break;
+        }
+
+        pfont = lcd_get_char_font(*p, size);
+
+        if (pfont == NULL || cy + size <= clip->y ||
+            cx + size / 2 <= clip->x || cx >= clip->x + clip->w) {
+            cx += size / 2;
+            continue;
+        }
+
+        /* 点阵按列存放, 只画落在裁剪区内的点 */
+        for (uint8_t col = 0; col < size / 2; col++) {
+            uint16_t px = cx + col;
+
+            if (px < clip->x || px >= clip->x + clip->w) {
+                continue;
+            }
+
+            for (uint8_t row = 0; row < size; row++) {
+                uint16_t py = cy + row;
+
+                if (py < clip->y || py >= clip->y + clip->h) {
+                    continue;
+                }
+
+                if (pfont[col * col_bytes + row / 8] & (0x80 >> (row % 8))) {
+                    g_comp_buf[(py - band->y) * band->w + (px - band->x)] =
+                        widget->color;
+                }
+            }
+        }
+
+        cx += size / 2;
+    }
+}
+
+/**
+ * @brief 在合成缓冲区中绘制一个控件
+ *
+ * @param band 缓冲区对应的屏幕区域
+ * @param widget 控件
+ */
+static void lcd_comp_draw_widget(const lcd_comp_area_t *band,
+                                 const lcd_comp_widget_t *widget) {
+    lcd_comp_area_t clip, part;
+
+    if (widget->visible == 0 ||
+        lcd_comp_area_intersect(band, &widget->area, &clip) == 0) {
+        return;
+    }
+
+    switch (widget->type) {
+        case LCD_COMP_RECT: {
+            lcd_comp_buf_fill(band, &clip, widget->color);
+        } break;
+
+        case LCD_COMP_LABEL: {
+            lcd_comp_draw_label(band, &clip, widget);
+        } break;
+
+        case LCD_COMP_BAR: {
+            /* 已完成的部分用前景色, 其余用背景色 */
+            part = widget->area;
+            part.w = (uint32_t)widget->area.w * widget->value / 100;
+            lcd_comp_buf_fill(band, &clip, widget->bg_color);
+
+            if (lcd_comp_area_intersect(&clip, &part, &part)) {
+                lcd_comp_buf_fill(band, &part, widget->color);
+            }
+        } break;
+
+        default: {
+        } break;
+    }
+}
+
+/**
+ * @brief 合成并刷新一个脏区域
+ *
+ * @param area 脏区域
+ * @return 推送到屏幕的字节数
+ */
+static uint32_t lcd_comp_render_area(const lcd_comp_area_t *area) {
+    lcd_comp_area_t band = *area;
+    uint16_t rows = LCD_COMP_BUF_SIZE / area->w;
+    uint16_t row0;
+
+    if (rows == 0) {
+        return 0;
+    }
+
+    for (row0 = 0; row0 < area->h; row0 += rows) {
+        band.y = area->y + row0;
+        band.h = (area->h - row0 < rows) ? (area->h - row0) : rows;
+
+        /* 先铺屏幕背景, 再按创建顺序叠加控件 */
+        lcd_comp_buf_fill(&band, &band, g_comp_bg_color);
+
+        for (uint8_t i = 0; i < g_comp_widget_num; i++) {
+            lcd_comp_draw_widget(&band, &g_comp_widget[i]);
+        }
+
+        lcd_color_fill(band.x, band.y, band.x + band.w - 1,
+                       band.y + band.h - 1, g_comp_buf);
+    }
+
+    return (uint32_t)area->w * area->h * sizeof(uint16_t);
+}
+
+/**
+ * @brief 初始化合成器并以背景色清屏
+ *
+ * @param bg_color 屏幕背景色
+ * @param period_ms 刷新周期 (ms), 0 表示每次调用 `lcd_comp_refresh` 都刷新
+ * @note 会清除所有已创建的控件. 需要在 `lcd_init` 和 `lcd_display_dir`
+ *       之后调用.
+ */
+void lcd_comp_init(uint16_t bg_color, uint32_t period_ms) {
+    g_comp_widget_num = 0;
+    g_comp_dirty_num = 0;
+    g_comp_bg_color = bg_color;
+    g_comp_period_ms = period_ms;
+    g_comp_last_tick = HAL_GetTick();
+    memset(&g_comp_stat, 0, sizeof(g_comp_stat));
+
+    /* 使用 DWT 周期计数器统计每帧时间 */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    lcd_clear(bg_color);
+}
+
+/**
+ * @brief 从控件池中分配一个控件
+ *
+ * @param type 控件类型
+ * @param x 左上角 x 坐标
+ * @param y 左上角 y 坐标
+ * @param w 宽度
+ * @param h 高度
+ * @param color 前景色
+ * @return 控件, NULL 表示控件池已满
+ */
+static lcd_comp_widget_t *lcd_comp_alloc(lcd_comp_type_t type, uint16_t x,
+                                         uint16_t y, uint16_t w, uint16_t h,
+                                         uint16_t color) {
+    lcd_comp_widget_t *widget;
+
+    if (g_comp_widget_num >= LCD_COMP_WIDGET_NUM) {
+        return NULL;
+    }
+
+    widget = &g_comp_widget[g_comp_widget_num++];
+    memset(widget, 0, sizeof(lcd_comp_widget_t));
+    widget->type = type;
+    widget->area.x = x;
+    widget->area.y = y;
+    widget->area.w = w;
+    widget->area.h = h;
+    widget->color = color;
+    widget->visible = 1;
+
+    lcd_comp_add_dirty(widget->area);
+
+    return widget;
+}
+
+/**
+ * @brief 创建实心矩形
+ *
+ * @param x 左上角 x 坐标
+ * @param y 左上角 y 坐标
+ * @param w 宽度
+ * @param h 高度
+ * @param color 颜色
+ * @return 控件, NULL 表示控件池已满
+ */
+lcd_comp_widget_t *lcd_comp_create_rect(uint16_t x, uint16_t y, uint16_t w,
+                                        uint16_t h, uint16_t color) {
+    return lcd_comp_alloc(LCD_COMP_RECT, x, y, w, h, color);
+}
+
+/**
+ * @brief 创建文本标签
+ *
+ * @param x 左上角 x 坐标
+ * @param y 左上角 y 坐标
+ * @param w 宽度, 超出自动换行
+ * @param h 高度, 超出不显示
+ * @param size 字体大小 12/16/24/32
+ * @param text 文本, 超过 `LCD_COMP_TEXT_LEN - 1` 的部分截断
+ * @param color 文字颜色
+ * @return 控件, NULL 表示控件池已满
+ */
+lcd_comp_widget_t *lcd_comp_create_label(uint16_t x, uint16_t y, uint16_t w,
+                                         uint16_t h, uint8_t size,
+                                         const char *text, uint16_t color) {
+    lcd_comp_widget_t *widget =
+        lcd_comp_alloc(LCD_COMP_LABEL, x, y, w, h, color);
+
+    if (widget != NULL) {
+        widget->font_size = size;
+        strncpy(widget->text, text, LCD_COMP_TEXT_LEN - 1);
+    }
+
+    return widget;
+}
+
+/**
+ * @brief 创建水平进度条
+ *
+ * @param x 左上角 x 坐标
+ * @param y 左上角 y 坐标
+ * @param w 宽度
+ * @param h 高度
+ * @param color 已完成部分的颜色
+ * @param bg_color 未完成部分的颜色
+ * @return 控件, NULL 表示控件池已满
+ */
+lcd_comp_widget_t *lcd_comp_create_bar(uint16_t x, uint16_t y, uint16_t w,
+                                       uint16_t h, uint16_t color,
+                                       uint16_t bg_color) {
+    lcd_comp_widget_t *widget = lcd_comp_alloc(LCD_COMP_BAR, x, y, w, h, color);
+
+    if (widget != NULL) {
+        widget->bg_color = bg_color;
+    }
+
+    return widget;
+}
+
+/**
+ * @brief 设置标签文本
+ *
+ * @param widget 标签
+ * @param text 文本
+ * @note 文本没有变化时不会标记脏区域.
+ */
+void lcd_comp_set_text(lcd_comp_widget_t *widget, const char *text) {
+    if (widget == NULL || widget->type != LCD_COMP_LABEL ||
+        strncmp(widget->text, text, LCD_COMP_TEXT_LEN - 1) == 0) {
+        return;
+    }
+
+    strncpy(widget->text, text, LCD_COMP_TEXT_LEN - 1);
+
+    if (widget->visible) {
+        lcd_comp_add_dirty(widget->area);
+    }
+}
+
+/**
+ * @brief 设置进度条的值
+ *
+ * @param widget 进度条
+ * @param value 进度 0 ~ 100
+ * @note 只标记新旧进度之间变化的部分.
+ */
+void lcd_comp_set_value(lcd_comp_widget_t *widget, uint8_t value) {
+    lcd_comp_area_t span;
+    uint16_t old_w, new_w;
+
+    if (value > 100) {
+        value = 100;
+    }
+
+    if (widget == NULL || widget->type != LCD_COMP_BAR ||
+        widget->value == value) {
+        return;
+    }
+
+    old_w = (uint32_t)widget->area.w * widget->value / 100;
+    new_w = (uint32_t)widget->area.w * value / 100;
+    widget->value = value;
+
+    if (widget->visible == 0 || old_w == new_w) {
+        return;
+    }
+
+    span = widget->area;
+    span.x += (old_w < new_w) ? old_w : new_w;
+    span.w = (old_w < new_w) ? (new_w - old_w) : (old_w - new_w);
+    lcd_comp_add_dirty(span);
+}
+
+/**
+ * @brief 设置控件前景色
+ *
+ * @param widget 控件
+ * @param color 颜色
+ */
+void lcd_comp_set_color(lcd_comp_widget_t *widget, uint16_t color) {
+    if (widget == NULL || widget->color == color) {
+        return;
+    }
+
+    widget->color = color;
+
+    if (widget->visible) {
+        lcd_comp_add_dirty(widget->area);
+    }
+}
+
+/**
+ * @brief 显示或隐藏控件
+ *
+ * @param widget 控件
+ * @param visible 0: 隐藏; 1: 显示
+ */
+void lcd_comp_set_visible(lcd_comp_widget_t *widget, uint8_t visible) {
+    visible = visible ? 1 : 0;
+
+    if (widget == NULL || widget->visible == visible) {
+        return;
+    }
+
+    widget->visible = visible;
+    lcd_comp_add_dirty(widget->area);
+}
+
+/**
+ * @brief 标记一块区域需要重绘
+ *
+ * @param x 左上角 x 坐标
+ * @param y 左上角 y 坐标
+ * @param w 宽度
+ * @param h 高度
+ */
+void lcd_comp_invalidate(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    lcd_comp_area_t area = {x, y, w, h};
+
+    lcd_comp_add_dirty(area);
+}
+
+/**
+ * @brief 立即合成并刷新所有脏区域
+ */
+void lcd_comp_flush(void) {
+    uint32_t start, bytes = 0;
+
+    if (g_comp_dirty_num == 0) {
+        return;
+    }
+
+    start = DWT->CYCCNT;
+
+    for (uint8_t i = 0; i < g_comp_dirty_num; i++) {
+        bytes += lcd_comp_render_area(&g_comp_dirty[i]);
+    }
+
+    g_comp_dirty_num = 0;
+
+    g_comp_stat.frame_us =
+        (DWT->CYCCNT - start) / (SystemCoreClock / 1000000U);
+    if (g_comp_stat.frame_us > g_comp_stat.max_frame_us) {
+        g_comp_stat.max_frame_us = g_comp_stat.frame_us;
+    }
+
+    g_comp_stat.frame_bytes = bytes;
+    g_comp_stat.total_bytes += bytes;
+    ++g_comp_stat.frames;
+}
+
+/**
+ * @brief 按刷新周期合成并刷新脏区域
+ *
+ * @return 0: 本次没有刷新; 1: 刷新了一帧
+ * @note 在主循环或任务中周期调用.
+ */
+uint8_t lcd_comp_refresh(void) {
+    uint32_t tick = HAL_GetTick();
+
+    if (g_comp_dirty_num == 0 || tick - g_comp_last_tick < g_comp_period_ms) {
+        return 0;
+    }
+
+    g_comp_last_tick = tick;
+    lcd_comp_flush();
+
+    return 1;
+}
+
+/**
+ * @brief 获取刷新统计
+ *
+ * @param[out] stat 统计信息
+ */
+void lcd_comp_get_stat(lcd_comp_stat_t *stat) {
+    if (stat != NULL) {
+        *stat = g_comp_stat;
+    }
+}
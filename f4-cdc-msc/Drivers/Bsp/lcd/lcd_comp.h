@@ -0,0 +1,108 @@
+/**
+ * @file    lcd_comp.h
+ * @author  Deadline039
+ * @brief   LCD 脏矩形合成器
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * 保留模式的简单界面合成器, 用于不使用 LVGL 的程序:
+ *  - 控件 (矩形, 标签, 进度条) 保存在控件池中, 修改属性时只标记变化的区域;
+ *  - 相交或相邻的脏区域会合并, 脏区域表满时合并到增加面积最小的一项;
+ *  - 每帧按脏区域在内存中合成所有控件, 再以窗口整块刷新, 不会先清屏再画,
+ *    因此不会闪烁;
+ *  - 刷新频率由 `period_ms` 限制, 多次修改在一帧内只刷新一次.
+ * 控件按创建顺序绘制, 后创建的控件在上层. 标签背景透明.
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#ifndef __LCD_COMP_H
+#define __LCD_COMP_H
+
+#include "lcd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* 控件池大小 */
+#define LCD_COMP_WIDGET_NUM 16
+/* 脏区域表大小 */
+#define LCD_COMP_DIRTY_NUM  8
+/* 标签文本最大长度 (含结束符) */
+#define LCD_COMP_TEXT_LEN   32
+/* 合成缓冲区大小 (像素), 脏区域超过时分多次刷新 */
+#define LCD_COMP_BUF_SIZE   4096
+
+/**
+ * @brief 控件类型
+ */
+typedef enum {
+    LCD_COMP_RECT = 0U, /*!< 实心矩形 */
+    LCD_COMP_LABEL,     /*!< 文本标签 */
+    LCD_COMP_BAR        /*!< 水平进度条 */
+} lcd_comp_type_t;
+
+/**
+ * @brief 矩形区域
+ */
+typedef struct {
+    uint16_t x; /*!< 左上角 x 坐标 */
+    uint16_t y; /*!< 左上角 y 坐标 */
+    uint16_t w; /*!< 宽度 */
+    uint16_t h; /*!< 高度 */
+} lcd_comp_area_t;
+
+/**
+ * @brief 控件
+ */
+typedef struct {
+    lcd_comp_type_t type;          /*!< 控件类型 */
+    lcd_comp_area_t area;          /*!< 控件区域 */
+    uint16_t color;                /*!< 前景色 */
+    uint16_t bg_color;             /*!< 背景色, 仅进度条使用 */
+    uint8_t visible;               /*!< 是否显示 */
+    uint8_t font_size;             /*!< 字体大小 12/16/24/32, 仅标签使用 */
+    uint8_t value;                 /*!< 进度 0 ~ 100, 仅进度条使用 */
+    char text[LCD_COMP_TEXT_LEN];  /*!< 文本, 仅标签使用 */
+} lcd_comp_widget_t;
+
+/**
+ * @brief 刷新统计
+ */
+typedef struct {
+    uint32_t frames;       /*!< 已刷新的帧数 */
+    uint32_t frame_us;     /*!< 最近一帧的合成和刷新时间 (us) */
+    uint32_t max_frame_us; /*!< 最长一帧的时间 (us) */
+    uint32_t frame_bytes;  /*!< 最近一帧推送到屏幕的字节数 */
+    uint32_t total_bytes;  /*!< 累计推送到屏幕的字节数 */
+} lcd_comp_stat_t;
+
+void lcd_comp_init(uint16_t bg_color, uint32_t period_ms);
+
+lcd_comp_widget_t *lcd_comp_create_rect(uint16_t x, uint16_t y, uint16_t w,
+                                        uint16_t h, uint16_t color);
+lcd_comp_widget_t *lcd_comp_create_label(uint16_t x, uint16_t y, uint16_t w,
+                                         uint16_t h, uint8_t size,
+                                         const char *text, uint16_t color);
+lcd_comp_widget_t *lcd_comp_create_bar(uint16_t x, uint16_t y, uint16_t w,
+                                       uint16_t h, uint16_t color,
+                                       uint16_t bg_color);
+
+void lcd_comp_set_text(lcd_comp_widget_t *widget, const char *text);
+void lcd_comp_set_value(lcd_comp_widget_t *widget, uint8_t value);
+void lcd_comp_set_color(lcd_comp_widget_t *widget, uint16_t color);
+void lcd_comp_set_visible(lcd_comp_widget_t *widget, uint8_t visible);
+void lcd_comp_invalidate(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+uint8_t lcd_comp_refresh(void);
+void lcd_comp_flush(void);
+void lcd_comp_get_stat(lcd_comp_stat_t *stat);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __LCD_COMP_H */
@@ -0,0 +1,548 @@
+/**
+ * @file    lcd_font.c
+ * @author  Deadline039
+ * @brief   LCD 抗锯齿字库引擎
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#include "lcd_font.h"
+
+#include <string.h>
+
+/**
+ * @brief 字形缓存项
+ */
+typedef struct {
+    const lcd_font_t *font; /*!< 所属字库, NULL 表示空闲 */
+    uint32_t unicode;       /*!< 码点 */
+    uint32_t last_use;      /*!< 最近一次使用的时间戳, 用于 LRU 淘汰 */
+    lcd_font_glyph_t dsc;   /*!< 字形描述 */
+    uint8_t alpha[LCD_FONT_CACHE_SLOT_SIZE]; /*!< A8 格式的字形 */
+} lcd_font_cache_t;
+
+static lcd_font_cache_t g_font_cache[LCD_FONT_CACHE_NUM] LCD_FONT_CACHE_ATTR;
+static uint32_t g_font_cache_tick;
+static uint32_t g_font_cache_hit;
+static uint32_t g_font_cache_miss;
+
+/* 从外部读取位图时的缓冲区, 4bpp 时位图最大为缓存的一半 */
+static uint8_t g_font_packed_buf[LCD_FONT_CACHE_SLOT_SIZE / 2];
+
+/* CPU 混合后的刷新缓冲区 */
+static uint16_t g_font_blit_buf[LCD_FONT_BLIT_BUF_SIZE];
+
+/* 内置 ASCII 字库的位图偏移, 之前是字形描述, 最多 95 * 12 字节 */
+#define LCD_FONT_ASCII_BITMAP_OFFSET 0x10000U
+/* 内置 ASCII 字库每个字形的位图间隔, 32 点阵为 16 * 32 / 8 = 64 字节 */
+#define LCD_FONT_ASCII_BITMAP_STRIDE 64U
+
+static uint8_t lcd_font_ascii_read(const lcd_font_t *font, uint32_t offset,
+                                   void *buf, uint32_t len);
+
+/* ' ' ~ '~' 对应字形 0 ~ 94 */
+static const lcd_font_range_t g_font_ascii_range = {' ', '~' - ' ' + 1, 0};
+
+#define LCD_FONT_ASCII(size)                                                   \
+    {.bpp = 1,                                                                 \
+     .line_height = (size),                                                    \
+     .range_num = 1,                                                           \
+     .ranges = &g_font_ascii_range,                                            \
+     .glyphs = NULL,                                                           \
+     .bitmap = NULL,                                                           \
+     .glyph_offset = 0,                                                        \
+     .bitmap_offset = LCD_FONT_ASCII_BITMAP_OFFSET,                            \
+     .read_cb = lcd_font_ascii_read,                                           \
+     .user_data = NULL}
+
+static const lcd_font_t g_font_ascii[] = {LCD_FONT_ASCII(12), LCD_FONT_ASCII(16),
+                                          LCD_FONT_ASCII(24),
+                                          LCD_FONT_ASCII(32)};
+
+/**
+ * @brief 解码一个 UTF-8 字符
+ *
+ * @param[in,out] str 字符串指针, 解码后指向下一个字符
+ * @return Unicode 码点, 0 表示字符串结束
+ */
+static uint32_t lcd_font_utf8_next(const char **str) {
+    const uint8_t *p = (const uint8_t *)*str;
+    uint32_t unicode;
+    uint8_t len;
+
+    if (p[0] == 0) {
+        return 0;
+    }
+
+    if (p[0] < 0x80) {
+        unicode = p[0];
+        len = 1;
+    } else if ((p[0] & 0xE0) == 0xC0) {
+        unicode = p[0] & 0x1F;
+        len = 2;
+    } else if ((p[0] & 0xF0) == 0xE0) {
+        unicode = p[0] & 0x0F;
+        len = 3;
+    } else if ((p[0] & 0xF8) == 0xF0) {
+        unicode = p[0] & 0x07;
+        len = 4;
+    } else {
+        /* 非法首字节, 跳过 */
+        *str += 1;
+        return '?';
+    }
+
+    for (uint8_t i = 1; i < len; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            /* 字符被截断 */
+            *str += i;
+            return '?';
+        }
+        unicode = (unicode << 6) | (p[i] & 0x3F);
+    }
+
+    *str += len;
+    return unicode;
+}
+
+/**
+ * @brief 查找码点对应的字形 ID
+ *
+ * @param font 字库
+ * @param unicode 码点
+ * @param[out] glyph_id 字形 ID
+ * @return 0: 找到; 1: 字库中没有此字符
+ */
+static uint8_t lcd_font_find_glyph(const lcd_font_t *font, uint32_t unicode,
+                                   uint32_t *glyph_id) {
+    int32_t low = 0, high = (int32_t)font->range_num - 1;
+
+    /* 区段按升序排列, 二分查找 */
+    while (low <= high) {
+        int32_t mid = (low + high) / 2;
+        const lcd_font_range_t *range = &font->ranges[mid];
+
+        if (unicode < range->range_start) {
+            high = mid - 1;
+        } else if (unicode >= range->range_start + range->range_length) {
+            low = mid + 1;
+        } else {
+            *glyph_id = range->glyph_id_start + (unicode - range->range_start);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief 将打包的 1/2/4 bpp 位图展开为 A8
+ *
+ * @param packed 打包的位图
+ * @param bpp 每像素位数
+ * @param pixels 像素数
+ * @param alpha A8 输出缓冲区
+ */
+static void lcd_font_unpack(const uint8_t *packed, uint8_t bpp,
+                            uint32_t pixels, uint8_t *alpha) {
+    uint32_t bit = 0;
+    uint8_t mask = (1 << bpp) - 1;
+    /* 每一级灰度对应的透明度, 1bpp: 255; 2bpp: 85; 4bpp: 17 */
+    uint8_t scale = 255 / mask;
+
+    for (uint32_t i = 0; i < pixels; i++) {
+        uint8_t shift = 8 - bpp - (bit & 7);
+        alpha[i] = ((packed[bit >> 3] >> shift) & mask) * scale;
+        bit += bpp;
+    }
+}
+
+/**
+ * @brief 获取字形, 未命中时从字库渲染到缓存中
+ *
+ * @param font 字库
+ * @param unicode 码点
+ * @return 缓存项, NULL 表示字库中没有此字符或读取失败
+ */
+static lcd_font_cache_t *lcd_font_get_glyph(const lcd_font_t *font,
+                                            uint32_t unicode) {
+    lcd_font_cache_t *slot = &g_font_cache[0];
+    uint32_t glyph_id, pixels, packed_size;
+    const uint8_t *packed;
+
+    ++g_font_cache_tick;
+
+    for (uint32_t i = 0; i < LCD_FONT_CACHE_NUM; i++) {
+        lcd_font_cache_t *cache = &g_font_cache[i];
+
+        if (cache->font == font && cache->unicode == unicode) {
+            cache->last_use = g_font_cache_tick;
+            ++g_font_cache_hit;
+            return cache;
+        }
+
+        /* 顺便找到最久未使用的一项 (空闲项的时间戳为 0) */
+        if (cache->last_use < slot->last_use) {
+            slot = cache;
+        }
+    }
+
+    ++g_font_cache_miss;
+
+    if (lcd_font_find_glyph(font, unicode, &glyph_id)) {
+        return NULL;
+    }
+
+    slot->font = NULL;
+
+    if (font->glyphs) {
+        slot->dsc = font->glyphs[glyph_id];
+    } else if (font->read_cb == NULL ||
+               font->read_cb(font,
+                             font->glyph_offset +
+                                 glyph_id * sizeof(lcd_font_glyph_t),
+                             &slot->dsc, sizeof(lcd_font_glyph_t))) {
+        return NULL;
+    }
+
+    pixels = (uint32_t)slot->dsc.box_w * slot->dsc.box_h;
+    if (pixels > LCD_FONT_CACHE_SLOT_SIZE) {
+        /* 字形过大, 只保留步进宽度 */
+        slot->dsc.box_w = 0;
+        slot->dsc.box_h = 0;
+        pixels = 0;
+    }
+
+    packed_size = (pixels * font->bpp + 7) / 8;
+
+    if (font->bitmap) {
+        packed = font->bitmap + slot->dsc.bitmap_index;
+    } else if (packed_size == 0) {
+        packed = g_font_packed_buf;
+    } else if (font->read_cb == NULL ||
+               font->read_cb(font,
+                             font->bitmap_offset + slot->dsc.bitmap_index,
+                             g_font_packed_buf, packed_size)) {
+        return NULL;
+    } else {
+        packed = g_font_packed_buf;
+    }
+
+    lcd_font_unpack(packed, font->bpp, pixels, slot->alpha);
+
+    slot->font = font;
+    slot->unicode = unicode;
+    slot->last_use = g_font_cache_tick;
+
+    return slot;
+}
+
+/**
+ * @brief RGB565 颜色混合
+ *
+ * @param fg 前景色
+ * @param bg 背景色
+ * @param alpha 前景色透明度, 0 ~ 255
+ * @return 混合后的颜色
+ */
+static inline uint16_t lcd_font_blend(uint16_t fg, uint16_t bg, uint8_t alpha) {
+    /* 将 RGB565 展开为 00000GGGGGG00000RRRRR000000BBBBB, 三个通道一次算完 */
+    uint32_t a = (alpha + 4) >> 3;
+    uint32_t f = (fg | ((uint32_t)fg << 16)) & 0x07E0F81F;
+    uint32_t b = (bg | ((uint32_t)bg << 16)) & 0x07E0F81F;
+    uint32_t r = ((f * a + b * (32 - a)) >> 5) & 0x07E0F81F;
+
+    return (uint16_t)(r | (r >> 16));
+}
+
+/**
+ * @brief 绘制一个已缓存的字形
+ *
+ * @param x 字符单元左上角 x 坐标
+ * @param y 字符单元左上角 y 坐标
+ * @param font 字库
+ * @param glyph 字形缓存项
+ * @param color 字符颜色
+ * @param bg_color 背景颜色, 整个字符单元都会被填充
+ * @return 步进宽度, 0 表示超出屏幕
+ */
+static uint16_t lcd_font_draw_glyph(uint16_t x, uint16_t y,
+                                    const lcd_font_t *font,
+                                    const lcd_font_cache_t *glyph,
+                                    uint16_t color, uint16_t bg_color) {
+    const lcd_font_glyph_t *dsc = &glyph->dsc;
+    uint16_t cell_w, cell_h = font->line_height;
+    uint16_t rows, row0;
+
+    cell_w = dsc->adv_w;
+
+    if (cell_w == 0 || x + cell_w > lcddev.width ||
+        y + cell_h > lcddev.height) {
+        return 0;
+    }
+
+#if LCD_USE_RGB
+    if (lcdltdc.pwidth != 0 && dsc->box_w != 0 && dsc->ofs_x >= 0 &&
+        dsc->ofs_y >= 0 && dsc->ofs_x + dsc->box_w <= cell_w &&
+        dsc->ofs_y + dsc->box_h <= cell_h) {
+        /* RGB 屏: DMA2D 填充背景后直接混合 A8 字形 */
+        uint32_t rgb888 = ((color & 0xF800) << 8) | ((color & 0x07E0) << 5) |
+                          ((color & 0x001F) << 3);
+
+        lcd_fill(x, y, x + cell_w - 1, y + cell_h - 1, bg_color);
+        if (ltdc_blend_a8(x + dsc->ofs_x, y + dsc->ofs_y, dsc->box_w,
+                          dsc->box_h, glyph->alpha, rgb888) == 0) {
+            return cell_w;
+        }
+    }
+#endif /* LCD_USE_RGB */
+
+    /* CPU 混合, 按缓冲区大小分段, 每段一个窗口整块刷新 */
+    rows = LCD_FONT_BLIT_BUF_SIZE / cell_w;
+    if (rows == 0) {
+        return 0;
+    }
+
+    for (row0 = 0; row0 < cell_h; row0 += rows) {
+        uint16_t band = (cell_h - row0 < rows) ? (cell_h - row0) : rows;
+        uint16_t *buf = g_font_blit_buf;
+
+        for (uint16_t r = 0; r < band; r++) {
+            int32_t gy = (int32_t)(row0 + r) - dsc->ofs_y;
+            const uint8_t *src = NULL;
+
+            if (gy >= 0 && gy < dsc->box_h) {
+                src = glyph->alpha + gy * dsc->box_w;
+            }
+
+            for (uint16_t c = 0; c < cell_w; c++) {
+                int32_t gx = (int32_t)c - dsc->ofs_x;
+                uint8_t alpha = 0;
+
+                if (src != NULL && gx >= 0 && gx < dsc->box_w) {
+                    alpha = src[gx];
+                }
+
+                if (alpha == 0) {
+                    *buf++ = bg_color;
+                } else if (alpha == 255) {
+                    *buf++ = color;
+                } else {
+                    *buf++ = lcd_font_blend(color, bg_color, alpha);
+                }
+            }
+        }
+
+        lcd_color_fill(x, y + row0, x + cell_w - 1, y + row0 + band - 1,
+                       g_font_blit_buf);
+    }
+
+    return cell_w;
+}
+
+/**
+ * @brief 显示一个字符
+ *
+ * @param x 字符单元左上角 x 坐标
+ * @param y 字符单元左上角 y 坐标
+ * @param font 字库
+ * @param unicode 码点
+ * @param color 字符颜色
+ * @param bg_color 背景颜色, 整个字符单元都会被填充
+ * @return 步进宽度, 0 表示超出屏幕或字库中没有此字符
+ */
+uint16_t lcd_font_show_char(uint16_t x, uint16_t y, const lcd_font_t *font,
+                            uint32_t unicode, uint16_t color,
+                            uint16_t bg_color) {
+    lcd_font_cache_t *glyph = lcd_font_get_glyph(font, unicode);
+
+    if (glyph == NULL) {
+        return 0;
+    }
+
+    return lcd_font_draw_glyph(x, y, font, glyph, color, bg_color);
+}
+
+/**
+ * @brief 显示 UTF-8 字符串
+ *
+ * @param x 起始 x 坐标
+ * @param y 起始 y 坐标
+ * @param width 区域宽度
+ * @param height 区域高度
+ * @param font 字库
+ * @param str UTF-8 字符串
+ * @param color 字符颜色
+ * @param bg_color 背景颜色
+ * @note 超出区域宽度自动换行, 超出区域高度停止显示. 字库中没有的字符跳过.
+ */
+void lcd_font_show_string(uint16_t x, uint16_t y, uint16_t width,
+                          uint16_t height, const lcd_font_t *font,
+                          const char *str, uint16_t color, uint16_t bg_color) {
+    uint16_t x0 = x;
+    uint32_t unicode;
+    lcd_font_cache_t *glyph;
+
+    width += x;
+    height += y;
+
+    while ((unicode = lcd_font_utf8_next(&str)) != 0) {
+        if (unicode == '\n') {
+            x = x0;
+            y += font->line_height;
+            continue;
+        }
+
+        glyph = lcd_font_get_glyph(font, unicode);
+        if (glyph == NULL) {
+            continue;
+        }
+
+        if (x + glyph->dsc.adv_w > width) {
+            x = x0;
+            y += font->line_height;
+        }
+
+        if (y + font->line_height > height) {
+            break;
+        }
+
+        x += lcd_font_draw_glyph(x, y, font, glyph, color, bg_color);
+    }
+}
+
+/**
+ * @brief 计算字符串的显示宽度
+ *
+ * @param font 字库
+ * @param str UTF-8 字符串
+ * @return 宽度 (像素), 不处理换行
+ */
+uint16_t lcd_font_text_width(const lcd_font_t *font, const char *str) {
+    uint16_t width = 0;
+    uint32_t unicode;
+    lcd_font_cache_t *glyph;
+
+    while ((unicode = lcd_font_utf8_next(&str)) != 0) {
+        glyph = lcd_font_get_glyph(font, unicode);
+        if (glyph != NULL) {
+            width += glyph->dsc.adv_w;
+        }
+    }
+
+    return width;
+}
+
+/**
+ * @brief 内置 ASCII 字库的读取函数
+ *
+ * @param font 字库
+ * @param offset 读取的偏移地址
+ * @param buf 读取缓冲区
+ * @param len 读取长度
+ * @return 0: 成功; 1: 失败
+ * @note lcdfont.h 的点阵按列取模, 这里在缓存未命中时转换为按行存放的
+ *       1bpp 位图, 不需要另外保存一份字库. 字形描述同样在这里生成.
+ */
+static uint8_t lcd_font_ascii_read(const lcd_font_t *font, uint32_t offset,
+                                   void *buf, uint32_t len) {
+    uint8_t size = font->line_height;
+    uint8_t width = size / 2;
+    uint8_t col_bytes = (size + 7) / 8;
+    uint8_t *bitmap = buf;
+    const uint8_t *pfont;
+    uint32_t glyph_id, bit;
+
+    if (offset < font->bitmap_offset) {
+        lcd_font_glyph_t *dsc = buf;
+
+        if (len != sizeof(lcd_font_glyph_t)) {
+            return 1;
+        }
+
+        glyph_id = offset / sizeof(lcd_font_glyph_t);
+        memset(dsc, 0, sizeof(lcd_font_glyph_t));
+        dsc->bitmap_index = glyph_id * LCD_FONT_ASCII_BITMAP_STRIDE;
+        dsc->adv_w = width;
+        dsc->box_w = width;
+        dsc->box_h = size;
+        return 0;
+    }
+
+    glyph_id = (offset - font->bitmap_offset) / LCD_FONT_ASCII_BITMAP_STRIDE;
+    pfont = lcd_get_char_font((char)(' ' + glyph_id), size);
+    if (pfont == NULL || len < ((uint32_t)width * size + 7) / 8) {
+        return 1;
+    }
+
+    memset(bitmap, 0, len);
+
+    /* 每列 col_bytes 字节, 从上到下, 高位在前 */
+    for (uint8_t col = 0; col < width; col++) {
+        for (uint8_t row = 0; row < size; row++) {
+            if (pfont[col * col_bytes + row / 8] & (0x80 >> (row % 8))) {
+                bit = (uint32_t)row * width + col;
+                bitmap[bit >> 3] |= 0x80 >> (bit & 7);
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 获取内置 ASCII 字库
+ *
+ * @param size 字体大小 12/16/24/32
+ * @return 字库, NULL 表示不支持此字体大小
+ */
+const lcd_font_t *lcd_font_ascii(uint8_t size) {
+    switch (size) {
+        case 12:
+            return &g_font_ascii[0];
+
+        case 16:
+            return &g_font_ascii[1];
+
+        case 24:
+            return &g_font_ascii[2];
+
+        case 32:
+            return &g_font_ascii[3];
+
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * @brief 清空字形缓存
+ *
+ * @note 字库内容变化 (例如重新写入外部 Flash) 后需要调用.
+ */
+void lcd_font_cache_clear(void) {
+    memset(g_font_cache, 0, sizeof(g_font_cache));
+    g_font_cache_tick = 0;
+    g_font_cache_hit = 0;
+    g_font_cache_miss = 0;
+}
+
+/**
+ * @brief 获取字形缓存命中统计
+ *
+ * @param[out] hit 命中次数, 可以为 NULL
+ * @param[out] miss 未命中次数, 可以为 NULL
+ */
+void lcd_font_cache_stat(uint32_t *hit, uint32_t *miss) {
+    if (hit != NULL) {
+        *hit = g_font_cache_hit;
+    }
+
+    if (miss != NULL) {
+        *miss = g_font_cache_miss;
+    }
+}
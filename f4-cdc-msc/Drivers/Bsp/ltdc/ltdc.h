@@ -42,7 +42,7 @@ typedef struct {
     uint16_t hfp;        /*!< 水平前廊 */
     uint16_t vfp;        /*!< 垂直前廊  */
     uint8_t activelayer; /*!< 当前层编号 0/1 */
-    uint8_t dir;         /*!< 屏幕方向. 0-竖屏; 1-横屏 */
+    uint8_t dir; /*!< 屏幕方向. 0-竖屏; 1-横屏; 2-竖屏 (270°); 3-横屏 (180°) */
     uint16_t width;      /*!< LTDC 宽度 */
     uint16_t height;     /*!< LTDC 高度 */
     uint32_t pixsize;    /*!< 每个像素所占字节数 */
@@ -97,6 +97,13 @@ extern DMA2D_HandleTypeDef dma2d_handle; /* DMA2D 句柄 */
 #define LTDC_PIXFORMAT_AL44     0X06 /* AL44 格式 */
 #define LTDC_PIXFORMAT_AL88     0X07 /* AL88 格式 */
 
+/* 竖屏刷新颜色块时的转置分块边长, 可选 8 或 16 */
+#define LTDC_ROTATE_TILE_SIZE   16
+/* 竖屏刷新时每次交给 DMA2D 搬运的块宽度 (像素), 须为分块边长的整数倍 */
+#define LTDC_ROTATE_BLOCK_WIDTH 64
+/* 是否编译旋转刷新测速函数 ltdc_rotate_benchmark */
+#define LTDC_ROTATE_BENCHMARK   0
+
 /* LTDC 背光控制 */
 #define LTDC_BL(X)                                                             \
     X ? HAL_GPIO_WritePin(CSP_GPIO_PORT(LTDC_BL_GPIO_PORT), LTDC_BL_GPIO_PIN,  \
@@ -114,7 +121,12 @@ void ltdc_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey,
                uint32_t color);
 void ltdc_color_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey,
                      uint16_t *color);
+uint8_t ltdc_blend_a8(uint16_t sx, uint16_t sy, uint16_t width,
+                      uint16_t height, const uint8_t *alpha, uint32_t color);
 void ltdc_clear(uint32_t color);
+#if LTDC_ROTATE_BENCHMARK
+void ltdc_rotate_benchmark(void);
+#endif /* LTDC_ROTATE_BENCHMARK */
 uint8_t ltdc_clk_set(uint32_t pllsain, uint32_t pllsair, uint32_t pllsaidivr);
 void ltdc_layer_window_config(uint8_t layerx, uint16_t sx, uint16_t sy,
                               uint16_t width, uint16_t height);
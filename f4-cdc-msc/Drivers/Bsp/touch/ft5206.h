@@ -188,7 +188,8 @@ uint8_t ft5206_scan(uint8_t mode) {
 
     t++;
 
-    if ((t % 10) == 0 || t < 10) {
+    /* 中断方式采集时只在 INT 触发后调用, 不需要降低查询频率 */
+    if (TP_USE_INT || (t % 10) == 0 || t < 10) {
         /* 空闲时,每进入 10 次 CTP_Scan 函数才检测 1 次, 从而节省 CPU 使用率 */
         ft5206_rd_reg(FT5206_REG_NUM_FINGER, &sta, 1); /* 读取触摸点的状态 */
 
@@ -220,6 +221,8 @@ uint8_t ft5206_scan(uint8_t mode) {
                     if ((buf[0] & 0XF0) != 0X80) {
                         /* 必须是 contact 事件,才认为有效 */
                         tp_dev.x[i] = tp_dev.y[i] = 0;
+                    } else {
+                        tp_dir_rotate(&tp_dev.x[i], &tp_dev.y[i]);
                     }
                 }
             }
@@ -45,6 +45,38 @@
 #define TP_CLK_GPIO_PORT  H
 #define TP_CLK_GPIO_PIN   GPIO_PIN_6
 
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup 触摸屏中断采集
+ * @note 电容屏的 INT 引脚与电阻屏的 TP_PEN 是同一个引脚. 电容屏的 I2C
+ *       引脚 (PH6/PI3) 和电阻屏的 SPI 引脚都不是硬件外设引脚, 所以仍然使用
+ *       软件时序读取坐标, 但只在 INT/PENIRQ 触发后由采集任务读取,
+ *       空闲时不占用 CPU.
+ * @{
+ */
+
+/* 是否使用中断方式采集坐标 (需要 FreeRTOS) */
+#define TP_USE_INT             1
+
+#define TP_INT_GPIO_PORT       H
+#define TP_INT_GPIO_PIN        GPIO_PIN_7
+#define TP_INT_IRQn            EXTI9_5_IRQn
+#define TP_INT_IRQHandler      EXTI9_5_IRQHandler
+#define TP_INT_IT_PRIORITY     6
+
+/* 采集任务的优先级和栈大小 (字) */
+#define TP_TASK_PRIORITY       3
+#define TP_TASK_STACK_SIZE     256
+/* 坐标队列长度, 满了之后丢弃最旧的坐标 */
+#define TP_SAMPLE_QUEUE_LEN    8
+/* 按下期间多久没有 INT 就主动读一次, 用于检测松开 (ms) */
+#define TP_RELEASE_TIMEOUT_MS  30
+/* 电阻屏按下期间的采样周期 (ms) */
+#define TP_RT_SAMPLE_MS        5
+
 /**
  * @}
  */
@@ -127,7 +159,8 @@ typedef struct {
 
     /*!< 新增的参数,当触摸屏的左右上下完全颠倒时需要用到.
      * bit[7]:      0: 电阻屏; 1: 电容屏
-     * bit[6:1]:    保留.
+     * bit[6:2]:    保留.
+     * bit[1]:      0: 正常; 1: 旋转 180° (LCD 方向 2 / 3)
      * bit[0]:      0: 竖屏 (适合左右为 X 坐标, 上下为 Y 坐标的 TP)
      *              1: 横屏 (适合左右为 Y 坐标, 上下为 X 坐标的 TP)
      */
@@ -137,6 +170,16 @@ typedef struct {
 /* 触屏控制器在 touch.c 里面定义 */
 extern tp_dev_t tp_dev;
 
+/**
+ * @brief 带时间戳的触摸坐标
+ */
+typedef struct {
+    uint16_t x;      /*!< x 坐标 */
+    uint16_t y;      /*!< y 坐标 */
+    uint8_t pressed; /*!< 0: 松开; 1: 按下 */
+    uint32_t tick;   /*!< 采集时的系统节拍 */
+} tp_sample_t;
+
 /**
  * @}
  */
@@ -152,6 +195,13 @@ void tp_save_adjust_data(const uint8_t *data, uint16_t len);
 void tp_read_adjust_data(uint8_t *data, uint16_t len);
 void tp_draw_big_point(uint16_t x, uint16_t y, uint16_t color);
 
+#if TP_USE_INT
+uint8_t tp_int_start(void);
+uint8_t tp_sample_read(tp_sample_t *sample);
+uint32_t tp_sample_pending(void);
+void tp_sample_set_callback(void (*callback)(void));
+#endif /* TP_USE_INT */
+
 /**
  * @}
  */
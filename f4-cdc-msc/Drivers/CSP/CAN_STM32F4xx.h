@@ -36,8 +36,40 @@ extern "C" {
 #define CAN_DEINIT_FAIL         1
 #define CAN_NO_INIT             2
 
-/* Wait for can tx mailbox empty times. */
-#define CAN_SEND_TIMEOUT        100
+#define CAN_SEND_OK             0
+#define CAN_SEND_QUEUE_FULL     2
+#define CAN_SEND_PARAM_ERR      3
+#define CAN_SEND_NO_INIT        4
+
+#define CAN_FILTER_OK           0
+#define CAN_FILTER_PARAM_ERR    1
+#define CAN_FILTER_FULL         2
+#define CAN_FILTER_NO_BANK      3
+#define CAN_FILTER_FAIL         4
+
+#define CAN_STATS_OK            0
+#define CAN_STATS_PARAM_ERR     1
+#define CAN_STATS_NO_INIT       2
+#define CAN_STATS_FAIL          3
+
+/* Error state of a CAN. */
+#define CAN_ERR_ACTIVE          0
+#define CAN_ERR_WARNING         1
+#define CAN_ERR_PASSIVE         2
+#define CAN_ERR_BUS_OFF         3
+
+/* Bus-off recovery. */
+#define CAN_BUS_OFF_MANUAL      0 /* Wait for `can_bus_off_recover` */
+#define CAN_BUS_OFF_AUTO        1 /* Hardware, after 128 x 11 recessive bits */
+
+/* Frames waiting for a tx mailbox of each CAN. */
+#define CAN_TX_QUEUE_SIZE       16
+
+/* Receive subscriptions (ID and mask) of each CAN. */
+#define CAN_RX_FILTER_NUM       16
+
+/* ID ranges counted separately of each CAN. */
+#define CAN_STATS_RANGE_NUM     4
 
 /**
  * @}
@@ -58,6 +90,75 @@ typedef enum {
     can3_selected       /*!< Select CAN3 */
 } can_selected_t;
 
+/**
+ * @brief CAN frame.
+ */
+typedef struct {
+    uint32_t id;        /*!< Standard ID or Extend ID */
+    uint8_t ide;        /*!< `CAN_ID_STD` or `CAN_ID_EXT` */
+    uint8_t rtr;        /*!< `CAN_RTR_DATA` or `CAN_RTR_REMOTE` */
+    uint8_t len;        /*!< Data length, 0-8 */
+    uint8_t data[8];    /*!< Data */
+} can_frame_t;
+
+/**
+ * @brief Receive ring of a subscriber. It is written in CAN RX interrupt and
+ *        read by one task, no lock is needed.
+ */
+typedef struct can_rx_ring {
+    can_frame_t *buf;           /*!< Frames, provided by user */
+    uint32_t size;              /*!< Number of frames, must be power of 2 */
+    volatile uint32_t head;     /*!< Number of frames written */
+    volatile uint32_t tail;     /*!< Number of frames read */
+    volatile uint32_t lost;     /*!< Frames dropped because the ring is full */
+    void (*callback)(struct can_rx_ring *ring); /*!< Called in interrupt after
+                                                     frames received, can be
+                                                     NULL */
+} can_rx_ring_t;
+
+/**
+ * @brief Counters of an ID range.
+ */
+typedef struct {
+    uint32_t id_min;    /*!< The smallest ID */
+    uint32_t id_max;    /*!< The largest ID, smaller than `id_min`: unused */
+    uint8_t ide;        /*!< `CAN_ID_STD` or `CAN_ID_EXT` */
+    uint32_t tx_frames; /*!< Frames sent */
+    uint32_t tx_bytes;  /*!< Data bytes sent */
+    uint32_t rx_frames; /*!< Frames received */
+    uint32_t rx_bytes;  /*!< Data bytes received */
+} can_stats_range_t;
+
+/**
+ * @brief Statistics of a CAN.
+ */
+typedef struct {
+    uint32_t tx_frames;     /*!< Frames sent */
+    uint32_t tx_bytes;      /*!< Data bytes sent */
+    uint32_t tx_dropped;    /*!< Frames rejected, the queue is full */
+    uint32_t tx_retry;      /*!< Mailboxes aborted or failed, put back */
+    uint32_t tx_wait_avg;   /*!< Average time from `can_send` to sent, us */
+    uint32_t tx_wait_max;   /*!< Maximum time from `can_send` to sent, us */
+    uint32_t rx_frames;     /*!< Frames received */
+    uint32_t rx_bytes;      /*!< Data bytes received */
+    uint32_t rx_overrun;    /*!< FIFO overruns, frames are lost */
+    uint32_t rx_lost;       /*!< Frames dropped, the ring is full */
+    uint32_t load;          /*!< Bus load, unit: 0.1% */
+    uint32_t errors;        /*!< Protocol errors, need SCE interrupt */
+    uint32_t warning_count; /*!< Times of error warning */
+    uint32_t passive_count; /*!< Times of error passive */
+    uint32_t bus_off_count; /*!< Times of bus-off */
+    uint32_t recover_count; /*!< Times of leaving bus-off */
+    uint32_t passive_tick;  /*!< Tick of the last error passive, ms */
+    uint32_t bus_off_tick;  /*!< Tick of the last bus-off, ms */
+    uint32_t recover_tick;  /*!< Tick of the last leaving bus-off, ms */
+    uint8_t tec;            /*!< Transmit error counter */
+    uint8_t rec;            /*!< Receive error counter */
+    uint8_t state;          /*!< `CAN_ERR_ACTIVE` ... `CAN_ERR_BUS_OFF` */
+    uint8_t last_error;     /*!< Last error code (LEC), 0: no error */
+    can_stats_range_t range[CAN_STATS_RANGE_NUM]; /*!< ID ranges */
+} can_stats_t;
+
 /**
  * @}
  */
@@ -157,11 +258,37 @@ uint8_t can_rate_calc(uint32_t baud_rate, uint32_t prop_delay,
                       uint32_t base_freq, uint32_t *prescale, uint32_t *tsjw,
                       uint32_t *tseg1, uint32_t *tseg2);
 
-CAN_HandleTypeDef *can_get_handle(can_selected_t can_select);
+CAN_HandleTypeDef *can_get_handle(can_selected_t can_selected);
+uint8_t can_send(can_selected_t can_selected, const can_frame_t *frame);
+uint8_t can_send_timeout(can_selected_t can_selected, const can_frame_t *frame,
+                         uint32_t timeout);
+uint32_t can_tx_pending(can_selected_t can_selected);
+void can_set_tx_callback(can_selected_t can_selected,
+                         void (*callback)(can_selected_t can_selected));
 uint8_t can_send_message(can_selected_t can_selected, uint32_t can_ide,
                          uint32_t id, uint8_t len, const uint8_t *msg);
 uint8_t can_send_remote(can_selected_t can_selected, uint32_t can_ide,
                         uint32_t id, uint8_t len, const uint8_t *msg);
+
+uint8_t can_rx_ring_init(can_rx_ring_t *ring, can_frame_t *buf, uint32_t size,
+                         void (*callback)(can_rx_ring_t *ring));
+can_frame_t *can_rx_ring_peek(can_rx_ring_t *ring);
+void can_rx_ring_pop(can_rx_ring_t *ring);
+uint32_t can_rx_ring_count(can_rx_ring_t *ring);
+uint8_t can_rx_subscribe(can_selected_t can_selected, uint32_t can_ide,
+                         uint32_t id, uint32_t mask, uint32_t fifo,
+                         can_rx_ring_t *ring);
+uint8_t can_rx_unsubscribe(can_selected_t can_selected, can_rx_ring_t *ring);
+
+uint8_t can_stats_get(can_selected_t can_selected, can_stats_t *stats);
+void can_stats_reset(can_selected_t can_selected);
+uint8_t can_stats_set_range(can_selected_t can_selected, uint32_t index,
+                            uint32_t can_ide, uint32_t id_min, uint32_t id_max);
+void can_stats_print(can_selected_t can_selected,
+                     int (*print)(const char *fmt, ...));
+uint8_t can_set_bus_off_recovery(can_selected_t can_selected, uint8_t mode);
+uint8_t can_bus_off_recover(can_selected_t can_selected);
+
 /**
  * @}
  */
@@ -0,0 +1,101 @@
+/**
+ * @file    usbd_event.c
+ * @author  Deadline039
+ * @brief   USB 状态事件
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#include "usbd_event.h"
+
+#include "stm32f4xx_hal.h"
+
+#include "FreeRTOS.h"
+#include "event_groups.h"
+#include "task.h"
+
+static EventGroupHandle_t g_usbd_event_group;
+
+/* 尚未被取走的事件. 已经挂起的事件不再重复发送到事件组,
+   MSC 连续读写时每次等待最多只产生一次中断到任务的通知 */
+static volatile uint32_t g_usbd_event_pending;
+
+/**
+ * @brief 初始化 USB 事件
+ *
+ * @note 需要在 `USBD_Start` 之前调用, 调度器启动前后均可.
+ */
+void usbd_event_init(void) {
+    if (g_usbd_event_group == NULL) {
+        g_usbd_event_group = xEventGroupCreate();
+    }
+
+    g_usbd_event_pending = 0;
+}
+
+/**
+ * @brief 发布 USB 事件
+ *
+ * @param events 事件, `USBD_EVENT_xxx` 的组合
+ * @note 可以在中断和任务中调用. 在中断中调用时, 中断优先级不能高于
+ *       `configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY`.
+ */
+void usbd_event_set(uint32_t events) {
+    uint32_t primask = __get_PRIMASK();
+    uint32_t new_events;
+
+    __disable_irq();
+    new_events = events & ~g_usbd_event_pending;
+    g_usbd_event_pending |= events;
+    __set_PRIMASK(primask);
+
+    if (new_events == 0 || g_usbd_event_group == NULL ||
+        xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        return;
+    }
+
+    if (__get_IPSR() != 0) {
+        BaseType_t higher_task_woken = pdFALSE;
+
+        xEventGroupSetBitsFromISR(g_usbd_event_group, new_events,
+                                  &higher_task_woken);
+        portYIELD_FROM_ISR(higher_task_woken);
+    } else {
+        xEventGroupSetBits(g_usbd_event_group, new_events);
+    }
+}
+
+/**
+ * @brief 等待 USB 事件
+ *
+ * @param timeout_ms 超时时间 (ms)
+ * @return 等待期间发生的事件, 0 表示超时. 返回的事件会被清除.
+ */
+uint32_t usbd_event_wait(uint32_t timeout_ms) {
+    uint32_t start = HAL_GetTick();
+    uint32_t events = 0;
+
+    if (g_usbd_event_group != NULL &&
+        xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        events = xEventGroupWaitBits(g_usbd_event_group, USBD_EVENT_ALL,
+                                     pdTRUE, pdFALSE,
+                                     pdMS_TO_TICKS(timeout_ms));
+    } else {
+        /* 调度器未启动, 睡眠直到 USB 或 SysTick 中断 */
+        while (g_usbd_event_pending == 0 &&
+               HAL_GetTick() - start < timeout_ms) {
+            __WFI();
+        }
+    }
+
+    __disable_irq();
+    events |= g_usbd_event_pending;
+    g_usbd_event_pending = 0;
+    __enable_irq();
+
+    return events & USBD_EVENT_ALL;
+}
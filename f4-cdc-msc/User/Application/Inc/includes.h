@@ -30,6 +30,7 @@ extern "C" {
 #include "usbd_conf.h"
 #include "usbd_core.h"
 #include "usbd_desc.h"
+#include "usbd_event.h"
 #include "usbd_msc.h"
 #include "usbd_storage_if.h"
 
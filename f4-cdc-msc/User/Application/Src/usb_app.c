@@ -11,6 +11,9 @@
 USBD_HandleTypeDef usbd_device;
 TaskHandle_t usb_app_handle;
 
+/* 读写状态的保持时间 (ms), 超过此时间没有读写则不再显示 */
+#define USB_APP_ACTIVITY_MS 50
+
 /**
  * @brief USB 程序任务
  *
@@ -19,9 +22,10 @@ TaskHandle_t usb_app_handle;
 void usb_app(void *pvParameters) {
     UNUSED(pvParameters);
 
-    uint8_t last_usb_state_reg = 0;
-    uint8_t last_usb_dev_state = 0;
-    uint8_t times = 0;
+    lcd_comp_widget_t *dev_label;
+    lcd_comp_widget_t *msc_label[4];
+    uint32_t msc_state = 0;
+    uint32_t window_tick;
 
     lcd_init();
     lcd_display_dir(1);
@@ -31,59 +35,49 @@ void usb_app(void *pvParameters) {
 
     sdcard_init();
 
+    usbd_event_init();
     USBD_Init(&usbd_device, &USBD_Desc, DEVICE_FS);
     USBD_RegisterClass(&usbd_device, &USBD_MC);
     USBD_Start(&usbd_device);
 
-    lcd_clear(WHITE);
-    lcd_show_string(disp_x - 80, disp_y - 20, 200, 24, 16,
-                    "USB MSC & CDC composite. ", BLACK);
+    /* 界面只在状态变化时局部刷新, 最多 50 帧 / 秒 */
+    lcd_comp_init(WHITE, 20);
+    lcd_comp_create_label(disp_x - 80, disp_y - 20, 200, 16, 16,
+                          "USB MSC & CDC composite. ", BLACK);
+    dev_label = lcd_comp_create_label(disp_x - 80, disp_y - 40, 144, 16, 16,
+                                      "USB Disconnected.", BLACK);
+    msc_label[0] = lcd_comp_create_label(disp_x - 80, disp_y, 144, 16, 16,
+                                         "USB Writing...", RED);
+    msc_label[1] = lcd_comp_create_label(disp_x - 80, disp_y + 16, 144, 16, 16,
+                                         "USB Reading...", BLUE);
+    msc_label[2] = lcd_comp_create_label(disp_x - 80, disp_y + 16 * 2, 144, 16,
+                                         16, "USB Write Error.", RED);
+    msc_label[3] = lcd_comp_create_label(disp_x - 80, disp_y + 16 * 3, 144, 16,
+                                         16, "USB Read Error.", RED);
+
+    window_tick = HAL_GetTick();
 
     while (1) {
-        if (last_usb_state_reg != g_usb_msc_state) {
-            lcd_fill(disp_x - 80, disp_y, disp_x + 100, disp_y + 16 * 4, WHITE);
-            if (g_usb_msc_state & (1 << 0)) {
-                lcd_show_string(disp_x - 80, disp_y, 100, 16, 16,
-                                "USB Writing...", RED);
-            }
-
-            if (g_usb_msc_state & (1 << 1)) {
-                lcd_show_string(disp_x - 80, disp_y + 16, 100, 16, 16,
-                                "USB Reading...", BLUE);
-            }
-
-            if (g_usb_msc_state & (1 << 2)) {
-                lcd_show_string(disp_x - 80, disp_y + 16 * 2, 100, 16, 16,
-                                "USB Write Error. ", RED);
-            }
-
-            if (g_usb_msc_state & (1 << 3)) {
-                lcd_show_string(disp_x - 80, disp_y + 16 * 3, 100, 16, 16,
-                                "USB Read Error. ", RED);
-            }
-
-            last_usb_state_reg = g_usb_msc_state;
+        for (uint8_t i = 0; i < 4; i++) {
+            lcd_comp_set_visible(msc_label[i], msc_state & (1 << i));
         }
 
-        if (last_usb_dev_state != g_usb_dev_state) {
-            if (g_usb_dev_state) {
-                lcd_show_string(disp_x - 80, disp_y - 40, 100, 16, 16,
-                                "USB Connected.    ", BLACK);
-            } else {
-                lcd_show_string(disp_x - 80, disp_y - 40, 100, 16, 16,
-                                "USB Disconnected. ", BLACK);
-            }
-
-            last_usb_dev_state = g_usb_dev_state;
-        }
+        lcd_comp_set_text(dev_label, g_usb_dev_state ? "USB Connected."
+                                                     : "USB Disconnected.");
 
-        delay_ms(1);
+        /* 按 lcd_comp_init 设定的周期刷新; 被限速的脏区域在下一次
+           事件或等待超时 (不超过 50ms) 后刷新 */
+        lcd_comp_refresh();
 
-        ++times;
+        /* 阻塞等待 USB 事件, 超时用于让读写状态消失 */
+        uint32_t events = usbd_event_wait(USB_APP_ACTIVITY_MS);
 
-        if (times % 50 == 0) {
-            /* 每 50ms 更新一次设备状态 */
-            g_usb_msc_state = 0;
+        if (HAL_GetTick() - window_tick >= USB_APP_ACTIVITY_MS) {
+            /* 每 50ms 重新统计一次读写状态 */
+            window_tick = HAL_GetTick();
+            msc_state = 0;
         }
+
+        msc_state |= events & USBD_EVENT_MSC_ALL;
     }
 }
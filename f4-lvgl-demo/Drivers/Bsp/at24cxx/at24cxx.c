@@ -25,76 +25,115 @@
 
 #include "at24cxx.h"
 
+#include "../core/core_delay.h"
+#include "task.h"
 #include <string.h>
 
 /**
- * @brief AT24CXX I2C 读取一字节
+ * @brief I2C 传输完成, 唤醒等待的任务
  *
- * @param at24cxx 句柄
- * @param addr 地址
- * @return 读到的字节
+ * @param user 句柄
+ * @param status 传输状态
  */
-static uint8_t at24cxx_i2c_read_byte(at24cxx_handle_t *at24cxx, uint16_t addr) {
-    uint16_t dev_address;
-    uint16_t mem_address;
-    uint16_t address_size;
-    uint8_t byte;
+static void at24cxx_xfer_done(void *user, uint8_t status) {
+    at24cxx_handle_t *at24cxx = (at24cxx_handle_t *)user;
+    BaseType_t higher_task_woken = pdFALSE;
 
-    if (at24cxx->model > (uint16_t)AT24C16) {
-        dev_address = at24cxx->address + ((addr / 65536) << 1);
-        mem_address = addr % 65536;
-        address_size = I2C_MEMADD_SIZE_16BIT;
+    UNUSED(status);
+
+    if (xPortIsInsideInterrupt()) {
+        xSemaphoreGiveFromISR(at24cxx->done, &higher_task_woken);
+        portYIELD_FROM_ISR(higher_task_woken);
     } else {
-        dev_address = at24cxx->address + ((addr / 256) << 1);
-        mem_address = addr % 256;
-        address_size = I2C_MEMADD_SIZE_8BIT;
+        xSemaphoreGive(at24cxx->done);
     }
-
-    HAL_I2C_Mem_Read(at24cxx->hi2c, dev_address, mem_address, address_size,
-                     &byte, 1, 1000);
-
-    return byte;
 }
 
 /**
- * @brief AT24CXX I2C 写入一字节
+ * @brief 读写一段数据, 不能跨过 256 字节的块 (AT24C16 及以下)
  *
  * @param at24cxx 句柄
+ * @param type `I2C_XFER_MEM_READ` 或 `I2C_XFER_MEM_WRITE`
  * @param addr 地址
- * @param byte 要写入的字节
+ * @param buf 数据缓冲区
+ * @param len 长度
  * @return 操作状态
+ * @note 传输放入 I2C 总线队列, 调度器运行时等待句柄的信号量, 不占用 CPU,
+ *       也不占用任务通知. 器件正在写入时不应答, 会重试 `AT24CXX_RETRY` 次.
  */
-static at24cxx_result_t at24cxx_i2c_write_byte(at24cxx_handle_t *at24cxx,
-                                               uint16_t addr,
-                                               const uint8_t byte) {
-    uint16_t dev_address;
-    uint16_t mem_address;
-    uint16_t address_size;
+static at24cxx_result_t at24cxx_transfer(at24cxx_handle_t *at24cxx,
+                                         uint8_t type, uint16_t addr,
+                                         uint8_t *buf, uint16_t len) {
+    i2c_xfer_t xfer;
+    uint8_t retry;
+
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.type = type;
+    xfer.buf = buf;
+    xfer.len = len;
 
     if (at24cxx->model > (uint16_t)AT24C16) {
-        dev_address = at24cxx->address + ((addr / 65536) << 1);
-        mem_address = addr % 65536;
-        address_size = I2C_MEMADD_SIZE_16BIT;
+        xfer.dev_addr = at24cxx->address;
+        xfer.mem_addr = addr;
+        xfer.mem_addr_size = I2C_MEMADD_SIZE_16BIT;
     } else {
-        dev_address = at24cxx->address + ((addr / 256) << 1);
-        mem_address = addr % 256;
-        address_size = I2C_MEMADD_SIZE_8BIT;
+        xfer.dev_addr = at24cxx->address + ((addr / 256) << 1);
+        xfer.mem_addr = addr % 256;
+        xfer.mem_addr_size = I2C_MEMADD_SIZE_8BIT;
     }
 
-    if (HAL_I2C_Mem_Write(at24cxx->hi2c, dev_address, mem_address, address_size,
-                          (uint8_t *)&byte, 1, 1000) != HAL_OK) {
-        return AT24CXX_ERROR;
+    if (at24cxx->done != NULL &&
+        xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        xfer.callback = at24cxx_xfer_done;
+        xfer.user = at24cxx;
     }
 
-    /* Wait for the end of the transfer */
-    while (HAL_I2C_GetState(at24cxx->hi2c) != HAL_I2C_STATE_READY)
-        ;
-    /* Check if the Devices is ready for a new operation */
-    while (HAL_I2C_IsDeviceReady(at24cxx->hi2c, dev_address, 0xF, 0xF) !=
-           HAL_OK)
-        ;
+    for (retry = 0;; ++retry) {
+        if (i2c_bus_submit(at24cxx->hi2c, &xfer) != I2C_BUS_OK) {
+            return AT24CXX_ERROR;
+        }
 
-    return AT24CXX_OK;
+        if (xfer.callback != NULL) {
+            /* 信号量可能是之前的传输留下的, 需要再检查状态 */
+            while (xfer.status == I2C_BUS_PENDING) {
+                xSemaphoreTake(at24cxx->done, portMAX_DELAY);
+            }
+        } else {
+            i2c_bus_wait(&xfer, HAL_MAX_DELAY);
+        }
+
+        if (xfer.status == I2C_BUS_OK) {
+            return AT24CXX_OK;
+        }
+
+        if (xfer.status != I2C_BUS_NACK || retry >= AT24CXX_RETRY) {
+            return AT24CXX_ERROR;
+        }
+
+        delay_ms(1);
+    }
+}
+
+/**
+ * @brief 页大小
+ *
+ * @param model 型号
+ * @return 页大小 (byte)
+ */
+static uint16_t at24cxx_page_size(at24cxx_model_t model) {
+    if (model <= AT24C02) {
+        return 8;
+    }
+
+    if (model <= AT24C16) {
+        return 16;
+    }
+
+    if (model <= AT24C64) {
+        return 32;
+    }
+
+    return 64;
 }
 
 /**
@@ -121,6 +160,7 @@ at24cxx_result_t at24cxx_init(at24cxx_handle_t *at24cxx,
     at24cxx->model = model;
     at24cxx->address = 0xA0;
     at24cxx->address |= address << 1;
+    at24cxx->done = xSemaphoreCreateBinary();
 
     return AT24CXX_OK;
 }
@@ -136,6 +176,10 @@ at24cxx_result_t at24cxx_deinit(at24cxx_handle_t *at24cxx) {
         return AT24CXX_ERROR;
     }
 
+    if (at24cxx->done != NULL) {
+        vSemaphoreDelete(at24cxx->done);
+    }
+
     memset(at24cxx, 0, sizeof(at24cxx_handle_t));
 
     return AT24CXX_OK;
@@ -149,11 +193,11 @@ at24cxx_result_t at24cxx_deinit(at24cxx_handle_t *at24cxx) {
  * @return 读到的字节
  */
 uint8_t at24cxx_read_byte(at24cxx_handle_t *at24cxx, uint16_t address) {
-    if (at24cxx == NULL) {
-        return 0;
-    }
+    uint8_t byte = 0;
+
+    at24cxx_read(at24cxx, address, &byte, 1);
 
-    return at24cxx_i2c_read_byte(at24cxx, address);
+    return byte;
 }
 
 /**
@@ -166,11 +210,7 @@ uint8_t at24cxx_read_byte(at24cxx_handle_t *at24cxx, uint16_t address) {
  */
 at24cxx_result_t at24cxx_write_byte(at24cxx_handle_t *at24cxx, uint16_t address,
                                     const uint8_t byte) {
-    if (at24cxx == NULL) {
-        return AT24CXX_ERROR;
-    }
-
-    return at24cxx_i2c_write_byte(at24cxx, address, byte);
+    return at24cxx_write(at24cxx, address, &byte, 1);
 }
 
 /**
@@ -184,6 +224,8 @@ at24cxx_result_t at24cxx_write_byte(at24cxx_handle_t *at24cxx, uint16_t address,
  */
 at24cxx_result_t at24cxx_read(at24cxx_handle_t *at24cxx, uint16_t address,
                               uint8_t *data_buf, uint16_t data_len) {
+    uint16_t len;
+
     if (at24cxx == NULL) {
         return AT24CXX_ERROR;
     }
@@ -192,8 +234,22 @@ at24cxx_result_t at24cxx_read(at24cxx_handle_t *at24cxx, uint16_t address,
         return AT24CXX_ERROR;
     }
 
-    for (uint32_t i = 0; i < data_len; ++i) {
-        data_buf[i] = at24cxx_i2c_read_byte(at24cxx, address + i);
+    while (data_len != 0) {
+        len = data_len;
+        /* 器件地址包含块号, 跨块时要分开读 */
+        if (at24cxx->model <= (uint16_t)AT24C16 &&
+            len > 256 - address % 256) {
+            len = 256 - address % 256;
+        }
+
+        if (at24cxx_transfer(at24cxx, I2C_XFER_MEM_READ, address, data_buf,
+                             len) != AT24CXX_OK) {
+            return AT24CXX_ERROR;
+        }
+
+        address += len;
+        data_buf += len;
+        data_len -= len;
     }
 
     return AT24CXX_OK;
@@ -210,6 +266,9 @@ at24cxx_result_t at24cxx_read(at24cxx_handle_t *at24cxx, uint16_t address,
  */
 at24cxx_result_t at24cxx_write(at24cxx_handle_t *at24cxx, uint16_t address,
                                const uint8_t *data_buf, uint16_t data_len) {
+    uint16_t page;
+    uint16_t len;
+
     if (at24cxx == NULL) {
         return AT24CXX_ERROR;
     }
@@ -218,9 +277,27 @@ at24cxx_result_t at24cxx_write(at24cxx_handle_t *at24cxx, uint16_t address,
         return AT24CXX_ERROR;
     }
 
-    for (uint32_t i = 0; i < data_len; ++i) {
-        at24cxx_i2c_write_byte(at24cxx, address + i,
-                               (const uint8_t)(data_buf[i]));
+    page = at24cxx_page_size(at24cxx->model);
+
+    while (data_len != 0) {
+        /* 一次最多写到页的末尾, 否则会回到页首覆盖 */
+        len = page - address % page;
+        if (len > data_len) {
+            len = data_len;
+        }
+
+        if (at24cxx_transfer(at24cxx, I2C_XFER_MEM_WRITE, address,
+                             (uint8_t *)data_buf, len) != AT24CXX_OK) {
+            return AT24CXX_ERROR;
+        }
+
+        /* 等待写周期, 期间器件不应答 */
+        delay_ms(AT24CXX_WRITE_TIME);
+
+        address += len;
+        data_buf += len;
+        data_len -= len;
     }
+
     return AT24CXX_OK;
 }
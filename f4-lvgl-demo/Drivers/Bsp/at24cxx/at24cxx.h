@@ -27,6 +27,13 @@
 #define __AT24CXX_H
 
 #include <CSP_Config.h>
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* 写周期时间, 单位: ms */
+#define AT24CXX_WRITE_TIME 5
+/* 器件不应答时的重试次数, 每次间隔 1ms */
+#define AT24CXX_RETRY      3
 
 /**
  * @brief AT24CXX 型号定义, 值为最大容量 (byte)
@@ -72,6 +79,7 @@ typedef struct {
     I2C_HandleTypeDef *hi2c; /*!< I2C 句柄定义 */
     at24cxx_model_t model;   /*!< 型号 (值为容量) */
     uint8_t address;         /*!< I2C 器件地址 */
+    SemaphoreHandle_t done;  /*!< I2C 传输完成 */
 } at24cxx_handle_t;
 
 at24cxx_result_t at24cxx_init(at24cxx_handle_t *at24cxx,
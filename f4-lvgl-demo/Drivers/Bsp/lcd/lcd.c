@@ -19,6 +19,7 @@
 #include "lcd.h"
 
 #include "lcd_ex.h"
+#include "lcd_font.h"
 #include "lcdfont.h"
 
 static SRAM_HandleTypeDef sram_handle; /* SRAM 句柄 (用于控制 LCD) */
@@ -408,6 +409,8 @@ void lcd_ssd_backlight_set(uint8_t pwm) {
  * @brief 设置 LCD 显示方向
  *
  * @param dir 0, 竖屏;1, 横屏
+ * @note RGB 屏还支持 2, 竖屏 (旋转 270°); 3, 横屏 (旋转 180°).
+ *       MCU 屏传入非 0 值均按横屏处理.
  */
 void lcd_display_dir(uint8_t dir) {
     lcddev.dir = dir; /* 竖屏 / 横屏 */
@@ -1107,6 +1110,42 @@ void lcd_fill_circle(uint16_t x, uint16_t y, uint16_t r, uint16_t color) {
     }
 }
 
+/**
+ * @brief 获取 ASCII 字符的点阵数据
+ *
+ * @param chr 字符 ' ' --> '~'
+ * @param size 字体大小 12/16/24/32
+ * @return 点阵数据首地址, NULL 表示不支持此字符或字体大小
+ * @note 点阵按列存放, 每列从上到下, 高位在前, 每列占 `(size + 7) / 8` 字节,
+ *       共 `size / 2` 列.
+ */
+const uint8_t *lcd_get_char_font(char chr, uint8_t size) {
+    uint8_t index;
+
+    if (chr < ' ' || chr > '~') {
+        return NULL;
+    }
+
+    index = chr - ' '; /* 得到偏移后的值 (ASCII 字库是从空格开始取模) */
+
+    switch (size) {
+        case 12:
+            return asc2_1206[index]; /* 调用 1206 字体 */
+
+        case 16:
+            return asc2_1608[index]; /* 调用 1608 字体 */
+
+        case 24:
+            return asc2_2412[index]; /* 调用 2412 字体 */
+
+        case 32:
+            return asc2_3216[index]; /* 调用 3216 字体 */
+
+        default:
+            return NULL;
+    }
+}
+
 /**
  * @brief 在指定位置显示一个字符
  *
@@ -1122,33 +1161,22 @@ void lcd_show_char(uint16_t x, uint16_t y, char chr, uint8_t size, uint8_t mode,
     uint8_t temp, t1, t;
     uint16_t y0 = y;
     uint8_t csize = 0;
-    uint8_t *pfont = 0;
-
-    /* 得到字体一个字符对应点阵集所占的字节数 */
-    csize = (size / 8 + ((size % 8) ? 1 : 0)) * (size / 2);
-    chr = chr - ' '; /* 得到偏移后的值 (ASCII 字库是从空格开始取模) */
-
-    switch (size) {
-        case 12:
-            pfont = (uint8_t *)asc2_1206[(uint8_t)chr]; /* 调用 1206 字体 */
-            break;
+    const uint8_t *pfont = lcd_get_char_font(chr, size);
 
-        case 16:
-            pfont = (uint8_t *)asc2_1608[(uint8_t)chr]; /* 调用 1608 字体 */
-            break;
-
-        case 24:
-            pfont = (uint8_t *)asc2_2412[(uint8_t)chr]; /* 调用 2412 字体 */
-            break;
-
-        case 32:
-            pfont = (uint8_t *)asc2_3216[(uint8_t)chr]; /* 调用 3216 字体 */
-            break;
+    if (pfont == NULL) {
+        return;
+    }
 
-        default:
-            return;
+    /* 非叠加方式且完整显示: 通过字形缓存整块刷新, RGB 屏横屏由 DMA2D 混合 */
+    if (mode == 0 && lcd_font_show_char(x, y, lcd_font_ascii(size), chr, color,
+                                        (uint16_t)g_back_color) != 0) {
+        return;
     }
 
+    /* 叠加方式或者超出屏幕: 逐点绘制 */
+    /* 得到字体一个字符对应点阵集所占的字节数 */
+    csize = (size / 8 + ((size % 8) ? 1 : 0)) * (size / 2);
+
     for (t = 0; t < csize; t++) {
         temp = pfont[t]; /* 获取字符的点阵数据 */
 
@@ -1185,23 +1213,6 @@ void lcd_show_char(uint16_t x, uint16_t y, char chr, uint8_t size, uint8_t mode,
     }
 }
 
-/**
- * @brief 幂函数, m^n
- *
- * @param m 底数
- * @param n 指数
- * @retval m 的 n 次方
- */
-static uint32_t lcd_pow(uint8_t m, uint8_t n) {
-    uint32_t result = 1;
-
-    while (n--) {
-        result *= m;
-    }
-
-    return result;
-}
-
 /**
  * @brief 显示 len 个数字
  *
@@ -1216,10 +1227,17 @@ void lcd_show_num(uint16_t x, uint16_t y, uint32_t num, uint8_t len,
                   uint8_t size, uint16_t color) {
     uint8_t t, temp;
     uint8_t enshow = 0;
+    uint8_t digit[10]; /* 各位数字, digit[0] 为个位 */
+
+    /* 一次拆出所有位, 避免每一位都做一次求幂和除法 */
+    for (t = 0; t < 10; t++) {
+        digit[t] = num % 10;
+        num /= 10;
+    }
 
     for (t = 0; t < len; t++) {
         /* 按总显示位数循环 */
-        temp = (num / lcd_pow(10, len - t - 1)) % 10; /* 获取对应位的数字 */
+        temp = (len - t - 1 < 10) ? digit[len - t - 1] : 0; /* 对应位的数字 */
 
         if (enshow == 0 && t < (len - 1)) {
             /* 没有使能显示, 且还有位要显示 */
@@ -1254,10 +1272,17 @@ void lcd_show_xnum(uint16_t x, uint16_t y, uint32_t num, uint8_t len,
                    uint8_t size, uint8_t mode, uint16_t color) {
     uint8_t t, temp;
     uint8_t enshow = 0;
+    uint8_t digit[10]; /* 各位数字, digit[0] 为个位 */
+
+    /* 一次拆出所有位, 避免每一位都做一次求幂和除法 */
+    for (t = 0; t < 10; t++) {
+        digit[t] = num % 10;
+        num /= 10;
+    }
 
     for (t = 0; t < len; t++) {
         /* 按总显示位数循环 */
-        temp = (num / lcd_pow(10, len - t - 1)) % 10; /* 获取对应位的数字 */
+        temp = (len - t - 1 < 10) ? digit[len - t - 1] : 0; /* 对应位的数字 */
 
         if (enshow == 0 && t < (len - 1)) {
             /* 没有使能显示, 且还有位要显示 */
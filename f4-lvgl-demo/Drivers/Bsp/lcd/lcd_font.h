@@ -0,0 +1,119 @@
+/**
+ * @file    lcd_font.h
+ * @author  Deadline039
+ * @brief   LCD 抗锯齿字库引擎
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * 字库由 Unicode 区段表, 字形描述表和位图三部分组成:
+ *  - 区段表按 Unicode 升序排列, 每个区段对应一段连续的字形 ID;
+ *  - 字形描述表记录每个字形的位图位置, 尺寸, 偏移和步进宽度, 支持等宽和
+ *    比例字体;
+ *  - 位图按行连续存放, 不做行对齐, 高位在前, 每个像素 1/2/4 bit.
+ * 字形描述表和位图可以放在片内 Flash, 也可以放在 W25QXX 或 SD 卡中,
+ * 此时通过 `read_cb` 读取, 偏移量分别为 `glyph_offset` 和 `bitmap_offset`.
+ *
+ * 渲染后的字形以 A8 (每像素 1 字节透明度) 格式存入 LRU 字形缓存,
+ * 之后同一个字只需要混合和刷新. RGB 屏横屏时使用 DMA2D A8 混合,
+ * 其他情况由 CPU 混合后以一个窗口整块刷新.
+ *
+ * `lcd_font_ascii` 提供 lcdfont.h 中 12/16/24/32 点阵 ASCII 字库对应的
+ * 字库描述, lcd_show_char 和 lcd_show_string 通过它使用字形缓存.
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#ifndef __LCD_FONT_H
+#define __LCD_FONT_H
+
+#include "lcd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* 字形缓存数量 */
+#define LCD_FONT_CACHE_NUM       16
+/* 每个字形缓存的最大像素数 (A8 格式, 1 字节 / 像素), 超过的字形不显示.
+ * 512 可以放下 32 点阵 ASCII (16 * 32), 使用更大的字库时需要加大 */
+#define LCD_FONT_CACHE_SLOT_SIZE 512
+/**
+ * 字形缓存的存放位置, 默认放在片内 SRAM. 缓存较大时可以放到 SDRAM, 例如:
+ * `__attribute__((section(".bss.ARM.__at_0XC0900000")))` (AC6)
+ */
+#define LCD_FONT_CACHE_ATTR
+/* CPU 混合时的刷新缓冲区大小 (像素), 字符单元超过时分多次刷新 */
+#define LCD_FONT_BLIT_BUF_SIZE   1024
+
+/**
+ * @brief 字形描述
+ */
+typedef struct {
+    uint32_t bitmap_index; /*!< 位图在位图区中的字节偏移 */
+    uint16_t adv_w;        /*!< 步进宽度 (像素) */
+    uint8_t box_w;         /*!< 位图宽度 */
+    uint8_t box_h;         /*!< 位图高度 */
+    int8_t ofs_x;          /*!< 位图相对于字符单元左边的偏移 */
+    int8_t ofs_y;          /*!< 位图相对于字符单元顶部的偏移 */
+    uint16_t reserved;     /*!< 保留, 使结构体为 12 字节 */
+} lcd_font_glyph_t;
+
+/**
+ * @brief Unicode 区段
+ */
+typedef struct {
+    uint32_t range_start;    /*!< 区段起始码点 */
+    uint16_t range_length;   /*!< 区段长度 */
+    uint16_t glyph_id_start; /*!< 区段第一个字形的 ID */
+} lcd_font_range_t;
+
+typedef struct lcd_font lcd_font_t;
+
+/**
+ * @brief 外部字库读取函数
+ *
+ * @param font 字库
+ * @param offset 读取的偏移地址
+ * @param buf 读取缓冲区
+ * @param len 读取长度
+ * @return 0: 成功; 其他: 失败
+ */
+typedef uint8_t (*lcd_font_read_cb_t)(const lcd_font_t *font, uint32_t offset,
+                                      void *buf, uint32_t len);
+
+/**
+ * @brief 字库描述
+ */
+struct lcd_font {
+    uint8_t bpp;         /*!< 每像素位数, 1/2/4 */
+    uint8_t line_height; /*!< 行高 (字符单元高度) */
+    uint16_t range_num;  /*!< 区段数量 */
+    const lcd_font_range_t *ranges;  /*!< 区段表, 按 Unicode 升序 */
+    const lcd_font_glyph_t *glyphs;  /*!< 字形描述表, NULL 时从外部读取 */
+    const uint8_t *bitmap;           /*!< 位图, NULL 时从外部读取 */
+    uint32_t glyph_offset;           /*!< 外部字形描述表的偏移地址 */
+    uint32_t bitmap_offset;          /*!< 外部位图的偏移地址 */
+    lcd_font_read_cb_t read_cb;      /*!< 外部读取函数 */
+    void *user_data;                 /*!< 用户数据, 例如 W25QXX 句柄或 FIL */
+};
+
+uint16_t lcd_font_show_char(uint16_t x, uint16_t y, const lcd_font_t *font,
+                            uint32_t unicode, uint16_t color,
+                            uint16_t bg_color);
+void lcd_font_show_string(uint16_t x, uint16_t y, uint16_t width,
+                          uint16_t height, const lcd_font_t *font,
+                          const char *str, uint16_t color, uint16_t bg_color);
+uint16_t lcd_font_text_width(const lcd_font_t *font, const char *str);
+
+void lcd_font_cache_clear(void);
+void lcd_font_cache_stat(uint32_t *hit, uint32_t *miss);
+
+const lcd_font_t *lcd_font_ascii(uint8_t size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __LCD_FONT_H */
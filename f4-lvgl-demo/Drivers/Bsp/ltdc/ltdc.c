@@ -101,22 +101,100 @@ void ltdc_select_layer(uint8_t layerx) {
  * @brief LTDC 显示方向设置
  *
  * @param dir 方向
- *  @arg - 0: 竖屏
+ *  @arg - 0: 竖屏 (面板顺时针旋转 90°)
  *  @arg - 1: 横屏
+ *  @arg - 2: 竖屏 (面板顺时针旋转 270°)
+ *  @arg - 3: 横屏 (面板旋转 180°)
  */
 void ltdc_display_dir(uint8_t dir) {
     lcdltdc.dir = dir; /* 显示方向 */
 
-    if (dir == 0) {
+    if (dir == 0 || dir == 2) {
         /* 竖屏 */
         lcdltdc.width = lcdltdc.pheight;
         lcdltdc.height = lcdltdc.pwidth;
-    } else if (dir == 1) {
+    } else {
+        /* 横屏 */
         lcdltdc.width = lcdltdc.pwidth;
         lcdltdc.height = lcdltdc.pheight;
     }
 }
 
+/**
+ * @brief 将当前方向下的坐标转换为以 LCD 面板为基准的坐标
+ *
+ * @param x 逻辑 x 坐标
+ * @param y 逻辑 y 坐标
+ * @param[out] px 面板 x 坐标
+ * @param[out] py 面板 y 坐标
+ */
+static inline void ltdc_point_to_panel(uint16_t x, uint16_t y, uint32_t *px,
+                                       uint32_t *py) {
+    switch (lcdltdc.dir) {
+        case 0: {
+            /* 竖屏, 90° */
+            *px = y;
+            *py = lcdltdc.pheight - x - 1;
+        } break;
+
+        case 2: {
+            /* 竖屏, 270° */
+            *px = lcdltdc.pwidth - y - 1;
+            *py = x;
+        } break;
+
+        case 3: {
+            /* 横屏, 180° */
+            *px = lcdltdc.pwidth - x - 1;
+            *py = lcdltdc.pheight - y - 1;
+        } break;
+
+        default: {
+            /* 横屏 */
+            *px = x;
+            *py = y;
+        } break;
+    }
+}
+
+/**
+ * @brief 将当前方向下的矩形转换为以 LCD 面板为基准的矩形
+ *
+ * @param sx 起始 x 坐标
+ * @param sy 起始 y 坐标
+ * @param ex 结束 x 坐标
+ * @param ey 结束 y 坐标
+ * @param[out] psx 面板起始 x 坐标
+ * @param[out] psy 面板起始 y 坐标
+ * @param[out] pex 面板结束 x 坐标
+ * @param[out] pey 面板结束 y 坐标
+ */
+static void ltdc_area_to_panel(uint16_t sx, uint16_t sy, uint16_t ex,
+                               uint16_t ey, uint32_t *psx, uint32_t *psy,
+                               uint32_t *pex, uint32_t *pey) {
+    uint32_t x0, y0, x1, y1;
+
+    ltdc_point_to_panel(sx, sy, &x0, &y0);
+    ltdc_point_to_panel(ex, ey, &x1, &y1);
+
+    *psx = (x0 < x1) ? x0 : x1;
+    *pex = (x0 < x1) ? x1 : x0;
+    *psy = (y0 < y1) ? y0 : y1;
+    *pey = (y0 < y1) ? y1 : y0;
+}
+
+/**
+ * @brief 获取面板坐标对应的帧缓存地址
+ *
+ * @param px 面板 x 坐标
+ * @param py 面板 y 坐标
+ * @return 帧缓存地址
+ */
+static inline uint32_t ltdc_panel_addr(uint32_t px, uint32_t py) {
+    return ((uint32_t)g_ltdc_framebuf[lcdltdc.activelayer] +
+            lcdltdc.pixsize * (lcdltdc.pwidth * py + px));
+}
+
 /**
  * @brief LTDC 画点函数
  *
@@ -125,34 +203,15 @@ void ltdc_display_dir(uint8_t dir) {
  * @param color 颜色值
  */
 void ltdc_draw_point(uint16_t x, uint16_t y, uint32_t color) {
+    uint32_t px, py;
+
+    ltdc_point_to_panel(x, y, &px, &py);
 
 #if (LTDC_PIXFORMAT == LTDC_PIXFORMAT_ARGB8888 ||                              \
      LTDC_PIXFORMAT == LTDC_PIXFORMAT_RGB888)
-    if (lcdltdc.dir) {
-        /* 横屏 */
-        *(uint32_t *)((uint32_t)g_ltdc_framebuf[lcdltdc.activelayer] +
-                      lcdltdc.pixsize * (lcdltdc.pwidth * y + x)) = color;
-    } else {
-        /* 竖屏 */
-        *(uint32_t *)((uint32_t)g_ltdc_framebuf[lcdltdc.activelayer] +
-                      lcdltdc.pixsize *
-                          (lcdltdc.pwidth * (lcdltdc.pheight - x - 1) + y)) =
-            color;
-    }
-
+    *(uint32_t *)ltdc_panel_addr(px, py) = color;
 #else  /* LTDC_PIXFORMAT */
-
-    if (lcdltdc.dir) {
-        /* 横屏 */
-        *(uint16_t *)((uint32_t)g_ltdc_framebuf[lcdltdc.activelayer] +
-                      lcdltdc.pixsize * (lcdltdc.pwidth * y + x)) = color;
-    } else {
-        /* 竖屏 */
-        *(uint16_t *)((uint32_t)g_ltdc_framebuf[lcdltdc.activelayer] +
-                      lcdltdc.pixsize *
-                          (lcdltdc.pwidth * (lcdltdc.pheight - x - 1) + y)) =
-            color;
-    }
+    *(uint16_t *)ltdc_panel_addr(px, py) = color;
 #endif /* LTDC_PIXFORMAT */
 }
 
@@ -164,36 +223,59 @@ void ltdc_draw_point(uint16_t x, uint16_t y, uint32_t color) {
  * @return 颜色值
  */
 uint32_t ltdc_read_point(uint16_t x, uint16_t y) {
+    uint32_t px, py;
+
+    ltdc_point_to_panel(x, y, &px, &py);
 
 #if (LTDC_PIXFORMAT == LTDC_PIXFORMAT_ARGB8888 ||                              \
      LTDC_PIXFORMAT == LTDC_PIXFORMAT_RGB888)
-    if (lcdltdc.dir) {
-        /* 横屏 */
-        return *(uint32_t *)((uint32_t)g_ltdc_framebuf[lcdltdc.activelayer] +
-                             lcdltdc.pixsize * (lcdltdc.pwidth * y + x));
-    } else {
-        /* 竖屏 */
-        return *(
-            uint32_t *)((uint32_t)g_ltdc_framebuf[lcdltdc.activelayer] +
-                        lcdltdc.pixsize *
-                            (lcdltdc.pwidth * (lcdltdc.pheight - x - 1) + y));
-    }
+    return *(uint32_t *)ltdc_panel_addr(px, py);
+#else  /* LTDC_PIXFORMAT */
+    return *(uint16_t *)ltdc_panel_addr(px, py);
+#endif /* LTDC_PIXFORMAT */
+}
 
-#else /* LTDC_PIXFORMAT */
+/**
+ * @brief 等待 DMA2D 传输完成
+ *
+ */
+static void ltdc_dma2d_wait(void) {
+    uint32_t timeout = 0;
 
-    if (lcdltdc.dir) {
-        /* 横屏 */
-        return *(uint16_t *)((uint32_t)g_ltdc_framebuf[lcdltdc.activelayer] +
-                             lcdltdc.pixsize * (lcdltdc.pwidth * y + x));
-    } else {
-        /* 竖屏 */
-        return *(
-            uint16_t *)((uint32_t)g_ltdc_framebuf[lcdltdc.activelayer] +
-                        lcdltdc.pixsize *
-                            (lcdltdc.pwidth * (lcdltdc.pheight - x - 1) + y));
+    while (DMA2D->CR & DMA2D_CR_START) {
+        /* 传输完成后 START 位由硬件清零 */
+        timeout++;
+
+        if (timeout > 0X1FFFFF) {
+            break; /* 超时退出 */
+        }
     }
 
-#endif /* LTDC_PIXFORMAT */
+    DMA2D->IFCR |= DMA2D_FLAG_TC; /* 清除传输完成标志 */
+}
+
+/**
+ * @brief 启动 DMA2D 存储器到存储器传输, 不等待完成
+ *
+ * @param src 源地址
+ * @param src_offline 源行偏移 (像素)
+ * @param dst 目标地址
+ * @param dst_offline 目标行偏移 (像素)
+ * @param width 每行像素数
+ * @param height 行数
+ */
+static void ltdc_dma2d_copy_start(const void *src, uint32_t src_offline,
+                                  uint32_t dst, uint32_t dst_offline,
+                                  uint32_t width, uint32_t height) {
+    __HAL_RCC_DMA2D_CLK_ENABLE();    /* 使能 DM2D 时钟 */
+    DMA2D->CR = DMA2D_M2M;           /* 存储器到存储器模式 */
+    DMA2D->FGPFCCR = LTDC_PIXFORMAT; /* 设置颜色格式 */
+    DMA2D->FGOR = src_offline;       /* 前景层行偏移 */
+    DMA2D->OOR = dst_offline;        /* 设置行偏移 */
+    DMA2D->FGMAR = (uint32_t)src;    /* 源地址 */
+    DMA2D->OMAR = dst;               /* 输出存储器地址 */
+    DMA2D->NLR = height | (width << 16); /* 设定行数寄存器 */
+    DMA2D->CR |= DMA2D_CR_START;         /* 启动 DMA2D */
 }
 
 /**
@@ -213,54 +295,141 @@ void ltdc_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey,
                uint32_t color) {
     /* 以 LCD 面板为基准的坐标系, 不随横竖屏变化而变化 */
     uint32_t psx, psy, pex, pey;
-    uint32_t timeout = 0;
-    uint16_t offline;
-    uint32_t addr;
 
-    /* 坐标系转换 */
-    if (lcdltdc.dir) {
-        /* 横屏 */
-        psx = sx;
-        psy = sy;
-        pex = ex;
-        pey = ey;
-    } else {
-        /* 竖屏 */
-        if (ex >= lcdltdc.pheight) {
-            ex = lcdltdc.pheight - 1; /* 限制范围 */
-        }
-        if (sx >= lcdltdc.pheight) {
-            sx = lcdltdc.pheight - 1; /* 限制范围 */
-        }
-
-        psx = sy;
-        psy = lcdltdc.pheight - ex - 1;
-        pex = ey;
-        pey = lcdltdc.pheight - sx - 1;
+    /* 限制范围 */
+    if (ex >= lcdltdc.width) {
+        ex = lcdltdc.width - 1;
+    }
+    if (sx >= lcdltdc.width) {
+        sx = lcdltdc.width - 1;
+    }
+    if (ey >= lcdltdc.height) {
+        ey = lcdltdc.height - 1;
+    }
+    if (sy >= lcdltdc.height) {
+        sy = lcdltdc.height - 1;
     }
 
-    offline = lcdltdc.pwidth - (pex - psx + 1);
-    addr = ((uint32_t)g_ltdc_framebuf[lcdltdc.activelayer] +
-            lcdltdc.pixsize * (lcdltdc.pwidth * psy + psx));
+    /* 坐标系转换 */
+    ltdc_area_to_panel(sx, sy, ex, ey, &psx, &psy, &pex, &pey);
 
+    ltdc_dma2d_wait();              /* 等待上一次传输完成 */
     __HAL_RCC_DMA2D_CLK_ENABLE();   /* 使能 DM2D 时钟 */
-    DMA2D->CR &= ~(DMA2D_CR_START); /* 先停止 DMA2D */
     DMA2D->CR = DMA2D_R2M;          /* 寄存器到存储器模式 */
     DMA2D->OPFCCR = LTDC_PIXFORMAT; /* 设置颜色格式 */
-    DMA2D->OOR = offline;           /* 设置行偏移  */
-    DMA2D->OMAR = addr;             /* 输出存储器地址 */
+    DMA2D->OOR = lcdltdc.pwidth - (pex - psx + 1); /* 设置行偏移  */
+    DMA2D->OMAR = ltdc_panel_addr(psx, psy);       /* 输出存储器地址 */
     DMA2D->NLR = (pey - psy + 1) | ((pex - psx + 1) << 16); /* 设定行数寄存器 */
     DMA2D->OCOLR = color;        /* 设定输出颜色寄存器 */
     DMA2D->CR |= DMA2D_CR_START; /* 启动 DMA2D */
 
-    while ((DMA2D->ISR & (DMA2D_FLAG_TC)) == 0) {
-        /* 等待传输完成 */
-        timeout++;
-        if (timeout > 0X1FFFFF) {
-            break; /* 超时退出 */
+    ltdc_dma2d_wait();
+}
+
+/* 旋转刷新使用的乒乓缓冲区, CPU 转置一块的同时 DMA2D 搬运另一块 */
+static uint16_t g_ltdc_rotate_buf[2][LTDC_ROTATE_TILE_SIZE *
+                                     LTDC_ROTATE_BLOCK_WIDTH];
+
+/**
+ * @brief 旋转 90° / 270° 的颜色块填充
+ *
+ * @param color 颜色数组首地址
+ * @param width 颜色数组宽度 (逻辑坐标系)
+ * @param height 颜色数组高度 (逻辑坐标系)
+ * @param psx 面板起始 x 坐标
+ * @param psy 面板起始 y 坐标
+ * @note 面板区域宽 `height`, 高 `width`. 面板上第 r 行第 c 列的像素为
+ *       `color[base + r * rstep + c * cstep]`. 以 TILE * TILE 为单位转置到
+ *       片内缓冲区, 每凑满 TILE 行 * BLOCK_WIDTH 列交给 DMA2D 写入帧缓存,
+ *       这样对 SDRAM 始终是整行连续写入.
+ */
+static void ltdc_color_fill_rotate(const uint16_t *color, uint32_t width,
+                                   uint32_t height, uint32_t psx,
+                                   uint32_t psy) {
+    const uint16_t *base;
+    int32_t rstep, cstep;
+    uint32_t pw = height, ph = width;
+    uint32_t r0, c0, c1, r, c, tr, tc, tcw;
+    uint8_t idx = 0;
+
+    if (lcdltdc.dir == 0) {
+        /* 面板行 r 对应源数组第 (width - 1 - r) 列, 面板列 c 对应第 c 行 */
+        base = color + (width - 1);
+        rstep = -1;
+        cstep = (int32_t)width;
+    } else {
+        /* 面板行 r 对应源数组第 r 列, 面板列 c 对应第 (height - 1 - c) 行 */
+        base = color + (height - 1) * width;
+        rstep = 1;
+        cstep = -(int32_t)width;
+    }
+
+    for (r0 = 0; r0 < ph; r0 += LTDC_ROTATE_TILE_SIZE) {
+        tr = ph - r0;
+        if (tr > LTDC_ROTATE_TILE_SIZE) {
+            tr = LTDC_ROTATE_TILE_SIZE;
+        }
+
+        for (c0 = 0; c0 < pw; c0 += LTDC_ROTATE_BLOCK_WIDTH) {
+            uint16_t *buf = g_ltdc_rotate_buf[idx];
+
+            tc = pw - c0;
+            if (tc > LTDC_ROTATE_BLOCK_WIDTH) {
+                tc = LTDC_ROTATE_BLOCK_WIDTH;
+            }
+
+            /* 按 TILE * TILE 分块转置 */
+            for (c1 = 0; c1 < tc; c1 += LTDC_ROTATE_TILE_SIZE) {
+                tcw = tc - c1;
+                if (tcw > LTDC_ROTATE_TILE_SIZE) {
+                    tcw = LTDC_ROTATE_TILE_SIZE;
+                }
+
+                for (r = 0; r < tr; r++) {
+                    const uint16_t *s =
+                        base + (int32_t)(r0 + r) * rstep +
+                        (int32_t)(c0 + c1) * cstep;
+                    uint16_t *d = buf + r * tc + c1;
+
+                    for (c = 0; c < tcw; c++) {
+                        d[c] = *s;
+                        s += cstep;
+                    }
+                }
+            }
+
+            /* 等待另一块缓冲区搬运完成后再启动本块 */
+            ltdc_dma2d_wait();
+            ltdc_dma2d_copy_start(buf, 0, ltdc_panel_addr(psx + c0, psy + r0),
+                                  lcdltdc.pwidth - tc, tc, tr);
+            idx ^= 1;
+        }
+    }
+
+    ltdc_dma2d_wait();
+}
+
+/**
+ * @brief 旋转 180° 的颜色块填充
+ *
+ * @param color 颜色数组首地址
+ * @param width 颜色数组宽度
+ * @param height 颜色数组高度
+ * @param psx 面板起始 x 坐标
+ * @param psy 面板起始 y 坐标
+ * @note DMA2D 不支持镜像, 由 CPU 逐行倒序写入.
+ */
+static void ltdc_color_fill_flip(const uint16_t *color, uint32_t width,
+                                 uint32_t height, uint32_t psx, uint32_t psy) {
+    const uint16_t *s = color + width * height - 1;
+
+    for (uint32_t r = 0; r < height; r++) {
+        uint16_t *d = (uint16_t *)ltdc_panel_addr(psx, psy + r);
+
+        for (uint32_t c = 0; c < width; c++) {
+            d[c] = *s--;
         }
     }
-    DMA2D->IFCR |= DMA2D_FLAG_TC; /* 清除传输完成标志 */
 }
 
 /**
@@ -273,7 +442,9 @@ void ltdc_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey,
  * @param color 填充的颜色数组首地址
  * @note 此函数仅支持 uint16_t, RGB565 格式的颜色数组填充.
  *       `(sx, sy), (ex, ey)`: 填充矩形对角坐标, 区域大小为:
- *       `(ex - sx + 1) * (ey - sy + 1)`
+ *       `(ex - sx + 1) * (ey - sy + 1)`.
+ *       颜色数组按当前显示方向的行顺序排列, 竖屏时由本函数完成旋转,
+ *       可以直接作为 LVGL 的 `flush_cb` 使用.
  * @attention 起始坐标不能大于`lcddev.width - 1`;
  *            结束坐标不能大于`lcddev.height - 1`
  */
@@ -281,53 +452,128 @@ void ltdc_color_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey,
                      uint16_t *color) {
     /* 以 LCD 面板为基准的坐标系, 不随横竖屏变化而变化 */
     uint32_t psx, psy, pex, pey;
-    uint32_t timeout = 0;
-    uint16_t offline;
-    uint32_t addr;
+    uint32_t width = ex - sx + 1;
+    uint32_t height = ey - sy + 1;
 
     /* 坐标系转换 */
-    if (lcdltdc.dir) {
-        /* 横屏 */
-        psx = sx;
-        psy = sy;
-        pex = ex;
-        pey = ey;
-    } else {
-        /* 竖屏 */
-        psx = sy;
-        psy = lcdltdc.pheight - ex - 1;
-        pex = ey;
-        pey = lcdltdc.pheight - sx - 1;
+    ltdc_area_to_panel(sx, sy, ex, ey, &psx, &psy, &pex, &pey);
+
+    switch (lcdltdc.dir) {
+        case 0:
+        case 2: {
+            /* 竖屏 */
+            ltdc_color_fill_rotate(color, width, height, psx, psy);
+        } break;
+
+        case 3: {
+            /* 横屏, 180° */
+            ltdc_dma2d_wait();
+            ltdc_color_fill_flip(color, width, height, psx, psy);
+        } break;
+
+        default: {
+            /* 横屏 */
+            ltdc_dma2d_wait();
+            ltdc_dma2d_copy_start(color, 0, ltdc_panel_addr(psx, psy),
+                                  lcdltdc.pwidth - (pex - psx + 1),
+                                  pex - psx + 1, pey - psy + 1);
+            ltdc_dma2d_wait();
+        } break;
     }
+}
 
-    offline = lcdltdc.pwidth - (pex - psx + 1);
-    addr = ((uint32_t)g_ltdc_framebuf[lcdltdc.activelayer] +
-            lcdltdc.pixsize * (lcdltdc.pwidth * psy + psx));
+/**
+ * @brief 将 A8 格式的透明度图以指定颜色混合到屏幕上
+ *
+ * @param sx 起始 x 坐标
+ * @param sy 起始 y 坐标
+ * @param width 宽度
+ * @param height 高度
+ * @param alpha 透明度数组, 每像素 1 字节, 按行连续存放
+ * @param color 前景颜色, RGB888 格式
+ * @return 0: 成功; 1: 当前方向不支持, 需由 CPU 混合
+ * @note 只支持横屏 (方向 1), 用于抗锯齿字体等前景混合.
+ * @attention 区域不能超出屏幕
+ */
+uint8_t ltdc_blend_a8(uint16_t sx, uint16_t sy, uint16_t width,
+                      uint16_t height, const uint8_t *alpha, uint32_t color) {
+    uint32_t addr;
 
-    RCC->AHB1ENR |= 1 << 23; /* 使能 DM2D 时钟 */
+    if (lcdltdc.dir != 1 || width == 0 || height == 0) {
+        return 1;
+    }
 
-    DMA2D->CR = 0 << 16;             /* 存储器到存储器模式 */
-    DMA2D->FGPFCCR = LTDC_PIXFORMAT; /* 设置颜色格式 */
-    DMA2D->FGOR = 0;                 /* 前景层行偏移为 0 */
-    DMA2D->OOR = offline;            /* 设置行偏移 */
-    DMA2D->CR &= ~(1 << 0);          /* 先停止 DMA2D */
-    DMA2D->FGMAR = (uint32_t)color;  /* 源地址 */
-    DMA2D->OMAR = addr;              /* 输出存储器地址 */
-    DMA2D->NLR = (pey - psy + 1) | ((pex - psx + 1) << 16); /* 设定行数寄存器 */
-    DMA2D->CR |= 1 << 0;                                    /* 启动 DMA2D */
+    addr = ltdc_panel_addr(sx, sy);
+
+    ltdc_dma2d_wait();
+    __HAL_RCC_DMA2D_CLK_ENABLE();
+    DMA2D->CR = DMA2D_M2M_BLEND;           /* 存储器到存储器, 混合模式 */
+    DMA2D->FGMAR = (uint32_t)alpha;        /* 前景: A8 透明度 */
+    DMA2D->FGOR = 0;
+    DMA2D->FGPFCCR = DMA2D_INPUT_A8;
+    DMA2D->FGCOLR = color & 0X00FFFFFF;    /* A8 格式的颜色来自此寄存器 */
+    DMA2D->BGMAR = addr;                   /* 背景: 显存本身 */
+    DMA2D->BGOR = lcdltdc.pwidth - width;
+    DMA2D->BGPFCCR = LTDC_PIXFORMAT;
+    DMA2D->OMAR = addr;                    /* 输出写回显存 */
+    DMA2D->OOR = lcdltdc.pwidth - width;
+    DMA2D->OPFCCR = LTDC_PIXFORMAT;
+    DMA2D->NLR = height | ((uint32_t)width << 16);
+    DMA2D->CR |= DMA2D_CR_START;
+
+    ltdc_dma2d_wait();
+
+    return 0;
+}
 
-    while ((DMA2D->ISR & (1 << 1)) == 0) {
-        /* 等待传输完成 */
-        timeout++;
+#if LTDC_ROTATE_BENCHMARK
 
-        if (timeout > 0X1FFFFF) {
-            break; /* 超时退出 */
+#include <stdio.h>
+
+/* 测速用的颜色块尺寸 */
+#define LTDC_BENCH_WIDTH  128
+#define LTDC_BENCH_HEIGHT 64
+/* 每个方向重复的次数 */
+#define LTDC_BENCH_LOOPS  32
+
+/**
+ * @brief 旋转刷新测速, 通过 DWT 周期计数器统计每个方向每像素的 CPU 周期数
+ *
+ * @note 结果通过 printf 输出. 测试会覆盖屏幕左上角的内容.
+ */
+void ltdc_rotate_benchmark(void) {
+    static uint16_t bench_buf[LTDC_BENCH_WIDTH * LTDC_BENCH_HEIGHT];
+    uint8_t old_dir = lcdltdc.dir;
+    uint32_t pixels = LTDC_BENCH_WIDTH * LTDC_BENCH_HEIGHT * LTDC_BENCH_LOOPS;
+    uint32_t start, cycles;
+
+    for (uint32_t i = 0; i < LTDC_BENCH_WIDTH * LTDC_BENCH_HEIGHT; i++) {
+        bench_buf[i] = (uint16_t)(i * 0x0821);
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint8_t dir = 0; dir < 4; dir++) {
+        ltdc_display_dir(dir);
+
+        start = DWT->CYCCNT;
+        for (uint32_t i = 0; i < LTDC_BENCH_LOOPS; i++) {
+            ltdc_color_fill(0, 0, LTDC_BENCH_WIDTH - 1, LTDC_BENCH_HEIGHT - 1,
+                            bench_buf);
         }
+        cycles = DWT->CYCCNT - start;
+
+        printf("LTDC dir %u: %lu.%02lu cycles/pixel\r\n", dir,
+               cycles / pixels, (cycles % pixels) * 100 / pixels);
     }
 
-    DMA2D->IFCR |= 1 << 1; /* 清除传输完成标志 */
+    ltdc_display_dir(old_dir);
 }
 
+#endif /* LTDC_ROTATE_BENCHMARK */
+
 /**
  * @brief LTCD 清屏
  *
@@ -677,6 +923,7 @@ void ltdc_init(void) {
     // ltdc_layer_window_config(1, 0, 0, lcdltdc.pwidth, lcdltdc.pheight);
     // ltdc_display_dir(0); /* 默认竖屏 */
 
+    ltdc_display_dir(1);    /* 先按横屏清屏, 之后由 lcd_display_dir 设置 */
     ltdc_select_layer(0);   /* 选择第 1 层 */
     LTDC_BL(1);             /* 点亮背光 */
     ltdc_clear(0XFFFFFFFF); /* 清屏 */
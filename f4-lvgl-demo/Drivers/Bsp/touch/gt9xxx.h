@@ -216,7 +216,8 @@ uint8_t gt9xxx_scan(uint8_t mode) {
     static uint8_t t = 0; /* 控制查询间隔,从而降低 CPU 占用率 */
     t++;
 
-    if ((t % 10) == 0 || t < 10) {
+    /* 中断方式采集时只在 INT 触发后调用, 不需要降低查询频率 */
+    if (TP_USE_INT || (t % 10) == 0 || t < 10) {
         /* 空闲时,每进入 10 次 CTP_Scan 函数才检测 1 次,从而节省 CPU 使用率 */
         gt9xxx_rd_reg(GT9XXX_GSTID_REG, &mode, 1); /* 读取触摸点的状态 */
 
@@ -267,6 +268,8 @@ uint8_t gt9xxx_scan(uint8_t mode) {
                             tp_dev.y[i] = ((uint16_t)buf[1] << 8) + buf[0];
                         }
                     }
+
+                    tp_dir_rotate(&tp_dev.x[i], &tp_dev.y[i]);
                 }
             }
 
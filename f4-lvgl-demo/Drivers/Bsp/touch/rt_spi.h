@@ -199,6 +199,26 @@ uint8_t tp_read_xy2(uint16_t *x, uint16_t *y) {
     return 0;
 }
 
+/**
+ * @brief 将物理坐标 (AD 值) 转换为屏幕坐标
+ *
+ * @param[in,out] x x 坐标
+ * @param[in,out] y y 坐标
+ */
+static void tp_adc_to_screen(uint16_t *x, uint16_t *y) {
+    /* 将 X 轴物理坐标转换成逻辑坐标 (即对应 LCD 屏幕上面的 X 坐标值) */
+    *x = (signed short)(*x - tp_dev.adj_data.xc) /
+             (int16_t)tp_dev.adj_data.xfac +
+         lcddev.width / 2;
+
+    /* 将 Y 轴物理坐标转换成逻辑坐标 (即对应 LCD 屏幕上面的 Y 坐标值) */
+    *y = (signed short)(*y - tp_dev.adj_data.yc) /
+             (int16_t)tp_dev.adj_data.yfac +
+         lcddev.height / 2;
+
+    tp_dir_rotate(x, y);
+}
+
 /**
  * @brief 触摸按键扫描
  *
@@ -217,16 +237,7 @@ uint8_t tp_scan(uint8_t mode) {
             tp_read_xy2(&tp_dev.x[0], &tp_dev.y[0]);
         } else if (tp_read_xy2(&tp_dev.x[0], &tp_dev.y[0])) {
             /* 读取屏幕坐标,需要转换 */
-
-            /* 将 X 轴物理坐标转换成逻辑坐标 (即对应 LCD 屏幕上面的 X 坐标值) */
-            tp_dev.x[0] = (signed short)(tp_dev.x[0] - tp_dev.adj_data.xc) /
-                              (int16_t)tp_dev.adj_data.xfac +
-                          lcddev.width / 2;
-
-            /* 将 Y 轴物理坐标转换成逻辑坐标 (即对应 LCD 屏幕上面的 Y 坐标值) */
-            tp_dev.y[0] = (signed short)(tp_dev.y[0] - tp_dev.adj_data.yc) /
-                              (int16_t)tp_dev.adj_data.yfac +
-                          lcddev.height / 2;
+            tp_adc_to_screen(&tp_dev.x[0], &tp_dev.y[0]);
         }
 
         if ((tp_dev.sta & TP_PRES_DOWN) == 0) {
@@ -252,3 +263,221 @@ uint8_t tp_scan(uint8_t mode) {
     /* 返回当前的触屏状态 */
     return tp_dev.sta & TP_PRES_DOWN;
 }
+
+/*****************************************************************************
+ * @defgroup 连续采样
+ * @note 按下期间由触摸采集任务定时调用 `tp_read_burst`, 一次片选内连续完成
+ *       X/Y/Z1/Z2 四次转换 (每次转换 16 个时钟, 下一条命令与上一次结果的
+ *       低位重叠发送), 不需要等待转换时间. 结果经过压力判断, 滑动中值和
+ *       一阶 IIR 滤波后输出.
+ * @{
+ */
+
+/* ADS7846 命令: 12 位, 差分模式, 转换之间使能 PENIRQ */
+#define TP_CMD_X           0XD0
+#define TP_CMD_Y           0X90
+#define TP_CMD_Z1          0XB0
+#define TP_CMD_Z2          0XC0
+
+/* 滑动中值窗口长度 (奇数) */
+#define TP_RT_MEDIAN_N     5
+/* IIR 滤波系数, 新值权重为 1 / 2^TP_RT_IIR_SHIFT */
+#define TP_RT_IIR_SHIFT    2
+/* Z1 小于此值认为没有按下 (笔刚接触或正在离开) */
+#define TP_RT_Z1_MIN       64
+/* 触摸电阻 (相对值) 大于此值认为压力不足, 坐标不可靠 */
+#define TP_RT_RES_MAX      3000
+
+/**
+ * @brief 一次连续采样的原始数据
+ */
+typedef struct {
+    uint16_t x;  /*!< X 轴 AD 值 */
+    uint16_t y;  /*!< Y 轴 AD 值 */
+    uint16_t z1; /*!< Z1 AD 值 */
+    uint16_t z2; /*!< Z2 AD 值 */
+} tp_rt_raw_t;
+
+/**
+ * @brief 滤波器状态
+ */
+typedef struct {
+    uint16_t ring[2][TP_RT_MEDIAN_N];   /*!< 按时间顺序的采样值 */
+    uint16_t sorted[2][TP_RT_MEDIAN_N]; /*!< 升序排列的采样值 */
+    uint8_t index;                      /*!< 最旧的采样在 ring 中的位置 */
+    uint8_t count;                      /*!< 窗口中的采样个数 */
+    int32_t iir[2]; /*!< IIR 输出, 放大 2^TP_RT_IIR_SHIFT 倍 */
+} tp_rt_filter_t;
+
+/**
+ * @brief 发送 16 个时钟, 同时读回 16 位数据
+ *
+ * @param data 发送的数据, 高位先发
+ * @return 读回的数据
+ */
+static uint16_t tp_transfer16(uint16_t data) {
+    uint16_t num = 0;
+
+    for (uint8_t count = 0; count < 16; count++) {
+        if (data & 0x8000) {
+            TP_MOSI(1);
+        } else {
+            TP_MOSI(0);
+        }
+
+        data <<= 1;
+        num <<= 1;
+        TP_CLK(0); /* 下降沿输出数据 */
+        delay_us(1);
+        TP_CLK(1); /* 上升沿锁存命令 */
+
+        if (TP_MISO) {
+            num++;
+        }
+    }
+
+    return num;
+}
+
+/**
+ * @brief 一次片选内连续读取 X/Y/Z1/Z2
+ *
+ * @param[out] raw 原始数据, X/Y 已按屏幕方向对调
+ */
+void tp_read_burst(tp_rt_raw_t *raw) {
+    static const uint8_t cmd[4] = {TP_CMD_X, TP_CMD_Y, TP_CMD_Z1, TP_CMD_Z2};
+    uint16_t val[4];
+
+    TP_CLK(0);
+    TP_MOSI(0);
+    TP_CS(0);
+    tp_write_byte(cmd[0]);
+
+    for (uint8_t i = 0; i < 4; i++) {
+        /* 第 1 个时钟为 BUSY, 之后 12 位数据, 最后 3 位为 0.
+         * 下一条命令在后 8 个时钟发出 */
+        val[i] = (tp_transfer16(i < 3 ? cmd[i + 1] : 0) >> 3) & 0XFFF;
+    }
+
+    TP_CS(1);
+
+    if (tp_dev.touchtype & 0X01) {
+        /* X, Y 方向与屏幕相反 */
+        raw->x = val[1];
+        raw->y = val[0];
+    } else {
+        raw->x = val[0];
+        raw->y = val[1];
+    }
+
+    raw->z1 = val[2];
+    raw->z2 = val[3];
+}
+
+/**
+ * @brief 根据 Z1/Z2 判断压力是否足够
+ *
+ * @param raw 原始数据
+ * @return 0: 压力不足, 丢弃; 1: 有效
+ * @note 触摸电阻 R = Rx * X / 4096 * (Z2 / Z1 - 1), 这里只计算相对值.
+ */
+static uint8_t tp_rt_pressure_valid(const tp_rt_raw_t *raw) {
+    uint32_t x = (tp_dev.touchtype & 0X01) ? raw->y : raw->x;
+
+    if (raw->z1 < TP_RT_Z1_MIN || raw->z2 <= raw->z1) {
+        return 0;
+    }
+
+    return (x * (raw->z2 - raw->z1) / raw->z1) <= TP_RT_RES_MAX;
+}
+
+/**
+ * @brief 复位滤波器, 每次按下时调用
+ *
+ * @param filter 滤波器
+ */
+static void tp_rt_filter_reset(tp_rt_filter_t *filter) {
+    filter->index = 0;
+    filter->count = 0;
+}
+
+/**
+ * @brief 更新一个轴的有序窗口: 删除最旧的值, 插入新值
+ *
+ * @param sorted 有序窗口
+ * @param count 窗口中的采样个数
+ * @param old 要删除的值, `count < TP_RT_MEDIAN_N` 时忽略
+ * @param val 新值
+ */
+static void tp_rt_sorted_update(uint16_t *sorted, uint8_t count, uint16_t old,
+                                uint16_t val) {
+    uint8_t i = 0;
+
+    if (count == TP_RT_MEDIAN_N) {
+        /* 删除最旧的值 */
+        while (sorted[i] != old) {
+            i++;
+        }
+
+        for (; i < count - 1; i++) {
+            sorted[i] = sorted[i + 1];
+        }
+
+        count--;
+    }
+
+    /* 插入新值 */
+    for (i = count; i > 0 && sorted[i - 1] > val; i--) {
+        sorted[i] = sorted[i - 1];
+    }
+
+    sorted[i] = val;
+}
+
+/**
+ * @brief 向滤波器输入一个采样
+ *
+ * @param filter 滤波器
+ * @param[in,out] x 输入 x 轴 AD 值, 输出滤波后的值
+ * @param[in,out] y 输入 y 轴 AD 值, 输出滤波后的值
+ * @return 0: 窗口还没有填满, 没有输出; 1: 有输出
+ */
+static uint8_t tp_rt_filter_push(tp_rt_filter_t *filter, uint16_t *x,
+                                 uint16_t *y) {
+    uint16_t *val[2] = {x, y};
+
+    for (uint8_t axis = 0; axis < 2; axis++) {
+        tp_rt_sorted_update(filter->sorted[axis], filter->count,
+                            filter->ring[axis][filter->index], *val[axis]);
+        filter->ring[axis][filter->index] = *val[axis];
+    }
+
+    filter->index = (filter->index + 1) % TP_RT_MEDIAN_N;
+
+    if (filter->count < TP_RT_MEDIAN_N) {
+        filter->count++;
+
+        if (filter->count < TP_RT_MEDIAN_N) {
+            return 0;
+        }
+
+        /* 窗口刚填满, 用中值初始化 IIR */
+        for (uint8_t axis = 0; axis < 2; axis++) {
+            filter->iir[axis] = (int32_t)filter->sorted[axis][TP_RT_MEDIAN_N / 2]
+                                << TP_RT_IIR_SHIFT;
+        }
+    }
+
+    for (uint8_t axis = 0; axis < 2; axis++) {
+        int32_t median = filter->sorted[axis][TP_RT_MEDIAN_N / 2];
+
+        filter->iir[axis] += median - (filter->iir[axis] >> TP_RT_IIR_SHIFT);
+        *val[axis] = filter->iir[axis] >> TP_RT_IIR_SHIFT;
+    }
+
+    return 1;
+}
+
+/**
+ * @}
+ */
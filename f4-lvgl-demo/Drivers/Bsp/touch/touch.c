@@ -24,11 +24,19 @@
 #include <stdio.h>
 #include <string.h>
 
+static void tp_dir_rotate(uint16_t *x, uint16_t *y);
+
 #include "ct_iic.h"
 #include "ft5206.h"
 #include "gt9xxx.h"
 #include "rt_spi.h"
 
+#if TP_USE_INT
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+#endif /* TP_USE_INT */
+
 void tp_adjust(void);
 uint8_t tp_scan(uint8_t mode);
 uint8_t tp_init(void);
@@ -269,6 +277,13 @@ void tp_adjust(void) {
                     tp_dev.adj_data.yfac =
                         (float)(s2 + s4) / (2 * (lcddev.height - 40));
 
+                    if (tp_dev.touchtype & 0X02) {
+                        /* 校准点按当前方向绘制, 保存的参数统一换算到
+                         * 未旋转 180° 的方向, 由 tp_dir_rotate 再转回来 */
+                        tp_dev.adj_data.xfac = -tp_dev.adj_data.xfac;
+                        tp_dev.adj_data.yfac = -tp_dev.adj_data.yfac;
+                    }
+
                     tp_dev.adj_data.xc = pxy[4][0]; /* X 轴,物理中心坐标 */
                     tp_dev.adj_data.yc = pxy[4][1]; /* Y 轴,物理中心坐标 */
 
@@ -312,6 +327,21 @@ void tp_adjust(void) {
  * @{
  */
 
+/**
+ * @brief 按 LCD 方向修正屏幕坐标
+ *
+ * @param[in,out] x x 坐标
+ * @param[in,out] y y 坐标
+ * @note 各触摸芯片只区分横竖屏 (touchtype bit0), 方向 2 / 3 在此基础上
+ *       旋转 180°. 超出屏幕的坐标旋转后仍然超出, 不影响后续的合法性判断.
+ */
+static void tp_dir_rotate(uint16_t *x, uint16_t *y) {
+    if (tp_dev.touchtype & 0X02) {
+        *x = lcddev.width - 1 - *x;
+        *y = lcddev.height - 1 - *y;
+    }
+}
+
 /**
  * @brief 触摸屏初始化
  *
@@ -324,6 +354,7 @@ uint8_t tp_init(void) {
 
     tp_dev.touchtype = 0; /* 默认设置 (电阻屏 & 竖屏) */
     tp_dev.touchtype |= lcddev.dir & 0X01; /* 根据 LCD 判定是横屏还是竖屏 */
+    tp_dev.touchtype |= lcddev.dir & 0X02; /* 方向 2 / 3 再旋转 180° */
 
     switch (lcddev.id) {
         case 0x7796:
@@ -416,3 +447,236 @@ uint8_t tp_init(void) {
 /**
  * @}
  */
+
+#if TP_USE_INT
+
+/*****************************************************************************
+ * @defgroup 触摸屏中断采集
+ * @{
+ */
+
+static QueueHandle_t g_tp_sample_queue;
+static TaskHandle_t g_tp_task_handle;
+static void (*g_tp_sample_callback)(void);
+
+/**
+ * @brief 触摸屏 INT 引脚中断服务函数
+ *
+ * @note EXTI9_5 由 EXTI5 ~ EXTI9 共用, 如果其他外设也使用这些中断线,
+ *       需要把这里的处理合并到同一个中断服务函数中.
+ */
+void TP_INT_IRQHandler(void) {
+    BaseType_t higher_task_woken = pdFALSE;
+
+    if (__HAL_GPIO_EXTI_GET_IT(TP_INT_GPIO_PIN) != 0) {
+        __HAL_GPIO_EXTI_CLEAR_IT(TP_INT_GPIO_PIN);
+
+        if (g_tp_task_handle != NULL) {
+            vTaskNotifyGiveFromISR(g_tp_task_handle, &higher_task_woken);
+        }
+    }
+
+    portYIELD_FROM_ISR(higher_task_woken);
+}
+
+/**
+ * @brief 将坐标放入队列, 队列满时丢弃最旧的坐标
+ *
+ * @param sample 坐标
+ */
+static void tp_sample_push(const tp_sample_t *sample) {
+    tp_sample_t drop;
+
+    if (xQueueSend(g_tp_sample_queue, sample, 0) != pdPASS) {
+        xQueueReceive(g_tp_sample_queue, &drop, 0);
+        xQueueSend(g_tp_sample_queue, sample, 0);
+    }
+
+    if (g_tp_sample_callback != NULL) {
+        g_tp_sample_callback();
+    }
+}
+
+/**
+ * @brief 电阻屏按下期间定时连续采样, 直到松开
+ *
+ * @note 每 `TP_RT_SAMPLE_MS` 读一次 X/Y/Z1/Z2, 压力不足的采样直接丢弃,
+ *       其余经过中值和 IIR 滤波后上报. 采样期间 PENIRQ 会随转换变化,
+ *       产生的通知在松开后清除.
+ */
+static void tp_int_rt_track(void) {
+    static tp_rt_filter_t filter;
+    tp_rt_raw_t raw;
+    tp_sample_t sample;
+    uint8_t pressed = 0;
+    TickType_t wake = xTaskGetTickCount();
+
+    tp_rt_filter_reset(&filter);
+
+    while (TP_PEN == 0) {
+        tp_read_burst(&raw);
+
+        if (tp_rt_pressure_valid(&raw) &&
+            tp_rt_filter_push(&filter, &raw.x, &raw.y)) {
+            sample.x = raw.x;
+            sample.y = raw.y;
+            tp_adc_to_screen(&sample.x, &sample.y);
+            sample.pressed = 1;
+            sample.tick = xTaskGetTickCount();
+            pressed = 1;
+            tp_sample_push(&sample);
+        }
+
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(TP_RT_SAMPLE_MS));
+    }
+
+    if (pressed) {
+        /* 松开, 坐标沿用最后一次 */
+        sample.pressed = 0;
+        sample.tick = xTaskGetTickCount();
+        tp_sample_push(&sample);
+    }
+
+    ulTaskNotifyTake(pdTRUE, 0);
+}
+
+/**
+ * @brief 触摸采集任务
+ *
+ * @param pvParameters 启动参数
+ * @note 空闲时一直阻塞等待 INT (电阻屏为 PENIRQ).
+ *       电容屏: 按下期间每次 INT 读一次坐标, 超时没有 INT 时主动读一次以
+ *       检测松开. 只有按下和按下期间的坐标, 以及松开的那一次会放入队列.
+ *       电阻屏: 按下后定时连续采样, 直到松开.
+ */
+static void tp_int_task(void *pvParameters) {
+    UNUSED(pvParameters);
+
+    tp_sample_t sample;
+    uint8_t pressed = 0;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pressed
+                                     ? pdMS_TO_TICKS(TP_RELEASE_TIMEOUT_MS)
+                                     : portMAX_DELAY);
+
+        if ((tp_dev.touchtype & 0X80) == 0) {
+            /* 电阻屏 */
+            tp_int_rt_track();
+            continue;
+        }
+
+        tp_dev.scan(0);
+
+        sample.pressed = (tp_dev.sta & TP_PRES_DOWN) ? 1 : 0;
+
+        if (sample.pressed == 0 && pressed == 0) {
+            /* 一直是松开状态, 不需要上报 */
+            continue;
+        }
+
+        sample.x = tp_dev.x[0];
+        sample.y = tp_dev.y[0];
+        sample.tick = xTaskGetTickCount();
+        pressed = sample.pressed;
+        tp_sample_push(&sample);
+    }
+}
+
+/**
+ * @brief 启动触摸屏中断采集
+ *
+ * @return 启动结果
+ * @retval - 0: 成功
+ * @retval - 1: 创建任务失败
+ * @note 需要在 `tp_dev.init` 和校准之后调用. 启动后不要再调用
+ *       `tp_dev.scan`, 通过 `tp_sample_read` 获取坐标.
+ */
+uint8_t tp_int_start(void) {
+    GPIO_InitTypeDef gpio_init_struct;
+
+    if (g_tp_sample_queue == NULL) {
+        g_tp_sample_queue =
+            xQueueCreate(TP_SAMPLE_QUEUE_LEN, sizeof(tp_sample_t));
+
+        if (g_tp_sample_queue == NULL) {
+            return 1;
+        }
+
+        if (xTaskCreate(tp_int_task, "tp_int_task", TP_TASK_STACK_SIZE, NULL,
+                        TP_TASK_PRIORITY, &g_tp_task_handle) != pdPASS) {
+            vQueueDelete(g_tp_sample_queue);
+            g_tp_sample_queue = NULL;
+            return 1;
+        }
+    }
+
+    CSP_GPIO_CLK_ENABLE(TP_INT_GPIO_PORT);
+    gpio_init_struct.Pin = TP_INT_GPIO_PIN;
+    if (tp_dev.touchtype & 0X80) {
+        /* 电容屏每个报点周期都会在 INT 上产生脉冲, 双边沿触发 */
+        gpio_init_struct.Mode = GPIO_MODE_IT_RISING_FALLING;
+        gpio_init_struct.Pull = GPIO_NOPULL;
+    } else {
+        /* 电阻屏按下时 PENIRQ 拉低 */
+        gpio_init_struct.Mode = GPIO_MODE_IT_FALLING;
+        gpio_init_struct.Pull = GPIO_PULLUP;
+    }
+    gpio_init_struct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    HAL_GPIO_Init(CSP_GPIO_PORT(TP_INT_GPIO_PORT), &gpio_init_struct);
+
+    HAL_NVIC_SetPriority(TP_INT_IRQn, TP_INT_IT_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(TP_INT_IRQn);
+
+    /* 先读一次, 同步当前状态 */
+    xTaskNotifyGive(g_tp_task_handle);
+
+    return 0;
+}
+
+/**
+ * @brief 取出一个触摸坐标 (不阻塞)
+ *
+ * @param[out] sample 坐标
+ * @return 是否取到
+ * @retval - 0: 取到坐标
+ * @retval - 1: 队列为空或没有启动中断采集
+ */
+uint8_t tp_sample_read(tp_sample_t *sample) {
+    if (g_tp_sample_queue == NULL ||
+        xQueueReceive(g_tp_sample_queue, sample, 0) != pdPASS) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 获取队列中还没有取出的坐标数量
+ *
+ * @return 坐标数量
+ */
+uint32_t tp_sample_pending(void) {
+    if (g_tp_sample_queue == NULL) {
+        return 0;
+    }
+
+    return uxQueueMessagesWaiting(g_tp_sample_queue);
+}
+
+/**
+ * @brief 设置有新坐标时的回调函数
+ *
+ * @param callback 回调函数, 为 NULL 时取消
+ * @note 回调函数在采集任务中调用, 不能阻塞. 一般用来唤醒读取坐标的任务,
+ *       读取坐标的任务可以一直休眠到有触摸为止.
+ */
+void tp_sample_set_callback(void (*callback)(void)) {
+    g_tp_sample_callback = callback;
+}
+
+/**
+ * @}
+ */
+
+#endif /* TP_USE_INT */
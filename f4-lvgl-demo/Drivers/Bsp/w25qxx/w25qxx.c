@@ -14,104 +14,111 @@
 #include "w25qxx.h"
 
 #include "../core/core_delay.h"
+#include "task.h"
 #include <stdlib.h>
 #include <string.h>
 
-/**
- * @brief 启用片选信号 (CS 引脚拉低)
- *
- * @param w25qxx W25Qxx 句柄
- */
-static inline void cs_on(w25qxx_handle_t *w25qxx) {
-#if W25QXX_USE_QSPI
-    if (w25qxx->use_qspi) {
-        return;
-    }
-#endif /* W25QXX_USE_QSPI */
-
 #if W25QXX_USE_SPI
-    HAL_GPIO_WritePin(w25qxx->cs_port, w25qxx->cs_pin, GPIO_PIN_RESET);
-#endif /* W25QXX_USE_SPI */
-}
 
 /**
- * @brief 启用片选信号 (CS 引脚拉高)
+ * @brief SPI 传输完成, 唤醒等待的任务
  *
- * @param w25qxx W25Qxx 句柄
+ * @param xfer 传输
+ * @param status 传输状态
  */
-static inline void cs_off(w25qxx_handle_t *w25qxx) {
-#if W25QXX_USE_QSPI
-    if (w25qxx->use_qspi) {
-        return;
+static void w25qxx_xfer_done(spi_xfer_t *xfer, uint8_t status) {
+    w25qxx_handle_t *w25qxx = (w25qxx_handle_t *)xfer->user;
+    BaseType_t higher_task_woken = pdFALSE;
+
+    UNUSED(status);
+
+    if (xPortIsInsideInterrupt()) {
+        xSemaphoreGiveFromISR(w25qxx->done, &higher_task_woken);
+        portYIELD_FROM_ISR(higher_task_woken);
+    } else {
+        xSemaphoreGive(w25qxx->done);
     }
-#endif /* W25QXX_USE_QSPI */
+}
 
-#if W25QXX_USE_SPI
-    HAL_GPIO_WritePin(w25qxx->cs_port, w25qxx->cs_pin, GPIO_PIN_SET);
 #endif /* W25QXX_USE_SPI */
-}
 
 /**
- * @brief 往 W25QXX 芯片发送数据
+ * @brief 执行一条命令: 发送命令和地址, 然后发送或接收数据
  *
  * @param w25qxx W25QXX 句柄
- * @param buf 发送的数据
- * @param len 发送数据长度 (字节)
+ * @param cmd 命令
+ * @param addr 地址
+ * @param addr_len 地址长度 (字节), 0: 没有地址
+ * @param tx_buf 发送的数据, NULL: 不发送
+ * @param[out] rx_buf 接收缓冲区, NULL: 不接收
+ * @param len 数据长度 (字节), 最大 0xFFFF
  * @return 操作状态
+ * @note 命令和数据作为一个事务放入 SPI 总线队列, 片选, 时钟模式和速度由总线
+ *       设置, 总线上的其他设备可以使用不同的设置. 调度器运行时等待信号量,
+ *       不占用 CPU. 传输完成之前不会返回, 因为传输描述符在栈上.
  */
-static w25qxx_result_t w25qxx_transmit(w25qxx_handle_t *w25qxx, uint8_t *buf,
-                                       uint32_t len) {
-    HAL_StatusTypeDef res = HAL_ERROR;
-#ifdef W25QXX_USE_QSPI
+static w25qxx_result_t w25qxx_command(w25qxx_handle_t *w25qxx, uint8_t cmd,
+                                      uint32_t addr, uint8_t addr_len,
+                                      const uint8_t *tx_buf, uint8_t *rx_buf,
+                                      uint32_t len) {
+#if W25QXX_USE_QSPI
     if (w25qxx->use_qspi) {
-        /** @todo QSPI transmit function. */
+        /** @todo QSPI command function. */
 
         return W25QXX_ERROR;
     }
 #endif /* W25QXX_USE_QSPI */
 
 #if W25QXX_USE_SPI
-    if (w25qxx->handle.hspi->hdmatx != NULL) {
-        res = HAL_SPI_Transmit_DMA(w25qxx->handle.hspi, buf, len);
-    } else {
-        res = HAL_SPI_Transmit(w25qxx->handle.hspi, buf, len, 1000);
+    spi_xfer_t xfer[2];
+    spi_xfer_t *last = &xfer[0];
+    uint8_t head[5];
+    uint8_t i;
+
+    head[0] = cmd;
+    for (i = 1; i <= addr_len; ++i) {
+        head[i] = (uint8_t)(addr >> ((addr_len - i) * 8));
     }
 
-    if (res == HAL_OK) {
-        return W25QXX_OK;
+    memset(xfer, 0, sizeof(xfer));
+    for (i = 0; i < 2; ++i) {
+        xfer[i].cs_port = w25qxx->cs_port;
+        xfer[i].cs_pin = w25qxx->cs_pin;
+        xfer[i].clk_mode = W25QXX_SPI_CLK_MODE;
+        xfer[i].speed = W25QXX_SPI_SPEED;
+        xfer[i].user = w25qxx;
     }
-#endif /* W25QXX_USE_SPI */
 
-    return W25QXX_ERROR;
-}
+    xfer[0].tx_buf = head;
+    xfer[0].len = 1 + addr_len;
 
-/**
- * @brief 从 W25QXX 芯片接收数据
- *
- * @param w25qxx W25QXX 句柄
- * @param[out] buf 接收数据缓冲区
- * @param len 要接收的数据长度 (字节)
- * @return 操作状态
- */
-static w25qxx_result_t w25qxx_receive(w25qxx_handle_t *w25qxx, uint8_t *buf,
-                                      uint32_t len) {
-    HAL_StatusTypeDef res = HAL_ERROR;
-#ifdef W25QXX_USE_QSPI
-    if (w25qxx->use_qspi) {
-        /** @todo QSPI receive function. */
+    if (len != 0) {
+        xfer[1].tx_buf = tx_buf;
+        xfer[1].rx_buf = rx_buf;
+        xfer[1].len = len;
+        xfer[0].next = &xfer[1];
+        last = &xfer[1];
+    }
+
+    if (w25qxx->done != NULL &&
+        xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        last->callback = w25qxx_xfer_done;
+    }
 
+    if (spi_bus_submit(w25qxx->handle.hspi, xfer) != SPI_BUS_OK) {
         return W25QXX_ERROR;
     }
-#endif /* W25QXX_USE_QSPI */
 
-#if W25QXX_USE_SPI
-    if (w25qxx->handle.hspi->hdmarx != NULL) {
-        res = HAL_SPI_Receive_DMA(w25qxx->handle.hspi, buf, len);
+    if (last->callback != NULL) {
+        /* 信号量可能是之前的命令留下的, 需要再检查状态 */
+        while (last->status == SPI_BUS_PENDING) {
+            xSemaphoreTake(w25qxx->done, portMAX_DELAY);
+        }
     } else {
-        res = HAL_SPI_Receive(w25qxx->handle.hspi, buf, len, 1000);
+        spi_bus_wait(xfer, HAL_MAX_DELAY);
     }
 
-    if (res == HAL_OK) {
+    if (last->status == SPI_BUS_OK) {
         return W25QXX_OK;
     }
 #endif /* W25QXX_USE_SPI */
@@ -119,18 +126,30 @@ static w25qxx_result_t w25qxx_receive(w25qxx_handle_t *w25qxx, uint8_t *buf,
     return W25QXX_ERROR;
 }
 
+/**
+ * @brief 地址长度, 容量不小于 256 块时使用 4 字节地址
+ *
+ * @param w25qxx W25QXX 句柄
+ * @return 地址长度 (字节)
+ */
+static inline uint8_t w25qxx_addr_len(w25qxx_handle_t *w25qxx) {
+    return (w25qxx->block_count >= 256) ? 4 : 3;
+}
+
 /**
  * @brief 初始化 W25Qxx 芯片
  *
  * @param w25qxx W25QXX 句柄
  * @param use_qspi 是否使用 QSPI (需要预先打开`W25QXX_USE_QSPI`宏定义)
  * @return 是否初始化成功
- * @note 需要预先初始化 SPI. 函数会初始化片选引脚, 但是不会开启片选引脚时钟
+ * @note 需要预先初始化 SPI (8 位, 主机模式). 函数会初始化片选引脚, 但是不会
+ *       开启片选引脚时钟. SPI 速度和时钟模式由 `W25QXX_SPI_SPEED` 和
+ *       `W25QXX_SPI_CLK_MODE` 设置, 每次传输时切换.
  */
 w25qxx_result_t w25qxx_init(w25qxx_handle_t *w25qxx, bool use_qspi) {
     uint8_t tmp;
     w25qxx_result_t result = W25QXX_OK;
-    uint32_t id = w25qxx_read_id(w25qxx);
+    uint32_t id;
 
     if (w25qxx == NULL) {
         return W25QXX_ERROR;
@@ -144,12 +163,14 @@ w25qxx_result_t w25qxx_init(w25qxx_handle_t *w25qxx, bool use_qspi) {
                                             .Mode = GPIO_MODE_OUTPUT_PP,
                                             .Pull = GPIO_PULLUP,
                                             .Speed = GPIO_SPEED_FREQ_VERY_HIGH};
+        HAL_GPIO_WritePin(GPIOF, GPIO_PIN_6, GPIO_PIN_SET);
         HAL_GPIO_Init(GPIOF, &gpio_init_stuct);
-        /* SPI 提速 */
-        spi_change_speed(w25qxx->handle.hspi, SPI_BAUDRATEPRESCALER_2);
+        w25qxx->done = xSemaphoreCreateBinary();
     }
 #endif /* W25QXX_USE_SPI */
 
+    id = w25qxx_read_id(w25qxx);
+
     if (id) {
         w25qxx->manufacturer_id = (uint8_t)(id >> 8);
         w25qxx->device_id = (uint16_t)(id & 0xFF);
@@ -206,11 +227,16 @@ w25qxx_result_t w25qxx_init(w25qxx_handle_t *w25qxx, bool use_qspi) {
     }
 
     if (result == W25QXX_ERROR) {
-        /* Zero the handle so it is clear initialization failed! */
-        memset(w25qxx, 0, sizeof(w25qxx_handle_t));
         if (w25qxx->buf != NULL) {
             CSP_FREE(w25qxx->buf);
         }
+#if W25QXX_USE_SPI
+        if (w25qxx->done != NULL) {
+            vSemaphoreDelete(w25qxx->done);
+        }
+#endif /* W25QXX_USE_SPI */
+        /* Zero the handle so it is clear initialization failed! */
+        memset(w25qxx, 0, sizeof(w25qxx_handle_t));
         return result;
     }
 
@@ -241,10 +267,16 @@ w25qxx_result_t w25qxx_deinit(w25qxx_handle_t *w25qxx) {
         return W25QXX_ERROR;
     }
 
+#if W25QXX_USE_SPI
     if (w25qxx->use_qspi != true) {
         HAL_GPIO_DeInit(w25qxx->cs_port, w25qxx->cs_pin);
     }
 
+    if (w25qxx->done != NULL) {
+        vSemaphoreDelete(w25qxx->done);
+    }
+#endif /* W25QXX_USE_SPI */
+
     if (w25qxx->buf != NULL) {
         CSP_FREE(w25qxx->buf);
     }
@@ -260,24 +292,19 @@ w25qxx_result_t w25qxx_deinit(w25qxx_handle_t *w25qxx) {
  * @return 制造商和设备 ID
  */
 uint32_t w25qxx_read_id(w25qxx_handle_t *w25qxx) {
-    uint32_t ret = 0;
-    uint8_t buf[4];
+    uint8_t buf[2];
 
     if (w25qxx == NULL) {
         return W25QXX_ERROR;
     }
 
-    cs_on(w25qxx);
-    buf[0] = W25QXX_GET_ID;
-    buf[1] = 0x00;
-    buf[2] = 0x00;
-    buf[3] = 0x00;
+    /* 命令后面是 3 字节的 0 地址 */
+    if (w25qxx_command(w25qxx, W25QXX_GET_ID, 0, 3, NULL, buf, 2) !=
+        W25QXX_OK) {
+        return 0;
+    }
 
-    w25qxx_transmit(w25qxx, buf, 4);
-    w25qxx_receive(w25qxx, buf, 2);
-    ret = (buf[0] << 8) | buf[1];
-    cs_off(w25qxx);
-    return ret;
+    return (buf[0] << 8) | buf[1];
 }
 
 /**
@@ -288,19 +315,14 @@ uint32_t w25qxx_read_id(w25qxx_handle_t *w25qxx) {
  * @return 当前状态寄存器的值
  */
 uint8_t w25qxx_get_status(w25qxx_handle_t *w25qxx, uint8_t reg) {
-    uint8_t ret = 0;
-    uint8_t buf = reg;
+    uint8_t buf = 0;
 
     if (w25qxx == NULL) {
         return W25QXX_ERROR;
     }
 
-    cs_on(w25qxx);
-    w25qxx_transmit(w25qxx, &buf, 1);
-    w25qxx_receive(w25qxx, &buf, 1);
-    ret = buf;
-    cs_off(w25qxx);
-    return ret;
+    w25qxx_command(w25qxx, reg, 0, 0, NULL, &buf, 1);
+    return buf;
 }
 
 /**
@@ -313,19 +335,11 @@ uint8_t w25qxx_get_status(w25qxx_handle_t *w25qxx, uint8_t reg) {
  */
 w25qxx_result_t w25qxx_set_status(w25qxx_handle_t *w25qxx, uint8_t reg,
                                   uint8_t status) {
-    w25qxx_result_t ret = W25QXX_ERROR;
-    uint8_t buf[2];
-
     if (w25qxx == NULL) {
         return W25QXX_ERROR;
     }
 
-    buf[0] = reg;
-    buf[1] = status;
-    cs_on(w25qxx);
-    ret = w25qxx_transmit(w25qxx, buf, 2);
-    cs_off(w25qxx);
-    return ret;
+    return w25qxx_command(w25qxx, reg, 0, 0, &status, NULL, 1);
 }
 
 /**
@@ -335,18 +349,11 @@ w25qxx_result_t w25qxx_set_status(w25qxx_handle_t *w25qxx, uint8_t reg,
  * @return 操作状态
  */
 w25qxx_result_t w25qxx_write_enable(w25qxx_handle_t *w25qxx) {
-    w25qxx_result_t ret = W25QXX_ERROR;
-    uint8_t buf[1];
-
     if (w25qxx == NULL) {
         return W25QXX_ERROR;
     }
 
-    cs_on(w25qxx);
-    buf[0] = W25QXX_WRITE_ENABLE;
-    ret = w25qxx_transmit(w25qxx, buf, 1);
-    cs_off(w25qxx);
-    return ret;
+    return w25qxx_command(w25qxx, W25QXX_WRITE_ENABLE, 0, 0, NULL, NULL, 0);
 }
 
 /**
@@ -376,25 +383,6 @@ static w25qxx_result_t w25qxx_wait_for_ready(w25qxx_handle_t *w25qxx,
     return ret;
 }
 
-/**
- * @brief W25QXX 发送地址
- *
- * @param w25qxx W25QXX 句柄
- * @param address 地址
- */
-static void w25qxx_send_addr(w25qxx_handle_t *w25qxx, uint32_t address) {
-    uint8_t buf;
-    if (w25qxx->block_count >= 256) {
-        buf = ((uint8_t)(address >> 24));
-        w25qxx_transmit(w25qxx, &buf, 1);
-    }
-    buf = ((uint8_t)(address >> 16));
-    w25qxx_transmit(w25qxx, &buf, 1);
-    buf = ((uint8_t)(address >> 8));
-    w25qxx_transmit(w25qxx, &buf, 1);
-    buf = ((uint8_t)(address & 0xFF));
-    w25qxx_transmit(w25qxx, &buf, 1);
-}
 /**
  * @brief 读取 W25QXX
  *
@@ -403,23 +391,30 @@ static void w25qxx_send_addr(w25qxx_handle_t *w25qxx, uint32_t address) {
  * @param[out] buf 缓冲区
  * @param len 读取长度
  * @return 操作结果
+ * @note 每次最多读取 `W25QXX_READ_CHUNK` 字节, 之间其他设备可以使用 SPI.
  */
 w25qxx_result_t w25qxx_read(w25qxx_handle_t *w25qxx, uint32_t address,
                             uint8_t *buf, uint32_t len) {
-    uint8_t cmd = W25QXX_READ_DATA;
-    w25qxx_result_t ret;
+    uint32_t chunk;
 
     if (w25qxx == NULL) {
         return W25QXX_ERROR;
     }
 
-    cs_on(w25qxx);
-    w25qxx_transmit(w25qxx, &cmd, 1);
-    w25qxx_send_addr(w25qxx, address);
-    ret = w25qxx_receive(w25qxx, buf, len);
-    cs_off(w25qxx);
+    while (len != 0) {
+        chunk = (len > W25QXX_READ_CHUNK) ? W25QXX_READ_CHUNK : len;
+        if (w25qxx_command(w25qxx, W25QXX_READ_DATA, address,
+                           w25qxx_addr_len(w25qxx), NULL, buf,
+                           chunk) != W25QXX_OK) {
+            return W25QXX_ERROR;
+        }
 
-    return ret;
+        address += chunk;
+        buf += chunk;
+        len -= chunk;
+    }
+
+    return W25QXX_OK;
 }
 
 /**
@@ -433,8 +428,6 @@ w25qxx_result_t w25qxx_read(w25qxx_handle_t *w25qxx, uint32_t address,
  */
 static w25qxx_result_t w25qxx_write_page(w25qxx_handle_t *w25qxx, uint8_t *buf,
                                          uint32_t addr, uint16_t len) {
-    uint8_t cmd = W25QXX_PAGE_PROGRAM;
-
     if (w25qxx_write_enable(w25qxx) != W25QXX_OK) {
         return W25QXX_ERROR;
     }
@@ -443,17 +436,12 @@ static w25qxx_result_t w25qxx_write_page(w25qxx_handle_t *w25qxx, uint8_t *buf,
         return W25QXX_ERROR;
     }
 
-    cs_on(w25qxx);
-
-    w25qxx_transmit(w25qxx, &cmd, 1);
-    w25qxx_send_addr(w25qxx, addr);
-
-    if (w25qxx_transmit(w25qxx, buf, len) != W25QXX_OK) {
+    if (w25qxx_command(w25qxx, W25QXX_PAGE_PROGRAM, addr,
+                       w25qxx_addr_len(w25qxx), buf, NULL,
+                       len) != W25QXX_OK) {
         return W25QXX_ERROR;
     }
 
-    cs_off(w25qxx);
-
     if (w25qxx_wait_for_ready(w25qxx, 1000) != W25QXX_OK) {
         return W25QXX_TIMEOUT;
     }
@@ -615,8 +603,6 @@ w25qxx_result_t w25qxx_write(w25qxx_handle_t *w25qxx, uint32_t address,
  * @note 注意是扇区地址, 不是字节地址! 擦除一个扇区至少 150 ms
  */
 w25qxx_result_t w25qxx_erase(w25qxx_handle_t *w25qxx, uint32_t address) {
-    uint8_t cmd = W25QXX_SECTOR_ERASE;
-
     if (w25qxx == NULL) {
         return W25QXX_ERROR;
     }
@@ -630,10 +616,11 @@ w25qxx_result_t w25qxx_erase(w25qxx_handle_t *w25qxx, uint32_t address) {
         return W25QXX_TIMEOUT;
     }
 
-    cs_on(w25qxx);
-    w25qxx_transmit(w25qxx, &cmd, 1);
-    w25qxx_send_addr(w25qxx, address);
-    cs_off(w25qxx);
+    if (w25qxx_command(w25qxx, W25QXX_SECTOR_ERASE, address,
+                       w25qxx_addr_len(w25qxx), NULL, NULL,
+                       0) != W25QXX_OK) {
+        return W25QXX_ERROR;
+    }
 
     if (w25qxx_wait_for_ready(w25qxx, 1000) != W25QXX_OK) {
         return W25QXX_TIMEOUT;
@@ -649,8 +636,6 @@ w25qxx_result_t w25qxx_erase(w25qxx_handle_t *w25qxx, uint32_t address) {
  * @return 操作结果
  */
 w25qxx_result_t w25qxx_chip_erase(w25qxx_handle_t *w25qxx) {
-    uint8_t cmd = W25QXX_CHIP_ERASE;
-
     if (w25qxx == NULL) {
         return W25QXX_ERROR;
     }
@@ -660,9 +645,10 @@ w25qxx_result_t w25qxx_chip_erase(w25qxx_handle_t *w25qxx) {
         return W25QXX_TIMEOUT;
     }
 
-    cs_on(w25qxx);
-    w25qxx_transmit(w25qxx, &cmd, 1);
-    cs_off(w25qxx);
+    if (w25qxx_command(w25qxx, W25QXX_CHIP_ERASE, 0, 0, NULL, NULL, 0) !=
+        W25QXX_OK) {
+        return W25QXX_ERROR;
+    }
 
     w25qxx_wait_for_ready(w25qxx, HAL_MAX_DELAY);
 
@@ -27,6 +27,18 @@ extern "C" {
 /* 是否使用 SPI */
 #define W25QXX_USE_SPI                 1
 
+#if W25QXX_USE_SPI
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* SPI 时钟模式和速度, 每次传输时设置, 同一 SPI 上的其他设备可以使用不同的设置 */
+#define W25QXX_SPI_CLK_MODE            SPI_CLK_MODE3
+#define W25QXX_SPI_SPEED               SPI_BAUDRATEPRESCALER_2
+#endif /* W25QXX_USE_SPI */
+
+/* 一次读取的最大字节数, 不能超过 0xFFFF */
+#define W25QXX_READ_CHUNK              0x8000
+
 #define W25QXX_MANUFACTURER_NORMEM     0x52
 #define W25QXX_MANUFACTURER_BYTE       0x68
 #define W25QXX_MANUFACTURER_GIGADEVICE 0xC8
@@ -68,9 +80,10 @@ typedef union {
 typedef struct {
     w25qxx_spi_handle_t handle; /*!< 外设句柄 */
 #if W25QXX_USE_SPI
-    GPIO_TypeDef *cs_port; /*!< 片选端口 */
-    uint16_t cs_pin;       /*!< 片选引脚 */
-#endif                     /* W25QXX_USE_SPI */
+    GPIO_TypeDef *cs_port;  /*!< 片选端口 */
+    uint16_t cs_pin;        /*!< 片选引脚 */
+    SemaphoreHandle_t done; /*!< SPI 传输完成 */
+#endif                      /* W25QXX_USE_SPI */
     bool use_qspi;         /*!< 是否使用 QSPI */
 
     uint8_t manufacturer_id; /*!< 制造商 */
@@ -92,7 +105,8 @@ w25qxx_result_t w25qxx_init(w25qxx_handle_t *w25qxx, bool use_qspi);
 w25qxx_result_t w25qxx_deinit(w25qxx_handle_t *w25qxx);
 uint32_t w25qxx_read_id(w25qxx_handle_t *w25qxx);
 uint8_t w25qxx_get_status(w25qxx_handle_t *w25qxx, uint8_t reg);
-uint8_t w25qxx_set_status(w25qxx_handle_t *w25qxx, uint8_t reg, uint8_t status);
+w25qxx_result_t w25qxx_set_status(w25qxx_handle_t *w25qxx, uint8_t reg,
+                                  uint8_t status);
 w25qxx_result_t w25qxx_write_enable(w25qxx_handle_t *w25qxx);
 
 w25qxx_result_t w25qxx_read(w25qxx_handle_t *w25qxx, uint32_t address,
@@ -93,6 +93,8 @@ uint8_t i2c1_init(uint32_t clock_speed, uint32_t address,
 #if I2C1_IT_ENABLE
     HAL_NVIC_SetPriority(I2C1_EV_IRQn, I2C1_IT_PRIORITY, I2C1_IT_SUB);
     HAL_NVIC_EnableIRQ(I2C1_EV_IRQn);
+    HAL_NVIC_SetPriority(I2C1_ER_IRQn, I2C1_IT_PRIORITY, I2C1_IT_SUB);
+    HAL_NVIC_EnableIRQ(I2C1_ER_IRQn);
 #endif /* I2C1_IT_ENABLE */
 
 #if I2C1_RX_DMA
@@ -148,6 +150,14 @@ void I2C1_EV_IRQHandler(void) {
     HAL_I2C_EV_IRQHandler(&i2c1_handle);
 }
 
+/**
+ * @brief I2C1 Error ISR.
+ *
+ */
+void I2C1_ER_IRQHandler(void) {
+    HAL_I2C_ER_IRQHandler(&i2c1_handle);
+}
+
 #endif /* I2C1_IT_ENABLE */
 
 #if I2C1_RX_DMA
@@ -190,6 +200,11 @@ uint8_t i2c1_deinit(void) {
 
     __HAL_RCC_I2C1_CLK_DISABLE();
 
+#if I2C1_IT_ENABLE
+    HAL_NVIC_DisableIRQ(I2C1_EV_IRQn);
+    HAL_NVIC_DisableIRQ(I2C1_ER_IRQn);
+#endif /* I2C1_IT_ENABLE */
+
     HAL_GPIO_DeInit(CSP_GPIO_PORT(I2C1_SCL_PORT), I2C1_SCL_PIN);
     HAL_GPIO_DeInit(CSP_GPIO_PORT(I2C1_SDA_PORT), I2C1_SDA_PIN);
 
@@ -312,6 +327,8 @@ uint8_t i2c2_init(uint32_t clock_speed, uint32_t address,
 #if I2C2_IT_ENABLE
     HAL_NVIC_SetPriority(I2C2_EV_IRQn, I2C2_IT_PRIORITY, I2C2_IT_SUB);
     HAL_NVIC_EnableIRQ(I2C2_EV_IRQn);
+    HAL_NVIC_SetPriority(I2C2_ER_IRQn, I2C2_IT_PRIORITY, I2C2_IT_SUB);
+    HAL_NVIC_EnableIRQ(I2C2_ER_IRQn);
 #endif /* I2C2_IT_ENABLE */
 
 #if I2C2_RX_DMA
@@ -367,6 +384,14 @@ void I2C2_EV_IRQHandler(void) {
     HAL_I2C_EV_IRQHandler(&i2c2_handle);
 }
 
+/**
+ * @brief I2C2 Error ISR.
+ *
+ */
+void I2C2_ER_IRQHandler(void) {
+    HAL_I2C_ER_IRQHandler(&i2c2_handle);
+}
+
 #endif /* I2C2_IT_ENABLE */
 
 #if I2C2_RX_DMA
@@ -409,6 +434,11 @@ uint8_t i2c2_deinit(void) {
 
     __HAL_RCC_I2C2_CLK_DISABLE();
 
+#if I2C2_IT_ENABLE
+    HAL_NVIC_DisableIRQ(I2C2_EV_IRQn);
+    HAL_NVIC_DisableIRQ(I2C2_ER_IRQn);
+#endif /* I2C2_IT_ENABLE */
+
     HAL_GPIO_DeInit(CSP_GPIO_PORT(I2C2_SCL_PORT), I2C2_SCL_PIN);
     HAL_GPIO_DeInit(CSP_GPIO_PORT(I2C2_SDA_PORT), I2C2_SDA_PIN);
 
@@ -531,6 +561,8 @@ uint8_t i2c3_init(uint32_t clock_speed, uint32_t address,
 #if I2C3_IT_ENABLE
     HAL_NVIC_SetPriority(I2C3_EV_IRQn, I2C3_IT_PRIORITY, I2C3_IT_SUB);
     HAL_NVIC_EnableIRQ(I2C3_EV_IRQn);
+    HAL_NVIC_SetPriority(I2C3_ER_IRQn, I2C3_IT_PRIORITY, I2C3_IT_SUB);
+    HAL_NVIC_EnableIRQ(I2C3_ER_IRQn);
 #endif /* I2C3_IT_ENABLE */
 
 #if I2C3_RX_DMA
@@ -586,6 +618,14 @@ void I2C3_EV_IRQHandler(void) {
     HAL_I2C_EV_IRQHandler(&i2c3_handle);
 }
 
+/**
+ * @brief I2C3 Error ISR.
+ *
+ */
+void I2C3_ER_IRQHandler(void) {
+    HAL_I2C_ER_IRQHandler(&i2c3_handle);
+}
+
 #endif /* I2C3_IT_ENABLE */
 
 #if I2C3_RX_DMA
@@ -628,6 +668,11 @@ uint8_t i2c3_deinit(void) {
 
     __HAL_RCC_I2C3_CLK_DISABLE();
 
+#if I2C3_IT_ENABLE
+    HAL_NVIC_DisableIRQ(I2C3_EV_IRQn);
+    HAL_NVIC_DisableIRQ(I2C3_ER_IRQn);
+#endif /* I2C3_IT_ENABLE */
+
     HAL_GPIO_DeInit(CSP_GPIO_PORT(I2C3_SCL_PORT), I2C3_SCL_PIN);
     HAL_GPIO_DeInit(CSP_GPIO_PORT(I2C3_SDA_PORT), I2C3_SDA_PIN);
 
@@ -665,3 +710,586 @@ uint8_t i2c3_deinit(void) {
 /**
  * @}
  */
+
+/*****************************************************************************
+ * @defgroup I2C bus.
+ * @note Devices on one I2C queue their transfers with `i2c_bus_submit`, the
+ *       bus runs them one after another by DMA (`I2Cx_RX_DMA`/`I2Cx_TX_DMA`
+ *       with `I2Cx_IT_ENABLE`), interrupt (`I2Cx_IT_ENABLE`) or polling. The
+ *       next transfer is started in the interrupt of the last one, no lock is
+ *       needed by the devices. When the bus is stuck (bus error, arbitration
+ *       lost or BUSY never clears), SCL is clocked until the slave releases
+ *       SDA, then a STOP is sent and the I2C is initialized again. Only master
+ *       mode is supported. Don't call HAL I2C functions on an I2C in use by
+ *       the bus.
+ * @{
+ */
+
+/**
+ * @brief Queue of an I2C.
+ */
+typedef struct {
+    I2C_HandleTypeDef *hi2c;  /*!< The handle of I2C */
+    uint8_t it;               /*!< I2C interrupt is enabled */
+    GPIO_TypeDef *scl_port;   /*!< SCL port */
+    uint16_t scl_pin;         /*!< SCL pin */
+    uint8_t scl_af;           /*!< Alternate function of SCL */
+    GPIO_TypeDef *sda_port;   /*!< SDA port */
+    uint16_t sda_pin;         /*!< SDA pin */
+    uint8_t sda_af;           /*!< Alternate function of SDA */
+    volatile uint8_t running; /*!< The queue is being transferred */
+    volatile uint8_t async;   /*!< `head` is transferred by DMA or interrupt */
+    volatile uint8_t stuck;   /*!< Clear the bus before the next transfer */
+    i2c_xfer_t *head;         /*!< Transfer in progress */
+    i2c_xfer_t *tail;         /*!< Last transfer in the queue */
+} i2c_bus_t;
+
+#if I2C1_ENABLE
+static i2c_bus_t i2c1_bus = {.hi2c = &i2c1_handle,
+                             .it = I2C1_IT_ENABLE,
+                             .scl_port = CSP_GPIO_PORT(I2C1_SCL_PORT),
+                             .scl_pin = I2C1_SCL_PIN,
+                             .scl_af = GPIO_AF4_I2C1,
+                             .sda_port = CSP_GPIO_PORT(I2C1_SDA_PORT),
+                             .sda_pin = I2C1_SDA_PIN,
+                             .sda_af = GPIO_AF4_I2C1};
+#endif /* I2C1_ENABLE */
+
+#if I2C2_ENABLE
+static i2c_bus_t i2c2_bus = {.hi2c = &i2c2_handle,
+                             .it = I2C2_IT_ENABLE,
+                             .scl_port = CSP_GPIO_PORT(I2C2_SCL_PORT),
+                             .scl_pin = I2C2_SCL_PIN,
+                             .scl_af = GPIO_AF4_I2C2,
+                             .sda_port = CSP_GPIO_PORT(I2C2_SDA_PORT),
+                             .sda_pin = I2C2_SDA_PIN,
+                             .sda_af = I2C2_SDA_GPIO_AF};
+#endif /* I2C2_ENABLE */
+
+#if I2C3_ENABLE
+static i2c_bus_t i2c3_bus = {.hi2c = &i2c3_handle,
+                             .it = I2C3_IT_ENABLE,
+                             .scl_port = CSP_GPIO_PORT(I2C3_SCL_PORT),
+                             .scl_pin = I2C3_SCL_PIN,
+                             .scl_af = GPIO_AF4_I2C3,
+                             .sda_port = CSP_GPIO_PORT(I2C3_SDA_PORT),
+                             .sda_pin = I2C3_SDA_PIN,
+                             .sda_af = I2C3_SDA_GPIO_AF};
+#endif /* I2C3_ENABLE */
+
+/**
+ * @brief Get the queue of an I2C.
+ *
+ * @param hi2c The handle of I2C.
+ * @return The queue. return NULL which the I2C doesn't exist.
+ */
+static i2c_bus_t *i2c_bus_find(I2C_HandleTypeDef *hi2c) {
+#if I2C1_ENABLE
+    if (hi2c == &i2c1_handle) {
+        return &i2c1_bus;
+    }
+#endif /* I2C1_ENABLE */
+
+#if I2C2_ENABLE
+    if (hi2c == &i2c2_handle) {
+        return &i2c2_bus;
+    }
+#endif /* I2C2_ENABLE */
+
+#if I2C3_ENABLE
+    if (hi2c == &i2c3_handle) {
+        return &i2c3_bus;
+    }
+#endif /* I2C3_ENABLE */
+
+    UNUSED(hi2c);
+    return NULL;
+}
+
+/**
+ * @brief Half period of SCL when clearing the bus, about 5 us.
+ *
+ */
+static void i2c_bus_delay(void) {
+    volatile uint32_t count = SystemCoreClock / 1000000U;
+
+    while (count != 0) {
+        --count;
+    }
+}
+
+/**
+ * @brief Release a stuck bus and initialize the I2C again.
+ *
+ * @param bus The queue.
+ * @return `I2C_BUS_OK`; `I2C_BUS_ERROR`: SCL or SDA is still held low.
+ */
+static uint8_t i2c_bus_clear(i2c_bus_t *bus) {
+    GPIO_InitTypeDef gpio_init_struct = {.Mode = GPIO_MODE_OUTPUT_OD,
+                                         .Pull = GPIO_PULLUP,
+                                         .Speed = GPIO_SPEED_FREQ_VERY_HIGH};
+    uint8_t res = I2C_BUS_OK;
+    uint32_t i;
+
+    HAL_I2C_DeInit(bus->hi2c);
+
+    HAL_GPIO_WritePin(bus->scl_port, bus->scl_pin, GPIO_PIN_SET);
+    HAL_GPIO_WritePin(bus->sda_port, bus->sda_pin, GPIO_PIN_SET);
+    gpio_init_struct.Pin = bus->scl_pin;
+    HAL_GPIO_Init(bus->scl_port, &gpio_init_struct);
+    gpio_init_struct.Pin = bus->sda_pin;
+    HAL_GPIO_Init(bus->sda_port, &gpio_init_struct);
+    i2c_bus_delay();
+
+    /* The slave releases SDA after it has shifted out the rest of the byte. */
+    for (i = 0; i < I2C_BUS_RECOVER_CLOCKS; ++i) {
+        if (HAL_GPIO_ReadPin(bus->sda_port, bus->sda_pin) == GPIO_PIN_SET) {
+            break;
+        }
+
+        HAL_GPIO_WritePin(bus->scl_port, bus->scl_pin, GPIO_PIN_RESET);
+        i2c_bus_delay();
+        HAL_GPIO_WritePin(bus->scl_port, bus->scl_pin, GPIO_PIN_SET);
+        i2c_bus_delay();
+    }
+
+    /* STOP: SDA rises while SCL is high. */
+    HAL_GPIO_WritePin(bus->scl_port, bus->scl_pin, GPIO_PIN_RESET);
+    i2c_bus_delay();
+    HAL_GPIO_WritePin(bus->sda_port, bus->sda_pin, GPIO_PIN_RESET);
+    i2c_bus_delay();
+    HAL_GPIO_WritePin(bus->scl_port, bus->scl_pin, GPIO_PIN_SET);
+    i2c_bus_delay();
+    HAL_GPIO_WritePin(bus->sda_port, bus->sda_pin, GPIO_PIN_SET);
+    i2c_bus_delay();
+
+    if (HAL_GPIO_ReadPin(bus->scl_port, bus->scl_pin) == GPIO_PIN_RESET ||
+        HAL_GPIO_ReadPin(bus->sda_port, bus->sda_pin) == GPIO_PIN_RESET) {
+        res = I2C_BUS_ERROR;
+    }
+
+    gpio_init_struct.Mode = GPIO_MODE_AF_OD;
+    gpio_init_struct.Pin = bus->scl_pin;
+    gpio_init_struct.Alternate = bus->scl_af;
+    HAL_GPIO_Init(bus->scl_port, &gpio_init_struct);
+    gpio_init_struct.Pin = bus->sda_pin;
+    gpio_init_struct.Alternate = bus->sda_af;
+    HAL_GPIO_Init(bus->sda_port, &gpio_init_struct);
+
+    /* The I2C is reset by software in `HAL_I2C_Init`, BUSY is cleared. */
+    if (HAL_I2C_Init(bus->hi2c) != HAL_OK) {
+        res = I2C_BUS_ERROR;
+    }
+
+    return res;
+}
+
+/**
+ * @brief Get the status of a failed transfer, mark the bus if it is stuck.
+ *
+ * @param bus The queue.
+ * @return `I2C_BUS_NACK` or `I2C_BUS_ERROR`.
+ * @note It may be called in interrupt, so the bus is not cleared here. See
+ *       `i2c_bus_run`.
+ */
+static uint8_t i2c_bus_error(i2c_bus_t *bus) {
+    uint32_t error = bus->hi2c->ErrorCode;
+
+    if (error & (HAL_I2C_ERROR_BERR | HAL_I2C_ERROR_ARLO |
+                 HAL_I2C_ERROR_TIMEOUT)) {
+        bus->stuck = 1;
+    }
+
+    return (error & HAL_I2C_ERROR_AF) ? I2C_BUS_NACK : I2C_BUS_ERROR;
+}
+
+/**
+ * @brief Start a transfer.
+ *
+ * @param bus The queue.
+ * @param xfer The transfer.
+ * @return `I2C_BUS_PENDING`: Started by DMA or interrupt; `I2C_BUS_OK`,
+ *         `I2C_BUS_NACK` or `I2C_BUS_ERROR`: Done by polling.
+ */
+static uint8_t i2c_bus_start(i2c_bus_t *bus, i2c_xfer_t *xfer) {
+    I2C_HandleTypeDef *hi2c = bus->hi2c;
+    uint16_t dev = xfer->dev_addr;
+    uint16_t mem = xfer->mem_addr;
+    uint16_t size = xfer->mem_addr_size;
+    uint8_t *buf = xfer->buf;
+    uint16_t len = xfer->len;
+    DMA_HandleTypeDef *hdma;
+    HAL_StatusTypeDef res;
+
+    hdma = (xfer->type == I2C_XFER_READ || xfer->type == I2C_XFER_MEM_READ)
+               ? hi2c->hdmarx
+               : hi2c->hdmatx;
+
+    /* The address is sent in the event interrupt, DMA needs it too. */
+    if (bus->it && hdma != NULL && len > 1) {
+        bus->async = 1;
+        switch (xfer->type) {
+            case I2C_XFER_WRITE:
+                res = HAL_I2C_Master_Transmit_DMA(hi2c, dev, buf, len);
+                break;
+            case I2C_XFER_READ:
+                res = HAL_I2C_Master_Receive_DMA(hi2c, dev, buf, len);
+                break;
+            case I2C_XFER_MEM_WRITE:
+                res = HAL_I2C_Mem_Write_DMA(hi2c, dev, mem, size, buf, len);
+                break;
+            default:
+                res = HAL_I2C_Mem_Read_DMA(hi2c, dev, mem, size, buf, len);
+                break;
+        }
+    } else if (bus->it) {
+        bus->async = 1;
+        switch (xfer->type) {
+            case I2C_XFER_WRITE:
+                res = HAL_I2C_Master_Transmit_IT(hi2c, dev, buf, len);
+                break;
+            case I2C_XFER_READ:
+                res = HAL_I2C_Master_Receive_IT(hi2c, dev, buf, len);
+                break;
+            case I2C_XFER_MEM_WRITE:
+                res = HAL_I2C_Mem_Write_IT(hi2c, dev, mem, size, buf, len);
+                break;
+            default:
+                res = HAL_I2C_Mem_Read_IT(hi2c, dev, mem, size, buf, len);
+                break;
+        }
+    } else {
+        switch (xfer->type) {
+            case I2C_XFER_WRITE:
+                res = HAL_I2C_Master_Transmit(hi2c, dev, buf, len,
+                                              I2C_BUS_POLL_TIMEOUT);
+                break;
+            case I2C_XFER_READ:
+                res = HAL_I2C_Master_Receive(hi2c, dev, buf, len,
+                                             I2C_BUS_POLL_TIMEOUT);
+                break;
+            case I2C_XFER_MEM_WRITE:
+                res = HAL_I2C_Mem_Write(hi2c, dev, mem, size, buf, len,
+                                        I2C_BUS_POLL_TIMEOUT);
+                break;
+            default:
+                res = HAL_I2C_Mem_Read(hi2c, dev, mem, size, buf, len,
+                                       I2C_BUS_POLL_TIMEOUT);
+                break;
+        }
+    }
+
+    if (res != HAL_OK) {
+        bus->async = 0;
+        return i2c_bus_error(bus);
+    }
+
+    return bus->async ? I2C_BUS_PENDING : I2C_BUS_OK;
+}
+
+/**
+ * @brief Finish the head of the queue.
+ *
+ * @param bus The queue.
+ * @param status `I2C_BUS_OK`, `I2C_BUS_NACK` or `I2C_BUS_ERROR`.
+ */
+static void i2c_bus_finish(i2c_bus_t *bus, uint8_t status) {
+    void (*callback)(void *user, uint8_t status);
+    i2c_xfer_t *xfer;
+    uint32_t primask;
+    void *user;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    xfer = bus->head;
+    bus->head = xfer->link;
+    if (bus->head == NULL) {
+        bus->tail = NULL;
+    }
+    __set_PRIMASK(primask);
+
+    /* The owner may reuse it after the status is set. */
+    callback = xfer->callback;
+    user = xfer->user;
+    xfer->status = status;
+    if (callback != NULL) {
+        callback(user, status);
+    }
+}
+
+/**
+ * @brief Transfer the queue until it is empty or a transfer is started by
+ *        DMA or interrupt.
+ *
+ * @param bus The queue.
+ * @note Clearing a stuck bus bit-bangs SCL for up to about 100 us, so it is
+ *       not done in interrupt. The queue stops there and is run again by the
+ *       next `i2c_bus_submit` or `i2c_bus_recover` in task context.
+ */
+static void i2c_bus_run(i2c_bus_t *bus) {
+    i2c_xfer_t *xfer;
+    uint32_t primask;
+    uint8_t res;
+
+    while (1) {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        xfer = bus->head;
+        if (xfer != NULL && bus->stuck && __get_IPSR() != 0) {
+            xfer = NULL;
+        }
+        if (xfer == NULL) {
+            bus->running = 0;
+        }
+        __set_PRIMASK(primask);
+
+        if (xfer == NULL) {
+            return;
+        }
+
+        if (bus->stuck) {
+            bus->stuck = 0;
+            i2c_bus_clear(bus);
+        }
+
+        res = i2c_bus_start(bus, xfer);
+        if (res == I2C_BUS_PENDING) {
+            return;
+        }
+
+        i2c_bus_finish(bus, res);
+    }
+}
+
+/**
+ * @brief A transfer by DMA or interrupt is done.
+ *
+ * @param hi2c The handle of I2C.
+ * @param ok The transfer succeeded.
+ */
+static void i2c_bus_irq_done(I2C_HandleTypeDef *hi2c, uint8_t ok) {
+    i2c_bus_t *bus = i2c_bus_find(hi2c);
+
+    if (bus == NULL || bus->async == 0) {
+        return;
+    }
+
+    bus->async = 0;
+    i2c_bus_finish(bus, ok ? I2C_BUS_OK : i2c_bus_error(bus));
+    i2c_bus_run(bus);
+}
+
+/**
+ * @brief I2C master transmit completed callback.
+ *
+ * @param hi2c The handle of I2C.
+ */
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    i2c_bus_irq_done(hi2c, 1);
+}
+
+/**
+ * @brief I2C master receive completed callback.
+ *
+ * @param hi2c The handle of I2C.
+ */
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    i2c_bus_irq_done(hi2c, 1);
+}
+
+/**
+ * @brief I2C memory write completed callback.
+ *
+ * @param hi2c The handle of I2C.
+ */
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    i2c_bus_irq_done(hi2c, 1);
+}
+
+/**
+ * @brief I2C memory read completed callback.
+ *
+ * @param hi2c The handle of I2C.
+ */
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    i2c_bus_irq_done(hi2c, 1);
+}
+
+/**
+ * @brief I2C error callback.
+ *
+ * @param hi2c The handle of I2C.
+ */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+    i2c_bus_irq_done(hi2c, 0);
+}
+
+/**
+ * @brief Put a transfer into the queue of an I2C, it is started at once when
+ *        the I2C is idle.
+ *
+ * @param hi2c The handle of I2C.
+ * @param xfer The transfer. It can't be modified until done.
+ * @return Submit status.
+ * @retval - 0: `I2C_BUS_OK`:        Success.
+ * @retval - 1: `I2C_BUS_PARAM_ERR`: Parameter invalid.
+ * @retval - 2: `I2C_BUS_NO_INIT`:   I2C is not initialized.
+ * @note It can be called in interrupt. `callback` is called in interrupt
+ *       when the transfer is done by DMA or interrupt, otherwise in the
+ *       context which runs the queue. After a bus error the queue waits
+ *       until it is submitted to or recovered in task context, where the
+ *       bus is cleared. With RTOS, notify the waiting task in
+ *       `callback`. Buffers for DMA can't be in CCM RAM.
+ */
+uint8_t i2c_bus_submit(I2C_HandleTypeDef *hi2c, i2c_xfer_t *xfer) {
+    i2c_bus_t *bus = i2c_bus_find(hi2c);
+    uint32_t primask;
+    uint8_t start;
+
+    if (bus == NULL || xfer == NULL) {
+        return I2C_BUS_PARAM_ERR;
+    }
+
+    if (HAL_I2C_GetState(hi2c) == HAL_I2C_STATE_RESET) {
+        return I2C_BUS_NO_INIT;
+    }
+
+    if (xfer->type > I2C_XFER_MEM_READ || xfer->len == 0 ||
+        xfer->buf == NULL) {
+        return I2C_BUS_PARAM_ERR;
+    }
+
+    if ((xfer->type == I2C_XFER_MEM_WRITE ||
+         xfer->type == I2C_XFER_MEM_READ) &&
+        !IS_I2C_MEMADD_SIZE(xfer->mem_addr_size)) {
+        return I2C_BUS_PARAM_ERR;
+    }
+
+    xfer->status = I2C_BUS_PENDING;
+    xfer->link = NULL;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (bus->tail == NULL) {
+        bus->head = xfer;
+    } else {
+        bus->tail->link = xfer;
+    }
+    bus->tail = xfer;
+    start = !bus->running;
+    bus->running = 1;
+    __set_PRIMASK(primask);
+
+    if (start) {
+        i2c_bus_run(bus);
+    }
+
+    return I2C_BUS_OK;
+}
+
+/**
+ * @brief Wait for a transfer to be done.
+ *
+ * @param xfer The transfer.
+ * @param timeout Timeout, unit: ms.
+ * @return Transfer status.
+ * @retval - 0: `I2C_BUS_OK`:      Success.
+ * @retval - 3: `I2C_BUS_ERROR`:   Transfer failed.
+ * @retval - 4: `I2C_BUS_TIMEOUT`: Timeout, the transfer is still in the
+ *                                 queue.
+ * @retval - 6: `I2C_BUS_NACK`:    The device didn't acknowledge.
+ * @note It polls the status. With RTOS, notify the task in `callback` and
+ *       wait for it to release the CPU.
+ */
+uint8_t i2c_bus_wait(i2c_xfer_t *xfer, uint32_t timeout) {
+    uint32_t start = HAL_GetTick();
+
+    while (xfer->status == I2C_BUS_PENDING) {
+        if (HAL_GetTick() - start >= timeout) {
+            return I2C_BUS_TIMEOUT;
+        }
+    }
+
+    return xfer->status;
+}
+
+/**
+ * @brief Submit a transfer and wait for it.
+ *
+ * @param hi2c The handle of I2C.
+ * @param xfer The transfer.
+ * @param timeout Timeout, unit: ms.
+ * @return Transfer status, see `i2c_bus_submit` and `i2c_bus_wait`.
+ */
+uint8_t i2c_bus_transfer(I2C_HandleTypeDef *hi2c, i2c_xfer_t *xfer,
+                         uint32_t timeout) {
+    uint8_t res = i2c_bus_submit(hi2c, xfer);
+
+    if (res != I2C_BUS_OK) {
+        return res;
+    }
+
+    return i2c_bus_wait(xfer, timeout);
+}
+
+/**
+ * @brief Whether the queue of an I2C is being transferred.
+ *
+ * @param hi2c The handle of I2C.
+ * @return 1: Busy; 0: Idle or the I2C doesn't exist.
+ */
+uint8_t i2c_bus_busy(I2C_HandleTypeDef *hi2c) {
+    i2c_bus_t *bus = i2c_bus_find(hi2c);
+
+    return (bus != NULL) ? bus->running : 0;
+}
+
+/**
+ * @brief Clock SCL until the slave releases SDA, send a STOP and initialize
+ *        the I2C again.
+ *
+ * @param hi2c The handle of I2C.
+ * @return Recover status.
+ * @retval - 0: `I2C_BUS_OK`:        Success.
+ * @retval - 1: `I2C_BUS_PARAM_ERR`: The I2C doesn't exist or is in use by
+ *                                   the bus.
+ * @retval - 2: `I2C_BUS_NO_INIT`:   I2C is not initialized.
+ * @retval - 3: `I2C_BUS_ERROR`:     SCL or SDA is still held low.
+ * @note The bus does it by itself before the next transfer after a bus
+ *       error. It can't be called in interrupt. The transfers waiting behind
+ *       a bus error are started again.
+ */
+uint8_t i2c_bus_recover(I2C_HandleTypeDef *hi2c) {
+    i2c_bus_t *bus = i2c_bus_find(hi2c);
+    uint32_t primask;
+    uint8_t res, start;
+
+    if (bus == NULL || bus->running) {
+        return I2C_BUS_PARAM_ERR;
+    }
+
+    if (HAL_I2C_GetState(hi2c) == HAL_I2C_STATE_RESET) {
+        return I2C_BUS_NO_INIT;
+    }
+
+    bus->stuck = 0;
+    res = i2c_bus_clear(bus);
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    start = !bus->running && bus->head != NULL;
+    if (start) {
+        bus->running = 1;
+    }
+    __set_PRIMASK(primask);
+
+    if (start) {
+        i2c_bus_run(bus);
+    }
+
+    return res;
+}
+
+/**
+ * @}
+ */
@@ -30,10 +30,56 @@ extern "C" {
 #define I2C_DEINIT_DMA_FAIL 2
 #define I2C_NO_INIT         3
 
+#define I2C_BUS_OK          0
+#define I2C_BUS_PARAM_ERR   1
+#define I2C_BUS_NO_INIT     2
+#define I2C_BUS_ERROR       3
+#define I2C_BUS_TIMEOUT     4
+#define I2C_BUS_PENDING     5
+#define I2C_BUS_NACK        6
+
+/* Timeout of a transfer without DMA and interrupt, unit: ms. */
+#define I2C_BUS_POLL_TIMEOUT    100
+
+/* SCL pulses to let a slave release SDA when the bus is stuck. */
+#define I2C_BUS_RECOVER_CLOCKS  9
+
 /**
  * @}
  */
 
+/**
+ * @brief Type of an I2C transfer.
+ */
+typedef enum {
+    I2C_XFER_WRITE,     /*!< START, address, `buf`, STOP */
+    I2C_XFER_READ,      /*!< START, address, read `buf`, STOP */
+    I2C_XFER_MEM_WRITE, /*!< START, address, `mem_addr`, `buf`, STOP */
+    I2C_XFER_MEM_READ   /*!< START, address, `mem_addr`, RESTART, address,
+                             read `buf`, STOP */
+} i2c_xfer_type_t;
+
+/**
+ * @brief Transfer on a shared I2C bus.
+ */
+typedef struct i2c_xfer {
+    uint8_t type;               /*!< `i2c_xfer_type_t` */
+    uint8_t mem_addr_size;      /*!< `I2C_MEMADD_SIZE_8BIT` or
+                                     `I2C_MEMADD_SIZE_16BIT` */
+    uint16_t dev_addr;          /*!< Device address, 7-bit address is shifted
+                                     left by 1 */
+    uint16_t mem_addr;          /*!< Memory address of `I2C_XFER_MEM_x` */
+    uint16_t len;               /*!< Bytes to transfer */
+    uint8_t *buf;               /*!< Data to send or data received */
+    void (*callback)(void *user, uint8_t status); /*!< Called with `user`
+                                                       when done, can be
+                                                       NULL */
+    void *user;                 /*!< User data */
+
+    volatile uint8_t status;    /*!< `I2C_BUS_PENDING` until done */
+    struct i2c_xfer *link;      /*!< Private: next in the queue */
+} i2c_xfer_t;
+
 /*****************************************************************************
  * @defgroup I2C1 Functions
  * @{
@@ -391,6 +437,22 @@ uint8_t i2c3_deinit(void);
 
 #endif /* I2C3_ENABLE */
 
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup I2C Public Functions
+ * @{
+ */
+
+uint8_t i2c_bus_submit(I2C_HandleTypeDef *hi2c, i2c_xfer_t *xfer);
+uint8_t i2c_bus_wait(i2c_xfer_t *xfer, uint32_t timeout);
+uint8_t i2c_bus_transfer(I2C_HandleTypeDef *hi2c, i2c_xfer_t *xfer,
+                         uint32_t timeout);
+uint8_t i2c_bus_busy(I2C_HandleTypeDef *hi2c);
+uint8_t i2c_bus_recover(I2C_HandleTypeDef *hi2c);
+
 /**
  * @}
  */
@@ -41,14 +41,30 @@ void safe_memset(void *dst, unsigned char value, int size) {
         ((unsigned char *)dst)[i] = value;
     }
 }
+#if defined(__ARM_FEATURE_UNALIGNED)
+#include <string.h>
+
+// Unaligned word access is legal here, and the library memcpy only uses
+// LDR/STR on pointers of unknown alignment.
+void safe_memcpy(void *dst, const void *src, int size) {
+    memcpy(dst, src, (size_t)size);
+}
+#else
 void safe_memcpy(void *dst, const void *src, int size) {
     for (int i = 0; i < size; ++i) {
         ((unsigned char *)dst)[i] = ((unsigned char *)src)[i];
     }
 }
+#endif
 #ifndef LZ4_FORCE_MEMORY_ACCESS
+#if defined(__ARM_FEATURE_UNALIGNED)
+// Cortex-M3/M4/M7 handle unaligned LDR/STR in hardware, so packed access
+// compiles to single loads/stores instead of byte loops.
+#define LZ4_FORCE_MEMORY_ACCESS 1
+#else
 #define LZ4_FORCE_MEMORY_ACCESS 0
 #endif
+#endif
 
 /*-************************************
  *  Tuning parameters
@@ -324,7 +340,12 @@ void LZ4_wildCopy(void *dstPtr, const void *srcPtr, void *dstEnd) {
     BYTE *const e = (BYTE *)dstEnd;
 
     do {
+#if LZ4_FORCE_MEMORY_ACCESS
+        LZ4_write32(d, LZ4_read32(s));
+        LZ4_write32(d + 4, LZ4_read32(s + 4));
+#else
         safe_memcpy(d, s, 8);
+#endif
         d += 8;
         s += 8;
     } while (d < e);
@@ -9,6 +9,7 @@
  * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "eez-flow.h"
+#include "lv_port_prof.h"
 #if EEZ_FOR_LVGL_LZ4_OPTION
 #include "eez-flow-lz4.h"
 #endif
@@ -52,11 +53,28 @@ void executeActionFunction(int actionId) {
 #include "lvgl/lvgl.h"
 #endif
 #endif
+#if defined(EEZ_FOR_LVGL) && EEZ_FLOW_SLAB_SIZE > 0
+#include "mem_heap/mem_heap.h"
+#include "mem_heap/mem_slab.h"
+#endif
 namespace eez {
 #if defined(EEZ_FOR_LVGL)
 void initAllocHeap(uint8_t *heap, size_t heapSize) {
+#if EEZ_FLOW_SLAB_SIZE > 0
+    // flow objects are only touched by the CPU, prefer CCM
+    void *arena = mem_heap_alloc(EEZ_FLOW_SLAB_SIZE, MEM_HEAP_HINT_FAST, MEM_HEAP_USER_LVGL);
+    if (arena && mem_slab_init(arena, EEZ_FLOW_SLAB_SIZE) != 0) {
+        mem_heap_free(arena);
+    }
+#endif
 }
 void *alloc(size_t size, uint32_t id) {
+#if EEZ_FLOW_SLAB_SIZE > 0
+    void *ptr = mem_slab_alloc(size);
+    if (ptr) {
+        return ptr;
+    }
+#endif
 #if LVGL_VERSION_MAJOR >= 9
     return lv_malloc(size);
 #else
@@ -64,6 +82,12 @@ void *alloc(size_t size, uint32_t id) {
 #endif
 }
 void free(void *ptr) {
+#if EEZ_FLOW_SLAB_SIZE > 0
+    if (mem_slab_contains(ptr)) {
+        mem_slab_free(ptr);
+        return;
+    }
+#endif
 #if LVGL_VERSION_MAJOR >= 9
     lv_free(ptr);
 #else
@@ -72,17 +96,22 @@ void free(void *ptr) {
 }
 template<typename T> void freeObject(T *ptr) {
 	ptr->~T();
-#if LVGL_VERSION_MAJOR >= 9
-    lv_free(ptr);
-#else
-	lv_mem_free(ptr);
-#endif
+	free(ptr);
 }
 void getAllocInfo(uint32_t &free, uint32_t &alloc) {
+#if EEZ_FLOW_SLAB_SIZE > 0
+    mem_heap_user_stat_t heap;
+    mem_slab_stat_t slab;
+    mem_heap_get_user_stat(MEM_HEAP_USER_LVGL, &heap);
+    mem_slab_get_stat(&slab);
+    free = mem_heap_get_free_size() + slab.total_size - slab.used_size;
+    alloc = heap.used - slab.total_size + slab.used_size;
+#else
     lv_mem_monitor_t mon;
     lv_mem_monitor(&mon);
 	free = mon.free_size;
 	alloc = mon.total_size - mon.free_size;
+#endif
 }
 #elif defined(EEZ_DASHBOARD_API)
 #include <emscripten/heap.h>
@@ -327,11 +356,167 @@ void allocMemoryForDecompressedAssets(const uint8_t *assetsData, uint32_t assets
     decompressedAssetsMemoryBufferSize = decompressedDataOffset + decompressedSize;
     decompressedAssetsMemoryBuffer = (uint8_t *)eez::alloc(decompressedAssetsMemoryBufferSize, 0x587da194);
 }
+struct LoadedChunk {
+    uint8_t *data;
+    uint32_t lastUse;
+    uint32_t refCounter;
+};
+static const uint8_t *g_chunkedAssets;
+static LoadedChunk *g_loadedChunks;
+static uint32_t g_assetsChunkTick;
+static eez_flow_assets_stat_t g_assetsStat;
+static inline const AssetsChunk *getAssetsChunk(uint32_t flowIndex) {
+    return (const AssetsChunk *)(g_chunkedAssets + sizeof(ChunkedHeader)) + flowIndex;
+}
+static inline bool isChunkedFlowDefinition(FlowDefinition *flowDefinition) {
+    return g_loadedChunks && flowDefinition == static_cast<FlowDefinition *>(g_mainAssets->flowDefinition);
+}
+static bool loadChunkedAssets(const uint8_t *assets, uint32_t assetsSize) {
+#if EEZ_FOR_LVGL_LZ4_OPTION
+    auto header = (const ChunkedHeader *)assets;
+    auto coreData = (const uint8_t *)((const AssetsChunk *)(header + 1) + header->numChunks);
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+#endif
+	auto decompressedDataOffset = offsetof(Assets, settings);
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+    if (coreData + header->coreCompressedSize > assets + assetsSize) {
+        return false;
+    }
+    auto decompressedAssets = (Assets *)alloc(decompressedDataOffset + header->header.decompressedSize, 0x587da194);
+    auto loadedChunks = (LoadedChunk *)alloc(header->numChunks * sizeof(LoadedChunk), 0x6a1c94e3);
+    if (!decompressedAssets || !loadedChunks) {
+        return false;
+    }
+    decompressedAssets->projectMajorVersion = header->header.projectMajorVersion;
+    decompressedAssets->projectMinorVersion = header->header.projectMinorVersion;
+    decompressedAssets->assetsType = header->header.assetsType;
+    decompressedAssets->external = false;
+    decompressedAssets->reserved = 0;
+    int decompressResult = LZ4_decompress_safe(
+        (const char *)coreData,
+        (char *)decompressedAssets + decompressedDataOffset,
+        header->coreCompressedSize,
+        header->header.decompressedSize
+    );
+    if (decompressResult != (int)header->header.decompressedSize) {
+        return false;
+    }
+    memset(loadedChunks, 0, header->numChunks * sizeof(LoadedChunk));
+    g_mainAssets = decompressedAssets;
+    g_chunkedAssets = assets;
+    g_loadedChunks = loadedChunks;
+    g_assetsStat.chunks = header->numChunks;
+    return true;
+#else
+    return false;
+#endif
+}
+// Frees the least recently used flow that no flow state is running
+static bool evictAssetsChunk() {
+    LoadedChunk *victim = nullptr;
+    for (uint32_t i = 0; i < g_assetsStat.chunks; i++) {
+        auto loadedChunk = g_loadedChunks + i;
+        if (loadedChunk->data && loadedChunk->refCounter == 0 && (!victim || (int32_t)(loadedChunk->lastUse - victim->lastUse) < 0)) {
+            victim = loadedChunk;
+        }
+    }
+    if (!victim) {
+        return false;
+    }
+    auto chunk = getAssetsChunk(victim - g_loadedChunks);
+#if EEZ_FLOW_THREADED_EVAL
+    flow::purgeThreadedExpressions(victim->data, victim->data + chunk->size);
+#endif
+    free(victim->data);
+    victim->data = nullptr;
+    g_assetsStat.loaded--;
+    g_assetsStat.loadedSize -= chunk->size;
+    g_assetsStat.evictions++;
+    return true;
+}
+static uint8_t *loadAssetsChunk(uint32_t flowIndex) {
+#if EEZ_FOR_LVGL_LZ4_OPTION
+    auto chunk = getAssetsChunk(flowIndex);
+    while (g_assetsStat.loadedSize + chunk->size > EEZ_FLOW_ASSETS_CACHE_SIZE && evictAssetsChunk()) {
+    }
+    auto data = (uint8_t *)alloc(chunk->size, 0x3f7b02c5);
+    while (!data && evictAssetsChunk()) {
+        data = (uint8_t *)alloc(chunk->size, 0x3f7b02c5);
+    }
+    if (!data) {
+        ErrorTrace("Out of memory for flow %d\n", (int)flowIndex);
+        return nullptr;
+    }
+    int decompressResult = LZ4_decompress_safe(
+        (const char *)(g_chunkedAssets + chunk->offset),
+        (char *)data,
+        chunk->compressedSize,
+        chunk->size
+    );
+    if (decompressResult != (int)chunk->size) {
+        free(data);
+        ErrorTrace("Invalid flow %d\n", (int)flowIndex);
+        return nullptr;
+    }
+    // pointers into the core are stored as if the flow was at the start of the core
+    auto relocations = (const uint32_t *)(g_chunkedAssets + chunk->relocationsOffset);
+    auto delta = (int32_t)((uint8_t *)g_mainAssets - data);
+    for (uint32_t i = 0; i < chunk->numRelocations; i++) {
+        *(int32_t *)(data + relocations[i]) += delta;
+    }
+    g_assetsStat.loaded++;
+    g_assetsStat.loadedSize += chunk->size;
+    if (g_assetsStat.loadedSize > g_assetsStat.peakSize) {
+        g_assetsStat.peakSize = g_assetsStat.loadedSize;
+    }
+    g_assetsStat.loads++;
+    return data;
+#else
+    return nullptr;
+#endif
+}
+Flow *getFlow(FlowDefinition *flowDefinition, uint32_t flowIndex) {
+    auto flow = flowDefinition->flows[flowIndex];
+    if (flow || !isChunkedFlowDefinition(flowDefinition)) {
+        return flow;
+    }
+    auto loadedChunk = g_loadedChunks + flowIndex;
+    loadedChunk->lastUse = ++g_assetsChunkTick;
+    if (!loadedChunk->data) {
+        loadedChunk->data = loadAssetsChunk(flowIndex);
+    }
+    return (Flow *)loadedChunk->data;
+}
+// Flows with running flow states stay loaded
+void retainFlow(FlowDefinition *flowDefinition, uint32_t flowIndex) {
+    if (isChunkedFlowDefinition(flowDefinition) && g_loadedChunks[flowIndex].data) {
+        g_loadedChunks[flowIndex].refCounter++;
+    }
+}
+void releaseFlow(FlowDefinition *flowDefinition, uint32_t flowIndex) {
+    if (isChunkedFlowDefinition(flowDefinition) && g_loadedChunks[flowIndex].refCounter > 0) {
+        g_loadedChunks[flowIndex].refCounter--;
+    }
+}
 void loadMainAssets(const uint8_t *assets, uint32_t assetsSize) {
     auto header = (Header *)assets;
+#if EEZ_FLOW_THREADED_EVAL
+    flow::resetThreadedExpressions();
+#endif
     if (header->tag == HEADER_TAG) {
+        // used in place, Value needs at least word alignment
         g_mainAssets = (Assets *)(assets + sizeof(uint32_t));
         g_mainAssetsUncompressed = true;
+        assert(((uintptr_t)g_mainAssets & 3) == 0);
+    } else if (header->tag == HEADER_TAG_CHUNKED) {
+        g_mainAssetsUncompressed = false;
+        auto loaded = loadChunkedAssets(assets, assetsSize);
+        assert(loaded);
+        (void)loaded;
     } else {
 #if defined(EEZ_FOR_LVGL) || defined(EEZ_DASHBOARD_API)
         uint8_t *DECOMPRESSED_ASSETS_START_ADDRESS = 0;
@@ -485,6 +670,9 @@ int16_t getDataIdFromName(const WidgetCursor &widgetCursor, const char *name) {
 }
 #endif 
 } 
+extern "C" void eez_flow_get_assets_stat(eez_flow_assets_stat_t *stat) {
+    *stat = eez::g_assetsStat;
+}
 // -----------------------------------------------------------------------------
 // core/debug.cpp
 // -----------------------------------------------------------------------------
@@ -1011,37 +1199,248 @@ void stringAppendStringLength(char *str, size_t maxStrLength, const char *value,
         strncat(str, value, n);
     }
 }
+int formatUInt32(char *str, uint32_t value) {
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    for (int i = 0; i < n; i++) {
+        str[i] = digits[n - 1 - i];
+    }
+    str[n] = 0;
+    return n;
+}
+int formatInt32(char *str, int32_t value) {
+    if (value < 0) {
+        *str = '-';
+        return 1 + formatUInt32(str + 1, 0 - (uint32_t)value);
+    }
+    return formatUInt32(str, value);
+}
+int formatUInt64(char *str, uint64_t value) {
+    if (value <= UINT32_MAX) {
+        return formatUInt32(str, (uint32_t)value);
+    }
+    // Two 64-bit divisions at most instead of one per digit
+    int n = formatUInt64(str, value / 1000000000);
+    uint32_t low = (uint32_t)(value % 1000000000);
+    for (int i = 8; i >= 0; i--) {
+        str[n + i] = '0' + low % 10;
+        low /= 10;
+    }
+    str[n + 9] = 0;
+    return n + 9;
+}
+int formatInt64(char *str, int64_t value) {
+    if (value < 0) {
+        *str = '-';
+        return 1 + formatUInt64(str + 1, 0 - (uint64_t)value);
+    }
+    return formatUInt64(str, value);
+}
+static const uint64_t g_pow10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL
+};
+// mantissa * 10^exp10 * 2^exp2 rounded half to even like printf, the double
+// is split into mantissa and exponent so the result is exact. The caller keeps
+// the result below 2^64
+static uint64_t scaleDouble(uint64_t mantissa, int exp2, int exp10) {
+    uint64_t p = g_pow10[exp10];
+    uint64_t a0 = mantissa & 0xFFFFFFFF, a1 = mantissa >> 32;
+    uint64_t b0 = p & 0xFFFFFFFF, b1 = p >> 32;
+    uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    uint64_t mid = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+    uint64_t lo = (mid << 32) | (p00 & 0xFFFFFFFF);
+    uint64_t hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    int shift = -exp2;
+    if (shift <= 0) {
+        return lo << -shift;
+    }
+    if (shift > 128) {
+        return 0;
+    }
+    uint64_t result;
+    bool half, sticky;
+    if (shift == 128) {
+        result = 0;
+        half = (hi >> 63) != 0;
+        sticky = (hi << 1) != 0 || lo != 0;
+    } else {
+        result = shift < 64 ? (lo >> shift) | (hi << (64 - shift)) : hi >> (shift - 64);
+        int bit = shift - 1;
+        if (bit < 64) {
+            half = ((lo >> bit) & 1) != 0;
+            sticky = (lo & ((1ULL << bit) - 1)) != 0;
+        } else {
+            half = ((hi >> (bit - 64)) & 1) != 0;
+            sticky = lo != 0 || (hi & ((1ULL << (bit - 64)) - 1)) != 0;
+        }
+    }
+    if (half && (sticky || (result & 1))) {
+        result++;
+    }
+    return result;
+}
+// Returns false for NaN and infinity
+static bool splitDouble(double value, bool &negative, uint64_t &mantissa, int &exp2) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    negative = (bits >> 63) != 0;
+    int exponent = (int)((bits >> 52) & 0x7FF);
+    mantissa = bits & ((1ULL << 52) - 1);
+    if (exponent == 0x7FF) {
+        return false;
+    }
+    if (exponent == 0) {
+        exp2 = -1074;
+    } else {
+        mantissa |= 1ULL << 52;
+        exp2 = exponent - 1075;
+    }
+    return true;
+}
+int formatDouble(char *str, size_t maxStrLength, double value) {
+    bool negative;
+    uint64_t mantissa;
+    int exp2;
+    char text[16];
+    int n = 0;
+    if (splitDouble(value, negative, mantissa, exp2)) {
+        if (negative) {
+            text[n++] = '-';
+        }
+        double absValue = negative ? -value : value;
+        if (mantissa == 0) {
+            text[n++] = '0';
+        } else if (absValue >= 1e-5 && absValue < 1e6) {
+            // Six significant digits, the exponent is the one of the rounded
+            // value as in printf
+            int exp10 = 5;
+            while (absValue < (double)g_pow10[exp10 + 5] / 100000.0) {
+                exp10--;
+            }
+            uint32_t digits = (uint32_t)scaleDouble(mantissa, exp2, 5 - exp10);
+            if (digits >= 1000000) {
+                digits = 100000;
+                exp10++;
+            }
+            if (exp10 < -4 || exp10 > 5) {
+                n = -1;
+            } else {
+                char d[6];
+                for (int i = 5; i >= 0; i--) {
+                    d[i] = '0' + digits % 10;
+                    digits /= 10;
+                }
+                int last = 5;
+                while (last > 0 && last > exp10 && d[last] == '0') {
+                    last--;
+                }
+                if (exp10 >= 0) {
+                    for (int i = 0; i <= exp10; i++) {
+                        text[n++] = d[i];
+                    }
+                    if (last > exp10) {
+                        text[n++] = '.';
+                        for (int i = exp10 + 1; i <= last; i++) {
+                            text[n++] = d[i];
+                        }
+                    }
+                } else {
+                    text[n++] = '0';
+                    text[n++] = '.';
+                    for (int i = exp10 + 1; i < 0; i++) {
+                        text[n++] = '0';
+                    }
+                    for (int i = 0; i <= last; i++) {
+                        text[n++] = d[i];
+                    }
+                }
+            }
+        } else {
+            n = -1;
+        }
+    } else {
+        n = -1;
+    }
+    if (n < 0) {
+        return snprintf(str, maxStrLength, "%g", value);
+    }
+    text[n] = 0;
+    if (maxStrLength > 0) {
+        stringCopy(str, maxStrLength, text);
+    }
+    return n;
+}
+int formatDoubleFixed(char *str, size_t maxStrLength, double value, int numDecimalPlaces) {
+    bool negative;
+    uint64_t mantissa;
+    int exp2;
+    if (numDecimalPlaces < 0 || numDecimalPlaces > 9 ||
+        !splitDouble(value, negative, mantissa, exp2) ||
+        (negative ? -value : value) >= 1e9) {
+        return snprintf(str, maxStrLength, "%.*f", numDecimalPlaces, value);
+    }
+    uint64_t scaled = scaleDouble(mantissa, exp2, numDecimalPlaces);
+    char text[32];
+    int n = 0;
+    if (negative) {
+        text[n++] = '-';
+    }
+    n += formatUInt64(text + n, scaled / g_pow10[numDecimalPlaces]);
+    if (numDecimalPlaces > 0) {
+        uint32_t fraction = (uint32_t)(scaled % g_pow10[numDecimalPlaces]);
+        text[n++] = '.';
+        for (int i = numDecimalPlaces - 1; i >= 0; i--) {
+            text[n + i] = '0' + fraction % 10;
+            fraction /= 10;
+        }
+        n += numDecimalPlaces;
+    }
+    text[n] = 0;
+    if (maxStrLength > 0) {
+        stringCopy(str, maxStrLength, text);
+    }
+    return n;
+}
 void stringAppendInt(char *str, size_t maxStrLength, int value) {
-    auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%d", value);
+    char text[24];
+    formatInt32(text, value);
+    stringAppendString(str, maxStrLength, text);
 }
 void stringAppendUInt32(char *str, size_t maxStrLength, uint32_t value) {
-    auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%lu", (unsigned long)value);
+    char text[24];
+    formatUInt32(text, value);
+    stringAppendString(str, maxStrLength, text);
 }
 void stringAppendInt64(char *str, size_t maxStrLength, int64_t value) {
-    auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%jd", value);
+    char text[24];
+    formatInt64(text, value);
+    stringAppendString(str, maxStrLength, text);
 }
 void stringAppendUInt64(char *str, size_t maxStrLength, uint64_t value) {
-    auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%ju", value);
+    char text[24];
+    formatUInt64(text, value);
+    stringAppendString(str, maxStrLength, text);
 }
 void stringAppendFloat(char *str, size_t maxStrLength, float value) {
     auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%g", value);
+    formatDouble(str + n, maxStrLength - n, value);
 }
 void stringAppendFloat(char *str, size_t maxStrLength, float value, int numDecimalPlaces) {
     auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%.*f", numDecimalPlaces, value);
+    formatDoubleFixed(str + n, maxStrLength - n, value, numDecimalPlaces);
 }
 void stringAppendDouble(char *str, size_t maxStrLength, double value) {
     auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%g", value);
+    formatDouble(str + n, maxStrLength - n, value);
 }
 void stringAppendDouble(char *str, size_t maxStrLength, double value, int numDecimalPlaces) {
     auto n = strlen(str);
-    snprintf(str + n, maxStrLength - n, "%.*f", numDecimalPlaces, value);
+    formatDoubleFixed(str + n, maxStrLength - n, value, numDecimalPlaces);
 }
 void stringAppendVoltage(char *str, size_t maxStrLength, float value) {
     auto n = strlen(str);
@@ -2660,6 +3059,43 @@ bool Value::toBool(int *err) const {
     }
 	return false;
 }
+// Text of a value that is not a string as toString() makes it
+static int valueToStringText(const Value &value, char *text, int count) {
+    switch (value.type) {
+    case VALUE_TYPE_DOUBLE:
+        return formatDouble(text, count, value.doubleValue);
+    case VALUE_TYPE_FLOAT:
+        return formatDouble(text, count, value.floatValue);
+    case VALUE_TYPE_INT8:
+        return formatInt32(text, value.int8Value);
+    case VALUE_TYPE_UINT8:
+        return formatUInt32(text, value.uint8Value);
+    case VALUE_TYPE_INT16:
+        return formatInt32(text, value.int16Value);
+    case VALUE_TYPE_UINT16:
+        return formatUInt32(text, value.uint16Value);
+    case VALUE_TYPE_INT32:
+        return formatInt32(text, value.int32Value);
+    case VALUE_TYPE_UINT32:
+        return formatUInt32(text, value.uint32Value);
+    case VALUE_TYPE_INT64:
+        return formatInt64(text, value.int64Value);
+    case VALUE_TYPE_UINT64:
+        return formatUInt64(text, value.uint64Value);
+    default:
+        value.toText(text, count);
+        return strlen(text);
+    }
+}
+// String of a string value, otherwise the text toString() would make
+static const char *getStringOrText(const Value &value, char *text, int count) {
+    if (value.isString()) {
+        auto str = value.getString();
+        return str ? str : "";
+    }
+    valueToStringText(value, text, count);
+    return text;
+}
 Value Value::toString(uint32_t id) const {
 	if (isIndirectValueType()) {
 		return getValue().toString(id);
@@ -2668,87 +3104,125 @@ Value Value::toString(uint32_t id) const {
 		return *this;
 	}
     char tempStr[64];
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning(disable : 4474)
-#endif
-    if (type == VALUE_TYPE_DOUBLE) {
-        snprintf(tempStr, sizeof(tempStr), "%g", doubleValue);
-    } else if (type == VALUE_TYPE_FLOAT) {
-        snprintf(tempStr, sizeof(tempStr), "%g", floatValue);
-    } else if (type == VALUE_TYPE_INT8) {
-        snprintf(tempStr, sizeof(tempStr), "%" PRId8 "", int8Value);
-    } else if (type == VALUE_TYPE_UINT8) {
-        snprintf(tempStr, sizeof(tempStr), "%" PRIu8 "", uint8Value);
-    } else if (type == VALUE_TYPE_INT16) {
-        snprintf(tempStr, sizeof(tempStr), "%" PRId16 "", int16Value);
-    } else if (type == VALUE_TYPE_UINT16) {
-        snprintf(tempStr, sizeof(tempStr), "%" PRIu16 "", uint16Value);
-    } else if (type == VALUE_TYPE_INT32) {
-        snprintf(tempStr, sizeof(tempStr), "%" PRId32 "", int32Value);
-    } else if (type == VALUE_TYPE_UINT32) {
-        snprintf(tempStr, sizeof(tempStr), "%" PRIu32 "", uint32Value);
-    } else if (type == VALUE_TYPE_INT64) {
-#ifdef PRId64
-        snprintf(tempStr, sizeof(tempStr), "%" PRId64 "", int64Value);
-#else
-        snprintf(tempStr, sizeof(tempStr), "%" PRId32 "", (int32_t)int64Value);
-#endif
-    } else if (type == VALUE_TYPE_UINT64) {
-#ifdef PRIu64
-        snprintf(tempStr, sizeof(tempStr), "%" PRIu64 "", uint64Value);
-#else
-        snprintf(tempStr, sizeof(tempStr), "%" PRIu32 "", (uint32_t)uint64Value);
-#endif
-    } else {
-        toText(tempStr, sizeof(tempStr));
+    int len = valueToStringText(*this, tempStr, sizeof(tempStr));
+	return makePooledString(tempStr, len, id);
+}
+static StringRef *newStringRef(size_t len, uint32_t id) {
+#if EEZ_FLOW_STRING_POOL
+    // The text follows the reference in the same block
+    auto ptr = alloc(sizeof(StringRef) + len + 1, id);
+    if (ptr == nullptr) {
+        return nullptr;
     }
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif
-	return makeStringRef(tempStr, strlen(tempStr), id);
-}
-Value Value::makeStringRef(const char *str, int len, uint32_t id) {
+    auto stringRef = new (ptr) StringRef;
+    stringRef->str = (char *)(stringRef + 1);
+    stringRef->next = nullptr;
+    stringRef->hash = 0;
+#else
     auto stringRef = ObjectAllocator<StringRef>::allocate(id);
 	if (stringRef == nullptr) {
-		return Value(0, VALUE_TYPE_NULL);
-	}
-	if (len == -1) {
-		len = strlen(str);
+		return nullptr;
 	}
     stringRef->str = (char *)alloc(len + 1, id + 1);
     if (stringRef->str == nullptr) {
         ObjectAllocator<StringRef>::deallocate(stringRef);
-        return Value(0, VALUE_TYPE_NULL);
+        return nullptr;
     }
-    stringCopyLength(stringRef->str, len + 1, str, len);
-	stringRef->str[len] = 0;
+#endif
     stringRef->refCounter = 1;
+    return stringRef;
+}
+static Value makeStringRefValue(StringRef *stringRef) {
     Value value;
     value.type = VALUE_TYPE_STRING_REF;
     value.options = VALUE_OPTIONS_REF;
     value.refValue = stringRef;
 	return value;
 }
-Value Value::concatenateString(const Value &str1, const Value &str2) {
-    auto stringRef = ObjectAllocator<StringRef>::allocate(0xbab14c6a);;
-	if (stringRef == nullptr) {
-		return Value(0, VALUE_TYPE_NULL);
+#if EEZ_FLOW_STRING_POOL
+static StringRef *g_stringPool[EEZ_FLOW_STRING_POOL_SIZE];
+static uint32_t hashString(const char *str, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)str[i]) * 16777619u;
+    }
+    return hash | 1;
+}
+void removeFromStringPool(StringRef *stringRef) {
+    auto p = &g_stringPool[stringRef->hash & (EEZ_FLOW_STRING_POOL_SIZE - 1)];
+    while (*p) {
+        if (*p == stringRef) {
+            *p = stringRef->next;
+            break;
+        }
+        p = &(*p)->next;
+    }
+}
+#endif
+Value Value::makeStringRef(const char *str, int len, uint32_t id) {
+	if (len == -1) {
+		len = strlen(str);
 	}
-    auto newStrLen = strlen(str1.getString()) + strlen(str2.getString()) + 1;
-    stringRef->str = (char *)alloc(newStrLen, 0xb5320162);
-    if (stringRef->str == nullptr) {
-        ObjectAllocator<StringRef>::deallocate(stringRef);
+    auto stringRef = newStringRef(len, id);
+    if (stringRef == nullptr) {
         return Value(0, VALUE_TYPE_NULL);
     }
-    stringCopy(stringRef->str, newStrLen, str1.getString());
-    stringAppendString(stringRef->str, newStrLen, str2.getString());
-    stringRef->refCounter = 1;
-    Value value;
-    value.type = VALUE_TYPE_STRING_REF;
-    value.options = VALUE_OPTIONS_REF;
-    value.refValue = stringRef;
-	return value;
+    stringCopyLength(stringRef->str, len + 1, str, len);
+	stringRef->str[len] = 0;
+    return makeStringRefValue(stringRef);
+}
+Value Value::makePooledString(const char *str, int len, uint32_t id) {
+#if EEZ_FLOW_STRING_POOL
+	if (len == -1) {
+		len = strlen(str);
+	}
+    if (len > EEZ_FLOW_STRING_POOL_MAX_LEN) {
+        return makeStringRef(str, len, id);
+    }
+    uint32_t hash = hashString(str, len);
+    auto bucket = &g_stringPool[hash & (EEZ_FLOW_STRING_POOL_SIZE - 1)];
+    for (auto stringRef = *bucket; stringRef; stringRef = stringRef->next) {
+        if (stringRef->hash == hash && strncmp(stringRef->str, str, len) == 0 && stringRef->str[len] == 0) {
+            stringRef->refCounter++;
+            return makeStringRefValue(stringRef);
+        }
+    }
+    auto stringRef = newStringRef(len, id);
+    if (stringRef == nullptr) {
+        return Value(0, VALUE_TYPE_NULL);
+    }
+    memcpy(stringRef->str, str, len);
+    stringRef->str[len] = 0;
+    stringRef->hash = hash;
+    stringRef->next = *bucket;
+    *bucket = stringRef;
+    return makeStringRefValue(stringRef);
+#else
+    return makeStringRef(str, len, id);
+#endif
+}
+Value Value::concatenateString(const Value &str1, const Value &str2) {
+    return concatenateString(str1.getString(), str2.getString());
+}
+Value Value::concatenateString(const char *str1, const char *str2) {
+    size_t len1 = strlen(str1);
+    size_t len2 = strlen(str2);
+#if EEZ_FLOW_STRING_POOL
+    if (len1 + len2 <= EEZ_FLOW_STRING_POOL_MAX_LEN) {
+        char text[EEZ_FLOW_STRING_POOL_MAX_LEN + 1];
+        memcpy(text, str1, len1);
+        memcpy(text + len1, str2, len2);
+        return makePooledString(text, len1 + len2, 0xbab14c6a);
+    }
+#endif
+    auto stringRef = newStringRef(len1 + len2, 0xbab14c6a);
+    if (stringRef == nullptr) {
+        return Value(0, VALUE_TYPE_NULL);
+    }
+    memcpy(stringRef->str, str1, len1);
+    memcpy(stringRef->str + len1, str2, len2);
+    stringRef->str[len1 + len2] = 0;
+    return makeStringRefValue(stringRef);
 }
 Value Value::makeArrayRef(int arraySize, int arrayType, uint32_t id) {
     auto ptr = alloc(sizeof(ArrayValueRef) + (arraySize > 0 ? arraySize - 1 : 0) * sizeof(Value), id);
@@ -2947,6 +3421,7 @@ void setVar(int16_t id, const Value& value) {
         auto set = (void (*)(const char *))native_var.set;
         set(value.getString());
     }
+    flow::watchListOnNativeChanged();
 }
 #endif 
 #endif 
@@ -3205,6 +3680,12 @@ void executeCallAction(FlowState *flowState, unsigned componentIndex, int flowIn
 		return;
 	}
 	FlowState *actionFlowState = initActionFlowState(flowIndex, flowState, componentIndex, inputValue);
+    if (!actionFlowState) {
+        if ((int)componentIndex != -1) {
+            throwError(flowState, componentIndex, "Action flow not loaded\n");
+        }
+        return;
+    }
     if ((int)componentIndex != -1) {
         auto component = flowState->flow->components[componentIndex];
         for (uint32_t i = 0; i < actionFlowState->flow->userPropertiesAssignable.count; i++) {
@@ -3355,15 +3836,15 @@ void executeDelayComponent(FlowState *flowState, unsigned componentIndex) {
 			throwError(flowState, componentIndex, FlowError::PropertyInvalid("Delay", "Milliseconds"));
 			return;
 		}
-		if (!addToQueue(flowState, componentIndex, -1, -1, -1, true)) {
+		if (!addTimerToQueue(flowState, componentIndex, delayComponentExecutionState->waitUntil)) {
 			return;
 		}
 	} else {
-		if (millis() >= delayComponentExecutionState->waitUntil) {
+		if ((int32_t)(millis() - delayComponentExecutionState->waitUntil) >= 0) {
 			deallocateComponentExecutionState(flowState, componentIndex);
 			propagateValueThroughSeqout(flowState, componentIndex);
 		} else {
-			if (!addToQueue(flowState, componentIndex, -1, -1, -1, true)) {
+			if (!addTimerToQueue(flowState, componentIndex, delayComponentExecutionState->waitUntil)) {
 				return;
 			}
 		}
@@ -3450,7 +3931,7 @@ bool getCallActionValue(FlowState *flowState, unsigned componentIndex, Value &va
     }
     auto &parentComponentInputs = callActionComponent->inputs;
     auto parentFlowInputIndex = parentComponentInputs[callActionComponentInputIndex];
-    auto parentFlow = flowState->flowDefinition->flows[flowState->parentFlowState->flowIndex];
+    auto parentFlow = getFlow(flowState->flowDefinition, flowState->parentFlowState->flowIndex);
     if (parentFlowInputIndex >= parentFlow->componentInputs.count) {
         throwError(flowState, componentIndex, FlowError::Plain("Invalid input index of parent component in Input"));
         return false;
@@ -5947,9 +6428,11 @@ void processDebuggerInput(char *buffer, uint32_t length) {
 				auto componentIndex = (uint32_t)strtol(p + 1, nullptr, 10);
 				auto assets = g_firstFlowState->assets;
 				auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
-				if (flowIndex >= 0 && flowIndex < flowDefinition->flows.count) {
-					auto flow = flowDefinition->flows[flowIndex];
-					if (componentIndex >= 0 && componentIndex < flow->components.count) {
+				if (g_mainAssetsUncompressed && assets == g_mainAssets) {
+					ErrorTrace("Breakpoints need the assets in RAM\n");
+				} else if (flowIndex >= 0 && flowIndex < flowDefinition->flows.count) {
+					auto flow = getFlow(flowDefinition, flowIndex);
+					if (flow && componentIndex >= 0 && componentIndex < flow->components.count) {
 						auto component = flow->components[componentIndex];
 						component->breakpoint = messageFromDebugger == MESSAGE_FROM_DEBUGGER_ADD_BREAKPOINT ||
 							messageFromDebugger == MESSAGE_FROM_DEBUGGER_ENABLE_BREAKPOINT ? 1 : 0;
@@ -6538,7 +7021,54 @@ using namespace eez::gui;
 namespace eez {
 namespace flow {
 EvalStack g_stack;
+void evalArrayElement() {
+	auto elementIndexValue = g_stack.pop().getValue();
+	auto arrayValue = g_stack.pop().getValue();
+    if (arrayValue.getType() == VALUE_TYPE_UNDEFINED || arrayValue.getType() == VALUE_TYPE_NULL) {
+        g_stack.push(Value(0, VALUE_TYPE_UNDEFINED));
+    } else {
+        if (arrayValue.isArray()) {
+            auto array = arrayValue.getArray();
+            int err;
+            auto elementIndex = elementIndexValue.toInt32(&err);
+            if (!err) {
+                if (elementIndex >= 0 && elementIndex < (int)array->arraySize) {
+                    g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
+                } else {
+                    g_stack.push(Value::makeError());
+                    g_stack.setErrorMessage("Array element index out of bounds\n");
+                }
+            } else {
+                g_stack.push(Value::makeError());
+                g_stack.setErrorMessage("Integer value expected for array element index\n");
+            }
+        } else if (arrayValue.isBlob()) {
+            auto blobRef = arrayValue.getBlob();
+            int err;
+            auto elementIndex = elementIndexValue.toInt32(&err);
+            if (!err) {
+                if (elementIndex >= 0 && elementIndex < (int)blobRef->len) {
+                    g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
+                } else {
+                    g_stack.push(Value::makeError());
+                    g_stack.setErrorMessage("Blob element index out of bounds\n");
+                }
+            } else {
+                g_stack.push(Value::makeError());
+                g_stack.setErrorMessage("Integer value expected for blob element index\n");
+            }
+        } else {
+            g_stack.push(Value::makeError());
+            g_stack.setErrorMessage("Array value expected\n");
+        }
+    }
+}
 static void evalExpression(FlowState *flowState, const uint8_t *instructions, int *numInstructionBytes) {
+#if EEZ_FLOW_THREADED_EVAL
+    if (evalThreadedExpression(flowState, instructions, numInstructionBytes)) {
+        return;
+    }
+#endif
 	auto flowDefinition = flowState->flowDefinition;
 	auto flow = flowState->flow;
 	int i = 0;
@@ -6565,46 +7095,7 @@ static void evalExpression(FlowState *flowState, const uint8_t *instructions, in
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_OUTPUT) {
 			g_stack.push(Value((uint16_t)instructionArg, VALUE_TYPE_FLOW_OUTPUT));
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_ARRAY_ELEMENT) {
-			auto elementIndexValue = g_stack.pop().getValue();
-			auto arrayValue = g_stack.pop().getValue();
-            if (arrayValue.getType() == VALUE_TYPE_UNDEFINED || arrayValue.getType() == VALUE_TYPE_NULL) {
-                g_stack.push(Value(0, VALUE_TYPE_UNDEFINED));
-            } else {
-                if (arrayValue.isArray()) {
-                    auto array = arrayValue.getArray();
-                    int err;
-                    auto elementIndex = elementIndexValue.toInt32(&err);
-                    if (!err) {
-                        if (elementIndex >= 0 && elementIndex < (int)array->arraySize) {
-                            g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
-                        } else {
-                            g_stack.push(Value::makeError());
-                            g_stack.setErrorMessage("Array element index out of bounds\n");
-                        }
-                    } else {
-                        g_stack.push(Value::makeError());
-                        g_stack.setErrorMessage("Integer value expected for array element index\n");
-                    }
-                } else if (arrayValue.isBlob()) {
-                    auto blobRef = arrayValue.getBlob();
-                    int err;
-                    auto elementIndex = elementIndexValue.toInt32(&err);
-                    if (!err) {
-                        if (elementIndex >= 0 && elementIndex < (int)blobRef->len) {
-                            g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
-                        } else {
-                            g_stack.push(Value::makeError());
-                            g_stack.setErrorMessage("Blob element index out of bounds\n");
-                        }
-                    } else {
-                        g_stack.push(Value::makeError());
-                        g_stack.setErrorMessage("Integer value expected for blob element index\n");
-                    }
-                } else {
-                    g_stack.push(Value::makeError());
-                    g_stack.setErrorMessage("Array value expected\n");
-                }
-            }
+			evalArrayElement();
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_OPERATION) {
 			g_evalOperations[instructionArg](g_stack);
 		} else {
@@ -6830,6 +7321,9 @@ unsigned start(Assets *assets) {
     g_isStopped = false;
     g_isStopping = false;
     initGlobalVariables(assets);
+#if EEZ_FLOW_THREADED_EVAL
+    initThreadedExpressions(assets);
+#endif
 	queueReset();
     watchListReset();
 	scpiComponentInitHook();
@@ -6843,33 +7337,38 @@ void tick() {
     if (g_isStopping) {
         doStop();
         return;
+    }
+    if (g_debuggerIsConnected && isDebuggerBusyHook()) {
+        finishToDebuggerMessageHook();
+        return;
     }
 	uint32_t startTickCount = millis();
-    auto queueSizeAtTickStart = getQueueSize();
-    for (size_t i = 0; i < queueSizeAtTickStart || g_numNonContinuousTaskInQueue > 0; i++) {
+    propagatePostedValues();
+    // Event tasks first, including the ones added during this tick, then
+    // expired timers, then every continuous task once
+    size_t numContinuousTasks = getQueueSize(EEZ_FLOW_LANE_CONTINUOUS);
+    bool eventsPaused = false;
+    while (true) {
 		FlowState *flowState;
 		unsigned componentIndex;
-        bool continuousTask;
-		if (!peekNextTaskFromQueue(flowState, componentIndex, continuousTask)) {
-			break;
-		}
-		if (!continuousTask && !canExecuteStep(flowState, componentIndex)) {
-			break;
-		}
-		removeNextTaskFromQueue();
+        if (!eventsPaused && peekNextTaskFromQueue(EEZ_FLOW_LANE_EVENT, flowState, componentIndex)) {
+            if (!canExecuteStep(flowState, componentIndex)) {
+                eventsPaused = true;
+                continue;
+            }
+            removeNextTaskFromQueue(EEZ_FLOW_LANE_EVENT);
+        } else if (takeExpiredTimer(flowState, componentIndex)) {
+        } else if (numContinuousTasks > 0 && peekNextTaskFromQueue(EEZ_FLOW_LANE_CONTINUOUS, flowState, componentIndex)) {
+            removeNextTaskFromQueue(EEZ_FLOW_LANE_CONTINUOUS);
+            numContinuousTasks--;
+        } else {
+            break;
+        }
         flowState->executingComponentIndex = componentIndex;
         if (flowState->error) {
             deallocateComponentExecutionState(flowState, componentIndex);
         } else {
-            if (continuousTask) {
-                if (i < queueSizeAtTickStart) {
-                    executeComponent(flowState, componentIndex);
-                } else {
-                    addToQueue(flowState, componentIndex, -1, -1, -1, true);
-                }
-            } else {
-                executeComponent(flowState, componentIndex);
-            }
+            executeComponent(flowState, componentIndex);
         }
         if (isFlowStopped() || g_isStopping) {
             break;
@@ -6878,10 +7377,11 @@ void tick() {
         if (canFreeFlowState(flowState)) {
             freeFlowState(flowState);
         }
-        if ((i + 1) % 5 == 0) {
-            if (millis() - startTickCount >= FLOW_TICK_MAX_DURATION_MS) {
-                break;
-            }
+        if (millis() - startTickCount >= FLOW_TICK_MAX_DURATION_MS) {
+            break;
+        }
+        if (g_debuggerIsConnected && isDebuggerBusyHook()) {
+            break;
         }
 	}
     visitWatchList();
@@ -6978,6 +7478,7 @@ void setGlobalVariable(Assets *assets, uint32_t globalVariableIndex, const Value
         } else {
             *assets->flowDefinition->globalVariables[globalVariableIndex] = value;
         }
+        watchListOnGlobalChanged(globalVariableIndex);
     }
 }
 Value getUserProperty(unsigned propertyIndex) {
@@ -7237,6 +7738,9 @@ static void finishToDebuggerMessage() {
 }
 static void onDebuggerInputAvailable() {
 }
+static bool isDebuggerBusy() {
+    return false;
+}
 void (*replacePageHook)(int16_t pageId, uint32_t animType, uint32_t speed, uint32_t delay) = replacePage;
 void (*showKeyboardHook)(Value label, Value initialText, Value minChars, Value maxChars, bool isPassword, void(*onOk)(char *), void(*onCancel)()) = showKeyboard;
 void (*showKeypadHook)(Value label, Value initialValue, Value min, Value max, Unit unit, void(*onOk)(float), void(*onCancel)()) = showKeypad;
@@ -7246,6 +7750,9 @@ void (*startToDebuggerMessageHook)() = startToDebuggerMessage;
 void (*writeDebuggerBufferHook)(const char *buffer, uint32_t length) = writeDebuggerBuffer;
 void (*finishToDebuggerMessageHook)() = finishToDebuggerMessage;
 void (*onDebuggerInputAvailableHook)() = onDebuggerInputAvailable;
+// The debugger transport can not take more messages now, tick() stops
+// executing tasks so the GUI keeps running while it catches up
+bool (*isDebuggerBusyHook)() = isDebuggerBusy;
 #if defined(EEZ_FOR_LVGL)
 static lv_obj_t *getLvglObjectFromIndex(int32_t index) {
     return 0;
@@ -7430,7 +7937,13 @@ extern "C" void eez_flow_init(const uint8_t *assets, uint32_t assetsSize, lv_obj
     g_numImages = numImages;
     g_actions = actions;
     eez::initAssetsMemory();
+#if EEZ_FLOW_PACKED_ASSETS
+    (void)assets;
+    (void)assetsSize;
+    eez::loadMainAssets(eez_flow_packed_assets, eez_flow_packed_assets_size);
+#else
     eez::loadMainAssets(assets, assetsSize);
+#endif
     eez::initOtherMemory();
     eez::initAllocHeap(eez::ALLOC_BUFFER, eez::ALLOC_BUFFER_SIZE);
     eez::flow::replacePageHook = replacePageHook;
@@ -7473,11 +7986,16 @@ void eez_flow_init_style_names(const char **styleNames, size_t numStyles) {
     g_numStyles = numStyles;
 }
 extern "C" void eez_flow_tick() {
+    LV_PORT_PROF_BEGIN(LV_PORT_PROF_FLOW_TICK);
     eez::flow::tick();
+    LV_PORT_PROF_END(LV_PORT_PROF_FLOW_TICK);
 }
 extern "C" bool eez_flow_is_stopped() {
     return eez::flow::isFlowStopped();
 }
+extern "C" bool eez_flow_is_idle() {
+    return eez::flow::getQueueSize() == 0 && eez::flow::getPostedValueCount() == 0;
+}
 namespace eez {
 ActionExecFunc g_actionExecFunctions[] = { 0 };
 }
@@ -7498,6 +8016,17 @@ extern "C" void flowPropagateValueInt32(void *flowState, unsigned componentIndex
 extern "C" void flowPropagateValueUint32(void *flowState, unsigned componentIndex, unsigned outputIndex, uint32_t value) {
     eez::flow::propagateValue((eez::flow::FlowState *)flowState, componentIndex, outputIndex, eez::Value(value, eez::VALUE_TYPE_UINT32));
 }
+// Can be called from any task or interrupt, the value is propagated on the next
+// tick; the flow state must stay alive until then
+extern "C" bool flowPostValue(void *flowState, unsigned componentIndex, unsigned outputIndex) {
+    return eez::flow::postValue((eez::flow::FlowState *)flowState, componentIndex, outputIndex, eez::VALUE_TYPE_UNDEFINED, 0);
+}
+extern "C" bool flowPostValueInt32(void *flowState, unsigned componentIndex, unsigned outputIndex, int32_t value) {
+    return eez::flow::postValue((eez::flow::FlowState *)flowState, componentIndex, outputIndex, eez::VALUE_TYPE_INT32, (uint32_t)value);
+}
+extern "C" bool flowPostValueUint32(void *flowState, unsigned componentIndex, unsigned outputIndex, uint32_t value) {
+    return eez::flow::postValue((eez::flow::FlowState *)flowState, componentIndex, outputIndex, eez::VALUE_TYPE_UINT32, value);
+}
 extern "C" void flowPropagateValueLVGLEvent(void *flowState, unsigned componentIndex, unsigned outputIndex, lv_event_t *event) {
     if (eez::flow::hasAnyDataConnection((eez::flow::FlowState *)flowState, componentIndex, outputIndex)) {
         lv_event_code_t event_code = lv_event_get_code(event);
@@ -7727,12 +8256,10 @@ Value op_add(const Value& a1, const Value& b1) {
         return Value::makeError();
     }
     if (a.isString() || b.isString()) {
-        Value value1 = a.toString(0x84eafaa8);
-        Value value2 = b.toString(0xd273cab6);
-        auto res = Value::concatenateString(value1, value2);
-        char str1[128];
-        res.toText(str1, sizeof(str1));
-        return res;
+        // Numbers are formatted on the stack, only the result is allocated
+        char text1[64];
+        char text2[64];
+        return Value::concatenateString(getStringOrText(a, text1, sizeof(text1)), getStringOrText(b, text2, sizeof(text2)));
     }
     if (a.isDouble() || b.isDouble()) {
         return Value(a.toDouble() + b.toDouble(), VALUE_TYPE_DOUBLE);
@@ -8578,7 +9105,7 @@ void do_OPERATION_TYPE_DATE_TO_STRING(EvalStack &stack) {
     }
     char str[128];
     date::toString(a.getDouble(), str, sizeof(str));
-    stack.push(Value::makeStringRef(str, -1, 0xbe440ec8));
+    stack.push(Value::makePooledString(str, -1, 0xbe440ec8));
 #else
     stack.push(Value::makeError());
 #endif
@@ -8596,7 +9123,7 @@ void do_OPERATION_TYPE_DATE_TO_LOCALE_STRING(EvalStack &stack) {
     }
     char str[128];
     date::toLocaleString(a.getDouble(), str, sizeof(str));
-    stack.push(Value::makeStringRef(str, -1, 0xbe440ec8));
+    stack.push(Value::makePooledString(str, -1, 0xbe440ec8));
 #else
     stack.push(Value::makeError());
 #endif
@@ -9129,7 +9656,7 @@ void do_OPERATION_TYPE_STRING_SUBSTRING(EvalStack &stack) {
         end = strLen;
     }
     if (start < end) {
-        Value resultValue = Value::makeStringRef(str + start, end - start, 0x203b08a2);
+        Value resultValue = Value::makePooledString(str + start, end - start, 0x203b08a2);
         stack.push(resultValue);
         return;
     }
@@ -9297,7 +9824,13 @@ void do_OPERATION_TYPE_STRING_FORMAT(EvalStack &stack) {
         stack.push(Value::makeError());
         return;
     }
-    int resultStrLen = do_string_format(type, b, NULL, 0, format);
+    // Short results are formatted once on the stack
+    char text[EEZ_FLOW_STRING_POOL_MAX_LEN + 1];
+    int resultStrLen = do_string_format(type, b, text, sizeof(text), format);
+    if (resultStrLen >= 0 && resultStrLen < (int)sizeof(text)) {
+        stack.push(Value::makePooledString(text, resultStrLen, 0x1e1227fd));
+        return;
+    }
     char *resultStr = (char *)eez::alloc(resultStrLen + 1, 0x987ee4eb);
     do_string_format(type, b, resultStr, resultStrLen + 1, format);
     stack.push(Value::makeStringRef(resultStr, -1, 0x1e1227fd));
@@ -9996,6 +10529,727 @@ EvalOperation g_evalOperations[] = {
 } 
 } 
 // -----------------------------------------------------------------------------
+// flow/expression_threaded.cpp
+// -----------------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#if EEZ_FLOW_THREADED_EVAL
+namespace eez {
+namespace flow {
+// Labels as values (GCC, Clang and Arm Compiler 6), otherwise a switch
+#if defined(__GNUC__) || defined(__clang__)
+#define THREADED_GOTO 1
+#else
+#define THREADED_GOTO 0
+#endif
+// Longer expressions are left to the bytecode decoder
+#define THREADED_MAX_CODE 64
+// Room for expressions outside the component properties (Compare condition,
+// SetVariable entries, Switch tests...), translated on first evaluation
+#define THREADED_LAZY_NUM 64
+enum ThreadedOpcode {
+    THREADED_PUSH_CONSTANT,          // arg: constant index
+    THREADED_PUSH_FOLDED,            // arg: folded constant index
+    THREADED_PUSH_INPUT,             // arg: input index
+    THREADED_PUSH_LOCAL_VAR,         // arg: local variable index
+    THREADED_PUSH_GLOBAL_VAR,        // arg: global variable index
+    THREADED_PUSH_NATIVE_VAR,        // arg: native variable id
+    THREADED_PUSH_OUTPUT,            // arg: output index
+    THREADED_ARRAY_ELEMENT,
+    THREADED_OPERATION,              // arg: operation index
+    THREADED_BINARY,                 // arg: ThreadedBinary
+    THREADED_GLOBAL_CONST_BINARY,    // arg: global variable index, arg2: constant index | ThreadedBinary << 13
+    THREADED_INPUT_CONST_BINARY,     // arg: input index, arg2: as above
+    THREADED_LOCAL_CONST_BINARY,     // arg: local variable index, arg2: as above
+    THREADED_END,
+    THREADED_END_WITH_DST_VALUE_TYPE,
+    THREADED_NUM_OPCODES
+};
+// Operations with int32/float fast paths, the first 8 can be fused with a
+// variable and a constant operand
+enum ThreadedBinary {
+    THREADED_BINARY_ADD,
+    THREADED_BINARY_SUB,
+    THREADED_BINARY_EQUAL,
+    THREADED_BINARY_NOT_EQUAL,
+    THREADED_BINARY_LESS,
+    THREADED_BINARY_GREATER,
+    THREADED_BINARY_LESS_OR_EQUAL,
+    THREADED_BINARY_GREATER_OR_EQUAL,
+    THREADED_BINARY_MUL,
+    THREADED_NUM_BINARY
+};
+static const uint16_t THREADED_FUSED_CONSTANT_MASK = 0x1FFF;
+static const unsigned THREADED_FUSED_BINARY_SHIFT = 13;
+static const EvalOperation g_threadedBinaryOperations[THREADED_NUM_BINARY] = {
+    do_OPERATION_TYPE_ADD,
+    do_OPERATION_TYPE_SUB,
+    do_OPERATION_TYPE_EQUAL,
+    do_OPERATION_TYPE_NOT_EQUAL,
+    do_OPERATION_TYPE_LESS,
+    do_OPERATION_TYPE_GREATER,
+    do_OPERATION_TYPE_LESS_OR_EQUAL,
+    do_OPERATION_TYPE_GREATER_OR_EQUAL,
+    do_OPERATION_TYPE_MUL,
+};
+struct FoldableOperation {
+    EvalOperation operation;
+    uint8_t numOperands;
+};
+// Operations evaluated at translation time when all operands are constants
+static const FoldableOperation g_threadedFoldableOperations[] = {
+    { do_OPERATION_TYPE_ADD, 2 },
+    { do_OPERATION_TYPE_SUB, 2 },
+    { do_OPERATION_TYPE_MUL, 2 },
+    { do_OPERATION_TYPE_DIV, 2 },
+    { do_OPERATION_TYPE_MOD, 2 },
+    { do_OPERATION_TYPE_LEFT_SHIFT, 2 },
+    { do_OPERATION_TYPE_RIGHT_SHIFT, 2 },
+    { do_OPERATION_TYPE_BINARY_AND, 2 },
+    { do_OPERATION_TYPE_BINARY_OR, 2 },
+    { do_OPERATION_TYPE_BINARY_XOR, 2 },
+    { do_OPERATION_TYPE_EQUAL, 2 },
+    { do_OPERATION_TYPE_NOT_EQUAL, 2 },
+    { do_OPERATION_TYPE_LESS, 2 },
+    { do_OPERATION_TYPE_GREATER, 2 },
+    { do_OPERATION_TYPE_LESS_OR_EQUAL, 2 },
+    { do_OPERATION_TYPE_GREATER_OR_EQUAL, 2 },
+    { do_OPERATION_TYPE_LOGICAL_AND, 2 },
+    { do_OPERATION_TYPE_LOGICAL_OR, 2 },
+    { do_OPERATION_TYPE_UNARY_PLUS, 1 },
+    { do_OPERATION_TYPE_UNARY_MINUS, 1 },
+    { do_OPERATION_TYPE_BINARY_ONE_COMPLEMENT, 1 },
+    { do_OPERATION_TYPE_NOT, 1 },
+    { do_OPERATION_TYPE_CONDITIONAL, 3 },
+};
+struct ThreadedInstruction {
+    const void *code;   // label address, or the opcode without THREADED_GOTO
+    uint16_t arg;
+    uint16_t arg2;
+};
+// Followed by numFolded values and numCode instructions. numCode is 0 if the
+// expression could not be translated.
+struct ThreadedProgram {
+    const uint8_t *instructions;
+    uint32_t dstValueType;
+    uint16_t numInstructionBytes;
+    uint8_t numCode;
+    uint8_t numFolded;
+};
+struct ThreadedCache {
+    ThreadedProgram **entries;
+    uint32_t mask;
+    uint32_t count;
+    uint32_t maxCount;
+};
+static ThreadedCache g_threadedCache;
+static const uint8_t *g_threadedArenaStart;
+static const uint8_t *g_threadedArenaEnd;
+static const void *const *g_threadedCode;
+static ThreadedInstruction g_threadedScratchCode[THREADED_MAX_CODE];
+static Value g_threadedScratchFolded[THREADED_MAX_CODE];
+static uint16_t g_threadedScratchNumCode;
+static uint16_t g_threadedScratchNumFolded;
+static inline size_t getThreadedHeaderSize() {
+    return (sizeof(ThreadedProgram) + 7) & ~7;
+}
+static inline Value *getThreadedFolded(const ThreadedProgram *program) {
+    return (Value *)((uint8_t *)program + getThreadedHeaderSize());
+}
+static inline const ThreadedInstruction *getThreadedCode(const ThreadedProgram *program) {
+    return (const ThreadedInstruction *)(getThreadedFolded(program) + program->numFolded);
+}
+static inline size_t getThreadedProgramSize(size_t numCode, size_t numFolded) {
+    return getThreadedHeaderSize() + numFolded * sizeof(Value) + numCode * sizeof(ThreadedInstruction);
+}
+static inline uint32_t hashThreadedKey(const uint8_t *instructions) {
+    return (uint32_t)(((uintptr_t)instructions >> 1) * 2654435761U);
+}
+static ThreadedProgram *findThreadedProgram(const uint8_t *instructions) {
+    if (!g_threadedCache.entries) {
+        return nullptr;
+    }
+    for (uint32_t i = hashThreadedKey(instructions) & g_threadedCache.mask; ; i = (i + 1) & g_threadedCache.mask) {
+        auto program = g_threadedCache.entries[i];
+        if (!program || program->instructions == instructions) {
+            return program;
+        }
+    }
+}
+static void insertThreadedProgram(ThreadedProgram *program) {
+    uint32_t i;
+    for (i = hashThreadedKey(program->instructions) & g_threadedCache.mask; g_threadedCache.entries[i]; i = (i + 1) & g_threadedCache.mask) {
+    }
+    g_threadedCache.entries[i] = program;
+    g_threadedCache.count++;
+}
+// Backward shift deletion keeps the probe sequences of the other entries intact
+static void removeThreadedEntry(uint32_t i) {
+    auto mask = g_threadedCache.mask;
+    g_threadedCache.entries[i] = nullptr;
+    g_threadedCache.count--;
+    for (uint32_t j = (i + 1) & mask; g_threadedCache.entries[j]; j = (j + 1) & mask) {
+        uint32_t home = hashThreadedKey(g_threadedCache.entries[j]->instructions) & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            g_threadedCache.entries[i] = g_threadedCache.entries[j];
+            g_threadedCache.entries[j] = nullptr;
+            i = j;
+        }
+    }
+}
+static bool growThreadedCache() {
+    auto oldEntries = g_threadedCache.entries;
+    auto oldCapacity = g_threadedCache.mask + 1;
+    auto capacity = oldCapacity * 2;
+    auto entries = (ThreadedProgram **)alloc(capacity * sizeof(ThreadedProgram *), 0x4e1f0a57);
+    if (!entries) {
+        return false;
+    }
+    memset(entries, 0, capacity * sizeof(ThreadedProgram *));
+    g_threadedCache.entries = entries;
+    g_threadedCache.mask = capacity - 1;
+    g_threadedCache.count = 0;
+    g_threadedCache.maxCount = capacity * 3 / 4;
+    for (uint32_t i = 0; i < oldCapacity; i++) {
+        if (oldEntries[i]) {
+            insertThreadedProgram(oldEntries[i]);
+        }
+    }
+    free(oldEntries);
+    return true;
+}
+static bool isFoldableValue(const Value &value) {
+    return Value::isInt32OrLess(value.type) || value.type == VALUE_TYPE_INT64 || value.type == VALUE_TYPE_UINT64 ||
+        value.type == VALUE_TYPE_FLOAT || value.type == VALUE_TYPE_DOUBLE;
+}
+static int getFoldableNumOperands(EvalOperation operation) {
+    for (size_t i = 0; i < sizeof(g_threadedFoldableOperations) / sizeof(g_threadedFoldableOperations[0]); i++) {
+        if (g_threadedFoldableOperations[i].operation == operation) {
+            return g_threadedFoldableOperations[i].numOperands;
+        }
+    }
+    return 0;
+}
+static int getThreadedBinary(EvalOperation operation) {
+    for (int i = 0; i < THREADED_NUM_BINARY; i++) {
+        if (g_threadedBinaryOperations[i] == operation) {
+            return i;
+        }
+    }
+    return -1;
+}
+static const Value *getScratchConstant(FlowDefinition *flowDefinition, const ThreadedInstruction &instruction) {
+    auto opcode = (uintptr_t)instruction.code;
+    if (opcode == THREADED_PUSH_CONSTANT) {
+        return flowDefinition->constants[instruction.arg];
+    }
+    if (opcode == THREADED_PUSH_FOLDED) {
+        return &g_threadedScratchFolded[instruction.arg];
+    }
+    return nullptr;
+}
+// Evaluates the operation on the constants on top of the scratch code, the
+// result replaces them if it is a number
+static bool foldScratchOperation(FlowDefinition *flowDefinition, EvalOperation operation, int numOperands) {
+    if (g_threadedScratchNumCode < numOperands || g_stack.sp + numOperands > STACK_SIZE) {
+        return false;
+    }
+    auto first = g_threadedScratchNumCode - numOperands;
+    for (int i = 0; i < numOperands; i++) {
+        if (!getScratchConstant(flowDefinition, g_threadedScratchCode[first + i])) {
+            return false;
+        }
+    }
+    auto savedSp = g_stack.sp;
+    auto savedErrorMessage = g_stack.errorMessage;
+    for (int i = 0; i < numOperands; i++) {
+        g_stack.push(*getScratchConstant(flowDefinition, g_threadedScratchCode[first + i]));
+    }
+    operation(g_stack);
+    Value result;
+    bool folded = false;
+    if (g_stack.sp == savedSp + 1) {
+        result = g_stack.pop();
+        folded = isFoldableValue(result);
+    }
+    g_stack.sp = savedSp;
+    g_stack.errorMessage = savedErrorMessage;
+    if (!folded) {
+        return false;
+    }
+    // operands that were folded constants themselves are always the last ones
+    for (int i = 0; i < numOperands; i++) {
+        if ((uintptr_t)g_threadedScratchCode[first + i].code == THREADED_PUSH_FOLDED) {
+            g_threadedScratchNumFolded = g_threadedScratchCode[first + i].arg;
+            break;
+        }
+    }
+    g_threadedScratchFolded[g_threadedScratchNumFolded] = result;
+    g_threadedScratchCode[first].code = (const void *)THREADED_PUSH_FOLDED;
+    g_threadedScratchCode[first].arg = g_threadedScratchNumFolded++;
+    g_threadedScratchNumCode = first + 1;
+    return true;
+}
+static void emitScratch(ThreadedOpcode opcode, uint16_t arg, uint16_t arg2) {
+    auto &instruction = g_threadedScratchCode[g_threadedScratchNumCode++];
+    instruction.code = (const void *)(uintptr_t)opcode;
+    instruction.arg = arg;
+    instruction.arg2 = arg2;
+}
+static void emitScratchOperation(FlowDefinition *flowDefinition, uint16_t operationIndex) {
+    auto operation = g_evalOperations[operationIndex];
+    auto numOperands = getFoldableNumOperands(operation);
+    if (numOperands > 0 && foldScratchOperation(flowDefinition, operation, numOperands)) {
+        return;
+    }
+    auto binary = getThreadedBinary(operation);
+    if (binary < 0) {
+        emitScratch(THREADED_OPERATION, operationIndex, 0);
+        return;
+    }
+    if (binary < THREADED_BINARY_MUL && g_threadedScratchNumCode >= 2) {
+        auto &variable = g_threadedScratchCode[g_threadedScratchNumCode - 2];
+        auto &constant = g_threadedScratchCode[g_threadedScratchNumCode - 1];
+        auto variableOpcode = (uintptr_t)variable.code;
+        if ((uintptr_t)constant.code == THREADED_PUSH_CONSTANT && (
+            variableOpcode == THREADED_PUSH_GLOBAL_VAR ||
+            variableOpcode == THREADED_PUSH_INPUT ||
+            variableOpcode == THREADED_PUSH_LOCAL_VAR
+        )) {
+            variable.code = (const void *)(uintptr_t)(
+                variableOpcode == THREADED_PUSH_GLOBAL_VAR ? THREADED_GLOBAL_CONST_BINARY :
+                variableOpcode == THREADED_PUSH_INPUT ? THREADED_INPUT_CONST_BINARY :
+                THREADED_LOCAL_CONST_BINARY
+            );
+            variable.arg2 = constant.arg | (binary << THREADED_FUSED_BINARY_SHIFT);
+            g_threadedScratchNumCode--;
+            return;
+        }
+    }
+    emitScratch(THREADED_BINARY, binary, 0);
+}
+// Translates the bytecode into g_threadedScratchCode/g_threadedScratchFolded
+static bool translateExpression(FlowDefinition *flowDefinition, const uint8_t *instructions, ThreadedProgram &header) {
+    g_threadedScratchNumCode = 0;
+    g_threadedScratchNumFolded = 0;
+    header.instructions = instructions;
+    header.dstValueType = 0;
+    header.numInstructionBytes = 0;
+    for (int i = 0; ; i += 2) {
+        if (g_threadedScratchNumCode == THREADED_MAX_CODE) {
+            return false;
+        }
+		uint16_t instruction = instructions[i] + (instructions[i + 1] << 8);
+		auto instructionType = instruction & EXPR_EVAL_INSTRUCTION_TYPE_MASK;
+		auto instructionArg = instruction & EXPR_EVAL_INSTRUCTION_PARAM_MASK;
+		if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT) {
+            emitScratch(THREADED_PUSH_CONSTANT, instructionArg, 0);
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_INPUT) {
+            emitScratch(THREADED_PUSH_INPUT, instructionArg, 0);
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_LOCAL_VAR) {
+            emitScratch(THREADED_PUSH_LOCAL_VAR, instructionArg, 0);
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_GLOBAL_VAR) {
+			if ((uint32_t)instructionArg < flowDefinition->globalVariables.count) {
+                emitScratch(THREADED_PUSH_GLOBAL_VAR, instructionArg, 0);
+            } else {
+                emitScratch(THREADED_PUSH_NATIVE_VAR, instructionArg - flowDefinition->globalVariables.count + 1, 0);
+            }
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_OUTPUT) {
+            emitScratch(THREADED_PUSH_OUTPUT, instructionArg, 0);
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_ARRAY_ELEMENT) {
+            emitScratch(THREADED_ARRAY_ELEMENT, 0, 0);
+		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_OPERATION) {
+            emitScratchOperation(flowDefinition, instructionArg);
+        } else if (instruction == EXPR_EVAL_INSTRUCTION_TYPE_END_WITH_DST_VALUE_TYPE) {
+            header.dstValueType = instructions[i + 2] + (instructions[i + 3] << 8) + (instructions[i + 4] << 16) + (instructions[i + 5] << 24);
+            header.numInstructionBytes = i + 6;
+            emitScratch(THREADED_END_WITH_DST_VALUE_TYPE, 0, 0);
+            return true;
+        } else {
+            header.numInstructionBytes = i + 2;
+            emitScratch(THREADED_END, 0, 0);
+            return true;
+        }
+    }
+}
+// Copies the scratch translation into memory, with label addresses
+static void storeThreadedProgram(ThreadedProgram *program, const ThreadedProgram &header) {
+    *program = header;
+    program->numCode = (uint8_t)g_threadedScratchNumCode;
+    program->numFolded = (uint8_t)g_threadedScratchNumFolded;
+    auto folded = getThreadedFolded(program);
+    for (int i = 0; i < g_threadedScratchNumFolded; i++) {
+        new (folded + i) Value();
+        folded[i] = g_threadedScratchFolded[i];
+    }
+    auto code = (ThreadedInstruction *)getThreadedCode(program);
+    for (int i = 0; i < g_threadedScratchNumCode; i++) {
+        code[i] = g_threadedScratchCode[i];
+#if THREADED_GOTO
+        code[i].code = g_threadedCode[(uintptr_t)code[i].code];
+#endif
+    }
+}
+static inline bool evalBinaryFast(unsigned binary, const Value &a, const Value &b, Value &result) {
+    if (a.type == VALUE_TYPE_INT32 && b.type == VALUE_TYPE_INT32) {
+        int32_t x = a.int32Value;
+        int32_t y = b.int32Value;
+        switch (binary) {
+        case THREADED_BINARY_ADD: result = Value((int)((uint32_t)x + (uint32_t)y), VALUE_TYPE_INT32); return true;
+        case THREADED_BINARY_SUB: result = Value((int)((uint32_t)x - (uint32_t)y), VALUE_TYPE_INT32); return true;
+        case THREADED_BINARY_MUL: result = Value((int)((uint32_t)x * (uint32_t)y), VALUE_TYPE_INT32); return true;
+        case THREADED_BINARY_EQUAL: result = Value(x == y, VALUE_TYPE_BOOLEAN); return true;
+        case THREADED_BINARY_NOT_EQUAL: result = Value(x != y, VALUE_TYPE_BOOLEAN); return true;
+        case THREADED_BINARY_LESS: result = Value(x < y, VALUE_TYPE_BOOLEAN); return true;
+        case THREADED_BINARY_GREATER: result = Value(x > y, VALUE_TYPE_BOOLEAN); return true;
+        case THREADED_BINARY_LESS_OR_EQUAL: result = Value(x <= y, VALUE_TYPE_BOOLEAN); return true;
+        case THREADED_BINARY_GREATER_OR_EQUAL: result = Value(x >= y, VALUE_TYPE_BOOLEAN); return true;
+        }
+    } else if (a.type == VALUE_TYPE_FLOAT && b.type == VALUE_TYPE_FLOAT) {
+        float x = a.floatValue;
+        float y = b.floatValue;
+        // same results as is_less/is_equal, also for NaN
+        switch (binary) {
+        case THREADED_BINARY_ADD: result = Value(x + y, VALUE_TYPE_FLOAT); return true;
+        case THREADED_BINARY_SUB: result = Value(x - y, VALUE_TYPE_FLOAT); return true;
+        case THREADED_BINARY_MUL: result = Value(x * y, VALUE_TYPE_FLOAT); return true;
+        case THREADED_BINARY_EQUAL: result = Value(x == y, VALUE_TYPE_BOOLEAN); return true;
+        case THREADED_BINARY_NOT_EQUAL: result = Value(!(x == y), VALUE_TYPE_BOOLEAN); return true;
+        case THREADED_BINARY_LESS: result = Value(x < y, VALUE_TYPE_BOOLEAN); return true;
+        case THREADED_BINARY_GREATER: result = Value(!(x < y) && !(x == y), VALUE_TYPE_BOOLEAN); return true;
+        case THREADED_BINARY_LESS_OR_EQUAL: result = Value(x < y || x == y, VALUE_TYPE_BOOLEAN); return true;
+        case THREADED_BINARY_GREATER_OR_EQUAL: result = Value(!(x < y), VALUE_TYPE_BOOLEAN); return true;
+        }
+    }
+    return false;
+}
+// Variable and constant operands of a fused instruction. The fallback pushes
+// them as the bytecode would have done.
+static inline void evalConstBinary(const Value &a, const Value &aPushed, const Value &b, unsigned binary) {
+    if (g_stack.sp + 2 <= STACK_SIZE && evalBinaryFast(binary, a, b, g_stack.stack[g_stack.sp])) {
+        g_stack.sp++;
+        return;
+    }
+    g_stack.push(aPushed);
+    g_stack.push(b);
+    g_threadedBinaryOperations[binary](g_stack);
+}
+static inline const Value &derefValuePtr(const Value &value) {
+    return value.type == VALUE_TYPE_VALUE_PTR ? *value.pValueValue : value;
+}
+// Called with nullptr program once to publish the label addresses
+static void runThreadedProgram(FlowState *flowState, const ThreadedProgram *program) {
+#if THREADED_GOTO
+    static const void *const labels[THREADED_NUM_OPCODES] = {
+        &&L_PUSH_CONSTANT,
+        &&L_PUSH_FOLDED,
+        &&L_PUSH_INPUT,
+        &&L_PUSH_LOCAL_VAR,
+        &&L_PUSH_GLOBAL_VAR,
+        &&L_PUSH_NATIVE_VAR,
+        &&L_PUSH_OUTPUT,
+        &&L_ARRAY_ELEMENT,
+        &&L_OPERATION,
+        &&L_BINARY,
+        &&L_GLOBAL_CONST_BINARY,
+        &&L_INPUT_CONST_BINARY,
+        &&L_LOCAL_CONST_BINARY,
+        &&L_END,
+        &&L_END_WITH_DST_VALUE_TYPE,
+    };
+    if (!program) {
+        g_threadedCode = labels;
+        return;
+    }
+#define THREADED_CASE(NAME) L_##NAME:
+#define THREADED_NEXT() goto *(++ip)->code
+#else
+    if (!program) {
+        return;
+    }
+#define THREADED_CASE(NAME) case THREADED_##NAME:
+#define THREADED_NEXT() continue
+#endif
+	auto flowDefinition = flowState->flowDefinition;
+	auto flow = flowState->flow;
+    auto folded = getThreadedFolded(program);
+    auto ip = getThreadedCode(program);
+#if THREADED_GOTO
+    goto *ip->code;
+#else
+    for (;; ++ip) switch ((uintptr_t)ip->code) {
+#endif
+    THREADED_CASE(PUSH_CONSTANT) {
+        g_stack.push(*flowDefinition->constants[ip->arg]);
+        THREADED_NEXT();
+    }
+    THREADED_CASE(PUSH_FOLDED) {
+        g_stack.push(folded[ip->arg]);
+        THREADED_NEXT();
+    }
+    THREADED_CASE(PUSH_INPUT) {
+        g_stack.push(flowState->values[ip->arg]);
+        THREADED_NEXT();
+    }
+    THREADED_CASE(PUSH_LOCAL_VAR) {
+        g_stack.push(&flowState->values[flow->componentInputs.count + ip->arg]);
+        THREADED_NEXT();
+    }
+    THREADED_CASE(PUSH_GLOBAL_VAR) {
+        if (g_globalVariables) {
+            g_stack.push(g_globalVariables->values + ip->arg);
+        } else {
+            g_stack.push(flowDefinition->globalVariables[ip->arg]);
+        }
+        THREADED_NEXT();
+    }
+    THREADED_CASE(PUSH_NATIVE_VAR) {
+        g_stack.push(Value((int)ip->arg, VALUE_TYPE_NATIVE_VARIABLE));
+        THREADED_NEXT();
+    }
+    THREADED_CASE(PUSH_OUTPUT) {
+        g_stack.push(Value((uint16_t)ip->arg, VALUE_TYPE_FLOW_OUTPUT));
+        THREADED_NEXT();
+    }
+    THREADED_CASE(ARRAY_ELEMENT) {
+        evalArrayElement();
+        THREADED_NEXT();
+    }
+    THREADED_CASE(OPERATION) {
+        g_evalOperations[ip->arg](g_stack);
+        THREADED_NEXT();
+    }
+    THREADED_CASE(BINARY) {
+        auto sp = g_stack.sp;
+        Value result;
+        if (sp >= 2 && evalBinaryFast(ip->arg, derefValuePtr(g_stack.stack[sp - 2]), derefValuePtr(g_stack.stack[sp - 1]), result)) {
+            g_stack.stack[sp - 2] = result;
+            g_stack.sp = sp - 1;
+        } else {
+            g_threadedBinaryOperations[ip->arg](g_stack);
+        }
+        THREADED_NEXT();
+    }
+    THREADED_CASE(GLOBAL_CONST_BINARY) {
+        Value *pValue = g_globalVariables ? g_globalVariables->values + ip->arg : flowDefinition->globalVariables[ip->arg];
+        evalConstBinary(*pValue, Value(pValue, VALUE_TYPE_VALUE_PTR),
+            *flowDefinition->constants[ip->arg2 & THREADED_FUSED_CONSTANT_MASK], ip->arg2 >> THREADED_FUSED_BINARY_SHIFT);
+        THREADED_NEXT();
+    }
+    THREADED_CASE(INPUT_CONST_BINARY) {
+        const Value &value = flowState->values[ip->arg];
+        evalConstBinary(value, value,
+            *flowDefinition->constants[ip->arg2 & THREADED_FUSED_CONSTANT_MASK], ip->arg2 >> THREADED_FUSED_BINARY_SHIFT);
+        THREADED_NEXT();
+    }
+    THREADED_CASE(LOCAL_CONST_BINARY) {
+        Value *pValue = &flowState->values[flow->componentInputs.count + ip->arg];
+        evalConstBinary(*pValue, Value(pValue, VALUE_TYPE_VALUE_PTR),
+            *flowDefinition->constants[ip->arg2 & THREADED_FUSED_CONSTANT_MASK], ip->arg2 >> THREADED_FUSED_BINARY_SHIFT);
+        THREADED_NEXT();
+    }
+    THREADED_CASE(END) {
+        return;
+    }
+    THREADED_CASE(END_WITH_DST_VALUE_TYPE) {
+        if (g_stack.sp == 1) {
+            auto finalResult = g_stack.pop();
+            if (finalResult.getType() == VALUE_TYPE_VALUE_PTR) {
+                finalResult.dstValueType = program->dstValueType;
+            } else if (finalResult.getType() == VALUE_TYPE_ARRAY_ELEMENT_VALUE) {
+                auto arrayElementValue = (ArrayElementValue *)finalResult.refValue;
+                arrayElementValue->dstValueType = program->dstValueType;
+            }
+            g_stack.push(finalResult);
+        }
+        return;
+    }
+#if !THREADED_GOTO
+    }
+#endif
+#undef THREADED_CASE
+#undef THREADED_NEXT
+}
+#if EEZ_FLOW_THREADED_DUMP
+static void dumpValue(char tag, uint32_t index, const Value &value) {
+    if (value.type == VALUE_TYPE_FLOAT) {
+        printf("%c %u f %.9g\n", tag, (unsigned)index, (double)value.floatValue);
+    } else if (value.type == VALUE_TYPE_DOUBLE) {
+        printf("%c %u d %.17g\n", tag, (unsigned)index, value.doubleValue);
+    } else if (value.type == VALUE_TYPE_BOOLEAN) {
+        printf("%c %u b %d\n", tag, (unsigned)index, (int)value.int32Value);
+    } else if (value.type == VALUE_TYPE_INT32) {
+        printf("%c %u i %d\n", tag, (unsigned)index, (int)value.int32Value);
+    } else {
+        printf("%c %u x\n", tag, (unsigned)index);
+    }
+}
+static void dumpAssets(FlowDefinition *flowDefinition) {
+    for (uint32_t i = 0; i < flowDefinition->constants.count; i++) {
+        dumpValue('C', i, *flowDefinition->constants[i]);
+    }
+    for (uint32_t i = 0; i < flowDefinition->globalVariables.count; i++) {
+        dumpValue('G', i, *flowDefinition->globalVariables[i]);
+    }
+}
+static void dumpExpression(const ThreadedProgram &header) {
+    printf("E ");
+    for (int i = 0; i < header.numInstructionBytes; i++) {
+        printf("%02X", header.instructions[i]);
+    }
+    printf("\n");
+}
+#endif
+void initThreadedExpressions(Assets *assets) {
+    runThreadedProgram(nullptr, nullptr);
+    if (g_threadedCache.entries) {
+        return;
+    }
+	auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+#if EEZ_FLOW_THREADED_DUMP
+    dumpAssets(flowDefinition);
+#endif
+    // first pass counts the properties and the memory for their translations
+    uint32_t numProperties = 0;
+    size_t arenaSize = 0;
+    ThreadedProgram header;
+    for (uint32_t flowIndex = 0; flowIndex < flowDefinition->flows.count; flowIndex++) {
+        // flows of chunked assets are translated when they are evaluated
+        auto flow = flowDefinition->flows[flowIndex];
+        if (!flow) {
+            continue;
+        }
+        for (uint32_t componentIndex = 0; componentIndex < flow->components.count; componentIndex++) {
+            auto component = flow->components[componentIndex];
+            for (uint32_t propertyIndex = 0; propertyIndex < component->properties.count; propertyIndex++) {
+                numProperties++;
+                if (translateExpression(flowDefinition, component->properties[propertyIndex]->evalInstructions, header)) {
+                    arenaSize += getThreadedProgramSize(g_threadedScratchNumCode, g_threadedScratchNumFolded);
+                } else {
+                    arenaSize += getThreadedProgramSize(0, 0);
+                }
+            }
+        }
+    }
+    uint32_t capacity = 1;
+    while (capacity * 3 < (numProperties + THREADED_LAZY_NUM) * 4) {
+        capacity <<= 1;
+    }
+    auto entries = (ThreadedProgram **)alloc(capacity * sizeof(ThreadedProgram *), 0x4e1f0a57);
+    auto arena = (uint8_t *)alloc(arenaSize > 0 ? arenaSize : 1, 0x9b3c6d21);
+    if (!entries || !arena) {
+        if (entries) {
+            free(entries);
+        }
+        if (arena) {
+            free(arena);
+        }
+        return;
+    }
+    memset(entries, 0, capacity * sizeof(ThreadedProgram *));
+    g_threadedCache.entries = entries;
+    g_threadedCache.mask = capacity - 1;
+    g_threadedCache.count = 0;
+    g_threadedCache.maxCount = capacity * 3 / 4;
+    g_threadedArenaStart = arena;
+    g_threadedArenaEnd = arena + arenaSize;
+    for (uint32_t flowIndex = 0; flowIndex < flowDefinition->flows.count; flowIndex++) {
+        auto flow = flowDefinition->flows[flowIndex];
+        if (!flow) {
+            continue;
+        }
+        for (uint32_t componentIndex = 0; componentIndex < flow->components.count; componentIndex++) {
+            auto component = flow->components[componentIndex];
+            for (uint32_t propertyIndex = 0; propertyIndex < component->properties.count; propertyIndex++) {
+                auto instructions = component->properties[propertyIndex]->evalInstructions;
+                if (findThreadedProgram(instructions)) {
+                    continue;
+                }
+                if (!translateExpression(flowDefinition, instructions, header)) {
+                    g_threadedScratchNumCode = 0;
+                    g_threadedScratchNumFolded = 0;
+                }
+#if EEZ_FLOW_THREADED_DUMP
+                dumpExpression(header);
+#endif
+                auto program = (ThreadedProgram *)arena;
+                storeThreadedProgram(program, header);
+                arena += getThreadedProgramSize(g_threadedScratchNumCode, g_threadedScratchNumFolded);
+                insertThreadedProgram(program);
+            }
+        }
+    }
+}
+// Returns false if the bytecode decoder has to evaluate the expression
+bool evalThreadedExpression(FlowState *flowState, const uint8_t *instructions, int *numInstructionBytes) {
+    auto program = findThreadedProgram(instructions);
+    if (!program) {
+        if (!g_threadedCache.entries || (g_threadedCache.count >= g_threadedCache.maxCount && !growThreadedCache())) {
+            return false;
+        }
+        ThreadedProgram header;
+        if (!translateExpression(flowState->flowDefinition, instructions, header)) {
+            g_threadedScratchNumCode = 0;
+            g_threadedScratchNumFolded = 0;
+        }
+#if EEZ_FLOW_THREADED_DUMP
+        dumpExpression(header);
+#endif
+        program = (ThreadedProgram *)alloc(getThreadedProgramSize(g_threadedScratchNumCode, g_threadedScratchNumFolded), 0x2d8e4b93);
+        if (!program) {
+            return false;
+        }
+        storeThreadedProgram(program, header);
+        insertThreadedProgram(program);
+    }
+    if (program->numCode == 0) {
+        return false;
+    }
+    runThreadedProgram(flowState, program);
+    if (numInstructionBytes) {
+        *numInstructionBytes = program->numInstructionBytes;
+    }
+    return true;
+}
+// Drops the translations of a flow that is about to be freed
+void purgeThreadedExpressions(const uint8_t *start, const uint8_t *end) {
+    if (!g_threadedCache.entries) {
+        return;
+    }
+    for (uint32_t i = 0; i <= g_threadedCache.mask; ) {
+        auto program = g_threadedCache.entries[i];
+        if (program && program->instructions >= start && program->instructions < end) {
+            if ((const uint8_t *)program < g_threadedArenaStart || (const uint8_t *)program >= g_threadedArenaEnd) {
+                free(program);
+            }
+            // the entry moved into slot i is checked next
+            removeThreadedEntry(i);
+        } else {
+            i++;
+        }
+    }
+}
+// Drops all translations, they are keyed by the address of the bytecode
+void resetThreadedExpressions() {
+    if (!g_threadedCache.entries) {
+        return;
+    }
+    for (uint32_t i = 0; i <= g_threadedCache.mask; i++) {
+        auto program = (const uint8_t *)g_threadedCache.entries[i];
+        if (program && (program < g_threadedArenaStart || program >= g_threadedArenaEnd)) {
+            free((void *)program);
+        }
+    }
+    free((void *)g_threadedArenaStart);
+    free(g_threadedCache.entries);
+    memset(&g_threadedCache, 0, sizeof(g_threadedCache));
+    g_threadedArenaStart = nullptr;
+    g_threadedArenaEnd = nullptr;
+}
+} 
+} 
+#endif
+// -----------------------------------------------------------------------------
 // flow/private.cpp
 // -----------------------------------------------------------------------------
 #include <stdio.h>
@@ -10029,6 +11283,7 @@ void initGlobalVariables(Assets *assets) {
         (numVars > 0 ? numVars - 1 : 0) * sizeof(Value),
         0xcc34ca8e
     );
+    g_globalVariables->count = numVars;
     for (uint32_t i = 0; i < numVars; i++) {
 		new (g_globalVariables->values + i) Value();
         g_globalVariables->values[i] = flowDefinition->globalVariables[i]->clone();
@@ -10090,7 +11345,11 @@ static bool pingComponent(FlowState *flowState, unsigned componentIndex, int sou
 }
 static FlowState *initFlowState(Assets *assets, int flowIndex, FlowState *parentFlowState, int parentComponentIndex, const Value& inputValue) {
 	auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
-	auto flow = flowDefinition->flows[flowIndex];
+	auto flow = getFlow(flowDefinition, flowIndex);
+	if (!flow) {
+		return nullptr;
+	}
+	retainFlow(flowDefinition, flowIndex);
 	auto nValues = flow->componentInputs.count + flow->localVariables.count;
 	FlowState *flowState = new (
 		alloc(
@@ -10104,7 +11363,7 @@ static FlowState *initFlowState(Assets *assets, int flowIndex, FlowState *parent
 	flowState->flowStateIndex = (int)((uint8_t *)flowState - ALLOC_BUFFER);
 	flowState->assets = assets;
 	flowState->flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
-	flowState->flow = flowDefinition->flows[flowIndex];
+	flowState->flow = flow;
 	flowState->flowIndex = flowIndex;
 	flowState->error = false;
 	flowState->refCounter = 0;
@@ -10242,6 +11501,7 @@ void freeFlowState(FlowState *flowState) {
 	}
     freeAllChildrenFlowStates(flowState->firstChild);
 	onFlowStateDestroyed(flowState);
+	releaseFlow(flowState->flowDefinition, flowState->flowIndex);
 	flowState->~FlowState();
 	free(flowState);
 }
@@ -10389,6 +11649,7 @@ void assignValue(FlowState *flowState, int componentIndex, Value &dstValue, cons
                     throwError(flowState, componentIndex, FlowError::Plain(errorMessage));
                 } else {
                     blobRef->blob[arrayElementValue->elementIndex] = elementValue;
+                    watchListOnValueChanged(nullptr);
                 }
                 return;
             } else {
@@ -10408,6 +11669,7 @@ void assignValue(FlowState *flowState, int componentIndex, Value &dstValue, cons
             if (err) {
                 throwError(flowState, componentIndex, FlowError::Plain("Can not assign to JSON member"));
             }
+            watchListOnValueChanged(nullptr);
             return;
         }
 #endif
@@ -10448,6 +11710,7 @@ void assignValue(FlowState *flowState, int componentIndex, Value &dstValue, cons
         }
         if (assignValue(*pDstValue, srcValue, dstValueType)) {
             onValueChanged(pDstValue);
+            watchListOnValueChanged(pDstValue);
         } else {
             char errorMessage[100];
             snprintf(errorMessage, sizeof(errorMessage), "Can not assign %s to %s\n",
@@ -10695,120 +11958,554 @@ void enableThrowError(bool enable) {
 // -----------------------------------------------------------------------------
 // flow/queue.cpp
 // -----------------------------------------------------------------------------
+#include <atomic>
 namespace eez {
 namespace flow {
 #if !defined(EEZ_FLOW_QUEUE_SIZE)
 #define EEZ_FLOW_QUEUE_SIZE 1000
 #endif
-static const unsigned QUEUE_SIZE = EEZ_FLOW_QUEUE_SIZE;
-static struct {
+#if !defined(EEZ_FLOW_CONTINUOUS_QUEUE_SIZE)
+#define EEZ_FLOW_CONTINUOUS_QUEUE_SIZE 100
+#endif
+#if !defined(EEZ_FLOW_TIMER_NUM)
+#define EEZ_FLOW_TIMER_NUM 32
+#endif
+#if !defined(EEZ_FLOW_POST_QUEUE_SIZE)
+#define EEZ_FLOW_POST_QUEUE_SIZE 32
+#endif
+static_assert((EEZ_FLOW_POST_QUEUE_SIZE & (EEZ_FLOW_POST_QUEUE_SIZE - 1)) == 0, "EEZ_FLOW_POST_QUEUE_SIZE must be a power of 2");
+static_assert(EEZ_FLOW_TIMER_NUM < 0xFF, "EEZ_FLOW_TIMER_NUM too large");
+struct QueueTask {
 	FlowState *flowState;
-	unsigned componentIndex;
-    bool continuousTask;
-} g_queue[QUEUE_SIZE];
-static unsigned g_queueHead;
-static unsigned g_queueTail;
-static unsigned g_queueMax;
-static bool g_queueIsFull = false;
-unsigned g_numNonContinuousTaskInQueue;
+	uint16_t componentIndex;
+    uint16_t addedAt; // millis() when added, for the latency statistics
+};
+struct QueueLane {
+    QueueTask *tasks;
+    unsigned size;
+    unsigned head;
+    unsigned count;
+};
+// Only the event lane is reported to the debugger, which mirrors it as a FIFO
+static QueueTask g_eventTasks[EEZ_FLOW_QUEUE_SIZE];
+static QueueTask g_continuousTasks[EEZ_FLOW_CONTINUOUS_QUEUE_SIZE];
+static QueueLane g_lanes[2] = {
+    { g_eventTasks, EEZ_FLOW_QUEUE_SIZE, 0, 0 },
+    { g_continuousTasks, EEZ_FLOW_CONTINUOUS_QUEUE_SIZE, 0, 0 }
+};
+static eez_flow_queue_stat_t g_queueStat;
+static void laneStatAdded(unsigned lane, unsigned depth) {
+    auto &stat = g_queueStat.lanes[lane];
+    stat.added++;
+    stat.depth = depth;
+    if (stat.maxDepth < depth) {
+        stat.maxDepth = depth;
+    }
+}
+static void laneStatExecuted(unsigned lane, unsigned depth, uint32_t latency) {
+    auto &stat = g_queueStat.lanes[lane];
+    stat.executed++;
+    stat.depth = depth;
+    stat.totalLatency += latency;
+    if (stat.maxLatency < latency) {
+        stat.maxLatency = latency;
+    }
+}
+// Delay components wait in a hashed timer wheel instead of being polled from
+// the continuous lane on every tick
+static const unsigned TIMER_WHEEL_SLOTS = 16;
+static const uint32_t TIMER_WHEEL_RESOLUTION_MS = 8;
+static const uint8_t TIMER_NONE = 0xFF;
+static struct {
+    FlowState *flowState;
+    uint32_t due;
+    uint16_t componentIndex;
+    uint8_t next;
+} g_timers[EEZ_FLOW_TIMER_NUM];
+static uint8_t g_timerWheel[TIMER_WHEEL_SLOTS];
+static uint8_t g_freeTimer;
+static unsigned g_numTimers;
+static uint32_t g_timerWheelTime; // start of the first slot not yet expired
+static uint32_t g_nextTimerDue;
+static void timerReset() {
+    for (unsigned i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        g_timerWheel[i] = TIMER_NONE;
+    }
+    for (unsigned i = 0; i < EEZ_FLOW_TIMER_NUM; i++) {
+        g_timers[i].next = i + 1 < EEZ_FLOW_TIMER_NUM ? (uint8_t)(i + 1) : TIMER_NONE;
+    }
+    g_freeTimer = 0;
+    g_numTimers = 0;
+}
+static unsigned timerSlot(uint32_t time) {
+    return (time / TIMER_WHEEL_RESOLUTION_MS) & (TIMER_WHEEL_SLOTS - 1);
+}
+// Values posted from other tasks and interrupts: a bounded multi-producer
+// queue, every cell holds the position it may be written at next (relative
+// to its index, so zero-initialized cells are empty)
+static struct {
+    std::atomic<uint32_t> sequence;
+    FlowState *flowState;
+    uint16_t componentIndex;
+    uint16_t outputIndex;
+    ValueType type;
+    uint32_t value;
+    uint32_t postedAt;
+} g_postQueue[EEZ_FLOW_POST_QUEUE_SIZE];
+static std::atomic<uint32_t> g_postTail;
+static std::atomic<uint32_t> g_postDropped;
+static uint32_t g_postHead;
+static uint32_t postSequence(uint32_t position) {
+    return position & ~(uint32_t)(EEZ_FLOW_POST_QUEUE_SIZE - 1);
+}
+static bool takePostedValue(FlowState *&flowState, unsigned &componentIndex, unsigned &outputIndex, ValueType &type, uint32_t &value) {
+    auto &cell = g_postQueue[g_postHead & (EEZ_FLOW_POST_QUEUE_SIZE - 1)];
+    if (cell.sequence.load(std::memory_order_acquire) != postSequence(g_postHead) + 1) {
+        return false;
+    }
+    flowState = cell.flowState;
+    componentIndex = cell.componentIndex;
+    outputIndex = cell.outputIndex;
+    type = cell.type;
+    value = cell.value;
+    uint32_t latency = millis() - cell.postedAt;
+    cell.sequence.store(postSequence(g_postHead) + EEZ_FLOW_POST_QUEUE_SIZE, std::memory_order_release);
+    uint32_t depth = g_postTail.load(std::memory_order_relaxed) - g_postHead;
+    if (g_queueStat.lanes[EEZ_FLOW_LANE_POST].maxDepth < depth) {
+        g_queueStat.lanes[EEZ_FLOW_LANE_POST].maxDepth = depth;
+    }
+    g_postHead++;
+    laneStatExecuted(EEZ_FLOW_LANE_POST, depth - 1, latency);
+    return true;
+}
 void queueReset() {
-	g_queueHead = 0;
-	g_queueTail = 0;
-	g_queueMax  = 0;
-	g_queueIsFull = false;
-    g_numNonContinuousTaskInQueue = 0;
+    for (unsigned i = 0; i < 2; i++) {
+        g_lanes[i].head = 0;
+        g_lanes[i].count = 0;
+    }
+    timerReset();
+    FlowState *flowState;
+    unsigned componentIndex;
+    unsigned outputIndex;
+    ValueType type;
+    uint32_t value;
+    while (takePostedValue(flowState, componentIndex, outputIndex, type, value)) {
+    }
+    memset(&g_queueStat, 0, sizeof(g_queueStat));
+    g_postDropped.store(0, std::memory_order_relaxed);
 }
 size_t getQueueSize() {
-	if (g_queueHead == g_queueTail) {
-		if (g_queueIsFull) {
-			return QUEUE_SIZE;
-		}
-		return 0;
-	}
-	if (g_queueHead < g_queueTail) {
-		return g_queueTail - g_queueHead;
-	}
-	return QUEUE_SIZE - g_queueHead + g_queueTail;
+    return g_lanes[EEZ_FLOW_LANE_EVENT].count + g_lanes[EEZ_FLOW_LANE_CONTINUOUS].count;
+}
+size_t getQueueSize(unsigned lane) {
+    return g_lanes[lane].count;
 }
 size_t getMaxQueueSize() {
-	return g_queueMax;
+	return g_queueStat.lanes[EEZ_FLOW_LANE_EVENT].maxDepth + g_queueStat.lanes[EEZ_FLOW_LANE_CONTINUOUS].maxDepth;
 }
 bool addToQueue(FlowState *flowState, unsigned componentIndex, int sourceComponentIndex, int sourceOutputIndex, int targetInputIndex, bool continuousTask) {
-	if (g_queueIsFull) {
+    unsigned laneIndex = continuousTask ? EEZ_FLOW_LANE_CONTINUOUS : EEZ_FLOW_LANE_EVENT;
+    auto &lane = g_lanes[laneIndex];
+	if (lane.count == lane.size) {
+        g_queueStat.lanes[laneIndex].dropped++;
         throwError(flowState, componentIndex, "Execution queue is full\n");
 		return false;
 	}
-	g_queue[g_queueTail].flowState = flowState;
-	g_queue[g_queueTail].componentIndex = componentIndex;
-    g_queue[g_queueTail].continuousTask = continuousTask;
-	g_queueTail = (g_queueTail + 1) % QUEUE_SIZE;
-	if (g_queueHead == g_queueTail) {
-		g_queueIsFull = true;
-	}
-	size_t queueSize = getQueueSize();
-	g_queueMax = g_queueMax < queueSize ? queueSize : g_queueMax;
+    auto &task = lane.tasks[(lane.head + lane.count) % lane.size];
+	task.flowState = flowState;
+	task.componentIndex = (uint16_t)componentIndex;
+    task.addedAt = (uint16_t)millis();
+    lane.count++;
+    laneStatAdded(laneIndex, lane.count);
     if (!continuousTask) {
-        ++g_numNonContinuousTaskInQueue;
 	    onAddToQueue(flowState, sourceComponentIndex, sourceOutputIndex, componentIndex, targetInputIndex);
     }
     incRefCounterForFlowState(flowState);
 	return true;
 }
-bool peekNextTaskFromQueue(FlowState *&flowState, unsigned &componentIndex, bool &continuousTask) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
+bool addTimerToQueue(FlowState *flowState, unsigned componentIndex, uint32_t due) {
+    if (g_freeTimer == TIMER_NONE) {
+        g_queueStat.lanes[EEZ_FLOW_LANE_TIMER].dropped++;
+        return addToQueue(flowState, componentIndex, -1, -1, -1, true);
+    }
+    uint32_t now = millis();
+    if (g_numTimers == 0) {
+        g_timerWheelTime = now - now % TIMER_WHEEL_RESOLUTION_MS;
+    }
+    unsigned slot = timerSlot((int32_t)(due - g_timerWheelTime) < 0 ? g_timerWheelTime : due);
+    uint8_t timerIndex = g_freeTimer;
+    auto &timer = g_timers[timerIndex];
+    g_freeTimer = timer.next;
+    timer.flowState = flowState;
+    timer.componentIndex = (uint16_t)componentIndex;
+    timer.due = due;
+    timer.next = g_timerWheel[slot];
+    g_timerWheel[slot] = timerIndex;
+    if (g_numTimers == 0 || (int32_t)(due - g_nextTimerDue) < 0) {
+        g_nextTimerDue = due;
+    }
+    g_numTimers++;
+    laneStatAdded(EEZ_FLOW_LANE_TIMER, g_numTimers);
+    incRefCounterForFlowState(flowState);
+    return true;
+}
+bool takeExpiredTimer(FlowState *&flowState, unsigned &componentIndex) {
+    if (g_numTimers == 0) {
+        return false;
+    }
+    uint32_t now = millis();
+    if ((int32_t)(now - g_nextTimerDue) < 0) {
+        return false;
+    }
+    for (unsigned emptySlots = 0; emptySlots < TIMER_WHEEL_SLOTS; emptySlots++) {
+        for (uint8_t *link = &g_timerWheel[timerSlot(g_timerWheelTime)]; *link != TIMER_NONE; link = &g_timers[*link].next) {
+            auto &timer = g_timers[*link];
+            if ((int32_t)(now - timer.due) >= 0) {
+                uint8_t timerIndex = *link;
+                *link = timer.next;
+                timer.next = g_freeTimer;
+                g_freeTimer = timerIndex;
+                g_numTimers--;
+                laneStatExecuted(EEZ_FLOW_LANE_TIMER, g_numTimers, now - timer.due);
+                flowState = timer.flowState;
+                componentIndex = timer.componentIndex;
+                decRefCounterForFlowState(flowState);
+                return true;
+            }
+        }
+        if (now - g_timerWheelTime < TIMER_WHEEL_RESOLUTION_MS) {
+            break;
+        }
+        g_timerWheelTime += TIMER_WHEEL_RESOLUTION_MS;
+    }
+    // every slot has been visited, the rest are due later
+    g_timerWheelTime = now - now % TIMER_WHEEL_RESOLUTION_MS;
+    bool first = true;
+    for (unsigned slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+        for (uint8_t i = g_timerWheel[slot]; i != TIMER_NONE; i = g_timers[i].next) {
+            if (first || (int32_t)(g_timers[i].due - g_nextTimerDue) < 0) {
+                g_nextTimerDue = g_timers[i].due;
+                first = false;
+            }
+        }
+    }
+    return false;
+}
+uint32_t getTimerTimeout() {
+    if (g_numTimers == 0) {
+        return UINT32_MAX;
+    }
+    int32_t timeout = (int32_t)(g_nextTimerDue - millis());
+    return timeout > 0 ? (uint32_t)timeout : 0;
+}
+bool peekNextTaskFromQueue(unsigned lane, FlowState *&flowState, unsigned &componentIndex) {
+	if (g_lanes[lane].count == 0) {
 		return false;
 	}
-	flowState = g_queue[g_queueHead].flowState;
-	componentIndex = g_queue[g_queueHead].componentIndex;
-    continuousTask = g_queue[g_queueHead].continuousTask;
+    auto &task = g_lanes[lane].tasks[g_lanes[lane].head];
+	flowState = task.flowState;
+	componentIndex = task.componentIndex;
 	return true;
 }
-void removeNextTaskFromQueue() {
-	auto flowState = g_queue[g_queueHead].flowState;
-    decRefCounterForFlowState(flowState);
-    auto continuousTask = g_queue[g_queueHead].continuousTask;
-	g_queueHead = (g_queueHead + 1) % QUEUE_SIZE;
-	g_queueIsFull = false;
-    if (!continuousTask) {
-        --g_numNonContinuousTaskInQueue;
+void removeNextTaskFromQueue(unsigned lane) {
+    auto &task = g_lanes[lane].tasks[g_lanes[lane].head];
+    decRefCounterForFlowState(task.flowState);
+	g_lanes[lane].head = (g_lanes[lane].head + 1) % g_lanes[lane].size;
+    g_lanes[lane].count--;
+    laneStatExecuted(lane, g_lanes[lane].count, (uint16_t)((uint16_t)millis() - task.addedAt));
+    if (lane == EEZ_FLOW_LANE_EVENT) {
 	    onRemoveFromQueue();
     }
 }
 bool isInQueue(FlowState *flowState, unsigned componentIndex) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
-		return false;
-	}
-    unsigned int it = g_queueHead;
-    while (true) {
-		if (g_queue[it].flowState == flowState && g_queue[it].componentIndex == componentIndex) {
-            return true;
-		}
-        it = (it + 1) % QUEUE_SIZE;
-        if (it == g_queueTail) {
-            break;
+    for (unsigned lane = 0; lane < 2; lane++) {
+        for (unsigned i = 0, it = g_lanes[lane].head; i < g_lanes[lane].count; i++, it = (it + 1) % g_lanes[lane].size) {
+            if (g_lanes[lane].tasks[it].flowState == flowState && g_lanes[lane].tasks[it].componentIndex == componentIndex) {
+                return true;
+            }
         }
-	}
+    }
     return false;
 }
+bool postValue(FlowState *flowState, unsigned componentIndex, unsigned outputIndex, ValueType type, uint32_t value) {
+    uint32_t position = g_postTail.load(std::memory_order_relaxed);
+    while (true) {
+        auto &cell = g_postQueue[position & (EEZ_FLOW_POST_QUEUE_SIZE - 1)];
+        int32_t diff = (int32_t)(cell.sequence.load(std::memory_order_acquire) - postSequence(position));
+        if (diff == 0) {
+            if (g_postTail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            g_postDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = g_postTail.load(std::memory_order_relaxed);
+        }
+    }
+    auto &cell = g_postQueue[position & (EEZ_FLOW_POST_QUEUE_SIZE - 1)];
+    cell.flowState = flowState;
+    cell.componentIndex = (uint16_t)componentIndex;
+    cell.outputIndex = (uint16_t)outputIndex;
+    cell.type = type;
+    cell.value = value;
+    cell.postedAt = millis();
+    cell.sequence.store(postSequence(position) + 1, std::memory_order_release);
+    return true;
+}
+void propagatePostedValues() {
+    FlowState *flowState;
+    unsigned componentIndex;
+    unsigned outputIndex;
+    ValueType type;
+    uint32_t value;
+    while (takePostedValue(flowState, componentIndex, outputIndex, type, value)) {
+        if (type == VALUE_TYPE_INT32) {
+            propagateValue(flowState, componentIndex, outputIndex, Value((int)value, VALUE_TYPE_INT32));
+        } else if (type == VALUE_TYPE_UINT32) {
+            propagateValue(flowState, componentIndex, outputIndex, Value(value, VALUE_TYPE_UINT32));
+        } else {
+            propagateValue(flowState, componentIndex, outputIndex);
+        }
+    }
+}
+size_t getPostedValueCount() {
+    return g_postTail.load(std::memory_order_relaxed) - g_postHead;
+}
 } 
 } 
+extern "C" void eez_flow_get_queue_stat(eez_flow_queue_stat_t *stat) {
+    *stat = eez::flow::g_queueStat;
+    auto &post = stat->lanes[EEZ_FLOW_LANE_POST];
+    post.depth = eez::flow::getPostedValueCount();
+    post.added = post.executed + post.depth;
+    post.dropped = eez::flow::g_postDropped.load(std::memory_order_relaxed);
+}
+extern "C" uint32_t eez_flow_get_timeout() {
+    return eez::flow::getTimerTimeout();
+}
 // -----------------------------------------------------------------------------
 // flow/watch_list.cpp
 // -----------------------------------------------------------------------------
 namespace eez {
 namespace flow {
 void executeWatchVariableComponent(FlowState *flowState, unsigned componentIndex);
+#if EEZ_FLOW_WATCH_DIRTY
+// Global variables read by a watch expression, more makes it volatile
+#define WATCH_MAX_DEPS 4
+// Global variable write counters, indexed by (variable index % WATCH_VERSION_NUM).
+// Variables sharing a counter only cause extra evaluations.
+#define WATCH_VERSION_NUM 32
+static const uint8_t WATCH_VOLATILE = 0x01;
+static const uint8_t WATCH_NATIVE = 0x02;
+static uint32_t g_watchGlobalVersion[WATCH_VERSION_NUM];
+// Writes into array, blob and json contents and anything not a global variable
+static uint32_t g_watchIndirectVersion;
+static uint32_t g_watchNativeVersion;
+#endif
 struct WatchListNode {
     FlowState *flowState;
     unsigned componentIndex;
     WatchListNode *prev;
     WatchListNode *next;
+#if EEZ_FLOW_WATCH_DIRTY
+    uint8_t flags;
+    uint8_t numDeps;
+    uint16_t deps[WATCH_MAX_DEPS];
+    uint32_t seenVersion;
+    uint32_t seenIndirectVersion;
+#endif
 };
 struct WatchList {
     WatchListNode *first;
     WatchListNode *last;
 };
 static WatchList g_watchList;
+static eez_flow_watch_stat_t g_watchStat;
+#if EEZ_FLOW_WATCH_DIRTY
+// Operations whose result depends only on their operands
+static const EvalOperation g_watchPureOperations[] = {
+    do_OPERATION_TYPE_ADD,
+    do_OPERATION_TYPE_SUB,
+    do_OPERATION_TYPE_MUL,
+    do_OPERATION_TYPE_DIV,
+    do_OPERATION_TYPE_MOD,
+    do_OPERATION_TYPE_LEFT_SHIFT,
+    do_OPERATION_TYPE_RIGHT_SHIFT,
+    do_OPERATION_TYPE_BINARY_AND,
+    do_OPERATION_TYPE_BINARY_OR,
+    do_OPERATION_TYPE_BINARY_XOR,
+    do_OPERATION_TYPE_EQUAL,
+    do_OPERATION_TYPE_NOT_EQUAL,
+    do_OPERATION_TYPE_LESS,
+    do_OPERATION_TYPE_GREATER,
+    do_OPERATION_TYPE_LESS_OR_EQUAL,
+    do_OPERATION_TYPE_GREATER_OR_EQUAL,
+    do_OPERATION_TYPE_LOGICAL_AND,
+    do_OPERATION_TYPE_LOGICAL_OR,
+    do_OPERATION_TYPE_UNARY_PLUS,
+    do_OPERATION_TYPE_UNARY_MINUS,
+    do_OPERATION_TYPE_BINARY_ONE_COMPLEMENT,
+    do_OPERATION_TYPE_NOT,
+    do_OPERATION_TYPE_CONDITIONAL,
+    do_OPERATION_TYPE_FLOW_PARSE_INTEGER,
+    do_OPERATION_TYPE_FLOW_PARSE_FLOAT,
+    do_OPERATION_TYPE_FLOW_PARSE_DOUBLE,
+    do_OPERATION_TYPE_FLOW_TO_INTEGER,
+    do_OPERATION_TYPE_MATH_SIN,
+    do_OPERATION_TYPE_MATH_COS,
+    do_OPERATION_TYPE_MATH_LOG,
+    do_OPERATION_TYPE_MATH_LOG10,
+    do_OPERATION_TYPE_MATH_ABS,
+    do_OPERATION_TYPE_MATH_FLOOR,
+    do_OPERATION_TYPE_MATH_CEIL,
+    do_OPERATION_TYPE_MATH_ROUND,
+    do_OPERATION_TYPE_MATH_MIN,
+    do_OPERATION_TYPE_MATH_MAX,
+    do_OPERATION_TYPE_MATH_POW,
+    do_OPERATION_TYPE_STRING_LENGTH,
+    do_OPERATION_TYPE_STRING_SUBSTRING,
+    do_OPERATION_TYPE_STRING_FIND,
+    do_OPERATION_TYPE_STRING_PAD_START,
+    do_OPERATION_TYPE_STRING_FROM_CODE_POINT,
+    do_OPERATION_TYPE_STRING_CODE_POINT_AT,
+    do_OPERATION_TYPE_STRING_FORMAT,
+    do_OPERATION_TYPE_STRING_FORMAT_PREFIX,
+    do_OPERATION_TYPE_ARRAY_LENGTH,
+    do_OPERATION_TYPE_BLOB_TO_STRING,
+};
+static bool isPureOperation(EvalOperation operation) {
+    for (size_t i = 0; i < sizeof(g_watchPureOperations) / sizeof(g_watchPureOperations[0]); i++) {
+        if (g_watchPureOperations[i] == operation) {
+            return true;
+        }
+    }
+    return false;
+}
+// Finds the global variables the watch expression reads. Inputs, local
+// variables, outputs, native variables (unless notified) and operations
+// like Date.now() or Flow.isPageActive() make it volatile.
+static void scanWatchExpression(WatchListNode *node) {
+    node->flags = 0;
+    node->numDeps = 0;
+    auto flowDefinition = node->flowState->flowDefinition;
+    auto component = node->flowState->flow->components[node->componentIndex];
+    if (defs_v3::WATCH_VARIABLE_ACTION_COMPONENT_PROPERTY_VARIABLE >= component->properties.count) {
+        node->flags = WATCH_VOLATILE;
+        return;
+    }
+    const uint8_t *instructions = component->properties[defs_v3::WATCH_VARIABLE_ACTION_COMPONENT_PROPERTY_VARIABLE]->evalInstructions;
+    for (int i = 0; ; i += 2) {
+		uint16_t instruction = instructions[i] + (instructions[i + 1] << 8);
+		auto instructionType = instruction & EXPR_EVAL_INSTRUCTION_TYPE_MASK;
+		auto instructionArg = instruction & EXPR_EVAL_INSTRUCTION_PARAM_MASK;
+        if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT || instructionType == EXPR_EVAL_INSTRUCTION_ARRAY_ELEMENT) {
+            continue;
+        }
+        if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_GLOBAL_VAR) {
+			if ((uint32_t)instructionArg < flowDefinition->globalVariables.count) {
+                int j;
+                for (j = 0; j < node->numDeps && node->deps[j] != instructionArg; j++) {
+                }
+                if (j == node->numDeps) {
+                    if (node->numDeps == WATCH_MAX_DEPS) {
+                        node->flags |= WATCH_VOLATILE;
+                        return;
+                    }
+                    node->deps[node->numDeps++] = instructionArg;
+                }
+            } else {
+#if EEZ_FLOW_WATCH_NATIVE_NOTIFY
+                node->flags |= WATCH_NATIVE;
+#else
+                node->flags |= WATCH_VOLATILE;
+                return;
+#endif
+            }
+            continue;
+        }
+        if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_OPERATION) {
+            if (!isPureOperation(g_evalOperations[instructionArg])) {
+                node->flags |= WATCH_VOLATILE;
+                return;
+            }
+            continue;
+        }
+        if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_END) {
+            return;
+        }
+        node->flags |= WATCH_VOLATILE;
+        return;
+    }
+}
+// With compressed assets the global variables stay in the decompressed
+// flow definition instead of g_globalVariables
+static Value *getGlobalVariableValue(uint32_t globalVariableIndex) {
+    if (g_globalVariables) {
+        return g_globalVariables->values + globalVariableIndex;
+    }
+    return g_mainAssets->flowDefinition->globalVariables[globalVariableIndex];
+}
+static uint32_t getWatchVersion(WatchListNode *node, bool &indirect) {
+    uint32_t version = (node->flags & WATCH_NATIVE) ? g_watchNativeVersion : 0;
+    indirect = false;
+    for (int i = 0; i < node->numDeps; i++) {
+        version += g_watchGlobalVersion[node->deps[i] % WATCH_VERSION_NUM];
+        auto type = getGlobalVariableValue(node->deps[i])->type;
+        if (!(type == VALUE_TYPE_UNDEFINED || type == VALUE_TYPE_NULL ||
+            Value::isInt32OrLess(type) || type == VALUE_TYPE_INT64 || type == VALUE_TYPE_UINT64 ||
+            type == VALUE_TYPE_FLOAT || type == VALUE_TYPE_DOUBLE ||
+            type == VALUE_TYPE_STRING || type == VALUE_TYPE_STRING_ASSET || type == VALUE_TYPE_STRING_REF)) {
+            // contents of an array, blob or json can change without writing the variable
+            indirect = true;
+        }
+    }
+    return version;
+}
+// Returns true if the watch expression has to be evaluated and remembers the
+// versions it is going to see. The sum of the counters changes whenever one
+// of them is incremented.
+static bool isWatchDirty(WatchListNode *node) {
+    if (node->flags & WATCH_VOLATILE) {
+        return true;
+    }
+    bool indirect;
+    auto version = getWatchVersion(node, indirect);
+    bool dirty = version != node->seenVersion || (indirect && g_watchIndirectVersion != node->seenIndirectVersion);
+    node->seenVersion = version;
+    node->seenIndirectVersion = g_watchIndirectVersion;
+    return dirty;
+}
+#endif
+void watchListOnGlobalChanged(uint32_t globalVariableIndex) {
+#if EEZ_FLOW_WATCH_DIRTY
+    g_watchGlobalVersion[globalVariableIndex % WATCH_VERSION_NUM]++;
+#endif
+}
+void watchListOnValueChanged(const Value *pValue) {
+#if EEZ_FLOW_WATCH_DIRTY
+    if (g_globalVariables) {
+        if (pValue >= g_globalVariables->values && pValue < g_globalVariables->values + g_globalVariables->count) {
+            watchListOnGlobalChanged(pValue - g_globalVariables->values);
+            return;
+        }
+    } else if (pValue && g_mainAssets) {
+        auto &globalVariables = g_mainAssets->flowDefinition->globalVariables;
+        for (uint32_t i = 0; i < globalVariables.count; i++) {
+            if (globalVariables[i] == pValue) {
+                watchListOnGlobalChanged(i);
+                return;
+            }
+        }
+    }
+    g_watchIndirectVersion++;
+#endif
+}
+void watchListOnNativeChanged() {
+#if EEZ_FLOW_WATCH_DIRTY
+    g_watchNativeVersion++;
+#endif
+}
 WatchListNode *watchListAdd(FlowState *flowState, unsigned componentIndex) {
     auto node = (WatchListNode *)alloc(sizeof(WatchListNode), 0x00864d67);
     node->prev = g_watchList.last;
@@ -10822,6 +12519,12 @@ WatchListNode *watchListAdd(FlowState *flowState, unsigned componentIndex) {
     node->next = 0;
     node->flowState = flowState;
     node->componentIndex = componentIndex;
+#if EEZ_FLOW_WATCH_DIRTY
+    // the expression has just been evaluated by the caller
+    scanWatchExpression(node);
+    isWatchDirty(node);
+#endif
+    g_watchStat.watchers++;
     incRefCounterForFlowState(flowState);
     return node;
 }
@@ -10836,13 +12539,24 @@ void watchListRemove(WatchListNode *node) {
     } else {
         g_watchList.last = node->prev;
     }
+    g_watchStat.watchers--;
     free(node);
 }
 void visitWatchList() {
+    g_watchStat.evaluated = 0;
+    g_watchStat.skipped = 0;
     for (auto node = g_watchList.first; node; ) {
         auto nextNode = node->next;
         if (canExecuteStep(node->flowState, node->componentIndex)) {
-            executeWatchVariableComponent(node->flowState, node->componentIndex);
+#if EEZ_FLOW_WATCH_DIRTY
+            if (!isWatchDirty(node)) {
+                g_watchStat.skipped++;
+            } else
+#endif
+            {
+                g_watchStat.evaluated++;
+                executeWatchVariableComponent(node->flowState, node->componentIndex);
+            }
         }
         decRefCounterForFlowState(node->flowState);
         if (canFreeFlowState(node->flowState)) {
@@ -10853,6 +12567,8 @@ void visitWatchList() {
         }
         node = nextNode;
     }
+    g_watchStat.totalEvaluated += g_watchStat.evaluated;
+    g_watchStat.totalSkipped += g_watchStat.skipped;
 }
 void watchListReset() {
     for (auto node = g_watchList.first; node;) {
@@ -10862,4 +12578,10 @@ void watchListReset() {
     }
 }
 } 
-} 
\ No newline at end of file
+} 
+extern "C" void eez_flow_get_watch_stat(eez_flow_watch_stat_t *stat) {
+    *stat = eez::flow::g_watchStat;
+}
+extern "C" void eez_flow_native_var_changed() {
+    eez::flow::watchListOnNativeChanged();
+}
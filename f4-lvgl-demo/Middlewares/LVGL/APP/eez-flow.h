@@ -14,7 +14,46 @@
 #define EEZ_FOR_LVGL_LZ4_OPTION 1
 #define EEZ_FOR_LVGL_SHA256_OPTION 0
 #define EEZ_FLOW_QUEUE_SIZE 1000
+// Tasks that run again on every tick (animations, LVGL components, ...) wait
+// in their own lane and run after the event tasks
+#define EEZ_FLOW_CONTINUOUS_QUEUE_SIZE 100
+// Pending Delay components, more are polled from the continuous lane
+#define EEZ_FLOW_TIMER_NUM 32
+// Values posted with flowPostValue*() not yet propagated, power of 2
+#define EEZ_FLOW_POST_QUEUE_SIZE 32
 #define EEZ_FLOW_EVAL_STACK_SIZE 20
+// Strings made from numbers and by concatenation are allocated in one block
+// with their reference and shared while an equal string is alive, 0 allocates
+// the reference and the text separately for every string
+#define EEZ_FLOW_STRING_POOL 1
+// Hash buckets of the string pool, power of 2
+#define EEZ_FLOW_STRING_POOL_SIZE 64
+// Longer strings are not shared
+#define EEZ_FLOW_STRING_POOL_MAX_LEN 64
+// Value strings, arrays and component states up to MEM_SLAB_MAX_SIZE bytes
+// come from a mem_slab arena of this size, 0 uses the LVGL heap only
+#define EEZ_FLOW_SLAB_SIZE (16 * 1024)
+// WatchVariable expressions that only read global variables are re-evaluated
+// after one of those variables has been written, 0 re-evaluates every watch
+// expression on every tick
+#define EEZ_FLOW_WATCH_DIRTY 1
+// Native variables are written by application code without the flow knowing,
+// so watch expressions reading them are re-evaluated every tick. Set to 1 only
+// if the application calls eez_flow_native_var_changed() after every write
+#define EEZ_FLOW_WATCH_NATIVE_NOTIFY 0
+// Expressions are translated once into threaded code with constant folding,
+// fused variable/constant operations and int/float fast paths, 0 decodes the
+// asset bytecode on every evaluation
+#define EEZ_FLOW_THREADED_EVAL 1
+// Print the constants, global variables and expressions of the assets when
+// they are translated, for Tools/expr_bench
+#define EEZ_FLOW_THREADED_DUMP 0
+// Load eez_flow_packed_assets made by Tools/asset_pack instead of the assets
+// generated by EEZ Studio: uncompressed assets are used in place from flash,
+// chunked assets decompress every flow separately on first use
+#define EEZ_FLOW_PACKED_ASSETS 0
+// Flows of chunked assets that are not running are freed to stay below this
+#define EEZ_FLOW_ASSETS_CACHE_SIZE (16 * 1024)
 
 // -----------------------------------------------------------------------------
 // conf-internal.h
@@ -1258,7 +1297,10 @@ struct Value {
     bool toBool(int *err = nullptr) const;
 	Value toString(uint32_t id) const;
 	static Value makeStringRef(const char *str, int len, uint32_t id);
+    // Like makeStringRef but an equal string may be returned, do not modify it
+    static Value makePooledString(const char *str, int len, uint32_t id);
 	static Value concatenateString(const Value &str1, const Value &str2);
+	static Value concatenateString(const char *str1, const char *str2);
     static Value makeArrayRef(int arraySize, int arrayType, uint32_t id);
     static Value makeArrayElementRef(Value arrayValue, int elementIndex, uint32_t id);
     static Value makeJsonMemberRef(Value jsonValue, Value propertyName, uint32_t id);
@@ -1303,13 +1345,32 @@ struct Value {
 		PairOfInt16Value pairOfInt16Value;
 	};
 };
+#if EEZ_FLOW_STRING_POOL
+struct StringRef;
+void removeFromStringPool(StringRef *stringRef);
+#endif
 struct StringRef : public Ref {
     ~StringRef() {
+#if EEZ_FLOW_STRING_POOL
+        if (hash) {
+            removeFromStringPool(this);
+        }
+        if (str && str != (char *)(this + 1)) {
+            eez::free(str);
+        }
+#else
         if (str) {
             eez::free(str);
         }
+#endif
     }
 	char *str;
+#if EEZ_FLOW_STRING_POOL
+    // Next string in the same pool bucket
+    StringRef *next;
+    // Hash of the text, 0 if the string is not in the pool
+    uint32_t hash;
+#endif
 };
 struct ArrayValue {
 	uint32_t arraySize;
@@ -1564,6 +1625,7 @@ void executeActionFunction(int actionId);
 namespace eez {
 static const uint32_t HEADER_TAG = 0x5A45457E; 
 static const uint32_t HEADER_TAG_COMPRESSED = 0x7A65657E; 
+static const uint32_t HEADER_TAG_CHUNKED = 0x6B65657E; 
 static const uint8_t PROJECT_VERSION_V2 = 2;
 static const uint8_t PROJECT_VERSION_V3 = 3;
 static const uint8_t ASSETS_TYPE_FIRMWARE = 1;
@@ -1579,6 +1641,18 @@ struct Header {
     uint8_t reserved;
 	uint32_t decompressedSize;
 };
+struct ChunkedHeader {
+    Header header; 
+    uint32_t numChunks; 
+    uint32_t coreCompressedSize; 
+};
+struct AssetsChunk {
+    uint32_t offset; 
+    uint32_t compressedSize; 
+    uint32_t size; 
+    uint32_t relocationsOffset; 
+    uint32_t numRelocations; 
+};
 extern bool g_isMainAssetsLoaded;
 struct Assets;
 extern Assets *g_mainAssets;
@@ -1893,6 +1967,9 @@ bool decompressAssetsData(const uint8_t *assetsData, uint32_t assetsDataSize, As
 void loadMainAssets(const uint8_t *assets, uint32_t assetsSize);
 bool loadExternalAssets(const char *filePath, int *err);
 void unloadExternalAssets();
+Flow *getFlow(FlowDefinition *flowDefinition, uint32_t flowIndex);
+void retainFlow(FlowDefinition *flowDefinition, uint32_t flowIndex);
+void releaseFlow(FlowDefinition *flowDefinition, uint32_t flowIndex);
 #if EEZ_OPTION_GUI
 const gui::PageAsset *getPageAsset(int pageId);
 const gui::PageAsset* getPageAsset(int pageId, gui::WidgetCursor& widgetCursor);
@@ -2178,6 +2255,14 @@ void stringAppendCurrent(char *str, size_t maxStrLength, float value);
 void stringAppendPower(char *str, size_t maxStrLength, float value);
 void stringAppendDuration(char *str, size_t maxStrLength, float value);
 void stringAppendLoad(char *str, size_t maxStrLength, float value);
+// Same text as snprintf "%d", "%u", "%g" and "%.*f" without printf, return
+// the length. Integers need 21 bytes
+int formatInt32(char *str, int32_t value);
+int formatUInt32(char *str, uint32_t value);
+int formatInt64(char *str, int64_t value);
+int formatUInt64(char *str, uint64_t value);
+int formatDouble(char *str, size_t maxStrLength, double value);
+int formatDoubleFixed(char *str, size_t maxStrLength, double value, int numDecimalPlaces);
 uint32_t crc32(const uint8_t *message, size_t size);
 uint8_t toBCD(uint8_t bin);
 uint8_t fromBCD(uint8_t bcd);
@@ -2597,6 +2682,13 @@ bool evalProperty(FlowState *flowState, int componentIndex, int propertyIndex, V
 bool evalProperty(FlowState *flowState, int componentIndex, int propertyIndex, Value &result, const FlowError &errorMessage, int *numInstructionBytes = nullptr, const int32_t *iterators = nullptr);
 #endif
 bool evalAssignableProperty(FlowState *flowState, int componentIndex, int propertyIndex, Value &result, const FlowError &errorMessage, int *numInstructionBytes = nullptr, const int32_t *iterators = nullptr);
+void evalArrayElement();
+#if EEZ_FLOW_THREADED_EVAL
+void initThreadedExpressions(Assets *assets);
+bool evalThreadedExpression(FlowState *flowState, const uint8_t *instructions, int *numInstructionBytes);
+void purgeThreadedExpressions(const uint8_t *start, const uint8_t *end);
+void resetThreadedExpressions();
+#endif
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -2665,6 +2757,7 @@ extern void (*startToDebuggerMessageHook)();
 extern void (*writeDebuggerBufferHook)(const char *buffer, uint32_t length);
 extern void (*finishToDebuggerMessageHook)();
 extern void (*onDebuggerInputAvailableHook)();
+extern bool (*isDebuggerBusyHook)();
 #if defined(EEZ_FOR_LVGL)
 extern lv_obj_t *(*getLvglObjectFromIndexHook)(int32_t index);
 extern lv_group_t *(*getLvglGroupFromIndexHook)(int32_t index);
@@ -2714,14 +2807,20 @@ namespace eez {
 namespace flow {
 void queueReset();
 size_t getQueueSize();
+size_t getQueueSize(unsigned lane);
 size_t getMaxQueueSize();
-extern unsigned g_numNonContinuousTaskInQueue;
 bool addToQueue(FlowState *flowState, unsigned componentIndex,
     int sourceComponentIndex, int sourceOutputIndex, int targetInputIndex,
     bool continuousTask);
-bool peekNextTaskFromQueue(FlowState *&flowState, unsigned &componentIndex, bool &continuousTask);
-void removeNextTaskFromQueue();
+bool addTimerToQueue(FlowState *flowState, unsigned componentIndex, uint32_t due);
+bool takeExpiredTimer(FlowState *&flowState, unsigned &componentIndex);
+uint32_t getTimerTimeout();
+bool peekNextTaskFromQueue(unsigned lane, FlowState *&flowState, unsigned &componentIndex);
+void removeNextTaskFromQueue(unsigned lane);
 bool isInQueue(FlowState *flowState, unsigned componentIndex);
+bool postValue(FlowState *flowState, unsigned componentIndex, unsigned outputIndex, ValueType type, uint32_t value);
+void propagatePostedValues();
+size_t getPostedValueCount();
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -2734,6 +2833,9 @@ WatchListNode *watchListAdd(FlowState *flowState, unsigned componentIndex);
 void watchListRemove(WatchListNode *node);
 void visitWatchList();
 void watchListReset();
+void watchListOnGlobalChanged(uint32_t globalVariableIndex);
+void watchListOnValueChanged(const Value *pValue);
+void watchListOnNativeChanged();
 } 
 } 
 // -----------------------------------------------------------------------------
@@ -3042,6 +3144,50 @@ void eez_flow_init_style_names(const char **styleNames, size_t numStyles);
 void eez_flow_init_themes(const char **themeNames, size_t numThemes, void (*changeColorTheme)(uint32_t themeIndex));
 void eez_flow_tick();
 bool eez_flow_is_stopped();
+bool eez_flow_is_idle();
+typedef struct {
+    uint32_t watchers;        // nodes in the watch list
+    uint32_t evaluated;       // watch expressions evaluated in the last tick
+    uint32_t skipped;         // watch expressions skipped in the last tick
+    uint32_t totalEvaluated;
+    uint32_t totalSkipped;
+} eez_flow_watch_stat_t;
+void eez_flow_get_watch_stat(eez_flow_watch_stat_t *stat);
+void eez_flow_native_var_changed();
+typedef struct {
+    uint32_t chunks;          // flows compressed separately, 0 if not chunked
+    uint32_t loaded;          // flows decompressed now
+    uint32_t loadedSize;
+    uint32_t peakSize;
+    uint32_t loads;
+    uint32_t evictions;
+} eez_flow_assets_stat_t;
+void eez_flow_get_assets_stat(eez_flow_assets_stat_t *stat);
+typedef enum {
+    EEZ_FLOW_LANE_EVENT,      // tasks started by inputs and events, run first
+    EEZ_FLOW_LANE_CONTINUOUS, // tasks that run again on every tick
+    EEZ_FLOW_LANE_TIMER,      // Delay components
+    EEZ_FLOW_LANE_POST,       // values posted with flowPostValue*()
+    EEZ_FLOW_LANE_NUM
+} eez_flow_lane_t;
+typedef struct {
+    uint32_t depth;           // waiting now
+    uint32_t maxDepth;
+    uint32_t added;
+    uint32_t executed;
+    uint32_t dropped;         // lane full (timers: polled instead)
+    uint32_t maxLatency;      // ms from added (timers: from due) to executed
+    uint32_t totalLatency;    // divided by executed gives the average
+} eez_flow_lane_stat_t;
+typedef struct {
+    eez_flow_lane_stat_t lanes[EEZ_FLOW_LANE_NUM];
+} eez_flow_queue_stat_t;
+void eez_flow_get_queue_stat(eez_flow_queue_stat_t *stat);
+uint32_t eez_flow_get_timeout();
+#if EEZ_FLOW_PACKED_ASSETS
+extern const uint8_t eez_flow_packed_assets[];
+extern const uint32_t eez_flow_packed_assets_size;
+#endif
 extern int16_t g_currentScreen;
 int16_t eez_flow_get_current_screen();
 void eez_flow_set_screen(int16_t screenId, lv_scr_load_anim_t animType, uint32_t speed, uint32_t delay);
@@ -3052,6 +3198,9 @@ void *getFlowState(void *flowState, unsigned userWidgetComponentIndexOrPageIndex
 void flowPropagateValue(void *flowState, unsigned componentIndex, unsigned outputIndex);
 void flowPropagateValueInt32(void *flowState, unsigned componentIndex, unsigned outputIndex, int32_t value);
 void flowPropagateValueUint32(void *flowState, unsigned componentIndex, unsigned outputIndex, uint32_t value);
+bool flowPostValue(void *flowState, unsigned componentIndex, unsigned outputIndex);
+bool flowPostValueInt32(void *flowState, unsigned componentIndex, unsigned outputIndex, int32_t value);
+bool flowPostValueUint32(void *flowState, unsigned componentIndex, unsigned outputIndex, uint32_t value);
 void flowPropagateValueLVGLEvent(void *flowState, unsigned componentIndex, unsigned outputIndex, lv_event_t *event);
 const char *evalTextProperty(void *flowState, unsigned componentIndex, unsigned propertyIndex, const char *errorMessage);
 int32_t evalIntegerProperty(void *flowState, unsigned componentIndex, unsigned propertyIndex, const char *errorMessage);
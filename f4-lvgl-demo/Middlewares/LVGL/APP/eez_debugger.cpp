@@ -0,0 +1,330 @@
+/**
+ * @file    eez_debugger.cpp
+ * @author  Deadline039
+ * @brief   EEZ Flow 调试器的 USB CDC 传输
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * 帧缓冲区按顺序循环使用: 在 GUI 任务中填充 dbg_frame_next, USB 中断中发送
+ * dbg_frame_send. 启用后 USB CDC 只给调试器使用, 不要再调用 usb_cdc_printf.
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#include "eez_debugger.h"
+
+#if EEZ_DEBUGGER_CDC
+
+#include "eez-flow.h"
+/* LZ4_compress_fast_extState_fastReset */
+#define LZ4_STATIC_LINKING_ONLY
+#include "eez-flow-lz4.h"
+#include "lv_port_prof.h"
+#include "ring_fifo/ring_fifo.h"
+#include "usbd_cdc_if.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <bsp.h>
+
+#define FRAME_SIZE                                                             \
+    (EEZ_DEBUGGER_HEADER_SIZE + LZ4_COMPRESSBOUND(EEZ_DEBUGGER_BATCH_SIZE))
+
+/**
+ * @brief 帧状态
+ */
+enum {
+    FRAME_FREE,   /*!< 空闲 */
+    FRAME_READY,  /*!< 等待发送 */
+    FRAME_SENDING /*!< 正在发送 */
+};
+
+/**
+ * @brief 帧缓冲区
+ */
+typedef struct {
+    volatile uint8_t state;               /*!< 状态 */
+    uint32_t len;                         /*!< 帧长度 (含帧头) */
+    __ALIGNED(4) uint8_t data[FRAME_SIZE]; /*!< 帧头和数据 */
+} dbg_frame_t;
+
+static char dbg_text[EEZ_DEBUGGER_BATCH_SIZE];
+static uint32_t dbg_text_len;
+
+static dbg_frame_t dbg_frames[EEZ_DEBUGGER_FRAME_NUM];
+static uint32_t dbg_frame_next;
+static volatile uint32_t dbg_frame_send;
+
+static LZ4_stream_t dbg_lz4;
+
+static uint8_t dbg_rx_buf[EEZ_DEBUGGER_RX_SIZE];
+static ring_fifo_t *dbg_rx;
+
+static uint8_t dbg_seq;
+static uint8_t dbg_lost;
+static uint32_t dbg_cycles;
+static eez_debugger_stat_t dbg_stat;
+static void (*dbg_wakeup)(void);
+
+/**
+ * @brief 如果 USB 空闲, 发送下一帧. GUI 任务和 USB 中断都会调用
+ *
+ */
+static void dbg_kick(void) {
+    uint32_t primask = __get_PRIMASK();
+    dbg_frame_t *frame;
+
+    __disable_irq();
+    frame = &dbg_frames[dbg_frame_send];
+    if (frame->state == FRAME_READY && usb_cdc_tx_ready()) {
+        frame->state = FRAME_SENDING;
+        usb_cdc_tramsmit(frame->data, frame->len);
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 丢弃等待发送的帧, 正在发送的帧等待完成
+ *
+ */
+static void dbg_drop_frames(void) {
+    uint32_t primask = __get_PRIMASK();
+    uint32_t i;
+
+    __disable_irq();
+    for (i = 0; i < EEZ_DEBUGGER_FRAME_NUM; ++i) {
+        if (dbg_frames[i].state == FRAME_READY) {
+            dbg_frames[i].state = FRAME_FREE;
+        }
+    }
+    /* 保证填充和发送的顺序一致 */
+    if (dbg_frames[dbg_frame_send].state == FRAME_SENDING) {
+        dbg_frame_next = (dbg_frame_send + 1) % EEZ_DEBUGGER_FRAME_NUM;
+    } else {
+        dbg_frame_send = dbg_frame_next;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 把收集的消息压缩成一帧
+ *
+ */
+static void dbg_flush(void) {
+    dbg_frame_t *frame = &dbg_frames[dbg_frame_next];
+    uint8_t *p = frame->data;
+    uint8_t flags;
+    int len;
+
+    if (dbg_text_len == 0) {
+        return;
+    }
+
+    if (frame->state != FRAME_FREE) {
+        dbg_stat.lost_bytes += dbg_text_len;
+        dbg_lost = 1;
+        dbg_text_len = 0;
+        return;
+    }
+
+    flags = dbg_lost ? EEZ_DEBUGGER_FLAG_LOST : 0;
+    len = LZ4_compress_fast_extState_fastReset(
+        &dbg_lz4, dbg_text, (char *)p + EEZ_DEBUGGER_HEADER_SIZE,
+        (int)dbg_text_len, FRAME_SIZE - EEZ_DEBUGGER_HEADER_SIZE, 1);
+    if (len <= 0 || (uint32_t)len >= dbg_text_len) {
+        memcpy(p + EEZ_DEBUGGER_HEADER_SIZE, dbg_text, dbg_text_len);
+        len = (int)dbg_text_len;
+    } else {
+        flags |= EEZ_DEBUGGER_FLAG_LZ4;
+    }
+
+    p[0] = EEZ_DEBUGGER_MAGIC[0];
+    p[1] = EEZ_DEBUGGER_MAGIC[1];
+    p[2] = flags;
+    p[3] = dbg_seq++;
+    p[4] = (uint8_t)dbg_text_len;
+    p[5] = (uint8_t)(dbg_text_len >> 8);
+    p[6] = (uint8_t)len;
+    p[7] = (uint8_t)(len >> 8);
+    frame->len = EEZ_DEBUGGER_HEADER_SIZE + (uint32_t)len;
+
+    dbg_stat.text_bytes += dbg_text_len;
+    dbg_stat.sent_bytes += frame->len;
+    ++dbg_stat.frames;
+    dbg_lost = 0;
+    dbg_text_len = 0;
+
+    dbg_frame_next = (dbg_frame_next + 1) % EEZ_DEBUGGER_FRAME_NUM;
+    __DMB();
+    frame->state = FRAME_READY;
+    dbg_kick();
+}
+
+/**
+ * @brief 检查连接状态, 处理电脑发来的命令
+ *
+ */
+static void dbg_poll(void) {
+    char buf[64];
+    uint32_t len;
+
+    if (usb_cdc_is_open()) {
+        if (!dbg_stat.connected) {
+            dbg_drop_frames();
+            dbg_seq = 0;
+            dbg_lost = 0;
+            dbg_text_len = 0;
+            dbg_stat.connected = 1;
+            eez::flow::onDebuggerClientConnected();
+        }
+        while ((len = ring_fifo_read(dbg_rx, buf, sizeof(buf))) > 0) {
+            eez::flow::processDebuggerInput(buf, len);
+        }
+    } else if (dbg_stat.connected) {
+        dbg_stat.connected = 0;
+        eez::flow::onDebuggerClientDisconnected();
+        dbg_drop_frames();
+        dbg_text_len = 0;
+    }
+}
+
+/**
+ * @brief 一条消息开始, 没有需要做的
+ *
+ */
+static void dbg_start_message() {
+}
+
+/**
+ * @brief 收集消息, 满了先压缩发送
+ *
+ * @param buffer 消息
+ * @param length 长度
+ */
+static void dbg_write(const char *buffer, uint32_t length) {
+    uint32_t start = DWT->CYCCNT;
+    uint32_t n;
+
+    LV_PORT_PROF_BEGIN(LV_PORT_PROF_FLOW_DEBUG);
+    while (length > 0) {
+        n = EEZ_DEBUGGER_BATCH_SIZE - dbg_text_len;
+        if (n > length) {
+            n = length;
+        }
+        memcpy(dbg_text + dbg_text_len, buffer, n);
+        dbg_text_len += n;
+        buffer += n;
+        length -= n;
+        if (dbg_text_len == EEZ_DEBUGGER_BATCH_SIZE) {
+            dbg_flush();
+        }
+    }
+    LV_PORT_PROF_END(LV_PORT_PROF_FLOW_DEBUG);
+    dbg_cycles += DWT->CYCCNT - start;
+}
+
+/**
+ * @brief tick 结束, 发送这次收集的消息
+ *
+ */
+static void dbg_finish_message() {
+    uint32_t start = DWT->CYCCNT;
+
+    LV_PORT_PROF_BEGIN(LV_PORT_PROF_FLOW_DEBUG);
+    if (dbg_stat.connected) {
+        dbg_flush();
+    } else {
+        dbg_text_len = 0;
+    }
+    dbg_poll();
+    dbg_kick();
+    LV_PORT_PROF_END(LV_PORT_PROF_FLOW_DEBUG);
+
+    dbg_cycles += DWT->CYCCNT - start;
+    dbg_stat.tick_cycles = dbg_cycles;
+    if (dbg_cycles > dbg_stat.max_cycles) {
+        dbg_stat.max_cycles = dbg_cycles;
+    }
+    dbg_cycles = 0;
+}
+
+/**
+ * @brief 下一帧没有空闲的缓冲区
+ *
+ * @return 是否忙
+ */
+static bool dbg_is_busy() {
+    if (dbg_frames[dbg_frame_next].state == FRAME_FREE) {
+        return false;
+    }
+    ++dbg_stat.busy_ticks;
+    return true;
+}
+
+/**
+ * @brief 收到数据, USB 中断中调用
+ *
+ * @param data 数据
+ * @param len 长度
+ */
+static void dbg_rx_callback(const uint8_t *data, uint32_t len) {
+    ring_fifo_write(dbg_rx, data, len);
+    if (dbg_wakeup != NULL) {
+        dbg_wakeup();
+    }
+}
+
+/**
+ * @brief 发送完成, USB 中断中调用
+ *
+ */
+static void dbg_tx_callback(void) {
+    dbg_frame_t *frame = &dbg_frames[dbg_frame_send];
+
+    if (frame->state == FRAME_SENDING) {
+        frame->state = FRAME_FREE;
+        dbg_frame_send = (dbg_frame_send + 1) % EEZ_DEBUGGER_FRAME_NUM;
+    }
+    dbg_kick();
+}
+
+/**
+ * @brief 初始化, 在 ui_init 之前调用
+ *
+ * @param wakeup_from_isr 收到命令时在中断中调用, 用来唤醒 GUI 任务, 可以为 NULL
+ */
+void eez_debugger_init(void (*wakeup_from_isr)(void)) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    LZ4_resetStream(&dbg_lz4);
+    dbg_rx = ring_fifo_init(dbg_rx_buf, EEZ_DEBUGGER_RX_SIZE, RF_TYPE_STREAM);
+    if (dbg_rx == NULL) {
+        /* 不安装钩子和 USB 回调, 调试器保持关闭, 流程照常运行 */
+        printf("eez_debugger: rx fifo init failed, debugger disabled\r\n");
+        return;
+    }
+    dbg_wakeup = wakeup_from_isr;
+
+    eez::flow::startToDebuggerMessageHook = dbg_start_message;
+    eez::flow::writeDebuggerBufferHook = dbg_write;
+    eez::flow::finishToDebuggerMessageHook = dbg_finish_message;
+    eez::flow::isDebuggerBusyHook = dbg_is_busy;
+
+    usb_cdc_set_rx_callback(dbg_rx_callback);
+    usb_cdc_set_tx_callback(dbg_tx_callback);
+}
+
+/**
+ * @brief 获取统计
+ *
+ * @param stat 统计
+ */
+void eez_debugger_get_stat(eez_debugger_stat_t *stat) {
+    *stat = dbg_stat;
+}
+
+#endif /* EEZ_DEBUGGER_CDC */
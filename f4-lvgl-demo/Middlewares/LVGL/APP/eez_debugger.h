@@ -0,0 +1,81 @@
+/**
+ * @file    eez_debugger.h
+ * @author  Deadline039
+ * @brief   EEZ Flow 调试器的 USB CDC 传输
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * EEZ Flow 的调试消息是文本, 每个值单独写出. 这里把一次 tick 产生的消息
+ * 收集起来, 用 LZ4 压缩后作为一帧发送, 一帧是一次 USB 批量传输:
+ *
+ *   "EF"            魔数
+ *   uint8_t         标志, EEZ_DEBUGGER_FLAG_xxx
+ *   uint8_t         序号, 每帧加 1, 连接后从 0 开始
+ *   uint16_t        压缩前的长度
+ *   uint16_t        数据长度
+ *   数据            LZ4 块, 压缩后没有变小时为原文
+ *
+ * 多字节数据为小端. 电脑发来的命令 (很短) 直接是原来的文本协议. 电脑打开
+ * 串口 (DTR 有效) 时连接, 关闭时断开. Tools/flow_debug_bridge 在电脑上
+ * 解码并通过 TCP 转发给 EEZ Studio.
+ *
+ * 发送缓冲区全部被占用时, tick 不再执行任务, 等待发送完成, LVGL 不受影响.
+ * 一次 tick 的消息超过缓冲区时丢弃, 下一帧带有 EEZ_DEBUGGER_FLAG_LOST.
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#ifndef __EEZ_DEBUGGER_H
+#define __EEZ_DEBUGGER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* 使用 USB CDC 连接 EEZ Studio 调试器 */
+#define EEZ_DEBUGGER_CDC         0
+
+#if EEZ_DEBUGGER_CDC
+/* 一帧最多的消息长度 (压缩前) */
+#define EEZ_DEBUGGER_BATCH_SIZE  4096
+/* 帧缓冲区数量, 一个发送时其他的继续填充 */
+#define EEZ_DEBUGGER_FRAME_NUM   2
+/* 接收缓冲区大小, 必须为 2 的幂 */
+#define EEZ_DEBUGGER_RX_SIZE     256
+#endif /* EEZ_DEBUGGER_CDC */
+
+#define EEZ_DEBUGGER_MAGIC       "EF"
+#define EEZ_DEBUGGER_HEADER_SIZE 8
+/* 数据为 LZ4 块 */
+#define EEZ_DEBUGGER_FLAG_LZ4    0x01U
+/* 这一帧之前有消息被丢弃 */
+#define EEZ_DEBUGGER_FLAG_LOST   0x02U
+
+/**
+ * @brief 统计
+ */
+typedef struct {
+    uint32_t connected;   /*!< 调试器已连接 */
+    uint32_t text_bytes;  /*!< 消息总长度 (压缩前) */
+    uint32_t sent_bytes;  /*!< 发送的总长度 (含帧头) */
+    uint32_t frames;      /*!< 发送的帧数 */
+    uint32_t lost_bytes;  /*!< 丢弃的消息长度 */
+    uint32_t busy_ticks;  /*!< 因为发送缓冲区满而提前结束的 tick */
+    uint32_t tick_cycles; /*!< 上一次 tick 中传输 (收集, 压缩, 发送) 的周期数 */
+    uint32_t max_cycles;  /*!< tick_cycles 的最大值 */
+} eez_debugger_stat_t;
+
+#if EEZ_DEBUGGER_CDC
+void eez_debugger_init(void (*wakeup_from_isr)(void));
+void eez_debugger_get_stat(eez_debugger_stat_t *stat);
+#endif /* EEZ_DEBUGGER_CDC */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EEZ_DEBUGGER_H */
@@ -12,6 +12,7 @@
  *********************/
 
 #include "lv_port_disp.h"
+#include "lv_port_prof.h"
 #include <lvgl.h>
 
 #include <bsp.h>
@@ -230,7 +231,11 @@ void lv_port_disp_init(void) {
     // disp_drv.gpu_fill_cb = gpu_fill;
 
     /* 注册显示设备 */
+#if LV_PORT_PROF
+    lv_port_prof_init(lv_disp_drv_register(&disp_drv));
+#else  /* LV_PORT_PROF */
     lv_disp_drv_register(&disp_drv);
+#endif /* LV_PORT_PROF */
 }
 
 #if LV_USE_DMA2D_IT
@@ -253,6 +258,7 @@ static void dma2d_cplt_callback(DMA2D_HandleTypeDef *hdma2d) {
     /* 刷新显示设备 */
     if (lv_gpu_state == 1) {
         lv_gpu_state = 0;
+        LV_PORT_PROF_FLUSH_READY();
         lv_disp_flush_ready(&disp_drv);
     }
 }
@@ -292,6 +298,14 @@ static void disp_init(void) {
 static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area,
                        lv_color_t *color_p) {
 #if LV_USE_DMA2D_IT
+    if (lcdltdc.dir != 1) {
+        /* 中断传输不做旋转, 其他方向由 lcd_color_fill 完成旋转后同步刷新 */
+        lcd_color_fill(area->x1, area->y1, area->x2, area->y2,
+                       (uint16_t *)color_p);
+        lv_disp_flush_ready(disp_drv);
+        return;
+    }
+
     uint32_t off_line_src = lcddev.width - (area->x2 - area->x1 + 1);
     uint32_t addr =
         LTDC_FRAME_BUF_ADDR + 2 * (lcddev.width * area->y1 + area->x1);
@@ -318,7 +332,7 @@ static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area,
     DMA2D->CR |= DMA2D_CR_START;
     lv_gpu_state = 1;
 #else  /* LV_USE_DMA2D_IT */
-    /* 在指定区域内填充指定颜色块 */
+    /* 在指定区域内填充指定颜色块, RGB 屏在任意方向下都由驱动完成旋转 */
     lcd_color_fill(area->x1, area->y1, area->x2, area->y2, (uint16_t *)color_p);
     /* MCU 屏幕可以使用下面的方式加速 */
     // lcd_draw_fast_rgb_color(area->x1,area->y1,area->x2,area->y2,(uint16_t*)color_p);
@@ -0,0 +1,711 @@
+/**
+ * @file lv_port_fs.c
+ *
+ */
+
+/* Copy this file as "lv_port_fs.c" and set this value to "1" to enable content
+ */
+#if 1
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_port_fs.h"
+#include <lvgl.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "ff.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#if (LV_PORT_FS_BUF_SIZE % FF_MAX_SS) != 0
+#error "LV_PORT_FS_BUF_SIZE must be a multiple of the sector size"
+#endif /* LV_PORT_FS_BUF_SIZE % FF_MAX_SS */
+
+#ifdef DEBUG
+#define LV_FS_DBG(...)                                                         \
+    do {                                                                       \
+        printf(__VA_ARGS__);                                                   \
+        printf("\n");                                                          \
+    } while (0)
+#else /* DEBUG */
+#define LV_FS_DBG(...)
+#endif /* DEBUG */
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**
+ * @brief 簇链映射表缓存
+ * @note 图片解码器获取信息和解码时会反复打开同一个文件, 而建立映射表需要遍历
+ *       整条 FAT 簇链. 映射表以完整路径的哈希为键保留下来, 重新打开时用起始簇
+ *       和文件大小判断文件是否被修改过 (例如 USB 读卡器写入)
+ */
+typedef struct {
+    uint32_t hash;     /*!< 完整路径的哈希, 0 表示空闲 */
+    DWORD sclust;      /*!< 文件起始簇 */
+    FSIZE_t size;      /*!< 文件大小 */
+    uint32_t last_use; /*!< 最近使用的时间戳, 用于 LRU 替换 */
+    uint8_t ref;       /*!< 正在使用此映射表的文件数量 */
+    uint8_t valid;     /*!< 1: 映射表可用; 0: 文件碎片太多, 不使用快速定位 */
+    DWORD tbl[LV_PORT_FS_CLMT_SIZE]; /*!< 簇链映射表 */
+} fs_map_t;
+
+/**
+ * @brief 文件句柄
+ */
+typedef struct {
+    FIL fil;            /*!< FatFs 文件对象 */
+    uint8_t *buf;       /*!< 预读缓冲区 */
+    uint32_t buf_start; /*!< 缓冲区第一个字节的文件偏移, 按缓冲区大小对齐 */
+    uint32_t buf_len;   /*!< 缓冲区中的有效字节数, 0 表示缓冲区无效 */
+    uint32_t pos;       /*!< 当前读写位置 */
+    fs_map_t *map;      /*!< 使用的簇链映射表, 只读打开时有效 */
+    uint8_t used;       /*!< 是否已被占用 */
+} fs_file_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void fs_init(void);
+static void fs_drv_register(lv_fs_drv_t *drv, char letter, const char *vol);
+
+static void *fs_open(lv_fs_drv_t *drv, const char *path, lv_fs_mode_t mode);
+static lv_fs_res_t fs_close(lv_fs_drv_t *drv, void *file_p);
+static lv_fs_res_t fs_read(lv_fs_drv_t *drv, void *file_p, void *buf,
+                           uint32_t btr, uint32_t *br);
+static lv_fs_res_t fs_write(lv_fs_drv_t *drv, void *file_p, const void *buf,
+                            uint32_t btw, uint32_t *bw);
+static lv_fs_res_t fs_seek(lv_fs_drv_t *drv, void *file_p, uint32_t pos,
+                           lv_fs_whence_t whence);
+static lv_fs_res_t fs_tell(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p);
+static void *fs_dir_open(lv_fs_drv_t *drv, const char *path);
+static lv_fs_res_t fs_dir_read(lv_fs_drv_t *drv, void *dir_p, char *fn);
+static lv_fs_res_t fs_dir_close(lv_fs_drv_t *drv, void *dir_p);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+static FATFS fs_nand;
+static FATFS fs_sd;
+
+static lv_fs_drv_t fs_drv_nand;
+static lv_fs_drv_t fs_drv_sd;
+
+static fs_file_t fs_files[LV_PORT_FS_FILE_NUM];
+static fs_map_t fs_maps[LV_PORT_FS_MAP_NUM];
+static uint32_t fs_map_clock;
+
+static SemaphoreHandle_t fs_mutex;
+static lv_port_fs_stat_t fs_stat;
+
+/**
+ * 预读缓冲区放在外部 SDRAM, 跳过 LTDC 显存和 LVGL 全尺寸缓冲区
+ * (0xC0000000 ~ 0xC080E800). 地址按扇区对齐, FatFs 整扇区读取时直接写入
+ */
+#if (__ARMCC_VERSION >= 6010050) /* 使用 AC6 编译器 */
+static uint8_t fs_buf[LV_PORT_FS_FILE_NUM][LV_PORT_FS_BUF_SIZE]
+    __attribute__((section(".bss.ARM.__at_0XC0A00000")));
+#else /* 使用 AC5 编译器 */
+static uint8_t fs_buf[LV_PORT_FS_FILE_NUM][LV_PORT_FS_BUF_SIZE]
+    __attribute__((at(0XC0A00000)));
+#endif /* __ARMCC_VERSION */
+
+/**********************
+ *      MACROS
+ **********************/
+
+#define fs_lock()   xSemaphoreTake(fs_mutex, portMAX_DELAY)
+#define fs_unlock() xSemaphoreGive(fs_mutex)
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * @brief 初始化文件系统并注册 NAND 和 SD 卡两个盘符
+ *
+ * @note 需要在调度器启动后, lv_init() 之后调用
+ */
+void lv_port_fs_init(void) {
+    /*----------------------------------------------------
+     * 初始化存储设备和文件系统
+     * -------------------------------------------------*/
+    fs_init();
+
+    /*---------------------------------------------------
+     * 在 LVGL 中注册文件系统接口
+     *--------------------------------------------------*/
+    fs_drv_register(&fs_drv_nand, LV_PORT_FS_NAND_LETTER, "0:");
+    fs_drv_register(&fs_drv_sd, LV_PORT_FS_SD_LETTER, "1:");
+}
+
+/**
+ * @brief 获取读取统计
+ *
+ * @param[out] stat 统计信息
+ */
+void lv_port_fs_get_stat(lv_port_fs_stat_t *stat) {
+    if (stat == NULL) {
+        return;
+    }
+
+    fs_lock();
+    *stat = fs_stat;
+    fs_unlock();
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * @brief 挂载 NAND 和 SD 卡, 初始化文件句柄
+ *
+ */
+static void fs_init(void) {
+    FRESULT res;
+
+    fs_mutex = xSemaphoreCreateMutex();
+
+    for (uint32_t i = 0; i < LV_PORT_FS_FILE_NUM; ++i) {
+        fs_files[i].buf = fs_buf[i];
+    }
+
+    res = f_mount(&fs_nand, "0:", 1);
+    if (res == FR_OK) {
+        LV_FS_DBG("NAND flash mount success. ");
+    } else if (res == FR_NO_FILESYSTEM) {
+        LV_FS_DBG("No file system in NAND flash. Formatting... ");
+        res = f_mkfs("0:", NULL, NULL, FF_MAX_SS);
+
+        if (res == FR_OK) {
+            f_setlabel((const TCHAR *)"0:STM32 NAND");
+            LV_FS_DBG("NAND flash format finish. ");
+        } else {
+            LV_FS_DBG("NAND flash format failed. ");
+        }
+    } else {
+        LV_FS_DBG("NAND flash mount failed. ");
+    }
+
+    /* SD 卡是用户的存储介质, 没有文件系统时不自动格式化 */
+    res = f_mount(&fs_sd, "1:", 1);
+    if (res == FR_OK) {
+        LV_FS_DBG("SD card mount success. ");
+    } else {
+        LV_FS_DBG("No SD card. ");
+    }
+}
+
+/**
+ * @brief 注册一个盘符
+ *
+ * @param drv 驱动描述符
+ * @param letter 盘符
+ * @param vol FatFs 卷号字符串, 例如 "0:"
+ */
+static void fs_drv_register(lv_fs_drv_t *drv, char letter, const char *vol) {
+    lv_fs_drv_init(drv);
+
+    drv->letter = letter;
+    /* 驱动自己做预读, 不使用 LVGL 的缓存 */
+    drv->cache_size = 0;
+    drv->user_data = (void *)vol;
+
+    drv->open_cb = fs_open;
+    drv->close_cb = fs_close;
+    drv->read_cb = fs_read;
+    drv->write_cb = fs_write;
+    drv->seek_cb = fs_seek;
+    drv->tell_cb = fs_tell;
+
+    drv->dir_close_cb = fs_dir_close;
+    drv->dir_open_cb = fs_dir_open;
+    drv->dir_read_cb = fs_dir_read;
+
+    lv_fs_drv_register(drv);
+}
+
+/**
+ * @brief 拼接 FatFs 完整路径
+ *
+ * @param drv 驱动描述符
+ * @param path LVGL 传入的路径 (已去掉盘符)
+ * @param[out] full 完整路径, 长度为 `LV_PORT_FS_PATH_MAX`
+ * @return 拼接结果
+ * @retval - 0: 成功
+ * @retval - 1: 路径过长
+ */
+static uint8_t fs_make_path(lv_fs_drv_t *drv, const char *path, char *full) {
+    const char *vol = (const char *)drv->user_data;
+    size_t vol_len = strlen(vol);
+    size_t path_len = strlen(path);
+
+    if (vol_len + 1 + path_len + 1 > LV_PORT_FS_PATH_MAX) {
+        return 1;
+    }
+
+    memcpy(full, vol, vol_len);
+    full[vol_len] = '/';
+    memcpy(&full[vol_len + 1], path, path_len + 1);
+    return 0;
+}
+
+/**
+ * @brief 计算路径哈希 (FNV-1a)
+ *
+ * @param str 完整路径
+ * @return 哈希值, 不会为 0
+ */
+static uint32_t fs_hash(const char *str) {
+    uint32_t hash = 2166136261U;
+
+    while (*str != '\0') {
+        hash ^= (uint8_t)*str++;
+        hash *= 16777619U;
+    }
+
+    return (hash == 0) ? 1 : hash;
+}
+
+/**
+ * @brief 为只读打开的文件找到或建立簇链映射表
+ *
+ * @param file 文件句柄
+ * @param hash 完整路径的哈希
+ */
+static void fs_map_attach(fs_file_t *file, uint32_t hash) {
+    fs_map_t *victim = NULL;
+    fs_map_t *map;
+
+    file->map = NULL;
+
+    if (file->fil.obj.sclust == 0) {
+        /* 空文件没有簇链 */
+        return;
+    }
+
+    for (uint32_t i = 0; i < LV_PORT_FS_MAP_NUM; ++i) {
+        map = &fs_maps[i];
+
+        if (map->hash == hash && map->sclust == file->fil.obj.sclust &&
+            map->size == file->fil.obj.objsize) {
+            map->ref++;
+            map->last_use = ++fs_map_clock;
+            file->map = map;
+            if (map->valid) {
+                file->fil.cltbl = map->tbl;
+            }
+            fs_stat.map_hit++;
+            return;
+        }
+
+        if (map->ref == 0 &&
+            (victim == NULL || map->last_use < victim->last_use)) {
+            victim = map;
+        }
+    }
+
+    if (victim == NULL) {
+        /* 所有映射表都在使用, 这个文件使用普通定位 */
+        return;
+    }
+
+    victim->hash = hash;
+    victim->sclust = file->fil.obj.sclust;
+    victim->size = file->fil.obj.objsize;
+    victim->ref = 1;
+    victim->last_use = ++fs_map_clock;
+    victim->tbl[0] = LV_PORT_FS_CLMT_SIZE;
+
+    file->fil.cltbl = victim->tbl;
+    victim->valid = (f_lseek(&file->fil, CREATE_LINKMAP) == FR_OK);
+    if (!victim->valid) {
+        /* 片段太多, 映射表放不下, 记录下来避免下次再遍历 */
+        file->fil.cltbl = NULL;
+    }
+
+    file->map = victim;
+    fs_stat.map_build++;
+}
+
+/**
+ * @brief 将 FatFs 的读写指针移动到逻辑位置
+ *
+ * @param file 文件句柄
+ * @return FatFs 结果
+ */
+static FRESULT fs_sync_pos(fs_file_t *file) {
+    if (f_tell(&file->fil) == file->pos) {
+        return FR_OK;
+    }
+
+    return f_lseek(&file->fil, file->pos);
+}
+
+/**
+ * @brief 当前位置是否在预读缓冲区中
+ *
+ * @param file 文件句柄
+ * @return 1: 在缓冲区中; 0: 不在
+ */
+static inline uint8_t fs_buf_contains(const fs_file_t *file) {
+    return (file->buf_len != 0 && file->pos >= file->buf_start &&
+            file->pos < file->buf_start + file->buf_len);
+}
+
+/**
+ * @brief 从对齐的位置填充预读缓冲区
+ *
+ * @param file 文件句柄
+ * @return FatFs 结果
+ */
+static FRESULT fs_buf_fill(fs_file_t *file) {
+    uint32_t start = file->pos - (file->pos % LV_PORT_FS_BUF_SIZE);
+    UINT n = 0;
+    FRESULT res = FR_OK;
+
+    file->buf_len = 0;
+
+    if (f_tell(&file->fil) != start) {
+        res = f_lseek(&file->fil, start);
+    }
+
+    if (res == FR_OK) {
+        res = f_read(&file->fil, file->buf, LV_PORT_FS_BUF_SIZE, &n);
+    }
+
+    if (res == FR_OK) {
+        file->buf_start = start;
+        file->buf_len = n;
+        fs_stat.buf_fill++;
+    }
+
+    return res;
+}
+
+/**
+ * @brief 打开文件
+ *
+ * @param drv 驱动描述符
+ * @param path 文件路径 (已去掉盘符)
+ * @param mode 打开模式
+ * @return 文件句柄, 失败返回 NULL
+ */
+static void *fs_open(lv_fs_drv_t *drv, const char *path, lv_fs_mode_t mode) {
+    char full[LV_PORT_FS_PATH_MAX];
+    fs_file_t *file = NULL;
+    BYTE flags = 0;
+
+    if (mode == LV_FS_MODE_WR) {
+        flags = FA_WRITE | FA_OPEN_ALWAYS;
+    } else if (mode == LV_FS_MODE_RD) {
+        flags = FA_READ;
+    } else if (mode == (LV_FS_MODE_WR | LV_FS_MODE_RD)) {
+        flags = FA_READ | FA_WRITE | FA_OPEN_ALWAYS;
+    }
+
+    if (fs_make_path(drv, path, full) != 0) {
+        return NULL;
+    }
+
+    fs_lock();
+
+    for (uint32_t i = 0; i < LV_PORT_FS_FILE_NUM; ++i) {
+        if (fs_files[i].used == 0) {
+            file = &fs_files[i];
+            break;
+        }
+    }
+
+    if (file != NULL && f_open(&file->fil, full, flags) == FR_OK) {
+        file->used = 1;
+        file->pos = 0;
+        file->buf_start = 0;
+        file->buf_len = 0;
+        file->map = NULL;
+
+        /* 快速定位模式下文件不能扩展, 只对只读文件使用 */
+        if (mode == LV_FS_MODE_RD) {
+            fs_map_attach(file, fs_hash(full));
+        }
+    } else {
+        file = NULL;
+    }
+
+    fs_unlock();
+
+    return file;
+}
+
+/**
+ * @brief 关闭文件
+ *
+ * @param drv 驱动描述符
+ * @param file_p 文件句柄
+ * @return 操作结果
+ */
+static lv_fs_res_t fs_close(lv_fs_drv_t *drv, void *file_p) {
+    LV_UNUSED(drv);
+    fs_file_t *file = (fs_file_t *)file_p;
+    FRESULT res;
+
+    fs_lock();
+
+    res = f_close(&file->fil);
+    if (file->map != NULL) {
+        file->map->ref--;
+        file->map = NULL;
+    }
+    file->used = 0;
+
+    fs_unlock();
+
+    return (res == FR_OK) ? LV_FS_RES_OK : LV_FS_RES_UNKNOWN;
+}
+
+/**
+ * @brief 读取文件
+ *
+ * @param drv 驱动描述符
+ * @param file_p 文件句柄
+ * @param buf 读取缓冲区
+ * @param btr 要读取的字节数
+ * @param[out] br 实际读取的字节数
+ * @return 操作结果
+ * @note 小块读取 (图片头, 按行解码) 由对齐的预读缓冲区满足, 大于缓冲区的读取
+ *       直接读入目标缓冲区, 整扇区部分由 FatFs 一次多扇区读取
+ */
+static lv_fs_res_t fs_read(lv_fs_drv_t *drv, void *file_p, void *buf,
+                           uint32_t btr, uint32_t *br) {
+    LV_UNUSED(drv);
+    fs_file_t *file = (fs_file_t *)file_p;
+    uint8_t *dst = (uint8_t *)buf;
+    FRESULT res = FR_OK;
+    uint32_t ofs, n;
+    UINT rd;
+
+    *br = 0;
+
+    fs_lock();
+
+    while (btr > 0) {
+        if (fs_buf_contains(file)) {
+            fs_stat.buf_hit++;
+        } else if (btr >= LV_PORT_FS_BUF_SIZE) {
+            res = fs_sync_pos(file);
+            if (res == FR_OK) {
+                res = f_read(&file->fil, dst, btr, &rd);
+            }
+            if (res == FR_OK) {
+                file->pos += rd;
+                *br += rd;
+                fs_stat.direct++;
+            }
+            break;
+        } else {
+            res = fs_buf_fill(file);
+            if (res != FR_OK || !fs_buf_contains(file)) {
+                /* 出错或到达文件末尾 */
+                break;
+            }
+        }
+
+        ofs = file->pos - file->buf_start;
+        n = LV_MIN(btr, file->buf_len - ofs);
+        memcpy(dst, &file->buf[ofs], n);
+
+        dst += n;
+        btr -= n;
+        file->pos += n;
+        *br += n;
+    }
+
+    fs_unlock();
+
+    return (res == FR_OK) ? LV_FS_RES_OK : LV_FS_RES_UNKNOWN;
+}
+
+/**
+ * @brief 写入文件
+ *
+ * @param drv 驱动描述符
+ * @param file_p 文件句柄
+ * @param buf 要写入的数据
+ * @param btw 要写入的字节数
+ * @param[out] bw 实际写入的字节数
+ * @return 操作结果
+ */
+static lv_fs_res_t fs_write(lv_fs_drv_t *drv, void *file_p, const void *buf,
+                            uint32_t btw, uint32_t *bw) {
+    LV_UNUSED(drv);
+    fs_file_t *file = (fs_file_t *)file_p;
+    FRESULT res;
+    UINT wr = 0;
+
+    fs_lock();
+
+    /* 写入后预读缓冲区中的数据可能过期 */
+    file->buf_len = 0;
+
+    res = fs_sync_pos(file);
+    if (res == FR_OK) {
+        res = f_write(&file->fil, buf, btw, &wr);
+    }
+    file->pos += wr;
+    *bw = wr;
+
+    fs_unlock();
+
+    return (res == FR_OK) ? LV_FS_RES_OK : LV_FS_RES_UNKNOWN;
+}
+
+/**
+ * @brief 移动读写位置
+ *
+ * @param drv 驱动描述符
+ * @param file_p 文件句柄
+ * @param pos 偏移量
+ * @param whence 偏移的起点
+ * @return 操作结果
+ * @note 只修改逻辑位置, 真正的 f_lseek 在下次读写时按需进行,
+ *       位置落在预读缓冲区内时不访问存储器
+ */
+static lv_fs_res_t fs_seek(lv_fs_drv_t *drv, void *file_p, uint32_t pos,
+                           lv_fs_whence_t whence) {
+    LV_UNUSED(drv);
+    fs_file_t *file = (fs_file_t *)file_p;
+
+    fs_lock();
+
+    switch (whence) {
+        case LV_FS_SEEK_SET:
+            file->pos = pos;
+            break;
+        case LV_FS_SEEK_CUR:
+            file->pos += pos;
+            break;
+        case LV_FS_SEEK_END:
+            file->pos = f_size(&file->fil) + pos;
+            break;
+        default:
+            break;
+    }
+
+    fs_unlock();
+
+    return LV_FS_RES_OK;
+}
+
+/**
+ * @brief 获取读写位置
+ *
+ * @param drv 驱动描述符
+ * @param file_p 文件句柄
+ * @param[out] pos_p 当前位置
+ * @return 操作结果
+ */
+static lv_fs_res_t fs_tell(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p) {
+    LV_UNUSED(drv);
+    *pos_p = ((fs_file_t *)file_p)->pos;
+    return LV_FS_RES_OK;
+}
+
+/**
+ * @brief 打开目录
+ *
+ * @param drv 驱动描述符
+ * @param path 目录路径 (已去掉盘符)
+ * @return 目录句柄, 失败返回 NULL
+ */
+static void *fs_dir_open(lv_fs_drv_t *drv, const char *path) {
+    char full[LV_PORT_FS_PATH_MAX];
+    DIR *d;
+
+    if (fs_make_path(drv, path, full) != 0) {
+        return NULL;
+    }
+
+    d = lv_mem_alloc(sizeof(DIR));
+    if (d == NULL) {
+        return NULL;
+    }
+
+    fs_lock();
+    if (f_opendir(d, full) != FR_OK) {
+        lv_mem_free(d);
+        d = NULL;
+    }
+    fs_unlock();
+
+    return d;
+}
+
+/**
+ * @brief 读取下一个目录项
+ *
+ * @param drv 驱动描述符
+ * @param dir_p 目录句柄
+ * @param[out] fn 文件名, 目录以 '/' 开头, 读完时为空字符串
+ * @return 操作结果
+ */
+static lv_fs_res_t fs_dir_read(lv_fs_drv_t *drv, void *dir_p, char *fn) {
+    LV_UNUSED(drv);
+    FRESULT res;
+    FILINFO fno;
+    fn[0] = '\0';
+
+    fs_lock();
+
+    do {
+        res = f_readdir(dir_p, &fno);
+        if (res != FR_OK) {
+            break;
+        }
+
+        if (fno.fattrib & AM_DIR) {
+            fn[0] = '/';
+            strcpy(&fn[1], fno.fname);
+        } else {
+            strcpy(fn, fno.fname);
+        }
+
+    } while (strcmp(fn, "/.") == 0 || strcmp(fn, "/..") == 0);
+
+    fs_unlock();
+
+    return (res == FR_OK) ? LV_FS_RES_OK : LV_FS_RES_UNKNOWN;
+}
+
+/**
+ * @brief 关闭目录
+ *
+ * @param drv 驱动描述符
+ * @param dir_p 目录句柄
+ * @return 操作结果
+ */
+static lv_fs_res_t fs_dir_close(lv_fs_drv_t *drv, void *dir_p) {
+    LV_UNUSED(drv);
+
+    fs_lock();
+    f_closedir(dir_p);
+    fs_unlock();
+
+    lv_mem_free(dir_p);
+    return LV_FS_RES_OK;
+}
+
+#else /*Enable this file at the top*/
+
+/*This dummy typedef exists purely to silence -Wpedantic.*/
+typedef int keep_pedantic_happy;
+#endif
@@ -4,7 +4,7 @@
  */
 
 /* Copy this file as "lv_port_fs.h" and set this value to "1" to enable content */
-#if 0
+#if 1
 
 #ifndef LV_PORT_FS_H
 #define LV_PORT_FS_H
@@ -22,13 +22,45 @@ extern "C" {
  *      DEFINES
  *********************/
 
+/* NAND Flash (FatFs 卷 "0:") 的盘符, 例如 "N:/img/bg.bin" */
+#define LV_PORT_FS_NAND_LETTER 'N'
+/* SD 卡 (FatFs 卷 "1:") 的盘符, 例如 "S:/img/bg.bin" */
+#define LV_PORT_FS_SD_LETTER   'S'
+
+/* 同时打开的文件数量 */
+#define LV_PORT_FS_FILE_NUM    4
+/* 每个文件的预读缓冲区大小 (字节), 必须是扇区大小 (512) 的整数倍 */
+#define LV_PORT_FS_BUF_SIZE    4096
+/**
+ * 每个簇链映射表的大小 (DWORD 个数), 文件有 n 个不连续的片段时
+ * 需要 2n + 1 个, 片段过多时退回普通的 f_lseek
+ */
+#define LV_PORT_FS_CLMT_SIZE   32
+/* 缓存的簇链映射表数量, 关闭文件后保留, 再次打开同一文件时不用重新遍历 FAT */
+#define LV_PORT_FS_MAP_NUM     8
+/* 完整路径 (含卷号) 的最大长度 */
+#define LV_PORT_FS_PATH_MAX    128
+
 /**********************
  *      TYPEDEFS
  **********************/
 
+/**
+ * @brief 文件系统读取统计
+ */
+typedef struct {
+    uint32_t buf_hit;   /*!< 预读缓冲区命中的读取次数 */
+    uint32_t buf_fill;  /*!< 填充预读缓冲区的次数 */
+    uint32_t direct;    /*!< 绕过缓冲区直接读取的次数 */
+    uint32_t map_hit;   /*!< 复用已缓存簇链映射表的次数 */
+    uint32_t map_build; /*!< 建立簇链映射表的次数 */
+} lv_port_fs_stat_t;
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
+void lv_port_fs_init(void);
+void lv_port_fs_get_stat(lv_port_fs_stat_t *stat);
 
 /**********************
  *      MACROS
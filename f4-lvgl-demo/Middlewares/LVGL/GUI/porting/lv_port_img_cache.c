@@ -0,0 +1,641 @@
+/**
+ * @file lv_port_img_cache.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_port_img_cache.h"
+#include <lvgl.h>
+#include <misc/lv_gc.h>
+
+#include <string.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* 块大小按 8 字节对齐 */
+#define IMG_POOL_ALIGN(x) (((x) + 7U) & ~7U)
+/* 剩余空间小于这个值时不再分割空闲块 */
+#define IMG_POOL_MIN_SPLIT 64U
+
+#define IMG_CACHE_STR_(x)  #x
+#define IMG_CACHE_STR(x)   IMG_CACHE_STR_(x)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**
+ * @brief 缓存池中的内存块头
+ */
+typedef struct {
+    uint32_t size; /*!< 块大小, 含块头 */
+    uint32_t used; /*!< 是否已分配 */
+} img_blk_t;
+
+/**
+ * @brief 缓存的图片
+ */
+typedef struct {
+    const void *src;        /*!< 图片源, 文件路径保存在像素数据之后 */
+    lv_img_src_t src_type;  /*!< 图片源类型 */
+    uint32_t hash;          /*!< 文件路径的哈希, 变量图片不使用 */
+    lv_img_header_t header; /*!< 解码后的图片信息 */
+    uint8_t *data;          /*!< 解码后的像素数据, NULL 表示空闲 */
+    uint32_t last_use;      /*!< 最近使用的时间戳, 用于 LRU 淘汰 */
+    uint16_t ref;           /*!< 正在使用的解码会话数量 */
+    uint16_t pin;           /*!< 固定次数, 大于 0 时不会被淘汰 */
+    uint8_t stale;          /*!< 已失效, 会话全部关闭后释放 */
+} img_entry_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static lv_res_t img_cache_info(lv_img_decoder_t *decoder, const void *src,
+                               lv_img_header_t *header);
+static lv_res_t img_cache_open(lv_img_decoder_t *decoder,
+                               lv_img_decoder_dsc_t *dsc);
+static void img_cache_close(lv_img_decoder_t *decoder,
+                            lv_img_decoder_dsc_t *dsc);
+static img_entry_t *img_cache_find(const void *src, lv_img_src_t src_type);
+static void img_cache_drop(img_entry_t *entry);
+#if LV_PORT_IMG_CACHE_MONITOR
+static void img_cache_monitor_cb(lv_timer_t *timer);
+#endif /* LV_PORT_IMG_CACHE_MONITOR */
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**
+ * 缓存池放在外部 SDRAM, 由 sdram_init() 初始化.
+ * 0xC0000000 ~ 0xC080E800 为显存, 0xC0A00000 起为 lv_port_fs 的预读缓冲区
+ */
+#if (__ARMCC_VERSION >= 6010050) /* 使用 AC6 编译器 */
+static uint8_t img_pool[LV_PORT_IMG_CACHE_SIZE] __attribute__((
+    section(".bss.ARM.__at_" IMG_CACHE_STR(LV_PORT_IMG_CACHE_ADDR))));
+#else /* 使用 AC5 编译器 */
+static uint8_t img_pool[LV_PORT_IMG_CACHE_SIZE]
+    __attribute__((at(LV_PORT_IMG_CACHE_ADDR)));
+#endif /* __ARMCC_VERSION */
+
+static img_entry_t img_entries[LV_PORT_IMG_CACHE_ENTRY_NUM];
+static uint32_t img_clock;
+static lv_img_decoder_t *img_decoder;
+static lv_port_img_cache_stat_t img_stat;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * @brief 初始化图片缓存并注册解码器
+ *
+ * @note 需要在 lv_port_disp_init() 之后, 其他图片解码器注册之后调用,
+ *       保证缓存解码器位于解码器链表的最前面
+ */
+void lv_port_img_cache_init(void) {
+    img_blk_t *blk = (img_blk_t *)img_pool;
+
+    blk->size = LV_PORT_IMG_CACHE_SIZE;
+    blk->used = 0;
+
+    img_stat.total_bytes = LV_PORT_IMG_CACHE_SIZE;
+
+    img_decoder = lv_img_decoder_create();
+    lv_img_decoder_set_info_cb(img_decoder, img_cache_info);
+    lv_img_decoder_set_open_cb(img_decoder, img_cache_open);
+    lv_img_decoder_set_close_cb(img_decoder, img_cache_close);
+
+#if LV_PORT_IMG_CACHE_MONITOR
+    lv_obj_t *label = lv_label_create(lv_layer_sys());
+    lv_obj_set_style_bg_opa(label, LV_OPA_50, 0);
+    lv_obj_set_style_bg_color(label, lv_color_black(), 0);
+    lv_obj_set_style_text_color(label, lv_color_white(), 0);
+    lv_obj_set_style_pad_all(label, 3, 0);
+    lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_RIGHT, 0);
+    lv_label_set_text(label, "?");
+    lv_obj_align(label, LV_PORT_IMG_CACHE_MONITOR_POS,
+                 LV_PORT_IMG_CACHE_MONITOR_OFS_X, 0);
+    lv_timer_create(img_cache_monitor_cb, 500, label);
+#endif /* LV_PORT_IMG_CACHE_MONITOR */
+}
+
+/**
+ * @brief 固定图片, 固定的图片不会被淘汰
+ *
+ * @param src 图片源
+ * @return LV_RES_OK: 成功; LV_RES_INV: 图片无法缓存
+ * @note 未缓存时会立即解码. 用于常驻屏幕的背景等图片, 与
+ *       lv_port_img_cache_unpin() 成对调用
+ */
+lv_res_t lv_port_img_cache_pin(const void *src) {
+    lv_img_decoder_dsc_t dsc;
+    lv_res_t res = LV_RES_INV;
+
+    if (lv_img_decoder_open(&dsc, src, lv_color_black(), 0) != LV_RES_OK) {
+        return LV_RES_INV;
+    }
+
+    if (dsc.decoder == img_decoder) {
+        ((img_entry_t *)dsc.user_data)->pin++;
+        res = LV_RES_OK;
+    }
+
+    lv_img_decoder_close(&dsc);
+    return res;
+}
+
+/**
+ * @brief 取消固定图片
+ *
+ * @param src 图片源
+ */
+void lv_port_img_cache_unpin(const void *src) {
+    img_entry_t *entry = img_cache_find(src, lv_img_src_get_type(src));
+
+    if (entry != NULL && entry->pin > 0) {
+        entry->pin--;
+    }
+}
+
+/**
+ * @brief 使缓存的图片失效
+ *
+ * @param src 图片源, NULL 表示全部图片
+ * @note 文件被修改 (例如通过 USB 写入) 后调用. 正在绘制的图片在会话关闭后释放
+ */
+void lv_port_img_cache_invalidate(const void *src) {
+    img_entry_t *entry;
+
+    if (src != NULL) {
+        entry = img_cache_find(src, lv_img_src_get_type(src));
+        if (entry == NULL) {
+            return;
+        }
+
+        if (entry->ref == 0) {
+            img_cache_drop(entry);
+        } else {
+            entry->stale = 1;
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < LV_PORT_IMG_CACHE_ENTRY_NUM; ++i) {
+        entry = &img_entries[i];
+
+        if (entry->data == NULL) {
+            continue;
+        }
+
+        if (entry->ref == 0) {
+            img_cache_drop(entry);
+        } else {
+            entry->stale = 1;
+        }
+    }
+}
+
+/**
+ * @brief 获取缓存统计
+ *
+ * @param[out] stat 统计信息
+ */
+void lv_port_img_cache_get_stat(lv_port_img_cache_stat_t *stat) {
+    if (stat != NULL) {
+        *stat = img_stat;
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * @brief 从缓存池分配内存
+ *
+ * @param size 要分配的字节数
+ * @return 分配的内存, 空间不足返回 NULL
+ * @note 首次适配, 扫描时合并相邻的空闲块
+ */
+static void *img_pool_alloc(uint32_t size) {
+    uint32_t need = IMG_POOL_ALIGN(size) + sizeof(img_blk_t);
+    uint8_t *p = img_pool;
+    uint8_t *end = img_pool + LV_PORT_IMG_CACHE_SIZE;
+    img_blk_t *blk, *next;
+
+    while (p < end) {
+        blk = (img_blk_t *)p;
+
+        if (blk->used == 0) {
+            while (p + blk->size < end) {
+                next = (img_blk_t *)(p + blk->size);
+                if (next->used) {
+                    break;
+                }
+                blk->size += next->size;
+            }
+
+            if (blk->size >= need) {
+                if (blk->size - need >= IMG_POOL_MIN_SPLIT) {
+                    next = (img_blk_t *)(p + need);
+                    next->size = blk->size - need;
+                    next->used = 0;
+                    blk->size = need;
+                }
+
+                blk->used = 1;
+                img_stat.used_bytes += blk->size;
+                return blk + 1;
+            }
+        }
+
+        p += blk->size;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 释放缓存池中的内存
+ *
+ * @param ptr 要释放的内存
+ */
+static void img_pool_free(void *ptr) {
+    img_blk_t *blk = (img_blk_t *)ptr - 1;
+
+    img_stat.used_bytes -= blk->size;
+    blk->used = 0;
+}
+
+/**
+ * @brief 计算文件路径哈希 (FNV-1a)
+ *
+ * @param str 文件路径
+ * @return 哈希值
+ */
+static uint32_t img_cache_hash(const char *str) {
+    uint32_t hash = 2166136261U;
+
+    while (*str != '\0') {
+        hash ^= (uint8_t)*str++;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief 查找缓存的图片
+ *
+ * @param src 图片源
+ * @param src_type 图片源类型
+ * @return 缓存项, 未缓存返回 NULL
+ */
+static img_entry_t *img_cache_find(const void *src, lv_img_src_t src_type) {
+    uint32_t hash = 0;
+    img_entry_t *entry;
+
+    if (src_type == LV_IMG_SRC_FILE) {
+        hash = img_cache_hash((const char *)src);
+    }
+
+    for (uint32_t i = 0; i < LV_PORT_IMG_CACHE_ENTRY_NUM; ++i) {
+        entry = &img_entries[i];
+
+        if (entry->data == NULL || entry->stale ||
+            entry->src_type != src_type) {
+            continue;
+        }
+
+        if (src_type == LV_IMG_SRC_VARIABLE) {
+            if (entry->src == src) {
+                return entry;
+            }
+        } else if (entry->hash == hash &&
+                   strcmp((const char *)entry->src, (const char *)src) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 释放缓存项
+ *
+ * @param entry 缓存项
+ */
+static void img_cache_drop(img_entry_t *entry) {
+    img_pool_free(entry->data);
+    lv_memset_00(entry, sizeof(img_entry_t));
+    img_stat.entry_num--;
+}
+
+/**
+ * @brief 淘汰最久未使用且未被固定的图片
+ *
+ * @return 1: 淘汰了一张图片; 0: 没有可以淘汰的图片
+ */
+static uint8_t img_cache_evict(void) {
+    img_entry_t *victim = NULL;
+    img_entry_t *entry;
+
+    for (uint32_t i = 0; i < LV_PORT_IMG_CACHE_ENTRY_NUM; ++i) {
+        entry = &img_entries[i];
+
+        if (entry->data == NULL || entry->ref != 0 || entry->pin != 0) {
+            continue;
+        }
+
+        if (victim == NULL || entry->last_use < victim->last_use) {
+            victim = entry;
+        }
+    }
+
+    if (victim == NULL) {
+        return 0;
+    }
+
+    img_cache_drop(victim);
+    img_stat.evict++;
+    return 1;
+}
+
+/**
+ * @brief 解码后的格式是否可以缓存
+ *
+ * @param cf 源图片格式
+ * @param src_type 图片源类型
+ * @return true: 可以缓存
+ * @note 变量形式的真彩色图片本身就在内存中, 不需要缓存;
+ *       A1~A8 和索引格式与重新着色相关, 也不缓存
+ */
+static bool img_cache_cf_supported(lv_img_cf_t cf, lv_img_src_t src_type) {
+    switch (cf) {
+        case LV_IMG_CF_TRUE_COLOR:
+        case LV_IMG_CF_TRUE_COLOR_ALPHA:
+        case LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED:
+            return (src_type == LV_IMG_SRC_FILE);
+
+        case LV_IMG_CF_RAW:
+        case LV_IMG_CF_RAW_ALPHA:
+        case LV_IMG_CF_RAW_CHROMA_KEYED:
+            return (src_type == LV_IMG_SRC_FILE ||
+                    src_type == LV_IMG_SRC_VARIABLE);
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief 在其他解码器中查找能解码此图片的解码器
+ *
+ * @param src 图片源
+ * @param[out] header 图片信息
+ * @return 解码器, 没有找到返回 NULL
+ */
+static lv_img_decoder_t *img_cache_find_decoder(const void *src,
+                                                lv_img_header_t *header) {
+    lv_img_decoder_t *decoder;
+
+    _LV_LL_READ(&LV_GC_ROOT(_lv_img_decoder_ll), decoder) {
+        if (decoder == img_decoder || decoder->info_cb == NULL ||
+            decoder->open_cb == NULL) {
+            continue;
+        }
+
+        if (decoder->info_cb(decoder, src, header) == LV_RES_OK) {
+            return decoder;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 用其他解码器完整解码图片并加入缓存
+ *
+ * @param dsc 解码描述符
+ * @return 缓存项, 失败返回 NULL
+ */
+static img_entry_t *img_cache_load(lv_img_decoder_dsc_t *dsc) {
+    lv_img_decoder_dsc_t inner;
+    lv_img_decoder_t *decoder;
+    img_entry_t *entry = NULL;
+    uint32_t px_size, line_size, data_size, path_len = 0;
+    uint8_t *data = NULL;
+    lv_res_t res = LV_RES_OK;
+
+    lv_memset_00(&inner, sizeof(inner));
+    inner.src = dsc->src;
+    inner.src_type = dsc->src_type;
+    inner.color = dsc->color;
+    inner.frame_id = dsc->frame_id;
+
+    decoder = img_cache_find_decoder(dsc->src, &inner.header);
+    if (decoder == NULL) {
+        return NULL;
+    }
+    inner.decoder = decoder;
+
+    px_size = lv_img_cf_has_alpha(inner.header.cf) ? LV_IMG_PX_SIZE_ALPHA_BYTE
+                                                    : (LV_COLOR_SIZE / 8);
+    line_size = inner.header.w * px_size;
+    data_size = line_size * inner.header.h;
+    if (dsc->src_type == LV_IMG_SRC_FILE) {
+        path_len = strlen((const char *)dsc->src) + 1;
+    }
+
+    /* 超过整个缓存池的图片不缓存, 交给原解码器逐行解码 */
+    if (data_size == 0 ||
+        IMG_POOL_ALIGN(data_size + path_len) + sizeof(img_blk_t) >
+            LV_PORT_IMG_CACHE_SIZE) {
+        return NULL;
+    }
+
+    /* 先找空闲的缓存项, 再分配像素内存, 空间不足时淘汰旧图片 */
+    for (;;) {
+        for (uint32_t i = 0; i < LV_PORT_IMG_CACHE_ENTRY_NUM; ++i) {
+            if (img_entries[i].data == NULL) {
+                entry = &img_entries[i];
+                break;
+            }
+        }
+        if (entry != NULL || img_cache_evict() == 0) {
+            break;
+        }
+    }
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    for (;;) {
+        data = img_pool_alloc(data_size + path_len);
+        if (data != NULL || img_cache_evict() == 0) {
+            break;
+        }
+    }
+    if (data == NULL) {
+        return NULL;
+    }
+
+    if (decoder->open_cb(decoder, &inner) != LV_RES_OK) {
+        img_pool_free(data);
+        return NULL;
+    }
+
+    if (inner.img_data != NULL) {
+        /* 解码器给出了整张图片 (通常在 LVGL 堆中), 复制到 SDRAM */
+        lv_memcpy(data, inner.img_data, data_size);
+    } else if (decoder->read_line_cb != NULL) {
+        for (lv_coord_t y = 0; y < inner.header.h && res == LV_RES_OK; ++y) {
+            res = decoder->read_line_cb(decoder, &inner, 0, y, inner.header.w,
+                                        &data[y * line_size]);
+        }
+    } else {
+        res = LV_RES_INV;
+    }
+
+    if (decoder->close_cb != NULL) {
+        decoder->close_cb(decoder, &inner);
+    }
+
+    if (res != LV_RES_OK) {
+        img_pool_free(data);
+        return NULL;
+    }
+
+    entry->data = data;
+    entry->header = inner.header;
+    entry->src_type = dsc->src_type;
+    if (dsc->src_type == LV_IMG_SRC_FILE) {
+        memcpy(&data[data_size], dsc->src, path_len);
+        entry->src = &data[data_size];
+        entry->hash = img_cache_hash((const char *)dsc->src);
+    } else {
+        entry->src = dsc->src;
+    }
+
+    /* 缓存中保存的是解码后的真彩色数据 */
+    if (lv_img_cf_is_chroma_keyed(inner.header.cf)) {
+        entry->header.cf = LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED;
+    } else if (lv_img_cf_has_alpha(inner.header.cf)) {
+        entry->header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+    } else {
+        entry->header.cf = LV_IMG_CF_TRUE_COLOR;
+    }
+
+    img_stat.entry_num++;
+    return entry;
+}
+
+/**
+ * @brief 获取图片信息
+ *
+ * @param decoder 解码器
+ * @param src 图片源
+ * @param[out] header 图片信息
+ * @return LV_RES_OK: 可以由缓存解码器处理; LV_RES_INV: 交给其他解码器
+ */
+static lv_res_t img_cache_info(lv_img_decoder_t *decoder, const void *src,
+                               lv_img_header_t *header) {
+    LV_UNUSED(decoder);
+    lv_img_src_t src_type = lv_img_src_get_type(src);
+    img_entry_t *entry;
+
+    if (src_type != LV_IMG_SRC_FILE && src_type != LV_IMG_SRC_VARIABLE) {
+        return LV_RES_INV;
+    }
+
+    /* 命中时不访问文件 */
+    entry = img_cache_find(src, src_type);
+    if (entry != NULL) {
+        *header = entry->header;
+        return LV_RES_OK;
+    }
+
+    if (img_cache_find_decoder(src, header) == NULL ||
+        !img_cache_cf_supported(header->cf, src_type)) {
+        return LV_RES_INV;
+    }
+
+    return LV_RES_OK;
+}
+
+/**
+ * @brief 打开图片, 未缓存时完整解码一次
+ *
+ * @param decoder 解码器
+ * @param dsc 解码描述符
+ * @return LV_RES_OK: 成功; LV_RES_INV: 无法缓存, 交给其他解码器
+ */
+static lv_res_t img_cache_open(lv_img_decoder_t *decoder,
+                               lv_img_decoder_dsc_t *dsc) {
+    LV_UNUSED(decoder);
+    img_entry_t *entry;
+
+    entry = img_cache_find(dsc->src, dsc->src_type);
+    if (entry != NULL) {
+        img_stat.hit++;
+    } else {
+        entry = img_cache_load(dsc);
+        if (entry == NULL) {
+            return LV_RES_INV;
+        }
+        img_stat.miss++;
+    }
+
+    entry->ref++;
+    entry->last_use = ++img_clock;
+
+    dsc->header = entry->header;
+    dsc->img_data = entry->data;
+    dsc->user_data = entry;
+    return LV_RES_OK;
+}
+
+/**
+ * @brief 关闭图片
+ *
+ * @param decoder 解码器
+ * @param dsc 解码描述符
+ */
+static void img_cache_close(lv_img_decoder_t *decoder,
+                            lv_img_decoder_dsc_t *dsc) {
+    LV_UNUSED(decoder);
+    img_entry_t *entry = (img_entry_t *)dsc->user_data;
+
+    if (entry == NULL) {
+        return;
+    }
+
+    entry->ref--;
+    if (entry->ref == 0 && entry->stale) {
+        img_cache_drop(entry);
+    }
+}
+
+#if LV_PORT_IMG_CACHE_MONITOR
+/**
+ * @brief 刷新监视器显示
+ *
+ * @param timer 定时器, user_data 为标签
+ */
+static void img_cache_monitor_cb(lv_timer_t *timer) {
+    lv_obj_t *label = (lv_obj_t *)timer->user_data;
+    uint32_t total = img_stat.hit + img_stat.miss;
+    uint32_t rate = (total == 0) ? 0 : (img_stat.hit * 100U / total);
+
+    lv_label_set_text_fmt(label,
+                          "%" LV_PRIu32 "%% HIT\n%" LV_PRIu32 "/%" LV_PRIu32
+                          " KB",
+                          rate, img_stat.used_bytes / 1024U,
+                          img_stat.total_bytes / 1024U);
+}
+#endif /* LV_PORT_IMG_CACHE_MONITOR */
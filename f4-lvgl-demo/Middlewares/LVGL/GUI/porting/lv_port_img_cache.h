@@ -0,0 +1,71 @@
+/**
+ * @file lv_port_img_cache.h
+ *
+ */
+
+#ifndef LV_PORT_IMG_CACHE_H
+#define LV_PORT_IMG_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* 缓存池在外部 SDRAM 中的起始地址, 跳过显存和 lv_port_fs 的预读缓冲区 */
+#define LV_PORT_IMG_CACHE_ADDR      0XC0B00000
+/* 缓存池大小 (字节), 所有解码后图片占用的内存不超过这个值 */
+#define LV_PORT_IMG_CACHE_SIZE      (4U * 1024U * 1024U)
+/* 最多缓存的图片数量 */
+#define LV_PORT_IMG_CACHE_ENTRY_NUM 32
+
+/* 在性能监视器旁边显示命中率和缓存占用 */
+#define LV_PORT_IMG_CACHE_MONITOR   LV_USE_PERF_MONITOR
+#if LV_PORT_IMG_CACHE_MONITOR
+#define LV_PORT_IMG_CACHE_MONITOR_POS   LV_ALIGN_BOTTOM_RIGHT
+/* 相对于性能监视器的水平偏移, 避免两者重叠 */
+#define LV_PORT_IMG_CACHE_MONITOR_OFS_X (-80)
+#endif /* LV_PORT_IMG_CACHE_MONITOR */
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**
+ * @brief 图片缓存统计
+ */
+typedef struct {
+    uint32_t hit;        /*!< 命中次数 */
+    uint32_t miss;       /*!< 未命中 (需要解码) 的次数 */
+    uint32_t evict;      /*!< 被淘汰的图片数量 */
+    uint32_t used_bytes; /*!< 已缓存图片占用的字节数 */
+    uint32_t total_bytes; /*!< 缓存池大小 */
+    uint16_t entry_num;  /*!< 已缓存的图片数量 */
+} lv_port_img_cache_stat_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+void lv_port_img_cache_init(void);
+
+lv_res_t lv_port_img_cache_pin(const void *src);
+void lv_port_img_cache_unpin(const void *src);
+void lv_port_img_cache_invalidate(const void *src);
+void lv_port_img_cache_get_stat(lv_port_img_cache_stat_t *stat);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_PORT_IMG_CACHE_H*/
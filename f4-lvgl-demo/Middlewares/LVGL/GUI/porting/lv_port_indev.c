@@ -39,6 +39,11 @@ static void touchpad_get_xy(lv_coord_t *x, lv_coord_t *y);
 
 static lv_indev_t *indev_touchpad;
 
+#if TP_USE_INT
+/* 是否使用中断方式采集 */
+static bool touchpad_use_int;
+#endif /* TP_USE_INT */
+
 /**********************
  *   GLOBAL FUNCTIONS
  **********************/
@@ -76,6 +81,26 @@ void lv_port_indev_init(void) {
     indev_touchpad = lv_indev_drv_register(&indev_drv);
 }
 
+/**
+ * @brief 恢复输入设备的读取
+ *
+ * @note 中断采集时, 松开后会暂停 LVGL 的读取定时器, GUI 任务可以一直休眠.
+ *       有新的坐标时需要在 GUI 任务中调用此函数, 立即读取一次.
+ */
+void lv_port_indev_resume(void) {
+    lv_timer_t *read_timer;
+
+    if (indev_touchpad == NULL) {
+        return;
+    }
+
+    read_timer = indev_touchpad->driver->read_timer;
+    if (read_timer != NULL) {
+        lv_timer_resume(read_timer);
+        lv_timer_ready(read_timer);
+    }
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -91,10 +116,16 @@ void lv_port_indev_init(void) {
 static void touchpad_init(void) {
     /*Your code comes here*/
     tp_dev.init();
+
     /* 电阻屏如果发现显示屏 XY 镜像现象，需要坐标矫正 */
     if (0 == (tp_dev.touchtype & 0x80)) {
         tp_adjust();
     }
+
+#if TP_USE_INT
+    /* 由采集任务在 INT/PENIRQ 触发后读取坐标, 必须在校准之后启动 */
+    touchpad_use_int = (tp_int_start() == 0);
+#endif /* TP_USE_INT */
 }
 
 /**
@@ -107,6 +138,31 @@ static void touchpad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data) {
     static lv_coord_t last_x = 0;
     static lv_coord_t last_y = 0;
 
+#if TP_USE_INT
+    if (touchpad_use_int) {
+        static lv_indev_state_t last_state = LV_INDEV_STATE_REL;
+        tp_sample_t sample;
+
+        /* 每次取一个坐标, 队列中还有坐标时让 LVGL 继续读取, 不丢失点击 */
+        if (tp_sample_read(&sample) == 0) {
+            last_x = sample.x;
+            last_y = sample.y;
+            last_state =
+                sample.pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+            data->continue_reading = (tp_sample_pending() != 0);
+        } else if (last_state == LV_INDEV_STATE_REL &&
+                   indev_touchpad->proc.types.pointer.scroll_obj == NULL) {
+            /* 松开且惯性滚动已结束, 暂停读取, 由 lv_port_indev_resume 恢复 */
+            lv_timer_pause(indev_drv->read_timer);
+        }
+
+        data->state = last_state;
+        data->point.x = last_x;
+        data->point.y = last_y;
+        return;
+    }
+#endif /* TP_USE_INT */
+
     UNUSED(indev_drv);
 
     /* 保存按下的坐标和状态 */
@@ -32,6 +32,7 @@ extern "C" {
  * GLOBAL PROTOTYPES
  **********************/
 void lv_port_indev_init(void);
+void lv_port_indev_resume(void);
 
 /**********************
  *      MACROS
@@ -0,0 +1,467 @@
+/**
+ * @file lv_port_lz4.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_port_lz4.h"
+#include <lvgl.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <bsp.h>
+
+#include "eez-flow-lz4.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**
+ * @brief 压缩图片信息
+ */
+typedef struct {
+    uint8_t px_size;    /*!< 每像素字节数 */
+    uint16_t rows;      /*!< 每块的行数 */
+    uint16_t w;         /*!< 宽度 */
+    uint16_t h;         /*!< 高度 */
+    uint32_t max_block; /*!< 最大的压缩块大小 */
+    uint32_t block_num; /*!< 块数量 */
+} lz4_info_t;
+
+/**
+ * @brief 解码会话
+ */
+typedef struct {
+    lz4_info_t info;       /*!< 图片信息 */
+    uint8_t is_file;       /*!< 是否为文件图片 */
+    lv_fs_file_t file;     /*!< 文件, 仅文件图片使用 */
+    const uint8_t *stream; /*!< 从魔数开始的数据, 仅变量图片使用 */
+    uint32_t *offsets;     /*!< 块偏移表, 仅文件图片使用 */
+    uint8_t *in_buf;       /*!< 压缩块缓冲区, 仅文件图片使用 */
+    uint8_t *out_buf;      /*!< 解压后的块 */
+    int32_t cur_block;     /*!< out_buf 中的块, -1 表示无效 */
+} lz4_session_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static lv_res_t lz4_info(lv_img_decoder_t *decoder, const void *src,
+                         lv_img_header_t *header);
+static lv_res_t lz4_open(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc);
+static lv_res_t lz4_read_line(lv_img_decoder_t *decoder,
+                              lv_img_decoder_dsc_t *dsc, lv_coord_t x,
+                              lv_coord_t y, lv_coord_t len, uint8_t *buf);
+static void lz4_close(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+static lv_img_decoder_t *lz4_decoder;
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * @brief 注册 LZ4 图片解码器
+ *
+ * @note 需要在 lv_port_img_cache_init() 之前调用, 使解压后的图片可以被缓存
+ */
+void lv_port_lz4_init(void) {
+    lz4_decoder = lv_img_decoder_create();
+    lv_img_decoder_set_info_cb(lz4_decoder, lz4_info);
+    lv_img_decoder_set_open_cb(lz4_decoder, lz4_open);
+    lv_img_decoder_set_read_line_cb(lz4_decoder, lz4_read_line);
+    lv_img_decoder_set_close_cb(lz4_decoder, lz4_close);
+}
+
+#if LV_PORT_LZ4_BENCHMARK
+
+/* 随机读取单行的次数 */
+#define LZ4_BENCH_ROWS 16
+
+/**
+ * @brief 解码测速, 通过 DWT 周期计数器统计整图解码和随机读取单行的时间
+ *
+ * @param src 图片源, 变量或文件路径
+ * @note 直接调用 LZ4 解码器, 不经过图片缓存. 结果通过 printf 输出,
+ *       用于在不同的每块行数之间权衡 Flash 占用和解码时间
+ */
+void lv_port_lz4_benchmark(const void *src) {
+    lv_img_decoder_dsc_t dsc;
+    lz4_session_t *session;
+    uint8_t *line;
+    uint32_t start, full, row, raw, packed, pixels;
+    uint32_t cycles_us = SystemCoreClock / 1000000U;
+
+    lv_memset_00(&dsc, sizeof(dsc));
+    dsc.src = src;
+    dsc.src_type = lv_img_src_get_type(src);
+    dsc.decoder = lz4_decoder;
+
+    if (lz4_info(lz4_decoder, src, &dsc.header) != LV_RES_OK ||
+        lz4_open(lz4_decoder, &dsc) != LV_RES_OK) {
+        printf("LZ4 image: not a valid image\r\n");
+        return;
+    }
+
+    session = (lz4_session_t *)dsc.user_data;
+    line = lv_mem_alloc(session->info.w * session->info.px_size);
+    if (line == NULL) {
+        lz4_close(lz4_decoder, &dsc);
+        return;
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    start = DWT->CYCCNT;
+    for (lv_coord_t y = 0; y < session->info.h; ++y) {
+        lz4_read_line(lz4_decoder, &dsc, 0, y, session->info.w, line);
+    }
+    full = DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < LZ4_BENCH_ROWS; ++i) {
+        session->cur_block = -1;
+        lz4_read_line(lz4_decoder, &dsc, 0,
+                      (lv_coord_t)((i * 7919U) % session->info.h),
+                      session->info.w, line);
+    }
+    row = (DWT->CYCCNT - start) / LZ4_BENCH_ROWS;
+
+    pixels = (uint32_t)session->info.w * session->info.h;
+    raw = pixels * session->info.px_size;
+    if (session->is_file) {
+        packed = session->offsets[session->info.block_num];
+    } else {
+        memcpy(&packed,
+               &session->stream[LV_PORT_LZ4_HEADER_SIZE +
+                                session->info.block_num * 4U],
+               4);
+    }
+
+    printf("LZ4 image %ux%u, %u rows/block: %lu -> %lu bytes (%lu%%)\r\n",
+           (unsigned int)session->info.w, (unsigned int)session->info.h,
+           (unsigned int)session->info.rows, (unsigned long)raw,
+           (unsigned long)packed, (unsigned long)(packed * 100U / raw));
+    printf("  full decode %lu us (%lu.%02lu cycles/pixel), one row %lu us\r\n",
+           (unsigned long)(full / cycles_us), (unsigned long)(full / pixels),
+           (unsigned long)((full % pixels) * 100U / pixels),
+           (unsigned long)(row / cycles_us));
+
+    lv_mem_free(line);
+    lz4_close(lz4_decoder, &dsc);
+}
+
+#endif /* LV_PORT_LZ4_BENCHMARK */
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * @brief 读取小端 16 位数
+ *
+ * @param p 数据地址, 可以不对齐
+ * @return 读取的值
+ */
+static inline uint16_t lz4_get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * @brief 读取小端 32 位数
+ *
+ * @param p 数据地址, 可以不对齐
+ * @return 读取的值
+ */
+static inline uint32_t lz4_get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief 解析并检查压缩图片头
+ *
+ * @param hdr 从魔数开始的 `LV_PORT_LZ4_HEADER_SIZE` 字节
+ * @param cf LVGL 图片头中的格式
+ * @param[out] info 图片信息
+ * @return LV_RES_OK: 有效; LV_RES_INV: 不是 LZ4 图片
+ */
+static lv_res_t lz4_parse(const uint8_t *hdr, lv_img_cf_t cf,
+                          lz4_info_t *info) {
+    if (memcmp(hdr, LV_PORT_LZ4_MAGIC, 4) != 0 ||
+        hdr[4] != LV_PORT_LZ4_VERSION) {
+        return LV_RES_INV;
+    }
+
+    info->px_size = hdr[5];
+    info->rows = lz4_get_u16(&hdr[6]);
+    info->w = lz4_get_u16(&hdr[8]);
+    info->h = lz4_get_u16(&hdr[10]);
+    info->max_block = lz4_get_u32(&hdr[12]);
+
+    if (info->rows == 0 || info->w == 0 || info->h == 0) {
+        return LV_RES_INV;
+    }
+
+    /* RGB565 对应 RAW, ARGB8565 对应 RAW_ALPHA */
+    if (!((cf == LV_IMG_CF_RAW && info->px_size == LV_COLOR_SIZE / 8) ||
+          (cf == LV_IMG_CF_RAW_ALPHA &&
+           info->px_size == LV_IMG_PX_SIZE_ALPHA_BYTE))) {
+        return LV_RES_INV;
+    }
+
+    info->block_num = (info->h + info->rows - 1) / info->rows;
+    return LV_RES_OK;
+}
+
+/**
+ * @brief 获取图片信息
+ *
+ * @param decoder 解码器
+ * @param src 图片源
+ * @param[out] header 图片信息
+ * @return LV_RES_OK: 是 LZ4 图片; LV_RES_INV: 交给其他解码器
+ */
+static lv_res_t lz4_info(lv_img_decoder_t *decoder, const void *src,
+                         lv_img_header_t *header) {
+    LV_UNUSED(decoder);
+    lv_img_src_t src_type = lv_img_src_get_type(src);
+    uint8_t buf[sizeof(lv_img_header_t) + LV_PORT_LZ4_HEADER_SIZE];
+    lz4_info_t info;
+    lv_fs_file_t file;
+    uint32_t br = 0;
+
+    if (src_type == LV_IMG_SRC_VARIABLE) {
+        const lv_img_dsc_t *img = (const lv_img_dsc_t *)src;
+
+        if (img->data_size < LV_PORT_LZ4_HEADER_SIZE ||
+            lz4_parse(img->data, img->header.cf, &info) != LV_RES_OK) {
+            return LV_RES_INV;
+        }
+
+        *header = img->header;
+        return LV_RES_OK;
+    }
+
+    if (src_type != LV_IMG_SRC_FILE ||
+        strcmp(lv_fs_get_ext((const char *)src), "lz4") != 0) {
+        return LV_RES_INV;
+    }
+
+    if (lv_fs_open(&file, (const char *)src, LV_FS_MODE_RD) != LV_FS_RES_OK) {
+        return LV_RES_INV;
+    }
+    lv_fs_read(&file, buf, sizeof(buf), &br);
+    lv_fs_close(&file);
+
+    if (br != sizeof(buf)) {
+        return LV_RES_INV;
+    }
+
+    memcpy(header, buf, sizeof(lv_img_header_t));
+    if (lz4_parse(&buf[sizeof(lv_img_header_t)], header->cf, &info) !=
+        LV_RES_OK) {
+        return LV_RES_INV;
+    }
+
+    return LV_RES_OK;
+}
+
+/**
+ * @brief 打开图片, 只读取头和块偏移表, 不解压
+ *
+ * @param decoder 解码器
+ * @param dsc 解码描述符
+ * @return LV_RES_OK: 成功; LV_RES_INV: 失败
+ */
+static lv_res_t lz4_open(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    uint8_t hdr[sizeof(lv_img_header_t) + LV_PORT_LZ4_HEADER_SIZE];
+    lz4_session_t *session;
+    uint32_t size, br = 0;
+
+    session = lv_mem_alloc(sizeof(lz4_session_t));
+    if (session == NULL) {
+        return LV_RES_INV;
+    }
+    lv_memset_00(session, sizeof(lz4_session_t));
+    session->cur_block = -1;
+    dsc->user_data = session;
+
+    if (dsc->src_type == LV_IMG_SRC_VARIABLE) {
+        const lv_img_dsc_t *img = (const lv_img_dsc_t *)dsc->src;
+
+        session->stream = img->data;
+        lz4_parse(img->data, img->header.cf, &session->info);
+    } else {
+        if (lv_fs_open(&session->file, (const char *)dsc->src,
+                       LV_FS_MODE_RD) != LV_FS_RES_OK) {
+            lv_mem_free(session);
+            dsc->user_data = NULL;
+            return LV_RES_INV;
+        }
+        session->is_file = 1;
+
+        lv_fs_read(&session->file, hdr, sizeof(hdr), &br);
+        if (br != sizeof(hdr) ||
+            lz4_parse(&hdr[sizeof(lv_img_header_t)], dsc->header.cf,
+                      &session->info) != LV_RES_OK) {
+            lz4_close(decoder, dsc);
+            return LV_RES_INV;
+        }
+
+        /* 文件中的偏移表读入内存, 之后每块只需要一次定位和读取 */
+        size = (session->info.block_num + 1) * 4U;
+        session->offsets = lv_mem_alloc(size);
+        session->in_buf = lv_mem_alloc(session->info.max_block);
+        if (session->offsets == NULL || session->in_buf == NULL) {
+            lz4_close(decoder, dsc);
+            return LV_RES_INV;
+        }
+
+        lv_fs_read(&session->file, session->offsets, size, &br);
+        if (br != size) {
+            lz4_close(decoder, dsc);
+            return LV_RES_INV;
+        }
+        for (uint32_t i = 0; i <= session->info.block_num; ++i) {
+            session->offsets[i] =
+                lz4_get_u32((const uint8_t *)&session->offsets[i]);
+        }
+    }
+
+    session->out_buf = lv_mem_alloc(session->info.rows * session->info.w *
+                                    session->info.px_size);
+    if (session->out_buf == NULL) {
+        lz4_close(decoder, dsc);
+        return LV_RES_INV;
+    }
+
+    dsc->img_data = NULL;
+    return LV_RES_OK;
+}
+
+/**
+ * @brief 解压一块
+ *
+ * @param session 解码会话
+ * @param block 块序号
+ * @return LV_RES_OK: 成功; LV_RES_INV: 数据错误
+ */
+static lv_res_t lz4_decode_block(lz4_session_t *session, uint32_t block) {
+    const lz4_info_t *info = &session->info;
+    const uint8_t *src;
+    uint32_t start, end, rows, out_size, br = 0;
+    int ret;
+
+    if (session->is_file) {
+        start = session->offsets[block];
+        end = session->offsets[block + 1];
+    } else {
+        start = lz4_get_u32(
+            &session->stream[LV_PORT_LZ4_HEADER_SIZE + block * 4U]);
+        end = lz4_get_u32(
+            &session->stream[LV_PORT_LZ4_HEADER_SIZE + block * 4U + 4U]);
+    }
+
+    if (end < start || end - start > info->max_block) {
+        return LV_RES_INV;
+    }
+
+    if (session->is_file) {
+        lv_fs_seek(&session->file, sizeof(lv_img_header_t) + start,
+                   LV_FS_SEEK_SET);
+        lv_fs_read(&session->file, session->in_buf, end - start, &br);
+        if (br != end - start) {
+            return LV_RES_INV;
+        }
+        src = session->in_buf;
+    } else {
+        src = &session->stream[start];
+    }
+
+    rows = LV_MIN(info->rows, info->h - block * info->rows);
+    out_size = rows * info->w * info->px_size;
+
+    ret = LZ4_decompress_safe((const char *)src, (char *)session->out_buf,
+                              (int)(end - start), (int)out_size);
+    if (ret != (int)out_size) {
+        session->cur_block = -1;
+        return LV_RES_INV;
+    }
+
+    session->cur_block = (int32_t)block;
+    return LV_RES_OK;
+}
+
+/**
+ * @brief 读取一行
+ *
+ * @param decoder 解码器
+ * @param dsc 解码描述符
+ * @param x 起始 x 坐标
+ * @param y 行号
+ * @param len 像素数量
+ * @param[out] buf 像素数据
+ * @return LV_RES_OK: 成功; LV_RES_INV: 失败
+ * @note 同一块内的行只解压一次, 按行顺序读取时每块只解压一次
+ */
+static lv_res_t lz4_read_line(lv_img_decoder_t *decoder,
+                              lv_img_decoder_dsc_t *dsc, lv_coord_t x,
+                              lv_coord_t y, lv_coord_t len, uint8_t *buf) {
+    LV_UNUSED(decoder);
+    lz4_session_t *session = (lz4_session_t *)dsc->user_data;
+    const lz4_info_t *info = &session->info;
+    uint32_t block = (uint32_t)y / info->rows;
+    uint32_t ofs;
+
+    if (block != (uint32_t)session->cur_block &&
+        lz4_decode_block(session, block) != LV_RES_OK) {
+        return LV_RES_INV;
+    }
+
+    ofs = ((uint32_t)y % info->rows) * info->w + (uint32_t)x;
+    lv_memcpy(buf, &session->out_buf[ofs * info->px_size],
+              (uint32_t)len * info->px_size);
+    return LV_RES_OK;
+}
+
+/**
+ * @brief 关闭图片
+ *
+ * @param decoder 解码器
+ * @param dsc 解码描述符
+ */
+static void lz4_close(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    LV_UNUSED(decoder);
+    lz4_session_t *session = (lz4_session_t *)dsc->user_data;
+
+    if (session == NULL) {
+        return;
+    }
+
+    if (session->is_file) {
+        lv_fs_close(&session->file);
+    }
+
+    lv_mem_free(session->offsets);
+    lv_mem_free(session->in_buf);
+    lv_mem_free(session->out_buf);
+    lv_mem_free(session);
+    dsc->user_data = NULL;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file lv_port_lz4.h
+ *
+ */
+
+#ifndef LV_PORT_LZ4_H
+#define LV_PORT_LZ4_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**
+ * LZ4 压缩图片格式, 由 Tools/lz4_img 生成:
+ *
+ *   lv_img_header_t (仅文件, cf 为 LV_IMG_CF_RAW 或 LV_IMG_CF_RAW_ALPHA)
+ *   "LZ4I"          魔数
+ *   uint8_t         版本, 当前为 1
+ *   uint8_t         每像素字节数, 2: RGB565; 3: ARGB8565 (RGB565 + alpha)
+ *   uint16_t        每块的行数
+ *   uint16_t        宽度
+ *   uint16_t        高度
+ *   uint32_t        最大的压缩块大小
+ *   uint32_t[n + 1] 每块相对魔数的偏移, 最后一项为数据结尾
+ *   n 个独立压缩的 LZ4 块
+ *
+ * 多字节数据为小端. 每块独立压缩, 局部重绘时只解压需要的行所在的块.
+ * 变量图片的 data 指向魔数; 文件图片的扩展名必须为 ".lz4".
+ */
+#define LV_PORT_LZ4_MAGIC       "LZ4I"
+#define LV_PORT_LZ4_VERSION     1
+#define LV_PORT_LZ4_HEADER_SIZE 16
+
+/* 解码测速, 结果通过 printf 输出 */
+#define LV_PORT_LZ4_BENCHMARK   0
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+void lv_port_lz4_init(void);
+
+#if LV_PORT_LZ4_BENCHMARK
+void lv_port_lz4_benchmark(const void *src);
+#endif /* LV_PORT_LZ4_BENCHMARK */
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_PORT_LZ4_H*/
@@ -0,0 +1,505 @@
+/**
+ * @file lv_port_prof.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_port_prof.h"
+
+#if LV_PORT_PROF
+
+#include <draw/sw/lv_draw_sw.h>
+#include <lvgl.h>
+#include <string.h>
+
+#include <bsp.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#if (LV_PORT_PROF_BUF_NUM & (LV_PORT_PROF_BUF_NUM - 1)) != 0
+#error "LV_PORT_PROF_BUF_NUM must be a power of 2"
+#endif /* LV_PORT_PROF_BUF_NUM */
+
+#if LV_PORT_PROF_PKT_NUM > 255
+#error "LV_PORT_PROF_PKT_NUM must not be greater than 255"
+#endif /* LV_PORT_PROF_PKT_NUM */
+
+/* 每个打点输出的字节数 */
+#define PROF_EVENT_SIZE 5
+/* 一包的最大长度 */
+#define PROF_PKT_SIZE                                                          \
+    (LV_PORT_PROF_HEADER_SIZE + LV_PORT_PROF_PKT_NUM * PROF_EVENT_SIZE + 1)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**
+ * @brief 打点
+ */
+typedef struct {
+    uint32_t cycles; /*!< DWT 周期计数 */
+    uint8_t tag;     /*!< 编号, 最高位表示结束 */
+} prof_event_t;
+
+/**
+ * @brief 记录状态
+ */
+typedef enum {
+    PROF_STATE_STOP,  /*!< 未初始化 */
+    PROF_STATE_RUN,   /*!< 正在记录 */
+    PROF_STATE_PAUSE, /*!< 缓冲区满, 等待发送完成 */
+    PROF_STATE_ARMED  /*!< 已发送完成, 等待下一次 lv_timer_handler 或刷新 */
+} prof_state_t;
+
+/**
+ * @brief 被替换的原回调函数
+ */
+typedef struct {
+    lv_timer_cb_t refr_timer;
+    void (*flush_cb)(lv_disp_drv_t *disp_drv, const lv_area_t *area,
+                     lv_color_t *color_p);
+    void (*wait_cb)(lv_disp_drv_t *disp_drv);
+    void (*draw_rect)(lv_draw_ctx_t *draw_ctx, const lv_draw_rect_dsc_t *dsc,
+                      const lv_area_t *coords);
+    void (*draw_bg)(lv_draw_ctx_t *draw_ctx, const lv_draw_rect_dsc_t *dsc,
+                    const lv_area_t *coords);
+    void (*draw_img_decoded)(lv_draw_ctx_t *draw_ctx,
+                             const lv_draw_img_dsc_t *dsc,
+                             const lv_area_t *coords, const uint8_t *map_p,
+                             lv_img_cf_t color_format);
+    void (*draw_letter)(lv_draw_ctx_t *draw_ctx,
+                        const lv_draw_label_dsc_t *dsc,
+                        const lv_point_t *pos_p, uint32_t letter);
+    void (*draw_arc)(lv_draw_ctx_t *draw_ctx, const lv_draw_arc_dsc_t *dsc,
+                     const lv_point_t *center, uint16_t radius,
+                     uint16_t start_angle, uint16_t end_angle);
+    void (*draw_line)(lv_draw_ctx_t *draw_ctx, const lv_draw_line_dsc_t *dsc,
+                      const lv_point_t *point1, const lv_point_t *point2);
+    void (*draw_polygon)(lv_draw_ctx_t *draw_ctx,
+                         const lv_draw_rect_dsc_t *dsc,
+                         const lv_point_t *points, uint16_t point_cnt);
+    void (*blend)(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc);
+} prof_orig_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void prof_hook_draw_ctx(lv_disp_drv_t *disp_drv);
+static void prof_refr_timer(lv_timer_t *timer);
+static void prof_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area,
+                          lv_color_t *color_p);
+static void prof_wait_cb(lv_disp_drv_t *disp_drv);
+static void prof_draw_rect(lv_draw_ctx_t *draw_ctx,
+                           const lv_draw_rect_dsc_t *dsc,
+                           const lv_area_t *coords);
+static void prof_draw_bg(lv_draw_ctx_t *draw_ctx, const lv_draw_rect_dsc_t *dsc,
+                         const lv_area_t *coords);
+static void prof_draw_img_decoded(lv_draw_ctx_t *draw_ctx,
+                                  const lv_draw_img_dsc_t *dsc,
+                                  const lv_area_t *coords,
+                                  const uint8_t *map_p,
+                                  lv_img_cf_t color_format);
+static void prof_draw_letter(lv_draw_ctx_t *draw_ctx,
+                             const lv_draw_label_dsc_t *dsc,
+                             const lv_point_t *pos_p, uint32_t letter);
+static void prof_draw_arc(lv_draw_ctx_t *draw_ctx, const lv_draw_arc_dsc_t *dsc,
+                          const lv_point_t *center, uint16_t radius,
+                          uint16_t start_angle, uint16_t end_angle);
+static void prof_draw_line(lv_draw_ctx_t *draw_ctx,
+                           const lv_draw_line_dsc_t *dsc,
+                           const lv_point_t *point1, const lv_point_t *point2);
+static void prof_draw_polygon(lv_draw_ctx_t *draw_ctx,
+                              const lv_draw_rect_dsc_t *dsc,
+                              const lv_point_t *points, uint16_t point_cnt);
+static void prof_blend(lv_draw_ctx_t *draw_ctx,
+                       const lv_draw_sw_blend_dsc_t *dsc);
+static uint32_t prof_pack(uint8_t *pkt);
+static void prof_uart_output(const uint8_t *data, uint32_t len);
+static void prof_task(void *pvParameters);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+static prof_event_t prof_buf[LV_PORT_PROF_BUF_NUM];
+static volatile uint32_t prof_head;
+static volatile uint32_t prof_tail;
+static volatile uint32_t prof_dropped;
+static volatile prof_state_t prof_state;
+static volatile uint8_t prof_flush_waiting;
+
+static prof_orig_t prof_orig;
+static lv_port_prof_output_t prof_output = prof_uart_output;
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * @brief 初始化分析器, 挂接刷新定时器, flush 和绘制函数, 并创建输出任务
+ *
+ * @param disp 显示设备, 在 lv_disp_drv_register 之后调用
+ */
+void lv_port_prof_init(lv_disp_t *disp) {
+    lv_disp_drv_t *disp_drv = disp->driver;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    prof_orig.refr_timer = disp->refr_timer->timer_cb;
+    disp->refr_timer->timer_cb = prof_refr_timer;
+
+    prof_orig.flush_cb = disp_drv->flush_cb;
+    disp_drv->flush_cb = prof_flush_cb;
+    prof_orig.wait_cb = disp_drv->wait_cb;
+    disp_drv->wait_cb = prof_wait_cb;
+
+    prof_hook_draw_ctx(disp_drv);
+
+    prof_state = PROF_STATE_ARMED;
+
+    xTaskCreate(prof_task, "lv_prof", LV_PORT_PROF_TASK_STACK, NULL,
+                LV_PORT_PROF_TASK_PRIO, NULL);
+}
+
+/**
+ * @brief 设置输出函数, 默认通过 USART1 阻塞发送
+ *
+ * @param output 输出函数, 例如 USB CDC 的发送函数
+ * @note 输出函数在分析器的任务中调用
+ */
+void lv_port_prof_set_output(lv_port_prof_output_t output) {
+    prof_output = output;
+}
+
+/**
+ * @brief 记录一个打点
+ *
+ * @param tag 编号, 最高位为 1 表示结束
+ * @note 可以在中断中调用
+ */
+void lv_port_prof_record(uint8_t tag) {
+    uint32_t cycles = DWT->CYCCNT;
+    uint32_t primask = __get_PRIMASK();
+    prof_event_t *event;
+
+    __disable_irq();
+
+    if (prof_state == PROF_STATE_ARMED) {
+        /* 从最外层开始记录, 保证每一帧都是完整的 */
+        if (tag == LV_PORT_PROF_TIMER || tag == LV_PORT_PROF_FRAME) {
+            prof_state = PROF_STATE_RUN;
+        } else {
+            ++prof_dropped;
+        }
+    }
+
+    if (prof_state == PROF_STATE_RUN) {
+        if (prof_head - prof_tail >= LV_PORT_PROF_BUF_NUM) {
+            prof_state = PROF_STATE_PAUSE;
+            ++prof_dropped;
+        } else {
+            event = &prof_buf[prof_head & (LV_PORT_PROF_BUF_NUM - 1)];
+            event->cycles = cycles;
+            event->tag = tag;
+            ++prof_head;
+        }
+    } else if (prof_state == PROF_STATE_PAUSE) {
+        ++prof_dropped;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief flush 完成, 结束 FLUSH_WAIT
+ *
+ * @note 在调用 lv_disp_flush_ready 的中断中调用
+ */
+void lv_port_prof_flush_ready(void) {
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if (prof_flush_waiting) {
+        prof_flush_waiting = 0;
+        LV_PORT_PROF_END(LV_PORT_PROF_FLUSH_WAIT);
+    }
+    __set_PRIMASK(primask);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * @brief 替换绘制上下文中的绘制函数
+ *
+ * @param disp_drv 显示设备
+ */
+static void prof_hook_draw_ctx(lv_disp_drv_t *disp_drv) {
+    lv_draw_ctx_t *draw_ctx = disp_drv->draw_ctx;
+
+#define PROF_HOOK(func)                                                        \
+    do {                                                                       \
+        prof_orig.func = draw_ctx->func;                                       \
+        if (draw_ctx->func != NULL) {                                          \
+            draw_ctx->func = prof_##func;                                      \
+        }                                                                      \
+    } while (0)
+
+    PROF_HOOK(draw_rect);
+    PROF_HOOK(draw_bg);
+    PROF_HOOK(draw_img_decoded);
+    PROF_HOOK(draw_letter);
+    PROF_HOOK(draw_arc);
+    PROF_HOOK(draw_line);
+    PROF_HOOK(draw_polygon);
+
+#undef PROF_HOOK
+
+    /* 软件渲染和 DMA2D 的上下文都以 lv_draw_sw_ctx_t 开头 */
+    if (disp_drv->draw_ctx_size >= sizeof(lv_draw_sw_ctx_t)) {
+        lv_draw_sw_ctx_t *sw_ctx = (lv_draw_sw_ctx_t *)draw_ctx;
+        prof_orig.blend = sw_ctx->blend;
+        if (sw_ctx->blend != NULL) {
+            sw_ctx->blend = prof_blend;
+        }
+    }
+}
+
+/**
+ * @brief 刷新定时器, 单独统计布局的时间
+ *
+ * @param timer 刷新定时器
+ */
+static void prof_refr_timer(lv_timer_t *timer) {
+    lv_disp_t *disp = (lv_disp_t *)timer->user_data;
+
+    LV_PORT_PROF_BEGIN(LV_PORT_PROF_FRAME);
+
+    if (disp != NULL && disp->act_scr != NULL) {
+        LV_PORT_PROF_BEGIN(LV_PORT_PROF_LAYOUT);
+        /* 先完成布局, 刷新时的 lv_obj_update_layout 就不会再有工作 */
+        lv_obj_update_layout(disp->act_scr);
+        if (disp->prev_scr != NULL) {
+            lv_obj_update_layout(disp->prev_scr);
+        }
+        lv_obj_update_layout(disp->top_layer);
+        lv_obj_update_layout(disp->sys_layer);
+        LV_PORT_PROF_END(LV_PORT_PROF_LAYOUT);
+    }
+
+    prof_orig.refr_timer(timer);
+
+    LV_PORT_PROF_END(LV_PORT_PROF_FRAME);
+}
+
+/**
+ * @brief flush_cb
+ *
+ * @param disp_drv 显示设备
+ * @param area 刷新的区域
+ * @param color_p 颜色数组
+ */
+static void prof_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area,
+                          lv_color_t *color_p) {
+    LV_PORT_PROF_BEGIN(LV_PORT_PROF_FLUSH);
+    prof_orig.flush_cb(disp_drv, area, color_p);
+    LV_PORT_PROF_END(LV_PORT_PROF_FLUSH);
+}
+
+/**
+ * @brief LVGL 等待 flush 完成时反复调用
+ *
+ * @param disp_drv 显示设备
+ * @note 在关中断的情况下检查 flushing, 避免在 flush 已经完成之后才开始计时
+ */
+static void prof_wait_cb(lv_disp_drv_t *disp_drv) {
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if (!prof_flush_waiting && disp_drv->draw_buf->flushing) {
+        prof_flush_waiting = 1;
+        LV_PORT_PROF_BEGIN(LV_PORT_PROF_FLUSH_WAIT);
+    }
+    __set_PRIMASK(primask);
+
+    if (prof_orig.wait_cb != NULL) {
+        prof_orig.wait_cb(disp_drv);
+    }
+}
+
+static void prof_draw_rect(lv_draw_ctx_t *draw_ctx,
+                           const lv_draw_rect_dsc_t *dsc,
+                           const lv_area_t *coords) {
+    LV_PORT_PROF_BEGIN(LV_PORT_PROF_DRAW_RECT);
+    prof_orig.draw_rect(draw_ctx, dsc, coords);
+    LV_PORT_PROF_END(LV_PORT_PROF_DRAW_RECT);
+}
+
+static void prof_draw_bg(lv_draw_ctx_t *draw_ctx, const lv_draw_rect_dsc_t *dsc,
+                         const lv_area_t *coords) {
+    LV_PORT_PROF_BEGIN(LV_PORT_PROF_DRAW_BG);
+    prof_orig.draw_bg(draw_ctx, dsc, coords);
+    LV_PORT_PROF_END(LV_PORT_PROF_DRAW_BG);
+}
+
+static void prof_draw_img_decoded(lv_draw_ctx_t *draw_ctx,
+                                  const lv_draw_img_dsc_t *dsc,
+                                  const lv_area_t *coords,
+                                  const uint8_t *map_p,
+                                  lv_img_cf_t color_format) {
+    LV_PORT_PROF_BEGIN(LV_PORT_PROF_DRAW_IMG);
+    prof_orig.draw_img_decoded(draw_ctx, dsc, coords, map_p, color_format);
+    LV_PORT_PROF_END(LV_PORT_PROF_DRAW_IMG);
+}
+
+static void prof_draw_letter(lv_draw_ctx_t *draw_ctx,
+                             const lv_draw_label_dsc_t *dsc,
+                             const lv_point_t *pos_p, uint32_t letter) {
+    LV_PORT_PROF_BEGIN(LV_PORT_PROF_DRAW_LABEL);
+    prof_orig.draw_letter(draw_ctx, dsc, pos_p, letter);
+    LV_PORT_PROF_END(LV_PORT_PROF_DRAW_LABEL);
+}
+
+static void prof_draw_arc(lv_draw_ctx_t *draw_ctx, const lv_draw_arc_dsc_t *dsc,
+                          const lv_point_t *center, uint16_t radius,
+                          uint16_t start_angle, uint16_t end_angle) {
+    LV_PORT_PROF_BEGIN(LV_PORT_PROF_DRAW_ARC);
+    prof_orig.draw_arc(draw_ctx, dsc, center, radius, start_angle, end_angle);
+    LV_PORT_PROF_END(LV_PORT_PROF_DRAW_ARC);
+}
+
+static void prof_draw_line(lv_draw_ctx_t *draw_ctx,
+                           const lv_draw_line_dsc_t *dsc,
+                           const lv_point_t *point1, const lv_point_t *point2) {
+    LV_PORT_PROF_BEGIN(LV_PORT_PROF_DRAW_LINE);
+    prof_orig.draw_line(draw_ctx, dsc, point1, point2);
+    LV_PORT_PROF_END(LV_PORT_PROF_DRAW_LINE);
+}
+
+static void prof_draw_polygon(lv_draw_ctx_t *draw_ctx,
+                              const lv_draw_rect_dsc_t *dsc,
+                              const lv_point_t *points, uint16_t point_cnt) {
+    LV_PORT_PROF_BEGIN(LV_PORT_PROF_DRAW_POLYGON);
+    prof_orig.draw_polygon(draw_ctx, dsc, points, point_cnt);
+    LV_PORT_PROF_END(LV_PORT_PROF_DRAW_POLYGON);
+}
+
+static void prof_blend(lv_draw_ctx_t *draw_ctx,
+                       const lv_draw_sw_blend_dsc_t *dsc) {
+    LV_PORT_PROF_BEGIN(LV_PORT_PROF_BLEND);
+    prof_orig.blend(draw_ctx, dsc);
+    LV_PORT_PROF_END(LV_PORT_PROF_BLEND);
+}
+
+/**
+ * @brief 从缓冲区取出打点并打包
+ *
+ * @param pkt 数据包缓冲区, 至少 PROF_PKT_SIZE 字节
+ * @return 数据包长度, 没有打点时为 0
+ */
+static uint32_t prof_pack(uint8_t *pkt) {
+    uint32_t head = prof_head;
+    uint32_t tail = prof_tail;
+    uint32_t num = head - tail;
+    uint32_t dropped = 0;
+    uint32_t primask;
+    uint32_t len;
+    uint8_t sum = 0;
+
+    if (num == 0) {
+        /* 丢弃的打点只在缓冲区发送完之后报告, 上位机据此知道断点的位置 */
+        primask = __get_PRIMASK();
+        __disable_irq();
+        if (prof_state == PROF_STATE_PAUSE) {
+            prof_state = PROF_STATE_ARMED;
+        }
+        dropped = (prof_dropped > 0xFFFF) ? 0xFFFF : prof_dropped;
+        prof_dropped -= dropped;
+        __set_PRIMASK(primask);
+
+        if (dropped == 0) {
+            return 0;
+        }
+    }
+
+    if (num > LV_PORT_PROF_PKT_NUM) {
+        num = LV_PORT_PROF_PKT_NUM;
+    }
+
+    memcpy(pkt, LV_PORT_PROF_MAGIC, 4);
+    pkt[4] = LV_PORT_PROF_VERSION;
+    pkt[5] = (uint8_t)num;
+    pkt[6] = (uint8_t)dropped;
+    pkt[7] = (uint8_t)(dropped >> 8);
+    pkt[8] = (uint8_t)SystemCoreClock;
+    pkt[9] = (uint8_t)(SystemCoreClock >> 8);
+    pkt[10] = (uint8_t)(SystemCoreClock >> 16);
+    pkt[11] = (uint8_t)(SystemCoreClock >> 24);
+    len = LV_PORT_PROF_HEADER_SIZE;
+
+    for (uint32_t i = 0; i < num; ++i) {
+        const prof_event_t *event =
+            &prof_buf[(tail + i) & (LV_PORT_PROF_BUF_NUM - 1)];
+        pkt[len++] = (uint8_t)event->cycles;
+        pkt[len++] = (uint8_t)(event->cycles >> 8);
+        pkt[len++] = (uint8_t)(event->cycles >> 16);
+        pkt[len++] = (uint8_t)(event->cycles >> 24);
+        pkt[len++] = event->tag;
+    }
+    prof_tail = tail + num;
+
+    for (uint32_t i = 4; i < len; ++i) {
+        sum += pkt[i];
+    }
+    pkt[len++] = sum;
+
+    return len;
+}
+
+/**
+ * @brief 默认的输出函数, 通过 USART1 阻塞发送
+ *
+ * @param data 数据
+ * @param len 长度
+ */
+static void prof_uart_output(const uint8_t *data, uint32_t len) {
+    HAL_UART_Transmit(&usart1_handle, (uint8_t *)data, (uint16_t)len,
+                      HAL_MAX_DELAY);
+}
+
+/**
+ * @brief 输出任务, 把缓冲区中的打点打包发送
+ *
+ * @param pvParameters 未使用
+ */
+static void prof_task(void *pvParameters) {
+    static uint8_t pkt[PROF_PKT_SIZE];
+    uint32_t len;
+
+    UNUSED(pvParameters);
+
+    while (1) {
+        len = prof_pack(pkt);
+        if (len == 0) {
+            vTaskDelay(pdMS_TO_TICKS(LV_PORT_PROF_PERIOD_MS));
+            continue;
+        }
+        prof_output(pkt, len);
+    }
+}
+
+#endif /* LV_PORT_PROF */
@@ -0,0 +1,127 @@
+/**
+ * @file lv_port_prof.h
+ *
+ */
+
+#ifndef LV_PORT_PROF_H
+#define LV_PORT_PROF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**
+ * 渲染流水线分析器, 使用 DWT 周期计数器给每一段耗时打点.
+ *
+ * 每个打点为 5 字节 {uint32_t 周期数, uint8_t 编号}, 编号最高位为 1 表示结束.
+ * 打点先存入环形缓冲区, 再由低优先级任务打包输出:
+ *
+ *   "LVPF"          魔数
+ *   uint8_t         版本, 当前为 1
+ *   uint8_t         打点数量 n
+ *   uint16_t        丢弃的打点数量, 只在 n 为 0 时非 0, 表示记录在这里中断
+ *   uint32_t        CPU 频率 (Hz)
+ *   n 个打点
+ *   uint8_t         校验和, 魔数之后所有字节的和
+ *
+ * 多字节数据为小端. 默认通过 USART1 输出, 与 printf 共用串口时, 上位机根据
+ * 魔数和校验和重新同步. 用 Tools/lv_prof 转换为火焰图.
+ *
+ * 缓冲区满时暂停记录, 等全部发送完成后, 从下一次 lv_timer_handler 或者
+ * 刷新开始重新记录, 保证每一帧的打点都是完整的.
+ */
+#define LV_PORT_PROF             0
+
+#if LV_PORT_PROF
+/* 环形缓冲区能存放的打点数量, 必须为 2 的幂 */
+#define LV_PORT_PROF_BUF_NUM     2048
+/* 每包最多的打点数量 */
+#define LV_PORT_PROF_PKT_NUM     64
+/* 输出任务的优先级和栈大小 */
+#define LV_PORT_PROF_TASK_PRIO   1
+#define LV_PORT_PROF_TASK_STACK  256
+/* 缓冲区为空时输出任务的休眠时间 (ms) */
+#define LV_PORT_PROF_PERIOD_MS   10
+#endif /* LV_PORT_PROF */
+
+#define LV_PORT_PROF_MAGIC       "LVPF"
+#define LV_PORT_PROF_VERSION     1
+#define LV_PORT_PROF_HEADER_SIZE 12
+/* 打点编号中表示结束的位 */
+#define LV_PORT_PROF_END_BIT     0x80U
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**
+ * @brief 打点编号, 与 Tools/lv_prof 中的名称一一对应
+ */
+typedef enum {
+    LV_PORT_PROF_TIMER,        /*!< lv_timer_handler */
+    LV_PORT_PROF_FRAME,        /*!< 一次刷新 (_lv_disp_refr_timer) */
+    LV_PORT_PROF_LAYOUT,       /*!< 布局 */
+    LV_PORT_PROF_DRAW_RECT,    /*!< 矩形 (背景, 边框, 阴影) */
+    LV_PORT_PROF_DRAW_BG,      /*!< 背景 */
+    LV_PORT_PROF_DRAW_IMG,     /*!< 图片 (已解码的数据) */
+    LV_PORT_PROF_DRAW_LABEL,   /*!< 文字, 每个字符一次 */
+    LV_PORT_PROF_DRAW_ARC,     /*!< 圆弧 */
+    LV_PORT_PROF_DRAW_LINE,    /*!< 直线 */
+    LV_PORT_PROF_DRAW_POLYGON, /*!< 多边形 */
+    LV_PORT_PROF_BLEND,        /*!< 填充和混合 (DMA2D 或软件) */
+    LV_PORT_PROF_FLUSH,        /*!< flush_cb */
+    LV_PORT_PROF_FLUSH_WAIT,   /*!< 等待上一次 flush 完成 */
+    LV_PORT_PROF_UI_TICK,      /*!< ui_tick */
+    LV_PORT_PROF_FLOW_TICK,    /*!< eez_flow_tick */
+    LV_PORT_PROF_FLOW_DEBUG,   /*!< EEZ Flow 调试器传输 */
+    LV_PORT_PROF_USER,         /*!< 自定义打点从这里开始编号 */
+    LV_PORT_PROF_ID_MAX = 0x7F
+} lv_port_prof_id_t;
+
+/**
+ * @brief 输出函数
+ *
+ * @param data 数据
+ * @param len 长度
+ */
+typedef void (*lv_port_prof_output_t)(const uint8_t *data, uint32_t len);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+#if LV_PORT_PROF
+void lv_port_prof_init(lv_disp_t *disp);
+void lv_port_prof_set_output(lv_port_prof_output_t output);
+void lv_port_prof_record(uint8_t tag);
+void lv_port_prof_flush_ready(void);
+#endif /* LV_PORT_PROF */
+
+/**********************
+ *      MACROS
+ **********************/
+#if LV_PORT_PROF
+#define LV_PORT_PROF_BEGIN(id)    lv_port_prof_record((uint8_t)(id))
+#define LV_PORT_PROF_END(id)                                                   \
+    lv_port_prof_record((uint8_t)(id) | LV_PORT_PROF_END_BIT)
+/* 在 flush 完成 (调用 lv_disp_flush_ready) 的中断中调用 */
+#define LV_PORT_PROF_FLUSH_READY() lv_port_prof_flush_ready()
+#else /* LV_PORT_PROF */
+#define LV_PORT_PROF_BEGIN(id)
+#define LV_PORT_PROF_END(id)
+#define LV_PORT_PROF_FLUSH_READY()
+#endif /* LV_PORT_PROF */
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_PORT_PROF_H*/
@@ -44,9 +44,14 @@ static uint8_t usb_cdc_tx_buffer[USB_CDC_TX_BUF_SIZE];
 static uint8_t usb_cdc_rx_buffer[USB_CDC_RX_BUF_SIZE];
 
 /* 发送状态标识位, 1 为发送完毕 */
-static uint8_t usb_cdc_tx_cplt = 1;
+static volatile uint8_t usb_cdc_tx_cplt = 1;
 /* 接收状态标志位, 1 为接收到数据 */
 static uint8_t usb_cdc_rx_sta;
+/* 电脑打开了串口 (DTR 有效) */
+static volatile uint8_t usb_cdc_dtr;
+
+static usb_cdc_rx_cb_t usb_cdc_rx_callback;
+static usb_cdc_tx_cb_t usb_cdc_tx_callback;
 
 /* USB handler declaration */
 extern USBD_HandleTypeDef usbd_device;
@@ -113,6 +118,8 @@ static int8_t USB_CDC_Init(void) {
  *         USBD_FAIL
  */
 static int8_t USB_CDC_DeInit(void) {
+    usb_cdc_dtr = 0;
+    usb_cdc_tx_cplt = 1;
     return USBD_OK;
 }
 
@@ -172,7 +179,8 @@ static int8_t USB_CDC_Control(uint8_t cmd, uint8_t *pbuf, uint16_t length) {
             break;
 
         case CDC_SET_CONTROL_LINE_STATE:
-            /* Add your code here */
+            /* wValue 的第 0 位为 DTR */
+            usb_cdc_dtr = ((USBD_SetupReqTypedef *)pbuf)->wValue & 0x01U;
             break;
 
         case CDC_SEND_BREAK:
@@ -206,7 +214,9 @@ static uint8_t *rx_buf;
  *         USBD_FAIL
  */
 static int8_t USB_CDC_Receive(uint8_t *Buf, uint32_t *Len) {
-    UNUSED(Len);
+    if (usb_cdc_rx_callback != NULL) {
+        usb_cdc_rx_callback(Buf, *Len);
+    }
 
     rx_buf = Buf;
 
@@ -235,6 +245,9 @@ static int8_t USB_CDC_TransmitCplt(uint8_t *Buf, uint32_t *Len, uint8_t epnum) {
     UNUSED(epnum);
 
     usb_cdc_tx_cplt = 1;
+    if (usb_cdc_tx_callback != NULL) {
+        usb_cdc_tx_callback();
+    }
 
     return (0);
 }
@@ -246,9 +259,47 @@ static int8_t USB_CDC_TransmitCplt(uint8_t *Buf, uint32_t *Len, uint8_t epnum) {
  * @param len 发送长度
  */
 void usb_cdc_tramsmit(uint8_t *data, uint32_t len) {
+    /* 先清除标志, 发送完成中断可能在 TransmitPacket 返回前到来 */
+    usb_cdc_tx_cplt = 0;
     USBD_CDC_SetTxBuffer(&usbd_device, data, len);
     USBD_CDC_TransmitPacket(&usbd_device);
-    usb_cdc_tx_cplt = 0;
+}
+
+/**
+ * @brief 上一次发送是否已经完成
+ *
+ * @return 1 为可以发送
+ */
+uint8_t usb_cdc_tx_ready(void) {
+    return usb_cdc_tx_cplt;
+}
+
+/**
+ * @brief 电脑是否打开了串口
+ *
+ * @return 1 为已打开 (DTR 有效)
+ * @note 没有打开时电脑不会读取数据, 发送不会完成
+ */
+uint8_t usb_cdc_is_open(void) {
+    return usb_cdc_dtr;
+}
+
+/**
+ * @brief 设置接收回调, 设置后 `usb_cdc_scanf` 仍然可用
+ *
+ * @param callback 回调函数, NULL 取消
+ */
+void usb_cdc_set_rx_callback(usb_cdc_rx_cb_t callback) {
+    usb_cdc_rx_callback = callback;
+}
+
+/**
+ * @brief 设置发送完成回调
+ *
+ * @param callback 回调函数, NULL 取消
+ */
+void usb_cdc_set_tx_callback(usb_cdc_tx_cb_t callback) {
+    usb_cdc_tx_callback = callback;
 }
 
 /**
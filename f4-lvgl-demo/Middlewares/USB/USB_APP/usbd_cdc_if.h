@@ -37,9 +37,26 @@ extern USBD_CDC_ItfTypeDef USBD_CDC_fops;
 #define USB_CDC_TX_BUF_SIZE 200
 #define USB_CDC_RX_BUF_SIZE 200
 
+/**
+ * @brief 接收回调, 在 USB 中断中调用, 返回后数据缓冲区被重新使用
+ *
+ * @param data 收到的数据
+ * @param len 长度
+ */
+typedef void (*usb_cdc_rx_cb_t)(const uint8_t *data, uint32_t len);
+
+/**
+ * @brief 发送完成回调, 在 USB 中断中调用, 可以在其中发送下一块数据
+ */
+typedef void (*usb_cdc_tx_cb_t)(void);
+
 /* Exported functions ------------------------------------------------------- */
 
 void usb_cdc_tramsmit(uint8_t *data, uint32_t len);
+uint8_t usb_cdc_tx_ready(void);
+uint8_t usb_cdc_is_open(void);
+void usb_cdc_set_rx_callback(usb_cdc_rx_cb_t callback);
+void usb_cdc_set_tx_callback(usb_cdc_tx_cb_t callback);
 int usb_cdc_scanf(const char *__fmt, ...);
 int usb_cdc_printf(const char *__fmt, ...);
 
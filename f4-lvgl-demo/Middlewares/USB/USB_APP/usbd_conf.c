@@ -19,6 +19,7 @@
  */
 #include "stm32f4xx_hal.h"
 #include "usbd_core.h"
+#include "usbd_event.h"
 
 /* Private typedef -----------------------------------------------------------
  */
@@ -65,8 +66,9 @@ void HAL_PCD_MspInit(PCD_HandleTypeDef *hpcd) {
         /* Enable USB FS Clocks */
         __HAL_RCC_USB_OTG_FS_CLK_ENABLE();
 
-        /* Set USBFS Interrupt to the lowest priority */
-        HAL_NVIC_SetPriority(OTG_FS_IRQn, 1, 0);
+        /* 中断中会发布 USB 事件, 优先级不能高于
+           configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY */
+        HAL_NVIC_SetPriority(OTG_FS_IRQn, 6, 0);
 
         /* Enable USBFS Interrupt */
         HAL_NVIC_EnableIRQ(OTG_FS_IRQn);
@@ -173,6 +175,7 @@ void HAL_PCD_ResetCallback(PCD_HandleTypeDef *hpcd) {
  */
 void HAL_PCD_SuspendCallback(PCD_HandleTypeDef *hpcd) {
     g_usb_dev_state = 0;
+    usbd_event_set(USBD_EVENT_DISCONNECT);
     USBD_LL_Suspend(hpcd->pData);
     __HAL_PCD_GATE_PHYCLOCK(hpcd);
 
@@ -220,6 +223,7 @@ void HAL_PCD_ISOINIncompleteCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum) {
  */
 void HAL_PCD_ConnectCallback(PCD_HandleTypeDef *hpcd) {
     g_usb_dev_state = 1;
+    usbd_event_set(USBD_EVENT_CONNECT);
     USBD_LL_DevConnected(hpcd->pData);
 }
 
@@ -230,6 +234,7 @@ void HAL_PCD_ConnectCallback(PCD_HandleTypeDef *hpcd) {
  */
 void HAL_PCD_DisconnectCallback(PCD_HandleTypeDef *hpcd) {
     g_usb_dev_state = 0;
+    usbd_event_set(USBD_EVENT_DISCONNECT);
     USBD_LL_DevDisconnected(hpcd->pData);
 }
 
@@ -431,6 +436,7 @@ uint8_t USBD_LL_IsStallEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr) {
 USBD_StatusTypeDef USBD_LL_SetUSBAddress(USBD_HandleTypeDef *pdev,
                                          uint8_t dev_addr) {
     g_usb_dev_state = 1;
+    usbd_event_set(USBD_EVENT_CONNECT);
     HAL_StatusTypeDef hal_status = HAL_OK;
     USBD_StatusTypeDef usb_status = USBD_OK;
 
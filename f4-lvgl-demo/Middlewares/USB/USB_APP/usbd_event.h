@@ -0,0 +1,58 @@
+/**
+ * @file    usbd_event.h
+ * @author  Deadline039
+ * @brief   USB 状态事件
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * USB 回调 (中断中) 通过 `usbd_event_set` 发布状态变化, 显示任务通过
+ * `usbd_event_wait` 阻塞等待, 不再需要 1ms 轮询状态寄存器.
+ * 调度器启动后使用 FreeRTOS 事件组; 调度器启动前 (例如在 main 中直接进入
+ * USB 程序) 使用 WFI 睡眠等待中断.
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#ifndef __USBD_EVENT_H
+#define __USBD_EVENT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* 电脑正在向存储设备写入数据 */
+#define USBD_EVENT_MSC_WRITE     (1U << 0)
+/* 电脑正在从存储设备读出数据 */
+#define USBD_EVENT_MSC_READ      (1U << 1)
+/* 存储设备写数据错误 */
+#define USBD_EVENT_MSC_WRITE_ERR (1U << 2)
+/* 存储设备读数据错误 */
+#define USBD_EVENT_MSC_READ_ERR  (1U << 3)
+/* 电脑有轮询操作 (表明连接还保持着) */
+#define USBD_EVENT_MSC_POLL      (1U << 4)
+/* 设备已连接 (设置地址或检测到连接) */
+#define USBD_EVENT_CONNECT       (1U << 5)
+/* 设备断开或挂起 */
+#define USBD_EVENT_DISCONNECT    (1U << 6)
+
+/* MSC 读写活动相关的事件 */
+#define USBD_EVENT_MSC_ALL                                                     \
+    (USBD_EVENT_MSC_WRITE | USBD_EVENT_MSC_READ | USBD_EVENT_MSC_WRITE_ERR |   \
+     USBD_EVENT_MSC_READ_ERR | USBD_EVENT_MSC_POLL)
+/* 所有事件 */
+#define USBD_EVENT_ALL                                                         \
+    (USBD_EVENT_MSC_ALL | USBD_EVENT_CONNECT | USBD_EVENT_DISCONNECT)
+
+void usbd_event_init(void);
+void usbd_event_set(uint32_t events);
+uint32_t usbd_event_wait(uint32_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __USBD_EVENT_H */
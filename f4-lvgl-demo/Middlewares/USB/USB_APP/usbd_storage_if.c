@@ -20,18 +20,10 @@
  */
 
 #include "usbd_storage_if.h"
+#include "usbd_event.h"
 
 #include <bsp.h>
 
-/* 自己定义的一个标记 USB 状态的寄存器, 方便判断 USB 状态
- * bit0 : 表示电脑正在向 SD 卡写入数据
- * bit1 : 表示电脑正从 SD 卡读出数据
- * bit2 : SD 卡写数据错误标志位
- * bit3 : SD 卡读数据错误标志位
- * bit4 : 1, 表示电脑有轮询操作(表明连接还保持着)
- */
-volatile uint8_t g_usb_msc_state = 0;
-
 /* Private typedef -----------------------------------------------------------
  */
 /* Private define ------------------------------------------------------------
@@ -166,7 +158,7 @@ int8_t STORAGE_GetCapacity(uint8_t lun, uint32_t *block_num,
  */
 int8_t STORAGE_IsReady(uint8_t lun) {
     UNUSED(lun);
-    g_usb_msc_state |= 0X10;
+    usbd_event_set(USBD_EVENT_MSC_POLL);
     return USBD_OK;
 }
 
@@ -190,7 +182,7 @@ int8_t STORAGE_IsWriteProtected(uint8_t lun) {
 int8_t STORAGE_Read(uint8_t lun, uint8_t *buf, uint32_t blk_addr,
                     uint16_t blk_len) {
     int8_t ret = -1;
-    g_usb_msc_state |= 0X02;
+    usbd_event_set(USBD_EVENT_MSC_READ);
 
     switch (lun) {
         case STORAGE_DEV_NAND_FLASH:
@@ -206,7 +198,7 @@ int8_t STORAGE_Read(uint8_t lun, uint8_t *buf, uint32_t blk_addr,
     }
 
     if (ret) {
-        g_usb_msc_state |= 0X08;
+        usbd_event_set(USBD_EVENT_MSC_READ_ERR);
     }
 
     return ret;
@@ -223,7 +215,7 @@ int8_t STORAGE_Write(uint8_t lun, uint8_t *buf, uint32_t blk_addr,
                      uint16_t blk_len) {
     int8_t ret = -1;
 
-    g_usb_msc_state |= 0X01;
+    usbd_event_set(USBD_EVENT_MSC_WRITE);
 
     switch (lun) {
         case STORAGE_DEV_NAND_FLASH:
@@ -239,7 +231,7 @@ int8_t STORAGE_Write(uint8_t lun, uint8_t *buf, uint32_t blk_addr,
     }
 
     if (ret) {
-        g_usb_msc_state |= 0X04;
+        usbd_event_set(USBD_EVENT_MSC_WRITE_ERR);
     }
 
     return ret;
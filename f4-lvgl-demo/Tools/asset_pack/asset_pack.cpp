@@ -0,0 +1,1010 @@
+/**
+ * @file    asset_pack.cpp
+ * @author  Deadline039
+ * @brief   EEZ Flow 资源打包 (PC 端)
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * EEZ Studio 把整个工程的资源压缩为一块, 固件启动时全部解压到堆中. 本工具
+ * 读取 EEZ Studio 生成的 ui.c (或资源的二进制文件), 重新打包为:
+ *   分块 (默认): 核心 (常量, 全局变量, 名称, 字符串等) 和每个 flow 分别压缩,
+ *                启动时只解压核心, flow 在第一次创建 flow 状态时解压, 没有
+ *                运行的 flow 在超过 EEZ_FLOW_ASSETS_CACHE_SIZE 时被释放.
+ *   不压缩 (-x): 固件直接使用 flash 中的资源, 不占用 RAM, 但不能设置断点.
+ *
+ * flow 之间共享的数据, Value 引用的字符串和数组都放在核心中, 所以复制到
+ * 全局变量的字符串在 flow 被释放后仍然有效. flow 中指向核心的偏移记录在
+ * 重定位表中, 解压后修正. 包含未知组件的 flow 和 -k 指定的 flow 留在核心中.
+ *
+ * 打包后用固件的加载代码 (直接包含 eez-flow.cpp) 加载结果, 与原来的资源逐个
+ * 对象比较.
+ *
+ * 输出的 C 文件定义 eez_flow_packed_assets, 加入工程, 并把 eez-flow.h 中的
+ * EEZ_FLOW_PACKED_ASSETS 改为 1. EEZ Studio 重新生成 ui.c 后需要重新打包.
+ *
+ * 编译:
+ *   g++ -O2 -std=gnu++17 -o asset_pack asset_pack.cpp
+ *       ../../Middlewares/LVGL/APP/eez-flow-lz4.c -DLV_CONF_SKIP
+ *       -I../../Middlewares/LVGL/APP -I../../Middlewares/LVGL/GUI
+ *       -I../../Middlewares/LVGL/GUI/lvgl -I../../Middlewares/LVGL/GUI/lvgl/src
+ *       -I../../Middlewares/LVGL/GUI/porting -I../../User/Utils
+ * 用到的 LVGL 函数由 ../eez_stub/eez_stub.h 提供空实现.
+ *
+ * 用法:
+ *   asset_pack [-x] [-k flow] [-s 段名] [-o 输出] ui.c
+ *   -x: 不压缩, -k: flow 留在核心中 (可以多次指定), -s: 放到指定的段
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#include "eez-flow.cpp"
+
+#include "../eez_stub/eez_stub.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#if EEZ_OPTION_GUI
+#error "asset_pack only supports the LVGL assets"
+#endif /* EEZ_OPTION_GUI */
+
+/* eez::alloc 使用的分配函数 */
+extern "C" {
+void *mem_slab_alloc(size_t size) {
+    (void)size;
+    return NULL;
+}
+uint8_t mem_slab_contains(const void *ptr) {
+    (void)ptr;
+    return 0;
+}
+void mem_slab_free(void *ptr) {
+    (void)ptr;
+}
+void *lv_mem_alloc(size_t size) {
+    return malloc(size);
+}
+void lv_mem_free(void *ptr) {
+    free(ptr);
+}
+}
+
+using namespace eez;
+using namespace eez::flow;
+
+#define OWNER_NONE -2
+#define OWNER_CORE -1
+
+/**
+ * @brief 与 Assets 相同的布局. Assets 的成员有构造函数, 不是标准布局, 对它用
+ *        offsetof 没有保证, 偏移从这里得到
+ */
+typedef struct {
+    uint8_t project_major_version;
+    uint8_t project_minor_version;
+    uint8_t assets_type;
+    uint8_t external;
+    uint32_t reserved;
+    int32_t settings;
+    int32_t colors_definition;
+    uint32_t action_names[2];
+    uint32_t variable_names[2];
+    int32_t flow_definition;
+    uint32_t languages[2];
+} assets_layout_t;
+static_assert(sizeof(assets_layout_t) == sizeof(Assets), "Assets layout");
+
+/* 压缩的数据从 settings 开始, 前面的字段由加载代码填写 */
+#define ASSETS_DATA_OFFSET offsetof(assets_layout_t, settings)
+
+/* ListOfAssetsPtr 和 ListOfFundamentalType 的 items 不是公有成员 */
+#define LIST_ITEMS_OFFSET 4
+static_assert(sizeof(ListOfAssetsPtr<Value>) == 8, "list layout");
+static_assert(sizeof(ListOfFundamentalType<uint8_t>) == 8, "list layout");
+static_assert(sizeof(Value) == 16, "Value layout");
+
+/*****************************************************************************
+ * @defgroup 遍历
+ * @{
+ */
+
+/**
+ * @brief 按固件的结构遍历资源, 记录对象和偏移字段
+ */
+class walker_t {
+  public:
+    std::vector<const uint8_t *> objects; /*!< 访问顺序 */
+    std::vector<uint8_t> forced;          /*!< 字符串和数组, 必须在核心中 */
+    std::vector<std::pair<const uint8_t *, const uint8_t *>>
+        pointers;                         /*!< 偏移字段和目标 */
+    const uint8_t *flow_items = NULL;     /*!< flow 列表, 由加载代码处理 */
+    bool unknown = false;                 /*!< 有未知的组件 */
+
+    /**
+     * @brief 遍历核心
+     *
+     * @param assets 资源
+     */
+    void core(const Assets *assets) {
+        const uint8_t *t;
+
+        visit((const uint8_t *)assets);
+        follow(&assets->settings, &t);
+        if (follow(&assets->colorsDefinition, &t)) {
+            const Colors *colors = (const Colors *)t;
+            list(&colors->themes, [&](const uint8_t *p) {
+                const Theme *theme = (const Theme *)p;
+                const uint8_t *name;
+                follow(&theme->name, &name);
+                fundamental(&theme->colors);
+            });
+            fundamental(&colors->colors);
+        }
+        list(&assets->actionNames, [](const uint8_t *) {});
+        list(&assets->variableNames, [](const uint8_t *) {});
+        if (follow(&assets->flowDefinition, &t)) {
+            const FlowDefinition *fd = (const FlowDefinition *)t;
+            /* 只访问列表, flow 单独遍历 */
+            if (follow((const uint8_t *)&fd->flows + LIST_ITEMS_OFFSET, &t)) {
+                flow_items = t;
+            }
+            list(&fd->constants,
+                 [&](const uint8_t *p) { value((const Value *)p); });
+            list(&fd->globalVariables,
+                 [&](const uint8_t *p) { value((const Value *)p); });
+        }
+        list(&assets->languages, [&](const uint8_t *p) {
+            const Language *language = (const Language *)p;
+            const uint8_t *id;
+            follow(&language->languageID, &id);
+            list(&language->translations, [](const uint8_t *) {});
+        });
+    }
+
+    /**
+     * @brief 遍历一个 flow
+     *
+     * @param f flow
+     */
+    void flow(const Flow *f) {
+        visit((const uint8_t *)f);
+        list(&f->components,
+             [&](const uint8_t *p) { component((const Component *)p); });
+        list(&f->localVariables,
+             [&](const uint8_t *p) { value((const Value *)p); });
+        fundamental(&f->componentInputs);
+        list(&f->widgetDataItems, [](const uint8_t *) {});
+        list(&f->widgetActions, [](const uint8_t *) {});
+        fundamental(&f->userPropertiesAssignable);
+    }
+
+  private:
+    std::map<const uint8_t *, size_t> index;
+    bool force = false;
+
+    /**
+     * @brief 记录对象
+     *
+     * @param p 对象
+     * @return 是否第一次访问
+     */
+    bool visit(const uint8_t *p) {
+        auto it = index.find(p);
+
+        if (it != index.end()) {
+            forced[it->second] |= force;
+            return false;
+        }
+        index[p] = objects.size();
+        objects.push_back(p);
+        forced.push_back(force);
+        return true;
+    }
+
+    /**
+     * @brief 记录偏移字段, 访问目标
+     *
+     * @param field 字段 (AssetsPtr 或者 Value 的 int32Value)
+     * @param[out] target 目标, 偏移为 0 时为 NULL
+     * @return 是否第一次访问目标
+     */
+    bool follow(const void *field, const uint8_t **target) {
+        int32_t offset;
+
+        memcpy(&offset, field, sizeof(offset));
+        if (offset == 0) {
+            *target = NULL;
+            return false;
+        }
+        *target = (const uint8_t *)field + offset;
+        pointers.push_back({(const uint8_t *)field, *target});
+        return visit(*target);
+    }
+
+    /**
+     * @brief ListOfFundamentalType
+     */
+    void fundamental(const void *l) {
+        const uint8_t *items;
+        follow((const uint8_t *)l + LIST_ITEMS_OFFSET, &items);
+    }
+
+    /**
+     * @brief ListOfAssetsPtr, 对第一次访问的元素调用 item
+     */
+    template <typename F>
+    void list(const void *l, F item) {
+        uint32_t count;
+        const uint8_t *items, *t;
+
+        memcpy(&count, l, sizeof(count));
+        if (!follow((const uint8_t *)l + LIST_ITEMS_OFFSET, &items)) {
+            return;
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            if (follow(items + i * sizeof(int32_t), &t)) {
+                item(t);
+            }
+        }
+    }
+
+    /**
+     * @brief 资源中的 Value, 字符串和数组的偏移相对于 int32Value
+     */
+    void value(const Value *v) {
+        const uint8_t *t;
+        bool saved = force;
+
+        if (v->type != VALUE_TYPE_STRING_ASSET &&
+            v->type != VALUE_TYPE_ARRAY_ASSET) {
+            return;
+        }
+        force = true;
+        if (follow(&v->int32Value, &t) && v->type == VALUE_TYPE_ARRAY_ASSET) {
+            const ArrayValue *array = (const ArrayValue *)t;
+            for (uint32_t i = 0; i < array->arraySize; ++i) {
+                value(&array->values[i]);
+            }
+        }
+        force = saved;
+    }
+
+    /**
+     * @brief 组件, 只有下面几种组件在 Component 之后还有偏移字段
+     */
+    void component(const Component *c) {
+        const uint8_t *t;
+
+        fundamental(&c->inputs);
+        list(&c->properties, [](const uint8_t *) {});
+        list(&c->outputs, [&](const uint8_t *p) {
+            list(&((const ComponentOutput *)p)->connections,
+                 [](const uint8_t *) {});
+        });
+
+        switch (c->type) {
+            case defs_v3::COMPONENT_TYPE_SET_VARIABLE_ACTION:
+                list(&((const SetVariableActionComponent *)c)->entries,
+                     [&](const uint8_t *p) {
+                         const SetVariableEntry *e = (const SetVariableEntry *)p;
+                         follow(&e->variable, &t);
+                         follow(&e->value, &t);
+                     });
+                break;
+
+            case defs_v3::COMPONENT_TYPE_SWITCH_ACTION:
+                list(&((const SwitchActionComponent *)c)->tests,
+                     [&](const uint8_t *p) {
+                         const SwitchTest *test = (const SwitchTest *)p;
+                         follow(&test->condition, &t);
+                         follow(&test->outputValue, &t);
+                     });
+                break;
+
+            case defs_v3::COMPONENT_TYPE_LVGL_ACTION:
+                list(&((const LVGLApiComponent *)c)->actions,
+                     [&](const uint8_t *p) {
+                         list(&((const LVGLApiComponent_ActionType *)p)
+                                   ->properties,
+                              [](const uint8_t *) {});
+                     });
+                break;
+
+            default:
+                if (!(c->type < defs_v3::COMPONENT_TYPE_START_ACTION ||
+                      (c->type > defs_v3::COMPONENT_TYPE_START_ACTION &&
+                       c->type <= defs_v3::COMPONENT_TYPE_SET_COLOR_THEME_ACTION) ||
+                      c->type >= defs_v3::FIRST_DASHBOARD_WIDGET_COMPONENT_TYPE)) {
+                    unknown = true;
+                }
+                break;
+        }
+    }
+};
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup 输入
+ * @{
+ */
+
+/**
+ * @brief 读取 ui.c 中的 assets 数组或者二进制文件
+ *
+ * @param path 路径
+ * @param[out] data 数据
+ * @return 是否成功
+ */
+static bool input_load(const char *path, std::vector<uint8_t> &data) {
+    FILE *fp = fopen(path, "rb");
+    std::vector<char> text;
+    char buf[4096];
+    size_t n;
+
+    if (fp == NULL) {
+        return false;
+    }
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        text.insert(text.end(), buf, buf + n);
+    }
+    fclose(fp);
+    text.push_back('\0');
+
+    const char *p = strstr(text.data(), "assets[");
+    if (p == NULL) {
+        data.assign(text.begin(), text.end() - 1);
+        return true;
+    }
+
+    p = strchr(p, '{');
+    if (p == NULL) {
+        return false;
+    }
+    data.clear();
+    for (++p; *p != '\0' && *p != '}'; ++p) {
+        if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+            data.push_back((uint8_t)strtoul(p, (char **)&p, 16));
+            --p;
+        }
+    }
+
+    return *p == '}';
+}
+
+/**
+ * @brief 得到解压后的资源, Assets 从 image 开始
+ *
+ * @param data 输入
+ * @param[out] image 8 字节对齐的资源
+ * @param[out] size 大小
+ * @return 是否成功
+ */
+static bool input_decode(const std::vector<uint8_t> &data,
+                         std::vector<uint64_t> &image, size_t &size) {
+    Header header;
+    size_t offset = ASSETS_DATA_OFFSET;
+
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+
+    if (header.tag == HEADER_TAG) {
+        size = data.size() - sizeof(uint32_t);
+        image.assign((size + 7) / 8, 0);
+        memcpy(image.data(), data.data() + sizeof(uint32_t), size);
+        return true;
+    }
+    if (header.tag != HEADER_TAG_COMPRESSED) {
+        fprintf(stderr, "Unsupported assets (tag 0x%08X).\n",
+                (unsigned)header.tag);
+        return false;
+    }
+
+    size = offset + header.decompressedSize;
+    image.assign((size + 7) / 8, 0);
+    Assets *assets = (Assets *)image.data();
+    assets->projectMajorVersion = header.projectMajorVersion;
+    assets->projectMinorVersion = header.projectMinorVersion;
+    assets->assetsType = header.assetsType;
+    assets->external = 0;
+
+    return LZ4_decompress_safe((const char *)data.data() + sizeof(header),
+                               (char *)image.data() + offset,
+                               (int)(data.size() - sizeof(header)),
+                               (int)header.decompressedSize) ==
+           (int)header.decompressedSize;
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup 打包
+ * @{
+ */
+
+/**
+ * @brief 对象的新位置
+ */
+typedef struct {
+    int owner;       /*!< OWNER_CORE 或者 flow 序号 */
+    uint32_t offset; /*!< 在核心或者 flow 中的偏移 */
+    uint32_t size;   /*!< 到下一个对象为止的大小 */
+} place_t;
+
+/**
+ * @brief 一块数据
+ */
+typedef struct {
+    std::vector<uint8_t> data;
+    std::vector<uint32_t> relocations;
+    bool resident; /*!< 留在核心中 */
+} chunk_t;
+
+/**
+ * @brief 追加对象, 保持相对于起点的 8 字节对齐
+ *
+ * @param buf 目标
+ * @param src 对象
+ * @param size 大小
+ * @param align 原来的偏移
+ * @return 新的偏移
+ */
+static uint32_t pack_append(std::vector<uint8_t> &buf, const uint8_t *src,
+                            uint32_t size, uint32_t align) {
+    uint32_t offset = (uint32_t)buf.size();
+
+    offset += (align - offset) & 7U;
+    buf.resize(offset + size, 0);
+    memcpy(buf.data() + offset, src, size);
+
+    return offset;
+}
+
+/**
+ * @brief 写入偏移
+ */
+static void pack_write_offset(std::vector<uint8_t> &buf, uint32_t field,
+                              int32_t offset) {
+    memcpy(buf.data() + field, &offset, sizeof(offset));
+}
+
+/**
+ * @brief 划分核心和各个 flow, 重新排列并修正偏移
+ *
+ * @param image 资源
+ * @param size 大小
+ * @param keep 留在核心中的 flow
+ * @param[out] core 核心
+ * @param[out] chunks 每个 flow
+ * @return 是否成功
+ */
+static bool pack_split(const uint8_t *image, size_t size,
+                       const std::set<uint32_t> &keep,
+                       std::vector<uint8_t> &core,
+                       std::vector<chunk_t> &chunks) {
+    const Assets *assets = (const Assets *)image;
+    walker_t core_walk;
+    std::vector<walker_t> flow_walks;
+    std::map<const uint8_t *, int> owner;
+    std::vector<const uint8_t *> roots;
+
+    core_walk.core(assets);
+    for (auto p : core_walk.objects) {
+        owner[p] = OWNER_CORE;
+    }
+
+    const FlowDefinition *fd = assets->flowDefinition;
+    uint32_t flow_num = fd ? fd->flows.count : 0;
+    chunks.assign(flow_num, chunk_t());
+    flow_walks.resize(flow_num);
+    for (uint32_t i = 0; i < flow_num; ++i) {
+        roots.push_back((const uint8_t *)fd->flows[i]);
+        flow_walks[i].flow(fd->flows[i]);
+        chunks[i].resident = keep.count(i) || flow_walks[i].unknown;
+        if (flow_walks[i].unknown) {
+            printf("Flow %u has unknown components, kept in the core.\n", i);
+        }
+    }
+
+    /* 留在核心中的 flow 先处理, 其他 flow 共享的对象放在核心中 */
+    for (uint32_t i = 0; i < flow_num; ++i) {
+        if (chunks[i].resident) {
+            for (auto p : flow_walks[i].objects) {
+                owner[p] = OWNER_CORE;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < flow_num; ++i) {
+        if (chunks[i].resident) {
+            continue;
+        }
+        const walker_t &w = flow_walks[i];
+        for (size_t k = 0; k < w.objects.size(); ++k) {
+            auto it = owner.find(w.objects[k]);
+            if (w.forced[k]) {
+                owner[w.objects[k]] = OWNER_CORE;
+            } else if (it == owner.end()) {
+                owner[w.objects[k]] = (int)i;
+            } else if (it->second != (int)i) {
+                it->second = OWNER_CORE;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < flow_num; ++i) {
+        if (!chunks[i].resident && owner[roots[i]] != (int)i) {
+            chunks[i].resident = true;
+        }
+    }
+
+    /* 对象到下一个对象为止, 包括填充和内嵌的数据 */
+    std::vector<const uint8_t *> starts;
+    for (auto &it : owner) {
+        if (it.first < image || it.first >= image + size) {
+            fprintf(stderr, "Offset out of the assets.\n");
+            return false;
+        }
+        starts.push_back(it.first);
+    }
+    std::map<const uint8_t *, place_t> place;
+    for (size_t k = 0; k < starts.size(); ++k) {
+        const uint8_t *end = k + 1 < starts.size() ? starts[k + 1] : image + size;
+        place[starts[k]] = {owner[starts[k]], 0, (uint32_t)(end - starts[k])};
+    }
+    if (starts.empty() || starts[0] != image) {
+        fprintf(stderr, "Invalid assets.\n");
+        return false;
+    }
+
+    /* 核心和 flow 中的对象保持原来的顺序, flow 从 Flow 开始 */
+    core.clear();
+    for (auto p : starts) {
+        place_t &pl = place[p];
+        if (pl.owner == OWNER_CORE) {
+            pl.offset = pack_append(core, p, pl.size, (uint32_t)(p - image));
+        }
+    }
+    for (uint32_t i = 0; i < flow_num; ++i) {
+        if (chunks[i].resident) {
+            continue;
+        }
+        uint32_t root = (uint32_t)(roots[i] - image);
+        place_t &pl = place[roots[i]];
+        pl.offset = pack_append(chunks[i].data, roots[i], pl.size, 0);
+        for (auto p : starts) {
+            place_t &q = place[p];
+            if (q.owner == (int)i && p != roots[i]) {
+                q.offset = pack_append(chunks[i].data, p, q.size,
+                                       (uint32_t)(p - image) - root);
+            }
+        }
+    }
+
+    /* 修正偏移 */
+    auto locate = [&](const uint8_t *p, int &o, uint32_t &offset) {
+        auto it = std::upper_bound(starts.begin(), starts.end(), p);
+        const uint8_t *start = *(it - 1);
+        const place_t &pl = place[start];
+        o = pl.owner;
+        offset = pl.offset + (uint32_t)(p - start);
+    };
+    std::set<const uint8_t *> done;
+    auto relocate = [&](const std::pair<const uint8_t *, const uint8_t *> &ptr) {
+        int field_owner, target_owner;
+        uint32_t field, target;
+
+        if (!done.insert(ptr.first).second) {
+            return true;
+        }
+        locate(ptr.first, field_owner, field);
+        locate(ptr.second, target_owner, target);
+        if (field_owner == target_owner) {
+            pack_write_offset(field_owner == OWNER_CORE
+                                  ? core
+                                  : chunks[field_owner].data,
+                              field, (int32_t)(target - field));
+        } else if (target_owner == OWNER_CORE) {
+            /* 按 flow 在核心起点计算, 加载时加上实际的差值 */
+            pack_write_offset(chunks[field_owner].data, field,
+                              (int32_t)(target - field));
+            chunks[field_owner].relocations.push_back(field);
+        } else {
+            fprintf(stderr, "Unexpected offset from %s to flow %d.\n",
+                    field_owner == OWNER_CORE ? "the core" : "another flow",
+                    target_owner);
+            return false;
+        }
+        return true;
+    };
+
+    for (auto &ptr : core_walk.pointers) {
+        if (!relocate(ptr)) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < flow_num; ++i) {
+        for (auto &ptr : flow_walks[i].pointers) {
+            if (!relocate(ptr)) {
+                return false;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < flow_num; ++i) {
+        const uint8_t *item = core_walk.flow_items + i * sizeof(int32_t);
+        int o;
+        uint32_t field;
+
+        locate(item, o, field);
+        if (chunks[i].resident) {
+            if (!relocate({item, roots[i]})) {
+                return false;
+            }
+        } else {
+            pack_write_offset(core, field, 0);
+        }
+    }
+    for (auto &chunk : chunks) {
+        std::sort(chunk.relocations.begin(), chunk.relocations.end());
+    }
+
+    return true;
+}
+
+/**
+ * @brief 压缩
+ */
+static std::vector<uint8_t> pack_compress(const uint8_t *src, size_t size) {
+    std::vector<uint8_t> dst(LZ4_compressBound((int)size));
+    int n = LZ4_compress_default((const char *)src, (char *)dst.data(),
+                                 (int)size, (int)dst.size());
+
+    dst.resize(n > 0 ? n : 0);
+    return dst;
+}
+
+/**
+ * @brief 生成分块的资源
+ *
+ * @param header 原来的头
+ * @param core 核心
+ * @param chunks 每个 flow
+ * @param[out] out 结果
+ */
+static void pack_chunked(const Assets *assets, const std::vector<uint8_t> &core,
+                         const std::vector<chunk_t> &chunks,
+                         std::vector<uint8_t> &out) {
+    size_t offset = ASSETS_DATA_OFFSET;
+    ChunkedHeader header;
+    std::vector<AssetsChunk> table(chunks.size());
+    std::vector<uint8_t> core_data =
+        pack_compress(core.data() + offset, core.size() - offset);
+
+    memset(&header, 0, sizeof(header));
+    header.header.tag = HEADER_TAG_CHUNKED;
+    header.header.projectMajorVersion = assets->projectMajorVersion;
+    header.header.projectMinorVersion = assets->projectMinorVersion;
+    header.header.assetsType = assets->assetsType;
+    header.header.decompressedSize = (uint32_t)(core.size() - offset);
+    header.numChunks = (uint32_t)chunks.size();
+    header.coreCompressedSize = (uint32_t)core_data.size();
+
+    out.assign(sizeof(header) + table.size() * sizeof(AssetsChunk), 0);
+    out.insert(out.end(), core_data.begin(), core_data.end());
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        AssetsChunk &entry = table[i];
+        memset(&entry, 0, sizeof(entry));
+        if (chunks[i].resident) {
+            continue;
+        }
+        std::vector<uint8_t> data =
+            pack_compress(chunks[i].data.data(), chunks[i].data.size());
+        entry.offset = (uint32_t)out.size();
+        entry.compressedSize = (uint32_t)data.size();
+        entry.size = (uint32_t)chunks[i].data.size();
+        out.insert(out.end(), data.begin(), data.end());
+        out.resize((out.size() + 3) & ~(size_t)3, 0);
+        entry.relocationsOffset = (uint32_t)out.size();
+        entry.numRelocations = (uint32_t)chunks[i].relocations.size();
+        out.resize(out.size() + chunks[i].relocations.size() * sizeof(uint32_t));
+        memcpy(out.data() + entry.relocationsOffset,
+               chunks[i].relocations.data(),
+               chunks[i].relocations.size() * sizeof(uint32_t));
+    }
+
+    memcpy(out.data(), &header, sizeof(header));
+    memcpy(out.data() + sizeof(header), table.data(),
+           table.size() * sizeof(AssetsChunk));
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup 检查
+ * @{
+ */
+
+/**
+ * @brief 比较两次遍历, 偏移字段比较目标是否为同一个对象
+ *
+ * @param a 原来的资源
+ * @param b 加载后的资源
+ * @param extent 原来的资源中每个对象的大小
+ * @return 是否相同
+ */
+static bool verify_walk(const walker_t &a, const walker_t &b,
+                        const std::map<const uint8_t *, uint32_t> &extent) {
+    std::map<const uint8_t *, size_t> index_a, index_b;
+    std::map<size_t, std::set<uint32_t>> skip;
+
+    if (a.objects.size() != b.objects.size() ||
+        a.pointers.size() != b.pointers.size()) {
+        return false;
+    }
+    for (size_t k = 0; k < a.objects.size(); ++k) {
+        index_a[a.objects[k]] = k;
+        index_b[b.objects[k]] = k;
+    }
+
+    /* 偏移字段所在的对象和目标相同 */
+    auto owner_of = [](const std::map<const uint8_t *, size_t> &index,
+                       const uint8_t *p, size_t &k, uint32_t &offset) {
+        auto it = index.upper_bound(p);
+        if (it == index.begin()) {
+            return false;
+        }
+        --it;
+        k = it->second;
+        offset = (uint32_t)(p - it->first);
+        return true;
+    };
+    for (size_t k = 0; k < a.pointers.size(); ++k) {
+        size_t fa, fb, ta, tb;
+        uint32_t oa, ob;
+        if (!owner_of(index_a, a.pointers[k].first, fa, oa) ||
+            !owner_of(index_b, b.pointers[k].first, fb, ob) || fa != fb ||
+            oa != ob) {
+            return false;
+        }
+        ta = index_a.at(a.pointers[k].second);
+        tb = index_b.at(b.pointers[k].second);
+        if (ta != tb) {
+            return false;
+        }
+        skip[fa].insert(oa);
+    }
+    if (a.flow_items != NULL) {
+        size_t k = index_a.at(a.flow_items);
+        for (uint32_t o = 0; o < extent.at(a.flow_items); o += 4) {
+            skip[k].insert(o);
+        }
+    }
+
+    /* 其余内容相同 */
+    for (size_t k = 0; k < a.objects.size(); ++k) {
+        uint32_t size = extent.at(a.objects[k]);
+        const std::set<uint32_t> &s = skip[k];
+        for (uint32_t o = 0; o < size; ++o) {
+            if (s.count(o & ~3U)) {
+                continue;
+            }
+            if (a.objects[k][o] != b.objects[k][o]) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief 用固件的代码加载打包结果, 与原来的资源比较
+ *
+ * @param image 原来的资源
+ * @param size 大小
+ * @param out 打包结果
+ * @return 是否相同
+ */
+static bool verify(const uint8_t *image, size_t size,
+                   const std::vector<uint8_t> &out) {
+    const Assets *assets = (const Assets *)image;
+    walker_t all;
+    std::vector<const uint8_t *> starts;
+    std::map<const uint8_t *, uint32_t> extent;
+
+    /* 原来的资源中对象的大小 */
+    all.core(assets);
+    const FlowDefinition *fd = assets->flowDefinition;
+    uint32_t flow_num = fd ? fd->flows.count : 0;
+    for (uint32_t i = 0; i < flow_num; ++i) {
+        all.flow(fd->flows[i]);
+    }
+    starts = all.objects;
+    std::sort(starts.begin(), starts.end());
+    for (size_t k = 0; k < starts.size(); ++k) {
+        const uint8_t *end = k + 1 < starts.size() ? starts[k + 1] : image + size;
+        extent[starts[k]] = (uint32_t)(end - starts[k]);
+    }
+
+    /* 固件中 eez_flow_init 的做法 */
+    uint8_t *packed = (uint8_t *)aligned_alloc(8, (out.size() + 7) & ~(size_t)7);
+    memcpy(packed, out.data(), out.size());
+    loadMainAssets(packed, (uint32_t)out.size());
+
+    walker_t core_a, core_b;
+    core_a.core(assets);
+    core_b.core(g_mainAssets);
+    if (!verify_walk(core_a, core_b, extent)) {
+        fprintf(stderr, "Core differs.\n");
+        return false;
+    }
+
+    FlowDefinition *loaded = g_mainAssets->flowDefinition;
+    if (loaded->flows.count != flow_num) {
+        return false;
+    }
+    for (uint32_t i = 0; i < flow_num; ++i) {
+        walker_t flow_a, flow_b;
+        Flow *f = getFlow(loaded, i);
+        if (f == NULL) {
+            fprintf(stderr, "Flow %u can not be loaded.\n", i);
+            return false;
+        }
+        flow_a.flow(fd->flows[i]);
+        flow_b.flow(f);
+        if (!verify_walk(flow_a, flow_b, extent)) {
+            fprintf(stderr, "Flow %u differs.\n", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @brief 输出 C 文件, 格式与 EEZ Studio 生成的 ui.c 相同
+ *
+ * @param path 路径
+ * @param data 数据
+ * @param section 段名, 可以为 NULL
+ * @param source 输入文件
+ * @return 是否成功
+ */
+static bool output_write(const char *path, const std::vector<uint8_t> &data,
+                         const char *section, const char *source) {
+    FILE *fp = fopen(path, "w");
+
+    if (fp == NULL) {
+        return false;
+    }
+    fprintf(fp, "/* Generated by asset_pack from %s, do not edit */\n\n",
+            source);
+    fprintf(fp, "#include <stdint.h>\n\n");
+    /* Value 需要字对齐 */
+    if (section != NULL) {
+        fprintf(fp, "__attribute__((section(\"%s\"), aligned(8)))\n", section);
+    } else {
+        fprintf(fp, "__attribute__((aligned(8)))\n");
+    }
+    fprintf(fp, "const uint8_t eez_flow_packed_assets[%zu] = {", data.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+        fprintf(fp, "%s0x%02X%s", i % 16 == 0 ? "\n    " : "", data[i],
+                i + 1 < data.size() ? (i % 16 == 15 ? "," : ", ") : "");
+    }
+    fprintf(fp, "\n};\n\n");
+    fprintf(fp, "const uint32_t eez_flow_packed_assets_size = %zu;\n",
+            data.size());
+    fclose(fp);
+
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    const char *input = NULL, *output = "eez_flow_assets.c", *section = NULL;
+    bool uncompressed = false;
+    std::set<uint32_t> keep;
+    std::vector<uint8_t> data, out, core;
+    std::vector<uint64_t> image;
+    std::vector<chunk_t> chunks;
+    size_t size;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-x") == 0) {
+            uncompressed = true;
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            keep.insert((uint32_t)strtoul(argv[++i], NULL, 0));
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            section = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (argv[i][0] == '-') {
+            input = NULL;
+            break;
+        } else {
+            input = argv[i];
+        }
+    }
+    if (input == NULL) {
+        fprintf(stderr,
+                "Usage: %s [-x] [-k flow] [-s section] [-o output] ui.c\n",
+                argv[0]);
+        return 1;
+    }
+
+    if (!input_load(input, data)) {
+        fprintf(stderr, "Can not read %s.\n", input);
+        return 1;
+    }
+    if (!input_decode(data, image, size)) {
+        fprintf(stderr, "Invalid assets.\n");
+        return 1;
+    }
+    const uint8_t *img = (const uint8_t *)image.data();
+    const Assets *assets = (const Assets *)img;
+
+    printf("Input: %zu bytes, %zu bytes decompressed.\n", data.size(), size);
+
+    if (uncompressed) {
+        uint32_t tag = HEADER_TAG;
+        out.assign((const uint8_t *)&tag, (const uint8_t *)&tag + sizeof(tag));
+        out.insert(out.end(), img, img + size);
+        printf("Uncompressed: %zu bytes of flash, no RAM.\n", out.size());
+    } else {
+        if (!pack_split(img, size, keep, core, chunks)) {
+            return 1;
+        }
+        pack_chunked(assets, core, chunks, out);
+
+        const ChunkedHeader *header = (const ChunkedHeader *)out.data();
+        const AssetsChunk *table = (const AssetsChunk *)(header + 1);
+        size_t max_size = 0, total_size = 0;
+        printf("Core: %zu bytes, %u compressed.\n", core.size(),
+               (unsigned)header->coreCompressedSize);
+        printf("\nFlow        size  compressed  relocations\n");
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            if (chunks[i].resident) {
+                printf("%4zu    in the core\n", i);
+                continue;
+            }
+            printf("%4zu  %10u  %10u  %11u\n", i, (unsigned)table[i].size,
+                   (unsigned)table[i].compressedSize,
+                   (unsigned)table[i].numRelocations);
+            max_size = std::max(max_size, (size_t)table[i].size);
+            total_size += table[i].size;
+        }
+        printf("\nChunked: %zu bytes of flash, RAM %zu at start (was %zu), "
+               "%zu with every flow loaded, largest flow %zu.\n",
+               out.size(), core.size(), size, core.size() + total_size,
+               max_size);
+    }
+
+    if (!verify(img, size, out)) {
+        fprintf(stderr, "Verification failed.\n");
+        return 1;
+    }
+    if (!output_write(output, out, section, input)) {
+        fprintf(stderr, "Can not write %s.\n", output);
+        return 1;
+    }
+    printf("Verified, written to %s.\n", output);
+
+    return 0;
+}
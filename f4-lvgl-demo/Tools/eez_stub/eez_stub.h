@@ -0,0 +1,390 @@
+/**
+ * @file    eez_stub.h
+ * @author  Deadline039
+ * @brief   EEZ Flow PC 端工具的 LVGL 和固件函数空实现
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * expr_bench, string_bench 和 asset_pack 直接包含 eez-flow.cpp, 链接时需要
+ * 其中引用的 LVGL 控件, 动画, 输入设备, UI (screens.c, vars.c) 和内存管理
+ * 函数. 这些工具只使用资源加载, 表达式求值和 Value, 不会创建 LVGL 对象,
+ * 所以在这里提供空实现, 不需要编译 LVGL.
+ *
+ * 在 `#include "eez-flow.cpp"` 之后包含本文件. mem_slab_alloc,
+ * mem_slab_contains, mem_slab_free, lv_mem_alloc 和 lv_mem_free 由各工具
+ * 自己实现 (string_bench 需要统计分配次数).
+ *
+ * eez-flow.cpp 新增了对其他函数的调用时, 链接会报未定义的符号, 在这里补上
+ * 对应的空实现.
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#ifndef __EEZ_STUB_H
+#define __EEZ_STUB_H
+
+#include <stdlib.h>
+#include <time.h>
+
+extern "C" {
+
+/*****************************************************************************
+ * @defgroup 内存管理
+ * @{
+ */
+
+void *mem_heap_alloc(size_t size, mem_heap_hint_t hint, mem_heap_user_t user) {
+    (void)hint;
+    (void)user;
+    return malloc(size);
+}
+
+void mem_heap_free(void *ptr) {
+    free(ptr);
+}
+
+size_t mem_heap_get_free_size(void) {
+    return 0;
+}
+
+void mem_heap_get_user_stat(mem_heap_user_t user, mem_heap_user_stat_t *stat) {
+    (void)user;
+    memset(stat, 0, sizeof(*stat));
+}
+
+int mem_slab_init(void *start, size_t size) {
+    (void)start;
+    (void)size;
+    return 0;
+}
+
+void mem_slab_get_stat(mem_slab_stat_t *stat) {
+    memset(stat, 0, sizeof(*stat));
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup UI (EEZ Studio 生成)
+ * @{
+ */
+
+native_var_t native_vars[] = {{NATIVE_VAR_TYPE_NONE, NULL, NULL}};
+
+void create_screens() {
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup LVGL
+ * @{
+ */
+
+uint32_t lv_tick_get(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000U + ts.tv_nsec / 1000000U);
+}
+
+const lv_obj_class_t lv_btnmatrix_class = {};
+
+void lv_anim_init(lv_anim_t *a) {
+    memset(a, 0, sizeof(*a));
+}
+
+lv_anim_t *lv_anim_start(const lv_anim_t *a) {
+    (void)a;
+    return NULL;
+}
+
+int32_t lv_anim_path_linear(const lv_anim_t *a) {
+    (void)a;
+    return 0;
+}
+
+int32_t lv_anim_path_ease_in(const lv_anim_t *a) {
+    (void)a;
+    return 0;
+}
+
+int32_t lv_anim_path_ease_out(const lv_anim_t *a) {
+    (void)a;
+    return 0;
+}
+
+int32_t lv_anim_path_ease_in_out(const lv_anim_t *a) {
+    (void)a;
+    return 0;
+}
+
+int32_t lv_anim_path_overshoot(const lv_anim_t *a) {
+    (void)a;
+    return 0;
+}
+
+int32_t lv_anim_path_bounce(const lv_anim_t *a) {
+    (void)a;
+    return 0;
+}
+
+lv_event_code_t lv_event_get_code(lv_event_t *e) {
+    (void)e;
+    return LV_EVENT_ALL;
+}
+
+struct _lv_obj_t *lv_event_get_target(lv_event_t *e) {
+    (void)e;
+    return NULL;
+}
+
+struct _lv_obj_t *lv_event_get_current_target(lv_event_t *e) {
+    (void)e;
+    return NULL;
+}
+
+void *lv_event_get_param(lv_event_t *e) {
+    (void)e;
+    return NULL;
+}
+
+void *lv_event_get_user_data(lv_event_t *e) {
+    (void)e;
+    return NULL;
+}
+
+void lv_group_focus_obj(struct _lv_obj_t *obj) {
+    (void)obj;
+}
+
+void lv_group_focus_next(lv_group_t *group) {
+    (void)group;
+}
+
+void lv_group_focus_prev(lv_group_t *group) {
+    (void)group;
+}
+
+void lv_group_focus_freeze(lv_group_t *group, bool en) {
+    (void)group;
+    (void)en;
+}
+
+struct _lv_obj_t *lv_group_get_focused(const lv_group_t *group) {
+    (void)group;
+    return NULL;
+}
+
+void lv_group_set_editing(lv_group_t *group, bool edit) {
+    (void)group;
+    (void)edit;
+}
+
+void lv_group_set_wrap(lv_group_t *group, bool en) {
+    (void)group;
+    (void)en;
+}
+
+lv_indev_t *lv_indev_get_act(void) {
+    return NULL;
+}
+
+lv_dir_t lv_indev_get_gesture_dir(const lv_indev_t *indev) {
+    (void)indev;
+    return LV_DIR_NONE;
+}
+
+void lv_indev_wait_release(lv_indev_t *indev) {
+    (void)indev;
+}
+
+void lv_scr_load_anim(lv_obj_t *scr, lv_scr_load_anim_t anim_type,
+                      uint32_t time, uint32_t delay, bool auto_del) {
+    (void)scr;
+    (void)anim_type;
+    (void)time;
+    (void)delay;
+    (void)auto_del;
+}
+
+void lv_obj_add_flag(lv_obj_t *obj, lv_obj_flag_t f) {
+    (void)obj;
+    (void)f;
+}
+
+void lv_obj_clear_flag(lv_obj_t *obj, lv_obj_flag_t f) {
+    (void)obj;
+    (void)f;
+}
+
+bool lv_obj_has_flag(const lv_obj_t *obj, lv_obj_flag_t f) {
+    (void)obj;
+    (void)f;
+    return false;
+}
+
+void lv_obj_add_state(lv_obj_t *obj, lv_state_t state) {
+    (void)obj;
+    (void)state;
+}
+
+void lv_obj_clear_state(lv_obj_t *obj, lv_state_t state) {
+    (void)obj;
+    (void)state;
+}
+
+bool lv_obj_has_state(const lv_obj_t *obj, lv_state_t state) {
+    (void)obj;
+    (void)state;
+    return false;
+}
+
+bool lv_obj_check_type(const lv_obj_t *obj, const lv_obj_class_t *class_p) {
+    (void)obj;
+    (void)class_p;
+    return false;
+}
+
+lv_coord_t lv_obj_get_x(const struct _lv_obj_t *obj) {
+    (void)obj;
+    return 0;
+}
+
+lv_coord_t lv_obj_get_y(const struct _lv_obj_t *obj) {
+    (void)obj;
+    return 0;
+}
+
+lv_coord_t lv_obj_get_x_aligned(const struct _lv_obj_t *obj) {
+    (void)obj;
+    return 0;
+}
+
+lv_coord_t lv_obj_get_y_aligned(const struct _lv_obj_t *obj) {
+    (void)obj;
+    return 0;
+}
+
+lv_coord_t lv_obj_get_width(const struct _lv_obj_t *obj) {
+    (void)obj;
+    return 0;
+}
+
+lv_coord_t lv_obj_get_height(const struct _lv_obj_t *obj) {
+    (void)obj;
+    return 0;
+}
+
+void lv_obj_set_x(struct _lv_obj_t *obj, lv_coord_t x) {
+    (void)obj;
+    (void)x;
+}
+
+void lv_obj_set_y(struct _lv_obj_t *obj, lv_coord_t y) {
+    (void)obj;
+    (void)y;
+}
+
+void lv_obj_set_width(struct _lv_obj_t *obj, lv_coord_t w) {
+    (void)obj;
+    (void)w;
+}
+
+void lv_obj_set_height(struct _lv_obj_t *obj, lv_coord_t h) {
+    (void)obj;
+    (void)h;
+}
+
+void lv_obj_update_layout(const struct _lv_obj_t *obj) {
+    (void)obj;
+}
+
+lv_style_value_t lv_obj_get_style_prop(const struct _lv_obj_t *obj,
+                                       lv_part_t part, lv_style_prop_t prop) {
+    lv_style_value_t value;
+
+    (void)obj;
+    (void)part;
+    (void)prop;
+    memset(&value, 0, sizeof(value));
+    return value;
+}
+
+void lv_obj_set_style_opa(struct _lv_obj_t *obj, lv_opa_t value,
+                          lv_style_selector_t selector) {
+    (void)obj;
+    (void)value;
+    (void)selector;
+}
+
+void lv_label_set_text(lv_obj_t *obj, const char *text) {
+    (void)obj;
+    (void)text;
+}
+
+void lv_img_set_src(lv_obj_t *obj, const void *src) {
+    (void)obj;
+    (void)src;
+}
+
+void lv_img_set_angle(lv_obj_t *obj, int16_t angle) {
+    (void)obj;
+    (void)angle;
+}
+
+uint16_t lv_img_get_angle(lv_obj_t *obj) {
+    (void)obj;
+    return 0;
+}
+
+void lv_img_set_zoom(lv_obj_t *obj, uint16_t zoom) {
+    (void)obj;
+    (void)zoom;
+}
+
+uint16_t lv_img_get_zoom(lv_obj_t *obj) {
+    (void)obj;
+    return LV_IMG_ZOOM_NONE;
+}
+
+void lv_arc_set_value(lv_obj_t *obj, int16_t value) {
+    (void)obj;
+    (void)value;
+}
+
+void lv_bar_set_value(lv_obj_t *obj, int32_t value, lv_anim_enable_t anim) {
+    (void)obj;
+    (void)value;
+    (void)anim;
+}
+
+void lv_dropdown_set_selected(lv_obj_t *obj, uint16_t sel_opt) {
+    (void)obj;
+    (void)sel_opt;
+}
+
+void lv_roller_set_selected(lv_obj_t *obj, uint16_t sel_opt,
+                            lv_anim_enable_t anim) {
+    (void)obj;
+    (void)sel_opt;
+    (void)anim;
+}
+
+void lv_keyboard_set_textarea(lv_obj_t *kb, lv_obj_t *ta) {
+    (void)kb;
+    (void)ta;
+}
+
+/**
+ * @}
+ */
+}
+
+#endif /* __EEZ_STUB_H */
@@ -0,0 +1,473 @@
+/**
+ * @file    expr_bench.cpp
+ * @author  Deadline039
+ * @brief   EEZ Flow 表达式求值测试 (PC 端)
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * 直接包含 eez-flow.cpp, 用固件中的代码分别以字节码解释 (原来的 evalExpression)
+ * 和线程化代码 (EEZ_FLOW_THREADED_EVAL) 求值同一组表达式, 检查结果相同后
+ * 比较每次求值的耗时.
+ *
+ * 表达式来自固件的记录: 把 eez-flow.h 中的 EEZ_FLOW_THREADED_DUMP 改为 1,
+ * 启动时会通过 printf 输出常量, 全局变量和每个属性的表达式:
+ *   C <序号> <类型> <值>    常量, 类型为 i/f/d/b, 其他类型为 x
+ *   G <序号> <类型> <值>    全局变量的初始值
+ *   E <字节码>              表达式, 十六进制
+ * 把串口日志保存下来作为输入, 其他行会被忽略. 没有输入文件时使用内置的
+ * 一组常见表达式 (变量与常量比较, 算术, 条件, 常量运算).
+ * 组件输入和局部变量的值为整数 0, 1, 2...
+ *
+ * 编译:
+ *   g++ -O2 -std=gnu++17 -o expr_bench expr_bench.cpp
+ *       ../../Middlewares/LVGL/APP/eez-flow-lz4.c -DLV_CONF_SKIP
+ *       -I../../Middlewares/LVGL/APP -I../../Middlewares/LVGL/GUI
+ *       -I../../Middlewares/LVGL/GUI/lvgl -I../../Middlewares/LVGL/GUI/lvgl/src
+ *       -I../../Middlewares/LVGL/GUI/porting -I../../User/Utils
+ * 测试不会调用 LVGL, 用到的 LVGL 函数由 ../eez_stub/eez_stub.h 提供空实现.
+ *
+ * 用法:
+ *   expr_bench [-n 次数] [记录文件]
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#include "eez-flow.cpp"
+
+#include "../eez_stub/eez_stub.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* 计时重复次数, 取最小值 */
+#define REPEAT_NUM   5
+#define MAX_CONST    1024
+#define MAX_GLOBAL   256
+#define MAX_EXPR     1024
+#define MAX_EXPR_LEN 256
+/* 组件输入和局部变量的数量 */
+#define VALUE_NUM    32
+
+/* eez::alloc 使用的分配函数 */
+extern "C" {
+void *mem_slab_alloc(size_t size) {
+    (void)size;
+    return NULL;
+}
+uint8_t mem_slab_contains(const void *ptr) {
+    (void)ptr;
+    return 0;
+}
+void mem_slab_free(void *ptr) {
+    (void)ptr;
+}
+void *lv_mem_alloc(size_t size) {
+    return malloc(size);
+}
+void lv_mem_free(void *ptr) {
+    free(ptr);
+}
+}
+
+using namespace eez;
+using namespace eez::flow;
+
+/**
+ * @brief 表达式
+ */
+typedef struct {
+    uint8_t code[MAX_EXPR_LEN];
+    size_t len;
+} expr_t;
+
+static char const_type[MAX_CONST], global_type[MAX_GLOBAL];
+static double const_value[MAX_CONST], global_value[MAX_GLOBAL];
+static uint32_t const_num, global_num;
+static expr_t exprs[MAX_EXPR];
+static size_t expr_num;
+
+/* 内置的表达式, 16 位指令 */
+static const char *const builtin_record[] = {
+    "C 0 i 50",   "C 1 i 1",    "C 2 f 2.5",  "C 3 i 3",  "C 4 i 4",
+    "C 5 i 10",   "C 6 i 90",   "C 7 f 0",    "C 8 i 100",
+    "G 0 i 42",   "G 1 f 1.5",  "G 2 f 3.25", "G 3 b 1",
+    /* global0 > 50 */
+    "E 006000000DC000E0",
+    /* input0 == 1 */
+    "E 002001000AC000E0",
+    /* global1 * 2.5 + global2 */
+    "E 0160020002C0026000C000E0",
+    /* 3 * 4 + global0 */
+    "E 0300040002C0006000C000E0",
+    /* global0 >= 10 && global0 <= 90 */
+    "E 006005000FC0006006000EC010C000E0",
+    /* global3 ? global1 : 0.0 */
+    "E 03600160070016C000E0",
+    /* local0 + 1 */
+    "E 0040010000C000E0",
+    /* -global0 + 100 */
+    "E 006013C0080000C000E0",
+};
+
+/* 手工构造的 flow 定义, AssetsPtr 为相对偏移, 需要在同一块内存中 */
+static uint8_t assets_buf[1 << 20];
+static size_t assets_used;
+
+/*****************************************************************************
+ * @defgroup 记录
+ * @{
+ */
+
+/**
+ * @brief 解析一行记录
+ *
+ * @param line 一行
+ */
+static void record_parse_line(const char *line) {
+    unsigned idx;
+    char type;
+    double value = 0;
+
+    while (*line == ' ' || *line == '\t') {
+        ++line;
+    }
+
+    if ((line[0] == 'C' || line[0] == 'G') && line[1] == ' ') {
+        if (sscanf(line + 2, "%u %c %lf", &idx, &type, &value) < 2) {
+            return;
+        }
+        if (line[0] == 'C' && idx < MAX_CONST) {
+            const_type[idx] = type;
+            const_value[idx] = value;
+            if (idx + 1 > const_num) {
+                const_num = idx + 1;
+            }
+        } else if (line[0] == 'G' && idx < MAX_GLOBAL) {
+            global_type[idx] = type;
+            global_value[idx] = value;
+            if (idx + 1 > global_num) {
+                global_num = idx + 1;
+            }
+        }
+    } else if (line[0] == 'E' && line[1] == ' ' && expr_num < MAX_EXPR) {
+        expr_t *e = &exprs[expr_num];
+        unsigned byte;
+
+        e->len = 0;
+        for (line += 2; e->len < MAX_EXPR_LEN; line += 2) {
+            while (*line == ' ') {
+                ++line;
+            }
+            if (sscanf(line, "%2x", &byte) != 1) {
+                break;
+            }
+            e->code[e->len++] = (uint8_t)byte;
+        }
+        if (e->len >= 2) {
+            ++expr_num;
+        }
+    }
+}
+
+/**
+ * @brief 读取记录文件
+ *
+ * @param path 路径
+ * @return 读取状态:
+ * @retval - 0: 成功
+ * @retval - 1: 打开失败
+ */
+static int record_load(const char *path) {
+    char line[2 * MAX_EXPR_LEN + 16];
+    FILE *fp = fopen(path, "r");
+
+    if (fp == NULL) {
+        return 1;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        record_parse_line(line);
+    }
+    fclose(fp);
+
+    return 0;
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup Flow 定义
+ * @{
+ */
+
+/**
+ * @brief 从 assets_buf 申请
+ */
+static void *assets_alloc(size_t size) {
+    void *ptr;
+
+    assets_used = (assets_used + 15U) & ~(size_t)15U;
+    ptr = assets_buf + assets_used;
+    assets_used += size;
+    if (assets_used > sizeof(assets_buf)) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+
+    return ptr;
+}
+
+/**
+ * @brief 设置 AssetsPtr 的偏移
+ *
+ * @param field AssetsPtr 的地址
+ * @param target 指向的数据
+ */
+static void assets_set_ptr(void *field, void *target) {
+    *(int32_t *)field = (int32_t)((uint8_t *)target - (uint8_t *)field);
+}
+
+/**
+ * @brief 根据记录生成值
+ */
+static Value make_value(char type, double value) {
+    switch (type) {
+        case 'i':
+            return Value((int)value, VALUE_TYPE_INT32);
+        case 'f':
+            return Value((float)value, VALUE_TYPE_FLOAT);
+        case 'd':
+            return Value(value, VALUE_TYPE_DOUBLE);
+        case 'b':
+            return Value((int)value != 0, VALUE_TYPE_BOOLEAN);
+        default:
+            return Value();
+    }
+}
+
+/**
+ * @brief 生成常量和全局变量的列表
+ *
+ * @param list ListOfAssetsPtr<Value>
+ * @param num 数量
+ * @param type 类型
+ * @param value 值
+ */
+static void make_value_list(ListOfAssetsPtr<Value> *list, uint32_t num,
+                            const char *type, const double *value) {
+    int32_t *items = (int32_t *)assets_alloc((num + 1) * sizeof(int32_t));
+    Value *values = (Value *)assets_alloc((num + 1) * sizeof(Value));
+
+    list->count = num;
+    assets_set_ptr((uint8_t *)list + sizeof(uint32_t), items);
+    for (uint32_t i = 0; i < num; ++i) {
+        new (&values[i]) Value();
+        values[i] = make_value(type[i], value[i]);
+        assets_set_ptr(&items[i], &values[i]);
+    }
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @brief 当前时间 (ns)
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 比较两个结果
+ */
+static bool same_value(const Value &a, const Value &b) {
+    if (a.type != b.type) {
+        return false;
+    }
+    if (a.type == VALUE_TYPE_FLOAT && isnan(a.floatValue)) {
+        return isnan(b.floatValue);
+    }
+    if (a.type == VALUE_TYPE_DOUBLE && isnan(a.doubleValue)) {
+        return isnan(b.doubleValue);
+    }
+    return a.type == VALUE_TYPE_ERROR || a == b;
+}
+
+/**
+ * @brief 求值一次, 结果留在 g_stack 中
+ *
+ * @param fs flow 状态
+ * @param e 表达式
+ * @param threaded 是否使用线程化代码
+ */
+static void eval_once(FlowState *fs, const expr_t *e, bool threaded) {
+    g_stack.sp = 0;
+    g_stack.errorMessage = nullptr;
+    if (!threaded || !evalThreadedExpression(fs, e->code, nullptr)) {
+        ThreadedCache saved = g_threadedCache;
+
+        /* 没有缓存时 evalExpression 使用字节码解释 */
+        g_threadedCache.entries = nullptr;
+        evalExpression(fs, e->code, nullptr);
+        g_threadedCache = saved;
+    }
+}
+
+/**
+ * @brief 测量一组表达式求值一次的平均耗时
+ *
+ * @param fs flow 状态
+ * @param n 次数
+ * @param threaded 是否使用线程化代码
+ * @return 每个表达式的耗时 (ns)
+ */
+static double measure(FlowState *fs, size_t n, bool threaded) {
+    double best = 1e30;
+
+    for (int r = 0; r < REPEAT_NUM; ++r) {
+        uint64_t t0 = now_ns();
+        for (size_t k = 0; k < n; ++k) {
+            for (size_t i = 0; i < expr_num; ++i) {
+                eval_once(fs, &exprs[i], threaded);
+            }
+        }
+        double t = (double)(now_ns() - t0) / (double)(n * expr_num);
+        if (t < best) {
+            best = t;
+        }
+    }
+
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = 100000;
+    const char *path = NULL;
+    size_t mismatch = 0, untranslated = 0, code_num = 0, folded_num = 0,
+           fused_num = 0, bytecode_num = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n = strtoul(argv[++i], NULL, 0);
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Usage: %s [-n num] [record]\n", argv[0]);
+            return 1;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if (path != NULL) {
+        if (record_load(path)) {
+            fprintf(stderr, "Can not open %s.\n", path);
+            return 1;
+        }
+    } else {
+        for (size_t i = 0;
+             i < sizeof(builtin_record) / sizeof(builtin_record[0]); ++i) {
+            record_parse_line(builtin_record[i]);
+        }
+    }
+    if (expr_num == 0) {
+        fprintf(stderr, "No expressions.\n");
+        return 1;
+    }
+
+    FlowDefinition *fd = (FlowDefinition *)assets_alloc(sizeof(FlowDefinition));
+    Flow *flow = (Flow *)assets_alloc(sizeof(Flow));
+    memset((void *)fd, 0, sizeof(FlowDefinition));
+    memset((void *)flow, 0, sizeof(Flow));
+    make_value_list(&fd->constants, const_num, const_type, const_value);
+    make_value_list(&fd->globalVariables, global_num, global_type,
+                    global_value);
+    flow->componentInputs.count = VALUE_NUM / 2;
+
+    static Value values[VALUE_NUM];
+    for (int i = 0; i < VALUE_NUM; ++i) {
+        values[i] = Value(i % (VALUE_NUM / 2), VALUE_TYPE_INT32);
+    }
+
+    static FlowState fs;
+    fs.flowDefinition = fd;
+    fs.flow = flow;
+    fs.values = values;
+    g_stack.flowState = &fs;
+
+    /* 与 initThreadedExpressions 相同, 表达式在第一次求值时翻译 */
+    runThreadedProgram(nullptr, nullptr);
+    uint32_t capacity = 1;
+    while (capacity * 3 < (uint32_t)(expr_num + 1) * 4) {
+        capacity <<= 1;
+    }
+    g_threadedCache.entries =
+        (ThreadedProgram **)calloc(capacity, sizeof(ThreadedProgram *));
+    g_threadedCache.mask = capacity - 1;
+    g_threadedCache.maxCount = capacity * 3 / 4;
+
+    for (size_t i = 0; i < expr_num; ++i) {
+        eval_once(&fs, &exprs[i], false);
+        size_t sp1 = g_stack.sp;
+        Value r1 = sp1 ? g_stack.stack[sp1 - 1].getValue() : Value();
+
+        eval_once(&fs, &exprs[i], true);
+        size_t sp2 = g_stack.sp;
+        Value r2 = sp2 ? g_stack.stack[sp2 - 1].getValue() : Value();
+
+        ThreadedProgram *p = findThreadedProgram(exprs[i].code);
+        if (p == NULL || p->numCode == 0) {
+            ++untranslated;
+        } else {
+            const ThreadedInstruction *code = getThreadedCode(p);
+            code_num += p->numCode;
+            folded_num += p->numFolded;
+            bytecode_num += p->numInstructionBytes / 2;
+            for (int k = 0; g_threadedCode && k < p->numCode; ++k) {
+                if (code[k].code ==
+                        g_threadedCode[THREADED_GLOBAL_CONST_BINARY] ||
+                    code[k].code ==
+                        g_threadedCode[THREADED_INPUT_CONST_BINARY] ||
+                    code[k].code ==
+                        g_threadedCode[THREADED_LOCAL_CONST_BINARY]) {
+                    ++fused_num;
+                }
+            }
+        }
+
+        if (sp1 != sp2 || !same_value(r1, r2)) {
+            char t1[64], t2[64];
+            r1.toText(t1, sizeof(t1));
+            r2.toText(t2, sizeof(t2));
+            printf("Mismatch in expression %zu: '%s' / '%s'\n", i, t1, t2);
+            ++mismatch;
+        }
+    }
+
+    printf("%zu expressions, %zu constants, %zu globals.\n", expr_num,
+           (size_t)const_num, (size_t)global_num);
+    printf("%zu bytecode -> %zu threaded instructions, %zu fused, "
+           "%zu folded constants, %zu not translated.\n",
+           bytecode_num, code_num, fused_num, folded_num, untranslated);
+    if (mismatch) {
+        printf("%zu results differ.\n", mismatch);
+        return 1;
+    }
+
+    double t_bytecode = measure(&fs, n, false);
+    double t_threaded = measure(&fs, n, true);
+    printf("\nInterpreter    ns/eval\n");
+    printf("bytecode     %9.1f\n", t_bytecode);
+    printf("threaded     %9.1f  (%.2fx)\n", t_threaded,
+           t_bytecode / t_threaded);
+
+    return 0;
+}
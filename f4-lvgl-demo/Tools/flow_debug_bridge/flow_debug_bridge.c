@@ -0,0 +1,410 @@
+/**
+ * @file    flow_debug_bridge.c
+ * @author  Deadline039
+ * @brief   EEZ Flow 调试器 USB CDC 桥 (PC 端)
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * 板子把调试消息压缩成帧发送 (格式见 `Middlewares/LVGL/APP/eez_debugger.h`),
+ * 这里解码后通过 TCP 转发给 EEZ Studio, EEZ Studio 发来的命令原样写入串口.
+ * 有 TCP 客户端时才打开串口, 打开串口 (DTR 有效) 即通知板子调试器已连接,
+ * 客户端断开时关闭串口.
+ *
+ * 编译:
+ *   gcc -O2 -I../../Middlewares/LVGL/APP -o flow_debug_bridge
+ *       flow_debug_bridge.c ../../Middlewares/LVGL/APP/eez-flow-lz4.c
+ *
+ * 用法:
+ *   flow_debug_bridge [-p port] /dev/ttyACM0
+ *     -p  TCP 端口, 默认 3333, 与 EEZ Studio 的调试器端口相同
+ *   flow_debug_bridge -d capture.bin
+ *     -d  解码保存下来的串口数据, 消息输出到 stdout
+ * 退出时和每次断开时输出压缩率, 丢失的帧数.
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "eez-flow-lz4.h"
+
+#define FRAME_MAGIC       "EF"
+#define FRAME_HEADER_SIZE 8
+#define FRAME_FLAG_LZ4    0x01U
+#define FRAME_FLAG_LOST   0x02U
+#define FRAME_MAX_TEXT    65535
+#define FRAME_MAX_DATA    LZ4_COMPRESSBOUND(FRAME_MAX_TEXT)
+
+#define RX_BUF_SIZE       (2 * (FRAME_HEADER_SIZE + FRAME_MAX_DATA))
+
+/**
+ * @brief 解码状态
+ */
+typedef struct {
+    uint8_t buf[RX_BUF_SIZE]; /*!< 未解析的串口数据 */
+    size_t len;               /*!< buf 中的长度 */
+    int seq;                  /*!< 期望的下一个序号, -1 为未知 */
+
+    uint64_t text_bytes;  /*!< 解码后的消息长度 */
+    uint64_t frame_bytes; /*!< 帧的总长度 */
+    uint32_t frames;      /*!< 帧数 */
+    uint32_t lost_frames; /*!< 序号不连续, 估计丢失的帧数 */
+    uint32_t lost_flags;  /*!< 板子报告丢弃消息的次数 */
+    uint32_t skip_bytes;  /*!< 重新同步跳过的字节 */
+} decoder_t;
+
+static char text[FRAME_MAX_TEXT];
+
+/**
+ * @brief 写完所有数据
+ *
+ * @param fd 文件描述符
+ * @param buf 数据
+ * @param len 长度
+ * @return 0: 成功; -1: 失败
+ */
+static int write_all(int fd, const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    ssize_t n;
+
+    while (len > 0) {
+        n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief 重置解码状态
+ *
+ * @param dec 解码状态
+ */
+static void decoder_reset(decoder_t *dec) {
+    memset(dec, 0, sizeof(*dec));
+    dec->seq = -1;
+}
+
+/**
+ * @brief 解析一帧
+ *
+ * @param dec 解码状态
+ * @param p 帧起始
+ * @param remain 剩余长度
+ * @param out 消息输出的文件描述符
+ * @return >0: 帧长度; 0: 数据不够; -1: 不是帧, 跳过一个字节
+ */
+static long frame_parse(decoder_t *dec, const uint8_t *p, size_t remain,
+                        int out) {
+    uint32_t text_len, data_len;
+    uint8_t flags, seq;
+    int n;
+
+    if (remain < 2) {
+        return remain == 1 && p[0] == FRAME_MAGIC[0] ? 0 : -1;
+    }
+    if (memcmp(p, FRAME_MAGIC, 2) != 0) {
+        return -1;
+    }
+    if (remain < FRAME_HEADER_SIZE) {
+        return 0;
+    }
+
+    flags = p[2];
+    seq = p[3];
+    text_len = p[4] | ((uint32_t)p[5] << 8);
+    data_len = p[6] | ((uint32_t)p[7] << 8);
+    if ((flags & ~(FRAME_FLAG_LZ4 | FRAME_FLAG_LOST)) != 0 || text_len == 0 ||
+        data_len == 0 || data_len > FRAME_MAX_DATA ||
+        (!(flags & FRAME_FLAG_LZ4) && data_len != text_len)) {
+        return -1;
+    }
+    if (remain < FRAME_HEADER_SIZE + data_len) {
+        return 0;
+    }
+
+    if (flags & FRAME_FLAG_LZ4) {
+        n = LZ4_decompress_safe((const char *)p + FRAME_HEADER_SIZE, text,
+                                (int)data_len, (int)text_len);
+        if (n != (int)text_len) {
+            return -1;
+        }
+    } else {
+        memcpy(text, p + FRAME_HEADER_SIZE, text_len);
+    }
+
+    if (dec->seq >= 0 && seq != (uint8_t)dec->seq) {
+        dec->lost_frames += (uint8_t)(seq - dec->seq);
+        fprintf(stderr, "seq %u, expected %u\n", seq, (uint8_t)dec->seq);
+    }
+    if (flags & FRAME_FLAG_LOST) {
+        ++dec->lost_flags;
+        fprintf(stderr, "seq %u: messages dropped on the device\n", seq);
+    }
+    dec->seq = (uint8_t)(seq + 1);
+    dec->text_bytes += text_len;
+    dec->frame_bytes += FRAME_HEADER_SIZE + data_len;
+    ++dec->frames;
+
+    if (out >= 0 && write_all(out, text, text_len) != 0) {
+        return -2;
+    }
+    return (long)(FRAME_HEADER_SIZE + data_len);
+}
+
+/**
+ * @brief 处理收到的串口数据
+ *
+ * @param dec 解码状态
+ * @param data 数据
+ * @param len 长度
+ * @param out 消息输出的文件描述符
+ * @return 0: 成功; -1: 输出失败
+ */
+static int decoder_feed(decoder_t *dec, const uint8_t *data, size_t len,
+                        int out) {
+    size_t pos = 0, n;
+    long ret;
+
+    while (len > 0) {
+        n = sizeof(dec->buf) - dec->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(dec->buf + dec->len, data, n);
+        dec->len += n;
+        data += n;
+        len -= n;
+
+        pos = 0;
+        while (pos < dec->len) {
+            ret = frame_parse(dec, dec->buf + pos, dec->len - pos, out);
+            if (ret == 0) {
+                break;
+            }
+            if (ret == -2) {
+                return -1;
+            }
+            if (ret < 0) {
+                ++dec->skip_bytes;
+                ++pos;
+            } else {
+                pos += (size_t)ret;
+            }
+        }
+        memmove(dec->buf, dec->buf + pos, dec->len - pos);
+        dec->len -= pos;
+    }
+    return 0;
+}
+
+/**
+ * @brief 输出统计
+ *
+ * @param dec 解码状态
+ */
+static void decoder_report(const decoder_t *dec) {
+    fprintf(stderr,
+            "%u frames, %llu bytes -> %llu bytes (%.1f%%), %u lost frames, "
+            "%u dropped on the device, %u bytes skipped\n",
+            dec->frames, (unsigned long long)dec->text_bytes,
+            (unsigned long long)dec->frame_bytes,
+            dec->text_bytes ? 100.0 * (double)dec->frame_bytes /
+                                  (double)dec->text_bytes
+                            : 0.0,
+            dec->lost_frames, dec->lost_flags, dec->skip_bytes);
+}
+
+/**
+ * @brief 以原始模式打开串口, 打开时 DTR 有效, 关闭时无效
+ *
+ * @param path 串口
+ * @return 文件描述符, -1 为失败
+ */
+static int serial_open(const char *path) {
+    struct termios tio;
+    int fd;
+
+    fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD | HUPCL;
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    tcflush(fd, TCIFLUSH);
+    return fd;
+}
+
+/**
+ * @brief 转发一个 TCP 客户端, 直到任意一端断开
+ *
+ * @param client 客户端
+ * @param serial_path 串口
+ */
+static void bridge(int client, const char *serial_path) {
+    static decoder_t dec;
+    uint8_t buf[4096];
+    struct pollfd fds[2];
+    ssize_t n;
+    int serial;
+
+    serial = serial_open(serial_path);
+    if (serial < 0) {
+        return;
+    }
+    decoder_reset(&dec);
+
+    fds[0].fd = serial;
+    fds[0].events = POLLIN;
+    fds[1].fd = client;
+    fds[1].events = POLLIN;
+    while (1) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[0].revents & (POLLIN | POLLERR | POLLHUP)) {
+            n = read(serial, buf, sizeof(buf));
+            if (n <= 0) {
+                fprintf(stderr, "%s closed\n", serial_path);
+                break;
+            }
+            if (decoder_feed(&dec, buf, (size_t)n, client) != 0) {
+                break;
+            }
+        }
+        if (fds[1].revents & (POLLIN | POLLERR | POLLHUP)) {
+            n = read(client, buf, sizeof(buf));
+            if (n <= 0 || write_all(serial, buf, (size_t)n) != 0) {
+                break;
+            }
+        }
+    }
+
+    close(serial);
+    decoder_report(&dec);
+}
+
+/**
+ * @brief 解码保存的串口数据
+ *
+ * @param path 文件
+ * @return 0: 成功; 1: 失败
+ */
+static int decode_file(const char *path) {
+    static decoder_t dec;
+    uint8_t buf[4096];
+    size_t n;
+    FILE *fp;
+
+    fp = fopen(path, "rb");
+    if (fp == NULL) {
+        perror(path);
+        return 1;
+    }
+    decoder_reset(&dec);
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        if (decoder_feed(&dec, buf, n, STDOUT_FILENO) != 0) {
+            break;
+        }
+    }
+    fclose(fp);
+    decoder_report(&dec);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *serial_path = NULL;
+    const char *decode_path = NULL;
+    struct sockaddr_in addr;
+    int port = 3333;
+    int listener, client, opt = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            decode_path = argv[++i];
+        } else if (serial_path == NULL && argv[i][0] != '-') {
+            serial_path = argv[i];
+        } else {
+            serial_path = NULL;
+            decode_path = NULL;
+            break;
+        }
+    }
+    if (decode_path != NULL) {
+        return decode_file(decode_path);
+    }
+    if (serial_path == NULL) {
+        fprintf(stderr,
+                "usage: %s [-p port] /dev/ttyACM0\n"
+                "       %s -d capture.bin\n",
+                argv[0], argv[0]);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        perror("socket");
+        return 1;
+    }
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(listener, 1) != 0) {
+        perror("bind");
+        close(listener);
+        return 1;
+    }
+
+    fprintf(stderr, "listening on port %d\n", port);
+    while (1) {
+        client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("accept");
+            break;
+        }
+        fprintf(stderr, "client connected\n");
+        bridge(client, serial_path);
+        close(client);
+        fprintf(stderr, "client disconnected\n");
+    }
+
+    close(listener);
+    return 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file    CSP_Config.h
+ * @author  Deadline039
+ * @brief   isotp_loopback 使用的 CSP 替身 (PC 端)
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * 只提供 isotp.c 用到的类型, 宏和函数声明, 函数由 isotp_loopback.c 模拟.
+ * 常量与 CAN_STM32F4xx.h 和 stm32f4xx_hal_can.h 相同.
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#ifndef __CSP_CONFIG_H
+#define __CSP_CONFIG_H
+
+#include <stdint.h>
+
+#define CAN1_ENABLE          1
+#define CAN2_ENABLE          1
+#define CAN3_ENABLE          0
+
+#define CAN_ID_STD           0x00000000U
+#define CAN_ID_EXT           0x00000004U
+#define CAN_RTR_DATA         0x00000000U
+#define CAN_RTR_REMOTE       0x00000002U
+#define CAN_RX_FIFO0         0x00000000U
+#define CAN_RX_FIFO1         0x00000001U
+
+#define CAN_SEND_OK          0
+#define CAN_SEND_QUEUE_FULL  2
+#define CAN_SEND_PARAM_ERR   3
+
+#define CAN_FILTER_OK        0
+#define CAN_FILTER_PARAM_ERR 1
+#define CAN_FILTER_FULL      2
+
+/* 模拟时只有一个执行流, 不需要关中断 */
+#define __get_PRIMASK()      0U
+#define __set_PRIMASK(x)     ((void)(x))
+#define __disable_irq()      ((void)0)
+#define __DMB()              ((void)0)
+#define UNUSED(x)            ((void)(x))
+
+typedef enum {
+    can1_selected = 0U,
+    can2_selected,
+    can3_selected
+} can_selected_t;
+
+typedef struct {
+    uint32_t id;
+    uint8_t ide;
+    uint8_t rtr;
+    uint8_t len;
+    uint8_t data[8];
+} can_frame_t;
+
+typedef struct can_rx_ring {
+    can_frame_t *buf;
+    uint32_t size;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t lost;
+    void (*callback)(struct can_rx_ring *ring);
+} can_rx_ring_t;
+
+uint32_t HAL_GetTick(void);
+
+uint8_t can_send(can_selected_t can_selected, const can_frame_t *frame);
+uint32_t can_tx_pending(can_selected_t can_selected);
+void can_set_tx_callback(can_selected_t can_selected,
+                         void (*callback)(can_selected_t can_selected));
+
+uint8_t can_rx_ring_init(can_rx_ring_t *ring, can_frame_t *buf, uint32_t size,
+                         void (*callback)(can_rx_ring_t *ring));
+can_frame_t *can_rx_ring_peek(can_rx_ring_t *ring);
+void can_rx_ring_pop(can_rx_ring_t *ring);
+uint8_t can_rx_subscribe(can_selected_t can_selected, uint32_t can_ide,
+                         uint32_t id, uint32_t mask, uint32_t fifo,
+                         can_rx_ring_t *ring);
+uint8_t can_rx_unsubscribe(can_selected_t can_selected, can_rx_ring_t *ring);
+
+#endif /* __CSP_CONFIG_H */
@@ -0,0 +1,736 @@
+/**
+ * @file    isotp_loopback.c
+ * @author  Deadline039
+ * @brief   ISO-TP 回环测试 (PC 端)
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * 直接包含 isotp.c, 用同一目录下的 CSP_Config.h 代替 CSP. 模拟 CAN1 和 CAN2
+ * 接在同一条总线上: 按 ID 仲裁, 每帧按位数计时 (不计位填充), 发送完成后放入
+ * 对方订阅的接收环并调用发送完成回调, 每 1ms 调用一次 isotp_tick.
+ *
+ * 默认为正确性测试: 多对通道同时双向收发随机长度的消息 (包括单帧和超过
+ * 4095 字节的首帧), 每对使用随机的 BS, STmin, 填充和标准/扩展 ID, 检查收到
+ * 的每一条消息. -l 按概率丢帧, 检查超时和序号错误能够恢复, 这时应该用 -w
+ * 把超时改为固件的 1000ms. 另外检查接收缓冲区不够时双方都得到
+ * ISOTP_OVERFLOW.
+ *
+ * -t 为吞吐量测试: 一对通道单向连续发送 4095 字节的消息, 输出有效数据速率
+ * 和总线占用率, 与理论值 (每条消息 1 个首帧, 1 个流控帧和 585 个连续帧)
+ * 比较. 结果只反映协议和调度的开销, 不包括 MCU 的中断延迟.
+ *
+ * 编译:
+ *   gcc -O2 -o isotp_loopback isotp_loopback.c -I. -I../../User/Utils
+ *
+ * 用法:
+ *   isotp_loopback [-p 通道对数] [-n 消息数] [-l 丢帧百分比] [-b 波特率]
+ *                  [-r 种子] [-w 超时 ms] [-t]
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * STmin 为 0 的高优先级通道会占满总线, 低优先级的通道要等它发完才能发送,
+ * 1000ms 的超时会失败, 所以超时可以由 -w 设置, 默认很长
+ */
+static uint32_t sim_timeout_ms = 600000;
+#define ISOTP_TIMEOUT_MS sim_timeout_ms
+
+#include "isotp/isotp.c"
+
+/* 每个 CAN 的发送队列, 3 个邮箱加 CAN_TX_QUEUE_SIZE */
+#define SIM_TX_QUEUE_SIZE (3 + 16)
+/* 每个 CAN 的订阅数 */
+#define SIM_SUB_NUM       16
+#define SIM_CAN_NUM       2
+#define SIM_PAIR_MAX      8
+/* 正确性测试的最大消息长度 */
+#define SIM_MSG_MAX       6000
+/* 吞吐量测试的消息长度 */
+#define SIM_BENCH_LEN     4095
+
+/**
+ * @brief 模拟的 CAN 控制器
+ */
+typedef struct {
+    can_frame_t tx[SIM_TX_QUEUE_SIZE]; /*!< 等待发送的帧 */
+    uint32_t tx_num;                   /*!< 等待发送的帧数 */
+
+    struct {
+        uint32_t ide;
+        uint32_t id;
+        uint32_t mask;
+        can_rx_ring_t *ring;
+    } sub[SIM_SUB_NUM]; /*!< 订阅 */
+
+    void (*tx_callback)(can_selected_t can_selected); /*!< 发送完成回调 */
+} sim_can_t;
+
+/**
+ * @brief 一个通道的收发统计
+ */
+typedef struct {
+    isotp_channel_t channel;
+    uint8_t tx_buf[SIM_MSG_MAX];
+    uint8_t rx_buf[SIM_MSG_MAX];
+    uint32_t key;      /*!< 生成数据用 */
+    uint32_t peer_key; /*!< 对方的 key */
+    uint32_t max_len;  /*!< 发送的最大长度 */
+    uint32_t fix_len;  /*!< 不为 0 时只发送这个长度 */
+    uint32_t tx_target;
+    uint32_t tx_started;
+    uint32_t tx_ok;
+    uint32_t tx_fail;
+    uint32_t rx_ok;
+    uint32_t rx_fail;
+    uint32_t rx_bad;
+    uint32_t rx_last_len;
+    uint8_t rx_last_status;
+    uint8_t tx_last_status;
+    uint64_t rx_bytes;
+} sim_node_t;
+
+static sim_can_t sim_can[SIM_CAN_NUM];
+static uint64_t sim_ns;        /* 当前时刻 */
+static uint64_t sim_tick_ns;   /* 下一次 isotp_tick 的时刻 */
+static uint32_t sim_bit_ns;    /* 一位的时间 */
+static int sim_bus_can;        /* 正在发送的 CAN, -1: 总线空闲 */
+static uint32_t sim_bus_index; /* 正在发送的帧 */
+static uint64_t sim_bus_end;   /* 这一帧结束的时刻 */
+static uint64_t sim_busy_ns;   /* 总线忙的时间 */
+static uint64_t sim_frames;    /* 发送的帧数 */
+static uint64_t sim_dropped;   /* 丢掉的帧数 */
+static double sim_loss;        /* 丢帧概率 */
+
+static sim_node_t sim_nodes[SIM_PAIR_MAX * 2];
+static uint32_t sim_node_num;
+
+uint32_t HAL_GetTick(void) {
+    return (uint32_t)(sim_ns / 1000000U);
+}
+
+uint8_t can_send(can_selected_t can_selected, const can_frame_t *frame) {
+    sim_can_t *can = &sim_can[can_selected];
+
+    if (frame->len > 8) {
+        return CAN_SEND_PARAM_ERR;
+    }
+
+    if (can->tx_num >= SIM_TX_QUEUE_SIZE) {
+        return CAN_SEND_QUEUE_FULL;
+    }
+
+    can->tx[can->tx_num++] = *frame;
+    return CAN_SEND_OK;
+}
+
+uint32_t can_tx_pending(can_selected_t can_selected) {
+    return sim_can[can_selected].tx_num;
+}
+
+void can_set_tx_callback(can_selected_t can_selected,
+                         void (*callback)(can_selected_t can_selected)) {
+    sim_can[can_selected].tx_callback = callback;
+}
+
+uint8_t can_rx_ring_init(can_rx_ring_t *ring, can_frame_t *buf, uint32_t size,
+                         void (*callback)(can_rx_ring_t *ring)) {
+    if (ring == NULL || buf == NULL || size == 0 || (size & (size - 1)) != 0) {
+        return CAN_FILTER_PARAM_ERR;
+    }
+
+    ring->buf = buf;
+    ring->size = size;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->lost = 0;
+    ring->callback = callback;
+    return CAN_FILTER_OK;
+}
+
+can_frame_t *can_rx_ring_peek(can_rx_ring_t *ring) {
+    if (ring->head == ring->tail) {
+        return NULL;
+    }
+
+    return &ring->buf[ring->tail & (ring->size - 1)];
+}
+
+void can_rx_ring_pop(can_rx_ring_t *ring) {
+    if (ring->head != ring->tail) {
+        ++ring->tail;
+    }
+}
+
+uint8_t can_rx_subscribe(can_selected_t can_selected, uint32_t can_ide,
+                         uint32_t id, uint32_t mask, uint32_t fifo,
+                         can_rx_ring_t *ring) {
+    sim_can_t *can = &sim_can[can_selected];
+
+    UNUSED(fifo);
+    for (uint32_t i = 0; i < SIM_SUB_NUM; ++i) {
+        if (can->sub[i].ring == NULL) {
+            can->sub[i].ide = can_ide;
+            can->sub[i].id = id & mask;
+            can->sub[i].mask = mask;
+            can->sub[i].ring = ring;
+            return CAN_FILTER_OK;
+        }
+    }
+
+    return CAN_FILTER_FULL;
+}
+
+uint8_t can_rx_unsubscribe(can_selected_t can_selected, can_rx_ring_t *ring) {
+    sim_can_t *can = &sim_can[can_selected];
+
+    for (uint32_t i = 0; i < SIM_SUB_NUM; ++i) {
+        if (can->sub[i].ring == ring) {
+            can->sub[i].ring = NULL;
+        }
+    }
+
+    return CAN_FILTER_OK;
+}
+
+/**
+ * @brief 帧在总线上的位数, 不计位填充
+ *
+ * @param frame 帧
+ * @return 位数, 包括帧间隔
+ */
+static uint32_t sim_frame_bits(const can_frame_t *frame) {
+    /* SOF, 仲裁段, 控制段, CRC, ACK, EOF 和 3 位帧间隔 */
+    uint32_t bits = (frame->ide == CAN_ID_STD) ? 47 : 67;
+
+    if (frame->rtr == CAN_RTR_DATA) {
+        bits += 8U * frame->len;
+    }
+
+    return bits;
+}
+
+/**
+ * @brief 仲裁的优先级, 越小越优先. 基本 ID 相同时标准帧优先
+ *
+ * @param frame 帧
+ * @return 优先级
+ */
+static uint64_t sim_frame_key(const can_frame_t *frame) {
+    if (frame->ide == CAN_ID_STD) {
+        return (uint64_t)frame->id << 19;
+    }
+
+    return ((uint64_t)frame->id << 1) | 1U;
+}
+
+/**
+ * @brief 总线空闲时开始发送优先级最高的帧
+ *
+ */
+static void sim_bus_start(void) {
+    uint64_t key, best_key = UINT64_MAX;
+    uint32_t bits;
+
+    for (int c = 0; c < SIM_CAN_NUM; ++c) {
+        for (uint32_t i = 0; i < sim_can[c].tx_num; ++i) {
+            key = sim_frame_key(&sim_can[c].tx[i]);
+            if (key < best_key) {
+                best_key = key;
+                sim_bus_can = c;
+                sim_bus_index = i;
+            }
+        }
+    }
+
+    if (sim_bus_can < 0) {
+        return;
+    }
+
+    bits = sim_frame_bits(&sim_can[sim_bus_can].tx[sim_bus_index]);
+    sim_bus_end = sim_ns + (uint64_t)bits * sim_bit_ns;
+    sim_busy_ns += (uint64_t)bits * sim_bit_ns;
+}
+
+/**
+ * @brief 一帧发送完成, 交给对方的接收环, 然后调用发送完成回调
+ *
+ */
+static void sim_bus_finish(void) {
+    can_selected_t sender = (can_selected_t)sim_bus_can;
+    sim_can_t *tx = &sim_can[sender];
+    can_frame_t frame = tx->tx[sim_bus_index];
+    can_rx_ring_t *ring;
+
+    memmove(&tx->tx[sim_bus_index], &tx->tx[sim_bus_index + 1],
+            (tx->tx_num - sim_bus_index - 1) * sizeof(can_frame_t));
+    --tx->tx_num;
+    sim_bus_can = -1;
+    ++sim_frames;
+
+    if (sim_loss > 0 && (double)rand() / RAND_MAX < sim_loss) {
+        ++sim_dropped;
+    } else {
+        for (int c = 0; c < SIM_CAN_NUM; ++c) {
+            if (c == (int)sender) {
+                continue;
+            }
+
+            for (uint32_t i = 0; i < SIM_SUB_NUM; ++i) {
+                ring = sim_can[c].sub[i].ring;
+                if (ring == NULL || sim_can[c].sub[i].ide != frame.ide ||
+                    (frame.id & sim_can[c].sub[i].mask) !=
+                        sim_can[c].sub[i].id) {
+                    continue;
+                }
+
+                if (ring->head - ring->tail >= ring->size) {
+                    ++ring->lost;
+                } else {
+                    ring->buf[ring->head & (ring->size - 1)] = frame;
+                    ++ring->head;
+                }
+                if (ring->callback != NULL) {
+                    ring->callback(ring);
+                }
+                break;
+            }
+        }
+    }
+
+    if (tx->tx_callback != NULL) {
+        tx->tx_callback(sender);
+    }
+}
+
+/**
+ * @brief 第 i 个字节的数据
+ *
+ * @param key 发送方
+ * @param len 消息长度
+ * @param i 第几个字节
+ * @return 数据
+ */
+static uint8_t sim_pattern(uint32_t key, uint32_t len, uint32_t i) {
+    uint32_t x = key * 2654435761U ^ len * 40503U ^ i * 2246822519U;
+
+    x ^= x >> 15;
+    x *= 2246822519U;
+    x ^= x >> 13;
+    return (uint8_t)x;
+}
+
+/**
+ * @brief 随机的消息长度, 单帧, 短消息和长消息各占一部分
+ *
+ * @param max_len 最大长度
+ * @return 长度
+ */
+static uint32_t sim_rand_len(uint32_t max_len) {
+    uint32_t r = (uint32_t)rand() % 10;
+
+    if (r < 3) {
+        return 1 + (uint32_t)rand() % 7;
+    }
+    if (r < 6) {
+        return 8 + (uint32_t)rand() % 100;
+    }
+    return 1 + (uint32_t)rand() % max_len;
+}
+
+/**
+ * @brief 空闲的通道开始发送下一条消息
+ *
+ */
+static void sim_feed(void) {
+    sim_node_t *node;
+    uint32_t len;
+
+    for (uint32_t n = 0; n < sim_node_num; ++n) {
+        node = &sim_nodes[n];
+        if (node->tx_started >= node->tx_target ||
+            isotp_tx_busy(&node->channel)) {
+            continue;
+        }
+
+        len = node->fix_len ? node->fix_len : sim_rand_len(node->max_len);
+        for (uint32_t i = 0; i < len; ++i) {
+            node->tx_buf[i] = sim_pattern(node->key, len, i);
+        }
+        ++node->tx_started;
+        if (isotp_send(&node->channel, node->tx_buf, len) != ISOTP_OK) {
+            --node->tx_started;
+        }
+    }
+}
+
+/**
+ * @brief 运行到某个时刻
+ *
+ * @param end_ns 结束时刻
+ */
+static void sim_run(uint64_t end_ns) {
+    uint64_t next;
+
+    for (;;) {
+        if (sim_bus_can < 0) {
+            sim_bus_start();
+        }
+
+        next = sim_tick_ns;
+        if (sim_bus_can >= 0 && sim_bus_end <= next) {
+            next = sim_bus_end;
+        }
+        if (next > end_ns) {
+            sim_ns = end_ns;
+            return;
+        }
+
+        sim_ns = next;
+        if (sim_bus_can >= 0 && sim_ns == sim_bus_end) {
+            sim_bus_finish();
+        } else {
+            sim_tick_ns += 1000000U;
+            isotp_tick();
+        }
+        sim_feed();
+    }
+}
+
+/**
+ * @brief 所有消息都已发送, 总线空闲
+ *
+ * @return 1: 完成; 0: 未完成
+ */
+static int sim_done(void) {
+    for (uint32_t n = 0; n < sim_node_num; ++n) {
+        if (sim_nodes[n].tx_started < sim_nodes[n].tx_target ||
+            isotp_tx_busy(&sim_nodes[n].channel)) {
+            return 0;
+        }
+    }
+
+    return sim_bus_can < 0 && sim_can[0].tx_num == 0 && sim_can[1].tx_num == 0;
+}
+
+static void sim_rx_done(isotp_channel_t *channel, uint32_t len,
+                        uint8_t status) {
+    sim_node_t *node = (sim_node_t *)channel->cfg.user;
+
+    node->rx_last_len = len;
+    node->rx_last_status = status;
+    if (status != ISOTP_OK) {
+        ++node->rx_fail;
+        return;
+    }
+
+    ++node->rx_ok;
+    node->rx_bytes += len;
+    for (uint32_t i = 0; i < len; ++i) {
+        if (node->rx_buf[i] != sim_pattern(node->peer_key, len, i)) {
+            ++node->rx_bad;
+            break;
+        }
+    }
+}
+
+static void sim_tx_done(isotp_channel_t *channel, uint8_t status) {
+    sim_node_t *node = (sim_node_t *)channel->cfg.user;
+
+    node->tx_last_status = status;
+    if (status == ISOTP_OK) {
+        ++node->tx_ok;
+    } else {
+        ++node->tx_fail;
+    }
+}
+
+/**
+ * @brief 复位模拟的总线和所有通道
+ *
+ * @param bit_rate 波特率
+ */
+static void sim_reset(uint32_t bit_rate) {
+    for (uint32_t n = 0; n < sim_node_num; ++n) {
+        isotp_close(&sim_nodes[n].channel);
+    }
+
+    memset(sim_can, 0, sizeof(sim_can));
+    memset(sim_nodes, 0, sizeof(sim_nodes));
+    sim_node_num = 0;
+    sim_ns = 0;
+    sim_tick_ns = 1000000U;
+    sim_bit_ns = 1000000000U / bit_rate;
+    sim_bus_can = -1;
+    sim_busy_ns = 0;
+    sim_frames = 0;
+    sim_dropped = 0;
+}
+
+/**
+ * @brief 打开一对通道, A 在 CAN1 上, B 在 CAN2 上
+ *
+ * @param pair 第几对
+ * @param cfg 配置, ID, 回调和缓冲区由这里填写
+ * @param rx_size B 的接收缓冲区大小
+ * @return 0: 成功; 其他: 失败
+ */
+static int sim_open_pair(uint32_t pair, const isotp_config_t *cfg,
+                         uint32_t rx_size) {
+    sim_node_t *a = &sim_nodes[sim_node_num++];
+    sim_node_t *b = &sim_nodes[sim_node_num++];
+    isotp_config_t ca = *cfg, cb = *cfg;
+    uint32_t base = (cfg->ide == CAN_ID_STD) ? 0x700U : 0x18DA0000U;
+
+    a->key = pair * 2;
+    b->key = pair * 2 + 1;
+    a->peer_key = b->key;
+    b->peer_key = a->key;
+
+    ca.can = can1_selected;
+    ca.tx_id = base + pair * 2;
+    ca.rx_id = base + pair * 2 + 1;
+    ca.rx_buf = a->rx_buf;
+    ca.rx_size = SIM_MSG_MAX;
+    ca.rx_done = sim_rx_done;
+    ca.tx_done = sim_tx_done;
+    ca.user = a;
+
+    cb.can = can2_selected;
+    cb.tx_id = ca.rx_id;
+    cb.rx_id = ca.tx_id;
+    cb.rx_buf = b->rx_buf;
+    cb.rx_size = rx_size;
+    cb.rx_done = sim_rx_done;
+    cb.tx_done = sim_tx_done;
+    cb.user = b;
+
+    if (isotp_open(&a->channel, &ca) != ISOTP_OK ||
+        isotp_open(&b->channel, &cb) != ISOTP_OK) {
+        printf("pair %u: open failed\n", (unsigned)pair);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 正确性测试
+ *
+ * @param pairs 通道对数
+ * @param msgs 每个方向的消息数
+ * @param bit_rate 波特率
+ * @return 错误数
+ */
+static uint32_t test_loopback(uint32_t pairs, uint32_t msgs,
+                              uint32_t bit_rate) {
+    static const uint8_t st_mins[] = {0, 0, 0, 1, 2, 0xF3};
+    isotp_config_t cfg;
+    uint32_t errors = 0;
+    sim_node_t *node, *peer;
+
+    sim_reset(bit_rate);
+    for (uint32_t p = 0; p < pairs; ++p) {
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.ide = (p & 1U) ? CAN_ID_EXT : CAN_ID_STD;
+        cfg.fifo = CAN_RX_FIFO0;
+        cfg.block_size = (uint8_t)(rand() % 5);
+        cfg.st_min = st_mins[(uint32_t)rand() % sizeof(st_mins)];
+        cfg.padding = (uint8_t)(rand() % 2);
+        if (sim_open_pair(p, &cfg, SIM_MSG_MAX) != 0) {
+            return 1;
+        }
+        printf("pair %u: %s BS %u STmin 0x%02X padding %u\n", (unsigned)p,
+               cfg.ide == CAN_ID_STD ? "std" : "ext", cfg.block_size,
+               cfg.st_min, cfg.padding);
+    }
+
+    for (uint32_t n = 0; n < sim_node_num; ++n) {
+        sim_nodes[n].tx_target = msgs;
+        sim_nodes[n].max_len = SIM_MSG_MAX;
+    }
+
+    while (!sim_done()) {
+        sim_run(sim_ns + 1000000U);
+    }
+    /* 丢帧时等待接收方超时 */
+    if (sim_loss > 0) {
+        sim_run(sim_ns + (uint64_t)sim_timeout_ms * 2000000U);
+    }
+
+    for (uint32_t n = 0; n < sim_node_num; ++n) {
+        node = &sim_nodes[n];
+        peer = &sim_nodes[n ^ 1U];
+        printf("node %2u: tx %u ok %u fail, rx %u ok %u fail %u bad, ring "
+               "lost %u\n",
+               (unsigned)n, (unsigned)node->tx_ok, (unsigned)node->tx_fail,
+               (unsigned)node->rx_ok, (unsigned)node->rx_fail,
+               (unsigned)node->rx_bad, (unsigned)node->channel.ring.lost);
+
+        errors += node->rx_bad + node->channel.ring.lost;
+        errors += (node->tx_ok + node->tx_fail != msgs);
+        if (sim_loss == 0) {
+            errors += node->tx_fail + node->rx_fail;
+            errors += (node->rx_ok != peer->tx_ok);
+        }
+    }
+
+    printf("%.3f s, %llu frames, %llu dropped, bus load %.1f%%\n",
+           (double)sim_ns / 1e9, (unsigned long long)sim_frames,
+           (unsigned long long)sim_dropped,
+           100.0 * (double)sim_busy_ns / (double)sim_ns);
+
+    return errors;
+}
+
+/**
+ * @brief 接收缓冲区不够时双方都报告溢出
+ *
+ * @param bit_rate 波特率
+ * @return 错误数
+ */
+static uint32_t test_overflow(uint32_t bit_rate) {
+    isotp_config_t cfg;
+    uint32_t errors = 0;
+    sim_node_t *a, *b;
+
+    sim_reset(bit_rate);
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.ide = CAN_ID_STD;
+    cfg.fifo = CAN_RX_FIFO0;
+    cfg.padding = 1;
+    if (sim_open_pair(0, &cfg, 100) != 0) {
+        return 1;
+    }
+    a = &sim_nodes[0];
+    b = &sim_nodes[1];
+
+    a->tx_target = 1;
+    a->fix_len = 200;
+    while (!sim_done()) {
+        sim_run(sim_ns + 1000000U);
+    }
+
+    if (a->tx_fail != 1 || a->tx_last_status != ISOTP_OVERFLOW) {
+        ++errors;
+    }
+    if (b->rx_fail != 1 || b->rx_last_status != ISOTP_OVERFLOW ||
+        b->rx_last_len <= 100) {
+        ++errors;
+    }
+    printf("overflow: tx status %u, rx status %u len %u\n",
+           a->tx_last_status, b->rx_last_status, (unsigned)b->rx_last_len);
+
+    return errors;
+}
+
+/**
+ * @brief 吞吐量测试
+ *
+ * @param msgs 消息数
+ * @param bit_rate 波特率
+ * @param block_size 接收方的 BS
+ * @return 错误数
+ */
+static uint32_t test_bench(uint32_t msgs, uint32_t bit_rate,
+                           uint8_t block_size) {
+    isotp_config_t cfg;
+    sim_node_t *a, *b;
+    uint32_t cf_num, fc_num;
+    double seconds, theory;
+
+    sim_reset(bit_rate);
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.ide = CAN_ID_STD;
+    cfg.fifo = CAN_RX_FIFO0;
+    cfg.block_size = block_size;
+    cfg.padding = 1;
+    if (sim_open_pair(0, &cfg, SIM_MSG_MAX) != 0) {
+        return 1;
+    }
+    a = &sim_nodes[0];
+    b = &sim_nodes[1];
+    a->tx_target = msgs;
+    a->fix_len = SIM_BENCH_LEN;
+
+    while (!sim_done()) {
+        sim_run(sim_ns + 1000000U);
+    }
+
+    /* 每条消息的帧数, 全部为 8 字节的标准帧 */
+    cf_num = (SIM_BENCH_LEN - 6 + 6) / 7;
+    fc_num = 1 + (block_size ? (cf_num - 1) / block_size : 0);
+    theory = (double)SIM_BENCH_LEN * bit_rate /
+             (double)((1 + cf_num + fc_num) * 111U) / 1024.0;
+    seconds = (double)sim_ns / 1e9;
+
+    printf("%7u bit/s BS %2u: %7.2f KB/s (theory %7.2f), bus load %.1f%%, "
+           "%u/%u received\n",
+           (unsigned)bit_rate, block_size,
+           (double)b->rx_bytes / seconds / 1024.0, theory,
+           100.0 * (double)sim_busy_ns / (double)sim_ns, (unsigned)b->rx_ok,
+           (unsigned)msgs);
+
+    return b->rx_ok != msgs || b->rx_bad != 0;
+}
+
+int main(int argc, char *argv[]) {
+    static const uint32_t bit_rates[] = {125000, 250000, 500000, 1000000};
+    uint32_t pairs = 4, msgs = 200, bit_rate = 500000, seed = 1;
+    uint32_t errors = 0;
+    int bench = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            pairs = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            msgs = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            sim_loss = strtod(argv[++i], NULL) / 100.0;
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            bit_rate = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            sim_timeout_ms = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-t") == 0) {
+            bench = 1;
+        } else {
+            fprintf(stderr,
+                    "Usage: %s [-p pairs] [-n msgs] [-l loss%%] [-b bit_rate] "
+                    "[-r seed] [-w timeout_ms] [-t]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    if (pairs == 0 || pairs > SIM_PAIR_MAX || bit_rate == 0) {
+        fprintf(stderr, "pairs must be 1-%d\n", SIM_PAIR_MAX);
+        return 1;
+    }
+
+    if (bench) {
+        for (uint32_t i = 0; i < sizeof(bit_rates) / sizeof(bit_rates[0]);
+             ++i) {
+            errors += test_bench(msgs, bit_rates[i], 0);
+            errors += test_bench(msgs, bit_rates[i], 8);
+        }
+    } else {
+        srand(seed);
+        errors += test_loopback(pairs, msgs, bit_rate);
+        if (sim_loss == 0) {
+            errors += test_overflow(bit_rate);
+        }
+    }
+
+    sim_reset(bit_rate);
+    printf("%u errors\n", (unsigned)errors);
+    return errors != 0;
+}
@@ -0,0 +1,452 @@
+/**
+ * @file    lv_prof.c
+ * @author  Deadline039
+ * @brief   渲染流水线分析数据转换工具 (PC 端)
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * 解析 lv_port_prof 通过串口输出的数据 (格式见
+ * `Middlewares/LVGL/GUI/porting/lv_port_prof.h`), 输出:
+ *   - 每种打点的统计 (次数, 总时间, 自身时间, 平均每帧)
+ *   - Chrome Trace 格式的 JSON, 用 chrome://tracing 或 ui.perfetto.dev 打开
+ *     即为时间轴上的火焰图
+ *   - 折叠栈格式, 用 flamegraph.pl 或 speedscope 生成火焰图, 权重为周期数
+ * 串口中夹杂的 printf 文本会被跳过.
+ *
+ * 编译:
+ *   gcc -O2 -o lv_prof lv_prof.c
+ *
+ * 用法:
+ *   lv_prof [-t trace.json] [-f folded.txt] [-p] capture.bin
+ *     -t  输出 Chrome Trace
+ *     -f  输出折叠栈
+ *     -p  逐帧输出各阶段的自身时间
+ * 用串口工具把 USART1 收到的数据原样保存为 capture.bin.
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROF_MAGIC       "LVPF"
+#define PROF_VERSION     1
+#define PROF_HEADER_SIZE 12
+#define PROF_EVENT_SIZE  5
+#define PROF_END_BIT     0x80U
+#define PROF_ID_NUM      128
+
+/* 与 lv_port_prof_id_t 对应 */
+#define PROF_ID_FRAME    1
+
+#define STACK_DEPTH      32
+#define FOLD_NUM         4096
+
+static const char *const prof_names[] = {
+    "TIMER",     "FRAME",     "LAYOUT",       "DRAW_RECT",
+    "DRAW_BG",   "DRAW_IMG",  "DRAW_LABEL",   "DRAW_ARC",
+    "DRAW_LINE", "DRAW_POLYGON", "BLEND",     "FLUSH",
+    "FLUSH_WAIT", "UI_TICK",  "FLOW_TICK",    "FLOW_DEBUG",
+};
+
+/**
+ * @brief 未结束的打点
+ */
+typedef struct {
+    uint8_t id;      /*!< 编号 */
+    uint64_t start;  /*!< 开始时间 (周期) */
+    uint64_t child;  /*!< 子打点的总时间 */
+} frame_t;
+
+/**
+ * @brief 每种打点的统计
+ */
+typedef struct {
+    uint32_t count;   /*!< 次数 */
+    uint64_t total;   /*!< 总时间 (含子打点) */
+    uint64_t self;    /*!< 自身时间 */
+    uint64_t max;     /*!< 单次最长时间 */
+} stat_t;
+
+/**
+ * @brief 折叠栈
+ */
+typedef struct {
+    uint8_t depth;              /*!< 深度 */
+    uint8_t ids[STACK_DEPTH];   /*!< 调用栈 */
+    uint64_t cycles;            /*!< 自身时间 */
+} fold_t;
+
+static frame_t stack[STACK_DEPTH];
+static int stack_depth;
+static stat_t stats[PROF_ID_NUM];
+static uint64_t frame_self[PROF_ID_NUM];
+static fold_t folds[FOLD_NUM];
+static int fold_num;
+
+static uint32_t cpu_hz = 180000000;
+static uint64_t now;
+static uint32_t last_cycles;
+static int has_last;
+static uint32_t frame_num;
+static uint32_t gap_num;
+static uint64_t dropped_num;
+
+static FILE *trace_fp;
+static int trace_first = 1;
+static FILE *folded_fp;
+static int per_frame;
+
+/**
+ * @brief 打点名称
+ *
+ * @param id 编号
+ * @return 名称
+ */
+static const char *prof_name(uint8_t id) {
+    static char buf[16];
+
+    if (id < sizeof(prof_names) / sizeof(prof_names[0])) {
+        return prof_names[id];
+    }
+    snprintf(buf, sizeof(buf), "USER_%u", id);
+    return buf;
+}
+
+/**
+ * @brief 周期数转换为微秒
+ *
+ * @param cycles 周期数
+ * @return 微秒
+ */
+static double cycles_to_us(uint64_t cycles) {
+    return (double)cycles * 1e6 / (double)cpu_hz;
+}
+
+/**
+ * @brief 累加折叠栈
+ *
+ * @param id 结束的打点
+ * @param self 自身时间
+ */
+static void fold_add(uint8_t id, uint64_t self) {
+    int depth = stack_depth + 1;
+
+    for (int i = 0; i < fold_num; ++i) {
+        if (folds[i].depth != depth || folds[i].ids[depth - 1] != id) {
+            continue;
+        }
+        int j = 0;
+        while (j < stack_depth && folds[i].ids[j] == stack[j].id) {
+            ++j;
+        }
+        if (j == stack_depth) {
+            folds[i].cycles += self;
+            return;
+        }
+    }
+
+    if (fold_num == FOLD_NUM) {
+        return;
+    }
+    folds[fold_num].depth = (uint8_t)depth;
+    for (int j = 0; j < stack_depth; ++j) {
+        folds[fold_num].ids[j] = stack[j].id;
+    }
+    folds[fold_num].ids[depth - 1] = id;
+    folds[fold_num].cycles = self;
+    ++fold_num;
+}
+
+/**
+ * @brief 输出一帧的统计
+ *
+ * @param dur 帧的时间
+ */
+static void frame_print(uint64_t dur) {
+    printf("frame %6u %9.1f us:", frame_num, cycles_to_us(dur));
+    for (int i = 0; i < PROF_ID_NUM; ++i) {
+        if (frame_self[i] != 0) {
+            printf(" %s=%.1f", prof_name((uint8_t)i),
+                   cycles_to_us(frame_self[i]));
+        }
+    }
+    printf("\n");
+}
+
+/**
+ * @brief 结束一个打点
+ *
+ * @param end 结束时间
+ */
+static void frame_pop(uint64_t end) {
+    frame_t *f = &stack[--stack_depth];
+    uint64_t dur = end - f->start;
+    uint64_t self = (dur > f->child) ? dur - f->child : 0;
+    stat_t *s = &stats[f->id];
+
+    ++s->count;
+    s->total += dur;
+    s->self += self;
+    if (dur > s->max) {
+        s->max = dur;
+    }
+    frame_self[f->id] += self;
+
+    if (stack_depth > 0) {
+        stack[stack_depth - 1].child += dur;
+    }
+
+    if (trace_fp != NULL) {
+        fprintf(trace_fp,
+                "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                "\"ts\":%.3f,\"dur\":%.3f}",
+                trace_first ? "" : ",", prof_name(f->id),
+                cycles_to_us(f->start), cycles_to_us(dur));
+        trace_first = 0;
+    }
+
+    fold_add(f->id, self);
+
+    if (f->id == PROF_ID_FRAME) {
+        ++frame_num;
+        if (per_frame) {
+            frame_print(dur);
+        }
+    }
+}
+
+/**
+ * @brief 处理一个打点
+ *
+ * @param cycles DWT 周期计数
+ * @param tag 编号, 最高位为 1 表示结束
+ */
+static void event_handle(uint32_t cycles, uint8_t tag) {
+    uint8_t id = tag & ~PROF_END_BIT;
+
+    /* 32 位计数器回绕, 打点间隔不会超过一个周期 */
+    if (has_last) {
+        now += (uint32_t)(cycles - last_cycles);
+    }
+    last_cycles = cycles;
+    has_last = 1;
+
+    if ((tag & PROF_END_BIT) == 0) {
+        if (stack_depth == STACK_DEPTH) {
+            fprintf(stderr, "stack overflow, drop %s\n", prof_name(id));
+            return;
+        }
+        if (id == PROF_ID_FRAME) {
+            memset(frame_self, 0, sizeof(frame_self));
+        }
+        stack[stack_depth].id = id;
+        stack[stack_depth].start = now;
+        stack[stack_depth].child = 0;
+        ++stack_depth;
+        return;
+    }
+
+    /* 没有对应开始的结束 (开始被丢弃) 直接忽略 */
+    int i = stack_depth - 1;
+    while (i >= 0 && stack[i].id != id) {
+        --i;
+    }
+    if (i < 0) {
+        return;
+    }
+    while (stack_depth > i + 1) {
+        frame_pop(now);
+    }
+    frame_pop(now);
+}
+
+/**
+ * @brief 记录中断, 丢弃未结束的打点
+ *
+ * @param dropped 丢弃的打点数量
+ */
+static void gap_handle(uint32_t dropped) {
+    stack_depth = 0;
+    has_last = 0;
+    dropped_num += dropped;
+    ++gap_num;
+}
+
+/**
+ * @brief 解析一包
+ *
+ * @param pkt 从魔数开始的数据
+ * @param remain 剩余长度
+ * @return 包的长度, 0 表示不是有效的包
+ */
+static size_t packet_parse(const uint8_t *pkt, size_t remain) {
+    uint8_t sum = 0;
+    size_t len;
+    uint8_t num;
+
+    if (remain < PROF_HEADER_SIZE + 1 || memcmp(pkt, PROF_MAGIC, 4) != 0 ||
+        pkt[4] != PROF_VERSION) {
+        return 0;
+    }
+    num = pkt[5];
+    len = PROF_HEADER_SIZE + (size_t)num * PROF_EVENT_SIZE;
+    if (remain < len + 1) {
+        return 0;
+    }
+    for (size_t i = 4; i < len; ++i) {
+        sum += pkt[i];
+    }
+    if (sum != pkt[len]) {
+        return 0;
+    }
+
+    uint32_t dropped = pkt[6] | ((uint32_t)pkt[7] << 8);
+    cpu_hz = pkt[8] | ((uint32_t)pkt[9] << 8) | ((uint32_t)pkt[10] << 16) |
+             ((uint32_t)pkt[11] << 24);
+    if (cpu_hz == 0) {
+        cpu_hz = 1;
+    }
+    if (dropped != 0) {
+        gap_handle(dropped);
+    }
+
+    for (uint8_t i = 0; i < num; ++i) {
+        const uint8_t *e = pkt + PROF_HEADER_SIZE + i * PROF_EVENT_SIZE;
+        event_handle(e[0] | ((uint32_t)e[1] << 8) | ((uint32_t)e[2] << 16) |
+                         ((uint32_t)e[3] << 24),
+                     e[4]);
+    }
+
+    return len + 1;
+}
+
+/**
+ * @brief 输出统计
+ *
+ */
+static void stat_print(void) {
+    uint64_t self_total = 0;
+
+    for (int i = 0; i < PROF_ID_NUM; ++i) {
+        self_total += stats[i].self;
+    }
+    if (self_total == 0) {
+        self_total = 1;
+    }
+
+    printf("frames: %u, gaps: %u, dropped events: %llu, cpu: %u Hz\n",
+           frame_num, gap_num, (unsigned long long)dropped_num, cpu_hz);
+    printf("%-14s %9s %12s %12s %7s %10s %10s %12s\n", "name", "count",
+           "total(ms)", "self(ms)", "self%", "avg(us)", "max(us)",
+           "per frame(us)");
+    for (int i = 0; i < PROF_ID_NUM; ++i) {
+        const stat_t *s = &stats[i];
+        if (s->count == 0) {
+            continue;
+        }
+        printf("%-14s %9u %12.3f %12.3f %6.1f%% %10.1f %10.1f %12.1f\n",
+               prof_name((uint8_t)i), s->count, cycles_to_us(s->total) / 1000,
+               cycles_to_us(s->self) / 1000,
+               100.0 * (double)s->self / (double)self_total,
+               cycles_to_us(s->total) / s->count, cycles_to_us(s->max),
+               frame_num ? cycles_to_us(s->total) / frame_num : 0.0);
+    }
+}
+
+/**
+ * @brief 输出折叠栈
+ *
+ */
+static void folded_print(void) {
+    for (int i = 0; i < fold_num; ++i) {
+        for (int j = 0; j < folds[i].depth; ++j) {
+            fprintf(folded_fp, "%s%s", j ? ";" : "", prof_name(folds[i].ids[j]));
+        }
+        fprintf(folded_fp, " %llu\n", (unsigned long long)folds[i].cycles);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *trace_path = NULL;
+    const char *folded_path = NULL;
+    const char *in_path = NULL;
+    uint8_t *data;
+    long size;
+    FILE *fp;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            folded_path = argv[++i];
+        } else if (strcmp(argv[i], "-p") == 0) {
+            per_frame = 1;
+        } else if (in_path == NULL && argv[i][0] != '-') {
+            in_path = argv[i];
+        } else {
+            in_path = NULL;
+            break;
+        }
+    }
+    if (in_path == NULL) {
+        fprintf(stderr,
+                "usage: %s [-t trace.json] [-f folded.txt] [-p] capture.bin\n",
+                argv[0]);
+        return 1;
+    }
+
+    fp = fopen(in_path, "rb");
+    if (fp == NULL) {
+        perror(in_path);
+        return 1;
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    data = malloc(size > 0 ? (size_t)size : 1);
+    if (data == NULL || fread(data, 1, (size_t)size, fp) != (size_t)size) {
+        fprintf(stderr, "read %s failed\n", in_path);
+        fclose(fp);
+        return 1;
+    }
+    fclose(fp);
+
+    if (trace_path != NULL) {
+        trace_fp = fopen(trace_path, "w");
+        if (trace_fp == NULL) {
+            perror(trace_path);
+            return 1;
+        }
+        fprintf(trace_fp, "[");
+    }
+
+    for (size_t pos = 0; pos < (size_t)size;) {
+        size_t len = packet_parse(data + pos, (size_t)size - pos);
+        /* 不是有效的包 (printf 文本或者传输错误), 逐字节重新同步 */
+        pos += (len != 0) ? len : 1;
+    }
+
+    if (trace_fp != NULL) {
+        fprintf(trace_fp, "\n]\n");
+        fclose(trace_fp);
+    }
+
+    if (folded_path != NULL) {
+        folded_fp = fopen(folded_path, "w");
+        if (folded_fp == NULL) {
+            perror(folded_path);
+            return 1;
+        }
+        folded_print();
+        fclose(folded_fp);
+    }
+
+    stat_print();
+    free(data);
+    return 0;
+}
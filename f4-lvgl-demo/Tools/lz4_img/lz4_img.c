@@ -0,0 +1,395 @@
+/**
+ * @file    lz4_img.c
+ * @author  Deadline039
+ * @brief   LZ4 压缩图片转换工具 (PC 端)
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * 把 LVGL 图片转换工具生成的 16 位色 Binary 图片 (.bin, CF_TRUE_COLOR 或
+ * CF_TRUE_COLOR_ALPHA) 按块压缩为 lv_port_lz4 使用的格式, 格式说明见
+ * `Middlewares/LVGL/GUI/porting/lv_port_lz4.h`.
+ * 压缩使用与固件相同的 `eez-flow-lz4.c`.
+ *
+ * 编译:
+ *   gcc -O2 -o lz4_img lz4_img.c ../../Middlewares/LVGL/APP/eez-flow-lz4.c \
+ *       -I../../Middlewares/LVGL/APP
+ *
+ * 用法:
+ *   lz4_img [-r 行数] input.bin output.lz4       生成文件, 放到 NAND/SD 卡
+ *   lz4_img [-r 行数] -c 变量名 input.bin out.c  生成 C 数组, 编译进 Flash
+ *   lz4_img -b input.bin                         比较不同每块行数的压缩率和
+ *                                                解压时间
+ * 每块行数越小, 局部重绘时解压的数据越少, 但压缩率越低. 默认 4 行.
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "eez-flow-lz4.h"
+
+#define LZ4_IMG_MAGIC       "LZ4I"
+#define LZ4_IMG_VERSION     1
+#define LZ4_IMG_HEADER_SIZE 16
+
+/* LVGL 图片格式 (lv_img_cf_t) */
+#define CF_RAW              1
+#define CF_RAW_ALPHA        2
+#define CF_TRUE_COLOR       4
+#define CF_TRUE_COLOR_ALPHA 5
+
+/**
+ * @brief 源图片
+ */
+typedef struct {
+    uint32_t cf;      /*!< LVGL 格式 */
+    uint32_t w;       /*!< 宽度 */
+    uint32_t h;       /*!< 高度 */
+    uint32_t px_size; /*!< 每像素字节数 */
+    uint8_t *pixels;  /*!< 像素数据 */
+} image_t;
+
+/**
+ * @brief 压缩结果
+ */
+typedef struct {
+    uint8_t *data; /*!< 从魔数开始的压缩数据 */
+    uint32_t size; /*!< 压缩数据大小 */
+} packed_t;
+
+static void put_u16(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+ * @brief 读取 LVGL Binary 图片
+ *
+ * @param path 文件路径
+ * @param[out] img 图片
+ * @return 0: 成功; 1: 失败
+ */
+static int load_image(const char *path, image_t *img) {
+    FILE *fp = fopen(path, "rb");
+    uint8_t hdr[4];
+    uint32_t word, size;
+
+    if (fp == NULL) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+
+    if (fread(hdr, 1, 4, fp) != 4) {
+        fclose(fp);
+        return 1;
+    }
+
+    word = get_u32(hdr);
+    img->cf = word & 0x1F;
+    img->w = (word >> 10) & 0x7FF;
+    img->h = (word >> 21) & 0x7FF;
+
+    if (img->cf == CF_TRUE_COLOR) {
+        img->px_size = 2;
+    } else if (img->cf == CF_TRUE_COLOR_ALPHA) {
+        img->px_size = 3;
+    } else {
+        fprintf(stderr, "%s: only 16 bit TRUE_COLOR(_ALPHA) is supported\n",
+                path);
+        fclose(fp);
+        return 1;
+    }
+
+    size = img->w * img->h * img->px_size;
+    img->pixels = malloc(size);
+    if (img->pixels == NULL || fread(img->pixels, 1, size, fp) != size) {
+        fprintf(stderr, "%s: truncated image\n", path);
+        fclose(fp);
+        return 1;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+/**
+ * @brief 按块压缩
+ *
+ * @param img 图片
+ * @param rows 每块行数
+ * @param[out] out 压缩结果
+ * @return 0: 成功; 1: 失败
+ */
+static int pack_image(const image_t *img, uint32_t rows, packed_t *out) {
+    uint32_t line = img->w * img->px_size;
+    uint32_t block_num = (img->h + rows - 1) / rows;
+    uint32_t table = LZ4_IMG_HEADER_SIZE + (block_num + 1) * 4;
+    uint32_t cap = table + block_num * LZ4_compressBound(rows * line);
+    uint32_t pos = table, max_block = 0;
+
+    out->data = malloc(cap);
+    if (out->data == NULL) {
+        return 1;
+    }
+
+    for (uint32_t b = 0; b < block_num; ++b) {
+        uint32_t n = rows;
+        int ret;
+
+        if (b * rows + n > img->h) {
+            n = img->h - b * rows;
+        }
+
+        put_u32(&out->data[LZ4_IMG_HEADER_SIZE + b * 4], pos);
+        ret = LZ4_compress_default((const char *)&img->pixels[b * rows * line],
+                                   (char *)&out->data[pos], (int)(n * line),
+                                   (int)(cap - pos));
+        if (ret <= 0) {
+            return 1;
+        }
+
+        pos += (uint32_t)ret;
+        if ((uint32_t)ret > max_block) {
+            max_block = (uint32_t)ret;
+        }
+    }
+    put_u32(&out->data[LZ4_IMG_HEADER_SIZE + block_num * 4], pos);
+
+    memcpy(out->data, LZ4_IMG_MAGIC, 4);
+    out->data[4] = LZ4_IMG_VERSION;
+    out->data[5] = (uint8_t)img->px_size;
+    put_u16(&out->data[6], rows);
+    put_u16(&out->data[8], img->w);
+    put_u16(&out->data[10], img->h);
+    put_u32(&out->data[12], max_block);
+
+    out->size = pos;
+    return 0;
+}
+
+/**
+ * @brief 解压全部块并与原图比较
+ *
+ * @param img 原图
+ * @param pk 压缩结果
+ * @param[out] full_us 解压整图的时间
+ * @param[out] block_us 解压一块的平均时间
+ * @return 0: 一致; 1: 不一致
+ */
+static int verify_image(const image_t *img, const packed_t *pk,
+                        double *full_us, double *block_us) {
+    uint32_t rows = pk->data[6] | (pk->data[7] << 8);
+    uint32_t line = img->w * img->px_size;
+    uint32_t block_num = (img->h + rows - 1) / rows;
+    uint8_t *out = malloc(img->h * line);
+    double start;
+    int err = 0;
+
+    if (out == NULL) {
+        return 1;
+    }
+
+    start = now_us();
+    for (uint32_t b = 0; b < block_num; ++b) {
+        uint32_t s = get_u32(&pk->data[LZ4_IMG_HEADER_SIZE + b * 4]);
+        uint32_t e = get_u32(&pk->data[LZ4_IMG_HEADER_SIZE + b * 4 + 4]);
+        uint32_t n = (b * rows + rows > img->h) ? img->h - b * rows : rows;
+
+        if (LZ4_decompress_safe((const char *)&pk->data[s],
+                                (char *)&out[b * rows * line], (int)(e - s),
+                                (int)(n * line)) != (int)(n * line)) {
+            err = 1;
+        }
+    }
+    *full_us = now_us() - start;
+    *block_us = *full_us / block_num;
+
+    if (err || memcmp(out, img->pixels, img->h * line) != 0) {
+        err = 1;
+    }
+
+    free(out);
+    return err;
+}
+
+/**
+ * @brief 输出 .lz4 文件
+ */
+static int write_bin(const char *path, const image_t *img,
+                     const packed_t *pk) {
+    FILE *fp = fopen(path, "wb");
+    uint8_t hdr[4];
+    uint32_t cf = (img->px_size == 3) ? CF_RAW_ALPHA : CF_RAW;
+
+    if (fp == NULL) {
+        fprintf(stderr, "cannot create %s\n", path);
+        return 1;
+    }
+
+    put_u32(hdr, cf | (img->w << 10) | (img->h << 21));
+    fwrite(hdr, 1, 4, fp);
+    fwrite(pk->data, 1, pk->size, fp);
+    fclose(fp);
+    return 0;
+}
+
+/**
+ * @brief 输出 C 数组
+ */
+static int write_c(const char *path, const char *name, const image_t *img,
+                   const packed_t *pk) {
+    FILE *fp = fopen(path, "w");
+
+    if (fp == NULL) {
+        fprintf(stderr, "cannot create %s\n", path);
+        return 1;
+    }
+
+    fprintf(fp, "/* Generated by lz4_img, do not edit. */\n\n");
+    fprintf(fp, "#include \"lvgl.h\"\n\n");
+    fprintf(fp, "static const uint8_t %s_map[] = {", name);
+    for (uint32_t i = 0; i < pk->size; ++i) {
+        fprintf(fp, "%s0x%02x,", (i % 16) ? " " : "\n    ", pk->data[i]);
+    }
+    fprintf(fp, "\n};\n\n");
+
+    fprintf(fp, "const lv_img_dsc_t %s = {\n", name);
+    fprintf(fp, "    .header.cf = %s,\n",
+            (img->px_size == 3) ? "LV_IMG_CF_RAW_ALPHA" : "LV_IMG_CF_RAW");
+    fprintf(fp, "    .header.always_zero = 0,\n");
+    fprintf(fp, "    .header.reserved = 0,\n");
+    fprintf(fp, "    .header.w = %u,\n", img->w);
+    fprintf(fp, "    .header.h = %u,\n", img->h);
+    fprintf(fp, "    .data_size = %u,\n", pk->size);
+    fprintf(fp, "    .data = %s_map,\n", name);
+    fprintf(fp, "};\n");
+
+    fclose(fp);
+    return 0;
+}
+
+/**
+ * @brief 比较不同每块行数的压缩率和解压时间
+ */
+static int benchmark(const image_t *img) {
+    static const uint32_t rows_list[] = {1, 2, 4, 8, 16, 32, 64};
+    uint32_t raw = img->w * img->h * img->px_size;
+    double full_us, block_us;
+    packed_t pk;
+
+    printf("%ux%u, %u bytes/pixel, %u bytes raw\n", img->w, img->h,
+           img->px_size, raw);
+    printf("rows  packed     ratio   full decode   one block  max block\n");
+
+    for (uint32_t i = 0; i < sizeof(rows_list) / sizeof(rows_list[0]); ++i) {
+        uint32_t rows = rows_list[i];
+
+        if (rows > img->h) {
+            rows = img->h;
+        }
+
+        if (pack_image(img, rows, &pk) != 0 ||
+            verify_image(img, &pk, &full_us, &block_us) != 0) {
+            fprintf(stderr, "rows %u: round trip failed\n", rows);
+            return 1;
+        }
+
+        printf("%4u  %9u  %5.1f%%  %9.0f us  %7.1f us  %9u\n", rows, pk.size,
+               pk.size * 100.0 / raw, full_us, block_us,
+               get_u32(&pk.data[12]));
+        free(pk.data);
+
+        if (rows == img->h) {
+            break;
+        }
+    }
+
+    printf("decode times are measured on this PC; use lv_port_lz4_benchmark()"
+           " on the board for real numbers\n");
+    return 0;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: lz4_img [-r rows] [-c name] input.bin output\n"
+            "       lz4_img -b input.bin\n");
+}
+
+int main(int argc, char **argv) {
+    const char *name = NULL;
+    uint32_t rows = 4;
+    int bench = 0;
+    int i = 1;
+    double full_us, block_us;
+    image_t img;
+    packed_t pk;
+
+    for (; i < argc && argv[i][0] == '-'; ++i) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            rows = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            name = argv[++i];
+        } else if (strcmp(argv[i], "-b") == 0) {
+            bench = 1;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (bench) {
+        if (i + 1 != argc || load_image(argv[i], &img) != 0) {
+            usage();
+            return 1;
+        }
+        return benchmark(&img);
+    }
+
+    if (i + 2 != argc || rows == 0 || load_image(argv[i], &img) != 0) {
+        usage();
+        return 1;
+    }
+
+    if (rows > img.h) {
+        rows = img.h;
+    }
+
+    if (pack_image(&img, rows, &pk) != 0 ||
+        verify_image(&img, &pk, &full_us, &block_us) != 0) {
+        fprintf(stderr, "compression failed\n");
+        return 1;
+    }
+
+    printf("%ux%u, %u rows/block: %u -> %u bytes (%.1f%%)\n", img.w, img.h,
+           rows, img.w * img.h * img.px_size, pk.size,
+           pk.size * 100.0 / (img.w * img.h * img.px_size));
+
+    if (name != NULL) {
+        return write_c(argv[i + 1], name, &img, &pk);
+    }
+    return write_bin(argv[i + 1], &img, &pk);
+}
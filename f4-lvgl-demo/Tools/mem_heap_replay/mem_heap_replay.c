@@ -0,0 +1,512 @@
+/**
+ * @file    mem_heap_replay.c
+ * @author  Deadline039
+ * @brief   mem_heap 申请记录回放测试 (PC 端)
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * 把 `MEM_HEAP_TRACE` 打开后串口输出的申请记录 (以 "mh " 开头的行, 其他行忽略)
+ * 在 PC 上按固件相同的区域配置回放, 输出每个区域的峰值占用, 碎片率, 失败次数,
+ * 以及与 C 库 malloc 的耗时对比. 没有记录时可以用 -g 生成模拟 LVGL 的随机记录.
+ *
+ * 编译:
+ *   gcc -O2 -o mem_heap_replay mem_heap_replay.c -I../../User/Utils
+ *
+ * 用法:
+ *   mem_heap_replay [-s SRAM KB] [-c CCM KB] [-d SDRAM KB] trace.log
+ *   mem_heap_replay [-s SRAM KB] [-c CCM KB] [-d SDRAM KB] -g 次数 [种子]
+ * 区域大小默认与 main.c 相同: SRAM 64KB, CCM 32KB, SDRAM 8MB.
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* 直接包含源文件, 以便每次回放前复位堆的状态 */
+#define MEM_HEAP_USE_FREERTOS 0
+#define MEM_HEAP_TRACE        0
+#include "mem_heap/mem_heap.c"
+
+/* 每隔多少次操作采样一次碎片率 */
+#define SAMPLE_INTERVAL 64
+/* 计时重复次数, 取最小值 */
+#define REPEAT_NUM      5
+
+/**
+ * @brief 一次操作
+ */
+typedef struct {
+    char type;     /*!< 'a': 申请; 'r': 重新申请; 'f': 释放 */
+    uint8_t hint;  /*!< 放置提示 */
+    uint8_t user;  /*!< 子系统 */
+    uint32_t id;   /*!< 内存编号 */
+    uint32_t size; /*!< 大小 */
+} op_t;
+
+/**
+ * @brief 指针到编号的映射, 开放寻址
+ */
+typedef struct {
+    uint64_t *key;
+    uint32_t *val;
+    size_t mask;
+} ptr_map_t;
+
+static op_t *ops;
+static size_t op_num, op_cap;
+static uint32_t id_num;
+
+/**
+ * @brief 添加一次操作
+ */
+static void op_push(char type, uint32_t id, uint32_t size, uint32_t hint,
+                    uint32_t user) {
+    if (op_num == op_cap) {
+        op_cap = op_cap ? op_cap * 2 : 4096;
+        ops = realloc(ops, op_cap * sizeof(op_t));
+        if (ops == NULL) {
+            fprintf(stderr, "Out of memory.\n");
+            exit(1);
+        }
+    }
+
+    ops[op_num].type = type;
+    ops[op_num].id = id;
+    ops[op_num].size = size;
+    ops[op_num].hint = (uint8_t)(hint < MEM_HEAP_HINT_NUM ? hint : 0);
+    ops[op_num].user = (uint8_t)(user < MEM_HEAP_USER_NUM ? user : 0);
+    ++op_num;
+}
+
+/**
+ * @brief 查找指针所在的槽
+ */
+static size_t map_slot(ptr_map_t *map, uint64_t key) {
+    size_t i = (size_t)((key >> 3) * 0x9E3779B97F4A7C15ULL) & map->mask;
+
+    while (map->key[i] != 0 && map->key[i] != key) {
+        i = (i + 1) & map->mask;
+    }
+
+    return i;
+}
+
+/**
+ * @brief 删除一个指针, 后面的项前移
+ */
+static void map_remove(ptr_map_t *map, uint64_t key) {
+    size_t i = map_slot(map, key), j = i;
+
+    if (map->key[i] == 0) {
+        return;
+    }
+    map->key[i] = 0;
+
+    for (;;) {
+        size_t home;
+
+        j = (j + 1) & map->mask;
+        if (map->key[j] == 0) {
+            return;
+        }
+        home = (size_t)((map->key[j] >> 3) * 0x9E3779B97F4A7C15ULL) &
+               map->mask;
+        /* home 不在 (i, j] 中时需要前移 */
+        if ((i <= j) ? (home <= i || home > j) : (home <= i && home > j)) {
+            map->key[i] = map->key[j];
+            map->val[i] = map->val[j];
+            map->key[j] = 0;
+            i = j;
+        }
+    }
+}
+
+/**
+ * @brief 读取申请记录
+ *
+ * @param path 文件路径
+ */
+static void trace_load(const char *path) {
+    FILE *fp = fopen(path, "r");
+    ptr_map_t map;
+    char line[256];
+    size_t cap = 1U << 16;
+
+    if (fp == NULL) {
+        fprintf(stderr, "Can not open %s.\n", path);
+        exit(1);
+    }
+
+    map.mask = cap - 1;
+    map.key = calloc(cap, sizeof(uint64_t));
+    map.val = calloc(cap, sizeof(uint32_t));
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        char *p = strstr(line, "mh ");
+        char p1[32], p2[32];
+        unsigned int size, hint, user;
+        uint64_t k1, k2;
+        size_t slot;
+
+        if (p == NULL) {
+            continue;
+        }
+
+        if (sscanf(p, "mh a %31s %u %u %u", p1, &size, &hint, &user) == 4) {
+            k1 = strtoull(p1, NULL, 16);
+            if (k1 == 0) {
+                continue; /* 固件上申请失败 */
+            }
+            slot = map_slot(&map, k1);
+            map.key[slot] = k1;
+            map.val[slot] = id_num;
+            op_push('a', id_num++, size, hint, user);
+        } else if (sscanf(p, "mh r %31s %31s %u %u %u", p1, p2, &size, &hint,
+                          &user) == 5) {
+            k1 = strtoull(p1, NULL, 16);
+            k2 = strtoull(p2, NULL, 16);
+            slot = map_slot(&map, k1);
+            if (map.key[slot] == 0 || k2 == 0) {
+                continue;
+            }
+            op_push('r', map.val[slot], size, hint, user);
+            if (k1 != k2) {
+                uint32_t id = map.val[slot];
+
+                map_remove(&map, k1);
+                slot = map_slot(&map, k2);
+                map.key[slot] = k2;
+                map.val[slot] = id;
+            }
+        } else if (sscanf(p, "mh f %31s", p1) == 1) {
+            k1 = strtoull(p1, NULL, 16);
+            slot = map_slot(&map, k1);
+            if (map.key[slot] == 0) {
+                continue;
+            }
+            op_push('f', map.val[slot], 0, 0, 0);
+            map_remove(&map, k1);
+        } else {
+            continue;
+        }
+
+        /* 负载超过一半时扩容 */
+        if (id_num * 2 > map.mask) {
+            ptr_map_t big;
+
+            big.mask = (map.mask + 1) * 2 - 1;
+            big.key = calloc(big.mask + 1, sizeof(uint64_t));
+            big.val = calloc(big.mask + 1, sizeof(uint32_t));
+            for (size_t i = 0; i <= map.mask; ++i) {
+                if (map.key[i] != 0) {
+                    slot = map_slot(&big, map.key[i]);
+                    big.key[slot] = map.key[i];
+                    big.val[slot] = map.val[i];
+                }
+            }
+            free(map.key);
+            free(map.val);
+            map = big;
+        }
+    }
+
+    fclose(fp);
+    free(map.key);
+    free(map.val);
+}
+
+/**
+ * @brief 生成模拟 LVGL 的随机记录: 大量小对象, 少量渲染缓冲区, 内核对象
+ *
+ * @param num 操作次数
+ * @param seed 随机种子
+ */
+static void trace_generate(size_t num, unsigned int seed) {
+    uint32_t *live = malloc(num * sizeof(uint32_t));
+    size_t live_num = 0;
+
+    srand(seed);
+    for (size_t i = 0; i < num; ++i) {
+        int r = rand() % 100;
+
+        if (live_num != 0 && (r < 45 || live_num > 2000)) {
+            size_t k = (size_t)rand() % live_num;
+
+            op_push('f', live[k], 0, 0, 0);
+            live[k] = live[--live_num];
+        } else if (live_num != 0 && r < 50) {
+            size_t k = (size_t)rand() % live_num;
+
+            op_push('r', live[k], 16 + (uint32_t)(rand() % 512),
+                    MEM_HEAP_HINT_DMA, MEM_HEAP_USER_LVGL);
+        } else if (r < 52) {
+            op_push('a', id_num, 4096 + (uint32_t)(rand() % (28 * 1024)),
+                    MEM_HEAP_HINT_DMA, MEM_HEAP_USER_LVGL);
+            live[live_num++] = id_num++;
+        } else if (r < 57) {
+            op_push('a', id_num, 64 + (uint32_t)(rand() % 1024),
+                    MEM_HEAP_HINT_FAST, MEM_HEAP_USER_RTOS);
+            live[live_num++] = id_num++;
+        } else {
+            op_push('a', id_num, 8 + (uint32_t)(rand() % 248),
+                    MEM_HEAP_HINT_DMA, MEM_HEAP_USER_LVGL);
+            live[live_num++] = id_num++;
+        }
+    }
+
+    free(live);
+}
+
+/**
+ * @brief 当前时间 (ns)
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 复位 mem_heap 并注册区域
+ */
+static void heap_reset(uint8_t *ccm, size_t ccm_size, uint8_t *sram,
+                       size_t sram_size, uint8_t *sdram, size_t sdram_size) {
+    heap_region_num = 0;
+    heap_free_size = 0;
+    heap_min_free_size = 0;
+    memset(heap_user_stat, 0, sizeof(heap_user_stat));
+
+    if (ccm_size != 0) {
+        mem_heap_add_region(ccm, ccm_size, MEM_HEAP_ATTR_FAST);
+    }
+    mem_heap_add_region(sram, sram_size, MEM_HEAP_ATTR_FAST | MEM_HEAP_ATTR_DMA);
+    if (sdram_size != 0) {
+        mem_heap_add_region(sdram, sdram_size,
+                            MEM_HEAP_ATTR_DMA | MEM_HEAP_ATTR_LARGE);
+    }
+}
+
+/**
+ * @brief 用 mem_heap 回放一遍
+ *
+ * @param ptr 每个编号对应的指针
+ * @param sample 是否采样碎片率
+ * @param[out] fail 失败次数
+ * @param[out] max_frag 每个区域采样到的最大碎片率
+ * @return 耗时 (ns)
+ */
+static uint64_t replay_heap(void **ptr, int sample, uint32_t *fail,
+                            uint8_t *max_frag) {
+    uint64_t t = 0, t0;
+
+    *fail = 0;
+    for (size_t i = 0; i < op_num; ++i) {
+        op_t *op = &ops[i];
+        void *p;
+
+        t0 = now_ns();
+        switch (op->type) {
+            case 'a': {
+                p = mem_heap_alloc(op->size, (mem_heap_hint_t)op->hint,
+                                   (mem_heap_user_t)op->user);
+                ptr[op->id] = p;
+            } break;
+
+            case 'r': {
+                if (ptr[op->id] == NULL) {
+                    p = (void *)1; /* 之前的申请已经失败 */
+                    break;
+                }
+                p = mem_heap_realloc(ptr[op->id], op->size,
+                                     (mem_heap_hint_t)op->hint,
+                                     (mem_heap_user_t)op->user);
+                if (p != NULL) {
+                    ptr[op->id] = p;
+                }
+            } break;
+
+            default: {
+                mem_heap_free(ptr[op->id]);
+                ptr[op->id] = NULL;
+                p = (void *)1;
+            } break;
+        }
+        t += now_ns() - t0;
+
+        if (p == NULL && op->type != 'f') {
+            ++*fail;
+        }
+
+        if (sample && i % SAMPLE_INTERVAL == 0) {
+            mem_heap_region_stat_t stat;
+
+            for (uint8_t k = 0; mem_heap_get_region_stat(k, &stat) == 0; ++k) {
+                if (stat.frag > max_frag[k]) {
+                    max_frag[k] = stat.frag;
+                }
+            }
+        }
+    }
+
+    return t;
+}
+
+/**
+ * @brief 用 C 库 malloc 回放一遍
+ *
+ * @param ptr 每个编号对应的指针
+ * @return 耗时 (ns)
+ */
+static uint64_t replay_libc(void **ptr) {
+    uint64_t t = 0, t0;
+
+    for (size_t i = 0; i < op_num; ++i) {
+        op_t *op = &ops[i];
+
+        t0 = now_ns();
+        switch (op->type) {
+            case 'a': {
+                ptr[op->id] = malloc(op->size);
+            } break;
+
+            case 'r': {
+                void *p = realloc(ptr[op->id], op->size);
+
+                if (p != NULL) {
+                    ptr[op->id] = p;
+                }
+            } break;
+
+            default: {
+                free(ptr[op->id]);
+                ptr[op->id] = NULL;
+            } break;
+        }
+        t += now_ns() - t0;
+    }
+
+    for (uint32_t i = 0; i < id_num; ++i) {
+        free(ptr[i]);
+    }
+
+    return t;
+}
+
+int main(int argc, char *argv[]) {
+    static const char *user_name[MEM_HEAP_USER_NUM] = {"APP", "RTOS", "LVGL",
+                                                       "CSP"};
+    size_t sram_size = 64U * 1024U, ccm_size = 32U * 1024U;
+    size_t sdram_size = 8U * 1024U * 1024U;
+    uint8_t *sram, *ccm, *sdram;
+    uint8_t max_frag[MEM_HEAP_REGION_NUM] = {0};
+    uint64_t t_heap = UINT64_MAX, t_libc = UINT64_MAX, t;
+    uint32_t fail = 0;
+    void **ptr;
+    int i;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; ++i) {
+        if (i + 1 >= argc) {
+            break;
+        }
+        if (strcmp(argv[i], "-s") == 0) {
+            sram_size = strtoul(argv[++i], NULL, 0) * 1024U;
+        } else if (strcmp(argv[i], "-c") == 0) {
+            ccm_size = strtoul(argv[++i], NULL, 0) * 1024U;
+        } else if (strcmp(argv[i], "-d") == 0) {
+            sdram_size = strtoul(argv[++i], NULL, 0) * 1024U;
+        } else if (strcmp(argv[i], "-g") == 0) {
+            size_t num = strtoul(argv[++i], NULL, 0);
+            unsigned int seed =
+                (i + 1 < argc) ? (unsigned int)strtoul(argv[++i], NULL, 0) : 1;
+
+            trace_generate(num, seed);
+        } else {
+            break;
+        }
+    }
+    if (op_num == 0) {
+        if (i >= argc) {
+            fprintf(stderr,
+                    "Usage: %s [-s SRAM KB] [-c CCM KB] [-d SDRAM KB] "
+                    "trace.log | -g num [seed]\n",
+                    argv[0]);
+            return 1;
+        }
+        trace_load(argv[i]);
+    }
+    if (op_num == 0) {
+        fprintf(stderr, "No allocation records.\n");
+        return 1;
+    }
+
+    sram = malloc(sram_size);
+    ccm = malloc(ccm_size ? ccm_size : 1);
+    sdram = malloc(sdram_size ? sdram_size : 1);
+    ptr = calloc(id_num, sizeof(void *));
+    if (sram == NULL || ccm == NULL || sdram == NULL || ptr == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
+    /* 第一遍统计, 后面几遍计时 */
+    heap_reset(ccm, ccm_size, sram, sram_size, sdram, sdram_size);
+    replay_heap(ptr, 1, &fail, max_frag);
+
+    printf("%zu operations, %u blocks.\n\n", op_num, id_num);
+    printf("Region      Size   Peak used  Free blks  Frag(end/max)\n");
+    for (uint8_t k = 0; k < heap_region_num; ++k) {
+        mem_heap_region_stat_t stat;
+
+        mem_heap_get_region_stat(k, &stat);
+        printf("%-6s %9zu %11zu %10zu %7u%% /%3u%%\n",
+               (stat.attr & MEM_HEAP_ATTR_LARGE) ? "SDRAM"
+               : (stat.attr & MEM_HEAP_ATTR_DMA) ? "SRAM"
+                                                 : "CCM",
+               stat.total_size, stat.total_size - stat.min_free_size,
+               stat.free_blk_num, stat.frag, max_frag[k]);
+    }
+
+    printf("\nUser       Peak      Allocs    Frees     Fails\n");
+    for (int u = 0; u < MEM_HEAP_USER_NUM; ++u) {
+        mem_heap_user_stat_t stat;
+
+        mem_heap_get_user_stat((mem_heap_user_t)u, &stat);
+        if (stat.alloc_cnt == 0 && stat.fail_cnt == 0) {
+            continue;
+        }
+        printf("%-6s %9zu %10u %8u %9u\n", user_name[u], stat.peak,
+               stat.alloc_cnt, stat.free_cnt, stat.fail_cnt);
+    }
+
+    for (int r = 0; r < REPEAT_NUM; ++r) {
+        uint32_t f;
+
+        memset(ptr, 0, id_num * sizeof(void *));
+        heap_reset(ccm, ccm_size, sram, sram_size, sdram, sdram_size);
+        t = replay_heap(ptr, 0, &f, max_frag);
+        t_heap = (t < t_heap) ? t : t_heap;
+
+        memset(ptr, 0, id_num * sizeof(void *));
+        t = replay_libc(ptr);
+        t_libc = (t < t_libc) ? t : t_libc;
+    }
+
+    printf("\nFailed allocations: %u\n", fail);
+    printf("mem_heap: %8.1f ns/op\n", (double)t_heap / (double)op_num);
+    printf("libc    : %8.1f ns/op\n", (double)t_libc / (double)op_num);
+
+    free(ptr);
+    free(sram);
+    free(ccm);
+    free(sdram);
+    free(ops);
+
+    return 0;
+}
@@ -0,0 +1,494 @@
+/**
+ * @file    mem_slab_bench.c
+ * @author  Deadline039
+ * @brief   EEZ Flow 内存分配测试 (PC 端)
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * 生成模拟 EEZ Flow 运行时的申请记录 (Value 字符串, 数组, 组件执行状态,
+ * 少量大块数据和常驻的全局变量), 分别用以下分配器回放, 比较耗时和峰值占用:
+ *   first-fit : EEZ 框架自带的单链表首次适配 (64 字节对齐, 释放时填充 0xCC)
+ *   mem_heap  : 只用 mem_heap
+ *   mem_slab  : 不大于 MEM_SLAB_MAX_SIZE 的用 mem_slab, 其余用 mem_heap,
+ *               与 eez-flow.cpp 中 eez::alloc 的做法相同
+ * PC 上指针为 8 字节, 块头和页描述比固件大, 峰值占用只用于相对比较.
+ *
+ * 编译:
+ *   gcc -O2 -o mem_slab_bench mem_slab_bench.c -I../../User/Utils
+ *
+ * 用法:
+ *   mem_slab_bench [-h 堆 KB] [-s slab KB] [-n 次数] [-r 种子]
+ * 默认与固件相同: 堆 64KB, slab 16KB, 200000 次申请.
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* 直接包含源文件, 以便每次回放前复位状态 */
+#define MEM_HEAP_USE_FREERTOS 0
+#define MEM_HEAP_TRACE        0
+#include "mem_heap/mem_heap.c"
+#include "mem_heap/mem_slab.c"
+
+/* 计时重复次数, 取最小值 */
+#define REPEAT_NUM 5
+/* 模拟固件上的 Value 大小 */
+#define VALUE_SIZE 16
+
+/**
+ * @brief 一次操作
+ */
+typedef struct {
+    uint8_t is_free; /*!< 是否为释放 */
+    uint32_t id;     /*!< 内存编号 */
+    uint32_t size;   /*!< 大小 */
+} op_t;
+
+/**
+ * @brief 分配器
+ */
+typedef struct {
+    const char *name;
+    void (*reset)(void);
+    void *(*alloc)(size_t size);
+    void (*free)(void *ptr);
+    size_t (*used)(void); /*!< 当前占用的堆空间 */
+} allocator_t;
+
+static op_t *ops;
+static size_t op_num, op_cap;
+static uint32_t id_num;
+
+static uint8_t *heap_buf;
+static size_t heap_size = 64U * 1024U;
+static size_t slab_size = 16U * 1024U;
+static void *slab_arena;
+
+/*****************************************************************************
+ * @defgroup 申请记录
+ * @{
+ */
+
+/**
+ * @brief 添加一次操作
+ */
+static void op_push(uint8_t is_free, uint32_t id, uint32_t size) {
+    if (op_num == op_cap) {
+        op_cap = op_cap ? op_cap * 2 : 4096;
+        ops = realloc(ops, op_cap * sizeof(op_t));
+        if (ops == NULL) {
+            fprintf(stderr, "Out of memory.\n");
+            exit(1);
+        }
+    }
+
+    ops[op_num].is_free = is_free;
+    ops[op_num].id = id;
+    ops[op_num].size = size;
+    ++op_num;
+}
+
+/**
+ * @brief 随机数 [lo, hi]
+ */
+static uint32_t rand_range(uint32_t lo, uint32_t hi) {
+    return lo + (uint32_t)rand() % (hi - lo + 1U);
+}
+
+/**
+ * @brief 随机的存活时间 (以申请次数计)
+ *
+ * @note 大多数是表达式求值的临时值, 一部分在队列中等待执行, 少量保存在
+ *       组件状态或变量中
+ */
+static uint32_t rand_life(void) {
+    int r = rand() % 100;
+
+    return (r < 80)   ? rand_range(1, 16)
+           : (r < 99) ? rand_range(16, 256)
+                      : rand_range(1024, 4095);
+}
+
+/**
+ * @brief 生成模拟 EEZ Flow 的申请记录
+ *
+ * @param num 申请次数
+ * @param seed 随机数种子
+ */
+static void trace_generate(size_t num, unsigned int seed) {
+    /* 按释放时刻挂在时间槽上, 时间以申请次数计 */
+    const size_t slot_num = 4096;
+    uint32_t *slot_head = malloc(slot_num * sizeof(uint32_t));
+    uint32_t *next = malloc((2 * num + 64) * sizeof(uint32_t));
+    uint32_t *due = malloc((2 * num + 64) * sizeof(uint32_t));
+
+    if (slot_head == NULL || next == NULL || due == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    memset(slot_head, 0xFF, slot_num * sizeof(uint32_t));
+    srand(seed);
+
+    /* 常驻的全局变量和监视列表 */
+    for (int i = 0; i < 48; ++i) {
+        op_push(0, id_num++, rand_range(16, 128));
+    }
+
+    for (size_t t = 0; t < num; ++t) {
+        uint32_t *head = &slot_head[t % slot_num];
+        uint32_t *p = head;
+        uint32_t size, life;
+        int r;
+
+        /* 先释放到期的 */
+        while (*p != UINT32_MAX) {
+            if (due[*p] == t) {
+                op_push(1, *p, 0);
+                *p = next[*p];
+            } else {
+                p = &next[*p];
+            }
+        }
+
+        r = rand() % 100;
+        if (r < 45) {
+            /* 字符串: StringRef + 内容, 大多很短 */
+            op_push(0, id_num, 8);
+            life = rand_life();
+            due[id_num] = (uint32_t)(t + life);
+            next[id_num] = slot_head[due[id_num] % slot_num];
+            slot_head[due[id_num] % slot_num] = id_num;
+            ++id_num;
+            size = (rand() % 100 < 80) ? rand_range(2, 24) : rand_range(24, 96);
+        } else if (r < 65) {
+            /* 数组: ArrayValueRef + n 个 Value */
+            size = 28 + (rand_range(1, 10) - 1U) * VALUE_SIZE;
+        } else if (r < 90) {
+            /* 组件执行状态 */
+            size = rand_range(16, 192);
+        } else if (r < 98) {
+            /* Value 临时对象 (ArrayElementValue, PropertyRef 等) */
+            size = rand_range(12, 40);
+        } else {
+            /* 大块数据: blob, 图表数据 */
+            size = rand_range(300, 2048);
+        }
+
+        op_push(0, id_num, size);
+        life = rand_life();
+        due[id_num] = (uint32_t)(t + life);
+        next[id_num] = slot_head[due[id_num] % slot_num];
+        slot_head[due[id_num] % slot_num] = id_num;
+        ++id_num;
+    }
+
+    free(slot_head);
+    free(next);
+    free(due);
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup first-fit, 取自 eez-flow.cpp 中非 LVGL 平台的实现 (去掉互斥锁)
+ * @{
+ */
+
+static const size_t FF_ALIGNMENT = 64;
+static const size_t FF_MIN_BLOCK_SIZE = 8;
+
+typedef struct ff_block {
+    struct ff_block *next;
+    int free;
+    size_t size;
+    uint32_t id;
+} ff_block_t;
+
+static size_t ff_used;
+
+static void ff_reset(void) {
+    ff_block_t *first = (ff_block_t *)heap_buf;
+
+    first->next = NULL;
+    first->free = 1;
+    first->size = heap_size - sizeof(ff_block_t);
+    ff_used = 0;
+}
+
+static void *ff_alloc(size_t size) {
+    ff_block_t *block = (ff_block_t *)heap_buf;
+
+    size = ((size + FF_ALIGNMENT - 1) / FF_ALIGNMENT) * FF_ALIGNMENT;
+    while (block) {
+        if (block->free && block->size >= size) {
+            break;
+        }
+        block = block->next;
+    }
+    if (!block) {
+        return NULL;
+    }
+    long remaining = (long)block->size - (long)size - (long)sizeof(ff_block_t);
+    if (remaining >= (long)FF_MIN_BLOCK_SIZE) {
+        ff_block_t *nb =
+            (ff_block_t *)((uint8_t *)block + sizeof(ff_block_t) + size);
+        nb->next = block->next;
+        nb->free = 1;
+        nb->size = (size_t)remaining;
+        block->next = nb;
+        block->size = size;
+    }
+    block->free = 0;
+    ff_used += block->size + sizeof(ff_block_t);
+    return block + 1;
+}
+
+static void ff_free(void *ptr) {
+    ff_block_t *prev = NULL;
+    ff_block_t *block = (ff_block_t *)heap_buf;
+
+    if (ptr == NULL) {
+        return;
+    }
+    while (block && (void *)(block + 1) < ptr) {
+        prev = block;
+        block = block->next;
+    }
+    if (!block || (void *)(block + 1) != ptr || block->free) {
+        return;
+    }
+    ff_used -= block->size + sizeof(ff_block_t);
+    memset(ptr, 0xCC, block->size);
+    ff_block_t *nb = block->next;
+    if (nb && nb->free) {
+        if (prev && prev->free) {
+            prev->next = nb->next;
+            prev->size += sizeof(ff_block_t) + block->size +
+                          sizeof(ff_block_t) + nb->size;
+        } else {
+            block->next = nb->next;
+            block->size += sizeof(ff_block_t) + nb->size;
+            block->free = 1;
+        }
+    } else if (prev && prev->free) {
+        prev->next = nb;
+        prev->size += sizeof(ff_block_t) + block->size;
+    } else {
+        block->free = 1;
+    }
+}
+
+static size_t ff_get_used(void) {
+    return ff_used;
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup mem_heap 和 mem_slab
+ * @{
+ */
+
+static void heap_reset(void) {
+    heap_region_num = 0;
+    heap_free_size = 0;
+    heap_min_free_size = 0;
+    memset(heap_user_stat, 0, sizeof(heap_user_stat));
+    mem_heap_add_region(heap_buf, heap_size,
+                        MEM_HEAP_ATTR_FAST | MEM_HEAP_ATTR_DMA);
+}
+
+static void *heap_alloc(size_t size) {
+    return mem_heap_alloc(size, MEM_HEAP_HINT_DMA, MEM_HEAP_USER_LVGL);
+}
+
+static size_t heap_get_used(void) {
+    return heap_region[0].total_size - heap_region[0].free_size;
+}
+
+static void slab_reset(void) {
+    heap_reset();
+    slab_arena = mem_heap_alloc(slab_size, MEM_HEAP_HINT_FAST,
+                                MEM_HEAP_USER_LVGL);
+    if (slab_arena == NULL || mem_slab_init(slab_arena, slab_size) != 0) {
+        fprintf(stderr, "Slab arena too large for the heap.\n");
+        exit(1);
+    }
+}
+
+static void *slab_alloc(size_t size) {
+    void *ptr = mem_slab_alloc(size);
+
+    return (ptr != NULL) ? ptr : heap_alloc(size);
+}
+
+static void slab_free(void *ptr) {
+    if (mem_slab_contains(ptr)) {
+        mem_slab_free(ptr);
+    } else {
+        mem_heap_free(ptr);
+    }
+}
+
+/* 已使用的页加上 slab 之外的堆占用 */
+static size_t slab_get_used(void) {
+    return slab_stat.page_used * (size_t)MEM_SLAB_PAGE_SIZE + heap_get_used() -
+           BLK_SIZE(heap_get_blk(slab_arena));
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @brief 当前时间 (ns)
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 回放一遍
+ *
+ * @param a 分配器
+ * @param ptr 每个编号对应的指针
+ * @param[out] peak 峰值占用, 为 NULL 时不统计 (计时)
+ * @param[out] fail 失败次数
+ * @return 耗时 (ns)
+ */
+static uint64_t replay(const allocator_t *a, void **ptr, size_t *peak,
+                       uint32_t *fail) {
+    uint64_t t0;
+
+    memset(ptr, 0, id_num * sizeof(void *));
+    a->reset();
+    *fail = 0;
+    if (peak != NULL) {
+        *peak = 0;
+    }
+
+    t0 = now_ns();
+    for (size_t i = 0; i < op_num; ++i) {
+        const op_t *op = &ops[i];
+
+        if (op->is_free) {
+            a->free(ptr[op->id]);
+            ptr[op->id] = NULL;
+        } else {
+            ptr[op->id] = a->alloc(op->size);
+            if (ptr[op->id] == NULL) {
+                ++*fail;
+            }
+        }
+
+        if (peak != NULL) {
+            size_t used = a->used();
+            if (used > *peak) {
+                *peak = used;
+            }
+        }
+    }
+
+    return now_ns() - t0;
+}
+
+int main(int argc, char *argv[]) {
+    static const allocator_t allocators[] = {
+        {"first-fit", ff_reset, ff_alloc, ff_free, ff_get_used},
+        {"mem_heap", heap_reset, heap_alloc, mem_heap_free, heap_get_used},
+        {"mem_slab", slab_reset, slab_alloc, slab_free, slab_get_used},
+    };
+    size_t num = 200000;
+    unsigned int seed = 1;
+    size_t live_bytes = 0, peak_live = 0;
+    uint32_t *sizes;
+    void **ptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 >= argc) {
+            fprintf(stderr,
+                    "Usage: %s [-h heap KB] [-s slab KB] [-n num] [-r seed]\n",
+                    argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-h") == 0) {
+            heap_size = strtoul(argv[++i], NULL, 0) * 1024U;
+        } else if (strcmp(argv[i], "-s") == 0) {
+            slab_size = strtoul(argv[++i], NULL, 0) * 1024U;
+        } else if (strcmp(argv[i], "-n") == 0) {
+            num = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-r") == 0) {
+            seed = (unsigned int)strtoul(argv[++i], NULL, 0);
+        }
+    }
+
+    trace_generate(num, seed);
+
+    heap_buf = malloc(heap_size);
+    ptr = malloc(id_num * sizeof(void *));
+    sizes = calloc(id_num, sizeof(uint32_t));
+    if (heap_buf == NULL || ptr == NULL || sizes == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
+    /* 请求的字节数, 作为占用的下限 */
+    for (size_t i = 0; i < op_num; ++i) {
+        if (ops[i].is_free) {
+            live_bytes -= sizes[ops[i].id];
+        } else {
+            sizes[ops[i].id] = ops[i].size;
+            live_bytes += ops[i].size;
+            if (live_bytes > peak_live) {
+                peak_live = live_bytes;
+            }
+        }
+    }
+
+    printf("%zu operations, %u blocks, peak requested %zu bytes.\n", op_num,
+           id_num, peak_live);
+    printf("Heap %zu KB, slab %zu KB (%u byte granule, objects <= %u).\n\n",
+           heap_size / 1024U, slab_size / 1024U, MEM_SLAB_GRANULE,
+           MEM_SLAB_MAX_SIZE);
+    printf("Allocator      ns/op   Peak used  Overhead  Failed\n");
+
+    for (size_t k = 0; k < sizeof(allocators) / sizeof(allocators[0]); ++k) {
+        const allocator_t *a = &allocators[k];
+        uint64_t best = UINT64_MAX, t;
+        size_t peak;
+        uint32_t fail;
+
+        replay(a, ptr, &peak, &fail);
+        for (int r = 0; r < REPEAT_NUM; ++r) {
+            t = replay(a, ptr, NULL, &fail);
+            if (t < best) {
+                best = t;
+            }
+        }
+
+        printf("%-10s %9.1f %11zu %8.1f%% %7u\n", a->name,
+               (double)best / (double)op_num, peak,
+               100.0 * ((double)peak - (double)peak_live) / (double)peak_live,
+               fail);
+    }
+
+    free(heap_buf);
+    free(ptr);
+    free(sizes);
+    free(ops);
+    return 0;
+}
@@ -0,0 +1,297 @@
+/**
+ * @file    string_bench.cpp
+ * @author  Deadline039
+ * @brief   EEZ Flow 字符串测试 (PC 端)
+ * @version 1.0
+ * @date    2026-10-19
+ *****************************************************************************
+ * 直接包含 eez-flow.cpp, 统计常见的字符串操作 (数字转字符串, "文字" + 数字
+ * 拼接, String.format, 重复赋值给变量) 每次的堆分配次数和耗时.
+ * 把 eez-flow.h 中的 EEZ_FLOW_STRING_POOL 改为 0 后重新编译, 可以和原来的
+ * 每个字符串分配两次比较.
+ *
+ * -v 比较 formatDouble, formatDoubleFixed 和 formatInt* 与 snprintf 的
+ * 输出, 使用随机的 float, double 和整数.
+ *
+ * 编译:
+ *   g++ -O2 -std=gnu++17 -o string_bench string_bench.cpp
+ *       ../../Middlewares/LVGL/APP/eez-flow-lz4.c -DLV_CONF_SKIP
+ *       -I../../Middlewares/LVGL/APP -I../../Middlewares/LVGL/GUI
+ *       -I../../Middlewares/LVGL/GUI/lvgl -I../../Middlewares/LVGL/GUI/lvgl/src
+ *       -I../../Middlewares/LVGL/GUI/porting -I../../User/Utils
+ * 测试不会调用 LVGL, 用到的 LVGL 函数由 ../eez_stub/eez_stub.h 提供空实现.
+ *
+ * 用法:
+ *   string_bench [-n 次数] [-v]
+ *****************************************************************************
+ * Change Logs:
+ * Date         Version     Author      Notes
+ * 2026-10-19   1.0         Deadline039 第一次发布
+ */
+
+#include "eez-flow.cpp"
+
+#include "../eez_stub/eez_stub.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* 计时重复次数, 取最小值 */
+#define REPEAT_NUM 5
+
+static size_t alloc_count;
+
+/* eez::alloc 使用的分配函数, 统计分配次数 */
+extern "C" {
+void *mem_slab_alloc(size_t size) {
+    (void)size;
+    return NULL;
+}
+uint8_t mem_slab_contains(const void *ptr) {
+    (void)ptr;
+    return 0;
+}
+void mem_slab_free(void *ptr) {
+    (void)ptr;
+}
+void *lv_mem_alloc(size_t size) {
+    ++alloc_count;
+    return malloc(size);
+}
+void lv_mem_free(void *ptr) {
+    free(ptr);
+}
+}
+
+using namespace eez;
+using namespace eez::flow;
+
+/**
+ * @brief 测试项
+ */
+typedef struct {
+    const char *name;           /*!< 名称 */
+    void (*run)(uint32_t iter); /*!< 执行一次 */
+} bench_t;
+
+static Value label_var;
+
+/**
+ * @brief 数字转字符串
+ *
+ * @param iter 第几次
+ */
+static void bench_int_to_string(uint32_t iter) {
+    Value value((int)(iter % 1000), VALUE_TYPE_INT32);
+    Value str = value.toString(0);
+}
+
+/**
+ * @brief 小数转字符串
+ *
+ * @param iter 第几次
+ */
+static void bench_float_to_string(uint32_t iter) {
+    Value value(20.0f + (float)(iter % 100) * 0.1f, VALUE_TYPE_FLOAT);
+    Value str = value.toString(0);
+}
+
+/**
+ * @brief "Temp: " + 数字 + " C"
+ *
+ * @param iter 第几次
+ */
+static void bench_concat(uint32_t iter) {
+    Value value(20.0f + (float)(iter % 100) * 0.1f, VALUE_TYPE_FLOAT);
+    Value str = op_add(op_add(Value("Temp: "), value), Value(" C"));
+}
+
+/**
+ * @brief String.format("%.2f", 数字)
+ *
+ * @param iter 第几次
+ */
+static void bench_format(uint32_t iter) {
+    EvalStack stack;
+    Value value(20.0 + (double)(iter % 100) * 0.01, VALUE_TYPE_DOUBLE);
+    stack.push(value);
+    stack.push(Value("%.2f"));
+    do_OPERATION_TYPE_STRING_FORMAT(stack);
+    Value str = stack.pop();
+}
+
+/**
+ * @brief 每次 tick 把同样的文字赋值给变量, 值很少改变
+ *
+ * @param iter 第几次
+ */
+static void bench_label(uint32_t iter) {
+    Value mode((int)(iter / 1000 % 4), VALUE_TYPE_INT32);
+    label_var = op_add(Value("Mode "), mode);
+}
+
+static const bench_t benches[] = {
+    {"int toString",        bench_int_to_string  },
+    {"float toString",      bench_float_to_string},
+    {"\"Temp: \" + x + \" C\"", bench_concat         },
+    {"String.format %.2f",  bench_format         },
+    {"label = \"Mode \" + x", bench_label          },
+};
+
+/**
+ * @brief 当前时间
+ *
+ * @return 纳秒
+ */
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/**
+ * @brief 比较一个 double 的格式化结果
+ *
+ * @param value 数值
+ * @return 不同的数量
+ */
+static size_t verify_double(double value) {
+    char expect[64], text[64];
+    size_t mismatch = 0;
+
+    snprintf(expect, sizeof(expect), "%g", value);
+    formatDouble(text, sizeof(text), value);
+    if (strcmp(expect, text) != 0) {
+        if (mismatch++ < 10) {
+            printf("%%g %.17g: \"%s\" != \"%s\"\n", value, text, expect);
+        }
+    }
+    for (int d = 0; d <= 6; ++d) {
+        snprintf(expect, sizeof(expect), "%.*f", d, value);
+        formatDoubleFixed(text, sizeof(text), value, d);
+        if (strcmp(expect, text) != 0) {
+            if (mismatch++ < 10) {
+                printf("%%.%df %.17g: \"%s\" != \"%s\"\n", d, value, text,
+                       expect);
+            }
+        }
+    }
+    return mismatch;
+}
+
+/**
+ * @brief 随机的 64 位数
+ *
+ * @return 随机数
+ */
+static uint64_t rand64(void) {
+    return ((uint64_t)rand() << 62) ^ ((uint64_t)rand() << 31) ^
+           (uint64_t)rand();
+}
+
+/**
+ * @brief 比较格式化结果与 snprintf
+ *
+ * @param n 数量
+ * @return 不同的数量
+ */
+static size_t verify(size_t n) {
+    char expect[32], text[32];
+    size_t mismatch = 0;
+    static const double edges[] = {
+        0.0,      -0.0,     1e-5,      9.999995e-6, 1e-4,     0.1,
+        0.5,      0.125,    0.0625,    1.5,         2.5,      999999.4,
+        999999.5, 999999.6, 12345.25,  12345.75,    1e6,      123456.5,
+        0.000125, 1e9,      999999999.5, NAN,       INFINITY, -INFINITY,
+    };
+
+    srand(1);
+    for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i) {
+        mismatch += verify_double(edges[i]);
+        mismatch += verify_double(-edges[i]);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t bits = rand64();
+        uint32_t fbits = (uint32_t)bits;
+        double d;
+        float f;
+
+        /* 随机位的 float 和 double, 以及常见范围内的小数 */
+        memcpy(&f, &fbits, sizeof(f));
+        mismatch += verify_double(f);
+        memcpy(&d, &bits, sizeof(d));
+        mismatch += verify_double(d);
+        mismatch += verify_double((double)(int32_t)fbits / 1000.0);
+        mismatch += verify_double((float)((int32_t)(fbits % 2000001) - 1000000) /
+                                  (float)(1 + bits % 10000));
+
+        snprintf(expect, sizeof(expect), "%" PRId32, (int32_t)fbits);
+        formatInt32(text, (int32_t)fbits);
+        mismatch += strcmp(expect, text) != 0;
+        snprintf(expect, sizeof(expect), "%" PRIu32, fbits);
+        formatUInt32(text, fbits);
+        mismatch += strcmp(expect, text) != 0;
+        snprintf(expect, sizeof(expect), "%" PRId64, (int64_t)bits);
+        formatInt64(text, (int64_t)bits);
+        mismatch += strcmp(expect, text) != 0;
+        snprintf(expect, sizeof(expect), "%" PRIu64, bits >> (bits % 64));
+        formatUInt64(text, bits >> (bits % 64));
+        mismatch += strcmp(expect, text) != 0;
+    }
+    formatInt32(text, INT32_MIN);
+    mismatch += strcmp(text, "-2147483648") != 0;
+    formatInt64(text, INT64_MIN);
+    mismatch += strcmp(text, "-9223372036854775808") != 0;
+
+    return mismatch;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = 100000;
+    bool check = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            check = true;
+        } else {
+            fprintf(stderr, "Usage: %s [-n num] [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (check) {
+        size_t mismatch = verify(n);
+        printf("%zu values, %zu mismatches\n", n, mismatch);
+        return mismatch != 0;
+    }
+
+    printf("%-24s %12s %12s\n", "", "allocs/op", "ns/op");
+    for (size_t b = 0; b < sizeof(benches) / sizeof(benches[0]); ++b) {
+        double best = 0;
+        size_t allocs = 0;
+
+        for (int r = 0; r < REPEAT_NUM; ++r) {
+            size_t start_allocs = alloc_count;
+            double start = now_ns();
+            for (size_t i = 0; i < n; ++i) {
+                benches[b].run((uint32_t)i);
+            }
+            double t = (now_ns() - start) / (double)n;
+            if (r == 0 || t < best) {
+                best = t;
+            }
+            allocs = alloc_count - start_allocs;
+        }
+        printf("%-24s %12.2f %12.1f\n", benches[b].name,
+               (double)allocs / (double)n, best);
+    }
+    label_var = Value();
+
+    return 0;
+}
@@ -34,7 +34,13 @@ extern uint32_t SystemCoreClock;
 //  <i> 如果启用tickless模式, 当在Idle时停止tick周期中断.
 //  <i> 如果禁用, 将会一直产生tick周期中断
 //  <i> 默认: 0
-#define configUSE_TICKLESS_IDLE                   0
+#define configUSE_TICKLESS_IDLE                   1
+
+/* tickless 休眠时 SysTick 中断被抑制, 唤醒后 vTaskStepTick 补上 FreeRTOS 的
+ * 节拍, 这里同时补上 HAL 的 uwTick, 保证 HAL_GetTick 在休眠后和挂起调度器时
+ * 都能正常计时 */
+extern volatile uint32_t uwTick;
+#define traceINCREASE_TICK_COUNT(x) (uwTick += (uint32_t)(x))
 
 //  <o>系统时钟节拍频率 [Hz] <0-0xFFFFFFFF>
 #define configTICK_RATE_HZ                        ((TickType_t)1000)
@@ -120,6 +126,7 @@ extern uint32_t SystemCoreClock;
 #define configSUPPORT_DYNAMIC_ALLOCATION          1
 
 //  <o>堆内存总大小 [byte] <0-65535>
+//  <i> 未使用, 内核对象和任务栈由 mem_heap 分配
 #define configTOTAL_HEAP_SIZE                     ((size_t)16384)
 
 //  <q>用户手动分配FreeRTOS内存堆
@@ -128,7 +135,8 @@ extern uint32_t SystemCoreClock;
 
 //  <q>用户自行实现任务创建时使用的内存申请与释放函数
 //  <i> 默认: 0
-#define configSTACK_ALLOCATION_FROM_SEPARATE_HEAP 0
+//  <i> 任务栈可能被 DMA 访问, 由 mem_heap 分配在 DMA 可访问的区域
+#define configSTACK_ALLOCATION_FROM_SEPARATE_HEAP 1
 
 // </h>
 
@@ -170,10 +178,16 @@ extern uint32_t SystemCoreClock;
 #define configGENERATE_RUN_TIME_STATS             0
 
 #if (configGENERATE_RUN_TIME_STATS == 1)
-#include "btim.h"
-#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() ConfigureTimeForRunTimeStats()
-extern uint32_t FreeRTOSRunTimeTicks;
-#define portGET_RUN_TIME_COUNTER_VALUE() FreeRTOSRunTimeTicks
+/* 使用 DWT 周期计数器, 休眠时不计数, 总时间减去空闲任务的时间即为 CPU 忙碌的
+ * 时间. 32 位计数器在 168MHz 下约 25 秒溢出, 统计间隔需要小于这个时间 */
+#include "stm32f4xx.h"
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()                              \
+    do {                                                                       \
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;                        \
+        DWT->CYCCNT = 0;                                                       \
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;                                   \
+    } while (0)
+#define portGET_RUN_TIME_COUNTER_VALUE() (DWT->CYCCNT)
 #endif /* configGENERATE_RUN_TIME_STATS == 1 */
 
 //  <q>使用可视化跟踪调试
@@ -20,14 +20,21 @@ extern "C" {
 
 #include "bsp.h"
 
+#include "mem_heap/mem_heap.h"
+
 #include "FreeRTOS.h"
 #include "task.h"
 
 #include "lv_port_disp.h"
+#include "lv_port_fs.h"
+#include "lv_port_img_cache.h"
+#include "lv_port_lz4.h"
 #include "lv_port_indev.h"
+#include "lv_port_prof.h"
 #include "lvgl.h"
 
 #include "ui.h"
+#include "eez_debugger.h"
 
 #include "ff.h"
 #include "usbd_cdc.h"
@@ -35,6 +42,7 @@ extern "C" {
 #include "usbd_conf.h"
 #include "usbd_core.h"
 #include "usbd_desc.h"
+#include "usbd_event.h"
 #include "usbd_msc.h"
 #include "usbd_storage_if.h"
 
@@ -62,6 +70,8 @@ extern TaskHandle_t gui_task_handle;
  */
 
 void freertos_start(void);
+void gui_task_wakeup(void);
+void gui_task_wakeup_from_isr(BaseType_t *higher_task_woken);
 void at24c02_dev_init(void);
 
 uint8_t usb_detect_msc(void);
@@ -10,6 +10,26 @@
 
 extern USBD_HandleTypeDef usbd_device;
 
+/* 堆区域: 内部 SRAM, CCM (高 32KB, 低 32KB 留给链接器) 和外部 SDRAM */
+#define HEAP_SRAM_SIZE  (64U * 1024U)
+#define HEAP_CCM_ADDR   0X10008000
+#define HEAP_CCM_SIZE   (32U * 1024U)
+/* 跳过显存, lv_port_fs 缓冲区和图片缓存 */
+#define HEAP_SDRAM_ADDR 0XC1000000
+#define HEAP_SDRAM_SIZE (8U * 1024U * 1024U)
+
+#define HEAP_STR_(x)    #x
+#define HEAP_STR(x)     HEAP_STR_(x)
+
+static uint8_t heap_sram[HEAP_SRAM_SIZE] __attribute__((aligned(8)));
+
+#if (__ARMCC_VERSION >= 6010050) /* 使用 AC6 编译器 */
+static uint8_t heap_ccm[HEAP_CCM_SIZE]
+    __attribute__((section(".bss.ARM.__at_" HEAP_STR(HEAP_CCM_ADDR))));
+#else /* 使用 AC5 编译器 */
+static uint8_t heap_ccm[HEAP_CCM_SIZE] __attribute__((at(HEAP_CCM_ADDR)));
+#endif /* __ARMCC_VERSION */
+
 /**
  * @brief The program entrance.
  *
@@ -17,7 +37,18 @@ extern USBD_HandleTypeDef usbd_device;
  */
 int main(void) {
     HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);
+
+    /* CCM 只有 CPU 能访问, 先注册, 供内核对象等小对象优先使用 */
+    mem_heap_add_region(heap_ccm, HEAP_CCM_SIZE, MEM_HEAP_ATTR_FAST);
+    mem_heap_add_region(heap_sram, HEAP_SRAM_SIZE,
+                        MEM_HEAP_ATTR_FAST | MEM_HEAP_ATTR_DMA);
+
     bsp_init();
+
+    /* SDRAM 初始化后才能使用 */
+    mem_heap_add_region((void *)HEAP_SDRAM_ADDR, HEAP_SDRAM_SIZE,
+                        MEM_HEAP_ATTR_DMA | MEM_HEAP_ATTR_LARGE);
+
     if (usb_detect_msc()) {
         usb_app(NULL);
     }
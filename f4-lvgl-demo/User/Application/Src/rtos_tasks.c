@@ -14,6 +14,20 @@ void start_task(void *pvParameters);
 TaskHandle_t gui_task_handle;
 void gui_task(void *pvParameters);
 
+/* GUI 任务最长的休眠时间 (ms), 防止漏掉没有通知的数据变化 */
+#define GUI_TASK_MAX_SLEEP_MS  500
+/* EEZ Flow 队列中有任务时的刷新周期 (ms) */
+#define GUI_TASK_FLOW_TICK_MS  5
+
+/* 每 GUI_TASK_STAT_PERIOD_MS 通过 printf 输出 GUI 任务的唤醒次数和 CPU
+ * 占用率, 需要开启 configGENERATE_RUN_TIME_STATS */
+#define GUI_TASK_STAT          0
+#define GUI_TASK_STAT_PERIOD_MS 10000
+
+/* 非 0 时改回固定周期轮询 (原来为 5 ms), 用于和事件驱动方式对比
+ * GUI_TASK_STAT 的统计结果, 正常使用保持为 0 */
+#define GUI_TASK_POLL_MS       0
+
 /*****************************************************************************/
 
 /**
@@ -55,21 +69,148 @@ void action_led1_toggle(lv_event_t *e) {
 }
 
 /**
- * @brief Task1: Blink.
+ * @brief Wake up the GUI task, e.g. after a touch, a key press or a change of
+ *        the data displayed.
+ *
+ * @note Can not be called in interrupt, use `gui_task_wakeup_from_isr`.
+ */
+void gui_task_wakeup(void) {
+    if (gui_task_handle != NULL) {
+        xTaskNotifyGive(gui_task_handle);
+    }
+}
+
+/**
+ * @brief Wake up the GUI task from interrupt.
+ *
+ * @param[out] higher_task_woken Set to `pdTRUE` if a context switch is
+ *                               needed, pass to `portYIELD_FROM_ISR`.
+ */
+void gui_task_wakeup_from_isr(BaseType_t *higher_task_woken) {
+    if (gui_task_handle != NULL) {
+        vTaskNotifyGiveFromISR(gui_task_handle, higher_task_woken);
+    }
+}
+
+#if EEZ_DEBUGGER_CDC
+
+/**
+ * @brief Wake up the GUI task when the debugger sends a command, called in
+ *        the USB interrupt.
+ *
+ */
+static void gui_task_debugger_wakeup(void) {
+    BaseType_t higher_task_woken = pdFALSE;
+
+    gui_task_wakeup_from_isr(&higher_task_woken);
+    portYIELD_FROM_ISR(higher_task_woken);
+}
+
+#endif /* EEZ_DEBUGGER_CDC */
+
+#if GUI_TASK_STAT
+
+/**
+ * @brief Print the wakeups and CPU load of every `GUI_TASK_STAT_PERIOD_MS`.
+ *
+ * @note Leave the screen untouched for a few periods to get the idle
+ *       numbers, then compare them with `GUI_TASK_POLL_MS` set to 5.
+ */
+static void gui_task_stat(void) {
+    static TickType_t last_tick;
+    static uint32_t last_total, last_idle, wakeups;
+    TickType_t now = xTaskGetTickCount();
+    uint32_t total, idle, busy, load;
+
+    ++wakeups;
+    if (now - last_tick < pdMS_TO_TICKS(GUI_TASK_STAT_PERIOD_MS)) {
+        return;
+    }
+
+    total = portGET_RUN_TIME_COUNTER_VALUE();
+    idle = ulTaskGetIdleRunTimeCounter();
+    busy = (total - last_total) - (idle - last_idle);
+    /* 千分比 */
+    load = (uint32_t)((uint64_t)busy * 1000U /
+                      ((uint64_t)(now - last_tick) *
+                       (SystemCoreClock / configTICK_RATE_HZ)));
+
+    printf("gui: %u wakeups in %u ms, cpu load %u.%u%%\r\n",
+           (unsigned int)wakeups,
+           (unsigned int)((now - last_tick) * portTICK_PERIOD_MS),
+           (unsigned int)(load / 10), (unsigned int)(load % 10));
+
+    last_tick = now;
+    last_total = total;
+    last_idle = idle;
+    wakeups = 0;
+}
+
+#endif /* GUI_TASK_STAT */
+
+/**
+ * @brief GUI task.
  *
  * @param pvParameters Start parameters.
+ * @note Sleeps until the next LVGL timer is due. Touch samples and
+ *       `gui_task_wakeup` wake it up early. While the screen is static and
+ *       nothing is touched, the task wakes up only for the LVGL timers and
+ *       the EEZ Flow Delay components, and the idle task enters tickless
+ *       sleep.
  */
 void gui_task(void *pvParameters) {
+    uint32_t sleep_ms;
+
     UNUSED(pvParameters);
     lv_init();
     lv_port_disp_init();
     lv_port_indev_init();
+    lv_port_fs_init();
+    lv_port_lz4_init();
+    lv_port_img_cache_init();
+
+#if TP_USE_INT
+    tp_sample_set_callback(gui_task_wakeup);
+#endif /* TP_USE_INT */
+
+#if EEZ_DEBUGGER_CDC
+    eez_debugger_init(gui_task_debugger_wakeup);
+#endif /* EEZ_DEBUGGER_CDC */
 
     ui_init();
 
     while (1) {
-        lv_timer_handler();
+        LV_PORT_PROF_BEGIN(LV_PORT_PROF_TIMER);
+        sleep_ms = lv_timer_handler();
+        LV_PORT_PROF_END(LV_PORT_PROF_TIMER);
+        LV_PORT_PROF_BEGIN(LV_PORT_PROF_UI_TICK);
         ui_tick();
-        vTaskDelay(5);
+        LV_PORT_PROF_END(LV_PORT_PROF_UI_TICK);
+
+        if (!eez_flow_is_idle() && sleep_ms > GUI_TASK_FLOW_TICK_MS) {
+            sleep_ms = GUI_TASK_FLOW_TICK_MS;
+        }
+        if (sleep_ms > eez_flow_get_timeout()) {
+            sleep_ms = eez_flow_get_timeout();
+        }
+        if (sleep_ms > GUI_TASK_MAX_SLEEP_MS) {
+            sleep_ms = GUI_TASK_MAX_SLEEP_MS;
+        }
+
+#if GUI_TASK_STAT
+        gui_task_stat();
+#endif /* GUI_TASK_STAT */
+
+#if GUI_TASK_POLL_MS
+        /* 旧的轮询方式, 只用于对比测量 */
+        vTaskDelay(pdMS_TO_TICKS(GUI_TASK_POLL_MS));
+        if (ulTaskNotifyTake(pdTRUE, 0) != 0) {
+            lv_port_indev_resume();
+        }
+#else  /* GUI_TASK_POLL_MS */
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleep_ms)) != 0) {
+            lv_port_indev_resume();
+        }
+#endif /* GUI_TASK_POLL_MS */
     }
 }
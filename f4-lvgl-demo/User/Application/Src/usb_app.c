@@ -11,6 +11,9 @@
 USBD_HandleTypeDef usbd_device;
 TaskHandle_t usb_app_handle;
 
+/* 读写状态的保持时间 (ms), 超过此时间没有读写则不再显示 */
+#define USB_APP_ACTIVITY_MS 50
+
 /* 是否使用 MSC 设备 */
 uint8_t g_usb_app_use_msc;
 
@@ -23,6 +26,7 @@ uint8_t usb_detect_msc(void) {
     key_press_t key;
     uint32_t start_time = HAL_GetTick();
 
+    usbd_event_init();
     USBD_Init(&usbd_device, &USBD_Desc, DEVICE_FS);
     USBD_RegisterClass(&usbd_device, USBD_CDC_CLASS);
     USBD_CDC_RegisterInterface(&usbd_device, &USBD_CDC_fops);
@@ -57,9 +61,10 @@ void usb_app(void *pvParameters) {
     LED0_OFF();
     LED1_OFF();
 
-    uint8_t last_usb_state_reg = 0;
+    uint32_t msc_state = 0;
+    uint32_t last_msc_state = 0;
     uint32_t last_usb_dev_state = 0;
-    uint8_t times = 0;
+    uint32_t window_tick;
 
     lcd_init();
     lcd_display_dir(1);
@@ -85,30 +90,32 @@ void usb_app(void *pvParameters) {
     lcd_show_string(disp_x - 20, disp_y - 20, 400, 24, 16,
                     "Now is USB storage mode. ", BLACK);
 
+    window_tick = HAL_GetTick();
+
     while (1) {
-        if (last_usb_state_reg != g_usb_msc_state) {
+        if (last_msc_state != msc_state) {
             lcd_fill(disp_x - 20, disp_y, disp_x + 200, disp_y + 16 * 4, WHITE);
-            if (g_usb_msc_state & (1 << 0)) {
+            if (msc_state & (1 << 0)) {
                 lcd_show_string(disp_x - 20, disp_y, 200, 16, 16,
                                 "USB Writing...", RED);
             }
 
-            if (g_usb_msc_state & (1 << 1)) {
+            if (msc_state & (1 << 1)) {
                 lcd_show_string(disp_x - 20, disp_y + 16, 200, 16, 16,
                                 "USB Reading...", BLUE);
             }
 
-            if (g_usb_msc_state & (1 << 2)) {
+            if (msc_state & (1 << 2)) {
                 lcd_show_string(disp_x - 20, disp_y + 16 * 2, 200, 16, 16,
                                 "USB Write Error. ", RED);
             }
 
-            if (g_usb_msc_state & (1 << 3)) {
+            if (msc_state & (1 << 3)) {
                 lcd_show_string(disp_x - 20, disp_y + 16 * 3, 200, 16, 16,
                                 "USB Read Error. ", RED);
             }
 
-            last_usb_state_reg = g_usb_msc_state;
+            last_msc_state = msc_state;
         }
 
         if (last_usb_dev_state != g_usb_dev_state) {
@@ -123,14 +130,16 @@ void usb_app(void *pvParameters) {
             last_usb_dev_state = g_usb_dev_state;
         }
 
-        delay_ms(1);
+        /* 等待 USB 事件, 超时用于让读写状态消失. 此时调度器还没有启动,
+           等待期间 CPU 处于睡眠状态 */
+        uint32_t events = usbd_event_wait(USB_APP_ACTIVITY_MS);
 
-        ++times;
-
-        if (times > 50) {
-            /* 每 50ms 更新一次设备状态 */
-            times = 0;
-            g_usb_msc_state = 0;
+        if (HAL_GetTick() - window_tick >= USB_APP_ACTIVITY_MS) {
+            /* 每 50ms 重新统计一次读写状态 */
+            window_tick = HAL_GetTick();
+            msc_state = 0;
         }
+
+        msc_state |= events & USBD_EVENT_MSC_ALL;
     }
 }
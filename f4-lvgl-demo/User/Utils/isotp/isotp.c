@@ -0,0 +1,672 @@
+/**
+ * @file    isotp.c
+ * @author  Deadline039
+ * @brief   ISO 15765-2 (ISO-TP) 分段传输
+ * @version 1.0
+ * @date    2026-10-19
+ */
+
+#include "isotp.h"
+
+#if (CAN1_ENABLE || CAN2_ENABLE || CAN3_ENABLE)
+
+#include <stddef.h>
+#include <string.h>
+
+/* 协议控制信息 (PCI) 的类型 */
+#define PCI_SF     0x00U /* 单帧 */
+#define PCI_FF     0x10U /* 首帧 */
+#define PCI_CF     0x20U /* 连续帧 */
+#define PCI_FC     0x30U /* 流控帧 */
+
+/* 流控帧的状态 */
+#define FC_CTS     0x00U /* 继续发送 */
+#define FC_WAIT    0x01U /* 等待 */
+#define FC_OVFLW   0x02U /* 溢出 */
+#define FC_NONE    0xFFU /* 没有要发送的流控帧 */
+
+#define EVENT_NONE 0xFFU
+
+/**
+ * @brief 发送状态
+ */
+enum {
+    TX_IDLE,   /*!< 空闲 */
+    TX_SEND,   /*!< 发送单帧, 首帧或连续帧 */
+    TX_WAIT_FC /*!< 等待流控帧 */
+};
+
+/**
+ * @brief 接收状态
+ */
+enum {
+    RX_IDLE,   /*!< 空闲 */
+    RX_RECEIVE /*!< 等待连续帧 */
+};
+
+static isotp_channel_t *isotp_list;
+
+/**
+ * @brief 关中断
+ *
+ * @return 原来的 PRIMASK
+ */
+static inline uint32_t isotp_lock(void) {
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    return primask;
+}
+
+/**
+ * @brief 恢复中断
+ *
+ * @param primask isotp_lock 的返回值
+ */
+static inline void isotp_unlock(uint32_t primask) {
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 是否已经到了某个时刻
+ *
+ * @param now 当前时刻
+ * @param time 某个时刻
+ * @return 1: 已到; 0: 未到
+ */
+static inline uint8_t isotp_time_after(uint32_t now, uint32_t time) {
+    return (int32_t)(now - time) >= 0;
+}
+
+/**
+ * @brief STmin 转换为 ms
+ *
+ * @param st_min 流控帧中的 STmin
+ * @return 间隔, 单位: ms. 100-900us 按 1ms, 保留的值按 127ms
+ */
+static uint8_t isotp_st_min_ms(uint8_t st_min) {
+    if (st_min <= 0x7FU) {
+        return st_min;
+    }
+
+    if (st_min >= 0xF1U && st_min <= 0xF9U) {
+        return 1;
+    }
+
+    return 0x7FU;
+}
+
+/**
+ * @brief 初始化要发送的帧, 数据填充为 ISOTP_PADDING_BYTE
+ *
+ * @param channel 通道
+ * @param frame 帧
+ */
+static void isotp_frame_init(const isotp_channel_t *channel,
+                             can_frame_t *frame) {
+    frame->id = channel->cfg.tx_id;
+    frame->ide = channel->cfg.ide;
+    frame->rtr = CAN_RTR_DATA;
+    memset(frame->data, ISOTP_PADDING_BYTE, sizeof(frame->data));
+}
+
+/**
+ * @brief 把帧放入 CAN 发送队列
+ *
+ * @param channel 通道
+ * @param frame 帧
+ * @param len 有效的长度, 填充时发送 8 字节
+ * @return `CAN_SEND_OK` 成功, 其他值为失败
+ */
+static uint8_t isotp_frame_send(const isotp_channel_t *channel,
+                                can_frame_t *frame, uint32_t len) {
+    frame->len = channel->cfg.padding ? 8U : (uint8_t)len;
+    return can_send(channel->cfg.can, frame);
+}
+
+/**
+ * @brief 发送结束
+ *
+ * @param channel 通道
+ * @param status 结果
+ */
+static void isotp_tx_finish(isotp_channel_t *channel, uint8_t status) {
+    channel->tx_state = TX_IDLE;
+    channel->tx_buf = NULL;
+    channel->tx_event = status;
+}
+
+/**
+ * @brief 接收结束
+ *
+ * @param channel 通道
+ * @param status 结果
+ */
+static void isotp_rx_finish(isotp_channel_t *channel, uint8_t status) {
+    channel->rx_state = RX_IDLE;
+    channel->rx_event = status;
+    channel->rx_event_len =
+        (status == ISOTP_OVERFLOW) ? channel->rx_len : channel->rx_pos;
+}
+
+/**
+ * @brief 发送等待的流控帧, 队列满时由下次调用重试
+ *
+ * @param channel 通道
+ */
+static void isotp_rx_send_fc(isotp_channel_t *channel) {
+    can_frame_t frame;
+
+    if (channel->rx_fc == FC_NONE) {
+        return;
+    }
+
+    isotp_frame_init(channel, &frame);
+    frame.data[0] = PCI_FC | channel->rx_fc;
+    frame.data[1] = channel->cfg.block_size;
+    frame.data[2] = channel->cfg.st_min;
+    if (isotp_frame_send(channel, &frame, 3) == CAN_SEND_OK) {
+        channel->rx_fc = FC_NONE;
+    }
+}
+
+/**
+ * @brief 把后面的帧放入 CAN 发送队列, 直到需要等待流控帧, STmin 或队列
+ *
+ * @param channel 通道
+ * @param now 当前时刻
+ */
+static void isotp_tx_pump(isotp_channel_t *channel, uint32_t now) {
+    can_frame_t frame;
+    uint32_t len, n;
+
+    while (channel->tx_state == TX_SEND) {
+        if (channel->tx_pos != 0) {
+            if (channel->tx_st_min != 0 &&
+                !isotp_time_after(now, channel->tx_timer)) {
+                return;
+            }
+            if (can_tx_pending(channel->cfg.can) >= ISOTP_TX_PENDING_MAX) {
+                return;
+            }
+        }
+
+        isotp_frame_init(channel, &frame);
+        if (channel->tx_pos == 0 && channel->tx_len <= 7) {
+            n = channel->tx_len;
+            frame.data[0] = PCI_SF | (uint8_t)n;
+            memcpy(&frame.data[1], channel->tx_buf, n);
+            len = n + 1;
+        } else if (channel->tx_pos == 0) {
+            if (channel->tx_len <= 0xFFFU) {
+                frame.data[0] = PCI_FF | (uint8_t)(channel->tx_len >> 8);
+                frame.data[1] = (uint8_t)channel->tx_len;
+                n = 6;
+            } else {
+                /* 超过 4095 字节, 长度为 0, 后面是 32 位长度 */
+                frame.data[0] = PCI_FF;
+                frame.data[1] = 0;
+                frame.data[2] = (uint8_t)(channel->tx_len >> 24);
+                frame.data[3] = (uint8_t)(channel->tx_len >> 16);
+                frame.data[4] = (uint8_t)(channel->tx_len >> 8);
+                frame.data[5] = (uint8_t)channel->tx_len;
+                n = 2;
+            }
+            memcpy(&frame.data[8 - n], channel->tx_buf, n);
+            len = 8;
+        } else {
+            n = channel->tx_len - channel->tx_pos;
+            if (n > 7) {
+                n = 7;
+            }
+            frame.data[0] = PCI_CF | channel->tx_sn;
+            memcpy(&frame.data[1], channel->tx_buf + channel->tx_pos, n);
+            len = n + 1;
+        }
+
+        if (isotp_frame_send(channel, &frame, len) != CAN_SEND_OK) {
+            return;
+        }
+
+        channel->tx_deadline = now + ISOTP_TIMEOUT_MS;
+        if (channel->tx_pos == 0 && channel->tx_len > 7) {
+            /* 首帧之后等待流控帧 */
+            channel->tx_pos = n;
+            channel->tx_sn = 1;
+            channel->tx_state = TX_WAIT_FC;
+            return;
+        }
+
+        channel->tx_pos += n;
+        if (channel->tx_pos >= channel->tx_len) {
+            isotp_tx_finish(channel, ISOTP_OK);
+            return;
+        }
+
+        channel->tx_sn = (channel->tx_sn + 1) & 0x0FU;
+        if (channel->tx_bs != 0 && ++channel->tx_bs_cnt >= channel->tx_bs) {
+            channel->tx_bs_cnt = 0;
+            channel->tx_state = TX_WAIT_FC;
+            return;
+        }
+
+        if (channel->tx_st_min != 0) {
+            /* 当前时刻可能已经过了一部分, 多等 1ms 保证间隔 */
+            channel->tx_timer = now + channel->tx_st_min + 1;
+        }
+    }
+}
+
+/**
+ * @brief 处理一个收到的帧
+ *
+ * @param channel 通道
+ * @param frame 帧
+ * @param now 当前时刻
+ */
+static void isotp_rx_frame(isotp_channel_t *channel, const can_frame_t *frame,
+                           uint32_t now) {
+    const uint8_t *data = frame->data;
+    uint32_t len, n;
+
+    if (frame->rtr != CAN_RTR_DATA || frame->len == 0) {
+        return;
+    }
+
+    switch (data[0] & 0xF0U) {
+        case PCI_SF: {
+            len = data[0] & 0x0FU;
+            if (len == 0 || len + 1 > frame->len) {
+                return;
+            }
+
+            /* 新的消息会中止正在接收的消息 */
+            channel->rx_len = len;
+            channel->rx_pos = 0;
+            if (len > channel->cfg.rx_size) {
+                isotp_rx_finish(channel, ISOTP_OVERFLOW);
+                return;
+            }
+
+            memcpy(channel->cfg.rx_buf, &data[1], len);
+            channel->rx_pos = len;
+            isotp_rx_finish(channel, ISOTP_OK);
+        } break;
+
+        case PCI_FF: {
+            if (frame->len < 8) {
+                return;
+            }
+
+            len = ((uint32_t)(data[0] & 0x0FU) << 8) | data[1];
+            n = 6;
+            if (len == 0) {
+                len = ((uint32_t)data[2] << 24) | ((uint32_t)data[3] << 16) |
+                      ((uint32_t)data[4] << 8) | data[5];
+                n = 2;
+                if (len <= 0xFFFU) {
+                    return;
+                }
+            } else if (len <= 7) {
+                return;
+            }
+
+            channel->rx_len = len;
+            channel->rx_pos = 0;
+            if (len > channel->cfg.rx_size) {
+                channel->rx_fc = FC_OVFLW;
+                isotp_rx_send_fc(channel);
+                isotp_rx_finish(channel, ISOTP_OVERFLOW);
+                return;
+            }
+
+            memcpy(channel->cfg.rx_buf, &data[8 - n], n);
+            channel->rx_pos = n;
+            channel->rx_sn = 1;
+            channel->rx_bs_cnt = 0;
+            channel->rx_deadline = now + ISOTP_TIMEOUT_MS;
+            channel->rx_state = RX_RECEIVE;
+            channel->rx_fc = FC_CTS;
+            isotp_rx_send_fc(channel);
+        } break;
+
+        case PCI_CF: {
+            if (channel->rx_state != RX_RECEIVE) {
+                return;
+            }
+
+            if ((data[0] & 0x0FU) != channel->rx_sn) {
+                isotp_rx_finish(channel, ISOTP_SEQ_ERR);
+                return;
+            }
+
+            n = channel->rx_len - channel->rx_pos;
+            if (n > 7) {
+                n = 7;
+            }
+            if (n > frame->len - 1U) {
+                n = frame->len - 1U;
+            }
+            memcpy(channel->cfg.rx_buf + channel->rx_pos, &data[1], n);
+            channel->rx_pos += n;
+            channel->rx_sn = (channel->rx_sn + 1) & 0x0FU;
+            channel->rx_deadline = now + ISOTP_TIMEOUT_MS;
+
+            if (channel->rx_pos >= channel->rx_len) {
+                isotp_rx_finish(channel, ISOTP_OK);
+                return;
+            }
+
+            if (channel->cfg.block_size != 0 &&
+                ++channel->rx_bs_cnt >= channel->cfg.block_size) {
+                channel->rx_bs_cnt = 0;
+                channel->rx_fc = FC_CTS;
+                isotp_rx_send_fc(channel);
+            }
+        } break;
+
+        case PCI_FC: {
+            if (channel->tx_state != TX_WAIT_FC || frame->len < 3) {
+                return;
+            }
+
+            switch (data[0] & 0x0FU) {
+                case FC_CTS:
+                    channel->tx_bs = data[1];
+                    channel->tx_bs_cnt = 0;
+                    channel->tx_st_min = isotp_st_min_ms(data[2]);
+                    channel->tx_timer = now;
+                    channel->tx_state = TX_SEND;
+                    isotp_tx_pump(channel, now);
+                    break;
+
+                case FC_WAIT:
+                    channel->tx_deadline = now + ISOTP_TIMEOUT_MS;
+                    break;
+
+                case FC_OVFLW:
+                    isotp_tx_finish(channel, ISOTP_OVERFLOW);
+                    break;
+
+                default:
+                    isotp_tx_finish(channel, ISOTP_SEQ_ERR);
+                    break;
+            }
+        } break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief 调用等待通知的回调函数, 不能关中断调用
+ *
+ * @param channel 通道
+ */
+static void isotp_notify(isotp_channel_t *channel) {
+    uint32_t primask, rx_len;
+    uint8_t tx_event, rx_event;
+
+    primask = isotp_lock();
+    tx_event = channel->tx_event;
+    rx_event = channel->rx_event;
+    rx_len = channel->rx_event_len;
+    channel->tx_event = EVENT_NONE;
+    channel->rx_event = EVENT_NONE;
+    isotp_unlock(primask);
+
+    if (tx_event != EVENT_NONE && channel->cfg.tx_done != NULL) {
+        channel->cfg.tx_done(channel, tx_event);
+    }
+
+    if (rx_event != EVENT_NONE && channel->cfg.rx_done != NULL) {
+        channel->cfg.rx_done(channel, rx_len, rx_event);
+    }
+}
+
+/**
+ * @brief 通知所有通道
+ *
+ */
+static void isotp_notify_all(void) {
+    isotp_channel_t *channel;
+
+    for (channel = isotp_list; channel != NULL; channel = channel->next) {
+        isotp_notify(channel);
+    }
+}
+
+/**
+ * @brief 接收环的回调, 在 CAN 接收中断中调用
+ *
+ * @param ring 接收环
+ */
+static void isotp_rx_callback(can_rx_ring_t *ring) {
+    isotp_channel_t *channel =
+        (isotp_channel_t *)((uint8_t *)ring - offsetof(isotp_channel_t, ring));
+    uint32_t now = HAL_GetTick();
+    can_frame_t *frame;
+    uint32_t primask;
+
+    while ((frame = can_rx_ring_peek(ring)) != NULL) {
+        primask = isotp_lock();
+        isotp_rx_frame(channel, frame, now);
+        isotp_unlock(primask);
+        can_rx_ring_pop(ring);
+
+        /* 每条消息结束都要通知, 下一条消息会覆盖缓冲区 */
+        isotp_notify(channel);
+    }
+}
+
+/**
+ * @brief CAN 发送完成的回调, 在 CAN 发送中断中调用
+ *
+ * @param can_selected 哪个 CAN
+ */
+static void isotp_tx_callback(can_selected_t can_selected) {
+    uint32_t now = HAL_GetTick();
+    isotp_channel_t *channel;
+    uint32_t primask;
+
+    primask = isotp_lock();
+    for (channel = isotp_list; channel != NULL; channel = channel->next) {
+        if (channel->cfg.can == can_selected) {
+            isotp_rx_send_fc(channel);
+            isotp_tx_pump(channel, now);
+        }
+    }
+    isotp_unlock(primask);
+
+    isotp_notify_all();
+}
+
+/**
+ * @brief 打开通道
+ *
+ * @param channel 通道
+ * @param cfg 配置, 会复制到通道中
+ * @return 打开结果
+ * @retval - 0: `ISOTP_OK`:        成功
+ * @retval - 1: `ISOTP_PARAM_ERR`: 参数错误
+ * @retval - 6: `ISOTP_CAN_ERR`:   CAN 订阅失败
+ * @note 会占用 CAN 的发送完成回调 (can_set_tx_callback). 不能在中断中调用.
+ */
+uint8_t isotp_open(isotp_channel_t *channel, const isotp_config_t *cfg) {
+    uint32_t max_id, primask;
+    isotp_channel_t **prev;
+
+    if (channel == NULL || cfg == NULL) {
+        return ISOTP_PARAM_ERR;
+    }
+
+    max_id = (cfg->ide == CAN_ID_STD) ? 0x7FFU : 0x1FFFFFFFU;
+    if ((cfg->ide != CAN_ID_STD && cfg->ide != CAN_ID_EXT) ||
+        cfg->tx_id > max_id || cfg->rx_id > max_id) {
+        return ISOTP_PARAM_ERR;
+    }
+
+    memset(channel, 0, sizeof(isotp_channel_t));
+    channel->cfg = *cfg;
+    if (channel->cfg.rx_buf == NULL) {
+        channel->cfg.rx_size = 0;
+    }
+    channel->rx_fc = FC_NONE;
+    channel->tx_event = EVENT_NONE;
+    channel->rx_event = EVENT_NONE;
+    can_rx_ring_init(&channel->ring, channel->frames, ISOTP_RX_RING_SIZE,
+                     isotp_rx_callback);
+
+    primask = isotp_lock();
+    channel->next = isotp_list;
+    isotp_list = channel;
+    isotp_unlock(primask);
+
+    if (can_rx_subscribe(cfg->can, cfg->ide, cfg->rx_id, max_id, cfg->fifo,
+                         &channel->ring) != CAN_FILTER_OK) {
+        primask = isotp_lock();
+        for (prev = &isotp_list; *prev != NULL; prev = &(*prev)->next) {
+            if (*prev == channel) {
+                *prev = channel->next;
+                break;
+            }
+        }
+        isotp_unlock(primask);
+        return ISOTP_CAN_ERR;
+    }
+
+    can_set_tx_callback(cfg->can, isotp_tx_callback);
+
+    return ISOTP_OK;
+}
+
+/**
+ * @brief 关闭通道, 正在进行的收发直接中止, 不调用回调函数
+ *
+ * @param channel 通道
+ * @note 不能在中断中调用.
+ */
+void isotp_close(isotp_channel_t *channel) {
+    isotp_channel_t **prev;
+    uint32_t primask;
+
+    if (channel == NULL) {
+        return;
+    }
+
+    can_rx_unsubscribe(channel->cfg.can, &channel->ring);
+
+    primask = isotp_lock();
+    for (prev = &isotp_list; *prev != NULL; prev = &(*prev)->next) {
+        if (*prev == channel) {
+            *prev = channel->next;
+            break;
+        }
+    }
+    channel->tx_state = TX_IDLE;
+    channel->rx_state = RX_IDLE;
+    isotp_unlock(primask);
+}
+
+/**
+ * @brief 发送一条消息, 不等待
+ *
+ * @param channel 通道
+ * @param data 数据, 在 tx_done 之前不能修改
+ * @param len 长度, 1 到 ISOTP_MAX_SIZE
+ * @return 发送结果
+ * @retval - 0: `ISOTP_OK`:        开始发送, 结果由 tx_done 通知
+ * @retval - 1: `ISOTP_PARAM_ERR`: 参数错误
+ * @retval - 2: `ISOTP_BUSY`:      上一条消息还没有发送完
+ * @note 单帧可能在返回之前就调用 tx_done.
+ */
+uint8_t isotp_send(isotp_channel_t *channel, const uint8_t *data,
+                   uint32_t len) {
+    uint32_t now = HAL_GetTick();
+    uint32_t primask;
+
+    if (channel == NULL || data == NULL || len == 0 || len > ISOTP_MAX_SIZE) {
+        return ISOTP_PARAM_ERR;
+    }
+
+    primask = isotp_lock();
+    if (channel->tx_state != TX_IDLE) {
+        isotp_unlock(primask);
+        return ISOTP_BUSY;
+    }
+
+    channel->tx_buf = data;
+    channel->tx_len = len;
+    channel->tx_pos = 0;
+    channel->tx_sn = 0;
+    channel->tx_bs = 0;
+    channel->tx_bs_cnt = 0;
+    channel->tx_st_min = 0;
+    channel->tx_deadline = now + ISOTP_TIMEOUT_MS;
+    channel->tx_state = TX_SEND;
+    isotp_tx_pump(channel, now);
+    isotp_unlock(primask);
+
+    isotp_notify(channel);
+
+    return ISOTP_OK;
+}
+
+/**
+ * @brief 是否正在发送
+ *
+ * @param channel 通道
+ * @return 1: 正在发送; 0: 空闲
+ */
+uint8_t isotp_tx_busy(isotp_channel_t *channel) {
+    return channel->tx_state != TX_IDLE;
+}
+
+/**
+ * @brief 更换接收缓冲区, 正在接收的消息会被丢弃
+ *
+ * @param channel 通道
+ * @param buf 缓冲区
+ * @param size 大小
+ * @note 可以在 rx_done 中调用, 实现多个缓冲区轮流接收.
+ */
+void isotp_set_rx_buf(isotp_channel_t *channel, uint8_t *buf, uint32_t size) {
+    uint32_t primask = isotp_lock();
+
+    channel->rx_state = RX_IDLE;
+    channel->cfg.rx_buf = buf;
+    channel->cfg.rx_size = (buf == NULL) ? 0 : size;
+    isotp_unlock(primask);
+}
+
+/**
+ * @brief 处理超时, STmin 和队列满时的重试, 每 1ms 调用一次
+ *
+ */
+void isotp_tick(void) {
+    uint32_t now = HAL_GetTick();
+    isotp_channel_t *channel;
+    uint32_t primask;
+
+    primask = isotp_lock();
+    for (channel = isotp_list; channel != NULL; channel = channel->next) {
+        if (channel->tx_state != TX_IDLE &&
+            isotp_time_after(now, channel->tx_deadline)) {
+            isotp_tx_finish(channel, ISOTP_TIMEOUT);
+        }
+
+        if (channel->rx_state == RX_RECEIVE &&
+            isotp_time_after(now, channel->rx_deadline)) {
+            isotp_rx_finish(channel, ISOTP_TIMEOUT);
+        }
+
+        isotp_rx_send_fc(channel);
+        isotp_tx_pump(channel, now);
+    }
+    isotp_unlock(primask);
+
+    isotp_notify_all();
+}
+
+#endif /* (CAN1_ENABLE || CAN2_ENABLE || CAN3_ENABLE) */
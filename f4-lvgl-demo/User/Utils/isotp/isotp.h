@@ -0,0 +1,148 @@
+/**
+ * @file    isotp.h
+ * @author  Deadline039
+ * @brief   ISO 15765-2 (ISO-TP) 分段传输
+ * @version 1.0
+ * @date    2026-10-19
+ *
+ * 基于 CSP 的 CAN 驱动, 用 8 字节的经典 CAN 帧传输最长 ISOTP_MAX_SIZE 字节的
+ * 消息, 超过 4095 字节时首帧使用 32 位长度. 每个通道使用一对 ID, 收发可以
+ * 同时进行, 多个通道可以同时工作.
+ *
+ * 接收: 通道把 rx_id 订阅到自己的接收环, 在 CAN 接收中断中处理, 数据直接
+ * 复制到调用者的缓冲区, 不经过中间缓冲区. 完成后调用 rx_done, 可以在其中用
+ * isotp_set_rx_buf 换一个缓冲区, 否则下一条消息会覆盖它.
+ * 发送: 数据在 tx_done 之前不能修改. STmin 为 0 时连续帧在 CAN 发送完成中断中
+ * 补充 (需要打开 CAN 的发送中断), STmin 不为 0 时由 isotp_tick 按时间发送.
+ *
+ * isotp_tick 需要每 1ms 调用一次, 处理超时, STmin 和发送队列满时的重试.
+ * rx_done 和 tx_done 在中断, isotp_tick 或 isotp_send 中调用.
+ */
+
+#ifndef __ISOTP_H
+#define __ISOTP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <CSP_Config.h>
+
+#include <stdint.h>
+
+#if (CAN1_ENABLE || CAN2_ENABLE || CAN3_ENABLE)
+
+/* 每个通道接收环的帧数, 必须是 2 的幂 */
+#ifndef ISOTP_RX_RING_SIZE
+#define ISOTP_RX_RING_SIZE   16
+#endif /* ISOTP_RX_RING_SIZE */
+/* 等待流控帧 (N_Bs), 连续帧 (N_Cr) 和发送 (N_As) 的超时, 单位: ms */
+#ifndef ISOTP_TIMEOUT_MS
+#define ISOTP_TIMEOUT_MS     1000
+#endif /* ISOTP_TIMEOUT_MS */
+/* CAN 发送队列中的帧不少于这个数时暂停发送连续帧, 给其他报文留出空间 */
+#ifndef ISOTP_TX_PENDING_MAX
+#define ISOTP_TX_PENDING_MAX 8
+#endif /* ISOTP_TX_PENDING_MAX */
+/* 填充字节 */
+#ifndef ISOTP_PADDING_BYTE
+#define ISOTP_PADDING_BYTE   0xCC
+#endif /* ISOTP_PADDING_BYTE */
+/* 消息最大长度 */
+#ifndef ISOTP_MAX_SIZE
+#define ISOTP_MAX_SIZE       0x10000UL
+#endif /* ISOTP_MAX_SIZE */
+
+#define ISOTP_OK        0 /* 成功 */
+#define ISOTP_PARAM_ERR 1 /* 参数错误 */
+#define ISOTP_BUSY      2 /* 正在发送 */
+#define ISOTP_TIMEOUT   3 /* 超时 */
+#define ISOTP_OVERFLOW  4 /* 接收方缓冲区不够 */
+#define ISOTP_SEQ_ERR   5 /* 序号错误或流控帧无效 */
+#define ISOTP_CAN_ERR   6 /* CAN 订阅失败 */
+
+typedef struct isotp_channel isotp_channel_t;
+
+/**
+ * @brief 通道配置
+ */
+typedef struct {
+    can_selected_t can; /*!< 使用的 CAN */
+    uint32_t tx_id;     /*!< 发送的 ID */
+    uint32_t rx_id;     /*!< 接收的 ID */
+    uint8_t ide;        /*!< `CAN_ID_STD` 或 `CAN_ID_EXT` */
+    uint8_t fifo;       /*!< 接收的 FIFO, 必须打开它的中断 */
+    uint8_t block_size; /*!< 接收时流控帧的 BS, 0: 不分块 */
+    uint8_t st_min;     /*!< 接收时流控帧的 STmin, 按标准编码 */
+    uint8_t padding;    /*!< 1: 发送的帧填充到 8 字节 */
+    uint8_t *rx_buf;    /*!< 接收缓冲区, 可以为 NULL */
+    uint32_t rx_size;   /*!< 接收缓冲区大小 */
+
+    /**
+     * @brief 收到一条消息或接收失败
+     *
+     * @param channel 通道
+     * @param len 消息长度. 失败时为已收到的长度, 溢出时为消息的长度
+     * @param status `ISOTP_OK`, `ISOTP_TIMEOUT`, `ISOTP_OVERFLOW` 或
+     *               `ISOTP_SEQ_ERR`
+     */
+    void (*rx_done)(isotp_channel_t *channel, uint32_t len, uint8_t status);
+
+    /**
+     * @brief 最后一帧放入 CAN 发送队列或发送失败
+     *
+     * @param channel 通道
+     * @param status `ISOTP_OK`, `ISOTP_TIMEOUT`, `ISOTP_OVERFLOW` 或
+     *               `ISOTP_SEQ_ERR`
+     */
+    void (*tx_done)(isotp_channel_t *channel, uint8_t status);
+
+    void *user; /*!< 用户数据 */
+} isotp_config_t;
+
+/**
+ * @brief 通道, 由调用者分配, 关闭之前不能释放
+ */
+struct isotp_channel {
+    isotp_config_t cfg;                     /*!< 配置 */
+    can_rx_ring_t ring;                     /*!< 接收环 */
+    can_frame_t frames[ISOTP_RX_RING_SIZE]; /*!< 接收环的帧 */
+    struct isotp_channel *next;             /*!< 下一个通道 */
+
+    const uint8_t *tx_buf; /*!< 发送的数据 */
+    uint32_t tx_len;       /*!< 发送的长度 */
+    uint32_t tx_pos;       /*!< 已发送的长度 */
+    uint32_t tx_timer;     /*!< 下一个连续帧的时刻 */
+    uint32_t tx_deadline;  /*!< 超时的时刻 */
+    uint8_t tx_state;      /*!< 发送状态 */
+    uint8_t tx_sn;         /*!< 下一个连续帧的序号 */
+    uint8_t tx_bs;         /*!< 对方的 BS */
+    uint8_t tx_bs_cnt;     /*!< 这一块已发送的连续帧 */
+    uint8_t tx_st_min;     /*!< 对方的 STmin, 单位: ms */
+    uint8_t tx_event;      /*!< 等待通知的发送结果 */
+
+    uint32_t rx_len;       /*!< 接收的长度 */
+    uint32_t rx_pos;       /*!< 已接收的长度 */
+    uint32_t rx_deadline;  /*!< 超时的时刻 */
+    uint32_t rx_event_len; /*!< 等待通知的接收长度 */
+    uint8_t rx_state;      /*!< 接收状态 */
+    uint8_t rx_sn;         /*!< 下一个连续帧的序号 */
+    uint8_t rx_bs_cnt;     /*!< 这一块已接收的连续帧 */
+    uint8_t rx_fc;         /*!< 等待发送的流控帧 */
+    uint8_t rx_event;      /*!< 等待通知的接收结果 */
+};
+
+uint8_t isotp_open(isotp_channel_t *channel, const isotp_config_t *cfg);
+void isotp_close(isotp_channel_t *channel);
+uint8_t isotp_send(isotp_channel_t *channel, const uint8_t *data, uint32_t len);
+uint8_t isotp_tx_busy(isotp_channel_t *channel);
+void isotp_set_rx_buf(isotp_channel_t *channel, uint8_t *buf, uint32_t size);
+void isotp_tick(void);
+
+#endif /* (CAN1_ENABLE || CAN2_ENABLE || CAN3_ENABLE) */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ISOTP_H */
@@ -0,0 +1,866 @@
+/**
+ * @file    mem_heap.c
+ * @author  Deadline039
+ * @brief   多区域堆管理, 统一管理 SRAM, CCM 和 SDRAM
+ * @version 1.0
+ * @date    2026-10-19
+ */
+
+#include "mem_heap.h"
+
+#include <string.h>
+
+#if MEM_HEAP_TRACE
+#include <stdio.h>
+#endif /* MEM_HEAP_TRACE */
+
+#if MEM_HEAP_USE_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#endif /* MEM_HEAP_USE_FREERTOS */
+
+#define MEM_HEAP_ALIGN     8U
+#define MEM_HEAP_ALIGN_UP(x)                                                   \
+    (((x) + (MEM_HEAP_ALIGN - 1U)) & ~(size_t)(MEM_HEAP_ALIGN - 1U))
+
+/* 最小的一级为 [16, 32), 每级大小翻倍 */
+#define MEM_HEAP_CLASS_SHIFT 4U
+#define MEM_HEAP_CLASS_NUM   28U
+
+#define BLK_USED             1U
+#define BLK_MAGIC_USED       0xA55AU
+#define BLK_MAGIC_FREE       0x5AA5U
+
+/**
+ * @brief 块头, 紧挨在返回给用户的指针之前
+ */
+typedef struct mem_blk {
+    struct mem_blk *prev_phys; /*!< 物理上的前一块, 区域中第一块为 NULL */
+    uint32_t size;             /*!< 块大小 (含块头), bit0: 已占用 */
+    uint8_t region;            /*!< 所属区域 */
+    uint8_t user;              /*!< 所属子系统 */
+    uint16_t magic;            /*!< 检测重复释放和非法指针 */
+    uint32_t req;              /*!< 申请的大小 */
+
+    /* 以下两项只在空闲时有效, 占用用户数据区 */
+    struct mem_blk *next_free;
+    struct mem_blk *prev_free;
+} mem_blk_t;
+
+#define BLK_HDR_SIZE  MEM_HEAP_ALIGN_UP(offsetof(mem_blk_t, next_free))
+#define BLK_MIN_SIZE  MEM_HEAP_ALIGN_UP(sizeof(mem_blk_t))
+#define BLK_SIZE(b)   ((b)->size & ~(uint32_t)(MEM_HEAP_ALIGN - 1U))
+#define BLK_IS_USED(b) ((b)->size & BLK_USED)
+
+/**
+ * @brief 区域
+ */
+typedef struct {
+    uint8_t *start;
+    uint8_t *end;
+    uint32_t attr;
+    size_t total_size;
+    size_t free_size;
+    size_t min_free_size;
+    uint32_t bitmap; /*!< 非空的空闲链表 */
+    mem_blk_t *free_list[MEM_HEAP_CLASS_NUM];
+} mem_region_t;
+
+static mem_region_t heap_region[MEM_HEAP_REGION_NUM];
+static uint8_t heap_region_num;
+static size_t heap_free_size;
+static size_t heap_min_free_size;
+static mem_heap_user_stat_t heap_user_stat[MEM_HEAP_USER_NUM];
+
+/**
+ * @brief 各放置提示要求的属性和优先选择的属性
+ */
+static const struct {
+    uint32_t need;
+    uint32_t prefer;
+} heap_hint_attr[MEM_HEAP_HINT_NUM] = {
+    [MEM_HEAP_HINT_FAST] = {0, MEM_HEAP_ATTR_FAST},
+    [MEM_HEAP_HINT_DMA] = {MEM_HEAP_ATTR_DMA, MEM_HEAP_ATTR_FAST},
+    [MEM_HEAP_HINT_LARGE] = {0, MEM_HEAP_ATTR_LARGE},
+};
+
+/*****************************************************************************
+ * @defgroup Private functions.
+ * @{
+ */
+
+/**
+ * @brief 加锁, 调度器启动前不需要
+ */
+static inline void heap_lock(void) {
+#if MEM_HEAP_USE_FREERTOS
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+        vTaskSuspendAll();
+    }
+#endif /* MEM_HEAP_USE_FREERTOS */
+}
+
+/**
+ * @brief 解锁
+ */
+static inline void heap_unlock(void) {
+#if MEM_HEAP_USE_FREERTOS
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+        (void)xTaskResumeAll();
+    }
+#endif /* MEM_HEAP_USE_FREERTOS */
+}
+
+/**
+ * @brief 计算块大小所在的级
+ *
+ * @param size 块大小
+ * @return 级号
+ */
+static inline uint32_t blk_class(size_t size) {
+    uint32_t cls = 31U - (uint32_t)__builtin_clz((uint32_t)size);
+
+    cls = (cls < MEM_HEAP_CLASS_SHIFT) ? 0U : cls - MEM_HEAP_CLASS_SHIFT;
+    return (cls < MEM_HEAP_CLASS_NUM) ? cls : MEM_HEAP_CLASS_NUM - 1U;
+}
+
+/**
+ * @brief 物理上的后一块
+ *
+ * @param r 区域
+ * @param b 块
+ * @return 后一块, 已到区域末尾返回 NULL
+ */
+static inline mem_blk_t *blk_next(mem_region_t *r, mem_blk_t *b) {
+    uint8_t *p = (uint8_t *)b + BLK_SIZE(b);
+
+    return (p < r->end) ? (mem_blk_t *)p : NULL;
+}
+
+/**
+ * @brief 空闲块加入链表
+ *
+ * @param r 区域
+ * @param b 空闲块
+ */
+static void free_insert(mem_region_t *r, mem_blk_t *b) {
+    uint32_t cls = blk_class(b->size);
+
+    b->prev_free = NULL;
+    b->next_free = r->free_list[cls];
+    if (b->next_free != NULL) {
+        b->next_free->prev_free = b;
+    }
+    r->free_list[cls] = b;
+    r->bitmap |= 1U << cls;
+}
+
+/**
+ * @brief 空闲块移出链表
+ *
+ * @param r 区域
+ * @param b 空闲块
+ */
+static void free_remove(mem_region_t *r, mem_blk_t *b) {
+    uint32_t cls = blk_class(b->size);
+
+    if (b->prev_free != NULL) {
+        b->prev_free->next_free = b->next_free;
+    } else {
+        r->free_list[cls] = b->next_free;
+    }
+    if (b->next_free != NULL) {
+        b->next_free->prev_free = b->prev_free;
+    }
+    if (r->free_list[cls] == NULL) {
+        r->bitmap &= ~(1U << cls);
+    }
+}
+
+/**
+ * @brief 查找足够大的空闲块
+ *
+ * @param r 区域
+ * @param need 需要的块大小
+ * @return 空闲块, 没有返回 NULL
+ * @note 先在同一级里首次适配, 再取更高一级中的第一块 (一定够大)
+ */
+static mem_blk_t *free_find(mem_region_t *r, size_t need) {
+    uint32_t cls = blk_class(need);
+    uint32_t bits;
+    mem_blk_t *b;
+
+    for (b = r->free_list[cls]; b != NULL; b = b->next_free) {
+        if (b->size >= need) {
+            return b;
+        }
+    }
+
+    if (cls + 1U >= MEM_HEAP_CLASS_NUM) {
+        return NULL;
+    }
+    bits = r->bitmap & ~((2U << cls) - 1U);
+    if (bits == 0U) {
+        return NULL;
+    }
+
+    return r->free_list[__builtin_ctz(bits)];
+}
+
+/**
+ * @brief 将已占用块的尾部切出作为空闲块, 并与后面的空闲块合并
+ *
+ * @param r 区域
+ * @param b 已占用的块
+ * @param need 保留的大小
+ */
+static void blk_split(mem_region_t *r, mem_blk_t *b, size_t need) {
+    size_t size = BLK_SIZE(b);
+    mem_blk_t *n, *next;
+
+    if (size - need < BLK_MIN_SIZE) {
+        return;
+    }
+
+    n = (mem_blk_t *)((uint8_t *)b + need);
+    n->prev_phys = b;
+    n->size = (uint32_t)(size - need);
+    n->region = b->region;
+    n->magic = BLK_MAGIC_FREE;
+    b->size = (uint32_t)need | BLK_USED;
+    r->free_size += n->size;
+    heap_free_size += n->size;
+
+    next = blk_next(r, n);
+    if (next != NULL && !BLK_IS_USED(next)) {
+        free_remove(r, next);
+        next->magic = 0;
+        n->size += BLK_SIZE(next);
+        next = blk_next(r, n);
+    }
+    if (next != NULL) {
+        next->prev_phys = n;
+    }
+
+    free_insert(r, n);
+}
+
+/**
+ * @brief 从区域中申请一块
+ *
+ * @param r 区域
+ * @param need 需要的块大小
+ * @return 已占用的块, 失败返回 NULL
+ */
+static mem_blk_t *region_alloc(mem_region_t *r, size_t need) {
+    mem_blk_t *b = free_find(r, need);
+
+    if (b == NULL) {
+        return NULL;
+    }
+
+    free_remove(r, b);
+    r->free_size -= b->size;
+    heap_free_size -= b->size;
+    b->size |= BLK_USED;
+    b->magic = BLK_MAGIC_USED;
+    blk_split(r, b, need);
+
+    if (r->free_size < r->min_free_size) {
+        r->min_free_size = r->free_size;
+    }
+    if (heap_free_size < heap_min_free_size) {
+        heap_min_free_size = heap_free_size;
+    }
+
+    return b;
+}
+
+/**
+ * @brief 计算块大小
+ *
+ * @param size 申请的大小
+ * @return 块大小, 0 表示过大
+ */
+static inline size_t blk_need(size_t size) {
+    size_t need;
+
+    if (size > 0x7FFFFFFFU - BLK_HDR_SIZE - MEM_HEAP_ALIGN) {
+        return 0;
+    }
+
+    need = MEM_HEAP_ALIGN_UP(size + BLK_HDR_SIZE);
+    return (need < BLK_MIN_SIZE) ? BLK_MIN_SIZE : need;
+}
+
+/**
+ * @brief 按放置提示依次尝试各个区域
+ *
+ * @param need 需要的块大小
+ * @param hint 放置提示
+ * @return 已占用的块, 失败返回 NULL
+ */
+static mem_blk_t *heap_alloc_blk(size_t need, mem_heap_hint_t hint) {
+    uint32_t want, prefer, pass;
+    mem_blk_t *b;
+
+    want = heap_hint_attr[hint].need;
+    prefer = heap_hint_attr[hint].prefer;
+    if (hint == MEM_HEAP_HINT_DMA && need >= MEM_HEAP_LARGE_THRESHOLD) {
+        prefer = MEM_HEAP_ATTR_LARGE;
+    }
+
+    for (pass = 0; pass < 2; ++pass) {
+        for (uint8_t i = 0; i < heap_region_num; ++i) {
+            uint32_t attr = heap_region[i].attr;
+
+            if ((attr & want) != want) {
+                continue;
+            }
+            /* 第一轮只用优先的区域, 第二轮用剩下的区域 */
+            if (((attr & prefer) == prefer) != (pass == 0)) {
+                continue;
+            }
+
+            b = region_alloc(&heap_region[i], need);
+            if (b != NULL) {
+                return b;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 校验用户指针并取得块头
+ *
+ * @param ptr 用户指针
+ * @return 块头, 非法指针返回 NULL
+ */
+static mem_blk_t *heap_get_blk(void *ptr) {
+    mem_blk_t *b = (mem_blk_t *)((uint8_t *)ptr - BLK_HDR_SIZE);
+
+    if (b->magic != BLK_MAGIC_USED || !BLK_IS_USED(b) ||
+        b->region >= heap_region_num) {
+        return NULL;
+    }
+
+    return b;
+}
+
+/**
+ * @brief 释放块并与前后的空闲块合并
+ *
+ * @param b 已占用的块
+ */
+static void heap_free_blk(mem_blk_t *b) {
+    mem_region_t *r = &heap_region[b->region];
+    mem_heap_user_stat_t *u = &heap_user_stat[b->user];
+    mem_blk_t *next, *prev;
+
+    b->size = BLK_SIZE(b);
+    b->magic = BLK_MAGIC_FREE;
+    r->free_size += b->size;
+    heap_free_size += b->size;
+    u->used -= b->size;
+    ++u->free_cnt;
+
+    next = blk_next(r, b);
+    if (next != NULL && !BLK_IS_USED(next)) {
+        free_remove(r, next);
+        next->magic = 0;
+        b->size += BLK_SIZE(next);
+    }
+
+    prev = b->prev_phys;
+    if (prev != NULL && !BLK_IS_USED(prev)) {
+        free_remove(r, prev);
+        b->magic = 0;
+        prev->size += b->size;
+        b = prev;
+    }
+
+    next = blk_next(r, b);
+    if (next != NULL) {
+        next->prev_phys = b;
+    }
+
+    free_insert(r, b);
+}
+
+/**
+ * @brief 记录申请成功
+ *
+ * @param b 块
+ * @param size 申请的大小
+ * @param user 子系统
+ */
+static void heap_account(mem_blk_t *b, size_t size, mem_heap_user_t user) {
+    mem_heap_user_stat_t *u = &heap_user_stat[user];
+
+    b->user = (uint8_t)user;
+    b->req = (uint32_t)size;
+    u->used += BLK_SIZE(b);
+    ++u->alloc_cnt;
+    if (u->used > u->peak) {
+        u->peak = u->used;
+    }
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @brief 注册一个区域
+ *
+ * @param start 起始地址
+ * @param size 大小
+ * @param attr 区域属性, `MEM_HEAP_ATTR_xxx` 的组合
+ * @return 注册状态:
+ * @retval - 0: 成功
+ * @retval - 1: 区域数量已满
+ * @retval - 2: 区域太小
+ * @note 区域按注册顺序尝试, 同类区域中先注册的优先
+ */
+int mem_heap_add_region(void *start, size_t size, uint32_t attr) {
+    uintptr_t addr = MEM_HEAP_ALIGN_UP((uintptr_t)start);
+    mem_region_t *r;
+    mem_blk_t *b;
+
+    if (heap_region_num >= MEM_HEAP_REGION_NUM) {
+        return 1;
+    }
+    if (size < addr - (uintptr_t)start + BLK_MIN_SIZE) {
+        return 2;
+    }
+
+    size = (size - (addr - (uintptr_t)start)) & ~(size_t)(MEM_HEAP_ALIGN - 1U);
+    if (size > 0x7FFFFFF8U) {
+        size = 0x7FFFFFF8U;
+    }
+
+    heap_lock();
+
+    r = &heap_region[heap_region_num];
+    memset(r, 0, sizeof(mem_region_t));
+    r->start = (uint8_t *)addr;
+    r->end = r->start + size;
+    r->attr = attr;
+    r->total_size = size;
+    r->free_size = size;
+    r->min_free_size = size;
+
+    b = (mem_blk_t *)r->start;
+    b->prev_phys = NULL;
+    b->size = (uint32_t)size;
+    b->region = heap_region_num;
+    b->magic = BLK_MAGIC_FREE;
+    free_insert(r, b);
+
+    heap_free_size += size;
+    heap_min_free_size += size;
+    ++heap_region_num;
+
+    heap_unlock();
+
+    return 0;
+}
+
+/**
+ * @brief 申请内存
+ *
+ * @param size 大小
+ * @param hint 放置提示
+ * @param user 申请的子系统
+ * @return 8 字节对齐的内存, 失败返回 NULL
+ */
+void *mem_heap_alloc(size_t size, mem_heap_hint_t hint, mem_heap_user_t user) {
+    size_t need = blk_need(size);
+    mem_blk_t *b = NULL;
+
+    if (hint >= MEM_HEAP_HINT_NUM || user >= MEM_HEAP_USER_NUM) {
+        return NULL;
+    }
+
+    heap_lock();
+
+    if (need != 0) {
+        b = heap_alloc_blk(need, hint);
+    }
+    if (b != NULL) {
+        heap_account(b, size, user);
+    } else {
+        ++heap_user_stat[user].fail_cnt;
+    }
+
+    heap_unlock();
+
+#if MEM_HEAP_TRACE
+    printf("mh a %p %u %u %u\r\n", b ? (uint8_t *)b + BLK_HDR_SIZE : NULL,
+           (unsigned int)size, (unsigned int)hint, (unsigned int)user);
+#endif /* MEM_HEAP_TRACE */
+
+    return (b != NULL) ? (uint8_t *)b + BLK_HDR_SIZE : NULL;
+}
+
+/**
+ * @brief 重新申请内存
+ *
+ * @param ptr 原来的内存, 为 NULL 时等同于 `mem_heap_alloc`
+ * @param size 新的大小, 为 0 时等同于 `mem_heap_free`
+ * @param hint 需要搬移时的放置提示
+ * @param user 申请的子系统, 原来的内存不为 NULL 时沿用原来的子系统
+ * @return 新的内存, 失败返回 NULL, 原来的内存不变
+ * @note 优先原地缩小, 或者合并后面的空闲块原地扩大
+ */
+void *mem_heap_realloc(void *ptr, size_t size, mem_heap_hint_t hint,
+                       mem_heap_user_t user) {
+    size_t need, old_size;
+    mem_heap_user_stat_t *u;
+    mem_region_t *r;
+    mem_blk_t *b, *next;
+    void *new_ptr;
+
+    if (ptr == NULL) {
+        return mem_heap_alloc(size, hint, user);
+    }
+    if (size == 0) {
+        mem_heap_free(ptr);
+        return NULL;
+    }
+
+    need = blk_need(size);
+    if (need == 0) {
+        return NULL;
+    }
+
+    heap_lock();
+
+    b = heap_get_blk(ptr);
+    if (b == NULL) {
+        heap_unlock();
+        return NULL;
+    }
+
+    r = &heap_region[b->region];
+    u = &heap_user_stat[b->user];
+    old_size = BLK_SIZE(b);
+    next = blk_next(r, b);
+
+    if (need > old_size && next != NULL && !BLK_IS_USED(next) &&
+        old_size + next->size >= need) {
+        free_remove(r, next);
+        next->magic = 0;
+        r->free_size -= next->size;
+        heap_free_size -= next->size;
+        b->size = (uint32_t)(old_size + next->size) | BLK_USED;
+        next = blk_next(r, b);
+        if (next != NULL) {
+            next->prev_phys = b;
+        }
+        if (r->free_size < r->min_free_size) {
+            r->min_free_size = r->free_size;
+        }
+        if (heap_free_size < heap_min_free_size) {
+            heap_min_free_size = heap_free_size;
+        }
+    }
+
+    if (need <= BLK_SIZE(b)) {
+        blk_split(r, b, need);
+        u->used = u->used - old_size + BLK_SIZE(b);
+        if (u->used > u->peak) {
+            u->peak = u->used;
+        }
+        b->req = (uint32_t)size;
+        heap_unlock();
+
+#if MEM_HEAP_TRACE
+        printf("mh r %p %p %u %u %u\r\n", ptr, ptr, (unsigned int)size,
+               (unsigned int)hint, (unsigned int)b->user);
+#endif /* MEM_HEAP_TRACE */
+
+        return ptr;
+    }
+
+    user = (mem_heap_user_t)b->user;
+    old_size = b->req;
+    heap_unlock();
+
+    new_ptr = mem_heap_alloc(size, hint, user);
+    if (new_ptr != NULL) {
+        memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+        mem_heap_free(ptr);
+    }
+
+    return new_ptr;
+}
+
+/**
+ * @brief 释放内存
+ *
+ * @param ptr 内存, 为 NULL 时不做任何事
+ * @note 重复释放或非法指针会被忽略
+ */
+void mem_heap_free(void *ptr) {
+    mem_blk_t *b;
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    heap_lock();
+
+    b = heap_get_blk(ptr);
+    if (b != NULL) {
+        heap_free_blk(b);
+    }
+
+    heap_unlock();
+
+#if MEM_HEAP_TRACE
+    printf("mh f %p\r\n", ptr);
+#endif /* MEM_HEAP_TRACE */
+}
+
+/**
+ * @brief 所有区域的空闲大小
+ *
+ * @return 空闲大小
+ */
+size_t mem_heap_get_free_size(void) {
+    return heap_free_size;
+}
+
+/**
+ * @brief 所有区域空闲大小的历史最小值
+ *
+ * @return 空闲大小的历史最小值
+ */
+size_t mem_heap_get_min_free_size(void) {
+    return heap_min_free_size;
+}
+
+/**
+ * @brief 获取区域统计
+ *
+ * @param index 区域序号, 即注册顺序
+ * @param[out] stat 统计
+ * @return 获取状态:
+ * @retval - 0: 成功
+ * @retval - 1: 区域不存在
+ * @note 需要遍历空闲链表
+ */
+int mem_heap_get_region_stat(uint8_t index, mem_heap_region_stat_t *stat) {
+    mem_region_t *r;
+    mem_blk_t *b;
+
+    if (index >= heap_region_num || stat == NULL) {
+        return 1;
+    }
+
+    r = &heap_region[index];
+
+    heap_lock();
+
+    stat->start = (uintptr_t)r->start;
+    stat->attr = r->attr;
+    stat->total_size = r->total_size;
+    stat->free_size = r->free_size;
+    stat->min_free_size = r->min_free_size;
+    stat->max_free_blk = 0;
+    stat->min_free_blk = 0;
+    stat->free_blk_num = 0;
+    for (uint32_t cls = 0; cls < MEM_HEAP_CLASS_NUM; ++cls) {
+        for (b = r->free_list[cls]; b != NULL; b = b->next_free) {
+            ++stat->free_blk_num;
+            if (b->size > stat->max_free_blk) {
+                stat->max_free_blk = b->size;
+            }
+            if (stat->min_free_blk == 0 || b->size < stat->min_free_blk) {
+                stat->min_free_blk = b->size;
+            }
+        }
+    }
+
+    heap_unlock();
+
+    stat->frag = (stat->free_size == 0)
+                     ? 0
+                     : (uint8_t)(100U - (uint32_t)((uint64_t)stat->max_free_blk *
+                                                   100U / stat->free_size));
+
+    return 0;
+}
+
+/**
+ * @brief 获取子系统统计
+ *
+ * @param user 子系统
+ * @param[out] stat 统计
+ */
+void mem_heap_get_user_stat(mem_heap_user_t user, mem_heap_user_stat_t *stat) {
+    if (user >= MEM_HEAP_USER_NUM || stat == NULL) {
+        return;
+    }
+
+    heap_lock();
+    *stat = heap_user_stat[user];
+    heap_unlock();
+}
+
+#if MEM_HEAP_USE_FREERTOS
+
+/*****************************************************************************
+ * @defgroup FreeRTOS heap port, replace heap_4.c.
+ * @{
+ */
+
+/**
+ * @brief FreeRTOS 申请内存, 内核对象只由 CPU 访问, 优先放在 CCM
+ *
+ * @param xWantedSize 大小
+ * @return 内存
+ */
+void *pvPortMalloc(size_t xWantedSize) {
+    void *ret = mem_heap_alloc(xWantedSize, MEM_HEAP_HINT_FAST,
+                               MEM_HEAP_USER_RTOS);
+
+    traceMALLOC(ret, xWantedSize);
+
+#if (configUSE_MALLOC_FAILED_HOOK == 1)
+    if (ret == NULL) {
+        extern void vApplicationMallocFailedHook(void);
+        vApplicationMallocFailedHook();
+    }
+#endif /* configUSE_MALLOC_FAILED_HOOK == 1 */
+
+    return ret;
+}
+
+/**
+ * @brief FreeRTOS 申请清零的内存
+ *
+ * @param xNum 数量
+ * @param xSize 每个的大小
+ * @return 内存
+ */
+void *pvPortCalloc(size_t xNum, size_t xSize) {
+    void *ret;
+
+    if (xSize != 0 && xNum > (size_t)-1 / xSize) {
+        return NULL;
+    }
+
+    ret = pvPortMalloc(xNum * xSize);
+    if (ret != NULL) {
+        memset(ret, 0, xNum * xSize);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief FreeRTOS 释放内存
+ *
+ * @param pv 内存
+ */
+void vPortFree(void *pv) {
+    if (pv != NULL) {
+        traceFREE(pv, 0);
+        mem_heap_free(pv);
+    }
+}
+
+#if (configSTACK_ALLOCATION_FROM_SEPARATE_HEAP == 1)
+
+/**
+ * @brief FreeRTOS 申请任务栈, 栈上的缓冲区可能交给 DMA, 不能放在 CCM
+ *
+ * @param xSize 大小
+ * @return 内存
+ */
+void *pvPortMallocStack(size_t xSize) {
+    void *ret = mem_heap_alloc(xSize, MEM_HEAP_HINT_DMA, MEM_HEAP_USER_RTOS);
+
+    traceMALLOC(ret, xSize);
+
+    return ret;
+}
+
+/**
+ * @brief FreeRTOS 释放任务栈
+ *
+ * @param pv 内存
+ */
+void vPortFreeStack(void *pv) {
+    vPortFree(pv);
+}
+
+#endif /* configSTACK_ALLOCATION_FROM_SEPARATE_HEAP == 1 */
+
+/**
+ * @brief 堆由 mem_heap_add_region 初始化, 无需操作
+ */
+void vPortInitialiseBlocks(void) {
+}
+
+/**
+ * @brief FreeRTOS 空闲内存大小
+ *
+ * @return 所有区域的空闲大小
+ */
+size_t xPortGetFreeHeapSize(void) {
+    return mem_heap_get_free_size();
+}
+
+/**
+ * @brief FreeRTOS 空闲内存的历史最小值
+ *
+ * @return 所有区域空闲大小的历史最小值
+ */
+size_t xPortGetMinimumEverFreeHeapSize(void) {
+    return mem_heap_get_min_free_size();
+}
+
+/**
+ * @brief FreeRTOS 堆统计, 汇总所有区域
+ *
+ * @param pxHeapStats 统计
+ */
+void vPortGetHeapStats(HeapStats_t *pxHeapStats) {
+    mem_heap_region_stat_t region;
+    mem_heap_user_stat_t user;
+
+    memset(pxHeapStats, 0, sizeof(HeapStats_t));
+    pxHeapStats->xSizeOfSmallestFreeBlockInBytes = (size_t)-1;
+
+    for (uint8_t i = 0; mem_heap_get_region_stat(i, &region) == 0; ++i) {
+        pxHeapStats->xAvailableHeapSpaceInBytes += region.free_size;
+        pxHeapStats->xNumberOfFreeBlocks += region.free_blk_num;
+        if (region.max_free_blk >
+            pxHeapStats->xSizeOfLargestFreeBlockInBytes) {
+            pxHeapStats->xSizeOfLargestFreeBlockInBytes = region.max_free_blk;
+        }
+        if (region.free_blk_num != 0 &&
+            region.min_free_blk < pxHeapStats->xSizeOfSmallestFreeBlockInBytes) {
+            pxHeapStats->xSizeOfSmallestFreeBlockInBytes = region.min_free_blk;
+        }
+    }
+    if (pxHeapStats->xNumberOfFreeBlocks == 0) {
+        pxHeapStats->xSizeOfSmallestFreeBlockInBytes = 0;
+    }
+
+    mem_heap_get_user_stat(MEM_HEAP_USER_RTOS, &user);
+    pxHeapStats->xMinimumEverFreeBytesRemaining = mem_heap_get_min_free_size();
+    pxHeapStats->xNumberOfSuccessfulAllocations = user.alloc_cnt;
+    pxHeapStats->xNumberOfSuccessfulFrees = user.free_cnt;
+}
+
+/**
+ * @}
+ */
+
+#endif /* MEM_HEAP_USE_FREERTOS */
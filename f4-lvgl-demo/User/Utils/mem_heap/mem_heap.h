@@ -0,0 +1,125 @@
+/**
+ * @file    mem_heap.h
+ * @author  Deadline039
+ * @brief   多区域堆管理, 统一管理 SRAM, CCM 和 SDRAM
+ * @version 1.0
+ * @date    2026-10-19
+ *
+ * 每个区域用分级空闲链表 (按 2 的幂分级, 级内首次适配) 管理, 释放时与物理
+ * 相邻的空闲块立即合并. 申请时根据放置提示依次尝试各个区域:
+ *
+ *   MEM_HEAP_HINT_FAST  : CCM -> SRAM -> SDRAM, CPU 专用的小对象
+ *   MEM_HEAP_HINT_DMA   : SRAM -> SDRAM, 不会落在 CCM (DMA 无法访问 CCM);
+ *                         不小于 MEM_HEAP_LARGE_THRESHOLD 时优先 SDRAM
+ *   MEM_HEAP_HINT_LARGE : SDRAM -> 其他区域, 大缓冲区
+ *
+ * 区域按注册的先后顺序尝试. 每次申请都记在一个子系统名下, 用于按子系统统计
+ * 占用和峰值.
+ *
+ * 加锁使用 vTaskSuspendAll, 调度器启动前不加锁. 不能在中断中使用.
+ */
+
+#ifndef __MEM_HEAP_H
+#define __MEM_HEAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* 使用 FreeRTOS 加锁, 并接管 pvPortMalloc/vPortFree (替代 heap_4.c) */
+#ifndef MEM_HEAP_USE_FREERTOS
+#define MEM_HEAP_USE_FREERTOS    1
+#endif /* MEM_HEAP_USE_FREERTOS */
+
+/* 最多可注册的区域数量 */
+#define MEM_HEAP_REGION_NUM      4
+/* 不小于这个大小的 DMA 申请优先放在大容量区域 */
+#define MEM_HEAP_LARGE_THRESHOLD 4096
+
+/* 通过 printf 输出每次申请和释放, 用 Tools/mem_heap_replay 回放 */
+#ifndef MEM_HEAP_TRACE
+#define MEM_HEAP_TRACE           0
+#endif /* MEM_HEAP_TRACE */
+
+/* 区域属性 */
+#define MEM_HEAP_ATTR_FAST       (1U << 0) /*!< CPU 零等待访问 */
+#define MEM_HEAP_ATTR_DMA        (1U << 1) /*!< DMA 可访问 */
+#define MEM_HEAP_ATTR_LARGE      (1U << 2) /*!< 大容量 */
+
+/**
+ * @brief 放置提示
+ */
+typedef enum {
+    MEM_HEAP_HINT_FAST,  /*!< 优先快速内存 */
+    MEM_HEAP_HINT_DMA,   /*!< 必须 DMA 可访问 */
+    MEM_HEAP_HINT_LARGE, /*!< 优先大容量内存 */
+    MEM_HEAP_HINT_NUM
+} mem_heap_hint_t;
+
+/**
+ * @brief 申请内存的子系统
+ */
+typedef enum {
+    MEM_HEAP_USER_APP,  /*!< 应用 */
+    MEM_HEAP_USER_RTOS, /*!< FreeRTOS */
+    MEM_HEAP_USER_LVGL, /*!< LVGL 和 EEZ Flow */
+    MEM_HEAP_USER_CSP,  /*!< CSP 外设驱动 */
+    MEM_HEAP_USER_NUM
+} mem_heap_user_t;
+
+/**
+ * @brief 区域统计
+ */
+typedef struct {
+    uintptr_t start;      /*!< 起始地址 */
+    uint32_t attr;        /*!< 区域属性 */
+    size_t total_size;    /*!< 可用大小 */
+    size_t free_size;     /*!< 空闲大小 */
+    size_t min_free_size; /*!< 空闲大小的历史最小值 */
+    size_t max_free_blk;  /*!< 最大的空闲块 */
+    size_t min_free_blk;  /*!< 最小的空闲块 */
+    size_t free_blk_num;  /*!< 空闲块数量 */
+    uint8_t frag;         /*!< 碎片率 (%), 100 - 最大空闲块 / 空闲大小 */
+} mem_heap_region_stat_t;
+
+/**
+ * @brief 子系统统计
+ */
+typedef struct {
+    size_t used;         /*!< 当前占用 (含块头) */
+    size_t peak;         /*!< 占用峰值 */
+    uint32_t alloc_cnt;  /*!< 成功申请次数 */
+    uint32_t free_cnt;   /*!< 释放次数 */
+    uint32_t fail_cnt;   /*!< 申请失败次数 */
+} mem_heap_user_stat_t;
+
+int mem_heap_add_region(void *start, size_t size, uint32_t attr);
+
+void *mem_heap_alloc(size_t size, mem_heap_hint_t hint, mem_heap_user_t user);
+void *mem_heap_realloc(void *ptr, size_t size, mem_heap_hint_t hint,
+                       mem_heap_user_t user);
+void mem_heap_free(void *ptr);
+
+size_t mem_heap_get_free_size(void);
+size_t mem_heap_get_min_free_size(void);
+int mem_heap_get_region_stat(uint8_t index, mem_heap_region_stat_t *stat);
+void mem_heap_get_user_stat(mem_heap_user_t user, mem_heap_user_stat_t *stat);
+
+/* 各子系统的接口, 供 lv_conf.h 和 CSP_Config.h 使用 */
+#define mem_heap_lvgl_alloc(size)                                              \
+    mem_heap_alloc((size), MEM_HEAP_HINT_DMA, MEM_HEAP_USER_LVGL)
+#define mem_heap_lvgl_realloc(ptr, size)                                       \
+    mem_heap_realloc((ptr), (size), MEM_HEAP_HINT_DMA, MEM_HEAP_USER_LVGL)
+#define mem_heap_csp_alloc(size)                                               \
+    mem_heap_alloc((size), MEM_HEAP_HINT_DMA, MEM_HEAP_USER_CSP)
+#define mem_heap_csp_realloc(ptr, size)                                        \
+    mem_heap_realloc((ptr), (size), MEM_HEAP_HINT_DMA, MEM_HEAP_USER_CSP)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MEM_HEAP_H */
@@ -0,0 +1,388 @@
+/**
+ * @file    mem_slab.c
+ * @author  Deadline039
+ * @brief   小对象分级分配器
+ * @version 1.0
+ * @date    2026-10-19
+ */
+
+#include "mem_slab.h"
+#include "mem_heap.h"
+
+#include <string.h>
+
+#if MEM_SLAB_POISON
+#include <stdio.h>
+#endif /* MEM_SLAB_POISON */
+
+#if MEM_HEAP_USE_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#endif /* MEM_HEAP_USE_FREERTOS */
+
+#if (MEM_SLAB_GRANULE < 8) || (MEM_SLAB_GRANULE & (MEM_SLAB_GRANULE - 1))
+#error "MEM_SLAB_GRANULE must be a power of 2 and not less than 8"
+#endif /* MEM_SLAB_GRANULE */
+
+#if (MEM_SLAB_PAGE_SIZE % MEM_SLAB_GRANULE) || (MEM_SLAB_PAGE_SIZE > 0xFFFF)
+#error "MEM_SLAB_PAGE_SIZE must be a multiple of MEM_SLAB_GRANULE and < 64K"
+#endif /* MEM_SLAB_PAGE_SIZE */
+
+#define SLAB_CLASS_NUM  (MEM_SLAB_MAX_SIZE / MEM_SLAB_GRANULE)
+#define SLAB_PAGE_NONE  0xFFFFU
+#define SLAB_POISON     0xCCU
+
+/**
+ * @brief 空闲对象, 链接指针占用对象的前 4 字节
+ */
+typedef struct slab_obj {
+    struct slab_obj *next;
+} slab_obj_t;
+
+/**
+ * @brief 页描述, 与页分开存放, 不占用对象的空间
+ */
+typedef struct {
+    slab_obj_t *free_list; /*!< 页内已释放的对象 */
+    uint16_t used;         /*!< 已申请的对象数量 */
+    uint16_t carved;       /*!< 已切分的对象数量, 未切分的部分不需要链表 */
+    uint16_t prev;         /*!< 所在链表中的前一页 */
+    uint16_t next;         /*!< 所在链表中的后一页 */
+    uint8_t cls;           /*!< 所属的级 */
+} slab_page_t;
+
+static slab_page_t *slab_pages;
+static uint8_t *slab_base;
+static uint8_t *slab_end;
+static uint16_t slab_page_num;
+
+/* 每级有空闲对象的页 */
+static uint16_t slab_partial[SLAB_CLASS_NUM];
+/* 空闲页 */
+static uint16_t slab_free_page;
+
+static mem_slab_stat_t slab_stat;
+
+/*****************************************************************************
+ * @defgroup Private functions.
+ * @{
+ */
+
+/**
+ * @brief 加锁, 调度器启动前不需要
+ */
+static inline void slab_lock(void) {
+#if MEM_HEAP_USE_FREERTOS
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+        vTaskSuspendAll();
+    }
+#endif /* MEM_HEAP_USE_FREERTOS */
+}
+
+/**
+ * @brief 解锁
+ */
+static inline void slab_unlock(void) {
+#if MEM_HEAP_USE_FREERTOS
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+        (void)xTaskResumeAll();
+    }
+#endif /* MEM_HEAP_USE_FREERTOS */
+}
+
+/**
+ * @brief 级对应的对象大小
+ *
+ * @param cls 级
+ * @return 对象大小
+ */
+static inline uint32_t slab_obj_size(uint32_t cls) {
+    return (cls + 1U) * MEM_SLAB_GRANULE;
+}
+
+/**
+ * @brief 级对应的每页对象数量
+ *
+ * @param cls 级
+ * @return 对象数量
+ */
+static inline uint32_t slab_obj_num(uint32_t cls) {
+    return MEM_SLAB_PAGE_SIZE / slab_obj_size(cls);
+}
+
+/**
+ * @brief 从链表中取下一页
+ *
+ * @param head 链表头
+ * @param index 页号
+ */
+static void page_unlink(uint16_t *head, uint16_t index) {
+    slab_page_t *p = &slab_pages[index];
+
+    if (p->prev != SLAB_PAGE_NONE) {
+        slab_pages[p->prev].next = p->next;
+    } else {
+        *head = p->next;
+    }
+    if (p->next != SLAB_PAGE_NONE) {
+        slab_pages[p->next].prev = p->prev;
+    }
+}
+
+/**
+ * @brief 把一页插入链表头
+ *
+ * @param head 链表头
+ * @param index 页号
+ */
+static void page_push(uint16_t *head, uint16_t index) {
+    slab_page_t *p = &slab_pages[index];
+
+    p->prev = SLAB_PAGE_NONE;
+    p->next = *head;
+    if (*head != SLAB_PAGE_NONE) {
+        slab_pages[*head].prev = index;
+    }
+    *head = index;
+}
+
+#if MEM_SLAB_POISON
+/**
+ * @brief 检查对象除链接指针外是否都是填充值
+ *
+ * @param obj 对象
+ * @param size 对象大小
+ * @return 是否完好
+ */
+static uint8_t slab_poison_ok(const uint8_t *obj, uint32_t size) {
+    for (uint32_t i = sizeof(slab_obj_t); i < size; ++i) {
+        if (obj[i] != SLAB_POISON) {
+            return 0;
+        }
+    }
+    return 1;
+}
+#endif /* MEM_SLAB_POISON */
+
+/**
+ * @}
+ */
+
+/**
+ * @brief 初始化
+ *
+ * @param start 起始地址, 通常从 mem_heap 申请
+ * @param size 大小
+ * @return 初始化状态:
+ * @retval - 0: 成功
+ * @retval - 1: 空间不足一页
+ */
+int mem_slab_init(void *start, size_t size) {
+    uintptr_t addr = ((uintptr_t)start + MEM_SLAB_GRANULE - 1U) &
+                     ~(uintptr_t)(MEM_SLAB_GRANULE - 1U);
+    size_t num;
+
+    if (size < addr - (uintptr_t)start) {
+        return 1;
+    }
+    size -= addr - (uintptr_t)start;
+
+    /* 页描述放在最前面, 之后是按粒度对齐的页 */
+    num = size / (MEM_SLAB_PAGE_SIZE + sizeof(slab_page_t));
+    while (num > 0 && ((num * sizeof(slab_page_t) + MEM_SLAB_GRANULE - 1U) &
+                       ~(size_t)(MEM_SLAB_GRANULE - 1U)) +
+                              num * MEM_SLAB_PAGE_SIZE >
+                          size) {
+        --num;
+    }
+    if (num == 0) {
+        return 1;
+    }
+    if (num >= SLAB_PAGE_NONE) {
+        num = SLAB_PAGE_NONE - 1U;
+    }
+
+    slab_lock();
+
+    slab_pages = (slab_page_t *)addr;
+    slab_base = (uint8_t *)((addr + num * sizeof(slab_page_t) +
+                             MEM_SLAB_GRANULE - 1U) &
+                            ~(uintptr_t)(MEM_SLAB_GRANULE - 1U));
+    slab_end = slab_base + num * MEM_SLAB_PAGE_SIZE;
+    slab_page_num = (uint16_t)num;
+
+    for (uint32_t i = 0; i < SLAB_CLASS_NUM; ++i) {
+        slab_partial[i] = SLAB_PAGE_NONE;
+    }
+    slab_free_page = SLAB_PAGE_NONE;
+    for (uint16_t i = slab_page_num; i > 0; --i) {
+        page_push(&slab_free_page, i - 1U);
+    }
+
+    memset(&slab_stat, 0, sizeof(slab_stat));
+    slab_stat.total_size = num * MEM_SLAB_PAGE_SIZE;
+    slab_stat.page_num = slab_page_num;
+
+    slab_unlock();
+
+    return 0;
+}
+
+/**
+ * @brief 申请对象
+ *
+ * @param size 大小
+ * @return 按 MEM_SLAB_GRANULE 对齐的内存, 超过 MEM_SLAB_MAX_SIZE 或者没有
+ *         空闲页时返回 NULL
+ */
+void *mem_slab_alloc(size_t size) {
+    uint32_t cls, obj_size;
+    uint16_t index;
+    slab_page_t *p;
+    uint8_t *obj;
+
+    if (size == 0 || size > MEM_SLAB_MAX_SIZE || slab_page_num == 0) {
+        return NULL;
+    }
+
+    cls = (uint32_t)(size - 1U) / MEM_SLAB_GRANULE;
+    obj_size = slab_obj_size(cls);
+
+    slab_lock();
+
+    index = slab_partial[cls];
+    if (index == SLAB_PAGE_NONE) {
+        index = slab_free_page;
+        if (index == SLAB_PAGE_NONE) {
+            ++slab_stat.fail_cnt;
+            slab_unlock();
+            return NULL;
+        }
+        page_unlink(&slab_free_page, index);
+        p = &slab_pages[index];
+        p->free_list = NULL;
+        p->used = 0;
+        p->carved = 0;
+        p->cls = (uint8_t)cls;
+        page_push(&slab_partial[cls], index);
+        ++slab_stat.page_used;
+    }
+
+    p = &slab_pages[index];
+    if (p->free_list != NULL) {
+        obj = (uint8_t *)p->free_list;
+        p->free_list = p->free_list->next;
+#if MEM_SLAB_POISON
+        if (!slab_poison_ok(obj, obj_size)) {
+            ++slab_stat.poison_err;
+            printf("mem_slab: %p modified after free\r\n", obj);
+        }
+#endif /* MEM_SLAB_POISON */
+    } else {
+        obj = slab_base + (uint32_t)index * MEM_SLAB_PAGE_SIZE +
+              (uint32_t)p->carved * obj_size;
+        ++p->carved;
+    }
+
+    if (++p->used == slab_obj_num(cls)) {
+        page_unlink(&slab_partial[cls], index);
+    }
+
+    slab_stat.used_size += obj_size;
+    if (slab_stat.used_size > slab_stat.peak_size) {
+        slab_stat.peak_size = slab_stat.used_size;
+    }
+    ++slab_stat.alloc_cnt;
+
+    slab_unlock();
+
+    return obj;
+}
+
+/**
+ * @brief 释放对象
+ *
+ * @param ptr 由 `mem_slab_alloc` 申请的对象
+ * @note 调用者先用 `mem_slab_contains` 判断对象是否属于这里
+ */
+void mem_slab_free(void *ptr) {
+    uint32_t offset, in_page, cls, obj_size;
+    uint16_t index;
+    slab_page_t *p;
+
+    if (!mem_slab_contains(ptr)) {
+        return;
+    }
+
+    offset = (uint32_t)((uint8_t *)ptr - slab_base);
+    index = (uint16_t)(offset / MEM_SLAB_PAGE_SIZE);
+    p = &slab_pages[index];
+
+    slab_lock();
+
+    cls = p->cls;
+    obj_size = slab_obj_size(cls);
+
+    in_page = offset % MEM_SLAB_PAGE_SIZE;
+
+    /* 非法指针: 页未使用, 不在对象边界上或者落在页尾的剩余空间 */
+    if (p->used == 0 || in_page % obj_size != 0 ||
+        in_page >= slab_obj_num(cls) * obj_size) {
+        slab_unlock();
+        return;
+    }
+
+#if MEM_SLAB_POISON
+    for (slab_obj_t *o = p->free_list; o != NULL; o = o->next) {
+        if (o == ptr) {
+            ++slab_stat.poison_err;
+            printf("mem_slab: %p freed twice\r\n", ptr);
+            slab_unlock();
+            return;
+        }
+    }
+    memset(ptr, SLAB_POISON, obj_size);
+#endif /* MEM_SLAB_POISON */
+
+    if (p->used == slab_obj_num(cls)) {
+        /* 满页重新有了空闲对象 */
+        page_push(&slab_partial[cls], index);
+    }
+
+    ((slab_obj_t *)ptr)->next = p->free_list;
+    p->free_list = (slab_obj_t *)ptr;
+
+    if (--p->used == 0) {
+        /* 整页空闲, 归还给所有级使用 */
+        page_unlink(&slab_partial[cls], index);
+        page_push(&slab_free_page, index);
+        --slab_stat.page_used;
+    }
+
+    slab_stat.used_size -= obj_size;
+    ++slab_stat.free_cnt;
+
+    slab_unlock();
+}
+
+/**
+ * @brief 判断内存是否由这里分配
+ *
+ * @param ptr 内存
+ * @return 是否由这里分配
+ */
+uint8_t mem_slab_contains(const void *ptr) {
+    return ((const uint8_t *)ptr >= slab_base &&
+            (const uint8_t *)ptr < slab_end);
+}
+
+/**
+ * @brief 获取统计
+ *
+ * @param stat 统计
+ */
+void mem_slab_get_stat(mem_slab_stat_t *stat) {
+    slab_lock();
+    *stat = slab_stat;
+    slab_unlock();
+}
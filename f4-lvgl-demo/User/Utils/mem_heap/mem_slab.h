@@ -0,0 +1,72 @@
+/**
+ * @file    mem_slab.h
+ * @author  Deadline039
+ * @brief   小对象分级分配器
+ * @version 1.0
+ * @date    2026-10-19
+ *
+ * 从 mem_heap 申请一块连续的内存, 切分为固定大小的页. 每页只存放一种大小的
+ * 对象, 对象大小按 MEM_SLAB_GRANULE 分级. 每级维护一个有空闲对象的页链表,
+ * 每页维护自己的空闲对象链表, 申请和释放都是 O(1), 页中的对象全部释放后
+ * 归还给空闲页, 可以被其他级使用.
+ *
+ * 对象没有块头, 释放时根据地址所在的页找到大小. 大于 MEM_SLAB_MAX_SIZE
+ * 或者页用完时返回 NULL, 由调用者改用 mem_heap.
+ *
+ * 加锁方式与 mem_heap 相同, 不能在中断中使用.
+ */
+
+#ifndef __MEM_SLAB_H
+#define __MEM_SLAB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* 对象大小的粒度, 同时也是对象的对齐 */
+#ifndef MEM_SLAB_GRANULE
+#define MEM_SLAB_GRANULE   16
+#endif /* MEM_SLAB_GRANULE */
+/* 最大的对象 */
+#ifndef MEM_SLAB_MAX_SIZE
+#define MEM_SLAB_MAX_SIZE  256
+#endif /* MEM_SLAB_MAX_SIZE */
+/* 页大小, 越大每页的对象越多, 但没用满的页浪费也越多 */
+#ifndef MEM_SLAB_PAGE_SIZE
+#define MEM_SLAB_PAGE_SIZE 512
+#endif /* MEM_SLAB_PAGE_SIZE */
+
+/* 调试: 释放时用 0xCC 填充对象, 申请时检查, 发现释放后写入和重复释放 */
+#ifndef MEM_SLAB_POISON
+#define MEM_SLAB_POISON   0
+#endif /* MEM_SLAB_POISON */
+
+/**
+ * @brief 统计
+ */
+typedef struct {
+    size_t total_size;   /*!< 页的总大小 */
+    size_t used_size;    /*!< 已申请对象的大小 (按级对齐后) */
+    size_t peak_size;    /*!< used_size 的峰值 */
+    uint16_t page_num;   /*!< 页数量 */
+    uint16_t page_used;  /*!< 已分配给某一级的页 */
+    uint32_t alloc_cnt;  /*!< 成功申请次数 */
+    uint32_t free_cnt;   /*!< 释放次数 */
+    uint32_t fail_cnt;   /*!< 没有空闲页导致的失败次数 */
+    uint32_t poison_err; /*!< 检查到的释放后写入和重复释放次数 */
+} mem_slab_stat_t;
+
+int mem_slab_init(void *start, size_t size);
+void *mem_slab_alloc(size_t size);
+void mem_slab_free(void *ptr);
+uint8_t mem_slab_contains(const void *ptr);
+void mem_slab_get_stat(mem_slab_stat_t *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MEM_SLAB_H */